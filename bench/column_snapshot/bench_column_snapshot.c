@@ -0,0 +1,353 @@
+/**
+ * \file bench/column_snapshot/bench_column_snapshot.c
+ *
+ * \brief Compare a maintenance query answered by walking the records of a
+ * store with the same query answered by scanning a column snapshot.
+ *
+ * The query selects the unrevoked records that expire before a cutoff and
+ * still use a short password, which is the shape of a rotation sweep.
+ *
+ * Usage: bench_column_snapshot [records] [repeats]
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/column_snapshot.h>
+#include <rcpr/socket_utilities.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief The expiration cutoff of the query.
+ */
+#define CUTOFF                                                          500000
+
+/**
+ * \brief The shortest password length that is not selected.
+ */
+#define MIN_LENGTH                                                          20
+
+/**
+ * \brief Get the current monotonic time in seconds.
+ */
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * \brief Build a store image of records with varied dates and lengths.
+ */
+static status image_create(
+    secure_buffer** image, RCPR_SYM(allocator)* alloc, size_t count)
+{
+    status retval, release_retval;
+    secure_buffer_builder* builder = NULL;
+    uint32_t header[4] = {
+        socket_utility_hton32(STORE_MAGIC),
+        socket_utility_hton32(STORE_FORMAT_VERSION_1), 0, 0 };
+    uint8_t hash_id[32];
+
+    retval = secure_buffer_builder_create(&builder, alloc, 0);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = secure_buffer_builder_append(builder, header, sizeof(header));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_builder;
+    }
+
+    srand(1);
+    for (size_t i = 0; i < count; ++i)
+    {
+        metadata* meta = NULL;
+        secure_buffer* record = NULL;
+        const void* data;
+        size_t size;
+        uint32_t net_size;
+        uint64_t expiration = (uint64_t)rand() % 1000000;
+        uint64_t revocation = (0 == rand() % 8) ? expiration : 0;
+        uint32_t length = 12 + (uint32_t)(rand() % 20);
+
+        memset(hash_id, 0, sizeof(hash_id));
+        memcpy(hash_id, &i, sizeof(i));
+        if (STATUS_SUCCESS != (retval = metadata_create(&meta, alloc)))
+        {
+            goto cleanup_builder;
+        }
+
+        if (STATUS_SUCCESS
+                != (retval =
+                        metadata_hash_id_set(meta, hash_id, sizeof(hash_id)))
+         || STATUS_SUCCESS != (retval = metadata_version_set(meta, 1))
+         || STATUS_SUCCESS != (retval = metadata_creation_date_set(meta, 1))
+         || STATUS_SUCCESS
+                != (retval = metadata_revocation_date_set(meta, revocation))
+         || STATUS_SUCCESS
+                != (retval = metadata_expiration_date_set(meta, expiration))
+         || STATUS_SUCCESS
+                != (retval = metadata_password_length_set(meta, length))
+         || STATUS_SUCCESS != (retval = metadata_generation_set(meta, 0))
+         || STATUS_SUCCESS != (retval = metadata_legacy_flag_set(meta, false))
+         || STATUS_SUCCESS
+                != (retval = metadata_kdf_name_set(meta, "pbkdf2-sha3-512"))
+         || STATUS_SUCCESS
+                != (retval = metadata_encoding_set(meta, "0123456789abcdef"))
+         || STATUS_SUCCESS
+                != (retval = metadata_to_buffer(&record, alloc, meta)))
+        {
+            release_retval = resource_release(metadata_resource_handle(meta));
+            (void)release_retval;
+            goto cleanup_builder;
+        }
+
+        data = secure_buffer_data(&size, record);
+        net_size = socket_utility_hton32((uint32_t)size);
+        if (STATUS_SUCCESS
+                != (retval =
+                        secure_buffer_builder_append(
+                            builder, &net_size, sizeof(net_size)))
+         || STATUS_SUCCESS
+                != (retval = secure_buffer_builder_append(builder, data, size))
+         || STATUS_SUCCESS
+                != (retval =
+                        resource_release(secure_buffer_resource_handle(record)))
+         || STATUS_SUCCESS
+                != (retval = resource_release(metadata_resource_handle(meta))))
+        {
+            goto cleanup_builder;
+        }
+    }
+
+    retval = secure_buffer_builder_finalize(image, builder);
+
+cleanup_builder:
+    release_retval =
+        resource_release(secure_buffer_builder_resource_handle(builder));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Answer the query by reading each record.
+ */
+static status query_records(size_t* count, const store* st)
+{
+    status retval;
+    uint64_t expiration, revocation;
+    uint32_t length;
+
+    *count = 0;
+    for (size_t i = 0; i < store_record_count_get(st); ++i)
+    {
+        const metadata* meta = store_record_get(st, i);
+
+        if (STATUS_SUCCESS
+                != (retval = metadata_expiration_date_get(&expiration, meta))
+         || STATUS_SUCCESS
+                != (retval = metadata_revocation_date_get(&revocation, meta))
+         || STATUS_SUCCESS
+                != (retval = metadata_password_length_get(&length, meta)))
+        {
+            return retval;
+        }
+
+        if (expiration < CUTOFF && 0 == revocation && length < MIN_LENGTH)
+        {
+            ++*count;
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Answer the query by scanning the snapshot columns.
+ */
+static status query_columns(
+    size_t* count, const column_snapshot* snap, uint64_t* bitmap,
+    uint64_t* scratch)
+{
+    status retval;
+    size_t rows = column_snapshot_row_count_get(snap);
+    size_t words = COLUMN_SNAPSHOT_BITMAP_WORDS(rows);
+
+    retval =
+        column_snapshot_scan(
+            bitmap, snap, COLUMN_SNAPSHOT_FIELD_EXPIRATION_DATE,
+            COLUMN_SNAPSHOT_OP_LT, CUTOFF);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval =
+        column_snapshot_scan(
+            scratch, snap, COLUMN_SNAPSHOT_FIELD_REVOCATION_DATE,
+            COLUMN_SNAPSHOT_OP_EQ, 0);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    for (size_t i = 0; i < words; ++i)
+    {
+        bitmap[i] &= scratch[i];
+    }
+
+    retval =
+        column_snapshot_scan(
+            scratch, snap, COLUMN_SNAPSHOT_FIELD_PASSWORD_LENGTH,
+            COLUMN_SNAPSHOT_OP_LT, MIN_LENGTH);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    for (size_t i = 0; i < words; ++i)
+    {
+        bitmap[i] &= scratch[i];
+    }
+
+    *count = column_snapshot_bitmap_count(bitmap, rows);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Time both forms of the query.
+ */
+static status run(
+    RCPR_SYM(allocator)* alloc, const secure_buffer* image, size_t repeats)
+{
+    status retval, release_retval;
+    store* st = NULL;
+    column_snapshot* snap = NULL;
+    uint64_t* bitmap = NULL;
+    uint64_t* scratch = NULL;
+    size_t record_count = 0, column_count = 0;
+    double start, record_time, column_time, build_time;
+
+    retval = store_create_from_buffer(&st, alloc, image, 0);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    start = now();
+    retval = column_snapshot_create(&snap, alloc, st);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_st;
+    }
+    build_time = now() - start;
+
+    size_t words =
+        COLUMN_SNAPSHOT_BITMAP_WORDS(column_snapshot_row_count_get(snap));
+    bitmap = (uint64_t*)malloc((words + 1) * sizeof(*bitmap));
+    scratch = (uint64_t*)malloc((words + 1) * sizeof(*scratch));
+    if (NULL == bitmap || NULL == scratch)
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_bitmaps;
+    }
+
+    start = now();
+    for (size_t i = 0; i < repeats; ++i)
+    {
+        retval = query_records(&record_count, st);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_bitmaps;
+        }
+    }
+    record_time = (now() - start) / repeats;
+
+    start = now();
+    for (size_t i = 0; i < repeats; ++i)
+    {
+        retval = query_columns(&column_count, snap, bitmap, scratch);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_bitmaps;
+        }
+    }
+    column_time = (now() - start) / repeats;
+
+    printf(
+        "%zu records, %zu selected (%zu by columns)\n",
+        store_record_count_get(st), record_count, column_count);
+    printf("snapshot build %10.3f ms\n", build_time * 1e3);
+    printf("record walk    %10.3f ms/query\n", record_time * 1e3);
+    printf(
+        "column scan    %10.3f ms/query  (%.1fx)\n", column_time * 1e3,
+        record_time / column_time);
+
+cleanup_bitmaps:
+    free(bitmap);
+    free(scratch);
+
+    release_retval = resource_release(column_snapshot_resource_handle(snap));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_st:
+    release_retval = resource_release(store_resource_handle(st));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+int main(int argc, char* argv[])
+{
+    status retval;
+    RCPR_SYM(allocator)* alloc = NULL;
+    secure_buffer* image = NULL;
+    size_t count = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1000000;
+    size_t repeats = (argc > 2) ? strtoul(argv[2], NULL, 10) : 20;
+
+    if (repeats < 1)
+    {
+        fprintf(stderr, "repeats must be at least 1\n");
+        return 1;
+    }
+
+    if (STATUS_SUCCESS != (retval = malloc_allocator_create(&alloc))
+     || STATUS_SUCCESS != (retval = image_create(&image, alloc, count))
+     || STATUS_SUCCESS != (retval = run(alloc, image, repeats))
+     || STATUS_SUCCESS
+            != (retval =
+                    resource_release(secure_buffer_resource_handle(image)))
+     || STATUS_SUCCESS
+            != (retval = resource_release(allocator_resource_handle(alloc))))
+    {
+        fprintf(
+            stderr, "benchmark failed with status 0x%x\n", (unsigned)retval);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,412 @@
+/**
+ * \file bench/derive/bench_derive.c
+ *
+ * \brief Compare the throughput of the modern, session, and legacy derivation
+ * paths.
+ *
+ * Usage: bench_derive [record_count [iterations [thread_count]]]
+ *
+ * The nepephemeral 0.x scheme is supplied by the caller of the library, so
+ * this benchmark stands in for it with a single SHA3-512 digest per record.
+ * This measures the overhead of the legacy path through the batch engine,
+ * which is what replaces a process launch per legacy record. The session path
+ * pays the PBKDF2 iterations once, when the session is set, and that cost is
+ * reported on its own. Finally, the KDF is calibrated on this host for the
+ * interactive and master setup latency targets.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/derive.h>
+#include <openssl/evp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Stand-in legacy scheme: hex of SHA3-512(master || hash id).
+ */
+static status legacy_standin(
+    void* context, secure_buffer** password, RCPR_SYM(allocator)* alloc,
+    const secure_buffer* master, const metadata* record)
+{
+    status retval;
+    const void* hash_id;
+    size_t hash_id_size, master_size, size;
+    uint8_t digest[64];
+    unsigned int digest_size;
+    uint32_t password_length;
+    static const char HEX[] = "0123456789abcdef";
+
+    (void)context;
+
+    if (STATUS_SUCCESS
+            != (retval = metadata_hash_id_get(&hash_id, &hash_id_size, record))
+     || STATUS_SUCCESS
+            != (retval =
+                    metadata_password_length_get(&password_length, record)))
+    {
+        return retval;
+    }
+
+    const void* master_data =
+        secure_buffer_data(&master_size, (secure_buffer*)master);
+
+    EVP_MD_CTX* md = EVP_MD_CTX_new();
+    if (NULL == md
+     || 1 != EVP_DigestInit_ex(md, EVP_sha3_512(), NULL)
+     || 1 != EVP_DigestUpdate(md, master_data, master_size)
+     || 1 != EVP_DigestUpdate(md, hash_id, hash_id_size)
+     || 1 != EVP_DigestFinal_ex(md, digest, &digest_size))
+    {
+        EVP_MD_CTX_free(md);
+        return ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    EVP_MD_CTX_free(md);
+
+    retval = secure_buffer_create(password, alloc, password_length);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    char* out = (char*)secure_buffer_data(&size, *password);
+    for (size_t i = 0; i < password_length; ++i)
+    {
+        out[i] = HEX[(digest[(i / 2) % sizeof(digest)] >> (4 * (i & 1))) & 15];
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Get the current monotonic time in seconds.
+ */
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * \brief Derive every record in batches and report the throughput.
+ */
+static status run(
+    const char* name, RCPR_SYM(allocator)* alloc, const derive_context* ctx,
+    metadata** records, size_t count, size_t thread_count)
+{
+    status retval;
+    secure_buffer** passwords = NULL;
+
+    retval =
+        allocator_allocate(
+            alloc, (void**)&passwords, count * sizeof(*passwords));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    double start = now();
+    retval =
+        derive_password_batch(
+            passwords, alloc, ctx, (const metadata* const*)records, count,
+            thread_count);
+    double elapsed = now() - start;
+
+    if (STATUS_SUCCESS == retval)
+    {
+        printf(
+            "%-8s threads=%-3zu records=%-8zu %10.1f records/s\n", name,
+            thread_count, count, count / elapsed);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            retval =
+                resource_release(secure_buffer_resource_handle(passwords[i]));
+            if (STATUS_SUCCESS != retval)
+            {
+                break;
+            }
+        }
+    }
+
+    if (STATUS_SUCCESS != allocator_reclaim(alloc, passwords))
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Create the benchmark records.
+ */
+static status records_create(
+    metadata** records, RCPR_SYM(allocator)* alloc, size_t count, bool legacy,
+    const char* kdf_name)
+{
+    status retval;
+    uint8_t hash_id[32];
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        memset(hash_id, 0, sizeof(hash_id));
+        memcpy(hash_id, &i, sizeof(i));
+
+        if (STATUS_SUCCESS
+                != (retval = metadata_create(&records[i], alloc))
+         || STATUS_SUCCESS
+                != (retval =
+                        metadata_hash_id_set(
+                            records[i], hash_id, sizeof(hash_id)))
+         || STATUS_SUCCESS != (retval = metadata_version_set(records[i], 1))
+         || STATUS_SUCCESS
+                != (retval = metadata_creation_date_set(records[i], i))
+         || STATUS_SUCCESS
+                != (retval = metadata_revocation_date_set(records[i], 0))
+         || STATUS_SUCCESS
+                != (retval = metadata_expiration_date_set(records[i], 0))
+         || STATUS_SUCCESS
+                != (retval = metadata_password_length_set(records[i], 20))
+         || STATUS_SUCCESS
+                != (retval = metadata_generation_set(records[i], 0))
+         || STATUS_SUCCESS
+                != (retval = metadata_legacy_flag_set(records[i], legacy))
+         || STATUS_SUCCESS
+                != (retval = metadata_kdf_name_set(records[i], kdf_name))
+         || STATUS_SUCCESS
+                != (retval =
+                        metadata_encoding_set(
+                            records[i],
+                            "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                            "abcdefghijklmnopqrstuvwxyz"
+                            "0123456789+/")))
+        {
+            return retval;
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Release the benchmark records.
+ */
+static void records_release(
+    RCPR_SYM(allocator)* alloc, metadata** records, size_t count)
+{
+    if (NULL == records)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < count && NULL != records[i]; ++i)
+    {
+        if (STATUS_SUCCESS
+                != resource_release(metadata_resource_handle(records[i])))
+        {
+            fprintf(stderr, "failed to release record %zu\n", i);
+        }
+    }
+
+    if (STATUS_SUCCESS != allocator_reclaim(alloc, records))
+    {
+        fprintf(stderr, "failed to reclaim the record array\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    status retval;
+    RCPR_SYM(allocator)* alloc = NULL;
+    derive_context* ctx = NULL;
+    secure_buffer* master = NULL;
+    metadata** modern = NULL;
+    metadata** legacy = NULL;
+    metadata** session = NULL;
+    secure_buffer* session_passphrase = NULL;
+    size_t size;
+    size_t count = (argc > 1) ? strtoul(argv[1], NULL, 10) : 256;
+    uint32_t iterations = (argc > 2) ? strtoul(argv[2], NULL, 10) : 10000;
+    size_t max_threads = (argc > 3) ? strtoul(argv[3], NULL, 10) : 4;
+    const char* MASTER = "benchmark master passphrase";
+    const char* SESSION = "benchmark session passphrase";
+
+    if (0 == count || 0 == iterations || 0 == max_threads)
+    {
+        fprintf(
+            stderr, "usage: %s [records [iterations [threads]]]\n", argv[0]);
+        return 1;
+    }
+
+    if (STATUS_SUCCESS != (retval = malloc_allocator_create(&alloc))
+     || STATUS_SUCCESS
+            != (retval = secure_buffer_create(&master, alloc, strlen(MASTER))))
+    {
+        goto fail;
+    }
+
+    memcpy(secure_buffer_data(&size, master), MASTER, strlen(MASTER));
+
+    retval = derive_context_create(&ctx, alloc, master, iterations);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto fail;
+    }
+
+    retval =
+        allocator_allocate(alloc, (void**)&modern, count * sizeof(*modern));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto fail;
+    }
+
+    memset(modern, 0, count * sizeof(*modern));
+
+    retval =
+        allocator_allocate(alloc, (void**)&legacy, count * sizeof(*legacy));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto fail;
+    }
+
+    memset(legacy, 0, count * sizeof(*legacy));
+
+    retval =
+        allocator_allocate(alloc, (void**)&session, count * sizeof(*session));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto fail;
+    }
+
+    memset(session, 0, count * sizeof(*session));
+
+    if (STATUS_SUCCESS
+            != (retval =
+                    records_create(
+                        modern, alloc, count, false,
+                        DERIVE_KDF_PBKDF2_SHA3_512))
+     || STATUS_SUCCESS
+            != (retval =
+                    records_create(
+                        legacy, alloc, count, true,
+                        DERIVE_KDF_PBKDF2_SHA3_512))
+     || STATUS_SUCCESS
+            != (retval =
+                    records_create(
+                        session, alloc, count, false,
+                        DERIVE_KDF_SESSION_HMAC_SHA3_512)))
+    {
+        goto fail;
+    }
+
+    derive_context_legacy_set(ctx, &legacy_standin, NULL);
+
+    /* the session stage runs once. */
+    retval =
+        secure_buffer_create(&session_passphrase, alloc, strlen(SESSION));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto fail;
+    }
+
+    memcpy(
+        secure_buffer_data(&size, session_passphrase), SESSION,
+        strlen(SESSION));
+
+    double start = now();
+    retval = derive_context_session_set(ctx, session_passphrase);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto fail;
+    }
+
+    printf("pbkdf2-sha3-512 iterations=%u\n", iterations);
+    printf("session stage %10.3f ms\n", (now() - start) * 1e3);
+    for (size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        if (STATUS_SUCCESS
+                != (retval = run("modern", alloc, ctx, modern, count, threads))
+         || STATUS_SUCCESS
+                != (retval =
+                        run("session", alloc, ctx, session, count, threads))
+         || STATUS_SUCCESS
+                != (retval = run("legacy", alloc, ctx, legacy, count, threads)))
+        {
+            goto fail;
+        }
+    }
+
+    /* pick the costs for the standard latency targets on this host. */
+    uint32_t interactive_cost, master_cost;
+    if (STATUS_SUCCESS
+            != (retval =
+                    derive_cost_calibrate(
+                        &interactive_cost, DERIVE_KDF_PBKDF2_SHA3_512,
+                        DERIVE_COST_TARGET_INTERACTIVE_USEC))
+     || STATUS_SUCCESS
+            != (retval =
+                    derive_cost_calibrate(
+                        &master_cost, DERIVE_KDF_SESSION_HMAC_SHA3_512,
+                        DERIVE_COST_TARGET_MASTER_USEC)))
+    {
+        goto fail;
+    }
+
+    printf(
+        "calibrated iterations: interactive %u (%u ms), master %u (%u ms)\n",
+        interactive_cost, DERIVE_COST_TARGET_INTERACTIVE_USEC / 1000,
+        master_cost, DERIVE_COST_TARGET_MASTER_USEC / 1000);
+
+    retval = STATUS_SUCCESS;
+
+fail:
+    if (STATUS_SUCCESS != retval)
+    {
+        fprintf(
+            stderr, "benchmark failed with status 0x%x\n", (unsigned)retval);
+    }
+
+    records_release(alloc, modern, count);
+    records_release(alloc, legacy, count);
+    records_release(alloc, session, count);
+
+    if (NULL != ctx
+     && STATUS_SUCCESS
+            != resource_release(derive_context_resource_handle(ctx)))
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    if (NULL != master
+     && STATUS_SUCCESS
+            != resource_release(secure_buffer_resource_handle(master)))
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    if (NULL != session_passphrase
+     && STATUS_SUCCESS
+            != resource_release(
+                    secure_buffer_resource_handle(session_passphrase)))
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    if (NULL != alloc
+     && STATUS_SUCCESS != resource_release(allocator_resource_handle(alloc)))
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    return (STATUS_SUCCESS == retval) ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+/**
+ * \file bench/metadata/bench_metadata_serial.c
+ *
+ * \brief Measure metadata record encode and decode throughput.
+ *
+ * Usage: bench_metadata_serial [iterations]
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/metadata.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Get the current monotonic time in seconds.
+ */
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * \brief Create the benchmark record.
+ */
+static status record_create(metadata** meta, RCPR_SYM(allocator)* alloc)
+{
+    status retval;
+    const uint8_t HASH_ID[32] = { 0x01, 0x02, 0x03, 0x04 };
+
+    if (STATUS_SUCCESS != (retval = metadata_create(meta, alloc))
+     || STATUS_SUCCESS
+            != (retval = metadata_hash_id_set(*meta, HASH_ID, sizeof(HASH_ID)))
+     || STATUS_SUCCESS != (retval = metadata_version_set(*meta, 1))
+     || STATUS_SUCCESS != (retval = metadata_creation_date_set(*meta, 1))
+     || STATUS_SUCCESS != (retval = metadata_revocation_date_set(*meta, 0))
+     || STATUS_SUCCESS != (retval = metadata_expiration_date_set(*meta, 2))
+     || STATUS_SUCCESS != (retval = metadata_password_length_set(*meta, 20))
+     || STATUS_SUCCESS != (retval = metadata_generation_set(*meta, 0))
+     || STATUS_SUCCESS != (retval = metadata_legacy_flag_set(*meta, false))
+     || STATUS_SUCCESS
+            != (retval = metadata_kdf_name_set(*meta, "pbkdf2-sha3-512"))
+     || STATUS_SUCCESS
+            != (retval = metadata_encoding_set(*meta, "0123456789abcdef")))
+    {
+        return retval;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+int main(int argc, char* argv[])
+{
+    status retval;
+    RCPR_SYM(allocator)* alloc = NULL;
+    metadata* meta = NULL;
+    metadata* copy = NULL;
+    secure_buffer* buffer = NULL;
+    size_t size;
+    size_t iterations = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1000000;
+    double start, encode_time = 0.0, decode_time = 0.0;
+
+    if (STATUS_SUCCESS != (retval = malloc_allocator_create(&alloc))
+     || STATUS_SUCCESS != (retval = record_create(&meta, alloc)))
+    {
+        goto fail;
+    }
+
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        start = now();
+        retval = metadata_to_buffer(&buffer, alloc, meta);
+        encode_time += now() - start;
+        if (STATUS_SUCCESS != retval)
+        {
+            goto fail;
+        }
+
+        const void* data = secure_buffer_data(&size, buffer);
+
+        start = now();
+        retval = metadata_from_data(&copy, alloc, data, size);
+        decode_time += now() - start;
+        if (STATUS_SUCCESS != retval)
+        {
+            goto fail;
+        }
+
+        if (STATUS_SUCCESS
+                != (retval = resource_release(metadata_resource_handle(copy)))
+         || STATUS_SUCCESS
+                != (retval =
+                        resource_release(
+                            secure_buffer_resource_handle(buffer))))
+        {
+            goto fail;
+        }
+    }
+
+    printf("encode: %8.1f ns/record\n", encode_time * 1e9 / iterations);
+    printf("decode: %8.1f ns/record\n", decode_time * 1e9 / iterations);
+
+    if (STATUS_SUCCESS
+            != (retval = resource_release(metadata_resource_handle(meta)))
+     || STATUS_SUCCESS
+            != (retval = resource_release(allocator_resource_handle(alloc))))
+    {
+        goto fail;
+    }
+
+    return 0;
+
+fail:
+    fprintf(stderr, "benchmark failed with status 0x%x\n", (unsigned)retval);
+    return 1;
+}
@@ -0,0 +1,300 @@
+/**
+ * \file bench/secure_buffer/bench_secure_buffer_cache.c
+ *
+ * \brief Measure secure buffer creation and record parsing under contention,
+ * with and without a secure buffer cache, across a sweep of thread counts.
+ *
+ * Usage: bench_secure_buffer_cache [max threads] [operations per thread]
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/metadata.h>
+#include <nepe2/secure_buffer.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief The number of buffers each thread keeps alive at once.
+ */
+#define BENCH_WINDOW_SIZE                                                   16
+
+/**
+ * \brief The state of one benchmark thread.
+ */
+typedef struct bench_context bench_context;
+
+struct bench_context
+{
+    RCPR_SYM(allocator)* alloc;
+    const void* record;
+    size_t record_size;
+    size_t operations;
+    status retval;
+};
+
+/**
+ * \brief Get the current monotonic time in seconds.
+ */
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * \brief Create the benchmark record.
+ */
+static status record_create(metadata** meta, RCPR_SYM(allocator)* alloc)
+{
+    status retval;
+    const uint8_t HASH_ID[32] = { 0x01, 0x02, 0x03, 0x04 };
+
+    if (STATUS_SUCCESS != (retval = metadata_create(meta, alloc))
+     || STATUS_SUCCESS
+            != (retval = metadata_hash_id_set(*meta, HASH_ID, sizeof(HASH_ID)))
+     || STATUS_SUCCESS != (retval = metadata_version_set(*meta, 1))
+     || STATUS_SUCCESS != (retval = metadata_creation_date_set(*meta, 1))
+     || STATUS_SUCCESS != (retval = metadata_revocation_date_set(*meta, 0))
+     || STATUS_SUCCESS != (retval = metadata_expiration_date_set(*meta, 2))
+     || STATUS_SUCCESS != (retval = metadata_password_length_set(*meta, 20))
+     || STATUS_SUCCESS != (retval = metadata_generation_set(*meta, 0))
+     || STATUS_SUCCESS != (retval = metadata_legacy_flag_set(*meta, false))
+     || STATUS_SUCCESS
+            != (retval = metadata_kdf_name_set(*meta, "pbkdf2-sha3-512"))
+     || STATUS_SUCCESS
+            != (retval = metadata_encoding_set(*meta, "0123456789abcdef")))
+    {
+        return retval;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Create and release secure buffers of mixed sizes, keeping a small
+ * window of them alive.
+ */
+static void* buffer_worker(void* arg)
+{
+    bench_context* ctx = (bench_context*)arg;
+    secure_buffer* window[BENCH_WINDOW_SIZE] = { NULL };
+    size_t size;
+
+    ctx->retval = STATUS_SUCCESS;
+    for (size_t i = 0; i < ctx->operations; ++i)
+    {
+        secure_buffer** slot = &window[i % BENCH_WINDOW_SIZE];
+
+        if (NULL != *slot)
+        {
+            ctx->retval =
+                resource_release(secure_buffer_resource_handle(*slot));
+            *slot = NULL;
+            if (STATUS_SUCCESS != ctx->retval)
+            {
+                break;
+            }
+        }
+
+        ctx->retval = secure_buffer_create(slot, ctx->alloc, 16 + (i % 241));
+        if (STATUS_SUCCESS != ctx->retval)
+        {
+            break;
+        }
+
+        memset(secure_buffer_data(&size, *slot), 0x5a, 16);
+    }
+
+    for (size_t i = 0; i < BENCH_WINDOW_SIZE; ++i)
+    {
+        if (NULL != window[i])
+        {
+            status retval =
+                resource_release(secure_buffer_resource_handle(window[i]));
+            if (STATUS_SUCCESS != retval)
+            {
+                ctx->retval = retval;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Parse and release a serialized record.
+ */
+static void* parse_worker(void* arg)
+{
+    bench_context* ctx = (bench_context*)arg;
+    metadata* meta;
+
+    ctx->retval = STATUS_SUCCESS;
+    for (size_t i = 0; i < ctx->operations; ++i)
+    {
+        ctx->retval =
+            metadata_from_data(
+                &meta, ctx->alloc, ctx->record, ctx->record_size);
+        if (STATUS_SUCCESS != ctx->retval)
+        {
+            break;
+        }
+
+        ctx->retval = resource_release(metadata_resource_handle(meta));
+        if (STATUS_SUCCESS != ctx->retval)
+        {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Run a worker on the given number of threads.
+ *
+ * \returns the total operations per second, or a negative value on failure.
+ */
+static double run(
+    void* (*worker)(void*), bench_context* proto, size_t thread_count)
+{
+    pthread_t threads[64];
+    bench_context contexts[64];
+    bool failed = false;
+    double start = now();
+
+    for (size_t i = 0; i < thread_count; ++i)
+    {
+        contexts[i] = *proto;
+        pthread_create(&threads[i], NULL, worker, &contexts[i]);
+    }
+
+    for (size_t i = 0; i < thread_count; ++i)
+    {
+        pthread_join(threads[i], NULL);
+        if (STATUS_SUCCESS != contexts[i].retval)
+        {
+            proto->retval = contexts[i].retval;
+            failed = true;
+        }
+    }
+
+    if (failed)
+    {
+        return -1.0;
+    }
+
+    return thread_count * proto->operations / (now() - start);
+}
+
+int main(int argc, char* argv[])
+{
+    status retval;
+    RCPR_SYM(allocator)* alloc = NULL;
+    secure_buffer_cache* cache = NULL;
+    metadata* meta = NULL;
+    secure_buffer* record = NULL;
+    bench_context proto;
+    size_t max_threads = (argc > 1) ? strtoul(argv[1], NULL, 10) : 16;
+    size_t operations = (argc > 2) ? strtoul(argv[2], NULL, 10) : 200000;
+    double results[2][2][7];
+    size_t sweep = 0;
+
+    if (max_threads < 1 || max_threads > 64)
+    {
+        fprintf(stderr, "max threads must be between 1 and 64\n");
+        return 1;
+    }
+
+    if (STATUS_SUCCESS != (retval = malloc_allocator_create(&alloc))
+     || STATUS_SUCCESS != (retval = record_create(&meta, alloc))
+     || STATUS_SUCCESS
+            != (retval = metadata_to_buffer(&record, alloc, meta)))
+    {
+        goto fail;
+    }
+
+    proto.alloc = alloc;
+    proto.record = secure_buffer_data(&proto.record_size, record);
+    proto.operations = operations;
+    proto.retval = STATUS_SUCCESS;
+
+    /* sweep without the cache, and then with it. */
+    for (int cached = 0; cached < 2; ++cached)
+    {
+        if (cached)
+        {
+            retval = secure_buffer_cache_create(&cache, alloc);
+            if (STATUS_SUCCESS != retval)
+            {
+                goto fail;
+            }
+        }
+
+        sweep = 0;
+        for (size_t threads = 1; threads <= max_threads; threads *= 2)
+        {
+            results[cached][0][sweep] = run(&buffer_worker, &proto, threads);
+            results[cached][1][sweep] = run(&parse_worker, &proto, threads);
+            if (results[cached][0][sweep] < 0
+             || results[cached][1][sweep] < 0)
+            {
+                retval = proto.retval;
+                goto fail;
+            }
+
+            ++sweep;
+        }
+
+        if (cached)
+        {
+            retval =
+                resource_release(secure_buffer_cache_resource_handle(cache));
+            if (STATUS_SUCCESS != retval)
+            {
+                goto fail;
+            }
+        }
+    }
+
+    printf(
+        "threads  %14s %14s  %14s %14s\n", "buffers/s", "cached", "parses/s",
+        "cached");
+    sweep = 0;
+    for (size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        printf(
+            "%7zu  %14.0f %14.0f  %14.0f %14.0f\n", threads,
+            results[0][0][sweep], results[1][0][sweep], results[0][1][sweep],
+            results[1][1][sweep]);
+        ++sweep;
+    }
+
+    if (STATUS_SUCCESS
+            != (retval =
+                    resource_release(secure_buffer_resource_handle(record)))
+     || STATUS_SUCCESS
+            != (retval = resource_release(metadata_resource_handle(meta)))
+     || STATUS_SUCCESS
+            != (retval = resource_release(allocator_resource_handle(alloc))))
+    {
+        goto fail;
+    }
+
+    return 0;
+
+fail:
+    fprintf(stderr, "benchmark failed with status 0x%x\n", (unsigned)retval);
+    return 1;
+}
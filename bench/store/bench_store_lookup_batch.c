@@ -0,0 +1,268 @@
+/**
+ * \file bench/store/bench_store_lookup_batch.c
+ *
+ * \brief Compare random lookups in a large store made one at a time with the
+ * same lookups made in batches.
+ *
+ * Usage: bench_store_lookup_batch [records] [lookups] [batch]
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <nepe2/store.h>
+#include <rcpr/socket_utilities.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Get the current monotonic time in seconds.
+ */
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * \brief Spread a record number over a hash id.
+ */
+static void hash_id_make(uint8_t* hash_id, uint64_t id)
+{
+    uint64_t z = id + 0x9e3779b97f4a7c15;
+
+    memset(hash_id, 0, 32);
+    for (int i = 0; i < 4; ++i)
+    {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        z ^= z >> 31;
+        memcpy(hash_id + 8 * i, &z, sizeof(z));
+    }
+}
+
+/**
+ * \brief Build a store image of records with scattered hash ids.
+ */
+static status image_create(
+    secure_buffer** image, RCPR_SYM(allocator)* alloc, size_t count)
+{
+    status retval, release_retval;
+    secure_buffer_builder* builder = NULL;
+    uint32_t header[4] = {
+        socket_utility_hton32(STORE_MAGIC),
+        socket_utility_hton32(STORE_FORMAT_VERSION_1), 0, 0 };
+    uint8_t hash_id[32];
+
+    retval = secure_buffer_builder_create(&builder, alloc, 0);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = secure_buffer_builder_append(builder, header, sizeof(header));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_builder;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        metadata* meta = NULL;
+        secure_buffer* record = NULL;
+        const void* data;
+        size_t size;
+        uint32_t net_size;
+
+        hash_id_make(hash_id, i);
+        if (STATUS_SUCCESS != (retval = metadata_create(&meta, alloc)))
+        {
+            goto cleanup_builder;
+        }
+
+        if (STATUS_SUCCESS
+                != (retval =
+                        metadata_hash_id_set(meta, hash_id, sizeof(hash_id)))
+         || STATUS_SUCCESS != (retval = metadata_version_set(meta, 1))
+         || STATUS_SUCCESS != (retval = metadata_creation_date_set(meta, 1))
+         || STATUS_SUCCESS != (retval = metadata_revocation_date_set(meta, 0))
+         || STATUS_SUCCESS != (retval = metadata_expiration_date_set(meta, 2))
+         || STATUS_SUCCESS
+                != (retval = metadata_password_length_set(meta, 20))
+         || STATUS_SUCCESS != (retval = metadata_generation_set(meta, 0))
+         || STATUS_SUCCESS != (retval = metadata_legacy_flag_set(meta, false))
+         || STATUS_SUCCESS
+                != (retval = metadata_kdf_name_set(meta, "pbkdf2-sha3-512"))
+         || STATUS_SUCCESS
+                != (retval = metadata_encoding_set(meta, "0123456789abcdef"))
+         || STATUS_SUCCESS
+                != (retval = metadata_to_buffer(&record, alloc, meta)))
+        {
+            release_retval = resource_release(metadata_resource_handle(meta));
+            (void)release_retval;
+            goto cleanup_builder;
+        }
+
+        data = secure_buffer_data(&size, record);
+        net_size = socket_utility_hton32((uint32_t)size);
+        if (STATUS_SUCCESS
+                != (retval =
+                        secure_buffer_builder_append(
+                            builder, &net_size, sizeof(net_size)))
+         || STATUS_SUCCESS
+                != (retval = secure_buffer_builder_append(builder, data, size))
+         || STATUS_SUCCESS
+                != (retval =
+                        resource_release(secure_buffer_resource_handle(record)))
+         || STATUS_SUCCESS
+                != (retval = resource_release(metadata_resource_handle(meta))))
+        {
+            goto cleanup_builder;
+        }
+    }
+
+    retval = secure_buffer_builder_finalize(image, builder);
+
+cleanup_builder:
+    release_retval =
+        resource_release(secure_buffer_builder_resource_handle(builder));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Time the same random lookups made singly and in batches.
+ */
+static status run(
+    RCPR_SYM(allocator)* alloc, const secure_buffer* image, size_t count,
+    size_t lookups, size_t batch)
+{
+    status retval, release_retval;
+    store* st = NULL;
+    const metadata* meta;
+    uint8_t* hash_ids;
+    const void** ids;
+    size_t* sizes;
+    const metadata** found;
+    size_t found_count = 0;
+    double start, single_time, batch_time;
+
+    retval = store_create_from_buffer(&st, alloc, image, 0);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* every lookup is of a random record. */
+    hash_ids = (uint8_t*)malloc(lookups * 32);
+    ids = (const void**)malloc(lookups * sizeof(*ids));
+    sizes = (size_t*)malloc(lookups * sizeof(*sizes));
+    found = (const metadata**)malloc(batch * sizeof(*found));
+    if (NULL == hash_ids || NULL == ids || NULL == sizes || NULL == found)
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_arrays;
+    }
+
+    srand(1);
+    for (size_t i = 0; i < lookups; ++i)
+    {
+        hash_id_make(
+            hash_ids + 32 * i, ((size_t)rand() * RAND_MAX + rand()) % count);
+        ids[i] = hash_ids + 32 * i;
+        sizes[i] = 32;
+    }
+
+    start = now();
+    for (size_t i = 0; i < lookups; ++i)
+    {
+        retval = store_lookup(&meta, st, ids[i], sizes[i]);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_arrays;
+        }
+    }
+    single_time = now() - start;
+
+    start = now();
+    for (size_t i = 0; i < lookups; i += batch)
+    {
+        size_t n = (lookups - i < batch) ? lookups - i : batch;
+
+        found_count += store_lookup_batch(found, st, ids + i, sizes + i, n);
+    }
+    batch_time = now() - start;
+
+    if (lookups != found_count)
+    {
+        retval = ERROR_STORE_RECORD_NOT_FOUND;
+        goto cleanup_arrays;
+    }
+
+    printf(
+        "single  %8.1f ns/lookup\n"
+        "batched %8.1f ns/lookup  (%zu per batch, %.2fx)\n",
+        single_time * 1e9 / lookups, batch_time * 1e9 / lookups, batch,
+        single_time / batch_time);
+
+cleanup_arrays:
+    free(found);
+    free(sizes);
+    free(ids);
+    free(hash_ids);
+
+    release_retval = resource_release(store_resource_handle(st));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+int main(int argc, char* argv[])
+{
+    status retval;
+    RCPR_SYM(allocator)* alloc = NULL;
+    secure_buffer* image = NULL;
+    size_t count = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1000000;
+    size_t lookups = (argc > 2) ? strtoul(argv[2], NULL, 10) : 2000000;
+    size_t batch = (argc > 3) ? strtoul(argv[3], NULL, 10) : 256;
+
+    if (count < 1 || batch < 1)
+    {
+        fprintf(stderr, "records and batch must be at least 1\n");
+        return 1;
+    }
+
+    if (STATUS_SUCCESS != (retval = malloc_allocator_create(&alloc))
+     || STATUS_SUCCESS != (retval = image_create(&image, alloc, count))
+     || STATUS_SUCCESS
+            != (retval = run(alloc, image, count, lookups, batch))
+     || STATUS_SUCCESS
+            != (retval =
+                    resource_release(secure_buffer_resource_handle(image)))
+     || STATUS_SUCCESS
+            != (retval = resource_release(allocator_resource_handle(alloc))))
+    {
+        fprintf(
+            stderr, "benchmark failed with status 0x%x\n", (unsigned)retval);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,287 @@
+/**
+ * \file bench/store/bench_store_pages.c
+ *
+ * \brief Compare random lookups in a large store whose tables use ordinary
+ * pages, transparent huge pages, and explicit huge pages, reporting the data
+ * TLB misses of each where the kernel exposes them.
+ *
+ * Usage: bench_store_pages [records] [lookups]
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <linux/perf_event.h>
+#include <nepe2/store.h>
+#include <rcpr/socket_utilities.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Get the current monotonic time in seconds.
+ */
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * \brief Spread a record number over a hash id.
+ */
+static void hash_id_make(uint8_t* hash_id, uint64_t id)
+{
+    uint64_t z = id + 0x9e3779b97f4a7c15;
+
+    memset(hash_id, 0, 32);
+    for (int i = 0; i < 4; ++i)
+    {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        z ^= z >> 31;
+        memcpy(hash_id + 8 * i, &z, sizeof(z));
+    }
+}
+
+/**
+ * \brief Open a counter of data TLB read misses in user space for this
+ * thread.
+ *
+ * \returns the counter, or -1 if the kernel does not expose it.
+ */
+static int tlb_counter_open(void)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.size = sizeof(attr);
+    attr.config =
+        PERF_COUNT_HW_CACHE_DTLB
+      | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+      | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/**
+ * \brief Build a store image of records with scattered hash ids.
+ */
+static status image_create(
+    secure_buffer** image, RCPR_SYM(allocator)* alloc, size_t count)
+{
+    status retval, release_retval;
+    secure_buffer_builder* builder = NULL;
+    uint32_t header[4] = {
+        socket_utility_hton32(STORE_MAGIC),
+        socket_utility_hton32(STORE_FORMAT_VERSION_1), 0, 0 };
+    uint8_t hash_id[32];
+
+    retval = secure_buffer_builder_create(&builder, alloc, 0);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = secure_buffer_builder_append(builder, header, sizeof(header));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_builder;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        metadata* meta = NULL;
+        secure_buffer* record = NULL;
+        const void* data;
+        size_t size;
+        uint32_t net_size;
+
+        hash_id_make(hash_id, i);
+        if (STATUS_SUCCESS != (retval = metadata_create(&meta, alloc)))
+        {
+            goto cleanup_builder;
+        }
+
+        if (STATUS_SUCCESS
+                != (retval =
+                        metadata_hash_id_set(meta, hash_id, sizeof(hash_id)))
+         || STATUS_SUCCESS != (retval = metadata_version_set(meta, 1))
+         || STATUS_SUCCESS != (retval = metadata_creation_date_set(meta, 1))
+         || STATUS_SUCCESS != (retval = metadata_revocation_date_set(meta, 0))
+         || STATUS_SUCCESS != (retval = metadata_expiration_date_set(meta, 2))
+         || STATUS_SUCCESS
+                != (retval = metadata_password_length_set(meta, 20))
+         || STATUS_SUCCESS != (retval = metadata_generation_set(meta, 0))
+         || STATUS_SUCCESS != (retval = metadata_legacy_flag_set(meta, false))
+         || STATUS_SUCCESS
+                != (retval = metadata_kdf_name_set(meta, "pbkdf2-sha3-512"))
+         || STATUS_SUCCESS
+                != (retval = metadata_encoding_set(meta, "0123456789abcdef"))
+         || STATUS_SUCCESS
+                != (retval = metadata_to_buffer(&record, alloc, meta)))
+        {
+            release_retval = resource_release(metadata_resource_handle(meta));
+            (void)release_retval;
+            goto cleanup_builder;
+        }
+
+        data = secure_buffer_data(&size, record);
+        net_size = socket_utility_hton32((uint32_t)size);
+        if (STATUS_SUCCESS
+                != (retval =
+                        secure_buffer_builder_append(
+                            builder, &net_size, sizeof(net_size)))
+         || STATUS_SUCCESS
+                != (retval = secure_buffer_builder_append(builder, data, size))
+         || STATUS_SUCCESS
+                != (retval =
+                        resource_release(secure_buffer_resource_handle(record)))
+         || STATUS_SUCCESS
+                != (retval = resource_release(metadata_resource_handle(meta))))
+        {
+            goto cleanup_builder;
+        }
+    }
+
+    retval = secure_buffer_builder_finalize(image, builder);
+
+cleanup_builder:
+    release_retval =
+        resource_release(secure_buffer_builder_resource_handle(builder));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Load the image with the given flags, and time random lookups.
+ */
+static status run(
+    RCPR_SYM(allocator)* alloc, const secure_buffer* image, size_t count,
+    size_t lookups, uint32_t flags, const char* name)
+{
+    status retval, release_retval;
+    store* st = NULL;
+    const metadata* meta;
+    uint8_t hash_id[32];
+    uint64_t misses = 0;
+    int counter;
+    double start, elapsed;
+    static const char* MODE_NAMES[] = { "default", "transparent", "hugetlb" };
+
+    retval = store_create_from_buffer_with_flags(&st, alloc, image, 0, flags);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    counter = tlb_counter_open();
+    if (counter >= 0)
+    {
+        ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+        ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    srand(1);
+    start = now();
+    for (size_t i = 0; i < lookups; ++i)
+    {
+        hash_id_make(hash_id, ((size_t)rand() * RAND_MAX + rand()) % count);
+        retval = store_lookup(&meta, st, hash_id, sizeof(hash_id));
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_st;
+        }
+    }
+    elapsed = now() - start;
+
+    if (counter >= 0)
+    {
+        ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+        if (sizeof(misses) != read(counter, &misses, sizeof(misses)))
+        {
+            misses = 0;
+        }
+        close(counter);
+    }
+
+    printf(
+        "%-12s (%-11s) %8.1f ns/lookup", name,
+        MODE_NAMES[store_page_mode_get(st)], elapsed * 1e9 / lookups);
+    if (counter >= 0)
+    {
+        printf("  %8.3f dTLB misses/lookup\n", (double)misses / lookups);
+    }
+    else
+    {
+        printf("  dTLB misses n/a\n");
+    }
+
+cleanup_st:
+    release_retval = resource_release(store_resource_handle(st));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+int main(int argc, char* argv[])
+{
+    status retval;
+    RCPR_SYM(allocator)* alloc = NULL;
+    secure_buffer* image = NULL;
+    size_t count = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1000000;
+    size_t lookups = (argc > 2) ? strtoul(argv[2], NULL, 10) : 2000000;
+
+    if (count < 1)
+    {
+        fprintf(stderr, "records must be at least 1\n");
+        return 1;
+    }
+
+    if (STATUS_SUCCESS != (retval = malloc_allocator_create(&alloc))
+     || STATUS_SUCCESS != (retval = image_create(&image, alloc, count))
+     || STATUS_SUCCESS
+            != (retval = run(alloc, image, count, lookups, 0, "ordinary"))
+     || STATUS_SUCCESS
+            != (retval =
+                    run(alloc, image, count, lookups,
+                        STORE_LOAD_FLAG_HUGE_PAGES, "huge pages"))
+     || STATUS_SUCCESS
+            != (retval =
+                    run(alloc, image, count, lookups, STORE_LOAD_FLAG_HUGETLB,
+                        "hugetlb"))
+     || STATUS_SUCCESS
+            != (retval =
+                    resource_release(secure_buffer_resource_handle(image)))
+     || STATUS_SUCCESS
+            != (retval = resource_release(allocator_resource_handle(alloc))))
+    {
+        fprintf(
+            stderr, "benchmark failed with status 0x%x\n", (unsigned)retval);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,182 @@
+/**
+ * \file bench/store_file/bench_store_file.c
+ *
+ * \brief Compare the store file backends on batched small reads and synced
+ * appends.
+ *
+ * Usage: bench_store_file [path] [batches]
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/store_file.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief The number of records in each append or read batch.
+ */
+#define BATCH_SIZE 32
+
+/**
+ * \brief Get the current monotonic time in seconds.
+ */
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * \brief Create the benchmark record.
+ */
+static status record_create(metadata** meta, RCPR_SYM(allocator)* alloc)
+{
+    status retval;
+    const uint8_t HASH_ID[32] = { 0x01, 0x02, 0x03, 0x04 };
+
+    if (STATUS_SUCCESS != (retval = metadata_create(meta, alloc))
+     || STATUS_SUCCESS
+            != (retval = metadata_hash_id_set(*meta, HASH_ID, sizeof(HASH_ID)))
+     || STATUS_SUCCESS != (retval = metadata_version_set(*meta, 1))
+     || STATUS_SUCCESS != (retval = metadata_creation_date_set(*meta, 1))
+     || STATUS_SUCCESS != (retval = metadata_revocation_date_set(*meta, 0))
+     || STATUS_SUCCESS != (retval = metadata_expiration_date_set(*meta, 2))
+     || STATUS_SUCCESS != (retval = metadata_password_length_set(*meta, 20))
+     || STATUS_SUCCESS != (retval = metadata_generation_set(*meta, 0))
+     || STATUS_SUCCESS != (retval = metadata_legacy_flag_set(*meta, false))
+     || STATUS_SUCCESS
+            != (retval = metadata_kdf_name_set(*meta, "pbkdf2-sha3-512"))
+     || STATUS_SUCCESS
+            != (retval = metadata_encoding_set(*meta, "0123456789abcdef")))
+    {
+        return retval;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Run the benchmark against one backend.
+ */
+static status run(
+    RCPR_SYM(allocator)* alloc, const char* path, uint32_t flags,
+    const metadata* const* records, size_t batches)
+{
+    status retval, release_retval;
+    store_file* sf = NULL;
+    store_file_read_request requests[BATCH_SIZE];
+    uint8_t data[BATCH_SIZE][64];
+    double start, append_time, read_time;
+
+    unlink(path);
+    retval = store_file_open(&sf, alloc, path, STORE_FILE_FLAG_CREATE | flags);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* synced appends of small batches. */
+    start = now();
+    for (size_t i = 0; i < batches; ++i)
+    {
+        retval = store_file_append(sf, records, BATCH_SIZE, true);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_sf;
+        }
+    }
+    append_time = now() - start;
+
+    /* batches of small reads scattered over the image. */
+    uint64_t span = store_file_size_get(sf) - sizeof(data[0]);
+    srand(1);
+    start = now();
+    for (size_t i = 0; i < batches * 16; ++i)
+    {
+        for (size_t j = 0; j < BATCH_SIZE; ++j)
+        {
+            requests[j].offset = (uint64_t)rand() % span;
+            requests[j].size = sizeof(data[j]);
+            requests[j].data = data[j];
+        }
+
+        retval = store_file_read_batch(sf, requests, BATCH_SIZE);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_sf;
+        }
+    }
+    read_time = now() - start;
+
+    printf(
+        "%-8s append: %8.1f ns/record  read: %8.1f ns/read\n",
+        STORE_FILE_BACKEND_IO_URING == store_file_backend_get(sf)
+            ? "io_uring" : "pread",
+        append_time * 1e9 / (batches * BATCH_SIZE),
+        read_time * 1e9 / (batches * 16 * BATCH_SIZE));
+
+cleanup_sf:
+    release_retval = resource_release(store_file_resource_handle(sf));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    unlink(path);
+
+    return retval;
+}
+
+int main(int argc, char* argv[])
+{
+    status retval;
+    RCPR_SYM(allocator)* alloc = NULL;
+    metadata* meta = NULL;
+    const metadata* records[BATCH_SIZE];
+    const char* path = (argc > 1) ? argv[1] : "bench_store_file.img";
+    size_t batches = (argc > 2) ? strtoul(argv[2], NULL, 10) : 1000;
+
+    if (STATUS_SUCCESS != (retval = malloc_allocator_create(&alloc))
+     || STATUS_SUCCESS != (retval = record_create(&meta, alloc)))
+    {
+        goto fail;
+    }
+
+    for (size_t i = 0; i < BATCH_SIZE; ++i)
+    {
+        records[i] = meta;
+    }
+
+    if (STATUS_SUCCESS != (retval = run(alloc, path, 0, records, batches))
+     || STATUS_SUCCESS
+            != (retval =
+                    run(alloc, path, STORE_FILE_FLAG_IO_URING, records,
+                        batches)))
+    {
+        goto fail;
+    }
+
+    if (STATUS_SUCCESS
+            != (retval = resource_release(metadata_resource_handle(meta)))
+     || STATUS_SUCCESS
+            != (retval = resource_release(allocator_resource_handle(alloc))))
+    {
+        goto fail;
+    }
+
+    return 0;
+
+fail:
+    fprintf(stderr, "benchmark failed with status 0x%x\n", (unsigned)retval);
+    return 1;
+}
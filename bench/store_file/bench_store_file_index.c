@@ -0,0 +1,353 @@
+/**
+ * \file bench/store_file/bench_store_file_index.c
+ *
+ * \brief Compare a compacted store image loaded with its perfect hash index
+ * against the same image loaded by building the hash id index.
+ *
+ * Usage: bench_store_file_index [path] [records] [repeats]
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/store_file.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief The number of records in each append.
+ */
+#define BATCH_SIZE 1024
+
+/**
+ * \brief Get the current monotonic time in seconds.
+ */
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * \brief Set the hash id for the given record id.
+ */
+static void hash_id_init(uint8_t* hash_id, uint64_t id)
+{
+    memset(hash_id, 0, 32);
+    memcpy(hash_id, &id, sizeof(id));
+}
+
+/**
+ * \brief Create a record with the given id.
+ */
+static status record_create(
+    metadata** meta, RCPR_SYM(allocator)* alloc, uint64_t id)
+{
+    status retval;
+    uint8_t hash_id[32];
+
+    hash_id_init(hash_id, id);
+    if (STATUS_SUCCESS != (retval = metadata_create(meta, alloc))
+     || STATUS_SUCCESS
+            != (retval = metadata_hash_id_set(*meta, hash_id, sizeof(hash_id)))
+     || STATUS_SUCCESS != (retval = metadata_version_set(*meta, 1))
+     || STATUS_SUCCESS != (retval = metadata_creation_date_set(*meta, 1))
+     || STATUS_SUCCESS != (retval = metadata_revocation_date_set(*meta, 0))
+     || STATUS_SUCCESS != (retval = metadata_expiration_date_set(*meta, 2))
+     || STATUS_SUCCESS != (retval = metadata_password_length_set(*meta, 20))
+     || STATUS_SUCCESS != (retval = metadata_generation_set(*meta, 0))
+     || STATUS_SUCCESS != (retval = metadata_legacy_flag_set(*meta, false))
+     || STATUS_SUCCESS
+            != (retval = metadata_kdf_name_set(*meta, "pbkdf2-sha3-512"))
+     || STATUS_SUCCESS
+            != (retval = metadata_encoding_set(*meta, "0123456789abcdef")))
+    {
+        return retval;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Write a store image with the given number of records.
+ */
+static status image_create(
+    RCPR_SYM(allocator)* alloc, const char* path, size_t count)
+{
+    status retval, release_retval;
+    store_file* sf = NULL;
+    metadata* records[BATCH_SIZE];
+
+    unlink(path);
+    retval = store_file_open(&sf, alloc, path, STORE_FILE_FLAG_CREATE);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    for (size_t begin = 0; begin < count; begin += BATCH_SIZE)
+    {
+        size_t batch =
+            (count - begin < BATCH_SIZE) ? count - begin : BATCH_SIZE;
+        size_t created = 0;
+
+        for (; created < batch; ++created)
+        {
+            retval = record_create(&records[created], alloc, begin + created);
+            if (STATUS_SUCCESS != retval)
+            {
+                break;
+            }
+        }
+
+        if (STATUS_SUCCESS == retval)
+        {
+            retval =
+                store_file_append(
+                    sf, (const metadata* const*)records, batch, false);
+        }
+
+        for (size_t i = 0; i < created; ++i)
+        {
+            release_retval =
+                resource_release(metadata_resource_handle(records[i]));
+            if (STATUS_SUCCESS != release_retval)
+            {
+                retval = release_retval;
+            }
+        }
+
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_sf;
+        }
+    }
+
+    retval = store_file_sync(sf);
+
+cleanup_sf:
+    release_retval = resource_release(store_file_resource_handle(sf));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Load the image at the given path, and look up every record in a
+ * shuffled order.
+ */
+static status run(
+    RCPR_SYM(allocator)* alloc, const char* path, const char* label,
+    const uint64_t* order, size_t count, size_t repeats)
+{
+    status retval, release_retval;
+    store_file* sf = NULL;
+    secure_buffer* image = NULL;
+    store* st = NULL;
+    const metadata* found;
+    uint8_t hash_id[32];
+    double start, elapsed, load_time = 0, lookup_time;
+
+    if (STATUS_SUCCESS
+            != (retval = store_file_open(&sf, alloc, path, 0))
+     || STATUS_SUCCESS
+            != (retval = store_file_image_read(&image, alloc, sf)))
+    {
+        goto cleanup_sf;
+    }
+
+    /* keep the fastest load, so that the first touch of the heap does not
+     * count against one index. */
+    for (size_t r = 0; r < repeats; ++r)
+    {
+        start = now();
+        retval = store_create_from_buffer(&st, alloc, image, 0);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_image;
+        }
+        elapsed = now() - start;
+
+        if (0 == r || elapsed < load_time)
+        {
+            load_time = elapsed;
+        }
+
+        if (r + 1 < repeats)
+        {
+            retval = resource_release(store_resource_handle(st));
+            if (STATUS_SUCCESS != retval)
+            {
+                goto cleanup_image;
+            }
+        }
+    }
+
+    start = now();
+    for (size_t r = 0; r < repeats; ++r)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            hash_id_init(hash_id, order[i]);
+            retval = store_lookup(&found, st, hash_id, sizeof(hash_id));
+            if (STATUS_SUCCESS != retval)
+            {
+                goto cleanup_st;
+            }
+        }
+    }
+    lookup_time = (now() - start) / (repeats * (double)count);
+
+    printf(
+        "%-12s load %10.3f ms  lookup %8.1f ns\n", label, load_time * 1e3,
+        lookup_time * 1e9);
+
+cleanup_st:
+    release_retval = resource_release(store_resource_handle(st));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_image:
+    release_retval = resource_release(secure_buffer_resource_handle(image));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_sf:
+    if (NULL != sf)
+    {
+        release_retval = resource_release(store_file_resource_handle(sf));
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Compact the image with and without a perfect hash index, and compare
+ * the two.
+ */
+static status compare(
+    RCPR_SYM(allocator)* alloc, const char* path, size_t count,
+    size_t repeats)
+{
+    status retval;
+    store_file_compact_stats stats;
+    store_file_compact_options options = { 0, 0, 0, 0, 0 };
+    uint64_t* order;
+    size_t capacity = 16;
+
+    order = (uint64_t*)malloc((count + 1) * sizeof(*order));
+    if (NULL == order)
+    {
+        return ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    /* look records up in a shuffled order, so that the cache does not help. */
+    srand(1);
+    for (size_t i = 0; i < count; ++i)
+    {
+        order[i] = i;
+    }
+    for (size_t i = count; i > 1; --i)
+    {
+        size_t j = (size_t)rand() % i;
+        uint64_t tmp = order[i - 1];
+        order[i - 1] = order[j];
+        order[j] = tmp;
+    }
+
+    options.flags = STORE_FILE_COMPACT_FLAG_PERFECT_HASH;
+    if (STATUS_SUCCESS
+            != (retval = store_file_compact(&stats, alloc, path, &options))
+     || STATUS_SUCCESS
+            != (retval =
+                    run(alloc, path, "perfect hash", order, count, repeats)))
+    {
+        goto cleanup_order;
+    }
+
+    options.flags = 0;
+    if (STATUS_SUCCESS
+            != (retval = store_file_compact(&stats, alloc, path, &options))
+     || STATUS_SUCCESS
+            != (retval = run(alloc, path, "hash index", order, count, repeats)))
+    {
+        goto cleanup_order;
+    }
+
+    /* the hash id index keeps its load factor at or below 1/2. */
+    while (capacity < 2 * count)
+    {
+        capacity *= 2;
+    }
+
+    options.flags = STORE_FILE_COMPACT_FLAG_PERFECT_HASH;
+    retval = store_file_compact(&stats, alloc, path, &options);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_order;
+    }
+
+    printf(
+        "index size: perfect hash %llu bytes (%.2f bits/record), "
+        "hash index %zu bytes\n",
+        (unsigned long long)stats.index_size,
+        8.0 * stats.index_size / count,
+        capacity * (sizeof(uint64_t) + sizeof(void*) + sizeof(size_t)));
+
+cleanup_order:
+    free(order);
+
+    return retval;
+}
+
+int main(int argc, char* argv[])
+{
+    status retval;
+    RCPR_SYM(allocator)* alloc = NULL;
+    const char* path =
+        (argc > 1) ? argv[1] : "/tmp/bench_store_file_index.img";
+    size_t count = (argc > 2) ? strtoul(argv[2], NULL, 10) : 1000000;
+    size_t repeats = (argc > 3) ? strtoul(argv[3], NULL, 10) : 5;
+
+    if (count < 1 || repeats < 1)
+    {
+        fprintf(stderr, "records and repeats must be at least 1\n");
+        return 1;
+    }
+
+    if (STATUS_SUCCESS != (retval = malloc_allocator_create(&alloc))
+     || STATUS_SUCCESS != (retval = image_create(alloc, path, count))
+     || STATUS_SUCCESS != (retval = compare(alloc, path, count, repeats))
+     || STATUS_SUCCESS
+            != (retval = resource_release(allocator_resource_handle(alloc))))
+    {
+        fprintf(
+            stderr, "benchmark failed with status 0x%x\n", (unsigned)retval);
+        unlink(path);
+        return 1;
+    }
+
+    unlink(path);
+
+    return 0;
+}
@@ -0,0 +1,362 @@
+/**
+ * \file bench/store_file/bench_store_file_snapshot.c
+ *
+ * \brief Compare loading a store image by building its hash id index against
+ * loading it from an index snapshot sidecar that covers all but its newest
+ * records.
+ *
+ * Usage: bench_store_file_snapshot [path] [records] [tail] [repeats]
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/store_file.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief The number of records in each append.
+ */
+#define BATCH_SIZE 1024
+
+/**
+ * \brief Get the current monotonic time in seconds.
+ */
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * \brief Set the hash id for the given record id.
+ */
+static void hash_id_init(uint8_t* hash_id, uint64_t id)
+{
+    memset(hash_id, 0, 32);
+    memcpy(hash_id, &id, sizeof(id));
+}
+
+/**
+ * \brief Create a record with the given id.
+ */
+static status record_create(
+    metadata** meta, RCPR_SYM(allocator)* alloc, uint64_t id)
+{
+    status retval;
+    uint8_t hash_id[32];
+
+    hash_id_init(hash_id, id);
+    if (STATUS_SUCCESS != (retval = metadata_create(meta, alloc))
+     || STATUS_SUCCESS
+            != (retval = metadata_hash_id_set(*meta, hash_id, sizeof(hash_id)))
+     || STATUS_SUCCESS != (retval = metadata_version_set(*meta, 1))
+     || STATUS_SUCCESS != (retval = metadata_creation_date_set(*meta, 1))
+     || STATUS_SUCCESS != (retval = metadata_revocation_date_set(*meta, 0))
+     || STATUS_SUCCESS != (retval = metadata_expiration_date_set(*meta, 2))
+     || STATUS_SUCCESS != (retval = metadata_password_length_set(*meta, 20))
+     || STATUS_SUCCESS != (retval = metadata_generation_set(*meta, 0))
+     || STATUS_SUCCESS != (retval = metadata_legacy_flag_set(*meta, false))
+     || STATUS_SUCCESS
+            != (retval = metadata_kdf_name_set(*meta, "pbkdf2-sha3-512"))
+     || STATUS_SUCCESS
+            != (retval = metadata_encoding_set(*meta, "0123456789abcdef")))
+    {
+        return retval;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Append the records with ids from \p begin up to \p end to the store
+ * image at the given path.
+ */
+static status image_append(
+    RCPR_SYM(allocator)* alloc, const char* path, size_t begin, size_t end)
+{
+    status retval, release_retval;
+    store_file* sf = NULL;
+    metadata* records[BATCH_SIZE];
+
+    retval = store_file_open(&sf, alloc, path, STORE_FILE_FLAG_CREATE);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    for (; begin < end; begin += BATCH_SIZE)
+    {
+        size_t batch = (end - begin < BATCH_SIZE) ? end - begin : BATCH_SIZE;
+        size_t created = 0;
+
+        for (; created < batch; ++created)
+        {
+            retval = record_create(&records[created], alloc, begin + created);
+            if (STATUS_SUCCESS != retval)
+            {
+                break;
+            }
+        }
+
+        if (STATUS_SUCCESS == retval)
+        {
+            retval =
+                store_file_append(
+                    sf, (const metadata* const*)records, batch, false);
+        }
+
+        for (size_t i = 0; i < created; ++i)
+        {
+            release_retval =
+                resource_release(metadata_resource_handle(records[i]));
+            if (STATUS_SUCCESS != release_retval)
+            {
+                retval = release_retval;
+            }
+        }
+
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_sf;
+        }
+    }
+
+    retval = store_file_sync(sf);
+
+cleanup_sf:
+    release_retval = resource_release(store_file_resource_handle(sf));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Read the image at the given path.
+ */
+static status image_read(
+    secure_buffer** image, RCPR_SYM(allocator)* alloc, const char* path)
+{
+    status retval, release_retval;
+    store_file* sf = NULL;
+
+    retval = store_file_open(&sf, alloc, path, 0);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = store_file_image_read(image, alloc, sf);
+
+    release_retval = resource_release(store_file_resource_handle(sf));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Write the index snapshot sidecar of the image at the given path.
+ */
+static status sidecar_write(RCPR_SYM(allocator)* alloc, const char* path)
+{
+    status retval, release_retval;
+    secure_buffer* image = NULL;
+    secure_buffer* snapshot = NULL;
+    store* st = NULL;
+
+    retval = image_read(&image, alloc, path);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    if (STATUS_SUCCESS
+            != (retval = store_create_from_buffer(&st, alloc, image, 0)))
+    {
+        goto cleanup_image;
+    }
+
+    if (STATUS_SUCCESS
+            == (retval = store_snapshot_create(&snapshot, alloc, st)))
+    {
+        retval = store_file_snapshot_write(alloc, path, snapshot);
+
+        release_retval =
+            resource_release(secure_buffer_resource_handle(snapshot));
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    release_retval = resource_release(store_resource_handle(st));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_image:
+    release_retval = resource_release(secure_buffer_resource_handle(image));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Load the image with and without the snapshot, and keep the fastest
+ * load of each, so that the first touch of the heap does not count against
+ * either.
+ */
+static status compare(
+    RCPR_SYM(allocator)* alloc, const char* path, size_t repeats)
+{
+    status retval, release_retval;
+    secure_buffer* image = NULL;
+    secure_buffer* snapshot = NULL;
+    store* st = NULL;
+    double start, elapsed;
+    double full_time = 0, snapshot_time = 0;
+    size_t covered = 0;
+
+    retval = image_read(&image, alloc, path);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    for (size_t r = 0; r < repeats; ++r)
+    {
+        /* build the whole index. */
+        start = now();
+        retval = store_create_from_buffer(&st, alloc, image, 0);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_image;
+        }
+        elapsed = now() - start;
+
+        if (0 == r || elapsed < full_time)
+        {
+            full_time = elapsed;
+        }
+
+        retval = resource_release(store_resource_handle(st));
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_image;
+        }
+
+        /* read the sidecar, and only index the tail. */
+        start = now();
+        if (STATUS_SUCCESS
+                != (retval = store_file_snapshot_read(&snapshot, alloc, path)))
+        {
+            goto cleanup_image;
+        }
+
+        retval =
+            store_create_from_buffer_with_snapshot(
+                &st, alloc, image, snapshot, 0, 0);
+        release_retval =
+            resource_release(secure_buffer_resource_handle(snapshot));
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_image;
+        }
+        elapsed = now() - start;
+
+        if (0 == r || elapsed < snapshot_time)
+        {
+            snapshot_time = elapsed;
+        }
+
+        covered = store_snapshot_record_count_get(st);
+        retval = resource_release(store_resource_handle(st));
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_image;
+        }
+    }
+
+    printf(
+        "full index     load %10.3f ms\n"
+        "snapshot       load %10.3f ms  (%zu records from the snapshot)\n",
+        full_time * 1e3, snapshot_time * 1e3, covered);
+
+cleanup_image:
+    release_retval = resource_release(secure_buffer_resource_handle(image));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+int main(int argc, char* argv[])
+{
+    status retval;
+    RCPR_SYM(allocator)* alloc = NULL;
+    const char* path =
+        (argc > 1) ? argv[1] : "/tmp/bench_store_file_snapshot.img";
+    size_t count = (argc > 2) ? strtoul(argv[2], NULL, 10) : 1000000;
+    size_t tail = (argc > 3) ? strtoul(argv[3], NULL, 10) : 10000;
+    size_t repeats = (argc > 4) ? strtoul(argv[4], NULL, 10) : 5;
+    char sidecar_path[4096];
+
+    if (count < 1 || repeats < 1)
+    {
+        fprintf(stderr, "records and repeats must be at least 1\n");
+        return 1;
+    }
+
+    snprintf(
+        sidecar_path, sizeof(sidecar_path), "%s%s", path,
+        STORE_FILE_SNAPSHOT_SUFFIX);
+    unlink(path);
+
+    if (STATUS_SUCCESS != (retval = malloc_allocator_create(&alloc))
+     || STATUS_SUCCESS != (retval = image_append(alloc, path, 0, count))
+     || STATUS_SUCCESS != (retval = sidecar_write(alloc, path))
+     || STATUS_SUCCESS
+            != (retval = image_append(alloc, path, count, count + tail))
+     || STATUS_SUCCESS != (retval = compare(alloc, path, repeats))
+     || STATUS_SUCCESS
+            != (retval = resource_release(allocator_resource_handle(alloc))))
+    {
+        fprintf(
+            stderr, "benchmark failed with status 0x%x\n", (unsigned)retval);
+        unlink(path);
+        unlink(sidecar_path);
+        return 1;
+    }
+
+    unlink(path);
+    unlink(sidecar_path);
+
+    return 0;
+}
@@ -0,0 +1,204 @@
+/**
+ * \file bench/wal/bench_wal.c
+ *
+ * \brief Compare durable updates through a write-ahead log with one synced
+ * store file append per update.
+ *
+ * Usage: bench_wal [path] [threads] [updates per thread] [max delay us]
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/wal.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief The state shared by every writer thread.
+ */
+typedef struct bench_context bench_context;
+
+struct bench_context
+{
+    wal* w;
+    const metadata* record;
+    size_t updates;
+    status retval;
+};
+
+/**
+ * \brief Get the current monotonic time in seconds.
+ */
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * \brief Create the benchmark record.
+ */
+static status record_create(metadata** meta, RCPR_SYM(allocator)* alloc)
+{
+    status retval;
+    const uint8_t HASH_ID[32] = { 0x01, 0x02, 0x03, 0x04 };
+
+    if (STATUS_SUCCESS != (retval = metadata_create(meta, alloc))
+     || STATUS_SUCCESS
+            != (retval = metadata_hash_id_set(*meta, HASH_ID, sizeof(HASH_ID)))
+     || STATUS_SUCCESS != (retval = metadata_version_set(*meta, 1))
+     || STATUS_SUCCESS != (retval = metadata_creation_date_set(*meta, 1))
+     || STATUS_SUCCESS != (retval = metadata_revocation_date_set(*meta, 0))
+     || STATUS_SUCCESS != (retval = metadata_expiration_date_set(*meta, 2))
+     || STATUS_SUCCESS != (retval = metadata_password_length_set(*meta, 20))
+     || STATUS_SUCCESS != (retval = metadata_generation_set(*meta, 0))
+     || STATUS_SUCCESS != (retval = metadata_legacy_flag_set(*meta, false))
+     || STATUS_SUCCESS
+            != (retval = metadata_kdf_name_set(*meta, "pbkdf2-sha3-512"))
+     || STATUS_SUCCESS
+            != (retval = metadata_encoding_set(*meta, "0123456789abcdef")))
+    {
+        return retval;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Append updates through the log, one at a time.
+ */
+static void* writer(void* arg)
+{
+    bench_context* ctx = (bench_context*)arg;
+
+    ctx->retval = STATUS_SUCCESS;
+    for (size_t i = 0; i < ctx->updates; ++i)
+    {
+        status retval = wal_append(ctx->w, &ctx->record, 1);
+        if (STATUS_SUCCESS != retval)
+        {
+            ctx->retval = retval;
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+int main(int argc, char* argv[])
+{
+    status retval, release_retval;
+    RCPR_SYM(allocator)* alloc = NULL;
+    metadata* meta = NULL;
+    store_file* target = NULL;
+    wal* w = NULL;
+    pthread_t threads[64];
+    bench_context contexts[64];
+    char log_path[4096];
+    const char* path = (argc > 1) ? argv[1] : "bench_wal.img";
+    size_t thread_count = (argc > 2) ? strtoul(argv[2], NULL, 10) : 8;
+    size_t updates = (argc > 3) ? strtoul(argv[3], NULL, 10) : 200;
+    uint32_t max_delay_us =
+        (argc > 4) ? (uint32_t)strtoul(argv[4], NULL, 10) : 200;
+    double start, elapsed;
+
+    if (thread_count < 1 || thread_count > 64)
+    {
+        fprintf(stderr, "threads must be between 1 and 64\n");
+        return 1;
+    }
+
+    snprintf(log_path, sizeof(log_path), "%s.wal", path);
+    unlink(path);
+    unlink(log_path);
+
+    if (STATUS_SUCCESS != (retval = malloc_allocator_create(&alloc))
+     || STATUS_SUCCESS != (retval = record_create(&meta, alloc))
+     || STATUS_SUCCESS
+            != (retval =
+                    store_file_open(
+                        &target, alloc, path, STORE_FILE_FLAG_CREATE)))
+    {
+        goto fail;
+    }
+
+    /* one synced append per update. */
+    const metadata* record = meta;
+    start = now();
+    for (size_t i = 0; i < updates; ++i)
+    {
+        retval = store_file_append(target, &record, 1, true);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto fail;
+        }
+    }
+    elapsed = now() - start;
+    printf("direct:  %10.0f updates/s\n", updates / elapsed);
+
+    /* concurrent updates through the log. */
+    retval = wal_open(&w, alloc, log_path, target, 0, max_delay_us);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto fail;
+    }
+
+    start = now();
+    for (size_t i = 0; i < thread_count; ++i)
+    {
+        contexts[i].w = w;
+        contexts[i].record = meta;
+        contexts[i].updates = updates;
+        pthread_create(&threads[i], NULL, &writer, &contexts[i]);
+    }
+
+    for (size_t i = 0; i < thread_count; ++i)
+    {
+        pthread_join(threads[i], NULL);
+        if (STATUS_SUCCESS != contexts[i].retval)
+        {
+            retval = contexts[i].retval;
+        }
+    }
+    elapsed = now() - start;
+
+    printf(
+        "wal:     %10.0f updates/s  %6.1f updates/commit\n",
+        thread_count * updates / elapsed,
+        (double)(thread_count * updates) / wal_commit_count_get(w));
+
+    release_retval = resource_release(wal_resource_handle(w));
+    if (STATUS_SUCCESS != retval || STATUS_SUCCESS != release_retval)
+    {
+        retval = (STATUS_SUCCESS != retval) ? retval : release_retval;
+        goto fail;
+    }
+
+    unlink(path);
+    unlink(log_path);
+
+    if (STATUS_SUCCESS
+            != (retval = resource_release(metadata_resource_handle(meta)))
+     || STATUS_SUCCESS
+            != (retval = resource_release(allocator_resource_handle(alloc))))
+    {
+        goto fail;
+    }
+
+    return 0;
+
+fail:
+    fprintf(stderr, "benchmark failed with status 0x%x\n", (unsigned)retval);
+    return 1;
+}
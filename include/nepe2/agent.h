@@ -0,0 +1,274 @@
+/**
+ * \file nepe2/agent.h
+ *
+ * \brief An agent holds an unlocked vault and derivation state, and serves
+ * batched lookup and derive requests over a Unix domain socket.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <nepe2/derive.h>
+#include <nepe2/metadata.h>
+#include <nepe2/secure_buffer.h>
+#include <nepe2/store.h>
+#include <rcpr/allocator.h>
+#include <rcpr/resource.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief Look up records by hash id.
+ *
+ * Each response entry holds the newest generation of the record as a serial
+ * version 1 or 2 record, as written by \ref metadata_to_buffer. A record with
+ * a kdf cost is written as serial version 2.
+ */
+#define AGENT_OP_LOOKUP                                                   0x01
+
+/**
+ * \brief Derive passwords by hash id.
+ *
+ * Each response entry holds the password derived for the newest generation of
+ * the record.
+ */
+#define AGENT_OP_DERIVE                                                   0x02
+
+/**
+ * \brief Lock the memory of the agent process, so that the vault and
+ * derivation state are never written to swap.
+ */
+#define AGENT_FLAG_LOCK_MEMORY                                      0x00000001
+
+/**
+ * \brief The size of the prefix of every frame.
+ *
+ * Every frame is a big-endian uint32_t payload size followed by the payload.
+ *
+ * A request payload consists of the following big-endian fields:
+ *      - op (uint8_t), which is one of the AGENT_OP_ values.
+ *      - count (uint32_t).
+ *      - count entries, each a hash id size (uint32_t) followed by the hash id.
+ *
+ * A response payload consists of the following big-endian fields:
+ *      - status (uint32_t), which is the status of the request as a whole.
+ *      - count (uint32_t), which matches the request count on success.
+ *      - count entries, each a status (uint32_t), a size (uint32_t), and
+ *        size bytes of data. The data is empty unless the status is
+ *        STATUS_SUCCESS.
+ */
+#define AGENT_FRAME_PREFIX_SIZE                                              4
+
+/**
+ * \brief The largest frame payload that an agent or client accepts.
+ */
+#define AGENT_FRAME_MAX                                         (1024 * 1024)
+
+/**
+ * \brief An agent serves a vault to local clients.
+ */
+typedef struct agent agent;
+
+/******************************************************************************/
+/* Start of constructors.                                                     */
+/******************************************************************************/
+
+/**
+ * \brief Create an agent listening on the given Unix domain socket path.
+ *
+ * \param ag            Pointer to the agent pointer to receive the agent on
+ *                      success.
+ * \param alloc         The allocator instance to use for this operation, which
+ *                      must be thread-safe.
+ * \param vault         The unlocked vault to serve.
+ * \param ctx           The \ref derive_context holding the master passphrase.
+ * \param path          The socket path, which must not exist.
+ * \param flags         Zero or more AGENT_FLAG_ values.
+ *
+ * \note This agent is a \ref resource that must be released by calling
+ * \ref resource_release on its resource handle when it is no longer needed by
+ * the caller. The resource handle can be accessed by calling
+ * \ref agent_resource_handle on this agent instance. Releasing the agent closes
+ * every connection and removes the socket path. The socket is only accessible
+ * to the owner of the process.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_AGENT_PATH_TOO_LONG if \p path does not fit in a socket
+ *        address.
+ *      - ERROR_AGENT_SOCKET_FAILED if the socket could not be created, bound,
+ *        or listened on.
+ *      - ERROR_AGENT_EPOLL_FAILED if the event loop could not be created.
+ *      - ERROR_AGENT_MLOCK_FAILED if \ref AGENT_FLAG_LOCK_MEMORY is set and
+ *        memory could not be locked.
+ *
+ * \pre
+ *      - \p ag must not reference a valid \ref agent instance and must not be
+ *        NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ *      - \p vault must reference a valid \ref store instance.
+ *      - \p ctx must reference a valid \ref derive_context instance.
+ *      - \p path must be a valid ASCII zero terminated string.
+ * \post
+ *      - On success, \p ag is set to a pointer to a valid \ref agent instance,
+ *        which is a \ref resource owned by the caller that must be released
+ *        when no longer needed. The agent takes ownership of \p vault and
+ *        \p ctx.
+ *      - On failure, \p ag is not changed, \p vault and \p ctx are still owned
+ *        by the caller, and an error status is returned.
+ */
+status FN_DECL_MUST_CHECK
+agent_create(
+    agent** ag, RCPR_SYM(allocator)* alloc, store* vault, derive_context* ctx,
+    const char* path, uint32_t flags);
+
+/******************************************************************************/
+/* Start of accessors.                                                        */
+/******************************************************************************/
+
+/**
+ * \brief Given a \ref agent instance, return the resource handle for this
+ * \ref agent instance.
+ *
+ * \param ag            The \ref agent instance from which the resource handle
+ *                      is returned.
+ *
+ * \returns the resource handle for this \ref agent instance.
+ */
+RCPR_SYM(resource)*
+agent_resource_handle(
+    agent* ag);
+
+/******************************************************************************/
+/* Start of agent methods.                                                    */
+/******************************************************************************/
+
+/**
+ * \brief Run the event loop of an agent until it is stopped.
+ *
+ * \param ag            The \ref agent for this operation.
+ *
+ * \note Every connection is served from this thread with a single epoll
+ * instance. Each request frame is answered with one response frame, and every
+ * complete frame in a read is answered before the responses are written, so
+ * pipelined requests share a write. The derivations of a derive request are
+ * spread over one thread per online processor.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS when the agent is stopped.
+ *      - ERROR_AGENT_EPOLL_FAILED if waiting for events failed.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ */
+status FN_DECL_MUST_CHECK
+agent_run(
+    agent* ag);
+
+/**
+ * \brief Stop the event loop of an agent.
+ *
+ * \param ag            The \ref agent for this operation.
+ *
+ * \note This can be called from any thread, or from a signal handler. The
+ * event loop returns after it finishes the events it is handling.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_AGENT_EPOLL_FAILED if the event loop could not be woken.
+ */
+status FN_DECL_MUST_CHECK
+agent_stop(
+    agent* ag);
+
+/******************************************************************************/
+/* Start of client methods.                                                   */
+/******************************************************************************/
+
+/**
+ * \brief Connect to an agent.
+ *
+ * \param fd            Pointer to receive the connected socket on success,
+ *                      which is owned by the caller.
+ * \param path          The socket path of the agent.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_AGENT_PATH_TOO_LONG if \p path does not fit in a socket
+ *        address.
+ *      - ERROR_AGENT_SOCKET_FAILED if the connection failed.
+ */
+status FN_DECL_MUST_CHECK
+agent_connect(
+    int* fd, const char* path);
+
+/**
+ * \brief Send a batched request to an agent and read its response.
+ *
+ * \param response      Pointer to receive the response payload on success.
+ * \param alloc         The allocator to use for the response.
+ * \param fd            A socket connected with \ref agent_connect.
+ * \param op            The AGENT_OP_ value of this request.
+ * \param hash_ids      Array of \p count hash ids.
+ * \param hash_id_sizes Array of \p count hash id sizes.
+ * \param count         The number of hash ids.
+ *
+ * \note The request is written with a single writev, and the entries of the
+ * response are read with \ref agent_response_entry_next.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_AGENT_IO_FAILED if the request could not be written or the
+ *        response could not be read.
+ *      - ERROR_AGENT_BAD_FRAME if the request or response is too large.
+ *      - the status of the response, if the agent rejected the request.
+ *
+ * \pre
+ *      - \p response must not reference a valid \ref secure_buffer instance
+ *        and must not be NULL.
+ *      - \p hash_ids and \p hash_id_sizes must point to \p count entries.
+ * \post
+ *      - On success, \p response is set to a \ref secure_buffer holding the
+ *        response payload, which is owned by the caller.
+ *      - On failure, \p response is not changed.
+ */
+status FN_DECL_MUST_CHECK
+agent_request(
+    secure_buffer** response, RCPR_SYM(allocator)* alloc, int fd, uint8_t op,
+    const void* const* hash_ids, const size_t* hash_id_sizes, size_t count);
+
+/**
+ * \brief Read the next entry of a response payload.
+ *
+ * \param entry_status  Pointer to receive the status of this entry.
+ * \param data          Pointer to receive the data of this entry, which is
+ *                      owned by \p response.
+ * \param size          Pointer to receive the size of this entry.
+ * \param offset        The read position, which must be zero for the first
+ *                      entry and is advanced past this entry on success.
+ * \param response      The response payload from \ref agent_request.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_AGENT_BAD_FRAME if there are no more entries, or the response
+ *        is malformed.
+ */
+status FN_DECL_MUST_CHECK
+agent_response_entry_next(
+    status* entry_status, const void** data, size_t* size, size_t* offset,
+    secure_buffer* response);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
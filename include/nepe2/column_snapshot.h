@@ -0,0 +1,276 @@
+/**
+ * \file nepe2/column_snapshot.h
+ *
+ * \brief A column snapshot holds the fixed fields of every record of a
+ * \ref store in parallel arrays, so that maintenance queries can scan them
+ * without touching the records.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <nepe2/store.h>
+#include <rcpr/allocator.h>
+#include <rcpr/resource.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief Column snapshot field: the record version.
+ */
+#define COLUMN_SNAPSHOT_FIELD_VERSION                                        1
+
+/**
+ * \brief Column snapshot field: the creation date.
+ */
+#define COLUMN_SNAPSHOT_FIELD_CREATION_DATE                                  2
+
+/**
+ * \brief Column snapshot field: the revocation date.
+ */
+#define COLUMN_SNAPSHOT_FIELD_REVOCATION_DATE                                3
+
+/**
+ * \brief Column snapshot field: the expiration date.
+ */
+#define COLUMN_SNAPSHOT_FIELD_EXPIRATION_DATE                                4
+
+/**
+ * \brief Column snapshot field: the password length.
+ */
+#define COLUMN_SNAPSHOT_FIELD_PASSWORD_LENGTH                                5
+
+/**
+ * \brief Column snapshot field: the generation.
+ */
+#define COLUMN_SNAPSHOT_FIELD_GENERATION                                     6
+
+/**
+ * \brief Column snapshot field: the legacy flag, which is 1 for legacy
+ * records and 0 otherwise.
+ */
+#define COLUMN_SNAPSHOT_FIELD_LEGACY                                         7
+
+/**
+ * \brief Column snapshot field: the kdf id, as returned by
+ * \ref column_snapshot_kdf_id_get.
+ */
+#define COLUMN_SNAPSHOT_FIELD_KDF                                            8
+
+/**
+ * \brief Column snapshot field: the alphabet id, as returned by
+ * \ref column_snapshot_alphabet_id_get.
+ */
+#define COLUMN_SNAPSHOT_FIELD_ALPHABET                                       9
+
+/**
+ * \brief Column snapshot operator: the field is less than the value.
+ */
+#define COLUMN_SNAPSHOT_OP_LT                                                1
+
+/**
+ * \brief Column snapshot operator: the field is at most the value.
+ */
+#define COLUMN_SNAPSHOT_OP_LE                                                2
+
+/**
+ * \brief Column snapshot operator: the field is equal to the value.
+ */
+#define COLUMN_SNAPSHOT_OP_EQ                                                3
+
+/**
+ * \brief Column snapshot operator: the field is not equal to the value.
+ */
+#define COLUMN_SNAPSHOT_OP_NE                                                4
+
+/**
+ * \brief Column snapshot operator: the field is at least the value.
+ */
+#define COLUMN_SNAPSHOT_OP_GE                                                5
+
+/**
+ * \brief Column snapshot operator: the field is greater than the value.
+ */
+#define COLUMN_SNAPSHOT_OP_GT                                                6
+
+/**
+ * \brief The number of 64-bit words in a selection bitmap for the given
+ * number of rows.
+ */
+#define COLUMN_SNAPSHOT_BITMAP_WORDS(rows)                  (((rows) + 63) / 64)
+
+/**
+ * \brief A column snapshot is an immutable, column-wise copy of the fixed
+ * fields of a \ref store.
+ *
+ * Row i of the snapshot is the record at position i of the store. The dates
+ * are held as 64-bit columns; the version, password length, and generation as
+ * 32-bit columns; the kdf name and encoding as 16-bit ids into per-snapshot
+ * dictionaries; and the legacy flag as an 8-bit column. A scan compares one
+ * column against a value and writes a selection bitmap, with bit (i % 64) of
+ * word (i / 64) set if row i matches. Bitmaps from several scans can be
+ * combined with bitwise operations to answer compound queries.
+ */
+typedef struct column_snapshot column_snapshot;
+
+/******************************************************************************/
+/* Start of constructors.                                                     */
+/******************************************************************************/
+
+/**
+ * \brief Create a column snapshot of every record in a \ref store.
+ *
+ * \param snap          Pointer to the column snapshot pointer to receive the
+ *                      snapshot on success.
+ * \param alloc         The allocator instance to use for this operation.
+ * \param st            The store to snapshot.
+ *
+ * \note This column snapshot is a \ref resource that must be released by
+ * calling \ref resource_release on its resource handle when it is no longer
+ * needed by the caller. The resource handle can be accessed by calling
+ * \ref column_snapshot_resource_handle on this snapshot instance. The snapshot
+ * holds copies of the fields it needs, so it does not refer to \p st after it
+ * is created.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_COLUMN_SNAPSHOT_TOO_MANY_NAMES if the store has more distinct
+ *        kdf names or encodings than a 16-bit id can hold.
+ *      - an error from the \ref metadata getters if a record is incomplete.
+ *
+ * \pre
+ *      - \p snap must not reference a valid \ref column_snapshot instance and
+ *        must not be NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ *      - \p st must reference a valid \ref store instance.
+ * \post
+ *      - On success, \p snap is set to a pointer to a valid
+ *        \ref column_snapshot instance, which is a \ref resource owned by the
+ *        caller that must be released when no longer needed.
+ *      - On failure, \p snap is not changed and an error status is returned.
+ */
+status FN_DECL_MUST_CHECK
+column_snapshot_create(
+    column_snapshot** snap, RCPR_SYM(allocator)* alloc, const store* st);
+
+/******************************************************************************/
+/* Start of accessors.                                                        */
+/******************************************************************************/
+
+/**
+ * \brief Given a \ref column_snapshot instance, return the resource handle for
+ * this \ref column_snapshot instance.
+ *
+ * \param snap          The \ref column_snapshot instance from which the
+ *                      resource handle is returned.
+ *
+ * \returns the resource handle for this \ref column_snapshot instance.
+ */
+RCPR_SYM(resource)*
+column_snapshot_resource_handle(
+    column_snapshot* snap);
+
+/**
+ * \brief Get the number of rows in a \ref column_snapshot.
+ *
+ * \param snap          The \ref column_snapshot instance for this operation.
+ *
+ * \returns the number of rows, which is the record count of the store.
+ */
+size_t
+column_snapshot_row_count_get(
+    const column_snapshot* snap);
+
+/**
+ * \brief Get the id of a kdf name in a \ref column_snapshot.
+ *
+ * \param id            Pointer to receive the kdf id on success.
+ * \param snap          The \ref column_snapshot instance for this operation.
+ * \param kdf_name      The ASCII zero terminated kdf name.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_COLUMN_SNAPSHOT_NAME_NOT_FOUND if no record uses this kdf.
+ */
+status FN_DECL_MUST_CHECK
+column_snapshot_kdf_id_get(
+    uint32_t* id, const column_snapshot* snap, const char* kdf_name);
+
+/**
+ * \brief Get the id of an encoding alphabet in a \ref column_snapshot.
+ *
+ * \param id            Pointer to receive the alphabet id on success.
+ * \param snap          The \ref column_snapshot instance for this operation.
+ * \param encoding      The ASCII zero terminated encoding.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_COLUMN_SNAPSHOT_NAME_NOT_FOUND if no record uses this
+ *        encoding.
+ */
+status FN_DECL_MUST_CHECK
+column_snapshot_alphabet_id_get(
+    uint32_t* id, const column_snapshot* snap, const char* encoding);
+
+/******************************************************************************/
+/* Start of methods.                                                          */
+/******************************************************************************/
+
+/**
+ * \brief Select the rows of a \ref column_snapshot whose field compares to a
+ * value with the given operator.
+ *
+ * \param bitmap        The selection bitmap, which must hold
+ *                      \ref COLUMN_SNAPSHOT_BITMAP_WORDS of the row count
+ *                      words, and which is overwritten.
+ * \param snap          The \ref column_snapshot instance for this operation.
+ * \param field         The COLUMN_SNAPSHOT_FIELD_ value to compare.
+ * \param op            The COLUMN_SNAPSHOT_OP_ value to compare with.
+ * \param value         The value to compare against. Values are compared as
+ *                      unsigned integers, so a value wider than the column
+ *                      compares greater than every row.
+ *
+ * \note Where the CPU supports AVX2, each 64-row word of the bitmap is built
+ * from vector compares of the column; otherwise the rows are compared one at a
+ * time. Bits past the last row are clear.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_COLUMN_SNAPSHOT_INVALID_FIELD if \p field is not a valid field.
+ *      - ERROR_COLUMN_SNAPSHOT_INVALID_OPERATOR if \p op is not a valid
+ *        operator.
+ */
+status FN_DECL_MUST_CHECK
+column_snapshot_scan(
+    uint64_t* bitmap, const column_snapshot* snap, uint32_t field,
+    uint32_t op, uint64_t value);
+
+/******************************************************************************/
+/* Start of utility methods.                                                  */
+/******************************************************************************/
+
+/**
+ * \brief Count the selected rows of a selection bitmap.
+ *
+ * \param bitmap        The selection bitmap.
+ * \param rows          The number of rows covered by the bitmap.
+ *
+ * \returns the number of set bits for the first \p rows rows.
+ */
+size_t
+column_snapshot_bitmap_count(
+    const uint64_t* bitmap, size_t rows);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
@@ -0,0 +1,369 @@
+/**
+ * \file nepe2/derive.h
+ *
+ * \brief Derive passwords from a master passphrase and \ref metadata records.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <nepe2/metadata.h>
+#include <nepe2/secure_buffer.h>
+#include <rcpr/allocator.h>
+#include <rcpr/resource.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief The kdf name of the PBKDF2 HMAC-SHA3-512 mode.
+ */
+#define DERIVE_KDF_PBKDF2_SHA3_512                           "pbkdf2-sha3-512"
+
+/**
+ * \brief The kdf name of the session HMAC-SHA3-512 mode.
+ */
+#define DERIVE_KDF_SESSION_HMAC_SHA3_512               "session-hmac-sha3-512"
+
+/**
+ * \brief The largest kdf cost, which is the largest PBKDF2 iteration count.
+ */
+#define DERIVE_COST_MAX                                             0x7fffffff
+
+/**
+ * \brief The target latency, in microseconds, of a derivation the user waits
+ * on, such as deriving a password.
+ */
+#define DERIVE_COST_TARGET_INTERACTIVE_USEC                             250000
+
+/**
+ * \brief The target latency, in microseconds, of setting up the master
+ * passphrase or a session.
+ */
+#define DERIVE_COST_TARGET_MASTER_USEC                                 2000000
+
+/**
+ * \brief A derive context holds the master passphrase and the derivation
+ * parameters that are shared by every record.
+ *
+ * Records with the legacy flag set are derived with the nepephemeral 0.x
+ * scheme, which is supplied to the context by \ref derive_context_legacy_set.
+ * Every other record is derived in the mode named by its kdf name.
+ *
+ * The PBKDF2 HMAC-SHA3-512 mode derives
+ * ceil(password_length * log2(alphabet length) / 8) bytes with the master
+ * passphrase as the password, the kdf cost of the record as the iteration
+ * count, or the iteration count of the context if the record has no kdf cost,
+ * and the following salt:
+ *      - version (big-endian uint32_t).
+ *      - generation (big-endian uint32_t).
+ *      - hash id.
+ *
+ * The session HMAC-SHA3-512 mode splits the derivation in two stages. The
+ * session stage runs once, in \ref derive_context_session_set, and derives a
+ * 64 byte session key with PBKDF2 HMAC-SHA3-512, with the master passphrase
+ * as the password and the following salt:
+ *      - "nepe2 session".
+ *      - session passphrase.
+ *
+ * The session stage uses the iteration count of the context, so the kdf cost
+ * of a record in this mode is not used. The session key is kept in locked
+ * memory until the context is released or the session is replaced, when it is
+ * erased. The record stage derives the
+ * key in 64 byte blocks, where block i, counting from 1, is the HMAC-SHA3-512
+ * of the following with the session key:
+ *      - i (big-endian uint32_t).
+ *      - version (big-endian uint32_t).
+ *      - generation (big-endian uint32_t).
+ *      - password_length (big-endian uint32_t).
+ *      - hash id.
+ *
+ * In either mode, each password character is then taken from the next
+ * log2(alphabet length) bits of the derived key, most significant bit first,
+ * as an index into the encoding alphabet. Since alphabet lengths are powers of
+ * two, this is unbiased.
+ */
+typedef struct derive_context derive_context;
+
+/**
+ * \brief Derive a password with the nepephemeral 0.x scheme.
+ *
+ * \param context       The user context given to
+ *                      \ref derive_context_legacy_set.
+ * \param password      Pointer to receive the password on success.
+ * \param alloc         The allocator to use for the password.
+ * \param master        The master passphrase.
+ * \param record        The legacy record to derive.
+ *
+ * \note This function is called concurrently by batch derivation.
+ *
+ * \returns a status code indicating success or failure.
+ */
+typedef status (*derive_legacy_fn)(
+    void* context, secure_buffer** password, RCPR_SYM(allocator)* alloc,
+    const secure_buffer* master, const metadata* record);
+
+/******************************************************************************/
+/* Start of constructors.                                                     */
+/******************************************************************************/
+
+/**
+ * \brief Create a derive context.
+ *
+ * \param ctx           Pointer to the derive context pointer to receive the
+ *                      derive context on success.
+ * \param alloc         The allocator instance to use for this operation.
+ * \param master        The master passphrase, which is copied.
+ * \param iterations    The PBKDF2 iteration count for records without a kdf
+ *                      cost, and for the session stage.
+ *
+ * \note This derive context is a \ref resource that must be released by
+ * calling \ref resource_release on its resource handle when it is no longer
+ * needed by the caller. The resource handle can be accessed by calling
+ * \ref derive_context_resource_handle on this derive context instance. The
+ * copy of the master passphrase is erased when the context is released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *
+ * \pre
+ *      - \p ctx must not reference a valid \ref derive_context instance and
+ *        must not be NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ *      - \p master must reference a valid \ref secure_buffer instance.
+ *      - \p iterations must be greater than zero and at most
+ *        \ref DERIVE_COST_MAX.
+ * \post
+ *      - On success, \p ctx is set to a pointer to a valid
+ *        \ref derive_context instance, which is a \ref resource owned by the
+ *        caller that must be released when no longer needed.
+ *      - On failure, \p ctx is not changed and an error status is returned.
+ */
+status FN_DECL_MUST_CHECK
+derive_context_create(
+    derive_context** ctx, RCPR_SYM(allocator)* alloc,
+    const secure_buffer* master, uint32_t iterations);
+
+/**
+ * \brief Measure the KDF of a mode on this host, and pick the kdf cost that
+ * takes about the target latency.
+ *
+ * \param cost          Pointer to receive the kdf cost on success.
+ * \param kdf_name      The kdf name of the mode to calibrate.
+ * \param target_usec   The target latency, in microseconds, such as
+ *                      \ref DERIVE_COST_TARGET_INTERACTIVE_USEC or
+ *                      \ref DERIVE_COST_TARGET_MASTER_USEC.
+ *
+ * \note The KDF is timed with a doubling iteration count until one run is long
+ * enough to measure, and then the fastest of a few runs at that count is
+ * scaled to the target. Using the fastest run keeps a busy host from picking a
+ * lower cost. The measurement takes a small fraction of the target latency.
+ * For the PBKDF2 HMAC-SHA3-512 mode, the cost is the iteration count to store
+ * in each record with \ref metadata_kdf_cost_set. For the session
+ * HMAC-SHA3-512 mode, it is the iteration count of the session stage, which is
+ * given to \ref derive_context_create.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_DERIVE_UNKNOWN_KDF if the kdf name is unknown.
+ *      - ERROR_DERIVE_KDF_FAILED if the KDF failed.
+ *
+ * \pre
+ *      - \p cost must be a valid pointer.
+ *      - \p target_usec must be greater than zero.
+ * \post
+ *      - On success, \p cost is set to a kdf cost between 1 and
+ *        \ref DERIVE_COST_MAX.
+ *      - On failure, \p cost is unchanged.
+ */
+status FN_DECL_MUST_CHECK
+derive_cost_calibrate(
+    uint32_t* cost, const char* kdf_name, uint64_t target_usec);
+
+/******************************************************************************/
+/* Start of accessors.                                                        */
+/******************************************************************************/
+
+/**
+ * \brief Given a \ref derive_context instance, return the resource handle for
+ * this \ref derive_context instance.
+ *
+ * \param ctx           The \ref derive_context instance from which the
+ *                      resource handle is returned.
+ *
+ * \returns the resource handle for this \ref derive_context instance.
+ */
+RCPR_SYM(resource)*
+derive_context_resource_handle(
+    derive_context* ctx);
+
+/**
+ * \brief Set the nepephemeral 0.x scheme used for legacy records.
+ *
+ * \param ctx           The \ref derive_context instance for this operation.
+ * \param legacy        The legacy derivation function.
+ * \param context       The user context passed to \p legacy.
+ *
+ * \note Until this is set, deriving a legacy record fails with
+ * ERROR_DERIVE_LEGACY_UNAVAILABLE.
+ */
+void
+derive_context_legacy_set(
+    derive_context* ctx, derive_legacy_fn legacy, void* context);
+
+/**
+ * \brief Start a session by absorbing a session passphrase.
+ *
+ * \param ctx           The \ref derive_context instance for this operation.
+ * \param session       The session passphrase.
+ *
+ * \note This runs the PBKDF2 iterations of the session stage once, so that
+ * each record in the session HMAC-SHA3-512 mode only costs a few HMACs. The
+ * session key is locked in memory, and any previous session key is erased.
+ * This must not be called while passwords are being derived with \p ctx.
+ * Until a session is set, deriving a record in this mode fails with
+ * ERROR_DERIVE_SESSION_UNAVAILABLE.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_DERIVE_MLOCK_FAILED if the session key could not be locked in
+ *        memory.
+ *      - ERROR_DERIVE_KDF_FAILED if the KDF failed.
+ *
+ * \pre
+ *      - \p ctx must reference a valid \ref derive_context instance.
+ *      - \p session must reference a valid \ref secure_buffer instance.
+ * \post
+ *      - On failure, the context has no session.
+ */
+status FN_DECL_MUST_CHECK
+derive_context_session_set(
+    derive_context* ctx, const secure_buffer* session);
+
+/******************************************************************************/
+/* Start of derivation methods.                                               */
+/******************************************************************************/
+
+/**
+ * \brief Derive the password for a record.
+ *
+ * \param password      Pointer to receive the password on success.
+ * \param alloc         The allocator to use for the password.
+ * \param ctx           The \ref derive_context for this operation.
+ * \param record        The record to derive.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_METADATA_FIELD_NOT_SET if the record is missing a field.
+ *      - ERROR_DERIVE_UNKNOWN_KDF if the kdf name of the record is unknown.
+ *      - ERROR_DERIVE_UNSUPPORTED_ENCODING if the encoding of the record is
+ *        symbolic.
+ *      - ERROR_DERIVE_INVALID_PASSWORD_LENGTH if the password length of the
+ *        record is zero.
+ *      - ERROR_DERIVE_LEGACY_UNAVAILABLE if the record is a legacy record and
+ *        no legacy scheme is set.
+ *      - ERROR_DERIVE_SESSION_UNAVAILABLE if the record is in the session
+ *        mode and no session is set.
+ *      - ERROR_DERIVE_INVALID_COST if the kdf cost of the record is greater
+ *        than \ref DERIVE_COST_MAX.
+ *      - ERROR_DERIVE_KDF_FAILED if the KDF failed.
+ *
+ * \pre
+ *      - \p password must not reference a valid \ref secure_buffer instance
+ *        and must not be NULL.
+ *      - \p ctx must reference a valid \ref derive_context instance.
+ *      - \p record must reference a valid \ref metadata instance.
+ * \post
+ *      - On success, \p password is set to a \ref secure_buffer holding
+ *        password_length characters, which is owned by the caller.
+ *      - On failure, \p password is not changed.
+ */
+status FN_DECL_MUST_CHECK
+derive_password(
+    secure_buffer** password, RCPR_SYM(allocator)* alloc,
+    const derive_context* ctx, const metadata* record);
+
+/**
+ * \brief Check that a record can be derived, without running the KDF.
+ *
+ * \param ctx           The \ref derive_context for this operation.
+ * \param record        The record to check.
+ *
+ * \note This reports the record errors that \ref derive_password would, so
+ * that a batch can leave out the records that would fail it. A legacy record
+ * is only checked for a legacy scheme.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS if the record can be derived.
+ *      - ERROR_METADATA_FIELD_NOT_SET if the record is missing a field.
+ *      - ERROR_DERIVE_UNKNOWN_KDF if the kdf name of the record is unknown.
+ *      - ERROR_DERIVE_UNSUPPORTED_ENCODING if the encoding of the record is
+ *        symbolic.
+ *      - ERROR_DERIVE_INVALID_PASSWORD_LENGTH if the password length of the
+ *        record is zero.
+ *      - ERROR_DERIVE_LEGACY_UNAVAILABLE if the record is a legacy record and
+ *        no legacy scheme is set.
+ *      - ERROR_DERIVE_SESSION_UNAVAILABLE if the record is in the session
+ *        mode and no session is set.
+ *      - ERROR_DERIVE_INVALID_COST if the kdf cost of the record is greater
+ *        than \ref DERIVE_COST_MAX.
+ *
+ * \pre
+ *      - \p ctx must reference a valid \ref derive_context instance.
+ *      - \p record must reference a valid \ref metadata instance.
+ */
+status FN_DECL_MUST_CHECK
+derive_password_check(const derive_context* ctx, const metadata* record);
+
+/**
+ * \brief Derive the passwords for many records on several threads.
+ *
+ * \param passwords     Array of \p count pointers to receive the passwords.
+ * \param alloc         The allocator to use for the passwords, which must be
+ *                      thread-safe.
+ * \param ctx           The \ref derive_context for this operation.
+ * \param records       Array of \p count records to derive.
+ * \param count         The number of records.
+ * \param thread_count  The number of threads to use, or 0 to use one thread
+ *                      per online processor.
+ *
+ * \note Legacy and modern records may be mixed. Threads take the next record
+ * from a shared counter, so a batch with uneven per-record costs still keeps
+ * every thread busy.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_DERIVE_THREAD_CREATE_FAILED if a thread could not be created.
+ *      - the first error returned by \ref derive_password otherwise.
+ *
+ * \pre
+ *      - \p passwords must point to \p count writable pointers.
+ *      - \p ctx must reference a valid \ref derive_context instance.
+ *      - \p records must point to \p count valid \ref metadata instances.
+ * \post
+ *      - On success, each entry of \p passwords is set to the password for the
+ *        matching record, which is owned by the caller.
+ *      - On failure, every entry of \p passwords is NULL.
+ */
+status FN_DECL_MUST_CHECK
+derive_password_batch(
+    secure_buffer** passwords, RCPR_SYM(allocator)* alloc,
+    const derive_context* ctx, const metadata* const* records, size_t count,
+    size_t thread_count);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
@@ -13,3 +13,62 @@
 #define ERROR_METADATA_BAD_ENCODING_LENGTH                              0x3402
 #define ERROR_METADATA_INVALID_BUFFER_SIZE                              0x3403
 #define ERROR_METADATA_UNKNOWN_SERIAL_VERSION                           0x3404
+#define ERROR_METADATA_INVALID_STRING                                   0x3405
+#define ERROR_METADATA_WRITE_FAILED                                     0x3406
+
+#define ERROR_STORE_INVALID_HEADER                                      0x3501
+#define ERROR_STORE_UNKNOWN_FORMAT_VERSION                              0x3502
+#define ERROR_STORE_INVALID_RECORD_SIZE                                 0x3503
+#define ERROR_STORE_RECORD_NOT_FOUND                                    0x3504
+#define ERROR_STORE_THREAD_CREATE_FAILED                                0x3505
+#define ERROR_STORE_CHECKSUM_MISMATCH                                   0x3506
+#define ERROR_STORE_INVALID_INDEX                                       0x3507
+#define ERROR_STORE_SNAPSHOT_NOT_SUPPORTED                              0x3508
+
+#define ERROR_LIVE_STORE_MUTEX_INIT_FAILED                              0x3601
+
+#define ERROR_UPGRADE_PIPELINE_THREAD_CREATE_FAILED                     0x3701
+#define ERROR_UPGRADE_PIPELINE_SYNC_INIT_FAILED                         0x3702
+#define ERROR_UPGRADE_PIPELINE_CANCELED                                 0x3703
+#define ERROR_UPGRADE_PIPELINE_BAD_TARGET_LAYER                         0x3704
+
+#define ERROR_DERIVE_UNKNOWN_KDF                                        0x3801
+#define ERROR_DERIVE_UNSUPPORTED_ENCODING                               0x3802
+#define ERROR_DERIVE_LEGACY_UNAVAILABLE                                 0x3803
+#define ERROR_DERIVE_KDF_FAILED                                         0x3804
+#define ERROR_DERIVE_THREAD_CREATE_FAILED                               0x3805
+#define ERROR_DERIVE_INVALID_PASSWORD_LENGTH                            0x3806
+#define ERROR_DERIVE_SESSION_UNAVAILABLE                                0x3807
+#define ERROR_DERIVE_MLOCK_FAILED                                       0x3808
+#define ERROR_DERIVE_INVALID_COST                                       0x3809
+
+#define ERROR_SECURE_BUFFER_BUILDER_EMPTY                               0x3901
+#define ERROR_SECURE_BUFFER_CACHE_EXISTS                                0x3902
+#define ERROR_SECURE_BUFFER_CACHE_INIT_FAILED                           0x3903
+
+#define ERROR_AGENT_PATH_TOO_LONG                                       0x3A01
+#define ERROR_AGENT_SOCKET_FAILED                                       0x3A02
+#define ERROR_AGENT_EPOLL_FAILED                                        0x3A03
+#define ERROR_AGENT_MLOCK_FAILED                                        0x3A04
+#define ERROR_AGENT_BAD_FRAME                                           0x3A05
+#define ERROR_AGENT_UNKNOWN_OP                                          0x3A06
+#define ERROR_AGENT_IO_FAILED                                           0x3A07
+
+#define ERROR_STORE_FILE_OPEN_FAILED                                    0x3B01
+#define ERROR_STORE_FILE_READ_FAILED                                    0x3B02
+#define ERROR_STORE_FILE_WRITE_FAILED                                   0x3B03
+#define ERROR_STORE_FILE_SYNC_FAILED                                    0x3B04
+#define ERROR_STORE_FILE_SWAP_FAILED                                    0x3B05
+
+#define ERROR_WAL_SYNC_INIT_FAILED                                      0x3C01
+#define ERROR_WAL_FAILED                                                0x3C02
+#define ERROR_WAL_CORRUPT                                               0x3C03
+
+#define ERROR_COLUMN_SNAPSHOT_INVALID_FIELD                             0x3D01
+#define ERROR_COLUMN_SNAPSHOT_INVALID_OPERATOR                          0x3D02
+#define ERROR_COLUMN_SNAPSHOT_NAME_NOT_FOUND                            0x3D03
+#define ERROR_COLUMN_SNAPSHOT_TOO_MANY_NAMES                            0x3D04
+
+#define ERROR_PERFECT_HASH_BUILD_FAILED                                 0x3E01
+#define ERROR_PERFECT_HASH_BAD_PARTITION                                0x3E02
+#define ERROR_PERFECT_HASH_INVALID_FORMAT                               0x3E03
@@ -0,0 +1,238 @@
+/**
+ * \file nepe2/frozen_metadata.h
+ *
+ * \brief A frozen metadata record is an immutable, reference counted copy of a
+ * complete \ref metadata record that can be shared between threads.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <nepe2/metadata.h>
+#include <rcpr/allocator.h>
+#include <rcpr/resource.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief A frozen metadata record.
+ *
+ * Every field of a frozen record, including the hash id, kdf name, and
+ * encoding, is packed into a single allocation. A frozen record is never
+ * modified after it is created, so it can be read from any number of threads
+ * without locks. Each reference is released by calling \ref resource_release on
+ * the resource handle, and the record is erased and reclaimed when the last
+ * reference is released. References are counted atomically, so they can be
+ * acquired and released from any thread.
+ */
+typedef struct frozen_metadata frozen_metadata;
+
+/******************************************************************************/
+/* Start of constructors.                                                     */
+/******************************************************************************/
+
+/**
+ * \brief Freeze a complete \ref metadata record.
+ *
+ * \param frozen        Pointer to the frozen record pointer to receive the
+ *                      frozen record on success.
+ * \param alloc         The allocator instance to use for this operation.
+ * \param meta          The record to freeze.
+ *
+ * \note The frozen record holds the only reference to itself. It is a
+ * \ref resource that must be released by calling \ref resource_release on its
+ * resource handle when it is no longer needed by the caller. The resource
+ * handle can be accessed by calling \ref frozen_metadata_resource_handle on
+ * this frozen record. The record is reclaimed with \p alloc by whichever thread
+ * releases the last reference, so \p alloc must be safe to use from any thread
+ * that may release a reference.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_METADATA_FIELD_NOT_SET if \p meta is empty.
+ *
+ * \pre
+ *      - \p frozen must not reference a valid \ref frozen_metadata instance and
+ *        must not be NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ *      - \p meta must reference a valid \ref metadata instance.
+ * \post
+ *      - On success, \p frozen is set to a pointer to a valid
+ *        \ref frozen_metadata instance, which is a \ref resource owned by the
+ *        caller that must be released when no longer needed. \p meta is
+ *        unchanged and is still owned by the caller.
+ *      - On failure, \p frozen is not changed and an error status is returned.
+ */
+status FN_DECL_MUST_CHECK
+metadata_freeze(
+    frozen_metadata** frozen, RCPR_SYM(allocator)* alloc,
+    const metadata* meta);
+
+/**
+ * \brief Acquire another reference to a frozen record.
+ *
+ * \param frozen        The \ref frozen_metadata instance to share.
+ *
+ * \note This is a single relaxed atomic increment. Each acquired reference
+ * must be released by calling \ref resource_release on the resource handle.
+ *
+ * \returns \p frozen.
+ */
+frozen_metadata*
+frozen_metadata_acquire(
+    frozen_metadata* frozen);
+
+/******************************************************************************/
+/* Start of accessors.                                                        */
+/******************************************************************************/
+
+/**
+ * \brief Given a \ref frozen_metadata instance, return the resource handle for
+ * this \ref frozen_metadata instance.
+ *
+ * \param frozen        The \ref frozen_metadata instance from which the
+ *                      resource handle is returned.
+ *
+ * \note Releasing this resource handle releases one reference.
+ *
+ * \returns the resource handle for this \ref frozen_metadata instance.
+ */
+RCPR_SYM(resource)*
+frozen_metadata_resource_handle(
+    frozen_metadata* frozen);
+
+/**
+ * \brief Get the hash id of a frozen record.
+ *
+ * \param hash_id_size  Pointer to receive the size of the hash id.
+ * \param frozen        The \ref frozen_metadata instance for this operation.
+ *
+ * \returns the hash id, which is owned by this frozen record.
+ */
+const void*
+frozen_metadata_hash_id_get(
+    size_t* hash_id_size, const frozen_metadata* frozen);
+
+/**
+ * \brief Get the ASCII zero terminated kdf name of a frozen record.
+ *
+ * \param frozen        The \ref frozen_metadata instance for this operation.
+ *
+ * \returns the kdf name, which is owned by this frozen record.
+ */
+const char*
+frozen_metadata_kdf_name_get(
+    const frozen_metadata* frozen);
+
+/**
+ * \brief Get the ASCII zero terminated encoding of a frozen record.
+ *
+ * \param frozen        The \ref frozen_metadata instance for this operation.
+ *
+ * \returns the encoding, which is owned by this frozen record.
+ */
+const char*
+frozen_metadata_encoding_get(
+    const frozen_metadata* frozen);
+
+/**
+ * \brief Get the version of a frozen record.
+ *
+ * \param frozen        The \ref frozen_metadata instance for this operation.
+ *
+ * \returns the version.
+ */
+uint32_t
+frozen_metadata_version_get(
+    const frozen_metadata* frozen);
+
+/**
+ * \brief Get the creation date of a frozen record.
+ *
+ * \param frozen        The \ref frozen_metadata instance for this operation.
+ *
+ * \returns the creation date.
+ */
+uint64_t
+frozen_metadata_creation_date_get(
+    const frozen_metadata* frozen);
+
+/**
+ * \brief Get the revocation date of a frozen record.
+ *
+ * \param frozen        The \ref frozen_metadata instance for this operation.
+ *
+ * \returns the revocation date.
+ */
+uint64_t
+frozen_metadata_revocation_date_get(
+    const frozen_metadata* frozen);
+
+/**
+ * \brief Get the expiration date of a frozen record.
+ *
+ * \param frozen        The \ref frozen_metadata instance for this operation.
+ *
+ * \returns the expiration date.
+ */
+uint64_t
+frozen_metadata_expiration_date_get(
+    const frozen_metadata* frozen);
+
+/**
+ * \brief Get the password length of a frozen record.
+ *
+ * \param frozen        The \ref frozen_metadata instance for this operation.
+ *
+ * \returns the password length.
+ */
+uint32_t
+frozen_metadata_password_length_get(
+    const frozen_metadata* frozen);
+
+/**
+ * \brief Get the generation of a frozen record.
+ *
+ * \param frozen        The \ref frozen_metadata instance for this operation.
+ *
+ * \returns the generation.
+ */
+uint32_t
+frozen_metadata_generation_get(
+    const frozen_metadata* frozen);
+
+/**
+ * \brief Get the legacy flag of a frozen record.
+ *
+ * \param frozen        The \ref frozen_metadata instance for this operation.
+ *
+ * \returns the legacy flag.
+ */
+bool
+frozen_metadata_legacy_flag_get(
+    const frozen_metadata* frozen);
+
+/**
+ * \brief Get the kdf cost of a frozen record.
+ *
+ * \param frozen        The \ref frozen_metadata instance for this operation.
+ *
+ * \returns the kdf cost, which is zero if the record has none.
+ */
+uint32_t
+frozen_metadata_kdf_cost_get(
+    const frozen_metadata* frozen);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
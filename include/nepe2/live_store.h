@@ -0,0 +1,328 @@
+/**
+ * \file nepe2/live_store.h
+ *
+ * \brief A live store publishes immutable snapshots of a \ref store plus
+ * appended records, so that readers never block on writers.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <nepe2/metadata.h>
+#include <nepe2/store.h>
+#include <rcpr/allocator.h>
+#include <rcpr/resource.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief A live store is a \ref store that can be appended to while it is
+ * being read.
+ *
+ * Readers see an immutable \ref live_store_snapshot, which is a base
+ * \ref store plus a small index of records appended since the base was loaded.
+ * Writers build a new snapshot and publish it with a single pointer swap.
+ * Readers never write shared memory while reading. Instead, each reader thread
+ * registers a \ref live_store_reader and periodically announces a quiescent
+ * state, at which point it holds no snapshot or record pointers. Snapshots and
+ * superseded records are reclaimed once every online reader has announced a
+ * quiescent state after they were replaced.
+ */
+typedef struct live_store live_store;
+
+/**
+ * \brief A live store reader is the registration of a single reader thread.
+ */
+typedef struct live_store_reader live_store_reader;
+
+/**
+ * \brief A live store snapshot is an immutable view of a \ref live_store.
+ */
+typedef struct live_store_snapshot live_store_snapshot;
+
+/******************************************************************************/
+/* Start of constructors.                                                     */
+/******************************************************************************/
+
+/**
+ * \brief Create a live store from the given base \ref store.
+ *
+ * \param ls            Pointer to the live store pointer to receive the live
+ *                      store on success.
+ * \param alloc         The allocator instance to use for this operation.
+ * \param base          The base \ref store for this live store.
+ *
+ * \note This live store is a \ref resource that must be released by calling
+ * \ref resource_release on its resource handle when it is no longer needed by
+ * the caller. The resource handle can be accessed by calling
+ * \ref live_store_resource_handle on this live store instance. Every
+ * \ref live_store_reader must be released before the live store is released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_LIVE_STORE_MUTEX_INIT_FAILED if the writer lock could not be
+ *        created.
+ *
+ * \pre
+ *      - \p ls must not reference a valid \ref live_store instance and must
+ *        not be NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ *      - \p base must reference a valid \ref store instance.
+ * \post
+ *      - On success, \p ls is set to a pointer to a valid \ref live_store
+ *        instance, which is a \ref resource owned by the caller that must be
+ *        released when no longer needed. The live store takes ownership of
+ *        \p base.
+ *      - On failure, \p ls is not changed, \p base is still owned by the
+ *        caller, and an error status is returned.
+ */
+status FN_DECL_MUST_CHECK
+live_store_create(
+    live_store** ls, RCPR_SYM(allocator)* alloc, store* base);
+
+/**
+ * \brief Register a reader with the given \ref live_store.
+ *
+ * \param reader        Pointer to the reader pointer to receive the reader on
+ *                      success.
+ * \param ls            The \ref live_store to read.
+ *
+ * \note This reader is a \ref resource that must be released by calling
+ * \ref resource_release on its resource handle when it is no longer needed by
+ * the caller. The resource handle can be accessed by calling
+ * \ref live_store_reader_resource_handle on this reader instance. A reader
+ * must only be used by one thread at a time. A new reader starts online.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *
+ * \pre
+ *      - \p reader must not reference a valid \ref live_store_reader instance
+ *        and must not be NULL.
+ *      - \p ls must reference a valid \ref live_store instance.
+ * \post
+ *      - On success, \p reader is set to a pointer to a valid
+ *        \ref live_store_reader instance, which is a \ref resource owned by
+ *        the caller that must be released when no longer needed.
+ *      - On failure, \p reader is not changed and an error status is returned.
+ */
+status FN_DECL_MUST_CHECK
+live_store_reader_create(
+    live_store_reader** reader, live_store* ls);
+
+/******************************************************************************/
+/* Start of accessors.                                                        */
+/******************************************************************************/
+
+/**
+ * \brief Given a \ref live_store instance, return the resource handle for this
+ * \ref live_store instance.
+ *
+ * \param ls            The \ref live_store instance from which the resource
+ *                      handle is returned.
+ *
+ * \returns the resource handle for this \ref live_store instance.
+ */
+RCPR_SYM(resource)*
+live_store_resource_handle(
+    live_store* ls);
+
+/**
+ * \brief Given a \ref live_store_reader instance, return the resource handle
+ * for this \ref live_store_reader instance.
+ *
+ * \param reader        The \ref live_store_reader instance from which the
+ *                      resource handle is returned.
+ *
+ * \returns the resource handle for this \ref live_store_reader instance.
+ */
+RCPR_SYM(resource)*
+live_store_reader_resource_handle(
+    live_store_reader* reader);
+
+/**
+ * \brief Get the current snapshot of a \ref live_store.
+ *
+ * \param reader        The online \ref live_store_reader for this operation.
+ *
+ * \note This performs a single acquire load and no writes. The snapshot, and
+ * every record found through it, remain valid until this reader next calls
+ * \ref live_store_reader_quiescent or \ref live_store_reader_offline.
+ *
+ * \returns the current snapshot.
+ */
+const live_store_snapshot*
+live_store_snapshot_get(
+    const live_store_reader* reader);
+
+/**
+ * \brief Look up a record by hash id in a \ref live_store_snapshot.
+ *
+ * \param meta          Pointer to receive the record on success.
+ * \param snap          The \ref live_store_snapshot for this operation.
+ * \param hash_id       The hash id to look up.
+ * \param hash_id_size  The size of the hash id.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_RECORD_NOT_FOUND if no record matches this hash id.
+ *
+ * \pre
+ *      - \p meta must be a valid pointer.
+ *      - \p snap must be a snapshot returned by \ref live_store_snapshot_get
+ *        that is still valid.
+ *      - \p hash_id must point to a valid memory region that is at least
+ *        \p hash_id_size bytes in length.
+ * \post
+ *      - On success, \p meta is set to the newest generation of the record
+ *        matching this hash id. This record is owned by the live store and
+ *        must not be modified or released by the caller.
+ *      - On failure, \p meta is unchanged.
+ */
+status FN_DECL_MUST_CHECK
+live_store_snapshot_lookup(
+    const metadata** meta, const live_store_snapshot* snap,
+    const void* hash_id, size_t hash_id_size);
+
+/**
+ * \brief Look up a record in a \ref live_store_snapshot, using a precomputed
+ * index hash.
+ *
+ * \param meta          Pointer to receive the record on success.
+ * \param snap          The \ref live_store_snapshot for this operation.
+ * \param hash          The index hash of this hash id, as computed by
+ *                      \ref store_hash_id_hash.
+ * \param hash_id       The hash id to look up.
+ * \param hash_id_size  The size of the hash id.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_RECORD_NOT_FOUND if no record matches this hash id.
+ *
+ * \pre
+ *      - \p meta must be a valid pointer.
+ *      - \p snap must be a snapshot returned by \ref live_store_snapshot_get
+ *        that is still valid.
+ *      - \p hash must be the index hash of \p hash_id.
+ *      - \p hash_id must point to a valid memory region that is at least
+ *        \p hash_id_size bytes in length.
+ * \post
+ *      - On success, \p meta is set to the newest generation of the record
+ *        matching this hash id. This record is owned by the live store and
+ *        must not be modified or released by the caller.
+ *      - On failure, \p meta is unchanged.
+ */
+status FN_DECL_MUST_CHECK
+live_store_snapshot_lookup_hashed(
+    const metadata** meta, const live_store_snapshot* snap, uint64_t hash,
+    const void* hash_id, size_t hash_id_size);
+
+/******************************************************************************/
+/* Start of reader methods.                                                   */
+/******************************************************************************/
+
+/**
+ * \brief Announce that this reader holds no snapshot or record pointers.
+ *
+ * \param reader        The \ref live_store_reader for this operation.
+ *
+ * \note Readers should call this between units of work, such as between
+ * requests. Snapshots replaced before this call may be reclaimed afterward.
+ * A reader that stays online without calling this method prevents
+ * reclamation.
+ */
+void
+live_store_reader_quiescent(
+    live_store_reader* reader);
+
+/**
+ * \brief Take a reader offline, for instance before it blocks for a long time.
+ *
+ * \param reader        The \ref live_store_reader for this operation.
+ *
+ * \note An offline reader does not hold up reclamation, and must not use any
+ * snapshot or record pointers until it is brought back online with
+ * \ref live_store_reader_online.
+ */
+void
+live_store_reader_offline(
+    live_store_reader* reader);
+
+/**
+ * \brief Bring an offline reader back online.
+ *
+ * \param reader        The \ref live_store_reader for this operation.
+ */
+void
+live_store_reader_online(
+    live_store_reader* reader);
+
+/******************************************************************************/
+/* Start of writer methods.                                                   */
+/******************************************************************************/
+
+/**
+ * \brief Append records to a \ref live_store and publish a new snapshot.
+ *
+ * \param ls            The \ref live_store for this operation.
+ * \param records       The records to append.
+ * \param count         The number of records to append.
+ *
+ * \note A record replaces any record with the same hash id and an older or
+ * equal generation, so new generations and revocations are both applied by
+ * appending the updated record. All records in one call are published with a
+ * single pointer swap, so writers should batch records where possible.
+ * Writers are serialized with respect to each other, but never block readers.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_METADATA_FIELD_NOT_SET if a record is empty.
+ *
+ * \pre
+ *      - \p ls must reference a valid \ref live_store instance.
+ *      - \p records must point to \p count valid, non-empty \ref metadata
+ *        instances that were created with the allocator of this live store.
+ * \post
+ *      - On success, the live store takes ownership of every record in
+ *        \p records.
+ *      - On failure, the records are still owned by the caller, and the
+ *        published snapshot is unchanged.
+ */
+status FN_DECL_MUST_CHECK
+live_store_append(
+    live_store* ls, metadata** records, size_t count);
+
+/**
+ * \brief Wait until every replaced snapshot has been reclaimed.
+ *
+ * \param ls            The \ref live_store for this operation.
+ *
+ * \note This blocks until every online reader has announced a quiescent state
+ * after the most recent publish. It must not be called from a thread that owns
+ * an online reader.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status FN_DECL_MUST_CHECK
+live_store_synchronize(
+    live_store* ls);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
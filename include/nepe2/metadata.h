@@ -15,6 +15,7 @@
 #include <rcpr/resource.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <sys/uio.h>
 
 /* C++ compatibility. */
 # ifdef   __cplusplus
@@ -26,6 +27,38 @@ extern "C" {
  */
 typedef struct metadata metadata;
 
+/**
+ * \brief The number of iovec entries used by \ref metadata_to_iovec for each
+ * record.
+ */
+#define METADATA_IOVEC_COUNT                                                 4
+
+/**
+ * \brief The scratch space used by \ref metadata_to_iovec for each record,
+ * which holds the fixed size header of the serialized record in its largest
+ * serial version.
+ */
+#define METADATA_IOVEC_SCRATCH_SIZE                                         58
+
+/**
+ * \brief The scratch space used by \ref metadata_to_iovec_batch for each
+ * record, which holds a big-endian uint32_t record size followed by the fixed
+ * size header of the serialized record.
+ */
+#define METADATA_IOVEC_FRAMED_SCRATCH_SIZE                                  62
+
+/**
+ * \brief The location of a serialized record in a larger region, such as a
+ * store image.
+ */
+typedef struct metadata_extent metadata_extent;
+
+struct metadata_extent
+{
+    size_t offset;
+    size_t size;
+};
+
 /******************************************************************************/
 /* Start of constructors.                                                     */
 /******************************************************************************/
@@ -137,6 +170,34 @@ status FN_DECL_MUST_CHECK
 metadata_hash_id_set_from_secure_buffer(
     metadata* meta, const secure_buffer* buffer);
 
+/**
+ * \brief Set the hash id for a given \ref metadata instance, taking ownership
+ * of the given \ref secure_buffer.
+ *
+ * \param meta          The metadata instance for this operation.
+ * \param buffer        The \ref secure_buffer holding the hash id.
+ *
+ * \note If this \ref metadata instance is currently empty, and if this is the
+ * last field to set in order to make it whole, then this setter will make the
+ * instance whole. Unlike \ref metadata_hash_id_set_from_secure_buffer, this
+ * setter does not copy the hash id.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code if the previous hash id could not be released.
+ *
+ * \pre
+ *      - \p meta must reference a valid \ref metadata instance.
+ *      - \p buffer must reference a valid \ref secure_buffer instance owned by
+ *        the caller.
+ * \post
+ *      - The \p hash_id field for this \ref metadata instance is set to
+ *        \p buffer, which is now owned by this instance.
+ */
+status FN_DECL_MUST_CHECK
+metadata_hash_id_move(
+    metadata* meta, secure_buffer* buffer);
+
 /**
  * \brief Get the hash id for a given \ref metadata instance.
  *
@@ -492,6 +553,53 @@ status FN_DECL_MUST_CHECK
 metadata_legacy_flag_get(
     bool* legacy_flag, const metadata* meta);
 
+/**
+ * \brief Set the kdf cost for a given \ref metadata instance.
+ *
+ * \param meta              The metadata instance for this operation.
+ * \param kdf_cost          The kdf cost for this operation.
+ *
+ * \note The kdf cost is the work factor the record was created with, which
+ * for the PBKDF2 modes is the iteration count. A record without a kdf cost,
+ * or with a kdf cost of zero, is derived with the cost of the derive context,
+ * and serializes as it did before kdf costs were recorded. Since the kdf cost
+ * is optional, it does not affect whether the instance is whole.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *
+ * \pre
+ *      - \p meta must reference a valid \ref metadata instance.
+ * \post
+ *      - On success, the \p kdf_cost field for this \ref metadata instance is
+ *        set to \p kdf_cost.
+ *      - On failure, \p meta is unchanged.
+ */
+status FN_DECL_MUST_CHECK
+metadata_kdf_cost_set(
+    metadata* meta, uint32_t kdf_cost);
+
+/**
+ * \brief Get the kdf cost for a given \ref metadata instance.
+ *
+ * \param kdf_cost          Pointer to hold the kdf cost on success.
+ * \param meta              The metadata instance for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *
+ * \pre
+ *      - \p kdf_cost must be a valid pointer.
+ *      - \p meta must reference a valid \ref metadata instance.
+ * \post
+ *      - On success, \p kdf_cost is set to the kdf cost of this instance, which
+ *        is zero if it was never set.
+ *      - On failure, \p kdf_cost is unchanged.
+ */
+status FN_DECL_MUST_CHECK
+metadata_kdf_cost_get(
+    uint32_t* kdf_cost, const metadata* meta);
+
 /**
  * \brief Get the empty flag for a given \ref metadata instance.
  *
@@ -536,6 +644,39 @@ status FN_DECL_MUST_CHECK
 metadata_kdf_name_set(
     metadata* meta, const char* kdf_name);
 
+/**
+ * \brief Set the KDF algorithm name for a given \ref metadata instance,
+ * taking ownership of the given \ref secure_buffer.
+ *
+ * \param meta          The metadata instance for this operation.
+ * \param buffer        The \ref secure_buffer holding the ASCII zero
+ *                      terminated kdf name.
+ *
+ * \note If this \ref metadata instance is currently empty, and if this is the
+ * last field to set in order to make it whole, then this setter will make the
+ * instance whole. Unlike \ref metadata_kdf_name_set, this setter does not copy
+ * the kdf name.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_METADATA_INVALID_STRING if the last byte of \p buffer is not its
+ *        only ASCII zero.
+ *      - an error code if the previous kdf name could not be released.
+ *
+ * \pre
+ *      - \p meta must reference a valid \ref metadata instance.
+ *      - \p buffer must reference a valid \ref secure_buffer instance owned by
+ *        the caller.
+ * \post
+ *      - On success, the \p kdf_name field for this \ref metadata instance is
+ *        set to \p buffer, which is now owned by this instance.
+ *      - If \p buffer is rejected, \p meta is unchanged and \p buffer is
+ *        released. In every case, the caller no longer owns \p buffer.
+ */
+status FN_DECL_MUST_CHECK
+metadata_kdf_name_move(
+    metadata* meta, secure_buffer* buffer);
+
 /**
  * \brief Get the kdf name for a given \ref metadata instance.
  *
@@ -586,6 +727,41 @@ status FN_DECL_MUST_CHECK
 metadata_encoding_set(
     metadata* meta, const char* encoding);
 
+/**
+ * \brief Set the encoding for a given \ref metadata instance, taking ownership
+ * of the given \ref secure_buffer.
+ *
+ * \param meta          The metadata instance for this operation.
+ * \param buffer        The \ref secure_buffer holding the ASCII zero
+ *                      terminated encoding.
+ *
+ * \note If this \ref metadata instance is currently empty, and if this is the
+ * last field to set in order to make it whole, then this setter will make the
+ * instance whole. Unlike \ref metadata_encoding_set, this setter does not copy
+ * the encoding.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_METADATA_INVALID_STRING if the last byte of \p buffer is not its
+ *        only ASCII zero.
+ *      - ERROR_METADATA_BAD_ENCODING_LENGTH if the encoding length is not
+ *        supported.
+ *      - an error code if the previous encoding could not be released.
+ *
+ * \pre
+ *      - \p meta must reference a valid \ref metadata instance.
+ *      - \p buffer must reference a valid \ref secure_buffer instance owned by
+ *        the caller.
+ * \post
+ *      - On success, the \p encoding field for this \ref metadata instance is
+ *        set to \p buffer, which is now owned by this instance.
+ *      - If \p buffer is rejected, \p meta is unchanged and \p buffer is
+ *        released. In every case, the caller no longer owns \p buffer.
+ */
+status FN_DECL_MUST_CHECK
+metadata_encoding_move(
+    metadata* meta, secure_buffer* buffer);
+
 /**
  * \brief Get the encoding for a given \ref metadata instance.
  *
@@ -636,6 +812,96 @@ status FN_DECL_MUST_CHECK
 metadata_to_buffer(
     secure_buffer** buffer, RCPR_SYM(allocator)* alloc, const metadata* meta);
 
+/**
+ * \brief Describe the serialized form of a metadata record as an iovec array,
+ * without copying the variable length fields.
+ *
+ * \param iov           Array of \ref METADATA_IOVEC_COUNT entries to fill.
+ * \param scratch       Scratch space of at least
+ *                      \ref METADATA_IOVEC_SCRATCH_SIZE bytes, which receives
+ *                      the fixed size header.
+ * \param size          Pointer to receive the total serialized size.
+ * \param meta          The metadata instance to serialize.
+ *
+ * \note Writing the filled entries in order, such as with a single call to
+ * writev, produces the same bytes as \ref metadata_to_buffer. The entries
+ * point into \p scratch and into storage owned by \p meta, so they are valid
+ * until either is changed or released. The caller should erase \p scratch
+ * after use.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_METADATA_FIELD_NOT_SET if \p meta is empty.
+ *
+ * \pre
+ *      - \p iov must point to at least \ref METADATA_IOVEC_COUNT entries.
+ *      - \p scratch must point to at least \ref METADATA_IOVEC_SCRATCH_SIZE
+ *        bytes.
+ *      - \p size must be a valid pointer.
+ *      - \p meta must reference a valid \ref metadata instance.
+ * \post
+ *      - On success, \p iov, \p scratch, and \p size are filled.
+ *      - On failure, \p iov, \p scratch, and \p size are unchanged.
+ */
+status FN_DECL_MUST_CHECK
+metadata_to_iovec(
+    struct iovec* iov, void* scratch, size_t* size, const metadata* meta);
+
+/**
+ * \brief Describe many metadata records as one iovec array, with each record
+ * framed by its size.
+ *
+ * \param iov           Array of \p count * \ref METADATA_IOVEC_COUNT entries
+ *                      to fill.
+ * \param scratch       Scratch space of at least \p count *
+ *                      \ref METADATA_IOVEC_FRAMED_SCRATCH_SIZE bytes.
+ * \param size          Pointer to receive the total size of every framed
+ *                      record.
+ * \param records       The records to serialize.
+ * \param count         The number of records.
+ *
+ * \note Each record is preceded by its size as a big-endian uint32_t, which is
+ * the record framing used by store images, so a store header followed by these
+ * entries is a complete store image. The lifetime rules of
+ * \ref metadata_to_iovec apply. \ref metadata_iovec_write writes arrays of any
+ * length.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_METADATA_FIELD_NOT_SET if any record is empty.
+ *
+ * \pre
+ *      - \p iov, \p scratch, and \p size must be valid pointers to storage of
+ *        at least the sizes given above.
+ *      - \p records must point to \p count valid \ref metadata instances.
+ * \post
+ *      - On success, \p iov, \p scratch, and \p size are filled.
+ *      - On failure, \p size is unchanged.
+ */
+status FN_DECL_MUST_CHECK
+metadata_to_iovec_batch(
+    struct iovec* iov, void* scratch, size_t* size,
+    const metadata* const* records, size_t count);
+
+/**
+ * \brief Write an iovec array to a file descriptor.
+ *
+ * \param fd            The file descriptor to write to.
+ * \param iov           The entries to write.
+ * \param count         The number of entries.
+ *
+ * \note This writes with as few writev calls as possible, splitting the array
+ * into chunks of at most IOV_MAX entries and resuming after partial writes.
+ * The entries in \p iov are modified as they are written.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_METADATA_WRITE_FAILED if a write failed.
+ */
+status FN_DECL_MUST_CHECK
+metadata_iovec_write(
+    int fd, struct iovec* iov, size_t count);
+
 /**
  * \brief Serialize a metadata record from a buffer.
  *
@@ -665,6 +931,83 @@ status FN_DECL_MUST_CHECK
 metadata_from_buffer(
     metadata** meta, RCPR_SYM(allocator)* alloc, const secure_buffer* buffer);
 
+/**
+ * \brief Read a metadata record from a raw memory region.
+ *
+ * \param meta          Pointer to hold the \ref metadata instance pointer on
+ *                      success.
+ * \param alloc         The allocator to use for this operation.
+ * \param data          Pointer to the serialized record.
+ * \param size          The size of the serialized record.
+ *
+ * \note This is the same as \ref metadata_from_buffer, but it allows records
+ * to be read in place from a larger region, such as a store image, without
+ * first copying each record into its own \ref secure_buffer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_METADATA_INVALID_BUFFER_SIZE if the record size is invalid.
+ *      - ERROR_METADATA_UNKNOWN_SERIAL_VERSION if the serial version is not
+ *        supported.
+ *
+ * \pre
+ *      - \p meta must be a valid pointer whose pointer value does not
+ *        reference a valid \ref metadata instance.
+ *      - \p alloc must reference a valid \ref allocator instance.
+ *      - \p data must point to a valid memory region that is at least \p size
+ *        bytes in length.
+ * \post
+ *      - On success, the \p meta pointer is updated to a pointer to a valid
+ *        \ref metadata instance holding the parsed data from \p data.
+ *      - On failure, \p meta is unchanged.
+ */
+status FN_DECL_MUST_CHECK
+metadata_from_data(
+    metadata** meta, RCPR_SYM(allocator)* alloc, const void* data, size_t size);
+
+/**
+ * \brief Check the fixed headers of a batch of serialized records, without
+ * reading the records.
+ *
+ * \param bad_index     Pointer to receive the index of the first invalid
+ *                      record on failure.
+ * \param data          The region holding the records.
+ * \param extents       Array of \p count record locations in \p data.
+ * \param count         The number of records.
+ *
+ * \note Each header is checked for the serial version, that the sizes of the
+ * variable length fields add up to the record size, that the string fields are
+ * not too long, and that the encoding size is a supported alphabet size. A
+ * record fails with the status code that \ref metadata_from_data would return,
+ * but no record is allocated. The alphabet size is taken from the serialized
+ * encoding size, so an encoding padded past its terminator, which
+ * \ref metadata_to_buffer never writes, is rejected. Where the CPU supports
+ * SSE4.1, headers are checked four at a time.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS if every header is valid.
+ *      - ERROR_METADATA_INVALID_BUFFER_SIZE if a record size is invalid.
+ *      - ERROR_METADATA_UNKNOWN_SERIAL_VERSION if a serial version is not
+ *        supported.
+ *      - ERROR_METADATA_BAD_ENCODING_LENGTH if an encoding size is not a
+ *        supported alphabet size.
+ *
+ * \pre
+ *      - \p bad_index must be a valid pointer.
+ *      - \p extents must point to \p count extents, each of which lies
+ *        within \p data.
+ * \post
+ *      - On failure, \p bad_index is set to the index of the first invalid
+ *        record. A scrub can resume the check after this record.
+ *      - On success, \p bad_index is unchanged.
+ */
+status FN_DECL_MUST_CHECK
+metadata_header_batch_check(
+    size_t* bad_index, const void* data, const metadata_extent* extents,
+    size_t count);
+
 /* C++ compatibility. */
 # ifdef   __cplusplus
 }
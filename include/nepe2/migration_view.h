@@ -0,0 +1,175 @@
+/**
+ * \file nepe2/migration_view.h
+ *
+ * \brief A migration view stacks several \ref store layers, so that records
+ * from older modes are found when the newest mode has no record.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <nepe2/metadata.h>
+#include <nepe2/store.h>
+#include <rcpr/allocator.h>
+#include <rcpr/resource.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief A migration view is an ordered stack of \ref store layers.
+ *
+ * Layer 0 is the oldest layer, such as the nepephemeral 0.x legacy layer. Each
+ * layer pushed onto the view is newer than the layers before it. A lookup
+ * resolves a hash id to the newest layer containing it.
+ */
+typedef struct migration_view migration_view;
+
+/******************************************************************************/
+/* Start of constructors.                                                     */
+/******************************************************************************/
+
+/**
+ * \brief Create an empty migration view.
+ *
+ * \param view          Pointer to the migration view pointer to receive the
+ *                      migration view on success.
+ * \param alloc         The allocator instance to use for this operation.
+ *
+ * \note This migration view is a \ref resource that must be released by
+ * calling \ref resource_release on its resource handle when it is no longer
+ * needed by the caller. The resource handle can be accessed by calling
+ * \ref migration_view_resource_handle on this migration view instance.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *
+ * \pre
+ *      - \p view must not reference a valid \ref migration_view instance and
+ *        must not be NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ * \post
+ *      - On success, \p view is set to a pointer to a valid
+ *        \ref migration_view instance, which is a \ref resource owned by the
+ *        caller that must be released when no longer needed.
+ *      - On failure, \p view is not changed and an error status is returned.
+ */
+status FN_DECL_MUST_CHECK
+migration_view_create(
+    migration_view** view, RCPR_SYM(allocator)* alloc);
+
+/******************************************************************************/
+/* Start of accessors.                                                        */
+/******************************************************************************/
+
+/**
+ * \brief Given a \ref migration_view instance, return the resource handle for
+ * this \ref migration_view instance.
+ *
+ * \param view          The \ref migration_view instance from which the
+ *                      resource handle is returned.
+ *
+ * \returns the resource handle for this \ref migration_view instance.
+ */
+RCPR_SYM(resource)*
+migration_view_resource_handle(
+    migration_view* view);
+
+/**
+ * \brief Get the number of layers in a \ref migration_view instance.
+ *
+ * \param view          The \ref migration_view instance for this operation.
+ *
+ * \returns the number of layers in this migration view.
+ */
+size_t
+migration_view_layer_count_get(
+    const migration_view* view);
+
+/**
+ * \brief Get a layer of a \ref migration_view instance.
+ *
+ * \param view          The \ref migration_view instance for this operation.
+ * \param layer         The index of the layer, which must be less than the
+ *                      layer count of this view.
+ *
+ * \returns the \ref store for this layer, which is owned by the view.
+ */
+const store*
+migration_view_layer_get(
+    const migration_view* view, size_t layer);
+
+/**
+ * \brief Look up a record by hash id in the newest layer that contains it.
+ *
+ * \param meta          Pointer to receive the record on success.
+ * \param layer         Pointer to receive the index of the layer that answered
+ *                      on success. Layer 0 is the oldest layer.
+ * \param view          The \ref migration_view instance for this operation.
+ * \param hash_id       The hash id to look up.
+ * \param hash_id_size  The size of the hash id.
+ *
+ * \note The index hash of \p hash_id is computed once and reused to probe
+ * every layer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_RECORD_NOT_FOUND if no layer contains this hash id.
+ *
+ * \pre
+ *      - \p meta and \p layer must be valid pointers.
+ *      - \p view must reference a valid \ref migration_view instance.
+ *      - \p hash_id must point to a valid memory region that is at least
+ *        \p hash_id_size bytes in length.
+ * \post
+ *      - On success, \p meta is set to the newest generation of the record in
+ *        the newest layer containing this hash id, and \p layer is set to the
+ *        index of that layer. This record is owned by the layer and must not
+ *        be modified or released by the caller.
+ *      - On failure, \p meta and \p layer are unchanged.
+ */
+status FN_DECL_MUST_CHECK
+migration_view_lookup(
+    const metadata** meta, size_t* layer, const migration_view* view,
+    const void* hash_id, size_t hash_id_size);
+
+/******************************************************************************/
+/* Start of mutators.                                                         */
+/******************************************************************************/
+
+/**
+ * \brief Push a new layer onto a \ref migration_view.
+ *
+ * \param view          The \ref migration_view instance for this operation.
+ * \param layer         The \ref store for this layer, which is newer than every
+ *                      layer already in this view.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *
+ * \pre
+ *      - \p view must reference a valid \ref migration_view instance.
+ *      - \p layer must reference a valid \ref store instance.
+ * \post
+ *      - On success, the migration view takes ownership of \p layer, and its
+ *        layer index is the previous layer count.
+ *      - On failure, \p layer is still owned by the caller.
+ */
+status FN_DECL_MUST_CHECK
+migration_view_layer_push(
+    migration_view* view, store* layer);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
@@ -0,0 +1,526 @@
+/**
+ * \file nepe2/nepe2.hpp
+ *
+ * \brief C++20 wrappers for the nepe2 base library.
+ *
+ * These wrappers own the underlying C resources and release them when they go
+ * out of scope. They are move-only, so ownership is transferred rather than
+ * copied, and data is exposed through std::span views of the underlying
+ * storage. Failures are reported by throwing \ref nepe2::error.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#if !defined(__cplusplus) || __cplusplus < 202002L
+# error "nepe2/nepe2.hpp requires C++20."
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <nepe2/error_codes.h>
+#include <nepe2/metadata.h>
+#include <nepe2/secure_buffer.h>
+#include <rcpr/allocator.h>
+#include <rcpr/resource.h>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace nepe2 {
+
+/**
+ * \brief An error returned by the nepe2 C API.
+ */
+class error : public std::runtime_error
+{
+public:
+    /**
+     * \brief Create an error from a status code.
+     *
+     * \param code          The status code returned by the C API.
+     */
+    explicit error(status code)
+        : std::runtime_error(
+            "nepe2 error " + std::to_string(static_cast<unsigned>(code)))
+        , code_(code)
+    {
+    }
+
+    /**
+     * \brief Get the status code for this error.
+     */
+    status code() const noexcept
+    {
+        return code_;
+    }
+
+private:
+    status code_;
+};
+
+namespace detail {
+
+/**
+ * \brief Throw an \ref error if the given status is not STATUS_SUCCESS.
+ */
+inline void check(status retval)
+{
+    if (STATUS_SUCCESS != retval)
+    {
+        throw error(retval);
+    }
+}
+
+/**
+ * \brief Release a resource from a destructor, where errors can't be thrown.
+ */
+inline void release(RCPR_SYM(resource)* r) noexcept
+{
+    if (STATUS_SUCCESS != RCPR_SYM(resource_release)(r))
+    {
+        /* there is no way to report this from a destructor. */
+    }
+}
+
+} /* namespace detail */
+
+/**
+ * \brief A move-only owner of a C \ref secure_buffer.
+ */
+class secure_buffer
+{
+public:
+    /**
+     * \brief Create an empty owner.
+     */
+    secure_buffer() noexcept = default;
+
+    /**
+     * \brief Create a zeroed secure buffer of the given size.
+     *
+     * \param alloc         The allocator to use for this buffer.
+     * \param size          The size of this buffer, which must be non-zero.
+     */
+    secure_buffer(RCPR_SYM(allocator)* alloc, std::size_t size)
+    {
+        detail::check(secure_buffer_create(&buffer_, alloc, size));
+    }
+
+    /**
+     * \brief Create a secure buffer holding a copy of the given bytes.
+     *
+     * \param alloc         The allocator to use for this buffer.
+     * \param bytes         The bytes to copy, which must not be empty.
+     */
+    secure_buffer(
+        RCPR_SYM(allocator)* alloc, std::span<const std::byte> bytes)
+        : secure_buffer(alloc, bytes.size())
+    {
+        std::ranges::copy(bytes, span().begin());
+    }
+
+    /**
+     * \brief Take ownership of a C secure buffer.
+     *
+     * \param buffer        The buffer to adopt.
+     */
+    static secure_buffer adopt(::secure_buffer* buffer) noexcept
+    {
+        secure_buffer tmp;
+        tmp.buffer_ = buffer;
+
+        return tmp;
+    }
+
+    secure_buffer(const secure_buffer&) = delete;
+    secure_buffer& operator=(const secure_buffer&) = delete;
+
+    secure_buffer(secure_buffer&& other) noexcept
+        : buffer_(std::exchange(other.buffer_, nullptr))
+    {
+    }
+
+    secure_buffer& operator=(secure_buffer&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            buffer_ = std::exchange(other.buffer_, nullptr);
+        }
+
+        return *this;
+    }
+
+    ~secure_buffer()
+    {
+        reset();
+    }
+
+    /**
+     * \brief Release the owned buffer, erasing its contents.
+     */
+    void reset() noexcept
+    {
+        if (nullptr != buffer_)
+        {
+            detail::release(
+                secure_buffer_resource_handle(
+                    std::exchange(buffer_, nullptr)));
+        }
+    }
+
+    /**
+     * \brief Give up ownership of the C secure buffer.
+     *
+     * \returns the C secure buffer, which is now owned by the caller.
+     */
+    [[nodiscard]] ::secure_buffer* release() noexcept
+    {
+        return std::exchange(buffer_, nullptr);
+    }
+
+    /**
+     * \brief Get the C secure buffer without transferring ownership.
+     */
+    ::secure_buffer* get() const noexcept
+    {
+        return buffer_;
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return nullptr != buffer_;
+    }
+
+    /**
+     * \brief Get a writable view of this buffer.
+     */
+    std::span<std::byte> span() noexcept
+    {
+        return view();
+    }
+
+    /**
+     * \brief Get a read-only view of this buffer.
+     */
+    std::span<const std::byte> span() const noexcept
+    {
+        return view();
+    }
+
+    /**
+     * \brief Get the size of this buffer.
+     */
+    std::size_t size() const noexcept
+    {
+        return view().size();
+    }
+
+private:
+    std::span<std::byte> view() const noexcept
+    {
+        std::size_t size = 0;
+
+        if (nullptr == buffer_)
+        {
+            return {};
+        }
+
+        void* data = secure_buffer_data(&size, buffer_);
+
+        return { static_cast<std::byte*>(data), size };
+    }
+
+    ::secure_buffer* buffer_ = nullptr;
+};
+
+/**
+ * \brief A move-only owner of a C \ref metadata record.
+ */
+class metadata
+{
+public:
+    /**
+     * \brief Create an empty owner.
+     */
+    metadata() noexcept = default;
+
+    /**
+     * \brief Create an empty metadata record.
+     *
+     * \param alloc         The allocator to use for this record.
+     */
+    explicit metadata(RCPR_SYM(allocator)* alloc)
+    {
+        detail::check(metadata_create(&meta_, alloc));
+    }
+
+    /**
+     * \brief Read a metadata record from its serialized form.
+     *
+     * \param alloc         The allocator to use for this record.
+     * \param data          The serialized record.
+     */
+    static metadata from_data(
+        RCPR_SYM(allocator)* alloc, std::span<const std::byte> data)
+    {
+        metadata tmp;
+        detail::check(
+            metadata_from_data(&tmp.meta_, alloc, data.data(), data.size()));
+
+        return tmp;
+    }
+
+    /**
+     * \brief Take ownership of a C metadata record.
+     *
+     * \param meta          The record to adopt.
+     */
+    static metadata adopt(::metadata* meta) noexcept
+    {
+        metadata tmp;
+        tmp.meta_ = meta;
+
+        return tmp;
+    }
+
+    metadata(const metadata&) = delete;
+    metadata& operator=(const metadata&) = delete;
+
+    metadata(metadata&& other) noexcept
+        : meta_(std::exchange(other.meta_, nullptr))
+    {
+    }
+
+    metadata& operator=(metadata&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            meta_ = std::exchange(other.meta_, nullptr);
+        }
+
+        return *this;
+    }
+
+    ~metadata()
+    {
+        reset();
+    }
+
+    /**
+     * \brief Release the owned record.
+     */
+    void reset() noexcept
+    {
+        if (nullptr != meta_)
+        {
+            detail::release(
+                metadata_resource_handle(std::exchange(meta_, nullptr)));
+        }
+    }
+
+    /**
+     * \brief Give up ownership of the C metadata record.
+     *
+     * \returns the C metadata record, which is now owned by the caller.
+     */
+    [[nodiscard]] ::metadata* release() noexcept
+    {
+        return std::exchange(meta_, nullptr);
+    }
+
+    /**
+     * \brief Get the C metadata record without transferring ownership.
+     */
+    ::metadata* get() const noexcept
+    {
+        return meta_;
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return nullptr != meta_;
+    }
+
+    /**
+     * \brief Returns true if any field of this record is not yet set.
+     */
+    bool empty() const noexcept
+    {
+        return metadata_empty_flag_get(meta_);
+    }
+
+    /**
+     * \brief Serialize this record.
+     *
+     * \param alloc         The allocator to use for the serialized buffer.
+     */
+    nepe2::secure_buffer to_buffer(RCPR_SYM(allocator)* alloc) const
+    {
+        ::secure_buffer* tmp = nullptr;
+        detail::check(metadata_to_buffer(&tmp, alloc, meta_));
+
+        return nepe2::secure_buffer::adopt(tmp);
+    }
+
+    /* hash id. */
+    std::span<const std::byte> hash_id() const
+    {
+        const void* data = nullptr;
+        std::size_t size = 0;
+        detail::check(metadata_hash_id_get(&data, &size, meta_));
+
+        return { static_cast<const std::byte*>(data), size };
+    }
+
+    void hash_id(std::span<const std::byte> hash_id)
+    {
+        detail::check(
+            metadata_hash_id_set(meta_, hash_id.data(), hash_id.size()));
+    }
+
+    void hash_id(nepe2::secure_buffer&& buffer)
+    {
+        detail::check(metadata_hash_id_move(meta_, buffer.release()));
+    }
+
+    /* kdf name. */
+    std::string_view kdf_name() const
+    {
+        const char* name = nullptr;
+        detail::check(metadata_kdf_name_get(&name, meta_));
+
+        return name;
+    }
+
+    void kdf_name(const char* name)
+    {
+        detail::check(metadata_kdf_name_set(meta_, name));
+    }
+
+    void kdf_name(nepe2::secure_buffer&& buffer)
+    {
+        detail::check(metadata_kdf_name_move(meta_, buffer.release()));
+    }
+
+    /* encoding. */
+    std::string_view encoding() const
+    {
+        const char* encoding = nullptr;
+        detail::check(metadata_encoding_get(&encoding, meta_));
+
+        return encoding;
+    }
+
+    void encoding(const char* encoding)
+    {
+        detail::check(metadata_encoding_set(meta_, encoding));
+    }
+
+    void encoding(nepe2::secure_buffer&& buffer)
+    {
+        detail::check(metadata_encoding_move(meta_, buffer.release()));
+    }
+
+    /* scalar fields. */
+    uint32_t version() const
+    {
+        return get(&metadata_version_get);
+    }
+
+    void version(uint32_t version)
+    {
+        detail::check(metadata_version_set(meta_, version));
+    }
+
+    uint64_t creation_date() const
+    {
+        return get(&metadata_creation_date_get);
+    }
+
+    void creation_date(uint64_t date)
+    {
+        detail::check(metadata_creation_date_set(meta_, date));
+    }
+
+    uint64_t revocation_date() const
+    {
+        return get(&metadata_revocation_date_get);
+    }
+
+    void revocation_date(uint64_t date)
+    {
+        detail::check(metadata_revocation_date_set(meta_, date));
+    }
+
+    uint64_t expiration_date() const
+    {
+        return get(&metadata_expiration_date_get);
+    }
+
+    void expiration_date(uint64_t date)
+    {
+        detail::check(metadata_expiration_date_set(meta_, date));
+    }
+
+    uint32_t password_length() const
+    {
+        return get(&metadata_password_length_get);
+    }
+
+    void password_length(uint32_t length)
+    {
+        detail::check(metadata_password_length_set(meta_, length));
+    }
+
+    uint32_t generation() const
+    {
+        return get(&metadata_generation_get);
+    }
+
+    void generation(uint32_t generation)
+    {
+        detail::check(metadata_generation_set(meta_, generation));
+    }
+
+    uint32_t kdf_cost() const
+    {
+        return get(&metadata_kdf_cost_get);
+    }
+
+    void kdf_cost(uint32_t cost)
+    {
+        detail::check(metadata_kdf_cost_set(meta_, cost));
+    }
+
+    bool legacy_flag() const
+    {
+        return get(&metadata_legacy_flag_get);
+    }
+
+    void legacy_flag(bool flag)
+    {
+        detail::check(metadata_legacy_flag_set(meta_, flag));
+    }
+
+private:
+    template <typename T>
+    T get(status (*getter)(T*, const ::metadata*)) const
+    {
+        T value{};
+        detail::check(getter(&value, meta_));
+
+        return value;
+    }
+
+    ::metadata* meta_ = nullptr;
+};
+
+} /* namespace nepe2 */
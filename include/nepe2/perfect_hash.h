@@ -0,0 +1,277 @@
+/**
+ * \file nepe2/perfect_hash.h
+ *
+ * \brief A perfect hash maps each key of a fixed set of 64-bit keys to its own
+ * slot, with no empty slots, using a few bits per key.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <nepe2/secure_buffer.h>
+#include <rcpr/allocator.h>
+#include <rcpr/resource.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief The magic number at the start of a serialized perfect hash ("NP2H").
+ */
+#define PERFECT_HASH_MAGIC                                          0x4e503248
+
+/**
+ * \brief The serialized perfect hash format version supported by this
+ * library.
+ */
+#define PERFECT_HASH_FORMAT_VERSION_1                               0x00000001
+
+/**
+ * \brief The slot returned for a key that is not in the set.
+ */
+#define PERFECT_HASH_NOT_FOUND                                      UINT64_MAX
+
+/**
+ * \brief A perfect hash is an immutable minimal perfect hash function over a
+ * set of distinct 64-bit keys.
+ *
+ * The keys are split into partitions by their value modulo the partition
+ * count, and each partition has its own function. A partition's function is a
+ * cascade of bit arrays: at each level, every remaining key hashes to one bit
+ * of the level's array, the bits hit by exactly one key are set, and the other
+ * keys move on to the next, smaller, level. The slot of a key is the number of
+ * set bits before its bit, across all partitions in order, so the keys of
+ * partition p occupy a contiguous run of slots after those of partitions
+ * 0 .. p - 1. With one array bit per remaining key, this uses about three bits
+ * per key, plus a rank sample per 512 bits once loaded.
+ *
+ * The serialized form consists of the following big-endian fields:
+ *      - magic (uint32_t), which must be \ref PERFECT_HASH_MAGIC.
+ *      - format version (uint32_t).
+ *      - partition count (uint32_t).
+ *      - reserved (uint32_t), which must be zero.
+ *      - key count (uint64_t).
+ *      - level count (uint64_t).
+ *      - word count (uint64_t).
+ *      - the first level of each partition (uint32_t), followed by the level
+ *        count, and padded with zeros to a multiple of eight bytes.
+ *      - the first word of each level (uint64_t), followed by the word count.
+ *      - the words of the level bit arrays (uint64_t).
+ */
+typedef struct perfect_hash perfect_hash;
+
+/**
+ * \brief A perfect hash builder builds a \ref perfect_hash one partition at a
+ * time.
+ */
+typedef struct perfect_hash_builder perfect_hash_builder;
+
+/******************************************************************************/
+/* Start of constructors.                                                     */
+/******************************************************************************/
+
+/**
+ * \brief Create a perfect hash builder.
+ *
+ * \param builder       Pointer to the perfect hash builder pointer to receive
+ *                      the builder on success.
+ * \param alloc         The allocator instance to use for this operation.
+ * \param partition_count   The number of partitions, which must be at least
+ *                      1.
+ *
+ * \note This perfect hash builder is a \ref resource that must be released by
+ * calling \ref resource_release on its resource handle when it is no longer
+ * needed by the caller. The resource handle can be accessed by calling
+ * \ref perfect_hash_builder_resource_handle on this builder instance.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *
+ * \pre
+ *      - \p builder must not reference a valid \ref perfect_hash_builder
+ *        instance and must not be NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ * \post
+ *      - On success, \p builder is set to a pointer to a valid
+ *        \ref perfect_hash_builder instance, which is a \ref resource owned by
+ *        the caller that must be released when no longer needed.
+ *      - On failure, \p builder is not changed and an error status is
+ *        returned.
+ */
+status FN_DECL_MUST_CHECK
+perfect_hash_builder_create(
+    perfect_hash_builder** builder, RCPR_SYM(allocator)* alloc,
+    size_t partition_count);
+
+/**
+ * \brief Load a serialized \ref perfect_hash.
+ *
+ * \param ph            Pointer to the perfect hash pointer to receive the
+ *                      perfect hash on success.
+ * \param alloc         The allocator instance to use for this operation.
+ * \param data          The serialized perfect hash.
+ * \param size          The size of the serialized perfect hash.
+ *
+ * \note The bit arrays are copied, and the rank samples are rebuilt from
+ * them, so the perfect hash does not refer to \p data after it is created.
+ *
+ * This perfect hash is a \ref resource that must be released by calling
+ * \ref resource_release on its resource handle when it is no longer needed by
+ * the caller. The resource handle can be accessed by calling
+ * \ref perfect_hash_resource_handle on this perfect hash instance.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_PERFECT_HASH_INVALID_FORMAT if the data is not a valid
+ *        serialized perfect hash.
+ *
+ * \pre
+ *      - \p ph must not reference a valid \ref perfect_hash instance and must
+ *        not be NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ *      - \p data must point to at least \p size readable bytes.
+ * \post
+ *      - On success, \p ph is set to a pointer to a valid \ref perfect_hash
+ *        instance, which is a \ref resource owned by the caller that must be
+ *        released when no longer needed.
+ *      - On failure, \p ph is not changed and an error status is returned.
+ */
+status FN_DECL_MUST_CHECK
+perfect_hash_create_from_data(
+    perfect_hash** ph, RCPR_SYM(allocator)* alloc, const void* data,
+    size_t size);
+
+/******************************************************************************/
+/* Start of accessors.                                                        */
+/******************************************************************************/
+
+/**
+ * \brief Given a \ref perfect_hash_builder instance, return the resource
+ * handle for this \ref perfect_hash_builder instance.
+ *
+ * \param builder       The \ref perfect_hash_builder instance from which the
+ *                      resource handle is returned.
+ *
+ * \returns the resource handle for this \ref perfect_hash_builder instance.
+ */
+RCPR_SYM(resource)*
+perfect_hash_builder_resource_handle(
+    perfect_hash_builder* builder);
+
+/**
+ * \brief Given a \ref perfect_hash instance, return the resource handle for
+ * this \ref perfect_hash instance.
+ *
+ * \param ph            The \ref perfect_hash instance from which the resource
+ *                      handle is returned.
+ *
+ * \returns the resource handle for this \ref perfect_hash instance.
+ */
+RCPR_SYM(resource)*
+perfect_hash_resource_handle(
+    perfect_hash* ph);
+
+/**
+ * \brief Get the number of keys in a \ref perfect_hash.
+ *
+ * \param ph            The \ref perfect_hash instance for this operation.
+ *
+ * \returns the number of keys, which is also the number of slots.
+ */
+uint64_t
+perfect_hash_key_count_get(
+    const perfect_hash* ph);
+
+/******************************************************************************/
+/* Start of builder methods.                                                  */
+/******************************************************************************/
+
+/**
+ * \brief Add the keys of the next partition to a \ref perfect_hash_builder.
+ *
+ * \param slots         Array of \p count entries to receive the slot of each
+ *                      key on success.
+ * \param builder       The \ref perfect_hash_builder for this operation.
+ * \param keys          The distinct keys of this partition.
+ * \param count         The number of keys.
+ *
+ * \note Partitions are added in order, starting with partition 0, and each key
+ * must be in the partition being added. The slots of a partition are the
+ * \p count slots that follow those of the partitions added before it.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_PERFECT_HASH_BAD_PARTITION if every partition has already been
+ *        added, or if a key is not in this partition.
+ *      - ERROR_PERFECT_HASH_BUILD_FAILED if the keys could not be separated,
+ *        which happens if a key is repeated.
+ *
+ * \post
+ *      - On failure, the builder is unchanged.
+ */
+status FN_DECL_MUST_CHECK
+perfect_hash_builder_partition_add(
+    uint64_t* slots, perfect_hash_builder* builder, const uint64_t* keys,
+    size_t count);
+
+/**
+ * \brief Serialize the perfect hash built by a \ref perfect_hash_builder.
+ *
+ * \param buffer        Pointer to receive the serialized perfect hash on
+ *                      success.
+ * \param alloc         The allocator to use for the buffer.
+ * \param builder       The \ref perfect_hash_builder for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_PERFECT_HASH_BAD_PARTITION if not every partition has been
+ *        added.
+ *
+ * \post
+ *      - On success, \p buffer is set to a \ref secure_buffer owned by the
+ *        caller.
+ *      - On failure, \p buffer is not changed.
+ */
+status FN_DECL_MUST_CHECK
+perfect_hash_builder_emit(
+    secure_buffer** buffer, RCPR_SYM(allocator)* alloc,
+    const perfect_hash_builder* builder);
+
+/******************************************************************************/
+/* Start of methods.                                                          */
+/******************************************************************************/
+
+/**
+ * \brief Get the slot of a key in a \ref perfect_hash.
+ *
+ * \param ph            The \ref perfect_hash instance for this operation.
+ * \param key           The key to look up.
+ *
+ * \note A key in the set always gets its own slot. A key that is not in the
+ * set gets either \ref PERFECT_HASH_NOT_FOUND or the slot of some other key,
+ * so the caller must check the entry in the slot.
+ *
+ * \returns the slot of this key, or \ref PERFECT_HASH_NOT_FOUND.
+ */
+uint64_t
+perfect_hash_lookup(
+    const perfect_hash* ph, uint64_t key);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
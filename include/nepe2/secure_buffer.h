@@ -24,6 +24,33 @@ extern "C" {
  */
 typedef struct secure_buffer secure_buffer;
 
+/**
+ * \brief A secure buffer builder is a growable buffer that is finalized into a
+ * \ref secure_buffer.
+ *
+ * When a builder grows, its contents are copied to a larger region and the old
+ * region is erased before it is reclaimed, so no stale copies of its contents
+ * are left behind. Capacity grows geometrically, so appending n bytes in any
+ * number of steps copies O(n) bytes in total. Finalizing a builder hands its
+ * storage to a new \ref secure_buffer without copying it.
+ */
+typedef struct secure_buffer_builder secure_buffer_builder;
+
+/**
+ * \brief A secure buffer cache keeps per-thread caches of zeroed secure buffer
+ * blocks for one allocator.
+ *
+ * While a cache exists for an allocator, \ref secure_buffer_create takes small
+ * buffers for that allocator from the cache instead of the allocator. Each
+ * thread holds two magazines of blocks per size class, so most creates and
+ * releases touch only memory owned by the calling thread. Full and empty
+ * magazines are exchanged through a lock-free depot shared by all threads, so
+ * a block released by one thread can be reused by another. The buffer header
+ * and its data share one block, and a block is erased when its buffer is
+ * released, so blocks are handed out already zeroed.
+ */
+typedef struct secure_buffer_cache secure_buffer_cache;
+
 /******************************************************************************/
 /* Start of constructors.                                                     */
 /******************************************************************************/
@@ -39,7 +66,9 @@ typedef struct secure_buffer secure_buffer;
  * \note This secure buffer is a \ref resource that must be released by calling
  * \ref resource_release on its resource handle when it is no longer needed by
  * the caller. The resource handle can be accessed by calling
- * \ref secure_buffer_resource_handle on this secure buffer instance.
+ * \ref secure_buffer_resource_handle on this secure buffer instance. If
+ * \p alloc has a \ref secure_buffer_cache, a small buffer is taken from the
+ * cache of the calling thread.
  *
  * \returns a status code indicating success or failure.
  *      - STATUS_SUCCESS on success.
@@ -60,6 +89,78 @@ status FN_DECL_MUST_CHECK
 secure_buffer_create(
     secure_buffer** buffer, RCPR_SYM(allocator)* alloc, size_t size);
 
+/**
+ * \brief Create a secure buffer builder using the given allocator.
+ *
+ * \param builder       Pointer to the pointer to receive the builder on
+ *                      success.
+ * \param alloc         The allocator instance to use for this operation.
+ * \param capacity      The initial capacity of this builder, which may be 0.
+ *
+ * \note This builder is a \ref resource that must be released by calling
+ * \ref resource_release on its resource handle when it is no longer needed by
+ * the caller, even after it has been finalized. The resource handle can be
+ * accessed by calling \ref secure_buffer_builder_resource_handle on this
+ * builder instance.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *
+ * \pre
+ *      - \p builder must not reference a valid \ref secure_buffer_builder
+ *        instance and must not be NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ * \post
+ *      - On success, \p builder is set to a pointer to a valid, empty
+ *        \ref secure_buffer_builder instance, which is a \ref resource owned
+ *        by the caller that must be released when no longer needed.
+ *      - On failure, \p builder is not changed and an error status is
+ *        returned.
+ */
+status FN_DECL_MUST_CHECK
+secure_buffer_builder_create(
+    secure_buffer_builder** builder, RCPR_SYM(allocator)* alloc,
+    size_t capacity);
+
+/**
+ * \brief Create a secure buffer cache for the given allocator.
+ *
+ * \param cache         Pointer to the pointer to receive the cache on success.
+ * \param alloc         The allocator to cache, which must be thread-safe.
+ *
+ * \note This cache is a \ref resource that must be released by calling
+ * \ref resource_release on its resource handle when it is no longer needed by
+ * the caller. The resource handle can be accessed by calling
+ * \ref secure_buffer_cache_resource_handle on this cache instance. Every
+ * secure buffer created from \p alloc while the cache exists must be released
+ * before the cache, and no thread may create or release a secure buffer from
+ * \p alloc while the cache is being released. Blocks held by the cache are
+ * returned to \p alloc when the cache is released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_SECURE_BUFFER_CACHE_EXISTS if \p alloc already has a cache.
+ *      - ERROR_SECURE_BUFFER_CACHE_INIT_FAILED if the thread-local storage for
+ *        the cache could not be created, or too many caches exist.
+ *
+ * \pre
+ *      - \p cache must not reference a valid \ref secure_buffer_cache instance
+ *        and must not be NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ * \post
+ *      - On success, \p cache is set to a pointer to a valid
+ *        \ref secure_buffer_cache instance, which is a \ref resource owned by
+ *        the caller that must be released before \p alloc.
+ *      - On failure, \p cache is not changed and an error status is returned.
+ */
+status FN_DECL_MUST_CHECK
+secure_buffer_cache_create(
+    secure_buffer_cache** cache, RCPR_SYM(allocator)* alloc);
+
 /******************************************************************************/
 /* Start of accessors.                                                        */
 /******************************************************************************/
@@ -89,6 +190,185 @@ void*
 secure_buffer_data(
     size_t* size, secure_buffer* buffer);
 
+/**
+ * \brief Given a \ref secure_buffer_builder instance, return the resource
+ * handle for this \ref secure_buffer_builder instance.
+ *
+ * \param builder       The \ref secure_buffer_builder instance from which the
+ *                      resource handle is returned.
+ *
+ * \returns the resource handle for this \ref secure_buffer_builder instance.
+ */
+RCPR_SYM(resource)*
+secure_buffer_builder_resource_handle(
+    secure_buffer_builder* builder);
+
+/**
+ * \brief Given a \ref secure_buffer_cache instance, return the resource handle
+ * for this \ref secure_buffer_cache instance.
+ *
+ * \param cache         The \ref secure_buffer_cache instance from which the
+ *                      resource handle is returned.
+ *
+ * \returns the resource handle for this \ref secure_buffer_cache instance.
+ */
+RCPR_SYM(resource)*
+secure_buffer_cache_resource_handle(
+    secure_buffer_cache* cache);
+
+/**
+ * \brief Get the number of bytes appended to a \ref secure_buffer_builder.
+ *
+ * \param builder       The \ref secure_buffer_builder instance to access.
+ *
+ * \returns the size of this builder.
+ */
+size_t
+secure_buffer_builder_size_get(
+    const secure_buffer_builder* builder);
+
+/**
+ * \brief Given a \ref secure_buffer_builder instance, return the data pointer
+ * and size.
+ *
+ * \param size          Pointer to the size variable to receive the size.
+ * \param builder       The \ref secure_buffer_builder instance to access.
+ *
+ * \note The returned pointer is valid until this builder next grows, is
+ * consumed, is finalized, or is released. It is NULL if this builder has never
+ * grown.
+ *
+ * \returns the data pointer for this builder.
+ */
+void*
+secure_buffer_builder_data(
+    size_t* size, secure_buffer_builder* builder);
+
+/******************************************************************************/
+/* Start of builder methods.                                                  */
+/******************************************************************************/
+
+/**
+ * \brief Make room to append at least the given number of bytes to a
+ * \ref secure_buffer_builder without growing it again.
+ *
+ * \param builder       The \ref secure_buffer_builder for this operation.
+ * \param additional    The number of bytes to make room for.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *
+ * \post
+ *      - On failure, the contents of this builder are unchanged.
+ */
+status FN_DECL_MUST_CHECK
+secure_buffer_builder_reserve(
+    secure_buffer_builder* builder, size_t additional);
+
+/**
+ * \brief Extend a \ref secure_buffer_builder by the given number of bytes,
+ * returning the new region so that it can be written in place.
+ *
+ * \param data          Pointer to receive the start of the new region, which
+ *                      is zeroed.
+ * \param builder       The \ref secure_buffer_builder for this operation.
+ * \param size          The number of bytes to extend this builder by.
+ *
+ * \note The returned pointer is valid until this builder next grows, is
+ * finalized, or is released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *
+ * \post
+ *      - On failure, \p data and the contents of this builder are unchanged.
+ */
+status FN_DECL_MUST_CHECK
+secure_buffer_builder_extend(
+    void** data, secure_buffer_builder* builder, size_t size);
+
+/**
+ * \brief Append a copy of the given bytes to a \ref secure_buffer_builder.
+ *
+ * \param builder       The \ref secure_buffer_builder for this operation.
+ * \param data          The bytes to append.
+ * \param size          The number of bytes to append.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *
+ * \post
+ *      - On failure, the contents of this builder are unchanged.
+ */
+status FN_DECL_MUST_CHECK
+secure_buffer_builder_append(
+    secure_buffer_builder* builder, const void* data, size_t size);
+
+/**
+ * \brief Remove bytes from the front of a \ref secure_buffer_builder.
+ *
+ * \param builder       The \ref secure_buffer_builder for this operation.
+ * \param size          The number of bytes to remove, which must not be
+ *                      greater than the size of this builder.
+ *
+ * \note The remaining bytes are moved to the front of this builder, and the
+ * bytes vacated at the end are erased. This lets a builder be used as a
+ * queue, such as for buffering a stream, without reallocating it.
+ */
+void
+secure_buffer_builder_consume(
+    secure_buffer_builder* builder, size_t size);
+
+/**
+ * \brief Remove bytes from the end of a \ref secure_buffer_builder.
+ *
+ * \param builder       The \ref secure_buffer_builder for this operation.
+ * \param size          The new size of this builder, which must not be
+ *                      greater than its current size.
+ *
+ * \note The removed bytes are erased. This lets a caller undo a partial
+ * append, or give back the unused part of a region from
+ * \ref secure_buffer_builder_extend.
+ */
+void
+secure_buffer_builder_truncate(
+    secure_buffer_builder* builder, size_t size);
+
+/**
+ * \brief Finalize a \ref secure_buffer_builder into a \ref secure_buffer.
+ *
+ * \param buffer        Pointer to the pointer to receive the secure buffer on
+ *                      success.
+ * \param builder       The \ref secure_buffer_builder to finalize.
+ *
+ * \note The storage of this builder is handed to the secure buffer without
+ * copying it. The builder is left empty and can be reused, but it must still
+ * be released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_SECURE_BUFFER_BUILDER_EMPTY if nothing has been appended to
+ *        this builder.
+ *
+ * \post
+ *      - On success, \p buffer is set to a pointer to a valid
+ *        \ref secure_buffer instance holding the contents of this builder,
+ *        which is a \ref resource owned by the caller that must be released
+ *        when no longer needed.
+ *      - On failure, \p buffer and this builder are unchanged.
+ */
+status FN_DECL_MUST_CHECK
+secure_buffer_builder_finalize(
+    secure_buffer** buffer, secure_buffer_builder* builder);
+
 /******************************************************************************/
 /* Start of model checking properties.                                        */
 /******************************************************************************/
@@ -0,0 +1,627 @@
+/**
+ * \file nepe2/store.h
+ *
+ * \brief A store is an in-memory collection of \ref metadata records that is
+ * loaded from a serialized store image and indexed by hash id.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <nepe2/metadata.h>
+#include <nepe2/secure_buffer.h>
+#include <rcpr/allocator.h>
+#include <rcpr/resource.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief The magic number at the start of every store image ("NP2S").
+ */
+#define STORE_MAGIC                                                 0x4e503253
+
+/**
+ * \brief The store format version supported by this library.
+ */
+#define STORE_FORMAT_VERSION_1                                      0x00000001
+
+/**
+ * \brief The size of the store header.
+ *
+ * The store header consists of the following big-endian fields:
+ *      - magic (uint32_t), which must be \ref STORE_MAGIC.
+ *      - format version (uint32_t).
+ *      - flags (uint32_t), which are zero or more STORE_FLAG_ values.
+ *      - generation (uint32_t), which starts at zero and is changed whenever
+ *        records are removed or rewritten, but not when records are appended.
+ *
+ * The header is followed by zero or more records. Each record is a big-endian
+ * uint32_t record size followed by a serialized \ref metadata record of that
+ * size. If \ref STORE_FLAG_CRC32C is set, each record is then followed by its
+ * checksum. If \ref STORE_FLAG_PERFECT_HASH is set, the records are followed
+ * by a perfect hash index and its footer.
+ */
+#define STORE_HEADER_SIZE                                                   16
+
+/**
+ * \brief The size of the length prefix for each record in a store image.
+ */
+#define STORE_RECORD_PREFIX_SIZE                                             4
+
+/**
+ * \brief Store header flag: each record is followed by the big-endian uint32_t
+ * CRC32C of the serialized record, as computed by \ref store_crc32c.
+ */
+#define STORE_FLAG_CRC32C                                           0x00000001
+
+/**
+ * \brief Store header flag: the records are followed by a serialized
+ * \ref perfect_hash over the index hash of every hash id, which maps each hash
+ * id to the position of its record, and then by the index footer.
+ *
+ * Each hash id appears only once, in the slot order of the perfect hash. The
+ * index footer consists of the following big-endian fields:
+ *      - magic (uint32_t), which must be \ref STORE_INDEX_MAGIC.
+ *      - the CRC32C of the serialized perfect hash (uint32_t).
+ *      - the offset of the end of the records (uint64_t).
+ *      - the size of the serialized perfect hash (uint64_t).
+ */
+#define STORE_FLAG_PERFECT_HASH                                     0x00000002
+
+/**
+ * \brief Every store header flag supported by this library.
+ */
+#define STORE_FLAGS_SUPPORTED \
+    (STORE_FLAG_CRC32C | STORE_FLAG_PERFECT_HASH)
+
+/**
+ * \brief The magic number at the start of the index footer ("NP2I").
+ */
+#define STORE_INDEX_MAGIC                                           0x4e503249
+
+/**
+ * \brief The size of the index footer of a store image with
+ * \ref STORE_FLAG_PERFECT_HASH set.
+ */
+#define STORE_INDEX_FOOTER_SIZE                                             24
+
+/**
+ * \brief The magic number at the start of an index snapshot ("NP2X").
+ */
+#define STORE_SNAPSHOT_MAGIC                                        0x4e503258
+
+/**
+ * \brief The index snapshot format version supported by this library.
+ */
+#define STORE_SNAPSHOT_VERSION_1                                    0x00000001
+
+/**
+ * \brief The size of the header of an index snapshot.
+ *
+ * An index snapshot holds the hash id index of a \ref store, as written by
+ * \ref store_snapshot_create. The header consists of the following big-endian
+ * fields:
+ *      - magic (uint32_t), which must be \ref STORE_SNAPSHOT_MAGIC.
+ *      - format version (uint32_t).
+ *      - the generation of the store image (uint32_t).
+ *      - the CRC32C of the big-endian index hash of each covered record, in
+ *        store order (uint32_t).
+ *      - the number of covered records (uint64_t).
+ *      - the capacity of the index, which is a power of two (uint64_t).
+ *      - the CRC32C of the rest of the snapshot (uint32_t).
+ *      - reserved (uint32_t), which must be zero.
+ *
+ * The header is followed by each index entry, as its hash (uint64_t) and the
+ * position of its newest record (uint64_t), which is UINT64_MAX for an empty
+ * entry. These are followed by the position of the next older generation of
+ * each covered record (uint64_t), which is UINT64_MAX at the end of a chain.
+ */
+#define STORE_SNAPSHOT_HEADER_SIZE                                          40
+
+/**
+ * \brief The size of the checksum trailer for each record in a store image
+ * with \ref STORE_FLAG_CRC32C set.
+ */
+#define STORE_RECORD_TRAILER_SIZE                                            4
+
+/**
+ * \brief Store load flag: back the record table and hash id index with
+ * transparent huge pages, by asking the kernel to use huge pages for an
+ * aligned anonymous mapping.
+ */
+#define STORE_LOAD_FLAG_HUGE_PAGES                                  0x00000001
+
+/**
+ * \brief Store load flag: back the record table and hash id index with
+ * explicit huge pages from the hugetlbfs pool, falling back to transparent
+ * huge pages if the pool has too few free pages.
+ */
+#define STORE_LOAD_FLAG_HUGETLB                                     0x00000002
+
+/**
+ * \brief The size of the huge pages used by the store load flags.
+ */
+#define STORE_HUGE_PAGE_SIZE                                        0x00200000
+
+/**
+ * \brief Store page mode: the record table and index use the store allocator.
+ */
+#define STORE_PAGE_MODE_DEFAULT                                              0
+
+/**
+ * \brief Store page mode: the record table and index are in a mapping that is
+ * advised to use transparent huge pages.
+ */
+#define STORE_PAGE_MODE_TRANSPARENT                                          1
+
+/**
+ * \brief Store page mode: the record table and index are in a hugetlbfs
+ * mapping.
+ */
+#define STORE_PAGE_MODE_HUGETLB                                              2
+
+/**
+ * \brief A store is an immutable, indexed collection of \ref metadata records.
+ */
+typedef struct store store;
+
+/******************************************************************************/
+/* Start of constructors.                                                     */
+/******************************************************************************/
+
+/**
+ * \brief Load a store from the given store image.
+ *
+ * \param st            Pointer to the store pointer to receive the store on
+ *                      success.
+ * \param alloc         The allocator instance to use for this operation.
+ * \param image         The store image to load.
+ * \param thread_count  The number of threads to use to deserialize records,
+ *                      or 0 to use one thread per online processor.
+ *
+ * \note The offset table of the store image is built with a single pass over
+ * the record length prefixes. The offset table is then split into one chunk
+ * per thread, and each thread deserializes its chunk using its own allocator
+ * instance, so that loader threads do not share allocator state. If the image
+ * has \ref STORE_FLAG_CRC32C set, each thread verifies the checksum of each
+ * record just before it deserializes the record. Once all
+ * chunks are loaded, they are merged into a single hash id index. If a hash id
+ * appears more than once, the record with the newest generation is indexed,
+ * and the older generations are chained behind it for
+ * \ref store_lookup_history. If the image has \ref STORE_FLAG_PERFECT_HASH
+ * set, the records are still deserialized, but the perfect hash index stored
+ * in the image replaces the hash id index, after every record is checked
+ * against its slot.
+ *
+ * This store is a \ref resource that must be released by calling
+ * \ref resource_release on its resource handle when it is no longer needed by
+ * the caller. The resource handle can be accessed by calling
+ * \ref store_resource_handle on this store instance.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_STORE_INVALID_HEADER if the store header is invalid.
+ *      - ERROR_STORE_UNKNOWN_FORMAT_VERSION if the store format version is not
+ *        supported.
+ *      - ERROR_STORE_INVALID_RECORD_SIZE if a record size is invalid.
+ *      - ERROR_STORE_CHECKSUM_MISMATCH if a record does not match its
+ *        checksum.
+ *      - ERROR_STORE_INVALID_INDEX if the perfect hash index is invalid or
+ *        does not match the records.
+ *      - ERROR_STORE_THREAD_CREATE_FAILED if a loader thread could not be
+ *        created.
+ *      - an error from \ref metadata_header_batch_check or
+ *        \ref metadata_from_data if a record could not be deserialized.
+ *
+ * \pre
+ *      - \p st must not reference a valid \ref store instance and must not be
+ *        NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ *      - \p image must reference a valid \ref secure_buffer instance.
+ * \post
+ *      - On success, \p st is set to a pointer to a valid \ref store instance,
+ *        which is a \ref resource owned by the caller that must be released
+ *        when no longer needed.
+ *      - On failure, \p st is not changed and an error status is returned.
+ */
+status FN_DECL_MUST_CHECK
+store_create_from_buffer(
+    store** st, RCPR_SYM(allocator)* alloc, const secure_buffer* image,
+    size_t thread_count);
+
+/**
+ * \brief Load a store from the given store image, with the given load flags.
+ *
+ * \param st            Pointer to the store pointer to receive the store on
+ *                      success.
+ * \param alloc         The allocator instance to use for this operation.
+ * \param image         The store image to load.
+ * \param thread_count  The number of threads to use to deserialize records,
+ *                      or 0 to use one thread per online processor.
+ * \param flags         Zero or more STORE_LOAD_FLAG_ values.
+ *
+ * \note This loads the store exactly as \ref store_create_from_buffer does. If
+ * a huge page flag is set, the record table, the hash id index, and the
+ * generation chain links are placed together in one mapping of whole huge
+ * pages, so that lookups across a large store touch few TLB entries. If huge
+ * pages are not available, the mapping falls back to transparent huge pages
+ * and then to ordinary pages, and if no mapping can be made, the store
+ * allocator is used. \ref store_page_mode_get reports which was used. The
+ * records themselves are still allocated by the loader threads.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error from \ref store_create_from_buffer on failure.
+ *
+ * \pre
+ *      - \p st must not reference a valid \ref store instance and must not be
+ *        NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ *      - \p image must reference a valid \ref secure_buffer instance.
+ * \post
+ *      - On success, \p st is set to a pointer to a valid \ref store instance,
+ *        which is a \ref resource owned by the caller that must be released
+ *        when no longer needed.
+ *      - On failure, \p st is not changed and an error status is returned.
+ */
+status FN_DECL_MUST_CHECK
+store_create_from_buffer_with_flags(
+    store** st, RCPR_SYM(allocator)* alloc, const secure_buffer* image,
+    size_t thread_count, uint32_t flags);
+
+/**
+ * \brief Load a store from the given store image, with the given load flags,
+ * starting from an index snapshot.
+ *
+ * \param st            Pointer to the store pointer to receive the store on
+ *                      success.
+ * \param alloc         The allocator instance to use for this operation.
+ * \param image         The store image to load.
+ * \param snapshot      An index snapshot written by \ref store_snapshot_create
+ *                      for an earlier load of this image, or NULL.
+ * \param thread_count  The number of threads to use to deserialize records,
+ *                      or 0 to use one thread per online processor.
+ * \param flags         Zero or more STORE_LOAD_FLAG_ values.
+ *
+ * \note This loads the store exactly as
+ * \ref store_create_from_buffer_with_flags does, except for the hash id index.
+ * If the snapshot has the generation of this image, covers no more records
+ * than it has, and matches the index hashes of the records it covers, then
+ * its index is copied in and only the records appended since it was written
+ * are inserted. Otherwise, the snapshot is ignored and
+ * the index is built from every record. \ref store_snapshot_record_count_get
+ * reports how many records came from the snapshot. A snapshot is also ignored
+ * if the image has \ref STORE_FLAG_PERFECT_HASH set.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error from \ref store_create_from_buffer on failure.
+ *
+ * \pre
+ *      - \p st must not reference a valid \ref store instance and must not be
+ *        NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ *      - \p image must reference a valid \ref secure_buffer instance.
+ *      - \p snapshot must be NULL or reference a valid \ref secure_buffer
+ *        instance.
+ * \post
+ *      - On success, \p st is set to a pointer to a valid \ref store instance,
+ *        which is a \ref resource owned by the caller that must be released
+ *        when no longer needed.
+ *      - On failure, \p st is not changed and an error status is returned.
+ */
+status FN_DECL_MUST_CHECK
+store_create_from_buffer_with_snapshot(
+    store** st, RCPR_SYM(allocator)* alloc, const secure_buffer* image,
+    const secure_buffer* snapshot, size_t thread_count, uint32_t flags);
+
+/**
+ * \brief Write an index snapshot of a \ref store.
+ *
+ * \param snapshot      Pointer to receive the snapshot on success.
+ * \param alloc         The allocator to use for the snapshot.
+ * \param st            The \ref store instance for this operation.
+ *
+ * \note The snapshot covers every record of the store. Once more records are
+ * appended to the store image, loading the image with this snapshot only
+ * indexes the new records. The index hash of every record is computed again
+ * here, so that the snapshot can be checked against the records it covers.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_STORE_SNAPSHOT_NOT_SUPPORTED if the store uses a perfect hash
+ *        index.
+ *      - ERROR_METADATA_FIELD_NOT_SET if a record is missing its hash id.
+ *
+ * \pre
+ *      - \p snapshot must not reference a valid \ref secure_buffer instance
+ *        and must not be NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ *      - \p st must reference a valid \ref store instance.
+ * \post
+ *      - On success, \p snapshot is set to a \ref secure_buffer owned by the
+ *        caller.
+ *      - On failure, \p snapshot is not changed.
+ */
+status FN_DECL_MUST_CHECK
+store_snapshot_create(
+    secure_buffer** snapshot, RCPR_SYM(allocator)* alloc, const store* st);
+
+/******************************************************************************/
+/* Start of accessors.                                                        */
+/******************************************************************************/
+
+/**
+ * \brief Given a \ref store instance, return the resource handle for this
+ * \ref store instance.
+ *
+ * \param st            The \ref store instance from which the resource handle
+ *                      is returned.
+ *
+ * \returns the resource handle for this \ref store instance.
+ */
+RCPR_SYM(resource)*
+store_resource_handle(
+    store* st);
+
+/**
+ * \brief Get the page mode of the record table and index of a \ref store.
+ *
+ * \param st            The \ref store instance for this operation.
+ *
+ * \returns one of the STORE_PAGE_MODE_ values.
+ */
+int
+store_page_mode_get(
+    const store* st);
+
+/**
+ * \brief Get the number of records in a \ref store instance.
+ *
+ * \param st            The \ref store instance for this operation.
+ *
+ * \note This count includes every record in the store image, including older
+ * generations that are only reachable by \ref store_lookup_history.
+ *
+ * \returns the number of records in this store.
+ */
+size_t
+store_record_count_get(
+    const store* st);
+
+/**
+ * \brief Get the number of records of a \ref store instance that were indexed
+ * from an index snapshot.
+ *
+ * \param st            The \ref store instance for this operation.
+ *
+ * \returns the number of records covered by the snapshot that this store was
+ * loaded with, or zero if no snapshot was used.
+ */
+size_t
+store_snapshot_record_count_get(
+    const store* st);
+
+/**
+ * \brief Get a record by its position in a \ref store instance.
+ *
+ * \param st            The \ref store instance for this operation.
+ * \param index         The index of the record, which must be less than the
+ *                      record count of this store.
+ *
+ * \note Records are in store image order. This includes older generations that
+ * are only reachable by \ref store_lookup_history.
+ *
+ * \returns the record at this index. This record is owned by the store and
+ * must not be modified or released by the caller.
+ */
+const metadata*
+store_record_get(
+    const store* st, size_t index);
+
+/**
+ * \brief Look up a record by hash id.
+ *
+ * \param meta          Pointer to receive the record on success.
+ * \param st            The \ref store instance for this operation.
+ * \param hash_id       The hash id to look up.
+ * \param hash_id_size  The size of the hash id.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_RECORD_NOT_FOUND if no record matches this hash id.
+ *
+ * \pre
+ *      - \p meta must be a valid pointer.
+ *      - \p st must reference a valid \ref store instance.
+ *      - \p hash_id must point to a valid memory region that is at least
+ *        \p hash_id_size bytes in length.
+ * \post
+ *      - On success, \p meta is set to the newest generation of the record
+ *        matching this hash id. This record is owned by the store and must
+ *        not be modified or released by the caller.
+ *      - On failure, \p meta is unchanged.
+ */
+status FN_DECL_MUST_CHECK
+store_lookup(
+    const metadata** meta, const store* st, const void* hash_id,
+    size_t hash_id_size);
+
+/**
+ * \brief Look up a record by hash id, using a precomputed index hash.
+ *
+ * \param meta          Pointer to receive the record on success.
+ * \param st            The \ref store instance for this operation.
+ * \param hash          The index hash of this hash id, as computed by
+ *                      \ref store_hash_id_hash.
+ * \param hash_id       The hash id to look up.
+ * \param hash_id_size  The size of the hash id.
+ *
+ * \note This allows a caller that probes several indexes for the same hash id
+ * to compute the index hash only once.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_RECORD_NOT_FOUND if no record matches this hash id.
+ *
+ * \pre
+ *      - \p meta must be a valid pointer.
+ *      - \p st must reference a valid \ref store instance.
+ *      - \p hash must be the index hash of \p hash_id.
+ *      - \p hash_id must point to a valid memory region that is at least
+ *        \p hash_id_size bytes in length.
+ * \post
+ *      - On success, \p meta is set to the newest generation of the record
+ *        matching this hash id. This record is owned by the store and must
+ *        not be modified or released by the caller.
+ *      - On failure, \p meta is unchanged.
+ */
+status FN_DECL_MUST_CHECK
+store_lookup_hashed(
+    const metadata** meta, const store* st, uint64_t hash,
+    const void* hash_id, size_t hash_id_size);
+
+/**
+ * \brief Look up a batch of records by hash id.
+ *
+ * \param records       Array of \p count entries to receive the newest
+ *                      generation of each hash id, or NULL for each hash id
+ *                      that is not found.
+ * \param st            The \ref store instance for this operation.
+ * \param hash_ids      Array of \p count hash ids.
+ * \param hash_id_sizes Array of \p count hash id sizes.
+ * \param count         The number of hash ids.
+ *
+ * \note The hash ids are looked up in groups, with the cache misses of each
+ * group overlapped by prefetching. This is much faster than calling
+ * \ref store_lookup for each hash id when the store does not fit in cache.
+ *
+ * \returns the number of hash ids that were found.
+ *
+ * \pre
+ *      - \p records, \p hash_ids, and \p hash_id_sizes must point to \p count
+ *        entries.
+ *      - \p st must reference a valid \ref store instance.
+ * \post
+ *      - Each entry of \p records is set to the record matching the same
+ *        entry of \p hash_ids, or NULL. These records are owned by the store
+ *        and must not be modified or released by the caller.
+ */
+size_t
+store_lookup_batch(
+    const metadata** records, const store* st, const void* const* hash_ids,
+    const size_t* hash_id_sizes, size_t count);
+
+/**
+ * \brief Look up the newest generation of a record by hash id, and start a walk
+ * of its older generations.
+ *
+ * \param meta          Pointer to receive the record on success.
+ * \param cursor        Pointer to the history cursor, which is set on success.
+ * \param st            The \ref store instance for this operation.
+ * \param hash_id       The hash id to look up.
+ * \param hash_id_size  The size of the hash id.
+ *
+ * \note Every generation of a hash id is chained newest first when the store is
+ * loaded, so the newest generation is found with a single index probe, and
+ * each older generation is one step of \ref store_history_next.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_RECORD_NOT_FOUND if no record matches this hash id.
+ *
+ * \pre
+ *      - \p meta and \p cursor must be valid pointers.
+ *      - \p st must reference a valid \ref store instance.
+ *      - \p hash_id must point to a valid memory region that is at least
+ *        \p hash_id_size bytes in length.
+ * \post
+ *      - On success, \p meta is set to the newest generation of the record
+ *        matching this hash id, and \p cursor is set to its position in the
+ *        generation chain. This record is owned by the store and must not be
+ *        modified or released by the caller.
+ *      - On failure, \p meta and \p cursor are unchanged.
+ */
+status FN_DECL_MUST_CHECK
+store_lookup_history(
+    const metadata** meta, size_t* cursor, const store* st,
+    const void* hash_id, size_t hash_id_size);
+
+/**
+ * \brief Step to the next older generation of a record.
+ *
+ * \param meta          Pointer to receive the record on success.
+ * \param cursor        Pointer to the history cursor, which is advanced on
+ *                      success.
+ * \param st            The \ref store instance for this operation.
+ *
+ * \note Generations are returned newest first. Records with the same
+ * generation are returned in reverse store image order.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_RECORD_NOT_FOUND if there are no older generations.
+ *
+ * \pre
+ *      - \p meta must be a valid pointer.
+ *      - \p cursor must have been set by \ref store_lookup_history or by a
+ *        successful call to this method on the same store.
+ *      - \p st must reference a valid \ref store instance.
+ * \post
+ *      - On success, \p meta is set to the next older generation, and
+ *        \p cursor is set to its position in the generation chain.
+ *      - On failure, \p meta and \p cursor are unchanged.
+ */
+status FN_DECL_MUST_CHECK
+store_history_next(
+    const metadata** meta, size_t* cursor, const store* st);
+
+/******************************************************************************/
+/* Start of utility methods.                                                  */
+/******************************************************************************/
+
+/**
+ * \brief Compute the index hash for a hash id.
+ *
+ * \param hash_id       The hash id to hash.
+ * \param hash_id_size  The size of the hash id.
+ *
+ * \returns the 64-bit index hash for this hash id.
+ */
+uint64_t
+store_hash_id_hash(
+    const void* hash_id, size_t hash_id_size);
+
+/**
+ * \brief Compute or continue the CRC32C (Castagnoli) checksum of a region.
+ *
+ * \param crc           The checksum of the data before this region, or 0 to
+ *                      start a new checksum.
+ * \param data          The region to checksum.
+ * \param size          The size of the region.
+ *
+ * \note Where the CPU supports SSE4.2, the checksum is computed with the crc32
+ * instruction, over three interleaved streams for large regions. Otherwise, a
+ * table is used.
+ *
+ * \returns the checksum of the data so far.
+ */
+uint32_t
+store_crc32c(
+    uint32_t crc, const void* data, size_t size);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
@@ -0,0 +1,507 @@
+/**
+ * \file nepe2/store_file.h
+ *
+ * \brief A store file is a store image on disk, which can be read in batches
+ * and appended to.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <nepe2/metadata.h>
+#include <nepe2/secure_buffer.h>
+#include <nepe2/store.h>
+#include <rcpr/allocator.h>
+#include <rcpr/resource.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief Create the store file, with an empty store image, if it does not
+ * exist.
+ */
+#define STORE_FILE_FLAG_CREATE                                      0x00000001
+
+/**
+ * \brief Use the io_uring backend if the kernel supports it.
+ */
+#define STORE_FILE_FLAG_IO_URING                                    0x00000002
+
+/**
+ * \brief Create a new store image with \ref STORE_FLAG_CRC32C set, so that
+ * every record is followed by its checksum.
+ */
+#define STORE_FILE_FLAG_CRC32C                                      0x00000004
+
+/**
+ * \brief Compaction flag: write the records in the slot order of a perfect
+ * hash over their hash ids, and append the perfect hash as the index of the
+ * compacted image, setting \ref STORE_FLAG_PERFECT_HASH.
+ */
+#define STORE_FILE_COMPACT_FLAG_PERFECT_HASH                        0x00000001
+
+/**
+ * \brief The backend that issues one pread or pwritev call per request.
+ */
+#define STORE_FILE_BACKEND_PREAD                                             0
+
+/**
+ * \brief The backend that submits each batch to an io_uring instance.
+ */
+#define STORE_FILE_BACKEND_IO_URING                                          1
+
+/**
+ * \brief The suffix of the index snapshot sidecar of a store image.
+ */
+#define STORE_FILE_SNAPSHOT_SUFFIX                                 ".snapshot"
+
+/**
+ * \brief A store file is an open store image.
+ *
+ * A store file must only be used by one thread at a time. Appends are written
+ * at the end of the image as tracked by the store file, so a store file must
+ * be the only writer of its image.
+ */
+typedef struct store_file store_file;
+
+/**
+ * \brief One read in a batch.
+ */
+typedef struct store_file_read_request store_file_read_request;
+
+struct store_file_read_request
+{
+    uint64_t offset;
+    size_t size;
+    void* data;
+};
+
+/**
+ * \brief Options for \ref store_file_compact.
+ */
+typedef struct store_file_compact_options store_file_compact_options;
+
+struct store_file_compact_options
+{
+    /** \brief The current time, in the units of the revocation date. */
+    uint64_t now;
+    /** \brief How long a revoked record is kept after its revocation date. */
+    uint64_t retention;
+    /** \brief The number of threads, or 0 for one per online processor. */
+    size_t thread_count;
+    /** \brief The memory budget for the live set index, or 0 for the
+     * default. */
+    size_t memory_limit;
+    /** \brief Zero or more STORE_FILE_COMPACT_FLAG_ values. */
+    uint32_t flags;
+};
+
+/**
+ * \brief Counters reported by \ref store_file_compact.
+ */
+typedef struct store_file_compact_stats store_file_compact_stats;
+
+struct store_file_compact_stats
+{
+    /** \brief The number of records in the original image. */
+    uint64_t records_in;
+    /** \brief The number of records in the compacted image. */
+    uint64_t records_out;
+    /** \brief The number of records dropped for a newer generation. */
+    uint64_t superseded;
+    /** \brief The number of records dropped after their retention window. */
+    uint64_t revoked;
+    /** \brief The size of the original image. */
+    uint64_t bytes_in;
+    /** \brief The size of the compacted image. */
+    uint64_t bytes_out;
+    /** \brief The size of the perfect hash index of the compacted image,
+     * with its footer, or 0 if it has none. */
+    uint64_t index_size;
+};
+
+/******************************************************************************/
+/* Start of constructors.                                                     */
+/******************************************************************************/
+
+/**
+ * \brief Open a store file.
+ *
+ * \param sf            Pointer to the store file pointer to receive the store
+ *                      file on success.
+ * \param alloc         The allocator instance to use for this operation.
+ * \param path          The path of the store image.
+ * \param flags         Zero or more STORE_FILE_FLAG_ values.
+ *
+ * \note If \ref STORE_FILE_FLAG_IO_URING is set but io_uring is unavailable,
+ * for instance because the kernel is too old or io_uring is disabled, the store
+ * file silently uses the pread backend. The backend in use is returned by
+ * \ref store_file_backend_get.
+ *
+ * A new store image has \ref STORE_FLAG_CRC32C set if
+ * \ref STORE_FILE_FLAG_CRC32C is set. An existing image keeps the flags in its
+ * header, which are returned by \ref store_file_header_flags_get, and every
+ * append follows them. If the image has \ref STORE_FLAG_PERFECT_HASH set, the
+ * size of the store file is the end of its records, and the first append or
+ * truncate removes the index and clears the flag.
+ *
+ * This store file is a \ref resource that must be released by calling
+ * \ref resource_release on its resource handle when it is no longer needed by
+ * the caller. The resource handle can be accessed by calling
+ * \ref store_file_resource_handle on this store file instance.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_STORE_FILE_OPEN_FAILED if the file could not be opened or
+ *        created.
+ *      - ERROR_STORE_FILE_READ_FAILED if the store header could not be read.
+ *      - ERROR_STORE_FILE_WRITE_FAILED if the store header of a new file could
+ *        not be written.
+ *      - ERROR_STORE_INVALID_HEADER if the store header is invalid.
+ *      - ERROR_STORE_UNKNOWN_FORMAT_VERSION if the store format version is not
+ *        supported.
+ *      - ERROR_STORE_INVALID_INDEX if the index footer is invalid.
+ *
+ * \pre
+ *      - \p sf must not reference a valid \ref store_file instance and must not
+ *        be NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ *      - \p path must be a valid ASCII zero terminated string.
+ * \post
+ *      - On success, \p sf is set to a pointer to a valid \ref store_file
+ *        instance, which is a \ref resource owned by the caller that must be
+ *        released when no longer needed.
+ *      - On failure, \p sf is not changed and an error status is returned.
+ */
+status FN_DECL_MUST_CHECK
+store_file_open(
+    store_file** sf, RCPR_SYM(allocator)* alloc, const char* path,
+    uint32_t flags);
+
+/******************************************************************************/
+/* Start of accessors.                                                        */
+/******************************************************************************/
+
+/**
+ * \brief Given a \ref store_file instance, return the resource handle for this
+ * \ref store_file instance.
+ *
+ * \param sf            The \ref store_file instance from which the resource
+ *                      handle is returned.
+ *
+ * \returns the resource handle for this \ref store_file instance.
+ */
+RCPR_SYM(resource)*
+store_file_resource_handle(
+    store_file* sf);
+
+/**
+ * \brief Get the backend used by a \ref store_file.
+ *
+ * \param sf            The \ref store_file instance for this operation.
+ *
+ * \note A file whose ring fails switches to the pread backend for good.
+ *
+ * \returns \ref STORE_FILE_BACKEND_PREAD or \ref STORE_FILE_BACKEND_IO_URING.
+ */
+int
+store_file_backend_get(
+    const store_file* sf);
+
+/**
+ * \brief Get the store header flags of a \ref store_file.
+ *
+ * \param sf            The \ref store_file instance for this operation.
+ *
+ * \returns zero or more STORE_FLAG_ values.
+ */
+uint32_t
+store_file_header_flags_get(
+    const store_file* sf);
+
+/**
+ * \brief Get the generation of the store image of a \ref store_file.
+ *
+ * \param sf            The \ref store_file instance for this operation.
+ *
+ * \note The generation is kept in the store header. Appends leave it alone;
+ * \ref store_file_truncate and \ref store_file_compact change it.
+ *
+ * \returns the generation of the store image.
+ */
+uint32_t
+store_file_generation_get(
+    const store_file* sf);
+
+/**
+ * \brief Get the size of the store image of a \ref store_file, including every
+ * append.
+ *
+ * \param sf            The \ref store_file instance for this operation.
+ *
+ * \returns the size of the store image.
+ */
+uint64_t
+store_file_size_get(
+    const store_file* sf);
+
+/******************************************************************************/
+/* Start of store file methods.                                               */
+/******************************************************************************/
+
+/**
+ * \brief Read the whole store image of a \ref store_file.
+ *
+ * \param image         Pointer to receive the store image on success.
+ * \param alloc         The allocator to use for the store image.
+ * \param sf            The \ref store_file for this operation.
+ *
+ * \note The image, including any perfect hash index, can be loaded with
+ * \ref store_create_from_buffer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_STORE_FILE_READ_FAILED if the read failed.
+ *
+ * \post
+ *      - On success, \p image is set to a \ref secure_buffer holding the store
+ *        image, which is owned by the caller.
+ *      - On failure, \p image is not changed.
+ */
+status FN_DECL_MUST_CHECK
+store_file_image_read(
+    secure_buffer** image, RCPR_SYM(allocator)* alloc, store_file* sf);
+
+/**
+ * \brief Perform a batch of reads from a \ref store_file.
+ *
+ * \param sf            The \ref store_file for this operation.
+ * \param requests      The reads to perform.
+ * \param count         The number of reads.
+ *
+ * \note With the io_uring backend, the whole batch is submitted and reaped with
+ * as few system calls as the ring size allows. With the pread backend, each
+ * read is a separate pread call.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_FILE_READ_FAILED if any read failed or reached the end of
+ *        the file.
+ *
+ * \pre
+ *      - Each request must have a \p data pointer to at least \p size writable
+ *        bytes.
+ * \post
+ *      - On success, every request has been read.
+ *      - On failure, the contents of the request buffers are unspecified.
+ */
+status FN_DECL_MUST_CHECK
+store_file_read_batch(
+    store_file* sf, const store_file_read_request* requests, size_t count);
+
+/**
+ * \brief Append records to a \ref store_file.
+ *
+ * \param sf            The \ref store_file for this operation.
+ * \param records       The records to append.
+ * \param count         The number of records.
+ * \param sync          If true, the records are durable before this returns.
+ *
+ * \note The records are framed as store image records and written from their
+ * own storage with a single vectored write. With the io_uring backend, the
+ * write and its data sync are linked and submitted together. If the image
+ * has a perfect hash index, the index is removed first.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_METADATA_FIELD_NOT_SET if any record is empty.
+ *      - ERROR_STORE_FILE_WRITE_FAILED if the write failed.
+ *      - ERROR_STORE_FILE_SYNC_FAILED if the data sync failed.
+ *
+ * \post
+ *      - On success, the size of this store file includes the records.
+ *      - On failure, the size of this store file is unchanged, and any bytes
+ *        written past it are overwritten by the next append.
+ */
+status FN_DECL_MUST_CHECK
+store_file_append(
+    store_file* sf, const metadata* const* records, size_t count, bool sync);
+
+/**
+ * \brief Make every append to a \ref store_file durable.
+ *
+ * \param sf            The \ref store_file for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_FILE_SYNC_FAILED if the data sync failed.
+ */
+status FN_DECL_MUST_CHECK
+store_file_sync(
+    store_file* sf);
+
+/**
+ * \brief Truncate the store image of a \ref store_file, and make the new size
+ * durable.
+ *
+ * \param sf            The \ref store_file for this operation.
+ * \param size          The new size of the store image.
+ *
+ * \note If the store image has a perfect hash index, the index is removed
+ * first. The generation of the store image is then advanced and made durable
+ * before the file is truncated, so that no index snapshot of the records that
+ * are removed is used again.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_FILE_WRITE_FAILED if the file could not be truncated, or
+ *        if the generation could not be written.
+ *      - ERROR_STORE_FILE_SYNC_FAILED if the data sync failed.
+ *
+ * \pre
+ *      - \p size must be at least \ref STORE_HEADER_SIZE, and must not be
+ *        greater than the size of this store file.
+ * \post
+ *      - On success, the size of this store file is \p size.
+ */
+status FN_DECL_MUST_CHECK
+store_file_truncate(
+    store_file* sf, uint64_t size);
+
+/**
+ * \brief Rewrite a store image so that it only holds its live set.
+ *
+ * \param stats         Pointer to receive the compaction counters on success.
+ * \param alloc         The allocator instance to use for this operation, which
+ *                      must be thread-safe.
+ * \param path          The path of the store image.
+ * \param options       The options for this compaction.
+ *
+ * \note The live set is the newest generation of each hash id, as a loaded
+ * \ref store would see it, minus every record whose revocation date is at
+ * least the retention window before the current time.
+ *
+ * The image is compacted in passes, each of which covers one slice of the
+ * hash id space per thread, so that the index of live records never needs
+ * more than about \p options->memory_limit bytes. Each thread streams the
+ * image through its own fixed size buffer. The live records are written to a
+ * new image next to the original, which is synced and then renamed over the
+ * original. Until then, the original is untouched, so readers of it are
+ * unaffected; a \ref store_file or file descriptor opened before the rename
+ * keeps reading the original image. The new image keeps the checksum flag of
+ * the original, and checksummed records are verified as they are scanned. Its
+ * generation is one past that of the original, so an index snapshot of the
+ * original is not used with it.
+ *
+ * If \ref STORE_FILE_COMPACT_FLAG_PERFECT_HASH is set in \p options->flags,
+ * the records are written in the slot order of a perfect hash over their hash
+ * ids, which is appended to the new image as its index, so that a loaded
+ * \ref store answers lookups from the perfect hash instead of building a hash
+ * id index. If two live hash ids share an index hash, the perfect hash cannot
+ * be built, and the new image has no index; \p stats->index_size is then 0.
+ *
+ * The image must not be appended to while it is compacted, and a
+ * \ref store_file used to append to it must be reopened afterwards.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_STORE_FILE_OPEN_FAILED if the image or the new image could not
+ *        be opened.
+ *      - ERROR_STORE_FILE_READ_FAILED if the image could not be read.
+ *      - ERROR_STORE_FILE_WRITE_FAILED if the new image could not be written.
+ *      - ERROR_STORE_FILE_SYNC_FAILED if the new image could not be synced.
+ *      - ERROR_STORE_FILE_SWAP_FAILED if the new image could not be renamed
+ *        over the original.
+ *      - ERROR_STORE_INVALID_HEADER if the store header is invalid.
+ *      - ERROR_STORE_UNKNOWN_FORMAT_VERSION if the store format version is not
+ *        supported.
+ *      - ERROR_STORE_INVALID_RECORD_SIZE if a record is truncated.
+ *      - ERROR_STORE_CHECKSUM_MISMATCH if a record does not match its
+ *        checksum.
+ *      - ERROR_STORE_THREAD_CREATE_FAILED if a thread could not be started.
+ *      - an error from \ref metadata_from_data if a record is invalid.
+ *
+ * \post
+ *      - On success, the image at \p path is the compacted image.
+ *      - On failure, the image at \p path is unchanged.
+ */
+status FN_DECL_MUST_CHECK
+store_file_compact(
+    store_file_compact_stats* stats, RCPR_SYM(allocator)* alloc,
+    const char* path, const store_file_compact_options* options);
+
+/**
+ * \brief Write the index snapshot sidecar of a store image.
+ *
+ * \param alloc         The allocator instance to use for this operation.
+ * \param path          The path of the store image.
+ * \param snapshot      The index snapshot, as written by
+ *                      \ref store_snapshot_create.
+ *
+ * \note The sidecar is the store image path followed by
+ * \ref STORE_FILE_SNAPSHOT_SUFFIX. The snapshot is written to a temporary
+ * file, which is synced and then renamed over the sidecar, so a crash leaves
+ * either the old sidecar or the new one.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_STORE_FILE_OPEN_FAILED if the temporary file could not be
+ *        created.
+ *      - ERROR_STORE_FILE_WRITE_FAILED if the snapshot could not be written.
+ *      - ERROR_STORE_FILE_SYNC_FAILED if the snapshot could not be synced.
+ *      - ERROR_STORE_FILE_SWAP_FAILED if the temporary file could not be
+ *        renamed over the sidecar.
+ */
+status FN_DECL_MUST_CHECK
+store_file_snapshot_write(
+    RCPR_SYM(allocator)* alloc, const char* path,
+    const secure_buffer* snapshot);
+
+/**
+ * \brief Read the index snapshot sidecar of a store image.
+ *
+ * \param snapshot      Pointer to receive the index snapshot on success.
+ * \param alloc         The allocator instance to use for this operation.
+ * \param path          The path of the store image.
+ *
+ * \note The snapshot is not checked here; a stale or damaged snapshot is
+ * ignored by \ref store_create_from_buffer_with_snapshot.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_STORE_FILE_OPEN_FAILED if there is no sidecar, or it could not
+ *        be opened.
+ *      - ERROR_STORE_FILE_READ_FAILED if the sidecar could not be read.
+ *
+ * \post
+ *      - On success, \p snapshot is set to a \ref secure_buffer owned by the
+ *        caller.
+ *      - On failure, \p snapshot is not changed.
+ */
+status FN_DECL_MUST_CHECK
+store_file_snapshot_read(
+    secure_buffer** snapshot, RCPR_SYM(allocator)* alloc, const char* path);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
@@ -0,0 +1,258 @@
+/**
+ * \file nepe2/upgrade_pipeline.h
+ *
+ * \brief An upgrade pipeline moves every record still answered by a fallback
+ * layer of a \ref migration_view onto the newest mode, in the background.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <nepe2/metadata.h>
+#include <nepe2/migration_view.h>
+#include <nepe2/secure_buffer.h>
+#include <rcpr/allocator.h>
+#include <rcpr/resource.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief An upgrade pipeline runs four concurrent stages, connected by bounded
+ * queues:
+ *      - lookup, which scans the fallback layers and keeps each record that is
+ *        still the answer for its hash id.
+ *      - derive old, which derives the password for the old record.
+ *      - derive new, which builds the newest mode record for that password.
+ *      - emit, which serializes the new record and appends it to the output.
+ *
+ * Each stage runs on its own thread, so the derivations for different records
+ * overlap with each other and with serialization.
+ */
+typedef struct upgrade_pipeline upgrade_pipeline;
+
+/**
+ * \brief An upgrade checkpoint is the position of the next source record to
+ * consider.
+ *
+ * Source records are visited in layer order, and in store image order within a
+ * layer. A pipeline started from a checkpoint skips every record before it.
+ */
+typedef struct upgrade_checkpoint upgrade_checkpoint;
+
+struct upgrade_checkpoint
+{
+    size_t layer;
+    size_t index;
+};
+
+/**
+ * \brief Progress counters for an upgrade pipeline.
+ */
+typedef struct upgrade_progress upgrade_progress;
+
+struct upgrade_progress
+{
+    /** \brief The number of source records scanned by the lookup stage. */
+    uint64_t scanned;
+    /** \brief The number of scanned records that did not need an upgrade. */
+    uint64_t skipped;
+    /** \brief The number of records emitted in the newest mode. */
+    uint64_t upgraded;
+    /** \brief Every source record before this checkpoint is complete. */
+    upgrade_checkpoint checkpoint;
+    /** \brief True once every stage has stopped. */
+    bool done;
+};
+
+/**
+ * \brief Derive the password for a record in its old mode.
+ *
+ * \param context       The user context for this pipeline.
+ * \param password      Pointer to receive the password on success.
+ * \param alloc         The allocator to use for the password.
+ * \param old_record    The record to derive.
+ *
+ * \returns a status code indicating success or failure.
+ */
+typedef status (*upgrade_derive_old_fn)(
+    void* context, secure_buffer** password, RCPR_SYM(allocator)* alloc,
+    const metadata* old_record);
+
+/**
+ * \brief Build the newest mode record that derives the given password.
+ *
+ * \param context       The user context for this pipeline.
+ * \param new_record    Pointer to receive the new record on success.
+ * \param alloc         The allocator to use for the new record.
+ * \param old_record    The record being upgraded.
+ * \param password      The password derived from the old record.
+ *
+ * \returns a status code indicating success or failure.
+ */
+typedef status (*upgrade_derive_new_fn)(
+    void* context, metadata** new_record, RCPR_SYM(allocator)* alloc,
+    const metadata* old_record, const secure_buffer* password);
+
+/**
+ * \brief Append a serialized record to the output.
+ *
+ * \param context       The user context for this pipeline.
+ * \param frame         The record, framed as in a store image: a big-endian
+ *                      uint32_t record size followed by the record, and then
+ *                      its checksum if the output image flags include
+ *                      \ref STORE_FLAG_CRC32C.
+ * \param frame_size    The size of the frame.
+ * \param next          The checkpoint to resume from once this frame is
+ *                      durable.
+ *
+ * \note Frames are emitted in source order. Appending every frame to a store
+ * header builds a store image for the newest layer. Persisting \p next with
+ * the frame makes the upgrade resumable.
+ *
+ * \returns a status code indicating success or failure.
+ */
+typedef status (*upgrade_emit_fn)(
+    void* context, const void* frame, size_t frame_size,
+    const upgrade_checkpoint* next);
+
+/**
+ * \brief Options for an upgrade pipeline.
+ */
+typedef struct upgrade_pipeline_options upgrade_pipeline_options;
+
+struct upgrade_pipeline_options
+{
+    /** \brief The source view, which must outlive the pipeline. */
+    const migration_view* view;
+    /** \brief Records answered by a layer below this layer are upgraded. */
+    size_t target_layer;
+    /** \brief The capacity of each queue between stages, or 0 for a default. */
+    size_t queue_depth;
+    /** \brief The checkpoint to start from. */
+    upgrade_checkpoint start;
+    upgrade_derive_old_fn derive_old;
+    upgrade_derive_new_fn derive_new;
+    upgrade_emit_fn emit;
+    /** \brief The user context passed to each callback. */
+    void* context;
+    /** \brief The STORE_FLAG_ values of the output image header. */
+    uint32_t store_flags;
+};
+
+/******************************************************************************/
+/* Start of constructors.                                                     */
+/******************************************************************************/
+
+/**
+ * \brief Create an upgrade pipeline and start its stages.
+ *
+ * \param pipeline      Pointer to the upgrade pipeline pointer to receive the
+ *                      upgrade pipeline on success.
+ * \param alloc         The allocator instance to use for this operation. This
+ *                      allocator is used concurrently by every stage.
+ * \param options       The options for this pipeline, which are copied.
+ *
+ * \note This upgrade pipeline is a \ref resource that must be released by
+ * calling \ref resource_release on its resource handle when it is no longer
+ * needed by the caller. The resource handle can be accessed by calling
+ * \ref upgrade_pipeline_resource_handle on this upgrade pipeline instance.
+ * Releasing a running pipeline cancels it.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_UPGRADE_PIPELINE_BAD_TARGET_LAYER if the target layer is not a
+ *        layer of the view.
+ *      - ERROR_UPGRADE_PIPELINE_SYNC_INIT_FAILED if a lock or condition
+ *        variable could not be created.
+ *      - ERROR_UPGRADE_PIPELINE_THREAD_CREATE_FAILED if a stage thread could
+ *        not be created.
+ *
+ * \pre
+ *      - \p pipeline must not reference a valid \ref upgrade_pipeline instance
+ *        and must not be NULL.
+ *      - \p alloc must reference a valid, thread-safe \ref allocator.
+ *      - \p options must reference valid options, with every callback set.
+ * \post
+ *      - On success, \p pipeline is set to a pointer to a valid, running
+ *        \ref upgrade_pipeline instance, which is a \ref resource owned by the
+ *        caller that must be released when no longer needed.
+ *      - On failure, \p pipeline is not changed and an error status is
+ *        returned.
+ */
+status FN_DECL_MUST_CHECK
+upgrade_pipeline_create(
+    upgrade_pipeline** pipeline, RCPR_SYM(allocator)* alloc,
+    const upgrade_pipeline_options* options);
+
+/******************************************************************************/
+/* Start of accessors.                                                        */
+/******************************************************************************/
+
+/**
+ * \brief Given an \ref upgrade_pipeline instance, return the resource handle
+ * for this \ref upgrade_pipeline instance.
+ *
+ * \param pipeline      The \ref upgrade_pipeline instance from which the
+ *                      resource handle is returned.
+ *
+ * \returns the resource handle for this \ref upgrade_pipeline instance.
+ */
+RCPR_SYM(resource)*
+upgrade_pipeline_resource_handle(
+    upgrade_pipeline* pipeline);
+
+/**
+ * \brief Get the progress of an \ref upgrade_pipeline.
+ *
+ * \param progress      Pointer to receive the progress.
+ * \param pipeline      The \ref upgrade_pipeline instance for this operation.
+ *
+ * \note This can be called from any thread while the pipeline runs.
+ */
+void
+upgrade_pipeline_progress_get(
+    upgrade_progress* progress, upgrade_pipeline* pipeline);
+
+/******************************************************************************/
+/* Start of control methods.                                                  */
+/******************************************************************************/
+
+/**
+ * \brief Ask an \ref upgrade_pipeline to stop.
+ *
+ * \param pipeline      The \ref upgrade_pipeline instance for this operation.
+ *
+ * \note Records in flight are discarded. The checkpoint still covers every
+ * record that was emitted, so the upgrade can be resumed from it.
+ */
+void
+upgrade_pipeline_cancel(
+    upgrade_pipeline* pipeline);
+
+/**
+ * \brief Wait for every stage of an \ref upgrade_pipeline to stop.
+ *
+ * \param pipeline      The \ref upgrade_pipeline instance for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS if every record was upgraded.
+ *      - ERROR_UPGRADE_PIPELINE_CANCELED if the pipeline was canceled.
+ *      - the first error returned by a stage or callback otherwise.
+ */
+status FN_DECL_MUST_CHECK
+upgrade_pipeline_join(
+    upgrade_pipeline* pipeline);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
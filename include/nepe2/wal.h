@@ -0,0 +1,185 @@
+/**
+ * \file nepe2/wal.h
+ *
+ * \brief A write-ahead log makes record updates durable with one data sync per
+ * group of concurrent writers, and applies them to a \ref store_file later.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <nepe2/metadata.h>
+#include <nepe2/store_file.h>
+#include <rcpr/allocator.h>
+#include <rcpr/resource.h>
+#include <stdint.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief A write-ahead log sits in front of a target \ref store_file.
+ *
+ * The log is itself a store image. Each append blocks until its records are
+ * durable in the log. Concurrent appends are committed as a group: the first
+ * writer to find no commit in progress becomes the leader, waits up to the
+ * configured delay for other writers to join, and then writes and syncs every
+ * waiting record at once. Writers that arrive while a commit is in progress
+ * join the next group.
+ *
+ * A checkpoint applies the log to the target and empties the log. Opening a
+ * log replays any records left by a previous process, so an update is never
+ * lost once its append has returned. A torn record at the end of the log,
+ * left by a crash during a commit, was never acknowledged and is dropped. A
+ * damaged record with more of the log after it holds acknowledged updates, so
+ * the replay fails and leaves the log as it is. A log opened with
+ * \ref STORE_FILE_FLAG_CRC32C checksums each record, so that a damaged record
+ * is found even if it happens to parse.
+ *
+ * A crash after the log has been applied but before it is emptied applies it
+ * again on the next open, so the target can hold identical copies of a record.
+ */
+typedef struct wal wal;
+
+/******************************************************************************/
+/* Start of constructors.                                                     */
+/******************************************************************************/
+
+/**
+ * \brief Open a write-ahead log, replaying any records in it into the target.
+ *
+ * \param w             Pointer to the log pointer to receive the log on
+ *                      success.
+ * \param alloc         The allocator instance to use for this operation, which
+ *                      must be thread-safe.
+ * \param path          The path of the log, which is created if it does not
+ *                      exist.
+ * \param target        The \ref store_file that the log is applied to.
+ * \param flags         Zero or more STORE_FILE_FLAG_ values for the log.
+ * \param max_delay_us  The longest time, in microseconds, that a commit waits
+ *                      for other writers to join it. Zero commits as soon as
+ *                      the previous commit finishes.
+ *
+ * \note This log is a \ref resource that must be released by calling
+ * \ref resource_release on its resource handle when it is no longer needed by
+ * the caller. The resource handle can be accessed by calling
+ * \ref wal_resource_handle on this log instance. Releasing the log does not
+ * checkpoint it; the records are replayed when it is next opened.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_WAL_SYNC_INIT_FAILED if the commit lock could not be created.
+ *      - an error from \ref store_file_open if the log could not be opened.
+ *      - ERROR_WAL_CORRUPT if a record before the end of the log is damaged.
+ *      - an error from \ref store_file_append or \ref store_file_truncate if
+ *        the log could not be replayed.
+ *
+ * \pre
+ *      - \p w must not reference a valid \ref wal instance and must not be
+ *        NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ *      - \p path must be a valid ASCII zero terminated string.
+ *      - \p target must reference a valid \ref store_file instance.
+ * \post
+ *      - On success, \p w is set to a pointer to a valid \ref wal instance,
+ *        which is a \ref resource owned by the caller that must be released
+ *        when no longer needed. The log takes ownership of \p target.
+ *      - On failure, \p w is not changed, \p target is still owned by the
+ *        caller, and an error status is returned.
+ */
+status FN_DECL_MUST_CHECK
+wal_open(
+    wal** w, RCPR_SYM(allocator)* alloc, const char* path, store_file* target,
+    uint32_t flags, uint32_t max_delay_us);
+
+/******************************************************************************/
+/* Start of accessors.                                                        */
+/******************************************************************************/
+
+/**
+ * \brief Given a \ref wal instance, return the resource handle for this
+ * \ref wal instance.
+ *
+ * \param w             The \ref wal instance from which the resource handle is
+ *                      returned.
+ *
+ * \returns the resource handle for this \ref wal instance.
+ */
+RCPR_SYM(resource)*
+wal_resource_handle(
+    wal* w);
+
+/**
+ * \brief Get the number of commits, each of which is one data sync of the log.
+ *
+ * \param w             The \ref wal instance for this operation.
+ *
+ * \returns the number of commits since this log was opened.
+ */
+uint64_t
+wal_commit_count_get(
+    wal* w);
+
+/******************************************************************************/
+/* Start of write-ahead log methods.                                          */
+/******************************************************************************/
+
+/**
+ * \brief Append records to a \ref wal, and wait until they are durable.
+ *
+ * \param w             The \ref wal for this operation.
+ * \param records       The records to append.
+ * \param count         The number of records.
+ *
+ * \note This may be called from any number of threads at once. The records
+ * are written from their own storage, so they must not be modified until this
+ * returns.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_WAL_FAILED if this or an earlier commit failed. Once a commit
+ *        fails, the durable contents of the log are unknown, so every later
+ *        append fails until the log is reopened.
+ *
+ * \pre
+ *      - \p records must point to \p count valid, non-empty \ref metadata
+ *        instances.
+ */
+status FN_DECL_MUST_CHECK
+wal_append(
+    wal* w, const metadata* const* records, size_t count);
+
+/**
+ * \brief Apply every committed record in a \ref wal to its target, and empty
+ * the log.
+ *
+ * \param w             The \ref wal for this operation.
+ *
+ * \note The target is synced before the log is emptied. Appends may continue
+ * while a checkpoint runs; they are committed once it finishes.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_WAL_FAILED if an earlier commit failed.
+ *      - ERROR_WAL_CORRUPT if a record before the end of the log is damaged.
+ *      - an error from \ref store_file_append or \ref store_file_truncate if
+ *        the log could not be applied.
+ */
+status FN_DECL_MUST_CHECK
+wal_checkpoint(
+    wal* w);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
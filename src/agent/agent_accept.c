@@ -0,0 +1,91 @@
+/**
+ * \file agent/agent_accept.c
+ *
+ * \brief Accept pending connections for an \ref agent.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <nepe2/error_codes.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "agent_internal.h"
+
+/**
+ * \brief Accept every pending connection on the listening socket.
+ *
+ * \param ag            The \ref agent for this operation.
+ *
+ * \note If the agent runs out of descriptors or memory, the listening socket
+ * is unwatched until \ref agent_accept_resume is called.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_AGENT_EPOLL_FAILED if the listening socket failed.
+ */
+status FN_DECL_MUST_CHECK
+agent_accept(
+    agent* ag)
+{
+    for (;;)
+    {
+        int fd = accept(ag->listen_fd, NULL, NULL);
+        if (fd < 0)
+        {
+            switch (errno)
+            {
+                /* every pending connection has been accepted. */
+                case EAGAIN:
+#if EWOULDBLOCK != EAGAIN
+                case EWOULDBLOCK:
+#endif
+                    return STATUS_SUCCESS;
+
+                /* these only affect the connection being accepted. */
+                case EINTR:
+                case ECONNABORTED:
+                case EPROTO:
+                    continue;
+
+                /* out of descriptors or memory. The listening socket is
+                 * level triggered, so it is unwatched until a connection
+                 * closes or the retry interval passes, rather than waking
+                 * the event loop again immediately. */
+                case EMFILE:
+                case ENFILE:
+                case ENOBUFS:
+                case ENOMEM:
+                    if (0 != epoll_ctl(
+                                ag->epoll_fd, EPOLL_CTL_DEL, ag->listen_fd,
+                                NULL))
+                    {
+                        return ERROR_AGENT_EPOLL_FAILED;
+                    }
+
+                    ag->accept_paused = true;
+                    return STATUS_SUCCESS;
+
+                default:
+                    return ERROR_AGENT_EPOLL_FAILED;
+            }
+        }
+
+        /* a connection that can't be set up is dropped. */
+        if (0 != fcntl(fd, F_SETFD, FD_CLOEXEC)
+         || 0 != fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK))
+        {
+            close(fd);
+            continue;
+        }
+
+        if (STATUS_SUCCESS != agent_connection_add(ag, fd))
+        {
+            continue;
+        }
+    }
+}
@@ -0,0 +1,48 @@
+/**
+ * \file agent/agent_accept_resume.c
+ *
+ * \brief Resume accepting connections for an \ref agent.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <string.h>
+#include <sys/epoll.h>
+
+#include "agent_internal.h"
+
+/**
+ * \brief Watch the listening socket again after \ref agent_accept paused it.
+ *
+ * \param ag            The \ref agent for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success, or if accepting was not paused.
+ *      - ERROR_AGENT_EPOLL_FAILED if the listening socket could not be
+ *        rewatched.
+ */
+status FN_DECL_MUST_CHECK
+agent_accept_resume(
+    agent* ag)
+{
+    struct epoll_event ev;
+
+    if (!ag->accept_paused)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = &ag->listen_fd;
+    if (0 != epoll_ctl(ag->epoll_fd, EPOLL_CTL_ADD, ag->listen_fd, &ev))
+    {
+        return ERROR_AGENT_EPOLL_FAILED;
+    }
+
+    ag->accept_paused = false;
+
+    return STATUS_SUCCESS;
+}
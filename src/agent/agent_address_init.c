@@ -0,0 +1,42 @@
+/**
+ * \file agent/agent_address_init.c
+ *
+ * \brief Fill a Unix domain socket address.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <string.h>
+
+#include "agent_internal.h"
+
+/**
+ * \brief Fill a Unix domain socket address for the given path.
+ *
+ * \param addr          The address to fill.
+ * \param path          The socket path.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_AGENT_PATH_TOO_LONG if \p path does not fit in \p addr.
+ */
+status FN_DECL_MUST_CHECK
+agent_address_init(
+    struct sockaddr_un* addr, const char* path)
+{
+    size_t path_size = strlen(path) + 1;
+
+    /* the path, including its terminator, must fit in the address. */
+    if (path_size > sizeof(addr->sun_path))
+    {
+        return ERROR_AGENT_PATH_TOO_LONG;
+    }
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    memcpy(addr->sun_path, path, path_size);
+
+    return STATUS_SUCCESS;
+}
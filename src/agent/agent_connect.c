@@ -0,0 +1,57 @@
+/**
+ * \file agent/agent_connect.c
+ *
+ * \brief Connect to an \ref agent.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "agent_internal.h"
+
+/**
+ * \brief Connect to an agent.
+ *
+ * \param fd            Pointer to receive the connected socket on success,
+ *                      which is owned by the caller.
+ * \param path          The socket path of the agent.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_AGENT_PATH_TOO_LONG if \p path does not fit in a socket
+ *        address.
+ *      - ERROR_AGENT_SOCKET_FAILED if the connection failed.
+ */
+status FN_DECL_MUST_CHECK
+agent_connect(
+    int* fd, const char* path)
+{
+    status retval;
+    struct sockaddr_un addr;
+
+    retval = agent_address_init(&addr, path);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    int tmp = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (tmp < 0)
+    {
+        return ERROR_AGENT_SOCKET_FAILED;
+    }
+
+    if (0 != connect(tmp, (const struct sockaddr*)&addr, sizeof(addr)))
+    {
+        close(tmp);
+        return ERROR_AGENT_SOCKET_FAILED;
+    }
+
+    *fd = tmp;
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,116 @@
+/**
+ * \file agent/agent_connection_add.c
+ *
+ * \brief Add an accepted connection to an \ref agent.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "agent_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Set up a newly accepted connection.
+ *
+ * \param ag            The \ref agent for this operation.
+ * \param fd            The accepted socket, which is closed on failure.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_AGENT_EPOLL_FAILED if the connection could not be watched.
+ */
+status FN_DECL_MUST_CHECK
+agent_connection_add(
+    agent* ag, int fd)
+{
+    status retval, release_retval;
+    agent_connection* conn = NULL;
+    struct epoll_event ev;
+
+    /* allocate memory for the connection. */
+    retval = allocator_allocate(ag->alloc, (void**)&conn, sizeof(*conn));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_fd;
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(conn, 0, sizeof(*conn)));
+    conn->fd = fd;
+
+    /* create the input and output buffers. */
+    retval =
+        secure_buffer_builder_create(
+            &conn->in, ag->alloc, AGENT_CONNECTION_BUFFER_CAPACITY);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_conn;
+    }
+
+    retval =
+        secure_buffer_builder_create(
+            &conn->out, ag->alloc, AGENT_CONNECTION_BUFFER_CAPACITY);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_in;
+    }
+
+    /* watch it for requests. */
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = conn;
+    if (0 != epoll_ctl(ag->epoll_fd, EPOLL_CTL_ADD, fd, &ev))
+    {
+        retval = ERROR_AGENT_EPOLL_FAILED;
+        goto cleanup_out;
+    }
+
+    /* add it to the connection list. */
+    conn->next = ag->connections;
+    if (NULL != conn->next)
+    {
+        conn->next->prev = conn;
+    }
+    ag->connections = conn;
+
+    return STATUS_SUCCESS;
+
+cleanup_out:
+    release_retval =
+        resource_release(secure_buffer_builder_resource_handle(conn->out));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_in:
+    release_retval =
+        resource_release(secure_buffer_builder_resource_handle(conn->in));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_conn:
+    RCPR_MODEL_EXEMPT(memset(conn, 0, sizeof(*conn)));
+    release_retval = allocator_reclaim(ag->alloc, conn);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_fd:
+    close(fd);
+
+    return retval;
+}
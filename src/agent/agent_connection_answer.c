@@ -0,0 +1,71 @@
+/**
+ * \file agent/agent_connection_answer.c
+ *
+ * \brief Answer the complete requests buffered on an \ref agent connection.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <rcpr/socket_utilities.h>
+#include <string.h>
+
+#include "agent_internal.h"
+
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Answer every complete request frame in the input of a connection.
+ *
+ * \param ag            The \ref agent that owns this connection.
+ * \param conn          The connection.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_AGENT_BAD_FRAME if a frame is too large.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ */
+status FN_DECL_MUST_CHECK
+agent_connection_answer(
+    agent* ag, agent_connection* conn)
+{
+    status retval = STATUS_SUCCESS;
+    size_t size, offset = 0U;
+    uint32_t net_frame_size;
+
+    const uint8_t* data = secure_buffer_builder_data(&size, conn->in);
+    while (size - offset >= AGENT_FRAME_PREFIX_SIZE)
+    {
+        memcpy(&net_frame_size, data + offset, sizeof(net_frame_size));
+        size_t frame_size = socket_utility_ntoh32(net_frame_size);
+        if (frame_size > AGENT_FRAME_MAX)
+        {
+            retval = ERROR_AGENT_BAD_FRAME;
+            break;
+        }
+
+        /* wait for the rest of this frame. */
+        if (size - offset - AGENT_FRAME_PREFIX_SIZE < frame_size)
+        {
+            break;
+        }
+
+        retval =
+            agent_dispatch(
+                ag, conn->out, data + offset + AGENT_FRAME_PREFIX_SIZE,
+                frame_size);
+        if (STATUS_SUCCESS != retval)
+        {
+            break;
+        }
+
+        offset += AGENT_FRAME_PREFIX_SIZE + frame_size;
+    }
+
+    /* drop the answered requests. */
+    secure_buffer_builder_consume(conn->in, offset);
+
+    return retval;
+}
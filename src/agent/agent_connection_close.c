@@ -0,0 +1,86 @@
+/**
+ * \file agent/agent_connection_close.c
+ *
+ * \brief Close an \ref agent connection.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+#include <unistd.h>
+
+#include "agent_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Close a connection and release its buffers.
+ *
+ * \param ag            The \ref agent that owns this connection.
+ * \param conn          The connection to close.
+ *
+ * \note Closing the socket also removes it from the epoll instance. Since it
+ * frees a descriptor, accepting is resumed if it was paused.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status FN_DECL_MUST_CHECK
+agent_connection_close(
+    agent* ag, agent_connection* conn)
+{
+    status retval = STATUS_SUCCESS;
+    status release_retval;
+
+    /* remove it from the connection list. */
+    if (NULL != conn->prev)
+    {
+        conn->prev->next = conn->next;
+    }
+    else
+    {
+        ag->connections = conn->next;
+    }
+
+    if (NULL != conn->next)
+    {
+        conn->next->prev = conn->prev;
+    }
+
+    close(conn->fd);
+
+    /* a descriptor is now free, so try accepting again. */
+    release_retval = agent_accept_resume(ag);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    /* release the buffers, which erases any unanswered requests. */
+    release_retval =
+        resource_release(secure_buffer_builder_resource_handle(conn->in));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    release_retval =
+        resource_release(secure_buffer_builder_resource_handle(conn->out));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    /* clear and reclaim memory. */
+    RCPR_MODEL_EXEMPT(memset(conn, 0, sizeof(*conn)));
+    release_retval = allocator_reclaim(ag->alloc, conn);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
@@ -0,0 +1,79 @@
+/**
+ * \file agent/agent_connection_flush.c
+ *
+ * \brief Write the pending output of an \ref agent connection.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <errno.h>
+#include <nepe2/error_codes.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+#include "agent_internal.h"
+
+/**
+ * \brief Write as much of the pending output of a connection as possible.
+ *
+ * \param ag            The \ref agent that owns this connection.
+ * \param conn          The connection to write.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_AGENT_IO_FAILED if a write failed.
+ *      - ERROR_AGENT_EPOLL_FAILED if the connection could not be rewatched.
+ */
+status FN_DECL_MUST_CHECK
+agent_connection_flush(
+    agent* ag, agent_connection* conn)
+{
+    size_t size;
+    struct epoll_event ev;
+
+    for (;;)
+    {
+        const void* data = secure_buffer_builder_data(&size, conn->out);
+        if (0 == size)
+        {
+            break;
+        }
+
+        /* a client that disconnects must not raise SIGPIPE in the agent. */
+        ssize_t bytes = send(conn->fd, data, size, MSG_NOSIGNAL);
+        if (bytes < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            else if (EAGAIN == errno || EWOULDBLOCK == errno)
+            {
+                break;
+            }
+
+            return ERROR_AGENT_IO_FAILED;
+        }
+
+        secure_buffer_builder_consume(conn->out, (size_t)bytes);
+    }
+
+    /* watch for writability only while output is pending. */
+    bool writing = size > 0;
+    if (writing != conn->writing)
+    {
+        memset(&ev, 0, sizeof(ev));
+        ev.events = writing ? EPOLLOUT : EPOLLIN;
+        ev.data.ptr = conn;
+        if (0 != epoll_ctl(ag->epoll_fd, EPOLL_CTL_MOD, conn->fd, &ev))
+        {
+            return ERROR_AGENT_EPOLL_FAILED;
+        }
+
+        conn->writing = writing;
+    }
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,54 @@
+/**
+ * \file agent/agent_connection_handle.c
+ *
+ * \brief Handle the events of one \ref agent connection.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <sys/epoll.h>
+
+#include "agent_internal.h"
+
+/**
+ * \brief Handle the events for one connection.
+ *
+ * \param ag            The \ref agent that owns this connection.
+ * \param conn          The connection.
+ * \param events        The epoll events for this connection.
+ *
+ * \note A connection that fails for any reason is closed; this never stops the
+ * agent. A connection at EOF is closed once all of its output is written.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code if a failed connection could not be closed.
+ */
+status FN_DECL_MUST_CHECK
+agent_connection_handle(
+    agent* ag, agent_connection* conn, uint32_t events)
+{
+    status retval = STATUS_SUCCESS;
+
+    /* a connection with pending output is not read until it is written. */
+    if (!conn->writing && (events & (EPOLLIN | EPOLLHUP | EPOLLERR)))
+    {
+        retval = agent_connection_read(ag, conn);
+    }
+
+    /* write any responses. */
+    if (STATUS_SUCCESS == retval
+     && secure_buffer_builder_size_get(conn->out) > 0)
+    {
+        retval = agent_connection_flush(ag, conn);
+    }
+
+    if (STATUS_SUCCESS != retval
+     || (conn->eof && 0 == secure_buffer_builder_size_get(conn->out)))
+    {
+        return agent_connection_close(ag, conn);
+    }
+
+    return STATUS_SUCCESS;
+}
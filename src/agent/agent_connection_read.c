@@ -0,0 +1,96 @@
+/**
+ * \file agent/agent_connection_read.c
+ *
+ * \brief Read and answer requests from an \ref agent connection.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <errno.h>
+#include <nepe2/error_codes.h>
+#include <unistd.h>
+
+#include "agent_internal.h"
+
+/**
+ * \brief The number of bytes to read at a time.
+ */
+#define AGENT_READ_SIZE                                                  16384
+
+/**
+ * \brief The most reads to perform for one event, so that a busy client can't
+ * starve the others. The event loop is level triggered, so any remaining input
+ * is read on the next wait.
+ */
+#define AGENT_READS_PER_EVENT                                                8
+
+/**
+ * \brief Read every available byte from a connection, and answer each complete
+ * request frame.
+ *
+ * \param ag            The \ref agent that owns this connection.
+ * \param conn          The connection to read.
+ *
+ * \note When the peer shuts down its side of the connection, the complete
+ * frames already read are still answered and \p conn is marked as at EOF, so
+ * that it is closed once its output is written.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_AGENT_IO_FAILED if a read failed.
+ *      - ERROR_AGENT_BAD_FRAME if a frame is too large.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ */
+status FN_DECL_MUST_CHECK
+agent_connection_read(
+    agent* ag, agent_connection* conn)
+{
+    status retval;
+    void* region;
+
+    for (int i = 0; i < AGENT_READS_PER_EVENT; ++i)
+    {
+        /* read directly into the end of the input buffer. */
+        size_t size = secure_buffer_builder_size_get(conn->in);
+        retval =
+            secure_buffer_builder_extend(&region, conn->in, AGENT_READ_SIZE);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        ssize_t bytes = read(conn->fd, region, AGENT_READ_SIZE);
+        secure_buffer_builder_truncate(
+            conn->in, size + (bytes > 0 ? (size_t)bytes : 0U));
+
+        if (0 == bytes)
+        {
+            /* the peer is done writing; answer what it sent, then close
+             * once the answers are written. */
+            conn->eof = true;
+            break;
+        }
+        else if (bytes < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            else if (EAGAIN == errno || EWOULDBLOCK == errno)
+            {
+                break;
+            }
+
+            return ERROR_AGENT_IO_FAILED;
+        }
+        else if (bytes < AGENT_READ_SIZE)
+        {
+            /* the socket has been drained. */
+            break;
+        }
+    }
+
+    return agent_connection_answer(ag, conn);
+}
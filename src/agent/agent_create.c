@@ -0,0 +1,195 @@
+/**
+ * \file agent/agent_create.c
+ *
+ * \brief Create an \ref agent instance.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "agent_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Create an agent listening on the given Unix domain socket path.
+ *
+ * \param ag            Pointer to the agent pointer to receive the agent on
+ *                      success.
+ * \param alloc         The allocator instance to use for this operation, which
+ *                      must be thread-safe.
+ * \param vault         The unlocked vault to serve.
+ * \param ctx           The \ref derive_context holding the master passphrase.
+ * \param path          The socket path, which must not exist.
+ * \param flags         Zero or more AGENT_FLAG_ values.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_AGENT_PATH_TOO_LONG if \p path does not fit in a socket
+ *        address.
+ *      - ERROR_AGENT_SOCKET_FAILED if the socket could not be created, bound,
+ *        or listened on.
+ *      - ERROR_AGENT_EPOLL_FAILED if the event loop could not be created.
+ *      - ERROR_AGENT_MLOCK_FAILED if \ref AGENT_FLAG_LOCK_MEMORY is set and
+ *        memory could not be locked.
+ */
+status FN_DECL_MUST_CHECK
+agent_create(
+    agent** ag, RCPR_SYM(allocator)* alloc, store* vault, derive_context* ctx,
+    const char* path, uint32_t flags)
+{
+    status retval, release_retval;
+    agent* tmp = NULL;
+    bool bound = false;
+    struct epoll_event ev;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != ag);
+    RCPR_MODEL_ASSERT(prop_allocator_valid(alloc));
+    RCPR_MODEL_ASSERT(prop_store_valid(vault));
+    RCPR_MODEL_ASSERT(prop_derive_context_valid(ctx));
+    RCPR_MODEL_ASSERT(NULL != path);
+
+    /* allocate memory for the agent instance. */
+    retval = allocator_allocate(alloc, (void**)&tmp, sizeof(*tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(tmp, 0, sizeof(*tmp)));
+    tmp->listen_fd = -1;
+    tmp->epoll_fd = -1;
+    tmp->stop_fd = -1;
+
+    /* the tag is not set by default. */
+    RCPR_MODEL_ONLY(tmp->RCPR_MODEL_STRUCT_TAG_REF(agent) = 0);
+    RCPR_MODEL_ASSERT_STRUCT_TAG_NOT_INITIALIZED(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(agent), agent);
+
+    /* set the tag. */
+    RCPR_MODEL_STRUCT_TAG_INIT(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(agent), agent);
+
+    /* initialize resource. */
+    resource_init(&tmp->hdr, &agent_resource_release);
+    tmp->alloc = alloc;
+
+    /* build the socket address. */
+    retval = agent_address_init(&tmp->addr, path);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    /* keep the vault and derivation state out of swap if requested. */
+    if ((flags & AGENT_FLAG_LOCK_MEMORY)
+     && 0 != mlockall(MCL_CURRENT | MCL_FUTURE))
+    {
+        retval = ERROR_AGENT_MLOCK_FAILED;
+        goto cleanup_tmp;
+    }
+
+    /* create the listening socket. */
+    tmp->listen_fd =
+        socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (tmp->listen_fd < 0)
+    {
+        retval = ERROR_AGENT_SOCKET_FAILED;
+        goto cleanup_tmp;
+    }
+
+    /* bind it, and restrict it to the owner of this process. */
+    if (0 != bind(
+                tmp->listen_fd, (const struct sockaddr*)&tmp->addr,
+                sizeof(tmp->addr)))
+    {
+        retval = ERROR_AGENT_SOCKET_FAILED;
+        goto cleanup_tmp;
+    }
+
+    bound = true;
+    if (0 != chmod(tmp->addr.sun_path, S_IRUSR | S_IWUSR)
+     || 0 != listen(tmp->listen_fd, SOMAXCONN))
+    {
+        retval = ERROR_AGENT_SOCKET_FAILED;
+        goto cleanup_tmp;
+    }
+
+    /* create the event loop and the stop event. */
+    tmp->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    tmp->stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (tmp->epoll_fd < 0 || tmp->stop_fd < 0)
+    {
+        retval = ERROR_AGENT_EPOLL_FAILED;
+        goto cleanup_tmp;
+    }
+
+    /* watch the listening socket and the stop event. */
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = &tmp->listen_fd;
+    if (0 != epoll_ctl(tmp->epoll_fd, EPOLL_CTL_ADD, tmp->listen_fd, &ev))
+    {
+        retval = ERROR_AGENT_EPOLL_FAILED;
+        goto cleanup_tmp;
+    }
+
+    ev.data.ptr = &tmp->stop_fd;
+    if (0 != epoll_ctl(tmp->epoll_fd, EPOLL_CTL_ADD, tmp->stop_fd, &ev))
+    {
+        retval = ERROR_AGENT_EPOLL_FAILED;
+        goto cleanup_tmp;
+    }
+
+    /* success. */
+    tmp->vault = vault;
+    tmp->ctx = ctx;
+    *ag = tmp;
+    retval = STATUS_SUCCESS;
+    goto done;
+
+cleanup_tmp:
+    if (tmp->stop_fd >= 0)
+    {
+        close(tmp->stop_fd);
+    }
+
+    if (tmp->epoll_fd >= 0)
+    {
+        close(tmp->epoll_fd);
+    }
+
+    if (tmp->listen_fd >= 0)
+    {
+        close(tmp->listen_fd);
+    }
+
+    if (bound)
+    {
+        unlink(tmp->addr.sun_path);
+    }
+
+    RCPR_MODEL_EXEMPT(memset(tmp, 0, sizeof(*tmp)));
+    release_retval = allocator_reclaim(alloc, tmp);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
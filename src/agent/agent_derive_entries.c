@@ -0,0 +1,102 @@
+/**
+ * \file agent/agent_derive_entries.c
+ *
+ * \brief Derive the passwords of an \ref agent request.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "agent_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Derive the password of every entry that has a record.
+ *
+ * \param ag            The \ref agent for this operation.
+ * \param entries       The entries.
+ * \param count         The number of entries.
+ *
+ * \note Each record is checked with \ref derive_password_check first, so an
+ * invalid record only fails its own entry. The rest are derived as one batch
+ * on several threads; if the batch still fails, for instance because the KDF
+ * failed, every entry in it fails with the status of the batch.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ */
+status FN_DECL_MUST_CHECK
+agent_derive_entries(
+    agent* ag, agent_dispatch_entry* entries, size_t count)
+{
+    status retval, release_retval;
+    const metadata** records = NULL;
+    secure_buffer** passwords = NULL;
+    size_t found = 0U;
+
+    /* leave out the records that would fail the batch. */
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (STATUS_SUCCESS == entries[i].retval)
+        {
+            entries[i].retval =
+                derive_password_check(ag->ctx, entries[i].record);
+        }
+
+        if (STATUS_SUCCESS == entries[i].retval)
+        {
+            ++found;
+        }
+    }
+
+    if (0 == found)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    /* gather the records into one batch. */
+    retval =
+        allocator_allocate(
+            ag->alloc, (void**)&records,
+            found * (sizeof(*records) + sizeof(*passwords)));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    passwords = (secure_buffer**)(records + found);
+    for (size_t i = 0, j = 0; i < count; ++i)
+    {
+        if (STATUS_SUCCESS == entries[i].retval)
+        {
+            records[j++] = entries[i].record;
+        }
+    }
+
+    retval =
+        derive_password_batch(
+            passwords, ag->alloc, ag->ctx, records, found, 0);
+
+    /* hand each password to its entry. */
+    for (size_t i = 0, j = 0; i < count; ++i)
+    {
+        if (STATUS_SUCCESS != entries[i].retval)
+        {
+            continue;
+        }
+
+        entries[i].password = passwords[j++];
+        entries[i].retval = retval;
+    }
+
+    release_retval = allocator_reclaim(ag->alloc, records);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        return release_retval;
+    }
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,174 @@
+/**
+ * \file agent/agent_dispatch.c
+ *
+ * \brief Answer one \ref agent request.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <string.h>
+
+#include "agent_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Answer one request payload, appending the response frame to the
+ * output of a connection.
+ *
+ * \param ag            The \ref agent for this operation.
+ * \param out           The output buffer of the connection.
+ * \param payload       The request payload.
+ * \param size          The size of the request payload.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ */
+status FN_DECL_MUST_CHECK
+agent_dispatch(
+    agent* ag, secure_buffer_builder* out, const uint8_t* payload,
+    size_t size)
+{
+    status retval, release_retval, request_status;
+    agent_dispatch_entry* entries = NULL;
+    size_t count = 0U;
+    size_t response_count = 0U;
+    size_t frame_size, out_size;
+    uint8_t op;
+    uint8_t* bptr;
+    void* region;
+
+    /* reserve the frame prefix and response header. */
+    size_t start = secure_buffer_builder_size_get(out);
+    retval =
+        secure_buffer_builder_extend(
+            &region, out,
+            AGENT_FRAME_PREFIX_SIZE + AGENT_RESPONSE_HEADER_SIZE);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* read the request header. */
+    if (size < AGENT_REQUEST_HEADER_SIZE)
+    {
+        request_status = ERROR_AGENT_BAD_FRAME;
+        goto write_header;
+    }
+
+    op = payload[0];
+    count = agent_get_u32(payload + 1);
+    if (AGENT_OP_LOOKUP != op && AGENT_OP_DERIVE != op)
+    {
+        request_status = ERROR_AGENT_UNKNOWN_OP;
+        goto write_header;
+    }
+
+    /* each entry is at least a hash id size. */
+    if (count > (size - AGENT_REQUEST_HEADER_SIZE) / sizeof(uint32_t))
+    {
+        request_status = ERROR_AGENT_BAD_FRAME;
+        goto write_header;
+    }
+
+    if (count > 0)
+    {
+        retval =
+            allocator_allocate(
+                ag->alloc, (void**)&entries, count * sizeof(*entries));
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_entries;
+        }
+
+        RCPR_MODEL_EXEMPT(memset(entries, 0, count * sizeof(*entries)));
+    }
+
+    request_status =
+        agent_request_entries_read(
+            entries, count, payload + AGENT_REQUEST_HEADER_SIZE,
+            size - AGENT_REQUEST_HEADER_SIZE);
+    if (STATUS_SUCCESS != request_status)
+    {
+        goto write_header;
+    }
+
+    /* look up every entry. */
+    agent_lookup_entries(ag, entries, count);
+
+    /* derive every entry that was found. */
+    if (AGENT_OP_DERIVE == op)
+    {
+        retval = agent_derive_entries(ag, entries, count);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_entries;
+        }
+    }
+
+    retval = agent_response_entries_append(out, op, entries, count);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_entries;
+    }
+
+    /* a response that is too large is replaced by an error. */
+    response_count = count;
+    frame_size =
+        secure_buffer_builder_size_get(out) - start - AGENT_FRAME_PREFIX_SIZE;
+    if (frame_size > AGENT_FRAME_MAX)
+    {
+        secure_buffer_builder_truncate(
+            out, start + AGENT_FRAME_PREFIX_SIZE + AGENT_RESPONSE_HEADER_SIZE);
+        request_status = ERROR_AGENT_BAD_FRAME;
+        response_count = 0;
+    }
+
+write_header:
+    bptr = (uint8_t*)secure_buffer_builder_data(&out_size, out) + start;
+    bptr = agent_put_u32(bptr, out_size - start - AGENT_FRAME_PREFIX_SIZE);
+    bptr = agent_put_u32(bptr, request_status);
+    agent_put_u32(bptr, response_count); /* shortening cast. */
+
+    /* success. */
+    retval = STATUS_SUCCESS;
+    goto cleanup_entries;
+
+cleanup_entries:
+    if (STATUS_SUCCESS != retval)
+    {
+        secure_buffer_builder_truncate(out, start);
+    }
+
+    if (NULL != entries)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (NULL != entries[i].password)
+            {
+                release_retval =
+                    resource_release(
+                        secure_buffer_resource_handle(entries[i].password));
+                if (STATUS_SUCCESS != release_retval)
+                {
+                    retval = release_retval;
+                }
+            }
+        }
+
+        RCPR_MODEL_EXEMPT(memset(entries, 0, count * sizeof(*entries)));
+        release_retval = allocator_reclaim(ag->alloc, entries);
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+done:
+    return retval;
+}
@@ -0,0 +1,429 @@
+/**
+ * \file agent/agent_internal.h
+ *
+ * \brief Internal header for \ref agent.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <nepe2/agent.h>
+#include <rcpr/resource/protected.h>
+#include <rcpr/socket_utilities.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief The size of the fixed part of a request payload (op and count).
+ */
+#define AGENT_REQUEST_HEADER_SIZE                                            5
+
+/**
+ * \brief The size of the fixed part of a response payload (status and count).
+ */
+#define AGENT_RESPONSE_HEADER_SIZE                                           8
+
+/**
+ * \brief The size of the fixed part of a response entry (status and size).
+ */
+#define AGENT_RESPONSE_ENTRY_HEADER_SIZE                                     8
+
+/**
+ * \brief The number of events handled per wait.
+ */
+#define AGENT_EVENT_COUNT                                                   64
+
+/**
+ * \brief The number of request entries passed to each batch lookup.
+ */
+#define AGENT_LOOKUP_CHUNK                                                  64
+
+/**
+ * \brief How long to wait before listening again after running out of
+ * descriptors or memory, if no connection closes first.
+ */
+#define AGENT_ACCEPT_RETRY_MSEC                                            100
+
+/**
+ * \brief The initial capacity of each connection buffer.
+ */
+#define AGENT_CONNECTION_BUFFER_CAPACITY                                  4096
+
+/**
+ * \brief A client connection.
+ */
+typedef struct agent_connection agent_connection;
+
+struct agent_connection
+{
+    int fd;
+    bool writing;
+    bool eof;
+    secure_buffer_builder* in;
+    secure_buffer_builder* out;
+    agent_connection* prev;
+    agent_connection* next;
+};
+
+/**
+ * \brief The state of one request entry.
+ */
+typedef struct agent_dispatch_entry agent_dispatch_entry;
+
+struct agent_dispatch_entry
+{
+    const uint8_t* hash_id;
+    size_t hash_id_size;
+    status retval;
+    const metadata* record;
+    secure_buffer* password;
+};
+
+/**
+ * \brief Write a big-endian uint32_t.
+ */
+static inline uint8_t* agent_put_u32(uint8_t* bptr, uint32_t value)
+{
+    uint32_t net_value = RCPR_SYM(socket_utility_hton32)(value);
+    memcpy(bptr, &net_value, sizeof(net_value));
+
+    return bptr + sizeof(net_value);
+}
+
+/**
+ * \brief Read a big-endian uint32_t.
+ */
+static inline uint32_t agent_get_u32(const uint8_t* bptr)
+{
+    uint32_t net_value;
+    memcpy(&net_value, bptr, sizeof(net_value));
+
+    return RCPR_SYM(socket_utility_ntoh32)(net_value);
+}
+
+struct agent
+{
+    RCPR_SYM(resource) hdr;
+    RCPR_MODEL_STRUCT_TAG(agent);
+    RCPR_SYM(allocator)* alloc;
+    store* vault;
+    derive_context* ctx;
+    int listen_fd;
+    int epoll_fd;
+    int stop_fd;
+    bool stopped;
+    bool accept_paused;
+    agent_connection* connections;
+    struct sockaddr_un addr;
+};
+
+/**
+ * \brief Release an \ref agent resource.
+ *
+ * \param r             Pointer to the \ref agent resource to be released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status agent_resource_release(RCPR_SYM(resource)* r);
+
+/**
+ * \brief Fill a Unix domain socket address for the given path.
+ *
+ * \param addr          The address to fill.
+ * \param path          The socket path.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_AGENT_PATH_TOO_LONG if \p path does not fit in \p addr.
+ */
+status FN_DECL_MUST_CHECK
+agent_address_init(
+    struct sockaddr_un* addr, const char* path);
+
+/**
+ * \brief Accept every pending connection on the listening socket.
+ *
+ * \param ag            The \ref agent for this operation.
+ *
+ * \note A connection that can't be set up is closed, and does not stop the
+ * agent. If the agent runs out of descriptors or memory, the listening socket
+ * is unwatched until \ref agent_accept_resume is called.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_AGENT_EPOLL_FAILED if the listening socket failed.
+ */
+status FN_DECL_MUST_CHECK
+agent_accept(
+    agent* ag);
+
+/**
+ * \brief Watch the listening socket again after \ref agent_accept paused it.
+ *
+ * \param ag            The \ref agent for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success, or if accepting was not paused.
+ *      - ERROR_AGENT_EPOLL_FAILED if the listening socket could not be
+ *        rewatched.
+ */
+status FN_DECL_MUST_CHECK
+agent_accept_resume(
+    agent* ag);
+
+/**
+ * \brief Close a connection and release its buffers.
+ *
+ * \param ag            The \ref agent that owns this connection.
+ * \param conn          The connection to close.
+ *
+ * \note Closing a connection resumes accepting if it was paused.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status FN_DECL_MUST_CHECK
+agent_connection_close(
+    agent* ag, agent_connection* conn);
+
+/**
+ * \brief Read every available byte from a connection, and answer each complete
+ * request frame.
+ *
+ * \param ag            The \ref agent that owns this connection.
+ * \param conn          The connection to read.
+ *
+ * \note When the peer shuts down its side of the connection, the complete
+ * frames already read are still answered and \p conn is marked as at EOF, so
+ * that it is closed once its output is written.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_AGENT_IO_FAILED if a read failed.
+ *      - ERROR_AGENT_BAD_FRAME if a frame is too large.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ */
+status FN_DECL_MUST_CHECK
+agent_connection_read(
+    agent* ag, agent_connection* conn);
+
+/**
+ * \brief Write as much of the pending output of a connection as possible.
+ *
+ * \param ag            The \ref agent that owns this connection.
+ * \param conn          The connection to write.
+ *
+ * \note A connection is only watched for writability while it has output that
+ * could not be written immediately.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_AGENT_IO_FAILED if a write failed.
+ *      - ERROR_AGENT_EPOLL_FAILED if the connection could not be rewatched.
+ */
+status FN_DECL_MUST_CHECK
+agent_connection_flush(
+    agent* ag, agent_connection* conn);
+
+/**
+ * \brief Answer one request payload, appending the response frame to the
+ * output of a connection.
+ *
+ * \param ag            The \ref agent for this operation.
+ * \param out           The output buffer of the connection.
+ * \param payload       The request payload.
+ * \param size          The size of the request payload.
+ *
+ * \note A malformed request is answered with a response whose status is the
+ * error, rather than failing the connection.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ */
+status FN_DECL_MUST_CHECK
+agent_dispatch(
+    agent* ag, secure_buffer_builder* out, const uint8_t* payload,
+    size_t size);
+
+/* C++ compatibility. */
+/**
+ * \brief Append a response entry made of the given pieces.
+ *
+ * \param out           The output buffer.
+ * \param entry_status  The status of this entry.
+ * \param iov           The pieces of the entry data.
+ * \param iovcnt        The number of pieces.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+agent_response_entry_append(
+    secure_buffer_builder* out, status entry_status, const struct iovec* iov,
+    size_t iovcnt);
+
+/**
+ * \brief Split a request payload into its entries.
+ *
+ * \param entries       The entries to fill.
+ * \param count         The number of entries.
+ * \param bptr          The first entry of the payload.
+ * \param size          The size of the entries of the payload.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_AGENT_BAD_FRAME if the entries do not exactly fill the payload.
+ */
+status FN_DECL_MUST_CHECK
+agent_request_entries_read(
+    agent_dispatch_entry* entries, size_t count, const uint8_t* bptr,
+    size_t size);
+
+/**
+ * \brief Look up the record of every entry.
+ *
+ * \param ag            The \ref agent for this operation.
+ * \param entries       The entries.
+ * \param count         The number of entries.
+ *
+ * \note The entries are looked up in chunks with \ref store_lookup_batch, so
+ * that the cache misses of a large request overlap.
+ */
+void
+agent_lookup_entries(
+    agent* ag, agent_dispatch_entry* entries, size_t count);
+
+/**
+ * \brief Derive the password of every entry that has a record.
+ *
+ * \param ag            The \ref agent for this operation.
+ * \param entries       The entries.
+ * \param count         The number of entries.
+ *
+ * \note Each record is checked with \ref derive_password_check first, so an
+ * invalid record only fails its own entry. The rest are derived as one batch
+ * on several threads; if the batch still fails, for instance because the KDF
+ * failed, every entry in it fails with the status of the batch.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ */
+status FN_DECL_MUST_CHECK
+agent_derive_entries(
+    agent* ag, agent_dispatch_entry* entries, size_t count);
+
+/**
+ * \brief Append the entries of a response.
+ *
+ * \param out           The output buffer.
+ * \param op            The op of the request.
+ * \param entries       The entries.
+ * \param count         The number of entries.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+agent_response_entries_append(
+    secure_buffer_builder* out, uint8_t op, agent_dispatch_entry* entries,
+    size_t count);
+
+/**
+ * \brief Set up a newly accepted connection.
+ *
+ * \param ag            The \ref agent for this operation.
+ * \param fd            The accepted socket, which is closed on failure.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_AGENT_EPOLL_FAILED if the connection could not be watched.
+ */
+status FN_DECL_MUST_CHECK
+agent_connection_add(
+    agent* ag, int fd);
+
+/**
+ * \brief Answer every complete request frame in the input of a connection.
+ *
+ * \param ag            The \ref agent that owns this connection.
+ * \param conn          The connection.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_AGENT_BAD_FRAME if a frame is too large.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ */
+status FN_DECL_MUST_CHECK
+agent_connection_answer(
+    agent* ag, agent_connection* conn);
+
+/**
+ * \brief Read exactly the given number of bytes.
+ *
+ * \param fd            The socket to read.
+ * \param data          The buffer to read into.
+ * \param size          The number of bytes to read.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_AGENT_IO_FAILED if the read failed or the agent disconnected.
+ */
+status FN_DECL_MUST_CHECK
+agent_read_all(
+    int fd, void* data, size_t size);
+
+/**
+ * \brief Write one request frame.
+ *
+ * \param alloc         The allocator to use for the iovec array.
+ * \param fd            The socket to write.
+ * \param op            The AGENT_OP_ value of this request.
+ * \param hash_ids      Array of \p count hash ids.
+ * \param hash_id_sizes Array of \p count hash id sizes.
+ * \param count         The number of hash ids.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+agent_request_write(
+    RCPR_SYM(allocator)* alloc, int fd, uint8_t op,
+    const void* const* hash_ids, const size_t* hash_id_sizes, size_t count);
+
+/**
+ * \brief Handle the events for one connection.
+ *
+ * \param ag            The \ref agent that owns this connection.
+ * \param conn          The connection.
+ * \param events        The epoll events for this connection.
+ *
+ * \note A connection that fails for any reason is closed; this never stops the
+ * agent. A connection at EOF is closed once all of its output is written.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code if a failed connection could not be closed.
+ */
+status FN_DECL_MUST_CHECK
+agent_connection_handle(
+    agent* ag, agent_connection* conn, uint32_t events);
+
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
@@ -0,0 +1,54 @@
+/**
+ * \file agent/agent_lookup_entries.c
+ *
+ * \brief Look up the records of an \ref agent request.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+
+#include "agent_internal.h"
+
+/**
+ * \brief Look up the record of every entry.
+ *
+ * \param ag            The \ref agent for this operation.
+ * \param entries       The entries.
+ * \param count         The number of entries.
+ *
+ * \note The entries are looked up in chunks with \ref store_lookup_batch, so
+ * that the cache misses of a large request overlap.
+ */
+void
+agent_lookup_entries(
+    agent* ag, agent_dispatch_entry* entries, size_t count)
+{
+    const void* hash_ids[AGENT_LOOKUP_CHUNK];
+    size_t hash_id_sizes[AGENT_LOOKUP_CHUNK];
+    const metadata* records[AGENT_LOOKUP_CHUNK];
+
+    for (size_t begin = 0; begin < count; begin += AGENT_LOOKUP_CHUNK)
+    {
+        size_t chunk =
+            (count - begin < AGENT_LOOKUP_CHUNK)
+                ? count - begin : AGENT_LOOKUP_CHUNK;
+
+        for (size_t i = 0; i < chunk; ++i)
+        {
+            hash_ids[i] = entries[begin + i].hash_id;
+            hash_id_sizes[i] = entries[begin + i].hash_id_size;
+        }
+
+        store_lookup_batch(records, ag->vault, hash_ids, hash_id_sizes, chunk);
+
+        for (size_t i = 0; i < chunk; ++i)
+        {
+            entries[begin + i].record = records[i];
+            entries[begin + i].retval =
+                (NULL != records[i])
+                    ? STATUS_SUCCESS : ERROR_STORE_RECORD_NOT_FOUND;
+        }
+    }
+}
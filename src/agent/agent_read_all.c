@@ -0,0 +1,50 @@
+/**
+ * \file agent/agent_read_all.c
+ *
+ * \brief Read an exact number of bytes from an \ref agent socket.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <errno.h>
+#include <nepe2/error_codes.h>
+#include <unistd.h>
+
+#include "agent_internal.h"
+
+/**
+ * \brief Read exactly the given number of bytes.
+ *
+ * \param fd            The socket to read.
+ * \param data          The buffer to read into.
+ * \param size          The number of bytes to read.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_AGENT_IO_FAILED if the read failed or the agent disconnected.
+ */
+status FN_DECL_MUST_CHECK
+agent_read_all(
+    int fd, void* data, size_t size)
+{
+    uint8_t* bptr = (uint8_t*)data;
+
+    while (size > 0)
+    {
+        ssize_t bytes = read(fd, bptr, size);
+        if (bytes < 0 && EINTR == errno)
+        {
+            continue;
+        }
+        else if (bytes <= 0)
+        {
+            return ERROR_AGENT_IO_FAILED;
+        }
+
+        bptr += bytes;
+        size -= (size_t)bytes;
+    }
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,109 @@
+/**
+ * \file agent/agent_request.c
+ *
+ * \brief Send a batched request to an \ref agent.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <errno.h>
+#include <nepe2/error_codes.h>
+#include <rcpr/socket_utilities.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "agent_internal.h"
+
+RCPR_IMPORT_resource;
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Send a batched request to an agent and read its response.
+ *
+ * \param response      Pointer to receive the response payload on success.
+ * \param alloc         The allocator to use for the response.
+ * \param fd            A socket connected with \ref agent_connect.
+ * \param op            The AGENT_OP_ value of this request.
+ * \param hash_ids      Array of \p count hash ids.
+ * \param hash_id_sizes Array of \p count hash id sizes.
+ * \param count         The number of hash ids.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_AGENT_IO_FAILED if the request could not be written or the
+ *        response could not be read.
+ *      - ERROR_AGENT_BAD_FRAME if the request or response is too large.
+ *      - the status of the response, if the agent rejected the request.
+ */
+status FN_DECL_MUST_CHECK
+agent_request(
+    secure_buffer** response, RCPR_SYM(allocator)* alloc, int fd, uint8_t op,
+    const void* const* hash_ids, const size_t* hash_id_sizes, size_t count)
+{
+    status retval, release_retval;
+    secure_buffer* tmp = NULL;
+    uint32_t net_value;
+    size_t size;
+
+    /* send the request. */
+    retval =
+        agent_request_write(alloc, fd, op, hash_ids, hash_id_sizes, count);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* read the response size. */
+    retval = agent_read_all(fd, &net_value, sizeof(net_value));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    size_t payload_size = socket_utility_ntoh32(net_value);
+    if (payload_size < AGENT_RESPONSE_HEADER_SIZE
+     || payload_size > AGENT_FRAME_MAX)
+    {
+        retval = ERROR_AGENT_BAD_FRAME;
+        goto done;
+    }
+
+    /* read the response payload. */
+    retval = secure_buffer_create(&tmp, alloc, payload_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    uint8_t* data = (uint8_t*)secure_buffer_data(&size, tmp);
+    retval = agent_read_all(fd, data, size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    /* check the status of the request as a whole. */
+    memcpy(&net_value, data, sizeof(net_value));
+    retval = (status)socket_utility_ntoh32(net_value);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    /* success. */
+    *response = tmp;
+    goto done;
+
+cleanup_tmp:
+    release_retval = resource_release(secure_buffer_resource_handle(tmp));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
@@ -0,0 +1,53 @@
+/**
+ * \file agent/agent_request_entries_read.c
+ *
+ * \brief Split an \ref agent request payload into its entries.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+
+#include "agent_internal.h"
+
+/**
+ * \brief Split a request payload into its entries.
+ *
+ * \param entries       The entries to fill.
+ * \param count         The number of entries.
+ * \param bptr          The first entry of the payload.
+ * \param size          The size of the entries of the payload.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_AGENT_BAD_FRAME if the entries do not exactly fill the payload.
+ */
+status FN_DECL_MUST_CHECK
+agent_request_entries_read(
+    agent_dispatch_entry* entries, size_t count, const uint8_t* bptr,
+    size_t size)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (size < sizeof(uint32_t))
+        {
+            return ERROR_AGENT_BAD_FRAME;
+        }
+
+        size_t hash_id_size = agent_get_u32(bptr);
+        bptr += sizeof(uint32_t);
+        size -= sizeof(uint32_t);
+        if (size < hash_id_size)
+        {
+            return ERROR_AGENT_BAD_FRAME;
+        }
+
+        entries[i].hash_id = bptr;
+        entries[i].hash_id_size = hash_id_size;
+        bptr += hash_id_size;
+        size -= hash_id_size;
+    }
+
+    return (0 == size) ? STATUS_SUCCESS : ERROR_AGENT_BAD_FRAME;
+}
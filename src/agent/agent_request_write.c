@@ -0,0 +1,101 @@
+/**
+ * \file agent/agent_request_write.c
+ *
+ * \brief Write an \ref agent request frame.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <rcpr/socket_utilities.h>
+#include <string.h>
+
+#include "agent_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Write one request frame.
+ *
+ * \param alloc         The allocator to use for the iovec array.
+ * \param fd            The socket to write.
+ * \param op            The AGENT_OP_ value of this request.
+ * \param hash_ids      Array of \p count hash ids.
+ * \param hash_id_sizes Array of \p count hash id sizes.
+ * \param count         The number of hash ids.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+agent_request_write(
+    RCPR_SYM(allocator)* alloc, int fd, uint8_t op,
+    const void* const* hash_ids, const size_t* hash_id_sizes, size_t count)
+{
+    status retval, release_retval;
+    uint8_t header[AGENT_FRAME_PREFIX_SIZE + AGENT_REQUEST_HEADER_SIZE];
+    struct iovec* iov = NULL;
+    uint32_t net_value;
+
+    /* compute and check the payload size. */
+    size_t payload_size = AGENT_REQUEST_HEADER_SIZE;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (hash_id_sizes[i] > AGENT_FRAME_MAX
+         || payload_size + sizeof(uint32_t) + hash_id_sizes[i]
+                > AGENT_FRAME_MAX)
+        {
+            return ERROR_AGENT_BAD_FRAME;
+        }
+
+        payload_size += sizeof(uint32_t) + hash_id_sizes[i];
+    }
+
+    /* one entry for the header, and two for each hash id. */
+    size_t iovcnt = 1 + 2 * count;
+    retval =
+        allocator_allocate(
+            alloc, (void**)&iov,
+            iovcnt * sizeof(*iov) + count * sizeof(uint32_t));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* the hash id sizes are stored after the iovec array. */
+    uint8_t* sizes = (uint8_t*)(iov + iovcnt);
+
+    /* build the frame header. */
+    net_value = socket_utility_hton32(payload_size); /* shortening cast. */
+    memcpy(header, &net_value, sizeof(net_value));
+    header[AGENT_FRAME_PREFIX_SIZE] = op;
+    net_value = socket_utility_hton32(count); /* shortening cast. */
+    memcpy(header + AGENT_FRAME_PREFIX_SIZE + 1, &net_value, sizeof(net_value));
+    iov[0].iov_base = header;
+    iov[0].iov_len = sizeof(header);
+
+    /* the hash ids are written from the caller's storage. */
+    for (size_t i = 0; i < count; ++i)
+    {
+        net_value = socket_utility_hton32(hash_id_sizes[i]);
+        memcpy(sizes + i * sizeof(uint32_t), &net_value, sizeof(net_value));
+        iov[1 + 2 * i].iov_base = sizes + i * sizeof(uint32_t);
+        iov[1 + 2 * i].iov_len = sizeof(uint32_t);
+        iov[2 + 2 * i].iov_base = (void*)hash_ids[i];
+        iov[2 + 2 * i].iov_len = hash_id_sizes[i];
+    }
+
+    if (STATUS_SUCCESS != metadata_iovec_write(fd, iov, iovcnt))
+    {
+        retval = ERROR_AGENT_IO_FAILED;
+    }
+
+    release_retval = allocator_reclaim(alloc, iov);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
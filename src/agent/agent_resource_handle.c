@@ -0,0 +1,26 @@
+/**
+ * \file agent/agent_resource_handle.c
+ *
+ * \brief Get the resource handle for an \ref agent.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "agent_internal.h"
+
+/**
+ * \brief Given a \ref agent instance, return the resource handle for this
+ * \ref agent instance.
+ *
+ * \param ag            The \ref agent instance from which the resource handle
+ *                      is returned.
+ *
+ * \returns the resource handle for this \ref agent instance.
+ */
+RCPR_SYM(resource)*
+agent_resource_handle(
+    agent* ag)
+{
+    return &ag->hdr;
+}
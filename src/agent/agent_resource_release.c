@@ -0,0 +1,81 @@
+/**
+ * \file agent/agent_resource_release.c
+ *
+ * \brief Release an \ref agent resource.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+#include <unistd.h>
+
+#include "agent_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Release an \ref agent resource.
+ *
+ * \param r             Pointer to the \ref agent resource to be released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status agent_resource_release(RCPR_SYM(resource)* r)
+{
+    status retval = STATUS_SUCCESS;
+    status release_retval;
+
+    agent* ag = (agent*)r;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_agent_valid(ag));
+
+    /* cache allocator. */
+    allocator* alloc = ag->alloc;
+
+    /* close every connection. */
+    while (NULL != ag->connections)
+    {
+        release_retval = agent_connection_close(ag, ag->connections);
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    /* close the event loop, and remove the socket. */
+    close(ag->stop_fd);
+    close(ag->epoll_fd);
+    close(ag->listen_fd);
+    unlink(ag->addr.sun_path);
+
+    /* release the vault. */
+    release_retval = resource_release(store_resource_handle(ag->vault));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    /* release the derivation state, which erases the master passphrase. */
+    release_retval = resource_release(derive_context_resource_handle(ag->ctx));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(ag, 0, sizeof(*ag)));
+
+    /* reclaim memory. */
+    release_retval = allocator_reclaim(alloc, ag);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
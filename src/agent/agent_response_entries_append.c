@@ -0,0 +1,69 @@
+/**
+ * \file agent/agent_response_entries_append.c
+ *
+ * \brief Append the entries of an \ref agent response.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "agent_internal.h"
+
+/**
+ * \brief Append the entries of a response.
+ *
+ * \param out           The output buffer.
+ * \param op            The op of the request.
+ * \param entries       The entries.
+ * \param count         The number of entries.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+agent_response_entries_append(
+    secure_buffer_builder* out, uint8_t op, agent_dispatch_entry* entries,
+    size_t count)
+{
+    status retval = STATUS_SUCCESS;
+    struct iovec iov[METADATA_IOVEC_COUNT];
+    uint8_t scratch[METADATA_IOVEC_SCRATCH_SIZE];
+    size_t iovcnt, size;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        iovcnt = 0;
+        if (STATUS_SUCCESS != entries[i].retval)
+        {
+            /* a failed entry has no data. */
+        }
+        else if (AGENT_OP_LOOKUP == op)
+        {
+            /* copy the record straight from the vault. */
+            entries[i].retval =
+                metadata_to_iovec(iov, scratch, &size, entries[i].record);
+            if (STATUS_SUCCESS == entries[i].retval)
+            {
+                iovcnt = METADATA_IOVEC_COUNT;
+            }
+        }
+        else
+        {
+            iov[0].iov_base =
+                secure_buffer_data(&iov[0].iov_len, entries[i].password);
+            iovcnt = 1;
+        }
+
+        retval =
+            agent_response_entry_append(out, entries[i].retval, iov, iovcnt);
+        if (STATUS_SUCCESS != retval)
+        {
+            break;
+        }
+    }
+
+    RCPR_MODEL_EXEMPT(memset(scratch, 0, sizeof(scratch)));
+
+    return retval;
+}
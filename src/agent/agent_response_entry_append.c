@@ -0,0 +1,59 @@
+/**
+ * \file agent/agent_response_entry_append.c
+ *
+ * \brief Append one entry to an \ref agent response.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "agent_internal.h"
+
+/**
+ * \brief Append a response entry made of the given pieces.
+ *
+ * \param out           The output buffer.
+ * \param entry_status  The status of this entry.
+ * \param iov           The pieces of the entry data.
+ * \param iovcnt        The number of pieces.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+agent_response_entry_append(
+    secure_buffer_builder* out, status entry_status, const struct iovec* iov,
+    size_t iovcnt)
+{
+    status retval;
+    void* region;
+    size_t size = 0U;
+
+    for (size_t i = 0; i < iovcnt; ++i)
+    {
+        size += iov[i].iov_len;
+    }
+
+    retval =
+        secure_buffer_builder_extend(
+            &region, out, AGENT_RESPONSE_ENTRY_HEADER_SIZE);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    uint8_t* bptr = agent_put_u32((uint8_t*)region, entry_status);
+    agent_put_u32(bptr, size); /* shortening cast. */
+
+    for (size_t i = 0; i < iovcnt; ++i)
+    {
+        retval =
+            secure_buffer_builder_append(
+                out, iov[i].iov_base, iov[i].iov_len);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
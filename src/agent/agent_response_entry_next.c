@@ -0,0 +1,69 @@
+/**
+ * \file agent/agent_response_entry_next.c
+ *
+ * \brief Read the next entry of an \ref agent response.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <rcpr/socket_utilities.h>
+#include <string.h>
+
+#include "agent_internal.h"
+
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Read the next entry of a response payload.
+ *
+ * \param entry_status  Pointer to receive the status of this entry.
+ * \param data          Pointer to receive the data of this entry, which is
+ *                      owned by \p response.
+ * \param size          Pointer to receive the size of this entry.
+ * \param offset        The read position, which must be zero for the first
+ *                      entry and is advanced past this entry on success.
+ * \param response      The response payload from \ref agent_request.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_AGENT_BAD_FRAME if there are no more entries, or the response
+ *        is malformed.
+ */
+status FN_DECL_MUST_CHECK
+agent_response_entry_next(
+    status* entry_status, const void** data, size_t* size, size_t* offset,
+    secure_buffer* response)
+{
+    size_t response_size;
+    uint32_t net_status, net_size;
+
+    const uint8_t* bptr =
+        (const uint8_t*)secure_buffer_data(&response_size, response);
+
+    /* the first entry follows the response header. */
+    size_t pos = (0 == *offset) ? AGENT_RESPONSE_HEADER_SIZE : *offset;
+    if (pos > response_size
+     || response_size - pos < AGENT_RESPONSE_ENTRY_HEADER_SIZE)
+    {
+        return ERROR_AGENT_BAD_FRAME;
+    }
+
+    memcpy(&net_status, bptr + pos, sizeof(net_status));
+    memcpy(&net_size, bptr + pos + sizeof(net_status), sizeof(net_size));
+    pos += AGENT_RESPONSE_ENTRY_HEADER_SIZE;
+
+    size_t entry_size = socket_utility_ntoh32(net_size);
+    if (response_size - pos < entry_size)
+    {
+        return ERROR_AGENT_BAD_FRAME;
+    }
+
+    *entry_status = (status)socket_utility_ntoh32(net_status);
+    *data = bptr + pos;
+    *size = entry_size;
+    *offset = pos + entry_size;
+
+    return STATUS_SUCCESS;
+}
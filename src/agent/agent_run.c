@@ -0,0 +1,98 @@
+/**
+ * \file agent/agent_run.c
+ *
+ * \brief Run the event loop of an \ref agent.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <errno.h>
+#include <nepe2/error_codes.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "agent_internal.h"
+
+/**
+ * \brief Run the event loop of an agent until it is stopped.
+ *
+ * \param ag            The \ref agent for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS when the agent is stopped.
+ *      - ERROR_AGENT_EPOLL_FAILED if waiting for events failed.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ */
+status FN_DECL_MUST_CHECK
+agent_run(
+    agent* ag)
+{
+    status retval;
+    struct epoll_event events[AGENT_EVENT_COUNT];
+    eventfd_t value;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_agent_valid(ag));
+
+    ag->stopped = false;
+    while (!ag->stopped)
+    {
+        /* while accepting is paused, wake up to retry it. */
+        int count =
+            epoll_wait(
+                ag->epoll_fd, events, AGENT_EVENT_COUNT,
+                ag->accept_paused ? AGENT_ACCEPT_RETRY_MSEC : -1);
+        if (count < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            return ERROR_AGENT_EPOLL_FAILED;
+        }
+        else if (0 == count)
+        {
+            retval = agent_accept_resume(ag);
+            if (STATUS_SUCCESS != retval)
+            {
+                return retval;
+            }
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            if (&ag->stop_fd == events[i].data.ptr)
+            {
+                /* consume the stop event. */
+                if (0 != eventfd_read(ag->stop_fd, &value))
+                {
+                    return ERROR_AGENT_EPOLL_FAILED;
+                }
+
+                ag->stopped = true;
+                retval = STATUS_SUCCESS;
+            }
+            else if (&ag->listen_fd == events[i].data.ptr)
+            {
+                retval = agent_accept(ag);
+            }
+            else
+            {
+                retval =
+                    agent_connection_handle(
+                        ag, (agent_connection*)events[i].data.ptr,
+                        events[i].events);
+            }
+
+            if (STATUS_SUCCESS != retval)
+            {
+                return retval;
+            }
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
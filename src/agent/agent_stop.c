@@ -0,0 +1,35 @@
+/**
+ * \file agent/agent_stop.c
+ *
+ * \brief Stop the event loop of an \ref agent.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <sys/eventfd.h>
+
+#include "agent_internal.h"
+
+/**
+ * \brief Stop the event loop of an agent.
+ *
+ * \param ag            The \ref agent for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_AGENT_EPOLL_FAILED if the event loop could not be woken.
+ */
+status FN_DECL_MUST_CHECK
+agent_stop(
+    agent* ag)
+{
+    /* eventfd_write is a single write, so this is async-signal-safe. */
+    if (0 != eventfd_write(ag->stop_fd, 1))
+    {
+        return ERROR_AGENT_EPOLL_FAILED;
+    }
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,42 @@
+/**
+ * \file column_snapshot/column_snapshot_bitmap_count.c
+ *
+ * \brief Count the selected rows of a selection bitmap.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "column_snapshot_internal.h"
+
+/**
+ * \brief Count the selected rows of a selection bitmap.
+ *
+ * \param bitmap        The selection bitmap.
+ * \param rows          The number of rows covered by the bitmap.
+ *
+ * \returns the number of set bits for the first \p rows rows.
+ */
+size_t
+column_snapshot_bitmap_count(
+    const uint64_t* bitmap, size_t rows)
+{
+    size_t count = 0;
+    size_t words = rows / COLUMN_SNAPSHOT_WORD_ROWS;
+    size_t tail = rows % COLUMN_SNAPSHOT_WORD_ROWS;
+
+    for (size_t i = 0; i < words; ++i)
+    {
+        count += (size_t)__builtin_popcountll(bitmap[i]);
+    }
+
+    /* ignore any bits past the last row. */
+    if (tail > 0)
+    {
+        count +=
+            (size_t)__builtin_popcountll(
+                bitmap[words] & ((UINT64_C(1) << tail) - 1));
+    }
+
+    return count;
+}
@@ -0,0 +1,87 @@
+/**
+ * \file column_snapshot/column_snapshot_column_get.c
+ *
+ * \brief Get the column of a column snapshot that holds a field.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+
+#include "column_snapshot_internal.h"
+
+/**
+ * \brief Get the column of a \ref column_snapshot that holds a field.
+ *
+ * \param column        Pointer to receive the column on success.
+ * \param width         Pointer to receive the width of the column in bytes on
+ *                      success.
+ * \param snap          The \ref column_snapshot instance for this operation.
+ * \param field         The COLUMN_SNAPSHOT_FIELD_ value.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_COLUMN_SNAPSHOT_INVALID_FIELD if \p field is not a valid field.
+ */
+status FN_DECL_MUST_CHECK
+column_snapshot_column_get(
+    const void** column, size_t* width, const column_snapshot* snap,
+    uint32_t field)
+{
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_column_snapshot_valid(snap));
+
+    switch (field)
+    {
+        case COLUMN_SNAPSHOT_FIELD_VERSION:
+            *column = snap->version;
+            *width = sizeof(*snap->version);
+            break;
+
+        case COLUMN_SNAPSHOT_FIELD_CREATION_DATE:
+            *column = snap->creation_date;
+            *width = sizeof(*snap->creation_date);
+            break;
+
+        case COLUMN_SNAPSHOT_FIELD_REVOCATION_DATE:
+            *column = snap->revocation_date;
+            *width = sizeof(*snap->revocation_date);
+            break;
+
+        case COLUMN_SNAPSHOT_FIELD_EXPIRATION_DATE:
+            *column = snap->expiration_date;
+            *width = sizeof(*snap->expiration_date);
+            break;
+
+        case COLUMN_SNAPSHOT_FIELD_PASSWORD_LENGTH:
+            *column = snap->password_length;
+            *width = sizeof(*snap->password_length);
+            break;
+
+        case COLUMN_SNAPSHOT_FIELD_GENERATION:
+            *column = snap->generation;
+            *width = sizeof(*snap->generation);
+            break;
+
+        case COLUMN_SNAPSHOT_FIELD_LEGACY:
+            *column = snap->legacy;
+            *width = sizeof(*snap->legacy);
+            break;
+
+        case COLUMN_SNAPSHOT_FIELD_KDF:
+            *column = snap->kdf;
+            *width = sizeof(*snap->kdf);
+            break;
+
+        case COLUMN_SNAPSHOT_FIELD_ALPHABET:
+            *column = snap->alphabet;
+            *width = sizeof(*snap->alphabet);
+            break;
+
+        default:
+            return ERROR_COLUMN_SNAPSHOT_INVALID_FIELD;
+    }
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,65 @@
+/**
+ * \file column_snapshot/column_snapshot_columns_allocate.c
+ *
+ * \brief Allocate the columns of a \ref column_snapshot.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "column_snapshot_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Allocate and clear the columns of a snapshot.
+ *
+ * \param snap          The snapshot, with its row capacity set.
+ *
+ * \note The rows past the row count are left zeroed.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status FN_DECL_MUST_CHECK
+column_snapshot_columns_allocate(
+    column_snapshot* snap)
+{
+    status retval;
+    size_t rows = snap->row_capacity;
+
+    struct
+    {
+        void** column;
+        size_t width;
+    } columns[] = {
+        { (void**)&snap->creation_date, sizeof(*snap->creation_date) },
+        { (void**)&snap->revocation_date, sizeof(*snap->revocation_date) },
+        { (void**)&snap->expiration_date, sizeof(*snap->expiration_date) },
+        { (void**)&snap->version, sizeof(*snap->version) },
+        { (void**)&snap->password_length, sizeof(*snap->password_length) },
+        { (void**)&snap->generation, sizeof(*snap->generation) },
+        { (void**)&snap->kdf, sizeof(*snap->kdf) },
+        { (void**)&snap->alphabet, sizeof(*snap->alphabet) },
+        { (void**)&snap->legacy, sizeof(*snap->legacy) },
+    };
+
+    for (size_t i = 0; i < sizeof(columns) / sizeof(columns[0]); ++i)
+    {
+        retval =
+            allocator_allocate(
+                snap->alloc, columns[i].column, rows * columns[i].width);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        RCPR_MODEL_EXEMPT(
+            memset(*columns[i].column, 0, rows * columns[i].width));
+    }
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,129 @@
+/**
+ * \file column_snapshot/column_snapshot_create.c
+ *
+ * \brief Create a column snapshot of a store.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "column_snapshot_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Create a column snapshot of every record in a \ref store.
+ *
+ * \param snap          Pointer to the column snapshot pointer to receive the
+ *                      snapshot on success.
+ * \param alloc         The allocator instance to use for this operation.
+ * \param st            The store to snapshot.
+ *
+ * \note This column snapshot is a \ref resource that must be released by
+ * calling \ref resource_release on its resource handle when it is no longer
+ * needed by the caller. The resource handle can be accessed by calling
+ * \ref column_snapshot_resource_handle on this snapshot instance. The snapshot
+ * holds copies of the fields it needs, so it does not refer to \p st after it
+ * is created.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_COLUMN_SNAPSHOT_TOO_MANY_NAMES if the store has more distinct
+ *        kdf names or encodings than a 16-bit id can hold.
+ *      - an error from the \ref metadata getters if a record is incomplete.
+ *
+ * \pre
+ *      - \p snap must not reference a valid \ref column_snapshot instance and
+ *        must not be NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ *      - \p st must reference a valid \ref store instance.
+ * \post
+ *      - On success, \p snap is set to a pointer to a valid
+ *        \ref column_snapshot instance, which is a \ref resource owned by the
+ *        caller that must be released when no longer needed.
+ *      - On failure, \p snap is not changed and an error status is returned.
+ */
+status FN_DECL_MUST_CHECK
+column_snapshot_create(
+    column_snapshot** snap, RCPR_SYM(allocator)* alloc, const store* st)
+{
+    status retval, release_retval;
+    column_snapshot* tmp = NULL;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != snap);
+    RCPR_MODEL_ASSERT(prop_allocator_valid(alloc));
+    RCPR_MODEL_ASSERT(prop_store_valid(st));
+
+    /* allocate memory for the column snapshot instance. */
+    retval = allocator_allocate(alloc, (void**)&tmp, sizeof(*tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(tmp, 0, sizeof(*tmp)));
+
+    /* the tag is not set by default. */
+    RCPR_MODEL_ONLY(tmp->RCPR_MODEL_STRUCT_TAG_REF(column_snapshot) = 0);
+    RCPR_MODEL_ASSERT_STRUCT_TAG_NOT_INITIALIZED(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(column_snapshot), column_snapshot);
+
+    /* set the tag. */
+    RCPR_MODEL_STRUCT_TAG_INIT(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(column_snapshot), column_snapshot);
+
+    /* initialize resource. From here on, releasing tmp cleans up whatever has
+     * been built so far. */
+    resource_init(&tmp->hdr, &column_snapshot_resource_release);
+    tmp->alloc = alloc;
+    tmp->row_count = store_record_count_get(st);
+
+    /* round the columns up to whole bitmap words, so that scans never need a
+     * partial load. */
+    tmp->row_capacity =
+        COLUMN_SNAPSHOT_BITMAP_WORDS(tmp->row_count)
+            * COLUMN_SNAPSHOT_WORD_ROWS;
+    if (0 == tmp->row_capacity)
+    {
+        tmp->row_capacity = COLUMN_SNAPSHOT_WORD_ROWS;
+    }
+
+    /* allocate the columns. */
+    retval = column_snapshot_columns_allocate(tmp);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    /* copy each record into its row. */
+    for (size_t i = 0; i < tmp->row_count; ++i)
+    {
+        retval = column_snapshot_row_load(tmp, i, store_record_get(st, i));
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_tmp;
+        }
+    }
+
+    /* success. */
+    *snap = tmp;
+    retval = STATUS_SUCCESS;
+    goto done;
+
+cleanup_tmp:
+    release_retval = resource_release(&tmp->hdr);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
@@ -0,0 +1,120 @@
+/**
+ * \file column_snapshot/column_snapshot_dictionary_add.c
+ *
+ * \brief Add a name to a \ref column_snapshot dictionary.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <string.h>
+
+#include "column_snapshot_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Get the id of a name in a dictionary, adding the name if it is new.
+ *
+ * \param id            Pointer to receive the id of the name on success.
+ * \param alloc         The allocator that owns the dictionary memory.
+ * \param dict          The dictionary.
+ * \param name          The ASCII zero terminated name.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_COLUMN_SNAPSHOT_TOO_MANY_NAMES if the dictionary is full.
+ *      - an error code on failure.
+ */
+status FN_DECL_MUST_CHECK
+column_snapshot_dictionary_add(
+    uint16_t* id, RCPR_SYM(allocator)* alloc, column_snapshot_dictionary* dict,
+    const char* name)
+{
+    status retval;
+    uint32_t found;
+    size_t name_size = strlen(name) + 1;
+    char** names;
+    char* copy;
+    size_t capacity;
+
+    /* most rows repeat a name that is already known. */
+    if (STATUS_SUCCESS
+            == column_snapshot_dictionary_find(&found, dict, name))
+    {
+        *id = (uint16_t)found;
+        return STATUS_SUCCESS;
+    }
+
+    if (dict->count == COLUMN_SNAPSHOT_DICTIONARY_MAX)
+    {
+        return ERROR_COLUMN_SNAPSHOT_TOO_MANY_NAMES;
+    }
+
+    /* keep the slot table at most half full. */
+    if (2 * (dict->count + 1) > dict->slot_mask + 1 || NULL == dict->slots)
+    {
+        retval =
+            column_snapshot_dictionary_rehash(
+                alloc, dict,
+                (NULL == dict->slots)
+                    ? COLUMN_SNAPSHOT_DICTIONARY_SLOTS
+                    : 2 * (dict->slot_mask + 1));
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    /* grow the name array if needed. */
+    if (dict->count == dict->capacity)
+    {
+        capacity = (0 == dict->capacity) ? 4 : 2 * dict->capacity;
+
+        if (NULL == dict->names)
+        {
+            retval =
+                allocator_allocate(
+                    alloc, (void**)&names, capacity * sizeof(*names));
+        }
+        else
+        {
+            names = dict->names;
+            retval =
+                allocator_reallocate(
+                    alloc, (void**)&names, capacity * sizeof(*names));
+        }
+
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        dict->names = names;
+        dict->capacity = capacity;
+    }
+
+    /* copy the name. */
+    retval = allocator_allocate(alloc, (void**)&copy, name_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    memcpy(copy, name, name_size);
+
+    /* insert it into the slot table. */
+    size_t slot = store_hash_id_hash(name, name_size - 1) & dict->slot_mask;
+    while (0 != dict->slots[slot])
+    {
+        slot = (slot + 1) & dict->slot_mask;
+    }
+
+    dict->names[dict->count] = copy;
+    dict->slots[slot] = (uint32_t)dict->count + 1;
+    *id = (uint16_t)dict->count;
+    ++dict->count;
+
+    return STATUS_SUCCESS;
+}
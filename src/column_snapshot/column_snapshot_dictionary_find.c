@@ -0,0 +1,52 @@
+/**
+ * \file column_snapshot/column_snapshot_dictionary_find.c
+ *
+ * \brief Find a name in a column snapshot dictionary.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <string.h>
+
+#include "column_snapshot_internal.h"
+
+/**
+ * \brief Find a name in a dictionary.
+ *
+ * \param id            Pointer to receive the id of the name on success.
+ * \param dict          The dictionary to search.
+ * \param name          The ASCII zero terminated name.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_COLUMN_SNAPSHOT_NAME_NOT_FOUND if the name is not in the
+ *        dictionary.
+ */
+status FN_DECL_MUST_CHECK
+column_snapshot_dictionary_find(
+    uint32_t* id, const column_snapshot_dictionary* dict, const char* name)
+{
+    /* an empty dictionary has no slot table. */
+    if (NULL == dict->slots)
+    {
+        return ERROR_COLUMN_SNAPSHOT_NAME_NOT_FOUND;
+    }
+
+    /* probe until the name or an empty slot is found. */
+    size_t slot = store_hash_id_hash(name, strlen(name)) & dict->slot_mask;
+    while (0 != dict->slots[slot])
+    {
+        uint32_t candidate = dict->slots[slot] - 1;
+        if (!strcmp(dict->names[candidate], name))
+        {
+            *id = candidate;
+            return STATUS_SUCCESS;
+        }
+
+        slot = (slot + 1) & dict->slot_mask;
+    }
+
+    return ERROR_COLUMN_SNAPSHOT_NAME_NOT_FOUND;
+}
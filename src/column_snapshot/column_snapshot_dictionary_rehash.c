@@ -0,0 +1,70 @@
+/**
+ * \file column_snapshot/column_snapshot_dictionary_rehash.c
+ *
+ * \brief Grow the slot table of a \ref column_snapshot dictionary.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "column_snapshot_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Replace the slot table of a dictionary with a larger one.
+ *
+ * \param alloc         The allocator that owns the dictionary memory.
+ * \param dict          The dictionary.
+ * \param slot_count    The new number of slots, which must be a power of two.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status FN_DECL_MUST_CHECK
+column_snapshot_dictionary_rehash(
+    RCPR_SYM(allocator)* alloc, column_snapshot_dictionary* dict,
+    size_t slot_count)
+{
+    status retval;
+    uint32_t* slots;
+    size_t mask = slot_count - 1;
+
+    retval =
+        allocator_allocate(
+            alloc, (void**)&slots, slot_count * sizeof(*slots));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    RCPR_MODEL_EXEMPT(memset(slots, 0, slot_count * sizeof(*slots)));
+
+    /* reinsert every name. */
+    for (size_t i = 0; i < dict->count; ++i)
+    {
+        size_t slot =
+            store_hash_id_hash(dict->names[i], strlen(dict->names[i])) & mask;
+        while (0 != slots[slot])
+        {
+            slot = (slot + 1) & mask;
+        }
+
+        slots[slot] = (uint32_t)i + 1;
+    }
+
+    /* replace the old table. */
+    uint32_t* old_slots = dict->slots;
+    dict->slots = slots;
+    dict->slot_mask = mask;
+
+    if (NULL != old_slots)
+    {
+        return allocator_reclaim(alloc, old_slots);
+    }
+
+    return STATUS_SUCCESS;
+}
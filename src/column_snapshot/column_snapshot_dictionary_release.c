@@ -0,0 +1,62 @@
+/**
+ * \file column_snapshot/column_snapshot_dictionary_release.c
+ *
+ * \brief Release the memory of a column snapshot dictionary.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "column_snapshot_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Release the names and tables of a dictionary.
+ *
+ * \param alloc         The allocator that owns the dictionary memory.
+ * \param dict          The dictionary to release.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status
+column_snapshot_dictionary_release(
+    RCPR_SYM(allocator)* alloc, column_snapshot_dictionary* dict)
+{
+    status release_retval;
+    status retval = STATUS_SUCCESS;
+
+    /* release each name. */
+    for (size_t i = 0; i < dict->count; ++i)
+    {
+        release_retval = allocator_reclaim(alloc, dict->names[i]);
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    /* release the name array. */
+    if (NULL != dict->names)
+    {
+        release_retval = allocator_reclaim(alloc, dict->names);
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    /* release the slot table. */
+    if (NULL != dict->slots)
+    {
+        release_retval = allocator_reclaim(alloc, dict->slots);
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    return retval;
+}
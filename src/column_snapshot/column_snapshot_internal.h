@@ -0,0 +1,380 @@
+/**
+ * \file column_snapshot/column_snapshot_internal.h
+ *
+ * \brief Internal header for \ref column_snapshot.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <nepe2/column_snapshot.h>
+#include <rcpr/resource/protected.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__)
+# include <immintrin.h>
+# define COLUMN_SNAPSHOT_AVX2                                                1
+#endif
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief The number of rows compared to build one bitmap word.
+ */
+#define COLUMN_SNAPSHOT_WORD_ROWS                                           64
+
+/**
+ * \brief The largest number of distinct names in a dictionary.
+ */
+#define COLUMN_SNAPSHOT_DICTIONARY_MAX                                  0x10000
+
+/**
+ * \brief The initial number of slots in a dictionary slot table.
+ */
+#define COLUMN_SNAPSHOT_DICTIONARY_SLOTS                                    16
+
+/**
+ * \brief A dictionary of the distinct names in a string column.
+ *
+ * The names are owned copies, and the id of a name is its position in the
+ * name array. The open addressed slot table maps a name hash to its id plus
+ * one, with zero marking an empty slot.
+ */
+typedef struct column_snapshot_dictionary column_snapshot_dictionary;
+
+struct column_snapshot_dictionary
+{
+    size_t count;
+    size_t capacity;
+    char** names;
+    size_t slot_mask;
+    uint32_t* slots;
+};
+
+struct column_snapshot
+{
+    RCPR_SYM(resource) hdr;
+    RCPR_MODEL_STRUCT_TAG(column_snapshot);
+    RCPR_SYM(allocator)* alloc;
+    size_t row_count;
+    size_t row_capacity;
+    uint64_t* creation_date;
+    uint64_t* revocation_date;
+    uint64_t* expiration_date;
+    uint32_t* version;
+    uint32_t* password_length;
+    uint32_t* generation;
+    uint16_t* kdf;
+    uint16_t* alphabet;
+    uint8_t* legacy;
+    column_snapshot_dictionary kdf_names;
+    column_snapshot_dictionary alphabet_names;
+};
+
+/**
+ * \brief Release a \ref column_snapshot resource.
+ *
+ * \param r             Pointer to the \ref column_snapshot resource to be
+ *                      released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status column_snapshot_resource_release(RCPR_SYM(resource)* r);
+
+/**
+ * \brief Find a name in a dictionary.
+ *
+ * \param id            Pointer to receive the id of the name on success.
+ * \param dict          The dictionary to search.
+ * \param name          The ASCII zero terminated name.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_COLUMN_SNAPSHOT_NAME_NOT_FOUND if the name is not in the
+ *        dictionary.
+ */
+status FN_DECL_MUST_CHECK
+column_snapshot_dictionary_find(
+    uint32_t* id, const column_snapshot_dictionary* dict, const char* name);
+
+/**
+ * \brief Release the names and tables of a dictionary.
+ *
+ * \param alloc         The allocator that owns the dictionary memory.
+ * \param dict          The dictionary to release.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status
+column_snapshot_dictionary_release(
+    RCPR_SYM(allocator)* alloc, column_snapshot_dictionary* dict);
+
+/**
+ * \brief Allocate and clear the columns of a snapshot.
+ *
+ * \param snap          The snapshot, with its row capacity set.
+ *
+ * \note The rows past the row count are left zeroed.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status FN_DECL_MUST_CHECK
+column_snapshot_columns_allocate(
+    column_snapshot* snap);
+
+/**
+ * \brief Copy the fields of one record into a row of a snapshot.
+ *
+ * \param snap          The snapshot.
+ * \param row           The row to fill.
+ * \param meta          The record.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status FN_DECL_MUST_CHECK
+column_snapshot_row_load(
+    column_snapshot* snap, size_t row, const metadata* meta);
+
+/**
+ * \brief Get the id of a name in a dictionary, adding the name if it is new.
+ *
+ * \param id            Pointer to receive the id of the name on success.
+ * \param alloc         The allocator that owns the dictionary memory.
+ * \param dict          The dictionary.
+ * \param name          The ASCII zero terminated name.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_COLUMN_SNAPSHOT_TOO_MANY_NAMES if the dictionary is full.
+ *      - an error code on failure.
+ */
+status FN_DECL_MUST_CHECK
+column_snapshot_dictionary_add(
+    uint16_t* id, RCPR_SYM(allocator)* alloc, column_snapshot_dictionary* dict,
+    const char* name);
+
+/**
+ * \brief Replace the slot table of a dictionary with a larger one.
+ *
+ * \param alloc         The allocator that owns the dictionary memory.
+ * \param dict          The dictionary.
+ * \param slot_count    The new number of slots, which must be a power of two.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status FN_DECL_MUST_CHECK
+column_snapshot_dictionary_rehash(
+    RCPR_SYM(allocator)* alloc, column_snapshot_dictionary* dict,
+    size_t slot_count);
+
+/**
+ * \brief Get the column of a \ref column_snapshot that holds a field.
+ *
+ * \param column        Pointer to receive the column on success.
+ * \param width         Pointer to receive the width of the column in bytes on
+ *                      success.
+ * \param snap          The \ref column_snapshot instance for this operation.
+ * \param field         The COLUMN_SNAPSHOT_FIELD_ value.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_COLUMN_SNAPSHOT_INVALID_FIELD if \p field is not a valid field.
+ */
+status FN_DECL_MUST_CHECK
+column_snapshot_column_get(
+    const void** column, size_t* width, const column_snapshot* snap,
+    uint32_t field);
+
+/**
+ * \brief Build one bitmap word from the greater-than and equal-to masks of a
+ * group of 64 rows.
+ *
+ * \param op            The COLUMN_SNAPSHOT_OP_ value.
+ * \param gt            The rows that are greater than the value.
+ * \param eq            The rows that are equal to the value.
+ *
+ * \returns the rows that match the operator.
+ */
+static inline uint64_t
+column_snapshot_combine(
+    uint32_t op, uint64_t gt, uint64_t eq)
+{
+    switch (op)
+    {
+        case COLUMN_SNAPSHOT_OP_LT:
+            return ~(gt | eq);
+
+        case COLUMN_SNAPSHOT_OP_LE:
+            return ~gt;
+
+        case COLUMN_SNAPSHOT_OP_EQ:
+            return eq;
+
+        case COLUMN_SNAPSHOT_OP_NE:
+            return ~eq;
+
+        case COLUMN_SNAPSHOT_OP_GE:
+            return gt | eq;
+
+        default:
+            return gt;
+    }
+}
+
+/**
+ * \brief Read one row of a column.
+ *
+ * \param column        The column.
+ * \param width         The width of the column in bytes.
+ * \param row           The row to read.
+ *
+ * \returns the value of the row.
+ */
+static inline uint64_t
+column_snapshot_row_read(
+    const void* column, size_t width, size_t row)
+{
+    switch (width)
+    {
+        case sizeof(uint64_t):
+            return ((const uint64_t*)column)[row];
+
+        case sizeof(uint32_t):
+            return ((const uint32_t*)column)[row];
+
+        case sizeof(uint16_t):
+            return ((const uint16_t*)column)[row];
+
+        default:
+            return ((const uint8_t*)column)[row];
+    }
+}
+
+/**
+ * \brief Scan a column one row at a time.
+ *
+ * \param bitmap        The selection bitmap to write.
+ * \param column        The column.
+ * \param width         The width of the column in bytes.
+ * \param words         The number of bitmap words to write.
+ * \param op            The COLUMN_SNAPSHOT_OP_ value.
+ * \param value         The value to compare against.
+ *
+ * \note This is the fallback of \ref column_snapshot_scan on CPUs without
+ * AVX2. A value wider than the column compares greater than every row. The
+ * padding rows past the row count are compared as well, so their bits are not
+ * cleared.
+ */
+void
+column_snapshot_scan_scalar(
+    uint64_t* bitmap, const void* column, size_t width, size_t words,
+    uint32_t op, uint64_t value);
+
+#ifdef COLUMN_SNAPSHOT_AVX2
+/**
+ * \brief Pack two 16-bit compare results into one byte mask per row.
+ *
+ * \param lo            The compare result of the first 16 rows.
+ * \param hi            The compare result of the next 16 rows.
+ *
+ * \note The pack works within each 128-bit lane, so the 64-bit groups are put
+ * back in row order before the byte mask is taken.
+ *
+ * \returns one bit per row for the 32 rows.
+ */
+__attribute__((target("avx2")))
+static inline uint64_t
+column_snapshot_mask_16(
+    __m256i lo, __m256i hi)
+{
+    __m256i packed =
+        _mm256_permute4x64_epi64(_mm256_packs_epi16(lo, hi), 0xD8);
+
+    return (uint32_t)_mm256_movemask_epi8(packed);
+}
+
+/**
+ * \brief Scan a 64-bit column with AVX2.
+ *
+ * \param bitmap        The selection bitmap to write.
+ * \param column        The column.
+ * \param words         The number of bitmap words to write.
+ * \param op            The COLUMN_SNAPSHOT_OP_ value.
+ * \param value         The value to compare against.
+ *
+ * \note AVX2 only has signed compares, so both sides have their sign bit
+ * flipped, which orders them as unsigned values. The same holds for the
+ * narrower columns.
+ */
+__attribute__((target("avx2")))
+void
+column_snapshot_scan_avx2_64(
+    uint64_t* bitmap, const uint64_t* column, size_t words, uint32_t op,
+    uint64_t value);
+
+/**
+ * \brief Scan a 32-bit column with AVX2.
+ *
+ * \param bitmap        The selection bitmap to write.
+ * \param column        The column.
+ * \param words         The number of bitmap words to write.
+ * \param op            The COLUMN_SNAPSHOT_OP_ value.
+ * \param value         The value to compare against.
+ */
+__attribute__((target("avx2")))
+void
+column_snapshot_scan_avx2_32(
+    uint64_t* bitmap, const uint32_t* column, size_t words, uint32_t op,
+    uint32_t value);
+
+/**
+ * \brief Scan a 16-bit column with AVX2.
+ *
+ * \param bitmap        The selection bitmap to write.
+ * \param column        The column.
+ * \param words         The number of bitmap words to write.
+ * \param op            The COLUMN_SNAPSHOT_OP_ value.
+ * \param value         The value to compare against.
+ */
+__attribute__((target("avx2")))
+void
+column_snapshot_scan_avx2_16(
+    uint64_t* bitmap, const uint16_t* column, size_t words, uint32_t op,
+    uint16_t value);
+
+/**
+ * \brief Scan an 8-bit column with AVX2.
+ *
+ * \param bitmap        The selection bitmap to write.
+ * \param column        The column.
+ * \param words         The number of bitmap words to write.
+ * \param op            The COLUMN_SNAPSHOT_OP_ value.
+ * \param value         The value to compare against.
+ */
+__attribute__((target("avx2")))
+void
+column_snapshot_scan_avx2_8(
+    uint64_t* bitmap, const uint8_t* column, size_t words, uint32_t op,
+    uint8_t value);
+#endif
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
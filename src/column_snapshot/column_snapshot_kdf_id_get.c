@@ -0,0 +1,33 @@
+/**
+ * \file column_snapshot/column_snapshot_kdf_id_get.c
+ *
+ * \brief Get the id of a kdf name in a column snapshot.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "column_snapshot_internal.h"
+
+/**
+ * \brief Get the id of a kdf name in a \ref column_snapshot.
+ *
+ * \param id            Pointer to receive the kdf id on success.
+ * \param snap          The \ref column_snapshot instance for this operation.
+ * \param kdf_name      The ASCII zero terminated kdf name.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_COLUMN_SNAPSHOT_NAME_NOT_FOUND if no record uses this kdf.
+ */
+status FN_DECL_MUST_CHECK
+column_snapshot_kdf_id_get(
+    uint32_t* id, const column_snapshot* snap, const char* kdf_name)
+{
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != id);
+    RCPR_MODEL_ASSERT(prop_column_snapshot_valid(snap));
+    RCPR_MODEL_ASSERT(NULL != kdf_name);
+
+    return column_snapshot_dictionary_find(id, &snap->kdf_names, kdf_name);
+}
@@ -0,0 +1,26 @@
+/**
+ * \file column_snapshot/column_snapshot_resource_handle.c
+ *
+ * \brief Get the resource handle for the column snapshot.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "column_snapshot_internal.h"
+
+/**
+ * \brief Given a \ref column_snapshot instance, return the resource handle for
+ * this \ref column_snapshot instance.
+ *
+ * \param snap          The \ref column_snapshot instance from which the
+ *                      resource handle is returned.
+ *
+ * \returns the resource handle for this \ref column_snapshot instance.
+ */
+RCPR_SYM(resource)*
+column_snapshot_resource_handle(
+    column_snapshot* snap)
+{
+    return &snap->hdr;
+}
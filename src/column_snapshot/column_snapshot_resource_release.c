@@ -0,0 +1,83 @@
+/**
+ * \file column_snapshot/column_snapshot_resource_release.c
+ *
+ * \brief Release a \ref column_snapshot resource.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "column_snapshot_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Release a \ref column_snapshot resource.
+ *
+ * \param r             Pointer to the \ref column_snapshot resource to be
+ *                      released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status column_snapshot_resource_release(RCPR_SYM(resource)* r)
+{
+    status release_retval;
+    status retval = STATUS_SUCCESS;
+
+    column_snapshot* snap = (column_snapshot*)r;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_column_snapshot_valid(snap));
+
+    /* cache allocator. */
+    allocator* alloc = snap->alloc;
+
+    /* release each column. */
+    void* columns[] = {
+        snap->creation_date, snap->revocation_date, snap->expiration_date,
+        snap->version, snap->password_length, snap->generation, snap->kdf,
+        snap->alphabet, snap->legacy };
+    for (size_t i = 0; i < sizeof(columns) / sizeof(columns[0]); ++i)
+    {
+        if (NULL != columns[i])
+        {
+            release_retval = allocator_reclaim(alloc, columns[i]);
+            if (STATUS_SUCCESS != release_retval)
+            {
+                retval = release_retval;
+            }
+        }
+    }
+
+    /* release the dictionaries. */
+    release_retval =
+        column_snapshot_dictionary_release(alloc, &snap->kdf_names);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    release_retval =
+        column_snapshot_dictionary_release(alloc, &snap->alphabet_names);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(snap, 0, sizeof(*snap)));
+
+    /* reclaim memory. */
+    release_retval = allocator_reclaim(alloc, snap);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
@@ -0,0 +1,27 @@
+/**
+ * \file column_snapshot/column_snapshot_row_count_get.c
+ *
+ * \brief Get the number of rows in a column snapshot.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "column_snapshot_internal.h"
+
+/**
+ * \brief Get the number of rows in a \ref column_snapshot.
+ *
+ * \param snap          The \ref column_snapshot instance for this operation.
+ *
+ * \returns the number of rows, which is the record count of the store.
+ */
+size_t
+column_snapshot_row_count_get(
+    const column_snapshot* snap)
+{
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_column_snapshot_valid(snap));
+
+    return snap->row_count;
+}
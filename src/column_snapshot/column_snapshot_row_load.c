@@ -0,0 +1,79 @@
+/**
+ * \file column_snapshot/column_snapshot_row_load.c
+ *
+ * \brief Copy one record into a row of a \ref column_snapshot.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "column_snapshot_internal.h"
+
+/**
+ * \brief Copy the fields of one record into a row of a snapshot.
+ *
+ * \param snap          The snapshot.
+ * \param row           The row to fill.
+ * \param meta          The record.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status FN_DECL_MUST_CHECK
+column_snapshot_row_load(
+    column_snapshot* snap, size_t row, const metadata* meta)
+{
+    status retval;
+    bool legacy;
+    const char* kdf_name;
+    const char* encoding;
+
+    if (STATUS_SUCCESS
+            != (retval =
+                    metadata_version_get(&snap->version[row], meta))
+     || STATUS_SUCCESS
+            != (retval =
+                    metadata_creation_date_get(
+                        &snap->creation_date[row], meta))
+     || STATUS_SUCCESS
+            != (retval =
+                    metadata_revocation_date_get(
+                        &snap->revocation_date[row], meta))
+     || STATUS_SUCCESS
+            != (retval =
+                    metadata_expiration_date_get(
+                        &snap->expiration_date[row], meta))
+     || STATUS_SUCCESS
+            != (retval =
+                    metadata_password_length_get(
+                        &snap->password_length[row], meta))
+     || STATUS_SUCCESS
+            != (retval =
+                    metadata_generation_get(&snap->generation[row], meta))
+     || STATUS_SUCCESS
+            != (retval = metadata_legacy_flag_get(&legacy, meta))
+     || STATUS_SUCCESS
+            != (retval = metadata_kdf_name_get(&kdf_name, meta))
+     || STATUS_SUCCESS
+            != (retval = metadata_encoding_get(&encoding, meta)))
+    {
+        return retval;
+    }
+
+    snap->legacy[row] = legacy ? 1 : 0;
+
+    /* map the names to their dictionary ids. */
+    retval =
+        column_snapshot_dictionary_add(
+            &snap->kdf[row], snap->alloc, &snap->kdf_names, kdf_name);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    return
+        column_snapshot_dictionary_add(
+            &snap->alphabet[row], snap->alloc, &snap->alphabet_names,
+            encoding);
+}
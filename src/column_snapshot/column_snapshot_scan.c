@@ -0,0 +1,114 @@
+/**
+ * \file column_snapshot/column_snapshot_scan.c
+ *
+ * \brief Select the rows of a column snapshot that match a predicate.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+
+#include "column_snapshot_internal.h"
+
+/**
+ * \brief Select the rows of a \ref column_snapshot whose field compares to a
+ * value with the given operator.
+ *
+ * \param bitmap        The selection bitmap, which must hold
+ *                      \ref COLUMN_SNAPSHOT_BITMAP_WORDS of the row count
+ *                      words, and which is overwritten.
+ * \param snap          The \ref column_snapshot instance for this operation.
+ * \param field         The COLUMN_SNAPSHOT_FIELD_ value to compare.
+ * \param op            The COLUMN_SNAPSHOT_OP_ value to compare with.
+ * \param value         The value to compare against. Values are compared as
+ *                      unsigned integers, so a value wider than the column
+ *                      compares greater than every row.
+ *
+ * \note Where the CPU supports AVX2, each 64-row word of the bitmap is built
+ * from vector compares of the column; otherwise the rows are compared one at a
+ * time. Bits past the last row are clear.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_COLUMN_SNAPSHOT_INVALID_FIELD if \p field is not a valid field.
+ *      - ERROR_COLUMN_SNAPSHOT_INVALID_OPERATOR if \p op is not a valid
+ *        operator.
+ */
+status FN_DECL_MUST_CHECK
+column_snapshot_scan(
+    uint64_t* bitmap, const column_snapshot* snap, uint32_t field,
+    uint32_t op, uint64_t value)
+{
+    status retval;
+    const void* column;
+    size_t width;
+    size_t words = COLUMN_SNAPSHOT_BITMAP_WORDS(snap->row_count);
+    size_t tail = snap->row_count % COLUMN_SNAPSHOT_WORD_ROWS;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_column_snapshot_valid(snap));
+
+    if (op < COLUMN_SNAPSHOT_OP_LT || op > COLUMN_SNAPSHOT_OP_GT)
+    {
+        return ERROR_COLUMN_SNAPSHOT_INVALID_OPERATOR;
+    }
+
+    /* find the column for this field. */
+    retval = column_snapshot_column_get(&column, &width, snap, field);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* a value wider than the column is greater than every row. */
+    if (width < sizeof(value) && (value >> (8 * width)) != 0)
+    {
+        for (size_t w = 0; w < words; ++w)
+        {
+            bitmap[w] = column_snapshot_combine(op, 0, 0);
+        }
+    }
+#ifdef COLUMN_SNAPSHOT_AVX2
+    else if (__builtin_cpu_supports("avx2"))
+    {
+        switch (width)
+        {
+            case sizeof(uint64_t):
+                column_snapshot_scan_avx2_64(
+                    bitmap, (const uint64_t*)column, words, op, value);
+                break;
+
+            case sizeof(uint32_t):
+                column_snapshot_scan_avx2_32(
+                    bitmap, (const uint32_t*)column, words, op,
+                    (uint32_t)value);
+                break;
+
+            case sizeof(uint16_t):
+                column_snapshot_scan_avx2_16(
+                    bitmap, (const uint16_t*)column, words, op,
+                    (uint16_t)value);
+                break;
+
+            default:
+                column_snapshot_scan_avx2_8(
+                    bitmap, (const uint8_t*)column, words, op,
+                    (uint8_t)value);
+                break;
+        }
+    }
+#endif
+    else
+    {
+        column_snapshot_scan_scalar(bitmap, column, width, words, op, value);
+    }
+
+    /* the padding rows are zero, so they may have matched; clear them. */
+    if (tail > 0)
+    {
+        bitmap[words - 1] &= (UINT64_C(1) << tail) - 1;
+    }
+
+    return STATUS_SUCCESS;
+}
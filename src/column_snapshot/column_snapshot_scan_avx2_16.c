@@ -0,0 +1,60 @@
+/**
+ * \file column_snapshot/column_snapshot_scan_avx2_16.c
+ *
+ * \brief Scan a 16-bit column of a column snapshot with AVX2.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "column_snapshot_internal.h"
+
+#ifdef COLUMN_SNAPSHOT_AVX2
+/**
+ * \brief Scan a 16-bit column with AVX2.
+ *
+ * \param bitmap        The selection bitmap to write.
+ * \param column        The column.
+ * \param words         The number of bitmap words to write.
+ * \param op            The COLUMN_SNAPSHOT_OP_ value.
+ * \param value         The value to compare against.
+ */
+__attribute__((target("avx2")))
+void
+column_snapshot_scan_avx2_16(
+    uint64_t* bitmap, const uint16_t* column, size_t words, uint32_t op,
+    uint16_t value)
+{
+    const __m256i sign = _mm256_set1_epi16((short)0x8000);
+    const __m256i needle =
+        _mm256_xor_si256(_mm256_set1_epi16((short)value), sign);
+
+    for (size_t w = 0; w < words; ++w)
+    {
+        uint64_t gt = 0, eq = 0;
+        const uint16_t* rows = column + w * COLUMN_SNAPSHOT_WORD_ROWS;
+
+        for (size_t i = 0; i < COLUMN_SNAPSHOT_WORD_ROWS; i += 32)
+        {
+            __m256i lo =
+                _mm256_xor_si256(
+                    _mm256_loadu_si256((const __m256i*)(rows + i)), sign);
+            __m256i hi =
+                _mm256_xor_si256(
+                    _mm256_loadu_si256((const __m256i*)(rows + i + 16)),
+                    sign);
+
+            gt |=
+                column_snapshot_mask_16(
+                    _mm256_cmpgt_epi16(lo, needle),
+                    _mm256_cmpgt_epi16(hi, needle)) << i;
+            eq |=
+                column_snapshot_mask_16(
+                    _mm256_cmpeq_epi16(lo, needle),
+                    _mm256_cmpeq_epi16(hi, needle)) << i;
+        }
+
+        bitmap[w] = column_snapshot_combine(op, gt, eq);
+    }
+}
+#endif
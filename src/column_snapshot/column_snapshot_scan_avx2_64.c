@@ -0,0 +1,60 @@
+/**
+ * \file column_snapshot/column_snapshot_scan_avx2_64.c
+ *
+ * \brief Scan a 64-bit column of a column snapshot with AVX2.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "column_snapshot_internal.h"
+
+#ifdef COLUMN_SNAPSHOT_AVX2
+/**
+ * \brief Scan a 64-bit column with AVX2.
+ *
+ * \param bitmap        The selection bitmap to write.
+ * \param column        The column.
+ * \param words         The number of bitmap words to write.
+ * \param op            The COLUMN_SNAPSHOT_OP_ value.
+ * \param value         The value to compare against.
+ *
+ * \note AVX2 only has signed compares, so both sides have their sign bit
+ * flipped, which orders them as unsigned values. The same holds for the
+ * narrower columns.
+ */
+__attribute__((target("avx2")))
+void
+column_snapshot_scan_avx2_64(
+    uint64_t* bitmap, const uint64_t* column, size_t words, uint32_t op,
+    uint64_t value)
+{
+    const __m256i sign = _mm256_set1_epi64x((long long)(UINT64_C(1) << 63));
+    const __m256i needle =
+        _mm256_xor_si256(_mm256_set1_epi64x((long long)value), sign);
+
+    for (size_t w = 0; w < words; ++w)
+    {
+        uint64_t gt = 0, eq = 0;
+        const uint64_t* rows = column + w * COLUMN_SNAPSHOT_WORD_ROWS;
+
+        for (size_t i = 0; i < COLUMN_SNAPSHOT_WORD_ROWS; i += 4)
+        {
+            __m256i data =
+                _mm256_xor_si256(
+                    _mm256_loadu_si256((const __m256i*)(rows + i)), sign);
+            uint64_t gt_bits =
+                (uint64_t)_mm256_movemask_pd(
+                    _mm256_castsi256_pd(_mm256_cmpgt_epi64(data, needle)));
+            uint64_t eq_bits =
+                (uint64_t)_mm256_movemask_pd(
+                    _mm256_castsi256_pd(_mm256_cmpeq_epi64(data, needle)));
+
+            gt |= gt_bits << i;
+            eq |= eq_bits << i;
+        }
+
+        bitmap[w] = column_snapshot_combine(op, gt, eq);
+    }
+}
+#endif
@@ -0,0 +1,46 @@
+/**
+ * \file column_snapshot/column_snapshot_scan_scalar.c
+ *
+ * \brief Scan a column of a column snapshot one row at a time.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "column_snapshot_internal.h"
+
+/**
+ * \brief Scan a column one row at a time.
+ *
+ * \param bitmap        The selection bitmap to write.
+ * \param column        The column.
+ * \param width         The width of the column in bytes.
+ * \param words         The number of bitmap words to write.
+ * \param op            The COLUMN_SNAPSHOT_OP_ value.
+ * \param value         The value to compare against.
+ *
+ * \note This is the fallback of \ref column_snapshot_scan on CPUs without
+ * AVX2. A value wider than the column compares greater than every row. The
+ * padding rows past the row count are compared as well, so their bits are not
+ * cleared.
+ */
+void
+column_snapshot_scan_scalar(
+    uint64_t* bitmap, const void* column, size_t width, size_t words,
+    uint32_t op, uint64_t value)
+{
+    for (size_t w = 0; w < words; ++w)
+    {
+        uint64_t gt = 0, eq = 0;
+        size_t base = w * COLUMN_SNAPSHOT_WORD_ROWS;
+
+        for (size_t bit = 0; bit < COLUMN_SNAPSHOT_WORD_ROWS; ++bit)
+        {
+            uint64_t row = column_snapshot_row_read(column, width, base + bit);
+            gt |= (uint64_t)(row > value) << bit;
+            eq |= (uint64_t)(row == value) << bit;
+        }
+
+        bitmap[w] = column_snapshot_combine(op, gt, eq);
+    }
+}
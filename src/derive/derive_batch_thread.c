@@ -0,0 +1,49 @@
+/**
+ * \file derive/derive_batch_thread.c
+ *
+ * \brief The worker thread of a batch derivation.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "derive_internal.h"
+
+/**
+ * \brief Entry point for a batch derivation worker.
+ *
+ * \param context       The \ref derive_batch for this worker.
+ *
+ * \returns NULL.
+ */
+void*
+derive_batch_thread(
+    void* context)
+{
+    status retval;
+    derive_batch* batch = (derive_batch*)context;
+    status expected = STATUS_SUCCESS;
+
+    /* stop taking records once any worker fails. */
+    while (STATUS_SUCCESS == atomic_load(&batch->retval))
+    {
+        size_t i = atomic_fetch_add(&batch->next, 1);
+        if (i >= batch->count)
+        {
+            break;
+        }
+
+        retval =
+            derive_password(
+                &batch->passwords[i], batch->alloc, batch->ctx,
+                batch->records[i]);
+        if (STATUS_SUCCESS != retval)
+        {
+            /* keep the first error. */
+            atomic_compare_exchange_strong(&batch->retval, &expected, retval);
+            break;
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,115 @@
+/**
+ * \file derive/derive_context_create.c
+ *
+ * \brief Create a \ref derive_context instance.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "derive_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Create a derive context.
+ *
+ * \param ctx           Pointer to the derive context pointer to receive the
+ *                      derive context on success.
+ * \param alloc         The allocator instance to use for this operation.
+ * \param master        The master passphrase, which is copied.
+ * \param iterations    The PBKDF2 iteration count for records without a kdf
+ *                      cost, and for the session stage.
+ *
+ * \note This derive context is a \ref resource that must be released by
+ * calling \ref resource_release on its resource handle when it is no longer
+ * needed by the caller. The resource handle can be accessed by calling
+ * \ref derive_context_resource_handle on this derive context instance. The
+ * copy of the master passphrase is erased when the context is released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *
+ * \pre
+ *      - \p ctx must not reference a valid \ref derive_context instance and
+ *        must not be NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ *      - \p master must reference a valid \ref secure_buffer instance.
+ *      - \p iterations must be greater than zero and at most
+ *        \ref DERIVE_COST_MAX.
+ * \post
+ *      - On success, \p ctx is set to a pointer to a valid
+ *        \ref derive_context instance, which is a \ref resource owned by the
+ *        caller that must be released when no longer needed.
+ *      - On failure, \p ctx is not changed and an error status is returned.
+ */
+status FN_DECL_MUST_CHECK
+derive_context_create(
+    derive_context** ctx, RCPR_SYM(allocator)* alloc,
+    const secure_buffer* master, uint32_t iterations)
+{
+    status retval, release_retval;
+    derive_context* tmp = NULL;
+    size_t master_size, copy_size;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != ctx);
+    RCPR_MODEL_ASSERT(prop_allocator_valid(alloc));
+    RCPR_MODEL_ASSERT(prop_secure_buffer_valid(master));
+    RCPR_MODEL_ASSERT(iterations > 0 && iterations <= DERIVE_COST_MAX);
+
+    /* allocate memory for the derive context instance. */
+    retval = allocator_allocate(alloc, (void**)&tmp, sizeof(*tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(tmp, 0, sizeof(*tmp)));
+
+    /* the tag is not set by default. */
+    RCPR_MODEL_ONLY(tmp->RCPR_MODEL_STRUCT_TAG_REF(derive_context) = 0);
+    RCPR_MODEL_ASSERT_STRUCT_TAG_NOT_INITIALIZED(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(derive_context), derive_context);
+
+    /* set the tag. */
+    RCPR_MODEL_STRUCT_TAG_INIT(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(derive_context), derive_context);
+
+    /* initialize resource. */
+    resource_init(&tmp->hdr, &derive_context_resource_release);
+    tmp->alloc = alloc;
+    tmp->iterations = iterations;
+
+    /* copy the master passphrase. */
+    const void* master_data =
+        secure_buffer_data(&master_size, (secure_buffer*)master);
+    retval = secure_buffer_create(&tmp->master, alloc, master_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    memcpy(secure_buffer_data(&copy_size, tmp->master), master_data,
+           master_size);
+
+    /* success. */
+    *ctx = tmp;
+    return STATUS_SUCCESS;
+
+cleanup_tmp:
+    RCPR_MODEL_EXEMPT(memset(tmp, 0, sizeof(*tmp)));
+    release_retval = allocator_reclaim(alloc, tmp);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
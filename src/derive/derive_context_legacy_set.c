@@ -0,0 +1,28 @@
+/**
+ * \file derive/derive_context_legacy_set.c
+ *
+ * \brief Set the legacy scheme of a \ref derive_context.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "derive_internal.h"
+
+/**
+ * \brief Set the nepephemeral 0.x scheme used for legacy records.
+ *
+ * \param ctx           The \ref derive_context instance for this operation.
+ * \param legacy        The legacy derivation function.
+ * \param context       The user context passed to \p legacy.
+ *
+ * \note Until this is set, deriving a legacy record fails with
+ * ERROR_DERIVE_LEGACY_UNAVAILABLE.
+ */
+void
+derive_context_legacy_set(
+    derive_context* ctx, derive_legacy_fn legacy, void* context)
+{
+    ctx->legacy = legacy;
+    ctx->legacy_context = context;
+}
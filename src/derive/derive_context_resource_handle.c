@@ -0,0 +1,26 @@
+/**
+ * \file derive/derive_context_resource_handle.c
+ *
+ * \brief Get the resource handle for the derive context.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "derive_internal.h"
+
+/**
+ * \brief Given a \ref derive_context instance, return the resource handle for
+ * this \ref derive_context instance.
+ *
+ * \param ctx           The \ref derive_context instance from which the
+ *                      resource handle is returned.
+ *
+ * \returns the resource handle for this \ref derive_context instance.
+ */
+RCPR_SYM(resource)*
+derive_context_resource_handle(
+    derive_context* ctx)
+{
+    return &ctx->hdr;
+}
@@ -0,0 +1,62 @@
+/**
+ * \file derive/derive_context_resource_release.c
+ *
+ * \brief Release a \ref derive_context resource.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "derive_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Release a \ref derive_context resource.
+ *
+ * \param r             Pointer to the \ref derive_context resource to be
+ *                      released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status derive_context_resource_release(RCPR_SYM(resource)* r)
+{
+    status release_retval = STATUS_SUCCESS;
+    status retval = STATUS_SUCCESS;
+
+    derive_context* ctx = (derive_context*)r;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_derive_context_valid(ctx));
+
+    /* cache allocator. */
+    allocator* alloc = ctx->alloc;
+
+    /* erase the session key. */
+    derive_context_session_key_release(ctx);
+
+    /* release the master passphrase, which erases it. */
+    release_retval =
+        resource_release(secure_buffer_resource_handle(ctx->master));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(ctx, 0, sizeof(*ctx)));
+
+    /* reclaim memory. */
+    release_retval = allocator_reclaim(alloc, ctx);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
@@ -0,0 +1,38 @@
+/**
+ * \file derive/derive_context_session_key_release.c
+ *
+ * \brief Erase the session key of a \ref derive_context.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+#include <sys/mman.h>
+
+#include "derive_internal.h"
+
+/**
+ * \brief Erase, unlock, and unmap the session key of a \ref derive_context.
+ *
+ * \param ctx           The \ref derive_context for this operation.
+ *
+ * \note This does nothing if the context has no session key.
+ */
+void
+derive_context_session_key_release(
+    derive_context* ctx)
+{
+    if (NULL == ctx->session_key)
+    {
+        return;
+    }
+
+    /* erase the key before its page can leave locked memory. */
+    RCPR_MODEL_EXEMPT(memset(ctx->session_key, 0, DERIVE_SESSION_KEY_SIZE));
+    munlock(ctx->session_key, ctx->session_key_region_size);
+    munmap(ctx->session_key, ctx->session_key_region_size);
+
+    ctx->session_key = NULL;
+    ctx->session_key_region_size = 0;
+}
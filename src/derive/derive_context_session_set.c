@@ -0,0 +1,136 @@
+/**
+ * \file derive/derive_context_session_set.c
+ *
+ * \brief Start a session on a \ref derive_context.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <openssl/evp.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "derive_internal.h"
+
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Start a session by absorbing a session passphrase.
+ *
+ * \param ctx           The \ref derive_context instance for this operation.
+ * \param session       The session passphrase.
+ *
+ * \note This runs the PBKDF2 iterations of the session stage once, so that
+ * each record in the session HMAC-SHA3-512 mode only costs a few HMACs. The
+ * session key is locked in memory, and any previous session key is erased.
+ * This must not be called while passwords are being derived with \p ctx.
+ * Until a session is set, deriving a record in this mode fails with
+ * ERROR_DERIVE_SESSION_UNAVAILABLE.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_DERIVE_MLOCK_FAILED if the session key could not be locked in
+ *        memory.
+ *      - ERROR_DERIVE_KDF_FAILED if the KDF failed.
+ *
+ * \pre
+ *      - \p ctx must reference a valid \ref derive_context instance.
+ *      - \p session must reference a valid \ref secure_buffer instance.
+ * \post
+ *      - On failure, the context has no session.
+ */
+status FN_DECL_MUST_CHECK
+derive_context_session_set(
+    derive_context* ctx, const secure_buffer* session)
+{
+    status retval, release_retval;
+    secure_buffer* salt = NULL;
+    size_t master_size, session_size, salt_size;
+    const size_t domain_size = sizeof(DERIVE_SESSION_DOMAIN) - 1;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_derive_context_valid(ctx));
+    RCPR_MODEL_ASSERT(prop_secure_buffer_valid(session));
+
+    /* erase the previous session. */
+    derive_context_session_key_release(ctx);
+
+    /* the session key gets a page of its own, so that locking it does not
+     * reach into the heap, and unlocking it does not unlock anything else. */
+    long page_size = sysconf(_SC_PAGESIZE);
+    size_t region_size =
+        (page_size > DERIVE_SESSION_KEY_SIZE)
+            ? (size_t)page_size : DERIVE_SESSION_KEY_SIZE;
+    uint8_t* region =
+        (uint8_t*)mmap(
+            NULL, region_size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED == region)
+    {
+        return ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    if (0 != mlock(region, region_size))
+    {
+        munmap(region, region_size);
+        return ERROR_DERIVE_MLOCK_FAILED;
+    }
+
+#ifdef MADV_DONTDUMP
+    /* keep the session key out of core dumps. */
+    madvise(region, region_size, MADV_DONTDUMP);
+#endif
+
+    ctx->session_key = region;
+    ctx->session_key_region_size = region_size;
+
+    /* build the salt. */
+    const void* session_data =
+        secure_buffer_data(&session_size, (secure_buffer*)session);
+    retval =
+        secure_buffer_create(&salt, ctx->alloc, domain_size + session_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        derive_context_session_key_release(ctx);
+        return retval;
+    }
+
+    uint8_t* salt_data = (uint8_t*)secure_buffer_data(&salt_size, salt);
+    memcpy(salt_data, DERIVE_SESSION_DOMAIN, domain_size);
+    memcpy(salt_data + domain_size, session_data, session_size);
+
+    /* run the expensive stage once. */
+    const void* master_data = secure_buffer_data(&master_size, ctx->master);
+    if (1 !=
+            PKCS5_PBKDF2_HMAC(
+                (const char*)master_data, (int)master_size, salt_data,
+                (int)salt_size, (int)ctx->iterations, EVP_sha3_512(),
+                DERIVE_SESSION_KEY_SIZE, ctx->session_key))
+    {
+        retval = ERROR_DERIVE_KDF_FAILED;
+        goto cleanup_salt;
+    }
+
+    /* success. */
+    retval = STATUS_SUCCESS;
+
+cleanup_salt:
+    release_retval = resource_release(secure_buffer_resource_handle(salt));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    /* a failed session leaves no session behind. */
+    if (STATUS_SUCCESS != retval)
+    {
+        derive_context_session_key_release(ctx);
+    }
+
+    return retval;
+}
@@ -0,0 +1,124 @@
+/**
+ * \file derive/derive_cost_calibrate.c
+ *
+ * \brief Pick the kdf cost of a mode for a target latency on this host.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <string.h>
+
+#include "derive_internal.h"
+
+/**
+ * \brief Measure the KDF of a mode on this host, and pick the kdf cost that
+ * takes about the target latency.
+ *
+ * \param cost          Pointer to receive the kdf cost on success.
+ * \param kdf_name      The kdf name of the mode to calibrate.
+ * \param target_usec   The target latency, in microseconds, such as
+ *                      \ref DERIVE_COST_TARGET_INTERACTIVE_USEC or
+ *                      \ref DERIVE_COST_TARGET_MASTER_USEC.
+ *
+ * \note The KDF is timed with a doubling iteration count until one run is long
+ * enough to measure, and then the fastest of a few runs at that count is
+ * scaled to the target. Using the fastest run keeps a busy host from picking a
+ * lower cost. The measurement takes a small fraction of the target latency.
+ * For the PBKDF2 HMAC-SHA3-512 mode, the cost is the iteration count to store
+ * in each record with \ref metadata_kdf_cost_set. For the session
+ * HMAC-SHA3-512 mode, it is the iteration count of the session stage, which is
+ * given to \ref derive_context_create.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_DERIVE_UNKNOWN_KDF if the kdf name is unknown.
+ *      - ERROR_DERIVE_KDF_FAILED if the KDF failed.
+ *
+ * \pre
+ *      - \p cost must be a valid pointer.
+ *      - \p target_usec must be greater than zero.
+ * \post
+ *      - On success, \p cost is set to a kdf cost between 1 and
+ *        \ref DERIVE_COST_MAX.
+ *      - On failure, \p cost is unchanged.
+ */
+status FN_DECL_MUST_CHECK
+derive_cost_calibrate(
+    uint32_t* cost, const char* kdf_name, uint64_t target_usec)
+{
+    status retval;
+    uint64_t elapsed_nsec, best_nsec;
+    uint32_t iterations = DERIVE_CALIBRATE_FIRST_ITERATIONS;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != cost);
+    RCPR_MODEL_ASSERT(NULL != kdf_name);
+    RCPR_MODEL_ASSERT(target_usec > 0);
+
+    /* both modes spend their cost in PBKDF2 HMAC-SHA3-512. */
+    if (strcmp(DERIVE_KDF_PBKDF2_SHA3_512, kdf_name)
+     && strcmp(DERIVE_KDF_SESSION_HMAC_SHA3_512, kdf_name))
+    {
+        return ERROR_DERIVE_UNKNOWN_KDF;
+    }
+
+    /* a short target is measured for no longer than the target itself. */
+    uint64_t sample_nsec =
+        1000
+      * ((target_usec < DERIVE_CALIBRATE_SAMPLE_USEC)
+            ? target_usec : DERIVE_CALIBRATE_SAMPLE_USEC);
+
+    /* double the iteration count until a run is long enough to measure. */
+    for (;;)
+    {
+        retval = derive_cost_calibrate_run(&elapsed_nsec, iterations);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        if (elapsed_nsec >= sample_nsec || iterations > DERIVE_COST_MAX / 2)
+        {
+            break;
+        }
+
+        iterations *= 2;
+    }
+
+    /* keep the fastest run at this count. */
+    best_nsec = elapsed_nsec;
+    for (size_t i = 1; i < DERIVE_CALIBRATE_SAMPLES; ++i)
+    {
+        retval = derive_cost_calibrate_run(&elapsed_nsec, iterations);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        if (elapsed_nsec < best_nsec)
+        {
+            best_nsec = elapsed_nsec;
+        }
+    }
+
+    /* the cost of PBKDF2 is linear in its iteration count. */
+    double scaled =
+        (double)iterations * (double)target_usec * 1000.0
+      / (double)((best_nsec > 0) ? best_nsec : 1);
+    if (scaled < 1.0)
+    {
+        *cost = 1;
+    }
+    else if (scaled > (double)DERIVE_COST_MAX)
+    {
+        *cost = DERIVE_COST_MAX;
+    }
+    else
+    {
+        *cost = (uint32_t)scaled;
+    }
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,51 @@
+/**
+ * \file derive/derive_cost_calibrate_run.c
+ *
+ * \brief Time one KDF run for cost calibration.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <openssl/evp.h>
+#include <string.h>
+#include <time.h>
+
+#include "derive_internal.h"
+
+/**
+ * \brief Time one PBKDF2 HMAC-SHA3-512 run with a record sized salt.
+ *
+ * \param elapsed_nsec  Pointer to receive the elapsed time in nanoseconds.
+ * \param iterations    The iteration count.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+derive_cost_calibrate_run(
+    uint64_t* elapsed_nsec, uint32_t iterations)
+{
+    static const char password[] = "nepe2 calibration";
+    uint8_t salt[2 * sizeof(uint32_t) + 32];
+    uint8_t key[DERIVE_SESSION_KEY_SIZE];
+    struct timespec start, end;
+
+    memset(salt, 0, sizeof(salt));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (1 !=
+            PKCS5_PBKDF2_HMAC(
+                password, sizeof(password) - 1, salt, sizeof(salt),
+                (int)iterations, EVP_sha3_512(), sizeof(key), key))
+    {
+        return ERROR_DERIVE_KDF_FAILED;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    *elapsed_nsec =
+        (uint64_t)(end.tv_sec - start.tv_sec) * 1000000000
+      + (uint64_t)end.tv_nsec - (uint64_t)start.tv_nsec;
+
+    return STATUS_SUCCESS;
+}
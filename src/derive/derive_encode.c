@@ -0,0 +1,43 @@
+/**
+ * \file derive/derive_encode.c
+ *
+ * \brief Encode a derived key as password characters.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "derive_internal.h"
+
+/**
+ * \brief Encode a derived key as password characters.
+ *
+ * \param out           The output characters.
+ * \param length        The number of characters to write.
+ * \param key           The derived key, which holds at least
+ *                      ceil(length * bits / 8) bytes.
+ * \param encoding      The encoding alphabet.
+ * \param bits          The number of bits per character.
+ */
+void
+derive_encode(
+    uint8_t* out, size_t length, const uint8_t* key, const char* encoding,
+    unsigned int bits)
+{
+    uint32_t accumulator = 0;
+    unsigned int available = 0;
+    uint32_t mask = (1U << bits) - 1;
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        /* refill the accumulator a byte at a time, most significant first. */
+        while (available < bits)
+        {
+            accumulator = (accumulator << 8) | *key++;
+            available += 8;
+        }
+
+        available -= bits;
+        out[i] = (uint8_t)encoding[(accumulator >> available) & mask];
+    }
+}
@@ -0,0 +1,43 @@
+/**
+ * \file derive/derive_encoding_bits_get.c
+ *
+ * \brief Get the number of bits per character for an encoding alphabet.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <string.h>
+
+#include "derive_internal.h"
+
+/**
+ * \brief Get the number of bits per character for an encoding alphabet.
+ *
+ * \param bits          Pointer to receive the number of bits per character.
+ * \param encoding      The encoding alphabet.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_DERIVE_UNSUPPORTED_ENCODING if the alphabet length is not a
+ *        power of two between 2 and 128.
+ */
+status FN_DECL_MUST_CHECK
+derive_encoding_bits_get(
+    unsigned int* bits, const char* encoding)
+{
+    size_t length = strlen(encoding);
+
+    /* symbolic encodings are not alphabets. */
+    for (unsigned int i = 1; i <= 7; ++i)
+    {
+        if (((size_t)1 << i) == length)
+        {
+            *bits = i;
+            return STATUS_SUCCESS;
+        }
+    }
+
+    return ERROR_DERIVE_UNSUPPORTED_ENCODING;
+}
@@ -0,0 +1,185 @@
+/**
+ * \file derive/derive_internal.h
+ *
+ * \brief Internal header for \ref derive_context.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <nepe2/derive.h>
+#include <rcpr/resource/protected.h>
+#include <stdatomic.h>
+
+/**
+ * \brief The size of the session key.
+ */
+#define DERIVE_SESSION_KEY_SIZE                                             64
+
+/**
+ * \brief The domain tag that starts the salt of the session stage.
+ */
+#define DERIVE_SESSION_DOMAIN                                  "nepe2 session"
+
+/**
+ * \brief The iteration count of the first calibration run.
+ */
+#define DERIVE_CALIBRATE_FIRST_ITERATIONS                                 1024
+
+/**
+ * \brief The shortest calibration run, in microseconds, that is long enough
+ * to measure.
+ */
+#define DERIVE_CALIBRATE_SAMPLE_USEC                                     50000
+
+/**
+ * \brief The number of calibration runs at the final iteration count.
+ */
+#define DERIVE_CALIBRATE_SAMPLES                                             3
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+struct derive_context
+{
+    RCPR_SYM(resource) hdr;
+    RCPR_MODEL_STRUCT_TAG(derive_context);
+    RCPR_SYM(allocator)* alloc;
+    secure_buffer* master;
+    uint32_t iterations;
+    derive_legacy_fn legacy;
+    void* legacy_context;
+    uint8_t* session_key;
+    size_t session_key_region_size;
+};
+
+/**
+ * \brief The shared state of a batch derivation.
+ */
+typedef struct derive_batch derive_batch;
+
+struct derive_batch
+{
+    secure_buffer** passwords;
+    RCPR_SYM(allocator)* alloc;
+    const derive_context* ctx;
+    const metadata* const* records;
+    size_t count;
+    _Atomic size_t next;
+    _Atomic status retval;
+};
+
+/**
+ * \brief Release a \ref derive_context resource.
+ *
+ * \param r             Pointer to the \ref derive_context resource to be
+ *                      released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status derive_context_resource_release(RCPR_SYM(resource)* r);
+
+/**
+ * \brief Derive the password for a record with PBKDF2 HMAC-SHA3-512.
+ *
+ * \param password      Pointer to receive the password on success.
+ * \param alloc         The allocator to use for the password.
+ * \param ctx           The \ref derive_context for this operation.
+ * \param record        The record to derive.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+derive_password_pbkdf2_sha3_512(
+    secure_buffer** password, RCPR_SYM(allocator)* alloc,
+    const derive_context* ctx, const metadata* record);
+
+/**
+ * \brief Derive the password for a record with the session key.
+ *
+ * \param password      Pointer to receive the password on success.
+ * \param alloc         The allocator to use for the password.
+ * \param ctx           The \ref derive_context for this operation.
+ * \param record        The record to derive.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+derive_password_session_hmac_sha3_512(
+    secure_buffer** password, RCPR_SYM(allocator)* alloc,
+    const derive_context* ctx, const metadata* record);
+
+/**
+ * \brief Erase, unlock, and unmap the session key of a \ref derive_context.
+ *
+ * \param ctx           The \ref derive_context for this operation.
+ *
+ * \note This does nothing if the context has no session key.
+ */
+void
+derive_context_session_key_release(
+    derive_context* ctx);
+
+/**
+ * \brief Get the number of bits per character for an encoding alphabet.
+ *
+ * \param bits          Pointer to receive the number of bits per character.
+ * \param encoding      The encoding alphabet.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_DERIVE_UNSUPPORTED_ENCODING if the alphabet length is not a
+ *        power of two between 2 and 128.
+ */
+status FN_DECL_MUST_CHECK
+derive_encoding_bits_get(
+    unsigned int* bits, const char* encoding);
+
+/**
+ * \brief Encode a derived key as password characters.
+ *
+ * \param out           The output characters.
+ * \param length        The number of characters to write.
+ * \param key           The derived key, which holds at least
+ *                      ceil(length * bits / 8) bytes.
+ * \param encoding      The encoding alphabet.
+ * \param bits          The number of bits per character.
+ */
+void
+derive_encode(
+    uint8_t* out, size_t length, const uint8_t* key, const char* encoding,
+    unsigned int bits);
+
+/**
+ * \brief Entry point for a batch derivation worker.
+ *
+ * \param context       The \ref derive_batch for this worker.
+ *
+ * \returns NULL.
+ */
+void*
+derive_batch_thread(
+    void* context);
+
+/**
+ * \brief Time one PBKDF2 HMAC-SHA3-512 run with a record sized salt.
+ *
+ * \param elapsed_nsec  Pointer to receive the elapsed time in nanoseconds.
+ * \param iterations    The iteration count.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+derive_cost_calibrate_run(
+    uint64_t* elapsed_nsec, uint32_t iterations);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
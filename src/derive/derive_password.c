@@ -0,0 +1,104 @@
+/**
+ * \file derive/derive_password.c
+ *
+ * \brief Derive the password for a \ref metadata record.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <string.h>
+
+#include "derive_internal.h"
+
+/**
+ * \brief Derive the password for a record.
+ *
+ * \param password      Pointer to receive the password on success.
+ * \param alloc         The allocator to use for the password.
+ * \param ctx           The \ref derive_context for this operation.
+ * \param record        The record to derive.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_METADATA_FIELD_NOT_SET if the record is missing a field.
+ *      - ERROR_DERIVE_UNKNOWN_KDF if the kdf name of the record is unknown.
+ *      - ERROR_DERIVE_UNSUPPORTED_ENCODING if the encoding of the record is
+ *        symbolic.
+ *      - ERROR_DERIVE_INVALID_PASSWORD_LENGTH if the password length of the
+ *        record is zero.
+ *      - ERROR_DERIVE_LEGACY_UNAVAILABLE if the record is a legacy record and
+ *        no legacy scheme is set.
+ *      - ERROR_DERIVE_SESSION_UNAVAILABLE if the record is in the session
+ *        mode and no session is set.
+ *      - ERROR_DERIVE_INVALID_COST if the kdf cost of the record is greater
+ *        than \ref DERIVE_COST_MAX.
+ *      - ERROR_DERIVE_KDF_FAILED if the KDF failed.
+ *
+ * \pre
+ *      - \p password must not reference a valid \ref secure_buffer instance
+ *        and must not be NULL.
+ *      - \p ctx must reference a valid \ref derive_context instance.
+ *      - \p record must reference a valid \ref metadata instance.
+ * \post
+ *      - On success, \p password is set to a \ref secure_buffer holding
+ *        password_length characters, which is owned by the caller.
+ *      - On failure, \p password is not changed.
+ */
+status FN_DECL_MUST_CHECK
+derive_password(
+    secure_buffer** password, RCPR_SYM(allocator)* alloc,
+    const derive_context* ctx, const metadata* record)
+{
+    status retval;
+    bool legacy;
+    const char* kdf_name;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != password);
+    RCPR_MODEL_ASSERT(prop_derive_context_valid(ctx));
+    RCPR_MODEL_ASSERT(prop_metadata_valid(record));
+
+    /* legacy records use the nepephemeral 0.x scheme. */
+    retval = metadata_legacy_flag_get(&legacy, record);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    if (legacy)
+    {
+        if (NULL == ctx->legacy)
+        {
+            return ERROR_DERIVE_LEGACY_UNAVAILABLE;
+        }
+
+        return
+            ctx->legacy(
+                ctx->legacy_context, password, alloc, ctx->master, record);
+    }
+
+    /* every other record uses the mode named by its kdf name. */
+    retval = metadata_kdf_name_get(&kdf_name, record);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    if (!strcmp(DERIVE_KDF_PBKDF2_SHA3_512, kdf_name))
+    {
+        return derive_password_pbkdf2_sha3_512(password, alloc, ctx, record);
+    }
+
+    if (!strcmp(DERIVE_KDF_SESSION_HMAC_SHA3_512, kdf_name))
+    {
+        return
+            derive_password_session_hmac_sha3_512(
+                password, alloc, ctx, record);
+    }
+
+    return ERROR_DERIVE_UNKNOWN_KDF;
+}
@@ -0,0 +1,158 @@
+/**
+ * \file derive/derive_password_batch.c
+ *
+ * \brief Derive the passwords for many records on several threads.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "derive_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Derive the passwords for many records on several threads.
+ *
+ * \param passwords     Array of \p count pointers to receive the passwords.
+ * \param alloc         The allocator to use for the passwords, which must be
+ *                      thread-safe.
+ * \param ctx           The \ref derive_context for this operation.
+ * \param records       Array of \p count records to derive.
+ * \param count         The number of records.
+ * \param thread_count  The number of threads to use, or 0 to use one thread
+ *                      per online processor.
+ *
+ * \note Legacy and modern records may be mixed. Threads take the next record
+ * from a shared counter, so a batch with uneven per-record costs still keeps
+ * every thread busy.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_DERIVE_THREAD_CREATE_FAILED if a thread could not be created.
+ *      - the first error returned by \ref derive_password otherwise.
+ *
+ * \pre
+ *      - \p passwords must point to \p count writable pointers.
+ *      - \p ctx must reference a valid \ref derive_context instance.
+ *      - \p records must point to \p count valid \ref metadata instances.
+ * \post
+ *      - On success, each entry of \p passwords is set to the password for the
+ *        matching record, which is owned by the caller.
+ *      - On failure, every entry of \p passwords is NULL.
+ */
+status FN_DECL_MUST_CHECK
+derive_password_batch(
+    secure_buffer** passwords, RCPR_SYM(allocator)* alloc,
+    const derive_context* ctx, const metadata* const* records, size_t count,
+    size_t thread_count)
+{
+    status retval, release_retval;
+    pthread_t* threads = NULL;
+    size_t threads_started = 0;
+    derive_batch batch;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != passwords || 0 == count);
+    RCPR_MODEL_ASSERT(prop_derive_context_valid(ctx));
+    RCPR_MODEL_ASSERT(NULL != records || 0 == count);
+
+    RCPR_MODEL_EXEMPT(memset(passwords, 0, count * sizeof(*passwords)));
+
+    /* default to one thread per online processor. */
+    if (0 == thread_count)
+    {
+        long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = (processors > 0) ? (size_t)processors : 1;
+    }
+
+    /* there is no point in having threads without records. */
+    if (thread_count > count)
+    {
+        thread_count = count;
+    }
+
+    /* set up the shared state. */
+    batch.passwords = passwords;
+    batch.alloc = alloc;
+    batch.ctx = ctx;
+    batch.records = records;
+    batch.count = count;
+    atomic_init(&batch.next, 0);
+    atomic_init(&batch.retval, STATUS_SUCCESS);
+
+    /* start a thread for every worker but the first. */
+    if (thread_count > 1)
+    {
+        retval =
+            allocator_allocate(
+                ctx->alloc, (void**)&threads,
+                (thread_count - 1) * sizeof(*threads));
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        for (size_t i = 0; i + 1 < thread_count; ++i)
+        {
+            if (0 !=
+                    pthread_create(
+                        &threads[i], NULL, &derive_batch_thread, &batch))
+            {
+                /* stop the workers that did start. */
+                atomic_store(&batch.retval, ERROR_DERIVE_THREAD_CREATE_FAILED);
+                break;
+            }
+
+            ++threads_started;
+        }
+    }
+
+    /* the calling thread is the first worker. */
+    (void)derive_batch_thread(&batch);
+
+    /* wait for every started thread. */
+    for (size_t i = 0; i < threads_started; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    retval = atomic_load(&batch.retval);
+
+    /* on failure, release every password that was derived. */
+    if (STATUS_SUCCESS != retval)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (NULL != passwords[i])
+            {
+                release_retval =
+                    resource_release(
+                        secure_buffer_resource_handle(passwords[i]));
+                if (STATUS_SUCCESS != release_retval)
+                {
+                    retval = release_retval;
+                }
+
+                passwords[i] = NULL;
+            }
+        }
+    }
+
+    if (NULL != threads)
+    {
+        release_retval = allocator_reclaim(ctx->alloc, threads);
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    return retval;
+}
@@ -0,0 +1,110 @@
+/**
+ * \file derive/derive_password_check.c
+ *
+ * \brief Check that a record can be derived.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <string.h>
+
+#include "derive_internal.h"
+
+/**
+ * \brief Check that a record can be derived, without running the KDF.
+ *
+ * \param ctx           The \ref derive_context for this operation.
+ * \param record        The record to check.
+ *
+ * \note This reports the record errors that \ref derive_password would, so
+ * that a batch can leave out the records that would fail it. A legacy record
+ * is only checked for a legacy scheme.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS if the record can be derived.
+ *      - ERROR_METADATA_FIELD_NOT_SET if the record is missing a field.
+ *      - ERROR_DERIVE_UNKNOWN_KDF if the kdf name of the record is unknown.
+ *      - ERROR_DERIVE_UNSUPPORTED_ENCODING if the encoding of the record is
+ *        symbolic.
+ *      - ERROR_DERIVE_INVALID_PASSWORD_LENGTH if the password length of the
+ *        record is zero.
+ *      - ERROR_DERIVE_LEGACY_UNAVAILABLE if the record is a legacy record and
+ *        no legacy scheme is set.
+ *      - ERROR_DERIVE_SESSION_UNAVAILABLE if the record is in the session
+ *        mode and no session is set.
+ *      - ERROR_DERIVE_INVALID_COST if the kdf cost of the record is greater
+ *        than \ref DERIVE_COST_MAX.
+ */
+status FN_DECL_MUST_CHECK
+derive_password_check(const derive_context* ctx, const metadata* record)
+{
+    status retval;
+    bool legacy;
+    const char* kdf_name;
+    const char* encoding;
+    uint32_t password_length, cost;
+    unsigned int bits;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_derive_context_valid(ctx));
+    RCPR_MODEL_ASSERT(prop_metadata_valid(record));
+
+    /* legacy records only need a legacy scheme. */
+    retval = metadata_legacy_flag_get(&legacy, record);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    if (legacy)
+    {
+        return (NULL != ctx->legacy) ? STATUS_SUCCESS
+                                     : ERROR_DERIVE_LEGACY_UNAVAILABLE;
+    }
+
+    /* get the record fields that the modes check. */
+    if (STATUS_SUCCESS != (retval = metadata_kdf_name_get(&kdf_name, record))
+     || STATUS_SUCCESS
+            != (retval =
+                    metadata_password_length_get(&password_length, record))
+     || STATUS_SUCCESS != (retval = metadata_encoding_get(&encoding, record))
+     || STATUS_SUCCESS != (retval = derive_encoding_bits_get(&bits, encoding)))
+    {
+        return retval;
+    }
+
+    if (!strcmp(DERIVE_KDF_PBKDF2_SHA3_512, kdf_name))
+    {
+        retval = metadata_kdf_cost_get(&cost, record);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        if (cost > DERIVE_COST_MAX)
+        {
+            return ERROR_DERIVE_INVALID_COST;
+        }
+    }
+    else if (!strcmp(DERIVE_KDF_SESSION_HMAC_SHA3_512, kdf_name))
+    {
+        if (NULL == ctx->session_key)
+        {
+            return ERROR_DERIVE_SESSION_UNAVAILABLE;
+        }
+    }
+    else
+    {
+        return ERROR_DERIVE_UNKNOWN_KDF;
+    }
+
+    /* a password has at least one character. */
+    if (0 == password_length)
+    {
+        return ERROR_DERIVE_INVALID_PASSWORD_LENGTH;
+    }
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,146 @@
+/**
+ * \file derive/derive_password_pbkdf2_sha3_512.c
+ *
+ * \brief Derive a password with PBKDF2 HMAC-SHA3-512.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <openssl/evp.h>
+#include <rcpr/socket_utilities.h>
+#include <string.h>
+
+#include "derive_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Derive the password for a record with PBKDF2 HMAC-SHA3-512.
+ *
+ * \param password      Pointer to receive the password on success.
+ * \param alloc         The allocator to use for the password.
+ * \param ctx           The \ref derive_context for this operation.
+ * \param record        The record to derive.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+derive_password_pbkdf2_sha3_512(
+    secure_buffer** password, RCPR_SYM(allocator)* alloc,
+    const derive_context* ctx, const metadata* record)
+{
+    status retval, release_retval;
+    const void* hash_id;
+    size_t hash_id_size, master_size, salt_size, key_size, password_size;
+    uint32_t version, generation, password_length, iterations;
+    const char* encoding;
+    unsigned int bits;
+    secure_buffer* salt = NULL;
+    secure_buffer* key = NULL;
+    secure_buffer* tmp = NULL;
+    uint8_t* salt_data;
+
+    /* get the record fields that feed the derivation. */
+    if (STATUS_SUCCESS
+            != (retval =
+                    metadata_hash_id_get(&hash_id, &hash_id_size, record))
+     || STATUS_SUCCESS != (retval = metadata_version_get(&version, record))
+     || STATUS_SUCCESS
+            != (retval = metadata_generation_get(&generation, record))
+     || STATUS_SUCCESS
+            != (retval =
+                    metadata_password_length_get(&password_length, record))
+     || STATUS_SUCCESS != (retval = metadata_encoding_get(&encoding, record))
+     || STATUS_SUCCESS != (retval = derive_encoding_bits_get(&bits, encoding))
+     || STATUS_SUCCESS != (retval = metadata_kdf_cost_get(&iterations, record)))
+    {
+        return retval;
+    }
+
+    /* a password has at least one character. */
+    if (0 == password_length)
+    {
+        return ERROR_DERIVE_INVALID_PASSWORD_LENGTH;
+    }
+
+    /* a record without a kdf cost uses the cost of the context. */
+    if (0 == iterations)
+    {
+        iterations = ctx->iterations;
+    }
+    else if (iterations > DERIVE_COST_MAX)
+    {
+        return ERROR_DERIVE_INVALID_COST;
+    }
+
+    /* build the salt. */
+    salt_size = 2 * sizeof(uint32_t) + hash_id_size;
+    retval = secure_buffer_create(&salt, alloc, salt_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    salt_data = (uint8_t*)secure_buffer_data(&salt_size, salt);
+    uint32_t net_version = socket_utility_hton32(version);
+    uint32_t net_generation = socket_utility_hton32(generation);
+    memcpy(salt_data, &net_version, sizeof(net_version));
+    memcpy(salt_data + sizeof(net_version), &net_generation,
+           sizeof(net_generation));
+    memcpy(salt_data + 2 * sizeof(uint32_t), hash_id, hash_id_size);
+
+    /* derive enough key material for every character. */
+    key_size = ((size_t)password_length * bits + 7) / 8;
+    retval = secure_buffer_create(&key, alloc, key_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_salt;
+    }
+
+    const void* master_data = secure_buffer_data(&master_size, ctx->master);
+    uint8_t* key_data = (uint8_t*)secure_buffer_data(&key_size, key);
+    if (1 !=
+            PKCS5_PBKDF2_HMAC(
+                (const char*)master_data, (int)master_size, salt_data,
+                (int)salt_size, (int)iterations, EVP_sha3_512(),
+                (int)key_size, key_data))
+    {
+        retval = ERROR_DERIVE_KDF_FAILED;
+        goto cleanup_key;
+    }
+
+    /* encode the password. */
+    retval = secure_buffer_create(&tmp, alloc, password_length);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_key;
+    }
+
+    derive_encode(
+        (uint8_t*)secure_buffer_data(&password_size, tmp), password_length,
+        key_data, encoding, bits);
+
+    /* success. */
+    *password = tmp;
+    retval = STATUS_SUCCESS;
+
+cleanup_key:
+    release_retval = resource_release(secure_buffer_resource_handle(key));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_salt:
+    release_retval = resource_release(secure_buffer_resource_handle(salt));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
@@ -0,0 +1,153 @@
+/**
+ * \file derive/derive_password_session_hmac_sha3_512.c
+ *
+ * \brief Derive a password with the session key and HMAC-SHA3-512.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <rcpr/socket_utilities.h>
+#include <string.h>
+
+#include "derive_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Derive the password for a record with the session key.
+ *
+ * \param password      Pointer to receive the password on success.
+ * \param alloc         The allocator to use for the password.
+ * \param ctx           The \ref derive_context for this operation.
+ * \param record        The record to derive.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+derive_password_session_hmac_sha3_512(
+    secure_buffer** password, RCPR_SYM(allocator)* alloc,
+    const derive_context* ctx, const metadata* record)
+{
+    status retval, release_retval;
+    const void* hash_id;
+    size_t hash_id_size, message_size, key_size, password_size;
+    uint32_t version, generation, password_length;
+    const char* encoding;
+    unsigned int bits, block_size;
+    secure_buffer* message = NULL;
+    secure_buffer* key = NULL;
+    secure_buffer* tmp = NULL;
+    uint8_t* message_data;
+
+    /* the record stage needs the session stage. */
+    if (NULL == ctx->session_key)
+    {
+        return ERROR_DERIVE_SESSION_UNAVAILABLE;
+    }
+
+    /* get the record fields that feed the derivation. */
+    if (STATUS_SUCCESS
+            != (retval =
+                    metadata_hash_id_get(&hash_id, &hash_id_size, record))
+     || STATUS_SUCCESS != (retval = metadata_version_get(&version, record))
+     || STATUS_SUCCESS
+            != (retval = metadata_generation_get(&generation, record))
+     || STATUS_SUCCESS
+            != (retval =
+                    metadata_password_length_get(&password_length, record))
+     || STATUS_SUCCESS != (retval = metadata_encoding_get(&encoding, record))
+     || STATUS_SUCCESS != (retval = derive_encoding_bits_get(&bits, encoding)))
+    {
+        return retval;
+    }
+
+    /* a password has at least one character. */
+    if (0 == password_length)
+    {
+        return ERROR_DERIVE_INVALID_PASSWORD_LENGTH;
+    }
+
+    /* build the message, leaving room for the block counter up front. */
+    message_size = 4 * sizeof(uint32_t) + hash_id_size;
+    retval = secure_buffer_create(&message, alloc, message_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    message_data = (uint8_t*)secure_buffer_data(&message_size, message);
+    uint32_t fields[3] = {
+        socket_utility_hton32(version),
+        socket_utility_hton32(generation),
+        socket_utility_hton32(password_length) };
+    memcpy(message_data + sizeof(uint32_t), fields, sizeof(fields));
+    memcpy(message_data + 4 * sizeof(uint32_t), hash_id, hash_id_size);
+
+    /* derive whole blocks, enough for every character. */
+    key_size = ((size_t)password_length * bits + 7) / 8;
+    key_size =
+        (key_size + DERIVE_SESSION_KEY_SIZE - 1)
+            / DERIVE_SESSION_KEY_SIZE * DERIVE_SESSION_KEY_SIZE;
+    retval = secure_buffer_create(&key, alloc, key_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_message;
+    }
+
+    uint8_t* key_data = (uint8_t*)secure_buffer_data(&key_size, key);
+    for (size_t offset = 0; offset < key_size;
+         offset += DERIVE_SESSION_KEY_SIZE)
+    {
+        uint32_t counter =
+            socket_utility_hton32(
+                (uint32_t)(offset / DERIVE_SESSION_KEY_SIZE + 1));
+        memcpy(message_data, &counter, sizeof(counter));
+
+        if (NULL ==
+                HMAC(
+                    EVP_sha3_512(), ctx->session_key, DERIVE_SESSION_KEY_SIZE,
+                    message_data, message_size, key_data + offset,
+                    &block_size))
+        {
+            retval = ERROR_DERIVE_KDF_FAILED;
+            goto cleanup_key;
+        }
+    }
+
+    /* encode the password. */
+    retval = secure_buffer_create(&tmp, alloc, password_length);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_key;
+    }
+
+    derive_encode(
+        (uint8_t*)secure_buffer_data(&password_size, tmp), password_length,
+        key_data, encoding, bits);
+
+    /* success. */
+    *password = tmp;
+    retval = STATUS_SUCCESS;
+
+cleanup_key:
+    release_retval = resource_release(secure_buffer_resource_handle(key));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_message:
+    release_retval = resource_release(secure_buffer_resource_handle(message));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
@@ -0,0 +1,27 @@
+/**
+ * \file frozen_metadata/frozen_metadata_acquire.c
+ *
+ * \brief Acquire another reference to a frozen record.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "frozen_metadata_internal.h"
+
+/**
+ * \brief Acquire another reference to a frozen record.
+ *
+ * \param frozen        The \ref frozen_metadata instance to share.
+ *
+ * \returns \p frozen.
+ */
+frozen_metadata*
+frozen_metadata_acquire(
+    frozen_metadata* frozen)
+{
+    /* the caller already holds a reference, so no ordering is needed. */
+    atomic_fetch_add_explicit(&frozen->refcount, 1, memory_order_relaxed);
+
+    return frozen;
+}
@@ -0,0 +1,24 @@
+/**
+ * \file frozen_metadata/frozen_metadata_encoding_get.c
+ *
+ * \brief Get the encoding of a frozen record.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "frozen_metadata_internal.h"
+
+/**
+ * \brief Get the ASCII zero terminated encoding of a frozen record.
+ *
+ * \param frozen        The \ref frozen_metadata instance for this operation.
+ *
+ * \returns the encoding, which is owned by this frozen record.
+ */
+const char*
+frozen_metadata_encoding_get(
+    const frozen_metadata* frozen)
+{
+    return (const char*)frozen->data + frozen->encoding_offset;
+}
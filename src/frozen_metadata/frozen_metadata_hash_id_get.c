@@ -0,0 +1,27 @@
+/**
+ * \file frozen_metadata/frozen_metadata_hash_id_get.c
+ *
+ * \brief Get the hash id of a frozen record.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "frozen_metadata_internal.h"
+
+/**
+ * \brief Get the hash id of a frozen record.
+ *
+ * \param hash_id_size  Pointer to receive the size of the hash id.
+ * \param frozen        The \ref frozen_metadata instance for this operation.
+ *
+ * \returns the hash id, which is owned by this frozen record.
+ */
+const void*
+frozen_metadata_hash_id_get(
+    size_t* hash_id_size, const frozen_metadata* frozen)
+{
+    *hash_id_size = frozen->hash_id_size;
+
+    return frozen->data;
+}
@@ -0,0 +1,61 @@
+/**
+ * \file frozen_metadata/frozen_metadata_internal.h
+ *
+ * \brief Internal header for \ref frozen_metadata.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <nepe2/frozen_metadata.h>
+#include <rcpr/resource/protected.h>
+#include <stdatomic.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief A frozen record is followed in the same allocation by the hash id,
+ * the ASCII zero terminated kdf name, and the ASCII zero terminated encoding.
+ */
+struct frozen_metadata
+{
+    RCPR_SYM(resource) hdr;
+    RCPR_MODEL_STRUCT_TAG(frozen_metadata);
+    RCPR_SYM(allocator)* alloc;
+    size_t size;
+    _Atomic uint32_t refcount;
+    uint32_t version;
+    uint64_t creation_date;
+    uint64_t revocation_date;
+    uint64_t expiration_date;
+    uint32_t password_length;
+    uint32_t generation;
+    uint32_t kdf_cost;
+    uint32_t hash_id_size;
+    uint32_t kdf_name_offset;
+    uint32_t encoding_offset;
+    bool legacy_flag;
+    uint8_t data[];
+};
+
+/**
+ * \brief Release a reference to a \ref frozen_metadata resource.
+ *
+ * \param r             Pointer to the \ref frozen_metadata resource to be
+ *                      released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status frozen_metadata_resource_release(RCPR_SYM(resource)* r);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
@@ -0,0 +1,24 @@
+/**
+ * \file frozen_metadata/frozen_metadata_password_length_get.c
+ *
+ * \brief Get the password length of a frozen record.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "frozen_metadata_internal.h"
+
+/**
+ * \brief Get the password length of a frozen record.
+ *
+ * \param frozen        The \ref frozen_metadata instance for this operation.
+ *
+ * \returns the password length.
+ */
+uint32_t
+frozen_metadata_password_length_get(
+    const frozen_metadata* frozen)
+{
+    return frozen->password_length;
+}
@@ -0,0 +1,26 @@
+/**
+ * \file frozen_metadata/frozen_metadata_resource_handle.c
+ *
+ * \brief Get the resource handle for a frozen record.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "frozen_metadata_internal.h"
+
+/**
+ * \brief Given a \ref frozen_metadata instance, return the resource handle for
+ * this \ref frozen_metadata instance.
+ *
+ * \param frozen        The \ref frozen_metadata instance from which the
+ *                      resource handle is returned.
+ *
+ * \returns the resource handle for this \ref frozen_metadata instance.
+ */
+RCPR_SYM(resource)*
+frozen_metadata_resource_handle(
+    frozen_metadata* frozen)
+{
+    return &frozen->hdr;
+}
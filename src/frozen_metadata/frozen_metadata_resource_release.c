@@ -0,0 +1,47 @@
+/**
+ * \file frozen_metadata/frozen_metadata_resource_release.c
+ *
+ * \brief Release a reference to a \ref frozen_metadata resource.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "frozen_metadata_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Release a reference to a \ref frozen_metadata resource.
+ *
+ * \param r             Pointer to the \ref frozen_metadata resource to be
+ *                      released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status frozen_metadata_resource_release(RCPR_SYM(resource)* r)
+{
+    frozen_metadata* frozen = (frozen_metadata*)r;
+
+    /* drop this reference; only the last reference reclaims the record, and
+     * it must observe every read made through the other references. */
+    if (1
+            != atomic_fetch_sub_explicit(
+                    &frozen->refcount, 1, memory_order_acq_rel))
+    {
+        return STATUS_SUCCESS;
+    }
+
+    /* cache allocator. */
+    allocator* alloc = frozen->alloc;
+
+    /* erase the record, including the packed fields. */
+    RCPR_MODEL_EXEMPT(memset(frozen, 0, frozen->size));
+
+    /* reclaim memory. */
+    return allocator_reclaim(alloc, frozen);
+}
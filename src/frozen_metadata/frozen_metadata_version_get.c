@@ -0,0 +1,24 @@
+/**
+ * \file frozen_metadata/frozen_metadata_version_get.c
+ *
+ * \brief Get the version of a frozen record.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "frozen_metadata_internal.h"
+
+/**
+ * \brief Get the version of a frozen record.
+ *
+ * \param frozen        The \ref frozen_metadata instance for this operation.
+ *
+ * \returns the version.
+ */
+uint32_t
+frozen_metadata_version_get(
+    const frozen_metadata* frozen)
+{
+    return frozen->version;
+}
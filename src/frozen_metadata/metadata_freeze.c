@@ -0,0 +1,134 @@
+/**
+ * \file frozen_metadata/metadata_freeze.c
+ *
+ * \brief Freeze a complete \ref metadata record.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <string.h>
+
+#include "frozen_metadata_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Freeze a complete \ref metadata record.
+ *
+ * \param frozen        Pointer to the frozen record pointer to receive the
+ *                      frozen record on success.
+ * \param alloc         The allocator instance to use for this operation.
+ * \param meta          The record to freeze.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_METADATA_FIELD_NOT_SET if \p meta is empty.
+ */
+status FN_DECL_MUST_CHECK
+metadata_freeze(
+    frozen_metadata** frozen, RCPR_SYM(allocator)* alloc,
+    const metadata* meta)
+{
+    status retval;
+    frozen_metadata* tmp = NULL;
+    const void* hash_id;
+    size_t hash_id_size;
+    const char* kdf_name;
+    const char* encoding;
+    uint32_t version, password_length, generation, kdf_cost;
+    uint64_t creation_date, revocation_date, expiration_date;
+    bool legacy_flag;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != frozen);
+    RCPR_MODEL_ASSERT(prop_allocator_valid(alloc));
+    RCPR_MODEL_ASSERT(prop_metadata_valid(meta));
+
+    /* only complete records can be frozen. */
+    if (metadata_empty_flag_get(meta))
+    {
+        return ERROR_METADATA_FIELD_NOT_SET;
+    }
+
+    /* read every field. */
+    if (STATUS_SUCCESS
+            != (retval = metadata_hash_id_get(&hash_id, &hash_id_size, meta))
+     || STATUS_SUCCESS != (retval = metadata_kdf_name_get(&kdf_name, meta))
+     || STATUS_SUCCESS != (retval = metadata_encoding_get(&encoding, meta))
+     || STATUS_SUCCESS != (retval = metadata_version_get(&version, meta))
+     || STATUS_SUCCESS
+            != (retval = metadata_creation_date_get(&creation_date, meta))
+     || STATUS_SUCCESS
+            != (retval = metadata_revocation_date_get(&revocation_date, meta))
+     || STATUS_SUCCESS
+            != (retval = metadata_expiration_date_get(&expiration_date, meta))
+     || STATUS_SUCCESS
+            != (retval = metadata_password_length_get(&password_length, meta))
+     || STATUS_SUCCESS
+            != (retval = metadata_generation_get(&generation, meta))
+     || STATUS_SUCCESS
+            != (retval = metadata_legacy_flag_get(&legacy_flag, meta))
+     || STATUS_SUCCESS != (retval = metadata_kdf_cost_get(&kdf_cost, meta)))
+    {
+        return retval;
+    }
+
+    /* pack the variable length fields after the record. */
+    size_t kdf_name_size = strlen(kdf_name) + 1;
+    size_t encoding_size = strlen(encoding) + 1;
+    size_t size =
+        sizeof(*tmp) + hash_id_size + kdf_name_size + encoding_size;
+
+    /* allocate the record and its fields at once. */
+    retval = allocator_allocate(alloc, (void**)&tmp, size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(tmp, 0, size));
+
+    /* the tag is not set by default. */
+    RCPR_MODEL_ONLY(tmp->RCPR_MODEL_STRUCT_TAG_REF(frozen_metadata) = 0);
+    RCPR_MODEL_ASSERT_STRUCT_TAG_NOT_INITIALIZED(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(frozen_metadata), frozen_metadata);
+
+    /* set the tag. */
+    RCPR_MODEL_STRUCT_TAG_INIT(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(frozen_metadata), frozen_metadata);
+
+    /* initialize resource. */
+    resource_init(&tmp->hdr, &frozen_metadata_resource_release);
+    tmp->alloc = alloc;
+    tmp->size = size;
+    atomic_init(&tmp->refcount, 1);
+
+    /* copy the fixed size fields. */
+    tmp->version = version;
+    tmp->creation_date = creation_date;
+    tmp->revocation_date = revocation_date;
+    tmp->expiration_date = expiration_date;
+    tmp->password_length = password_length;
+    tmp->generation = generation;
+    tmp->kdf_cost = kdf_cost;
+    tmp->legacy_flag = legacy_flag;
+
+    /* copy the variable length fields. */
+    tmp->hash_id_size = hash_id_size; /* shortening cast. */
+    tmp->kdf_name_offset = hash_id_size;
+    tmp->encoding_offset = hash_id_size + kdf_name_size;
+    memcpy(tmp->data, hash_id, hash_id_size);
+    memcpy(tmp->data + tmp->kdf_name_offset, kdf_name, kdf_name_size);
+    memcpy(tmp->data + tmp->encoding_offset, encoding, encoding_size);
+
+    /* success. */
+    *frozen = tmp;
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,157 @@
+/**
+ * \file live_store/live_store_append.c
+ *
+ * \brief Append records to a \ref live_store.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "live_store_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Append records to a \ref live_store and publish a new snapshot.
+ *
+ * \param ls            The \ref live_store for this operation.
+ * \param records       The records to append.
+ * \param count         The number of records to append.
+ *
+ * \note A record replaces any record with the same hash id and an older or
+ * equal generation, so new generations and revocations are both applied by
+ * appending the updated record. All records in one call are published with a
+ * single pointer swap, so writers should batch records where possible.
+ * Writers are serialized with respect to each other, but never block readers.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_METADATA_FIELD_NOT_SET if a record is empty.
+ *
+ * \pre
+ *      - \p ls must reference a valid \ref live_store instance.
+ *      - \p records must point to \p count valid, non-empty \ref metadata
+ *        instances that were created with the allocator of this live store.
+ * \post
+ *      - On success, the live store takes ownership of every record in
+ *        \p records.
+ *      - On failure, the records are still owned by the caller, and the
+ *        published snapshot is unchanged.
+ */
+status FN_DECL_MUST_CHECK
+live_store_append(
+    live_store* ls, metadata** records, size_t count)
+{
+    status retval, release_retval;
+    live_store_snapshot* old;
+    live_store_snapshot* snap = NULL;
+    metadata** superseded = NULL;
+    size_t superseded_count = 0;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_live_store_valid(ls));
+    RCPR_MODEL_ASSERT(NULL != records || 0 == count);
+
+    /* there is nothing to publish. */
+    if (0 == count)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    pthread_mutex_lock(&ls->writer_lock);
+
+    /* only writers modify the current pointer. */
+    old = atomic_load_explicit(&ls->current, memory_order_relaxed);
+
+    /* create the new snapshot. */
+    retval = live_store_snapshot_create(&snap, ls, old->delta_count + count);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto unlock;
+    }
+
+    /* each appended record supersedes at most one record. */
+    retval =
+        allocator_allocate(
+            ls->alloc, (void**)&superseded, count * sizeof(*superseded));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_snap;
+    }
+
+    /* copy the old delta index. Old entries are unique by hash id. */
+    for (size_t i = 0; i <= old->delta_mask; ++i)
+    {
+        if (NULL != old->delta[i].record)
+        {
+            size_t slot = old->delta[i].hash & snap->delta_mask;
+            while (NULL != snap->delta[slot].record)
+            {
+                slot = (slot + 1) & snap->delta_mask;
+            }
+
+            snap->delta[slot] = old->delta[i];
+        }
+    }
+
+    snap->delta_count = old->delta_count;
+
+    /* insert the new records. */
+    for (size_t i = 0; i < count; ++i)
+    {
+        retval =
+            live_store_delta_insert(
+                snap, superseded, &superseded_count, records[i]);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_superseded;
+        }
+    }
+
+    /* publish the new snapshot. */
+    atomic_store_explicit(&ls->current, snap, memory_order_release);
+
+    /* retire the old snapshot. Readers that announce a later epoch can no
+     * longer see it, or the records it loses to the new snapshot. */
+    old->superseded = superseded;
+    old->superseded_count = superseded_count;
+    old->retire_epoch =
+        atomic_fetch_add_explicit(&ls->epoch, 1, memory_order_seq_cst);
+    old->next = NULL;
+    if (NULL == ls->retired_tail)
+    {
+        ls->retired_head = old;
+    }
+    else
+    {
+        ls->retired_tail->next = old;
+    }
+    ls->retired_tail = old;
+
+    /* the records are now owned by the live store, so a reclaim failure can't
+     * be reported as an append failure. */
+    retval = live_store_reclaim(ls);
+    goto unlock;
+
+cleanup_superseded:
+    release_retval = allocator_reclaim(ls->alloc, superseded);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_snap:
+    /* the delta records belong to the caller or to the old snapshot. */
+    release_retval = live_store_snapshot_release(ls, snap, false);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+unlock:
+    pthread_mutex_unlock(&ls->writer_lock);
+
+    return retval;
+}
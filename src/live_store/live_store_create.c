@@ -0,0 +1,129 @@
+/**
+ * \file live_store/live_store_create.c
+ *
+ * \brief Create a \ref live_store instance.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <string.h>
+
+#include "live_store_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Create a live store from the given base \ref store.
+ *
+ * \param ls            Pointer to the live store pointer to receive the live
+ *                      store on success.
+ * \param alloc         The allocator instance to use for this operation.
+ * \param base          The base \ref store for this live store.
+ *
+ * \note This live store is a \ref resource that must be released by calling
+ * \ref resource_release on its resource handle when it is no longer needed by
+ * the caller. The resource handle can be accessed by calling
+ * \ref live_store_resource_handle on this live store instance. Every
+ * \ref live_store_reader must be released before the live store is released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_LIVE_STORE_MUTEX_INIT_FAILED if the writer lock could not be
+ *        created.
+ *
+ * \pre
+ *      - \p ls must not reference a valid \ref live_store instance and must
+ *        not be NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ *      - \p base must reference a valid \ref store instance.
+ * \post
+ *      - On success, \p ls is set to a pointer to a valid \ref live_store
+ *        instance, which is a \ref resource owned by the caller that must be
+ *        released when no longer needed. The live store takes ownership of
+ *        \p base.
+ *      - On failure, \p ls is not changed, \p base is still owned by the
+ *        caller, and an error status is returned.
+ */
+status FN_DECL_MUST_CHECK
+live_store_create(
+    live_store** ls, RCPR_SYM(allocator)* alloc, store* base)
+{
+    status retval, release_retval;
+    live_store* tmp = NULL;
+    live_store_snapshot* snap = NULL;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != ls);
+    RCPR_MODEL_ASSERT(prop_allocator_valid(alloc));
+    RCPR_MODEL_ASSERT(prop_store_valid(base));
+
+    /* allocate memory for the live store instance. */
+    retval = allocator_allocate(alloc, (void**)&tmp, sizeof(*tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(tmp, 0, sizeof(*tmp)));
+
+    /* the tag is not set by default. */
+    RCPR_MODEL_ONLY(tmp->RCPR_MODEL_STRUCT_TAG_REF(live_store) = 0);
+    RCPR_MODEL_ASSERT_STRUCT_TAG_NOT_INITIALIZED(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(live_store), live_store);
+
+    /* set the tag. */
+    RCPR_MODEL_STRUCT_TAG_INIT(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(live_store), live_store);
+
+    /* initialize resource. */
+    resource_init(&tmp->hdr, &live_store_resource_release);
+    tmp->alloc = alloc;
+    tmp->base = base;
+
+    /* create the initial snapshot, which is just the base store. */
+    retval = live_store_snapshot_create(&snap, tmp, 0);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    /* create the writer lock. */
+    if (0 != pthread_mutex_init(&tmp->writer_lock, NULL))
+    {
+        retval = ERROR_LIVE_STORE_MUTEX_INIT_FAILED;
+        goto cleanup_snap;
+    }
+
+    /* epoch 0 is reserved for offline readers. */
+    atomic_init(&tmp->epoch, LIVE_STORE_READER_OFFLINE + 1);
+    atomic_init(&tmp->current, snap);
+
+    /* success. */
+    *ls = tmp;
+    retval = STATUS_SUCCESS;
+    goto done;
+
+cleanup_snap:
+    release_retval = live_store_snapshot_release(tmp, snap, true);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_tmp:
+    RCPR_MODEL_EXEMPT(memset(tmp, 0, sizeof(*tmp)));
+    release_retval = allocator_reclaim(alloc, tmp);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
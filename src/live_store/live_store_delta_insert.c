@@ -0,0 +1,126 @@
+/**
+ * \file live_store/live_store_delta_insert.c
+ *
+ * \brief Insert a record into a \ref live_store snapshot delta.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "live_store_internal.h"
+
+/**
+ * \brief Insert a record into the delta index of a new snapshot.
+ *
+ * \param snap              The new snapshot.
+ * \param superseded        The array of superseded records.
+ * \param superseded_count  Pointer to the number of superseded records.
+ * \param record            The record to insert.
+ *
+ * \note If this record has an older generation than an existing record with
+ * the same hash id, then it is superseded immediately. It is never visible to
+ * readers, but it is owned by the live store from here on.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+live_store_delta_insert(
+    live_store_snapshot* snap, metadata** superseded, size_t* superseded_count,
+    metadata* record)
+{
+    status retval;
+    const void* hash_id;
+    const void* entry_hash_id;
+    size_t hash_id_size, entry_hash_id_size;
+    uint32_t generation, entry_generation;
+    const metadata* base_record;
+    uint64_t hash;
+    size_t slot;
+
+    /* get the hash id and generation for this record. */
+    retval = metadata_hash_id_get(&hash_id, &hash_id_size, record);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = metadata_generation_get(&generation, record);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    hash = store_hash_id_hash(hash_id, hash_id_size);
+    slot = hash & snap->delta_mask;
+
+    /* linear probe until we find this hash id or an empty entry. */
+    while (NULL != snap->delta[slot].record)
+    {
+        if (snap->delta[slot].hash == hash)
+        {
+            retval =
+                metadata_hash_id_get(
+                    &entry_hash_id, &entry_hash_id_size,
+                    snap->delta[slot].record);
+            if (STATUS_SUCCESS != retval)
+            {
+                return retval;
+            }
+
+            if (entry_hash_id_size == hash_id_size
+             && !memcmp(entry_hash_id, hash_id, hash_id_size))
+            {
+                retval =
+                    metadata_generation_get(
+                        &entry_generation, snap->delta[slot].record);
+                if (STATUS_SUCCESS != retval)
+                {
+                    return retval;
+                }
+
+                /* keep the newest generation. On a tie, the later record. */
+                if (generation >= entry_generation)
+                {
+                    superseded[(*superseded_count)++] =
+                        snap->delta[slot].record;
+                    snap->delta[slot].record = record;
+                }
+                else
+                {
+                    superseded[(*superseded_count)++] = record;
+                }
+
+                return STATUS_SUCCESS;
+            }
+        }
+
+        slot = (slot + 1) & snap->delta_mask;
+    }
+
+    /* a record older than the base record never shadows it. */
+    if (STATUS_SUCCESS
+            == store_lookup_hashed(
+                    &base_record, snap->base, hash, hash_id, hash_id_size))
+    {
+        retval = metadata_generation_get(&entry_generation, base_record);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        if (generation < entry_generation)
+        {
+            superseded[(*superseded_count)++] = record;
+            return STATUS_SUCCESS;
+        }
+    }
+
+    /* insert the record into this empty entry. */
+    snap->delta[slot].hash = hash;
+    snap->delta[slot].record = record;
+    ++snap->delta_count;
+
+    return STATUS_SUCCESS;
+}
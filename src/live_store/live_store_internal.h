@@ -0,0 +1,176 @@
+/**
+ * \file live_store/live_store_internal.h
+ *
+ * \brief Internal header for \ref live_store.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <nepe2/live_store.h>
+#include <pthread.h>
+#include <rcpr/resource/protected.h>
+#include <stdatomic.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief The epoch value of an offline reader.
+ */
+#define LIVE_STORE_READER_OFFLINE                                            0
+
+/**
+ * \brief An entry in the open addressed index of appended records.
+ *
+ * Empty entries have a NULL record.
+ */
+typedef struct live_store_entry live_store_entry;
+
+struct live_store_entry
+{
+    uint64_t hash;
+    metadata* record;
+};
+
+struct live_store_snapshot
+{
+    const store* base;
+    size_t delta_count;
+    size_t delta_mask;
+    live_store_entry* delta;
+    uint64_t retire_epoch;
+    size_t superseded_count;
+    metadata** superseded;
+    live_store_snapshot* next;
+};
+
+struct live_store_reader
+{
+    RCPR_SYM(resource) hdr;
+    RCPR_MODEL_STRUCT_TAG(live_store_reader);
+    live_store* ls;
+    live_store_reader* next;
+    /* keep the announced epoch on its own cache line. */
+    uint8_t pad0[64];
+    _Atomic uint64_t epoch;
+    uint8_t pad1[64 - sizeof(uint64_t)];
+};
+
+struct live_store
+{
+    RCPR_SYM(resource) hdr;
+    RCPR_MODEL_STRUCT_TAG(live_store);
+    RCPR_SYM(allocator)* alloc;
+    store* base;
+    /* read-mostly. */
+    _Atomic(live_store_snapshot*) current;
+    _Atomic uint64_t epoch;
+    /* everything below is protected by the writer lock. */
+    pthread_mutex_t writer_lock;
+    live_store_reader* readers;
+    live_store_snapshot* retired_head;
+    live_store_snapshot* retired_tail;
+};
+
+/**
+ * \brief Release a \ref live_store resource.
+ *
+ * \param r             Pointer to the \ref live_store resource to be released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status live_store_resource_release(RCPR_SYM(resource)* r);
+
+/**
+ * \brief Release a \ref live_store_reader resource.
+ *
+ * \param r             Pointer to the \ref live_store_reader resource to be
+ *                      released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status live_store_reader_resource_release(RCPR_SYM(resource)* r);
+
+/**
+ * \brief Create a snapshot with an empty delta index large enough to hold the
+ * given number of records.
+ *
+ * \param snap          Pointer to receive the snapshot on success.
+ * \param ls            The \ref live_store for this snapshot.
+ * \param count         The number of records this snapshot must hold.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ */
+status FN_DECL_MUST_CHECK
+live_store_snapshot_create(
+    live_store_snapshot** snap, live_store* ls, size_t count);
+
+/**
+ * \brief Release a snapshot that is no longer reachable by any reader.
+ *
+ * \param ls            The \ref live_store that owns this snapshot.
+ * \param snap          The snapshot to release.
+ * \param release_delta If true, also release every record in the delta index.
+ *                      This is only true for the current snapshot when the
+ *                      live store itself is released.
+ *
+ * \note The superseded records of this snapshot are always released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status FN_DECL_MUST_CHECK
+live_store_snapshot_release(
+    live_store* ls, live_store_snapshot* snap, bool release_delta);
+
+/**
+ * \brief Reclaim every retired snapshot that no online reader can still see.
+ *
+ * \param ls            The \ref live_store for this operation.
+ *
+ * \note The writer lock must be held by the caller.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status FN_DECL_MUST_CHECK
+live_store_reclaim(
+    live_store* ls);
+
+/**
+ * \brief Insert a record into the delta index of a new snapshot.
+ *
+ * \param snap              The new snapshot.
+ * \param superseded        The array of superseded records.
+ * \param superseded_count  Pointer to the number of superseded records.
+ * \param record            The record to insert.
+ *
+ * \note If this record has an older generation than an existing record with
+ * the same hash id, then it is superseded immediately. It is never visible to
+ * readers, but it is owned by the live store from here on.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+live_store_delta_insert(
+    live_store_snapshot* snap, metadata** superseded, size_t* superseded_count,
+    metadata* record);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
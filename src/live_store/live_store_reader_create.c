@@ -0,0 +1,90 @@
+/**
+ * \file live_store/live_store_reader_create.c
+ *
+ * \brief Register a \ref live_store_reader with a \ref live_store.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "live_store_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Register a reader with the given \ref live_store.
+ *
+ * \param reader        Pointer to the reader pointer to receive the reader on
+ *                      success.
+ * \param ls            The \ref live_store to read.
+ *
+ * \note This reader is a \ref resource that must be released by calling
+ * \ref resource_release on its resource handle when it is no longer needed by
+ * the caller. The resource handle can be accessed by calling
+ * \ref live_store_reader_resource_handle on this reader instance. A reader
+ * must only be used by one thread at a time. A new reader starts online.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *
+ * \pre
+ *      - \p reader must not reference a valid \ref live_store_reader instance
+ *        and must not be NULL.
+ *      - \p ls must reference a valid \ref live_store instance.
+ * \post
+ *      - On success, \p reader is set to a pointer to a valid
+ *        \ref live_store_reader instance, which is a \ref resource owned by
+ *        the caller that must be released when no longer needed.
+ *      - On failure, \p reader is not changed and an error status is returned.
+ */
+status FN_DECL_MUST_CHECK
+live_store_reader_create(
+    live_store_reader** reader, live_store* ls)
+{
+    status retval;
+    live_store_reader* tmp = NULL;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != reader);
+    RCPR_MODEL_ASSERT(prop_live_store_valid(ls));
+
+    /* allocate memory for the reader. */
+    retval = allocator_allocate(ls->alloc, (void**)&tmp, sizeof(*tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(tmp, 0, sizeof(*tmp)));
+
+    /* the tag is not set by default. */
+    RCPR_MODEL_ONLY(tmp->RCPR_MODEL_STRUCT_TAG_REF(live_store_reader) = 0);
+    RCPR_MODEL_ASSERT_STRUCT_TAG_NOT_INITIALIZED(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(live_store_reader), live_store_reader);
+
+    /* set the tag. */
+    RCPR_MODEL_STRUCT_TAG_INIT(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(live_store_reader), live_store_reader);
+
+    /* initialize resource. */
+    resource_init(&tmp->hdr, &live_store_reader_resource_release);
+    tmp->ls = ls;
+
+    /* register the reader. It starts online at the current epoch. */
+    pthread_mutex_lock(&ls->writer_lock);
+    atomic_init(
+        &tmp->epoch, atomic_load_explicit(&ls->epoch, memory_order_acquire));
+    tmp->next = ls->readers;
+    ls->readers = tmp;
+    pthread_mutex_unlock(&ls->writer_lock);
+
+    /* success. */
+    *reader = tmp;
+    return STATUS_SUCCESS;
+}
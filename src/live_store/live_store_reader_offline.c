@@ -0,0 +1,27 @@
+/**
+ * \file live_store/live_store_reader_offline.c
+ *
+ * \brief Take a \ref live_store_reader offline.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "live_store_internal.h"
+
+/**
+ * \brief Take a reader offline, for instance before it blocks for a long time.
+ *
+ * \param reader        The \ref live_store_reader for this operation.
+ *
+ * \note An offline reader does not hold up reclamation, and must not use any
+ * snapshot or record pointers until it is brought back online with
+ * \ref live_store_reader_online.
+ */
+void
+live_store_reader_offline(
+    live_store_reader* reader)
+{
+    atomic_store_explicit(
+        &reader->epoch, LIVE_STORE_READER_OFFLINE, memory_order_release);
+}
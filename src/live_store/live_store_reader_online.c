@@ -0,0 +1,29 @@
+/**
+ * \file live_store/live_store_reader_online.c
+ *
+ * \brief Bring a \ref live_store_reader back online.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "live_store_internal.h"
+
+/**
+ * \brief Bring an offline reader back online.
+ *
+ * \param reader        The \ref live_store_reader for this operation.
+ */
+void
+live_store_reader_online(
+    live_store_reader* reader)
+{
+    atomic_store_explicit(
+        &reader->epoch,
+        atomic_load_explicit(&reader->ls->epoch, memory_order_acquire),
+        memory_order_relaxed);
+
+    /* pairs with the fence in live_store_reclaim, so that either the writer
+     * sees this reader online or this reader sees the latest snapshot. */
+    atomic_thread_fence(memory_order_seq_cst);
+}
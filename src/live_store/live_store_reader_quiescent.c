@@ -0,0 +1,33 @@
+/**
+ * \file live_store/live_store_reader_quiescent.c
+ *
+ * \brief Announce a quiescent state for a \ref live_store_reader.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "live_store_internal.h"
+
+/**
+ * \brief Announce that this reader holds no snapshot or record pointers.
+ *
+ * \param reader        The \ref live_store_reader for this operation.
+ *
+ * \note Readers should call this between units of work, such as between
+ * requests. Snapshots replaced before this call may be reclaimed afterward.
+ * A reader that stays online without calling this method prevents
+ * reclamation.
+ */
+void
+live_store_reader_quiescent(
+    live_store_reader* reader)
+{
+    /* the acquire load orders any later snapshot load after the publish that
+     * advanced the epoch; the release store orders every earlier snapshot
+     * access before a writer can observe this announcement. */
+    atomic_store_explicit(
+        &reader->epoch,
+        atomic_load_explicit(&reader->ls->epoch, memory_order_acquire),
+        memory_order_release);
+}
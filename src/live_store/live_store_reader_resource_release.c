@@ -0,0 +1,63 @@
+/**
+ * \file live_store/live_store_reader_resource_release.c
+ *
+ * \brief Release a \ref live_store_reader resource.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "live_store_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Release a \ref live_store_reader resource.
+ *
+ * \param r             Pointer to the \ref live_store_reader resource to be
+ *                      released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status live_store_reader_resource_release(RCPR_SYM(resource)* r)
+{
+    status retval, reclaim_retval;
+    live_store_reader** pos;
+
+    live_store_reader* reader = (live_store_reader*)r;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_live_store_reader_valid(reader));
+
+    /* cache the live store. */
+    live_store* ls = reader->ls;
+
+    /* unregister this reader, and reclaim anything it was holding up. */
+    pthread_mutex_lock(&ls->writer_lock);
+    for (pos = &ls->readers; NULL != *pos; pos = &(*pos)->next)
+    {
+        if (reader == *pos)
+        {
+            *pos = reader->next;
+            break;
+        }
+    }
+    retval = live_store_reclaim(ls);
+    pthread_mutex_unlock(&ls->writer_lock);
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(reader, 0, sizeof(*reader)));
+
+    /* reclaim memory. */
+    reclaim_retval = allocator_reclaim(ls->alloc, reader);
+    if (STATUS_SUCCESS != reclaim_retval)
+    {
+        retval = reclaim_retval;
+    }
+
+    return retval;
+}
@@ -0,0 +1,68 @@
+/**
+ * \file live_store/live_store_reclaim.c
+ *
+ * \brief Reclaim retired snapshots of a \ref live_store.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "live_store_internal.h"
+
+/**
+ * \brief Reclaim every retired snapshot that no online reader can still see.
+ *
+ * \param ls            The \ref live_store for this operation.
+ *
+ * \note The writer lock must be held by the caller.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status FN_DECL_MUST_CHECK
+live_store_reclaim(
+    live_store* ls)
+{
+    status retval = STATUS_SUCCESS;
+    status release_retval;
+    uint64_t min_epoch = UINT64_MAX;
+    uint64_t epoch;
+    live_store_snapshot* snap;
+
+    /* pairs with the fence in live_store_reader_online, so that a reader
+     * coming online either is seen here or sees the latest snapshot. */
+    atomic_thread_fence(memory_order_seq_cst);
+
+    /* find the oldest epoch announced by an online reader. */
+    for (live_store_reader* reader = ls->readers; NULL != reader;
+         reader = reader->next)
+    {
+        epoch = atomic_load_explicit(&reader->epoch, memory_order_acquire);
+        if (LIVE_STORE_READER_OFFLINE != epoch && epoch < min_epoch)
+        {
+            min_epoch = epoch;
+        }
+    }
+
+    /* snapshots are retired in epoch order, so stop at the first one that an
+     * online reader may still see. */
+    while (NULL != ls->retired_head
+        && ls->retired_head->retire_epoch < min_epoch)
+    {
+        snap = ls->retired_head;
+        ls->retired_head = snap->next;
+        if (NULL == ls->retired_head)
+        {
+            ls->retired_tail = NULL;
+        }
+
+        release_retval = live_store_snapshot_release(ls, snap, false);
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    return retval;
+}
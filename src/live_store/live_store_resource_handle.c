@@ -0,0 +1,26 @@
+/**
+ * \file live_store/live_store_resource_handle.c
+ *
+ * \brief Get the resource handle for the live store.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "live_store_internal.h"
+
+/**
+ * \brief Given a \ref live_store instance, return the resource handle for this
+ * \ref live_store instance.
+ *
+ * \param ls            The \ref live_store instance from which the resource
+ *                      handle is returned.
+ *
+ * \returns the resource handle for this \ref live_store instance.
+ */
+RCPR_SYM(resource)*
+live_store_resource_handle(
+    live_store* ls)
+{
+    return &ls->hdr;
+}
@@ -0,0 +1,83 @@
+/**
+ * \file live_store/live_store_resource_release.c
+ *
+ * \brief Release a \ref live_store resource.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "live_store_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Release a \ref live_store resource.
+ *
+ * \param r             Pointer to the \ref live_store resource to be released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status live_store_resource_release(RCPR_SYM(resource)* r)
+{
+    status retval = STATUS_SUCCESS;
+    status release_retval;
+    live_store_snapshot* snap;
+
+    live_store* ls = (live_store*)r;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_live_store_valid(ls));
+    RCPR_MODEL_ASSERT(NULL == ls->readers);
+
+    /* cache allocator. */
+    allocator* alloc = ls->alloc;
+
+    /* with no readers left, every retired snapshot can be released. */
+    while (NULL != ls->retired_head)
+    {
+        snap = ls->retired_head;
+        ls->retired_head = snap->next;
+
+        release_retval = live_store_snapshot_release(ls, snap, false);
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    /* release the current snapshot, which owns the live delta records. */
+    snap = atomic_load_explicit(&ls->current, memory_order_relaxed);
+    release_retval = live_store_snapshot_release(ls, snap, true);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    /* release the base store. */
+    release_retval = resource_release(store_resource_handle(ls->base));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    /* destroy the writer lock. */
+    pthread_mutex_destroy(&ls->writer_lock);
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(ls, 0, sizeof(*ls)));
+
+    /* reclaim memory. */
+    release_retval = allocator_reclaim(alloc, ls);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
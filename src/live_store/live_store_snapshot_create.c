@@ -0,0 +1,78 @@
+/**
+ * \file live_store/live_store_snapshot_create.c
+ *
+ * \brief Create an empty \ref live_store_snapshot.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "live_store_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Create a snapshot with an empty delta index large enough to hold the
+ * given number of records.
+ *
+ * \param snap          Pointer to receive the snapshot on success.
+ * \param ls            The \ref live_store for this snapshot.
+ * \param count         The number of records this snapshot must hold.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ */
+status FN_DECL_MUST_CHECK
+live_store_snapshot_create(
+    live_store_snapshot** snap, live_store* ls, size_t count)
+{
+    status retval, release_retval;
+    live_store_snapshot* tmp = NULL;
+    size_t capacity = 16;
+
+    /* keep the load factor at or below 1/2. */
+    while (capacity < 2 * count)
+    {
+        capacity *= 2;
+    }
+
+    /* allocate memory for the snapshot. */
+    retval = allocator_allocate(ls->alloc, (void**)&tmp, sizeof(*tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(tmp, 0, sizeof(*tmp)));
+    tmp->base = ls->base;
+    tmp->delta_mask = capacity - 1;
+
+    /* allocate the delta index. */
+    retval =
+        allocator_allocate(
+            ls->alloc, (void**)&tmp->delta, capacity * sizeof(*tmp->delta));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    RCPR_MODEL_EXEMPT(memset(tmp->delta, 0, capacity * sizeof(*tmp->delta)));
+
+    /* success. */
+    *snap = tmp;
+    return STATUS_SUCCESS;
+
+cleanup_tmp:
+    release_retval = allocator_reclaim(ls->alloc, tmp);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
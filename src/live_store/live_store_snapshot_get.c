@@ -0,0 +1,28 @@
+/**
+ * \file live_store/live_store_snapshot_get.c
+ *
+ * \brief Get the current snapshot of a \ref live_store.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "live_store_internal.h"
+
+/**
+ * \brief Get the current snapshot of a \ref live_store.
+ *
+ * \param reader        The online \ref live_store_reader for this operation.
+ *
+ * \note This performs a single acquire load and no writes. The snapshot, and
+ * every record found through it, remain valid until this reader next calls
+ * \ref live_store_reader_quiescent or \ref live_store_reader_offline.
+ *
+ * \returns the current snapshot.
+ */
+const live_store_snapshot*
+live_store_snapshot_get(
+    const live_store_reader* reader)
+{
+    return atomic_load_explicit(&reader->ls->current, memory_order_acquire);
+}
@@ -0,0 +1,45 @@
+/**
+ * \file live_store/live_store_snapshot_lookup.c
+ *
+ * \brief Look up a record in a \ref live_store_snapshot.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "live_store_internal.h"
+
+/**
+ * \brief Look up a record by hash id in a \ref live_store_snapshot.
+ *
+ * \param meta          Pointer to receive the record on success.
+ * \param snap          The \ref live_store_snapshot for this operation.
+ * \param hash_id       The hash id to look up.
+ * \param hash_id_size  The size of the hash id.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_RECORD_NOT_FOUND if no record matches this hash id.
+ *
+ * \pre
+ *      - \p meta must be a valid pointer.
+ *      - \p snap must be a snapshot returned by \ref live_store_snapshot_get
+ *        that is still valid.
+ *      - \p hash_id must point to a valid memory region that is at least
+ *        \p hash_id_size bytes in length.
+ * \post
+ *      - On success, \p meta is set to the newest generation of the record
+ *        matching this hash id. This record is owned by the live store and
+ *        must not be modified or released by the caller.
+ *      - On failure, \p meta is unchanged.
+ */
+status FN_DECL_MUST_CHECK
+live_store_snapshot_lookup(
+    const metadata** meta, const live_store_snapshot* snap,
+    const void* hash_id, size_t hash_id_size)
+{
+    return
+        live_store_snapshot_lookup_hashed(
+            meta, snap, store_hash_id_hash(hash_id, hash_id_size), hash_id,
+            hash_id_size);
+}
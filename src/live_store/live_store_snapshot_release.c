@@ -0,0 +1,93 @@
+/**
+ * \file live_store/live_store_snapshot_release.c
+ *
+ * \brief Release a \ref live_store_snapshot.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "live_store_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Release a snapshot that is no longer reachable by any reader.
+ *
+ * \param ls            The \ref live_store that owns this snapshot.
+ * \param snap          The snapshot to release.
+ * \param release_delta If true, also release every record in the delta index.
+ *                      This is only true for the current snapshot when the
+ *                      live store itself is released.
+ *
+ * \note The superseded records of this snapshot are always released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status FN_DECL_MUST_CHECK
+live_store_snapshot_release(
+    live_store* ls, live_store_snapshot* snap, bool release_delta)
+{
+    status retval = STATUS_SUCCESS;
+    status release_retval;
+
+    /* release the records in the delta index if requested. */
+    if (release_delta)
+    {
+        for (size_t i = 0; i <= snap->delta_mask; ++i)
+        {
+            if (NULL != snap->delta[i].record)
+            {
+                release_retval =
+                    resource_release(
+                        metadata_resource_handle(snap->delta[i].record));
+                if (STATUS_SUCCESS != release_retval)
+                {
+                    retval = release_retval;
+                }
+            }
+        }
+    }
+
+    /* release the records superseded when this snapshot was replaced. */
+    if (NULL != snap->superseded)
+    {
+        for (size_t i = 0; i < snap->superseded_count; ++i)
+        {
+            release_retval =
+                resource_release(metadata_resource_handle(snap->superseded[i]));
+            if (STATUS_SUCCESS != release_retval)
+            {
+                retval = release_retval;
+            }
+        }
+
+        release_retval = allocator_reclaim(ls->alloc, snap->superseded);
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    /* release the delta index. */
+    release_retval = allocator_reclaim(ls->alloc, snap->delta);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    /* clear and reclaim the snapshot. */
+    RCPR_MODEL_EXEMPT(memset(snap, 0, sizeof(*snap)));
+    release_retval = allocator_reclaim(ls->alloc, snap);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
@@ -0,0 +1,48 @@
+/**
+ * \file live_store/live_store_synchronize.c
+ *
+ * \brief Wait until every replaced snapshot of a \ref live_store is reclaimed.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <sched.h>
+
+#include "live_store_internal.h"
+
+/**
+ * \brief Wait until every replaced snapshot has been reclaimed.
+ *
+ * \param ls            The \ref live_store for this operation.
+ *
+ * \note This blocks until every online reader has announced a quiescent state
+ * after the most recent publish. It must not be called from a thread that owns
+ * an online reader.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status FN_DECL_MUST_CHECK
+live_store_synchronize(
+    live_store* ls)
+{
+    status retval;
+    bool done;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&ls->writer_lock);
+        retval = live_store_reclaim(ls);
+        done = (NULL == ls->retired_head);
+        pthread_mutex_unlock(&ls->writer_lock);
+
+        if (STATUS_SUCCESS != retval || done)
+        {
+            return retval;
+        }
+
+        sched_yield();
+    }
+}
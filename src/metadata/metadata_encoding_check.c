@@ -0,0 +1,62 @@
+/**
+ * \file metadata/metadata_encoding_check.c
+ *
+ * \brief Check that an encoding is supported.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <string.h>
+
+#include "metadata_internal.h"
+
+/**
+ * \brief Check that an encoding is supported, and determine whether it is
+ * symbolic.
+ *
+ * \param symbolic          Pointer to receive the symbolic flag on success.
+ * \param encoding          The encoding to check.
+ * \param encoding_length   The length of this encoding, not including the
+ *                          ASCII zero terminator.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_METADATA_BAD_ENCODING_LENGTH if the length of a non-symbolic
+ *        encoding is not a supported alphabet size.
+ */
+status FN_DECL_MUST_CHECK
+metadata_encoding_check(
+    bool* symbolic, const char* encoding, size_t encoding_length)
+{
+    /* is this a symbolic encoding? */
+    if (encoding_length >= 9 && !memcmp(encoding, "SYMBOLIC-", 9))
+    {
+        *symbolic = true;
+        return STATUS_SUCCESS;
+    }
+
+    switch (encoding_length)
+    {
+        /* binary encoding xlat tables are supported. */
+        case 2:
+        /* base-4 encoding xlat tables are supported. */
+        case 4:
+        /* octal encoding xlat tables are supported. */
+        case 8:
+        /* hex encoding xlat tables are supported. */
+        case 16:
+        /* base-32 encoding xlat tables are supported. */
+        case 32:
+        /* base-64 encoding xlat tables are supported. */
+        case 64:
+        /* base-128 encoding xlat tables are supported. */
+        case 128:
+            *symbolic = false;
+            return STATUS_SUCCESS;
+
+        default:
+            return ERROR_METADATA_BAD_ENCODING_LENGTH;
+    }
+}
@@ -0,0 +1,96 @@
+/**
+ * \file metadata/metadata_encoding_move.c
+ *
+ * \brief Move a secure buffer into the encoding field for a \ref metadata
+ * instance.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+
+#include "metadata_internal.h"
+
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Set the encoding for a given \ref metadata instance, taking ownership
+ * of the given \ref secure_buffer.
+ *
+ * \param meta          The metadata instance for this operation.
+ * \param buffer        The \ref secure_buffer holding the ASCII zero
+ *                      terminated encoding.
+ *
+ * \note If this \ref metadata instance is currently empty, and if this is the
+ * last field to set in order to make it whole, then this setter will make the
+ * instance whole. Unlike \ref metadata_encoding_set, this setter does not copy
+ * the encoding.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_METADATA_INVALID_STRING if the last byte of \p buffer is not its
+ *        only ASCII zero.
+ *      - ERROR_METADATA_BAD_ENCODING_LENGTH if the encoding length is not
+ *        supported.
+ *      - an error code if the previous encoding could not be released.
+ *
+ * \pre
+ *      - \p meta must reference a valid \ref metadata instance.
+ *      - \p buffer must reference a valid \ref secure_buffer instance owned by
+ *        the caller.
+ * \post
+ *      - On success, the \p encoding field for this \ref metadata instance is
+ *        set to \p buffer, which is now owned by this instance.
+ *      - If \p buffer is rejected, \p meta is unchanged and \p buffer is
+ *        released. In every case, the caller no longer owns \p buffer.
+ */
+status FN_DECL_MUST_CHECK
+metadata_encoding_move(
+    metadata* meta, secure_buffer* buffer)
+{
+    status retval, release_retval;
+    secure_buffer* old;
+    size_t length, size;
+    bool symbolic;
+
+    /* verify that this buffer holds a single string. */
+    retval = metadata_string_check(&length, buffer);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto release_buffer;
+    }
+
+    /* verify that this encoding is supported. */
+    retval =
+        metadata_encoding_check(
+            &symbolic, (const char*)secure_buffer_data(&size, buffer), length);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto release_buffer;
+    }
+
+    /* cache the old encoding if set. */
+    old = meta->encoding;
+
+    /* set the new encoding. */
+    meta->symbolic_encoding = symbolic;
+    meta->encoding = buffer;
+
+    /* release the old encoding if set. */
+    if (NULL != old)
+    {
+        return resource_release(secure_buffer_resource_handle(old));
+    }
+
+    return STATUS_SUCCESS;
+
+release_buffer:
+    release_retval = resource_release(secure_buffer_resource_handle(buffer));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
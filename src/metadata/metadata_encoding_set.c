@@ -51,35 +51,11 @@ metadata_encoding_set(
     void* data = NULL;
     size_t data_size = 0U;
 
-    /* is this a symbolic encoding? */
-    if (encoding_length >= 9 && !memcmp(encoding, "SYMBOLIC-", 9))
-    {
-        symbolic = true;
-    }
-    else
+    /* verify that this encoding is supported. */
+    retval = metadata_encoding_check(&symbolic, encoding, encoding_length);
+    if (STATUS_SUCCESS != retval)
     {
-        switch (encoding_length)
-        {
-            /* binary encoding xlat tables are supported. */
-            case 2:
-            /* base-4 encoding xlat tables are supported. */
-            case 4:
-            /* octal encoding xlat tables are supported. */
-            case 8:
-            /* hex encoding xlat tables are supported. */
-            case 16:
-            /* base-32 encoding xlat tables are supported. */
-            case 32:
-            /* base-64 encoding xlat tables are supported. */
-            case 64:
-            /* base-128 encoding xlat tables are supported. */
-            case 128:
-                break;
-
-            default:
-                retval = ERROR_METADATA_BAD_ENCODING_LENGTH;
-                goto done;
-        }
+        goto done;
     }
 
     /* copy the encoding value. */
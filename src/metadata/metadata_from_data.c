@@ -0,0 +1,150 @@
+/**
+ * \file metadata/metadata_from_data.c
+ *
+ * \brief Read a metadata record from a raw memory region.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+
+#include "metadata_internal.h"
+#include "metadata_serial.h"
+
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Read a metadata record from a raw memory region.
+ *
+ * \param meta          Pointer to hold the \ref metadata instance pointer on
+ *                      success.
+ * \param alloc         The allocator to use for this operation.
+ * \param data          Pointer to the serialized record.
+ * \param size          The size of the serialized record.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_METADATA_INVALID_BUFFER_SIZE if the record size is invalid.
+ *      - ERROR_METADATA_UNKNOWN_SERIAL_VERSION if the serial version is not
+ *        supported.
+ *
+ * \pre
+ *      - \p meta must be a valid pointer whose pointer value does not
+ *        reference a valid \ref metadata instance.
+ *      - \p alloc must reference a valid \ref allocator instance.
+ *      - \p data must point to a valid memory region that is at least \p size
+ *        bytes in length.
+ * \post
+ *      - On success, the \p meta pointer is updated to a pointer to a valid
+ *        \ref metadata instance holding the parsed data from \p data.
+ *      - On failure, \p meta is unchanged.
+ */
+status FN_DECL_MUST_CHECK
+metadata_from_data(
+    metadata** meta, RCPR_SYM(allocator)* alloc, const void* data, size_t size)
+{
+    status retval, release_retval;
+    metadata_serial_header header;
+    const uint8_t* bptr = (const uint8_t*)data;
+    metadata* tmp = NULL;
+    secure_buffer* str = NULL;
+
+    /* read and check the header. */
+    retval = metadata_serial_header_read(&header, bptr, size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    bptr += metadata_serial_header_size(header.serial_version);
+
+    /* create a metadata instance. */
+    retval = metadata_create(&tmp, alloc);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* set the fixed size fields. */
+    /* TODO - verify symbolic_encoding against the encoding below. */
+    tmp->version = header.version;
+    tmp->version_populated = true;
+    tmp->creation_date = header.creation_date;
+    tmp->creation_date_populated = true;
+    tmp->revocation_date = header.revocation_date;
+    tmp->revocation_date_populated = true;
+    tmp->expiration_date = header.expiration_date;
+    tmp->expiration_date_populated = true;
+    tmp->password_length = header.password_length;
+    tmp->password_length_populated = true;
+    tmp->generation = header.generation;
+    tmp->generation_populated = true;
+    tmp->legacy_flag = header.legacy_flag ? true : false;
+    tmp->legacy_flag_populated = true;
+    tmp->kdf_cost = header.kdf_cost;
+
+    /* set the hash id. */
+    retval = metadata_hash_id_set(tmp, bptr, header.hash_id_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    bptr += header.hash_id_size;
+
+    /* read and set the kdf name. */
+    retval =
+        metadata_string_field_read(&str, alloc, bptr, header.kdf_name_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    retval = metadata_kdf_name_move(tmp, str);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    bptr += header.kdf_name_size;
+
+    /* read and set the encoding. */
+    retval =
+        metadata_string_field_read(&str, alloc, bptr, header.encoding_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    retval = metadata_encoding_move(tmp, str);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    /* verify that this metadata instance is now valid. */
+    if (metadata_empty_flag_get(tmp))
+    {
+        retval = ERROR_METADATA_FIELD_NOT_SET;
+        goto cleanup_tmp;
+    }
+
+    /* success. */
+    retval = STATUS_SUCCESS;
+    *meta = tmp;
+    tmp = NULL;
+    goto done;
+
+cleanup_tmp:
+    release_retval = resource_release(&tmp->hdr);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
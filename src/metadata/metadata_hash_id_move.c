@@ -0,0 +1,56 @@
+/**
+ * \file metadata/metadata_hash_id_move.c
+ *
+ * \brief Move a secure buffer into the hash_id field for a \ref metadata
+ * instance.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "metadata_internal.h"
+
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Set the hash id for a given \ref metadata instance, taking ownership
+ * of the given \ref secure_buffer.
+ *
+ * \param meta          The metadata instance for this operation.
+ * \param buffer        The \ref secure_buffer holding the hash id.
+ *
+ * \note If this \ref metadata instance is currently empty, and if this is the
+ * last field to set in order to make it whole, then this setter will make the
+ * instance whole. Unlike \ref metadata_hash_id_set_from_secure_buffer, this
+ * setter does not copy the hash id.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code if the previous hash id could not be released.
+ *
+ * \pre
+ *      - \p meta must reference a valid \ref metadata instance.
+ *      - \p buffer must reference a valid \ref secure_buffer instance owned by
+ *        the caller.
+ * \post
+ *      - The \p hash_id field for this \ref metadata instance is set to
+ *        \p buffer, which is now owned by this instance.
+ */
+status FN_DECL_MUST_CHECK
+metadata_hash_id_move(
+    metadata* meta, secure_buffer* buffer)
+{
+    /* cache the old hash_id if set. */
+    secure_buffer* old = meta->hash_id;
+
+    /* set the new hash_id. */
+    meta->hash_id = buffer;
+
+    /* release the old hash_id if set. */
+    if (NULL != old)
+    {
+        return resource_release(secure_buffer_resource_handle(old));
+    }
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,85 @@
+/**
+ * \file metadata/metadata_header_batch_check.c
+ *
+ * \brief Check the fixed headers of a batch of serialized records.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+
+#include "metadata_internal.h"
+#include "metadata_serial.h"
+
+/**
+ * \brief Check the fixed headers of a batch of serialized records, without
+ * reading the records.
+ *
+ * \param bad_index     Pointer to receive the index of the first invalid
+ *                      record on failure.
+ * \param data          The region holding the records.
+ * \param extents       Array of \p count record locations in \p data.
+ * \param count         The number of records.
+ *
+ * \note Each header is checked for the serial version, that the sizes of the
+ * variable length fields add up to the record size, that the string fields are
+ * not too long, and that the encoding size is a supported alphabet size. A
+ * record fails with the status code that \ref metadata_from_data would return,
+ * but no record is allocated. The alphabet size is taken from the serialized
+ * encoding size, so an encoding padded past its terminator, which
+ * \ref metadata_to_buffer never writes, is rejected. Where the CPU supports
+ * SSE4.1, headers are checked four at a time.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS if every header is valid.
+ *      - ERROR_METADATA_INVALID_BUFFER_SIZE if a record size is invalid.
+ *      - ERROR_METADATA_UNKNOWN_SERIAL_VERSION if a serial version is not
+ *        supported.
+ *      - ERROR_METADATA_BAD_ENCODING_LENGTH if an encoding size is not a
+ *        supported alphabet size.
+ *
+ * \pre
+ *      - \p bad_index must be a valid pointer.
+ *      - \p extents must point to \p count extents, each of which lies
+ *        within \p data.
+ * \post
+ *      - On failure, \p bad_index is set to the index of the first invalid
+ *        record. A scrub can resume the check after this record.
+ *      - On success, \p bad_index is unchanged.
+ */
+status FN_DECL_MUST_CHECK
+metadata_header_batch_check(
+    size_t* bad_index, const void* data, const metadata_extent* extents,
+    size_t count)
+{
+    status retval;
+    const uint8_t* bdata = (const uint8_t*)data;
+    size_t i = 0;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != bad_index);
+    RCPR_MODEL_ASSERT(NULL != extents || 0 == count);
+
+#ifdef METADATA_HEADER_BATCH_SSE41
+    /* check whole groups with SSE4.1 if we can. */
+    if (__builtin_cpu_supports("sse4.1"))
+    {
+        i = metadata_header_batch_check_sse41(bdata, extents, count);
+    }
+#endif
+
+    /* check the rest one at a time. */
+    for (; i < count; ++i)
+    {
+        retval =
+            metadata_header_check(bdata + extents[i].offset, extents[i].size);
+        if (STATUS_SUCCESS != retval)
+        {
+            *bad_index = i;
+            return retval;
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,166 @@
+/**
+ * \file metadata/metadata_header_batch_check_sse41.c
+ *
+ * \brief Check the fixed headers of serialized records four at a time.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "metadata_serial.h"
+
+#ifdef METADATA_HEADER_BATCH_SSE41
+/**
+ * \brief Check groups of four headers at a time.
+ *
+ * \param data          The region holding the records.
+ * \param extents       Array of \p count record locations in \p data.
+ * \param count         The number of records.
+ *
+ * \note The fields of each group are gathered into one vector per field with
+ * byte shuffles, which also convert them from big-endian, and then every check
+ * is made on all four lanes at once. A group with a short or oversized record,
+ * or with any failing lane, is left to the scalar check, which reports the
+ * first failing record and its status.
+ *
+ * \returns the number of leading records that passed.
+ */
+__attribute__((target("sse4.1")))
+size_t
+metadata_header_batch_check_sse41(
+    const uint8_t* data, const metadata_extent* extents, size_t count)
+{
+    /* serial version and symbolic flag, from the first 16 bytes. */
+    const __m128i prefix_shuffle =
+        _mm_setr_epi8(
+            3, 2, 1, 0, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    /* hash id, kdf name, and encoding sizes, from the last 16 bytes. */
+    const __m128i sizes_shuffle =
+        _mm_setr_epi8(
+            7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, -1, -1, -1, -1);
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i two = _mm_set1_epi32(2);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i string_max = _mm_set1_epi32(METADATA_SERIAL_STRING_MAX);
+    const __m128i v1_header_size =
+        _mm_set1_epi32(METADATA_SERIAL_V1_HEADER_SIZE);
+    const __m128i v2_header_extra =
+        _mm_set1_epi32(
+            METADATA_SERIAL_V2_HEADER_SIZE - METADATA_SERIAL_V1_HEADER_SIZE);
+    const __m128i alphabet_min = _mm_set1_epi32(2);
+    const __m128i alphabet_max = _mm_set1_epi32(128);
+    const __m128i symbolic_min =
+        _mm_set1_epi32(METADATA_HEADER_BATCH_SYMBOLIC_MIN);
+    __m128i prefix[4], sizes[4];
+    uint32_t record_size[4];
+    size_t i;
+
+    for (i = 0; i + 4 <= count; i += 4)
+    {
+        /* gather one row per record. */
+        for (size_t j = 0; j < 4; ++j)
+        {
+            const uint8_t* record = data + extents[i + j].offset;
+
+            if (extents[i + j].size < METADATA_SERIAL_V1_HEADER_SIZE
+             || extents[i + j].size > UINT32_MAX)
+            {
+                return i;
+            }
+
+            record_size[j] = extents[i + j].size; /* shortening cast. */
+            prefix[j] =
+                _mm_shuffle_epi8(
+                    _mm_loadu_si128((const __m128i*)record), prefix_shuffle);
+            sizes[j] =
+                _mm_shuffle_epi8(
+                    _mm_loadu_si128(
+                        (const __m128i*)
+                            (record
+                                + METADATA_HEADER_BATCH_SIZES_LOAD_OFFSET)),
+                    sizes_shuffle);
+        }
+
+        /* transpose the rows into one vector per field. */
+        __m128i p01 = _mm_unpacklo_epi32(prefix[0], prefix[1]);
+        __m128i p23 = _mm_unpacklo_epi32(prefix[2], prefix[3]);
+        __m128i s01lo = _mm_unpacklo_epi32(sizes[0], sizes[1]);
+        __m128i s23lo = _mm_unpacklo_epi32(sizes[2], sizes[3]);
+        __m128i s01hi = _mm_unpackhi_epi32(sizes[0], sizes[1]);
+        __m128i s23hi = _mm_unpackhi_epi32(sizes[2], sizes[3]);
+        __m128i serial_version = _mm_unpacklo_epi64(p01, p23);
+        __m128i symbolic = _mm_unpackhi_epi64(p01, p23);
+        __m128i hash_id_size = _mm_unpacklo_epi64(s01lo, s23lo);
+        __m128i kdf_name_size = _mm_unpackhi_epi64(s01lo, s23lo);
+        __m128i encoding_size = _mm_unpacklo_epi64(s01hi, s23hi);
+        /* the serial version is supported, and the record holds its
+         * header. */
+        __m128i v2 = _mm_cmpeq_epi32(serial_version, two);
+        __m128i valid =
+            _mm_or_si128(_mm_cmpeq_epi32(serial_version, one), v2);
+        __m128i header_size =
+            _mm_add_epi32(v1_header_size, _mm_and_si128(v2, v2_header_extra));
+        __m128i total_size = _mm_loadu_si128((const __m128i*)record_size);
+        __m128i body_size = _mm_sub_epi32(total_size, header_size);
+        valid =
+            _mm_and_si128(
+                valid,
+                _mm_cmpeq_epi32(
+                    _mm_max_epu32(total_size, header_size), total_size));
+
+        /* the string fields are not too long. */
+        valid =
+            _mm_and_si128(
+                valid,
+                _mm_cmpeq_epi32(
+                    _mm_min_epu32(kdf_name_size, string_max), kdf_name_size));
+        valid =
+            _mm_and_si128(
+                valid,
+                _mm_cmpeq_epi32(
+                    _mm_min_epu32(encoding_size, string_max), encoding_size));
+
+        /* the variable length fields exactly fill the record. */
+        __m128i strings_size = _mm_add_epi32(kdf_name_size, encoding_size);
+        valid =
+            _mm_and_si128(
+                valid,
+                _mm_cmpeq_epi32(
+                    _mm_min_epu32(strings_size, body_size), strings_size));
+        valid =
+            _mm_and_si128(
+                valid,
+                _mm_cmpeq_epi32(
+                    _mm_sub_epi32(body_size, strings_size), hash_id_size));
+
+        /* the alphabet size is supported. */
+        __m128i alphabet = _mm_sub_epi32(encoding_size, one);
+        __m128i alphabet_valid =
+            _mm_and_si128(
+                _mm_cmpeq_epi32(
+                    _mm_and_si128(alphabet, _mm_sub_epi32(alphabet, one)),
+                    zero),
+                _mm_cmpeq_epi32(
+                    _mm_min_epu32(
+                        _mm_max_epu32(alphabet, alphabet_min), alphabet_max),
+                    alphabet));
+        __m128i symbolic_valid =
+            _mm_cmpeq_epi32(
+                _mm_max_epu32(encoding_size, symbolic_min), encoding_size);
+        valid =
+            _mm_and_si128(
+                valid,
+                _mm_blendv_epi8(
+                    symbolic_valid, alphabet_valid,
+                    _mm_cmpeq_epi32(symbolic, zero)));
+
+        /* stop at the first group with an invalid record. */
+        if (0x0f != _mm_movemask_ps(_mm_castsi128_ps(valid)))
+        {
+            return i;
+        }
+    }
+
+    return i;
+}
+#endif
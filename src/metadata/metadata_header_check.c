@@ -0,0 +1,56 @@
+/**
+ * \file metadata/metadata_header_check.c
+ *
+ * \brief Check the fixed header of one serialized record.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+
+#include "metadata_serial.h"
+
+/**
+ * \brief Check the fixed header of a single serialized record.
+ *
+ * \param data          Pointer to the serialized record.
+ * \param size          The size of the serialized record.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+metadata_header_check(
+    const uint8_t* data, size_t size)
+{
+    metadata_serial_header header;
+    uint32_t alphabet;
+    status retval;
+
+    /* check the serial version and the field sizes. */
+    retval = metadata_serial_header_read(&header, data, size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* a symbolic encoding must at least hold its prefix. */
+    if (header.symbolic_encoding)
+    {
+        if (header.encoding_size < METADATA_HEADER_BATCH_SYMBOLIC_MIN)
+        {
+            return ERROR_METADATA_BAD_ENCODING_LENGTH;
+        }
+
+        return STATUS_SUCCESS;
+    }
+
+    /* any other alphabet size must be a power of two from 2 to 128. */
+    alphabet = header.encoding_size - 1;
+    if (alphabet < 2 || alphabet > 128 || (alphabet & (alphabet - 1)))
+    {
+        return ERROR_METADATA_BAD_ENCODING_LENGTH;
+    }
+
+    return STATUS_SUCCESS;
+}
@@ -40,6 +40,7 @@ struct metadata
     uint32_t generation;
     bool legacy_flag_populated;
     bool legacy_flag;
+    uint32_t kdf_cost;
 };
 
 /**
@@ -53,6 +54,40 @@ struct metadata
  */
 status metadata_resource_release(RCPR_SYM(resource)* r);
 
+/**
+ * \brief Check that an encoding is supported, and determine whether it is
+ * symbolic.
+ *
+ * \param symbolic          Pointer to receive the symbolic flag on success.
+ * \param encoding          The encoding to check.
+ * \param encoding_length   The length of this encoding, not including the
+ *                          ASCII zero terminator.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_METADATA_BAD_ENCODING_LENGTH if the length of a non-symbolic
+ *        encoding is not a supported alphabet size.
+ */
+status FN_DECL_MUST_CHECK
+metadata_encoding_check(
+    bool* symbolic, const char* encoding, size_t encoding_length);
+
+/**
+ * \brief Check that a secure buffer holds exactly one ASCII zero terminated
+ * string.
+ *
+ * \param length            Pointer to receive the string length on success.
+ * \param buffer            The buffer to check.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_METADATA_INVALID_STRING if the last byte of this buffer is not
+ *        the only ASCII zero in the buffer.
+ */
+status FN_DECL_MUST_CHECK
+metadata_string_check(
+    size_t* length, secure_buffer* buffer);
+
 /* C++ compatibility. */
 # ifdef   __cplusplus
 }
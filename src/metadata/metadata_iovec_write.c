@@ -0,0 +1,79 @@
+/**
+ * \file metadata/metadata_iovec_write.c
+ *
+ * \brief Write an iovec array to a file descriptor.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <nepe2/error_codes.h>
+#include <nepe2/metadata.h>
+
+#ifndef IOV_MAX
+# define IOV_MAX 1024
+#endif
+
+/**
+ * \brief Write an iovec array to a file descriptor.
+ *
+ * \param fd            The file descriptor to write to.
+ * \param iov           The entries to write.
+ * \param count         The number of entries.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_METADATA_WRITE_FAILED if a write failed.
+ */
+status FN_DECL_MUST_CHECK
+metadata_iovec_write(
+    int fd, struct iovec* iov, size_t count)
+{
+    while (count > 0)
+    {
+        /* skip entries that have been completely written. */
+        if (0 == iov->iov_len)
+        {
+            ++iov;
+            --count;
+            continue;
+        }
+
+        int chunk = count > IOV_MAX ? IOV_MAX : (int)count;
+        ssize_t written = writev(fd, iov, chunk);
+        if (written < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            return ERROR_METADATA_WRITE_FAILED;
+        }
+        else if (0 == written)
+        {
+            return ERROR_METADATA_WRITE_FAILED;
+        }
+
+        /* advance past what was written, resuming any partial entry. */
+        size_t remaining = (size_t)written;
+        while (remaining > 0)
+        {
+            size_t consumed =
+                remaining < iov->iov_len ? remaining : iov->iov_len;
+            iov->iov_base = (uint8_t*)iov->iov_base + consumed;
+            iov->iov_len -= consumed;
+            remaining -= consumed;
+
+            if (0 == iov->iov_len)
+            {
+                ++iov;
+                --count;
+            }
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
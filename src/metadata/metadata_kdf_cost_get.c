@@ -0,0 +1,36 @@
+/**
+ * \file metadata/metadata_kdf_cost_get.c
+ *
+ * \brief Get the kdf cost for a given \ref metadata instance.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "metadata_internal.h"
+
+/**
+ * \brief Get the kdf cost for a given \ref metadata instance.
+ *
+ * \param kdf_cost          Pointer to hold the kdf cost on success.
+ * \param meta              The metadata instance for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *
+ * \pre
+ *      - \p kdf_cost must be a valid pointer.
+ *      - \p meta must reference a valid \ref metadata instance.
+ * \post
+ *      - On success, \p kdf_cost is set to the kdf cost of this instance, which
+ *        is zero if it was never set.
+ *      - On failure, \p kdf_cost is unchanged.
+ */
+status FN_DECL_MUST_CHECK
+metadata_kdf_cost_get(
+    uint32_t* kdf_cost, const metadata* meta)
+{
+    *kdf_cost = meta->kdf_cost;
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,41 @@
+/**
+ * \file metadata/metadata_kdf_cost_set.c
+ *
+ * \brief Set the kdf cost for a given \ref metadata instance.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "metadata_internal.h"
+
+/**
+ * \brief Set the kdf cost for a given \ref metadata instance.
+ *
+ * \param meta              The metadata instance for this operation.
+ * \param kdf_cost          The kdf cost for this operation.
+ *
+ * \note The kdf cost is the work factor the record was created with, which
+ * for the PBKDF2 modes is the iteration count. A record without a kdf cost,
+ * or with a kdf cost of zero, is derived with the cost of the derive context,
+ * and serializes as it did before kdf costs were recorded. Since the kdf cost
+ * is optional, it does not affect whether the instance is whole.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *
+ * \pre
+ *      - \p meta must reference a valid \ref metadata instance.
+ * \post
+ *      - On success, the \p kdf_cost field for this \ref metadata instance is
+ *        set to \p kdf_cost.
+ *      - On failure, \p meta is unchanged.
+ */
+status FN_DECL_MUST_CHECK
+metadata_kdf_cost_set(
+    metadata* meta, uint32_t kdf_cost)
+{
+    meta->kdf_cost = kdf_cost;
+
+    return STATUS_SUCCESS;
+}
@@ -44,7 +44,7 @@ metadata_kdf_name_get(
 
     /* get the data for this buffer. */
     data =
-        (const char*)secure_buffer_data(&size, (secure_buffer*)&meta->kdf_name);
+        (const char*)secure_buffer_data(&size, (secure_buffer*)meta->kdf_name);
 
     /* return the name to the caller. */
     *kdf_name = data;
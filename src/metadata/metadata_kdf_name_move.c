@@ -0,0 +1,81 @@
+/**
+ * \file metadata/metadata_kdf_name_move.c
+ *
+ * \brief Move a secure buffer into the kdf_name field for a \ref metadata
+ * instance.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "metadata_internal.h"
+
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Set the KDF algorithm name for a given \ref metadata instance,
+ * taking ownership of the given \ref secure_buffer.
+ *
+ * \param meta          The metadata instance for this operation.
+ * \param buffer        The \ref secure_buffer holding the ASCII zero
+ *                      terminated kdf name.
+ *
+ * \note If this \ref metadata instance is currently empty, and if this is the
+ * last field to set in order to make it whole, then this setter will make the
+ * instance whole. Unlike \ref metadata_kdf_name_set, this setter does not copy
+ * the kdf name.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_METADATA_INVALID_STRING if the last byte of \p buffer is not its
+ *        only ASCII zero.
+ *      - an error code if the previous kdf name could not be released.
+ *
+ * \pre
+ *      - \p meta must reference a valid \ref metadata instance.
+ *      - \p buffer must reference a valid \ref secure_buffer instance owned by
+ *        the caller.
+ * \post
+ *      - On success, the \p kdf_name field for this \ref metadata instance is
+ *        set to \p buffer, which is now owned by this instance.
+ *      - If \p buffer is rejected, \p meta is unchanged and \p buffer is
+ *        released. In every case, the caller no longer owns \p buffer.
+ */
+status FN_DECL_MUST_CHECK
+metadata_kdf_name_move(
+    metadata* meta, secure_buffer* buffer)
+{
+    status retval, release_retval;
+    secure_buffer* old;
+    size_t length;
+
+    /* verify that this buffer holds a single string. */
+    retval = metadata_string_check(&length, buffer);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto release_buffer;
+    }
+
+    /* cache the old kdf_name if set. */
+    old = meta->kdf_name;
+
+    /* set the new kdf_name. */
+    meta->kdf_name = buffer;
+
+    /* release the old kdf_name if set. */
+    if (NULL != old)
+    {
+        return resource_release(secure_buffer_resource_handle(old));
+    }
+
+    return STATUS_SUCCESS;
+
+release_buffer:
+    release_retval = resource_release(secure_buffer_resource_handle(buffer));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
@@ -0,0 +1,386 @@
+/**
+ * \file metadata/metadata_serial.h
+ *
+ * \brief The serialized layout of \ref metadata records.
+ *
+ * Each serial version declares its fixed header once, as a list of fields.
+ * The header struct, the header size, and the unrolled encoder and decoder
+ * for that header are all generated from this list, so a new serial version
+ * only needs a new field list. Every field is big-endian on the wire.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <nepe2/error_codes.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "metadata_internal.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+# include <immintrin.h>
+# define METADATA_HEADER_BATCH_SSE41                                         1
+#endif
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief The serial version written by \ref metadata_to_buffer for records
+ * without a kdf cost.
+ */
+#define METADATA_SERIAL_VERSION_1                                   0x00000001
+
+/**
+ * \brief The serial version written by \ref metadata_to_buffer for records
+ * with a kdf cost.
+ */
+#define METADATA_SERIAL_VERSION_2                                   0x00000002
+
+/**
+ * \brief The largest kdf name or encoding accepted when reading a record.
+ */
+#define METADATA_SERIAL_STRING_MAX                                        1023
+
+/**
+ * \brief The offset of the variable length field sizes, which is the same in
+ * every serial version, minus four, so that a 16 byte load ends at the end of
+ * a serial version 1 header.
+ */
+#define METADATA_HEADER_BATCH_SIZES_LOAD_OFFSET                             38
+
+/**
+ * \brief The smallest serialized encoding size of a symbolic encoding, which
+ * is the "SYMBOLIC-" prefix and the ASCII zero terminator.
+ */
+#define METADATA_HEADER_BATCH_SYMBOLIC_MIN                                  10
+
+/**
+ * \brief The fixed header for serial version 1.
+ *
+ * The header is followed by the hash id, kdf name, and encoding, whose sizes
+ * are given in the header.
+ */
+#define METADATA_SERIAL_V1_FIELDS(FIELD) \
+    FIELD(u32, serial_version) \
+    FIELD(u8,  symbolic_encoding) \
+    FIELD(u32, version) \
+    FIELD(u64, creation_date) \
+    FIELD(u64, revocation_date) \
+    FIELD(u64, expiration_date) \
+    FIELD(u32, password_length) \
+    FIELD(u32, generation) \
+    FIELD(u8,  legacy_flag) \
+    FIELD(u32, hash_id_size) \
+    FIELD(u32, kdf_name_size) \
+    FIELD(u32, encoding_size)
+
+/**
+ * \brief The fixed header for serial version 2, which appends the kdf cost to
+ * the serial version 1 header, so that the variable length field sizes are in
+ * the same place in both.
+ */
+#define METADATA_SERIAL_V2_FIELDS(FIELD) \
+    METADATA_SERIAL_V1_FIELDS(FIELD) \
+    FIELD(u32, kdf_cost)
+
+/* field types. */
+#define METADATA_SERIAL_TYPE_u8                                         uint8_t
+#define METADATA_SERIAL_TYPE_u32                                       uint32_t
+#define METADATA_SERIAL_TYPE_u64                                       uint64_t
+
+/* field generators. */
+#define METADATA_SERIAL_STRUCT_FIELD(type, name) \
+    METADATA_SERIAL_TYPE_##type name;
+#define METADATA_SERIAL_SIZE_FIELD(type, name) \
+    + sizeof(METADATA_SERIAL_TYPE_##type)
+#define METADATA_SERIAL_ENCODE_FIELD(type, name) \
+    bptr = metadata_serial_put_##type(bptr, header->name);
+#define METADATA_SERIAL_DECODE_FIELD(type, name) \
+    bptr = metadata_serial_get_##type(&header->name, bptr);
+
+/**
+ * \brief The decoded fixed header of any serial version. Fields that are not
+ * in the serial version of a record are zero.
+ */
+typedef struct metadata_serial_header metadata_serial_header;
+
+struct metadata_serial_header
+{
+    METADATA_SERIAL_V2_FIELDS(METADATA_SERIAL_STRUCT_FIELD)
+};
+
+/**
+ * \brief The size of the fixed header for each serial version.
+ */
+enum
+{
+    METADATA_SERIAL_V1_HEADER_SIZE =
+        0 METADATA_SERIAL_V1_FIELDS(METADATA_SERIAL_SIZE_FIELD),
+    METADATA_SERIAL_V2_HEADER_SIZE =
+        0 METADATA_SERIAL_V2_FIELDS(METADATA_SERIAL_SIZE_FIELD)
+};
+
+/* byte order conversion. */
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+# define METADATA_SERIAL_BE32(x)                                           (x)
+# define METADATA_SERIAL_BE64(x)                                           (x)
+#else
+# define METADATA_SERIAL_BE32(x)                          __builtin_bswap32(x)
+# define METADATA_SERIAL_BE64(x)                          __builtin_bswap64(x)
+#endif
+
+/**
+ * \brief Write a uint8_t field, returning the next write position.
+ */
+static inline uint8_t* metadata_serial_put_u8(uint8_t* bptr, uint8_t value)
+{
+    *bptr = value;
+
+    return bptr + sizeof(value);
+}
+
+/**
+ * \brief Write a big-endian uint32_t field, returning the next write position.
+ */
+static inline uint8_t* metadata_serial_put_u32(uint8_t* bptr, uint32_t value)
+{
+    value = METADATA_SERIAL_BE32(value);
+    memcpy(bptr, &value, sizeof(value));
+
+    return bptr + sizeof(value);
+}
+
+/**
+ * \brief Write a big-endian uint64_t field, returning the next write position.
+ */
+static inline uint8_t* metadata_serial_put_u64(uint8_t* bptr, uint64_t value)
+{
+    value = METADATA_SERIAL_BE64(value);
+    memcpy(bptr, &value, sizeof(value));
+
+    return bptr + sizeof(value);
+}
+
+/**
+ * \brief Read a uint8_t field, returning the next read position.
+ */
+static inline const uint8_t* metadata_serial_get_u8(
+    uint8_t* value, const uint8_t* bptr)
+{
+    *value = *bptr;
+
+    return bptr + sizeof(*value);
+}
+
+/**
+ * \brief Read a big-endian uint32_t field, returning the next read position.
+ */
+static inline const uint8_t* metadata_serial_get_u32(
+    uint32_t* value, const uint8_t* bptr)
+{
+    uint32_t net_value;
+    memcpy(&net_value, bptr, sizeof(net_value));
+    *value = METADATA_SERIAL_BE32(net_value);
+
+    return bptr + sizeof(net_value);
+}
+
+/**
+ * \brief Read a big-endian uint64_t field, returning the next read position.
+ */
+static inline const uint8_t* metadata_serial_get_u64(
+    uint64_t* value, const uint8_t* bptr)
+{
+    uint64_t net_value;
+    memcpy(&net_value, bptr, sizeof(net_value));
+    *value = METADATA_SERIAL_BE64(net_value);
+
+    return bptr + sizeof(net_value);
+}
+
+/**
+ * \brief Get the size of the fixed header for a serial version.
+ *
+ * \param serial_version    The serial version.
+ *
+ * \returns the header size, or zero if the serial version is not supported.
+ */
+static inline size_t metadata_serial_header_size(uint32_t serial_version)
+{
+    switch (serial_version)
+    {
+        case METADATA_SERIAL_VERSION_1:
+            return METADATA_SERIAL_V1_HEADER_SIZE;
+
+        case METADATA_SERIAL_VERSION_2:
+            return METADATA_SERIAL_V2_HEADER_SIZE;
+
+        default:
+            return 0;
+    }
+}
+
+/**
+ * \brief Encode a header in the serial version given by the header.
+ *
+ * \param bptr          The output, which must have room for
+ *                      \ref metadata_serial_header_size bytes.
+ * \param header        The header to encode.
+ *
+ * \returns the position just past the encoded header.
+ */
+static inline uint8_t* metadata_serial_header_encode(
+    uint8_t* bptr, const metadata_serial_header* header)
+{
+    if (METADATA_SERIAL_VERSION_2 == header->serial_version)
+    {
+        METADATA_SERIAL_V2_FIELDS(METADATA_SERIAL_ENCODE_FIELD)
+    }
+    else
+    {
+        METADATA_SERIAL_V1_FIELDS(METADATA_SERIAL_ENCODE_FIELD)
+    }
+
+    return bptr;
+}
+
+/**
+ * \brief Read and check the fixed header of a serialized record.
+ *
+ * \param header        The header to decode into.
+ * \param data          Pointer to the serialized record.
+ * \param size          The size of the serialized record.
+ *
+ * \note On success, the variable length fields exactly fill the rest of the
+ * record, and the string fields are not too long.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_METADATA_INVALID_BUFFER_SIZE if the record size is invalid.
+ *      - ERROR_METADATA_UNKNOWN_SERIAL_VERSION if the serial version is not
+ *        supported.
+ */
+static inline status metadata_serial_header_read(
+    metadata_serial_header* header, const uint8_t* data, size_t size)
+{
+    const uint8_t* bptr = data;
+    size_t header_size;
+
+    /* verify that the size is long enough to get the version. */
+    if (size < sizeof(header->serial_version))
+    {
+        return ERROR_METADATA_INVALID_BUFFER_SIZE;
+    }
+
+    /* verify that the serial version is supported. */
+    (void)metadata_serial_get_u32(&header->serial_version, data);
+    header_size = metadata_serial_header_size(header->serial_version);
+    if (0 == header_size)
+    {
+        return ERROR_METADATA_UNKNOWN_SERIAL_VERSION;
+    }
+
+    /* verify that the buffer size is at least the header size. */
+    if (size < header_size)
+    {
+        return ERROR_METADATA_INVALID_BUFFER_SIZE;
+    }
+
+    /* decode the header. */
+    if (METADATA_SERIAL_VERSION_2 == header->serial_version)
+    {
+        METADATA_SERIAL_V2_FIELDS(METADATA_SERIAL_DECODE_FIELD)
+    }
+    else
+    {
+        METADATA_SERIAL_V1_FIELDS(METADATA_SERIAL_DECODE_FIELD)
+        header->kdf_cost = 0;
+    }
+
+    /* verify that the variable length fields exactly fill the record. */
+    if (size - header_size
+            != (size_t)header->hash_id_size + header->kdf_name_size
+                + header->encoding_size
+     || header->kdf_name_size > METADATA_SERIAL_STRING_MAX
+     || header->encoding_size > METADATA_SERIAL_STRING_MAX)
+    {
+        return ERROR_METADATA_INVALID_BUFFER_SIZE;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Fill a header from a complete \ref metadata record.
+ *
+ * \param header        The header to fill.
+ * \param meta          The complete record to describe.
+ *
+ * \note A record with a kdf cost gets a serial version 2 header, and any other
+ * record gets a serial version 1 header.
+ */
+void
+metadata_serial_header_fill(
+    metadata_serial_header* header, const metadata* meta);
+
+/**
+ * \brief Copy a string field into a new ASCII zero terminated secure buffer.
+ *
+ * \param buffer        Pointer to receive the secure buffer on success.
+ * \param alloc         The allocator to use for this operation.
+ * \param data          The serialized string field.
+ * \param size          The size of the serialized string field.
+ *
+ * \note The string ends at the first ASCII zero in the field, if any.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+metadata_string_field_read(
+    secure_buffer** buffer, RCPR_SYM(allocator)* alloc, const uint8_t* data,
+    size_t size);
+
+/**
+ * \brief Check the fixed header of a single serialized record.
+ *
+ * \param data          Pointer to the serialized record.
+ * \param size          The size of the serialized record.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+metadata_header_check(
+    const uint8_t* data, size_t size);
+
+#ifdef METADATA_HEADER_BATCH_SSE41
+/**
+ * \brief Check groups of four headers at a time.
+ *
+ * \param data          The region holding the records.
+ * \param extents       Array of \p count record locations in \p data.
+ * \param count         The number of records.
+ *
+ * \note The fields of each group are gathered into one vector per field with
+ * byte shuffles, which also convert them from big-endian, and then every check
+ * is made on all four lanes at once. A group with a short or oversized record,
+ * or with any failing lane, is left to the scalar check, which reports the
+ * first failing record and its status.
+ *
+ * \returns the number of leading records that passed.
+ */
+__attribute__((target("sse4.1")))
+size_t
+metadata_header_batch_check_sse41(
+    const uint8_t* data, const metadata_extent* extents, size_t count);
+#endif
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
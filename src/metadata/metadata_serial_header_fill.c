@@ -0,0 +1,50 @@
+/**
+ * \file metadata/metadata_serial_header_fill.c
+ *
+ * \brief Fill a serial header from a \ref metadata record.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "metadata_serial.h"
+
+/**
+ * \brief Fill a header from a complete \ref metadata record.
+ *
+ * \param header        The header to fill.
+ * \param meta          The complete record to describe.
+ *
+ * \note A record with a kdf cost gets a serial version 2 header, and any other
+ * record gets a serial version 1 header.
+ */
+void
+metadata_serial_header_fill(
+    metadata_serial_header* header, const metadata* meta)
+{
+    size_t hash_id_size, kdf_name_size, encoding_size;
+
+    /* get the variable length field sizes. */
+    (void)secure_buffer_data(&hash_id_size, meta->hash_id);
+    (void)secure_buffer_data(&kdf_name_size, meta->kdf_name);
+    (void)secure_buffer_data(&encoding_size, meta->encoding);
+
+    header->serial_version =
+        (0 != meta->kdf_cost)
+            ? METADATA_SERIAL_VERSION_2 : METADATA_SERIAL_VERSION_1;
+    header->symbolic_encoding = meta->symbolic_encoding ? 1 : 0;
+    header->version = meta->version;
+    header->creation_date = meta->creation_date;
+    header->revocation_date = meta->revocation_date;
+    header->expiration_date = meta->expiration_date;
+    header->password_length = meta->password_length;
+    header->generation = meta->generation;
+    header->legacy_flag = meta->legacy_flag ? 1 : 0;
+    header->hash_id_size = hash_id_size; /* shortening cast. */
+    header->kdf_name_size = kdf_name_size; /* shortening cast. */
+    header->encoding_size = encoding_size; /* shortening cast. */
+    header->kdf_cost = meta->kdf_cost;
+    RCPR_MODEL_ASSERT(header->hash_id_size == hash_id_size);
+    RCPR_MODEL_ASSERT(header->kdf_name_size == kdf_name_size);
+    RCPR_MODEL_ASSERT(header->encoding_size == encoding_size);
+}
@@ -0,0 +1,44 @@
+/**
+ * \file metadata/metadata_string_check.c
+ *
+ * \brief Check that a secure buffer holds a single ASCII zero terminated
+ * string.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <string.h>
+
+#include "metadata_internal.h"
+
+/**
+ * \brief Check that a secure buffer holds exactly one ASCII zero terminated
+ * string.
+ *
+ * \param length            Pointer to receive the string length on success.
+ * \param buffer            The buffer to check.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_METADATA_INVALID_STRING if the last byte of this buffer is not
+ *        the only ASCII zero in the buffer.
+ */
+status FN_DECL_MUST_CHECK
+metadata_string_check(
+    size_t* length, secure_buffer* buffer)
+{
+    size_t size;
+    const char* data = (const char*)secure_buffer_data(&size, buffer);
+
+    /* the string length must account for every byte but the terminator. */
+    if (size < 1 || 0 != data[size - 1] || strlen(data) != size - 1)
+    {
+        return ERROR_METADATA_INVALID_STRING;
+    }
+
+    *length = size - 1;
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,49 @@
+/**
+ * \file metadata/metadata_string_field_read.c
+ *
+ * \brief Copy a serialized string field into a secure buffer.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "metadata_serial.h"
+
+/**
+ * \brief Copy a string field into a new ASCII zero terminated secure buffer.
+ *
+ * \param buffer        Pointer to receive the secure buffer on success.
+ * \param alloc         The allocator to use for this operation.
+ * \param data          The serialized string field.
+ * \param size          The size of the serialized string field.
+ *
+ * \note The string ends at the first ASCII zero in the field, if any.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+metadata_string_field_read(
+    secure_buffer** buffer, RCPR_SYM(allocator)* alloc, const uint8_t* data,
+    size_t size)
+{
+    status retval;
+    size_t length, buffer_size;
+
+    /* find the string length. */
+    const uint8_t* end = memchr(data, 0, size);
+    length = (NULL != end) ? (size_t)(end - data) : size;
+
+    /* create a zeroed buffer with room for the terminator. */
+    retval = secure_buffer_create(buffer, alloc, length + 1);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* copy the string. */
+    memcpy(secure_buffer_data(&buffer_size, *buffer), data, length);
+
+    return STATUS_SUCCESS;
+}
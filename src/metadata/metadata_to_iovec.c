@@ -0,0 +1,64 @@
+/**
+ * \file metadata/metadata_to_iovec.c
+ *
+ * \brief Describe the serialized form of a metadata record as an iovec array.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+
+#include "metadata_internal.h"
+#include "metadata_serial.h"
+
+_Static_assert(
+    METADATA_IOVEC_SCRATCH_SIZE == METADATA_SERIAL_V2_HEADER_SIZE,
+    "the iovec scratch size must match the largest serial header size.");
+
+/**
+ * \brief Describe the serialized form of a metadata record as an iovec array,
+ * without copying the variable length fields.
+ *
+ * \param iov           Array of \ref METADATA_IOVEC_COUNT entries to fill.
+ * \param scratch       Scratch space of at least
+ *                      \ref METADATA_IOVEC_SCRATCH_SIZE bytes, which receives
+ *                      the fixed size header.
+ * \param size          Pointer to receive the total serialized size.
+ * \param meta          The metadata instance to serialize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_METADATA_FIELD_NOT_SET if \p meta is empty.
+ */
+status FN_DECL_MUST_CHECK
+metadata_to_iovec(
+    struct iovec* iov, void* scratch, size_t* size, const metadata* meta)
+{
+    metadata_serial_header header;
+
+    /* verify that this record is valid (all fields set). */
+    if (metadata_empty_flag_get(meta))
+    {
+        return ERROR_METADATA_FIELD_NOT_SET;
+    }
+
+    /* encode the header into the scratch space. */
+    metadata_serial_header_fill(&header, meta);
+    metadata_serial_header_encode((uint8_t*)scratch, &header);
+    iov[0].iov_base = scratch;
+    iov[0].iov_len = metadata_serial_header_size(header.serial_version);
+
+    /* the variable length fields are written from the record itself. */
+    iov[1].iov_base = secure_buffer_data(&iov[1].iov_len, meta->hash_id);
+    iov[2].iov_base = secure_buffer_data(&iov[2].iov_len, meta->kdf_name);
+    iov[3].iov_base = secure_buffer_data(&iov[3].iov_len, meta->encoding);
+
+    *size =
+        iov[0].iov_len
+      + iov[1].iov_len
+      + iov[2].iov_len
+      + iov[3].iov_len;
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,73 @@
+/**
+ * \file metadata/metadata_to_iovec_batch.c
+ *
+ * \brief Describe many metadata records as one framed iovec array.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+
+#include "metadata_internal.h"
+#include "metadata_serial.h"
+
+_Static_assert(
+    METADATA_IOVEC_FRAMED_SCRATCH_SIZE
+        == sizeof(uint32_t) + METADATA_IOVEC_SCRATCH_SIZE,
+    "the framed scratch size must hold a record size and a header.");
+
+/**
+ * \brief Describe many metadata records as one iovec array, with each record
+ * framed by its size.
+ *
+ * \param iov           Array of \p count * \ref METADATA_IOVEC_COUNT entries
+ *                      to fill.
+ * \param scratch       Scratch space of at least \p count *
+ *                      \ref METADATA_IOVEC_FRAMED_SCRATCH_SIZE bytes.
+ * \param size          Pointer to receive the total size of every framed
+ *                      record.
+ * \param records       The records to serialize.
+ * \param count         The number of records.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_METADATA_FIELD_NOT_SET if any record is empty.
+ */
+status FN_DECL_MUST_CHECK
+metadata_to_iovec_batch(
+    struct iovec* iov, void* scratch, size_t* size,
+    const metadata* const* records, size_t count)
+{
+    status retval;
+    uint8_t* sptr = (uint8_t*)scratch;
+    size_t total = 0U;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t record_size;
+
+        /* the header follows the record size in the scratch space. */
+        retval =
+            metadata_to_iovec(
+                iov, sptr + sizeof(uint32_t), &record_size, records[i]);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        /* extend the header entry to cover the record size. */
+        metadata_serial_put_u32(sptr, record_size); /* shortening cast. */
+        RCPR_MODEL_ASSERT(record_size <= UINT32_MAX);
+        iov[0].iov_base = sptr;
+        iov[0].iov_len += sizeof(uint32_t);
+
+        total += sizeof(uint32_t) + record_size;
+        iov += METADATA_IOVEC_COUNT;
+        sptr += METADATA_IOVEC_FRAMED_SCRATCH_SIZE;
+    }
+
+    *size = total;
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,81 @@
+/**
+ * \file migration_view/migration_view_create.c
+ *
+ * \brief Create a \ref migration_view instance.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "migration_view_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Create an empty migration view.
+ *
+ * \param view          Pointer to the migration view pointer to receive the
+ *                      migration view on success.
+ * \param alloc         The allocator instance to use for this operation.
+ *
+ * \note This migration view is a \ref resource that must be released by
+ * calling \ref resource_release on its resource handle when it is no longer
+ * needed by the caller. The resource handle can be accessed by calling
+ * \ref migration_view_resource_handle on this migration view instance.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *
+ * \pre
+ *      - \p view must not reference a valid \ref migration_view instance and
+ *        must not be NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ * \post
+ *      - On success, \p view is set to a pointer to a valid
+ *        \ref migration_view instance, which is a \ref resource owned by the
+ *        caller that must be released when no longer needed.
+ *      - On failure, \p view is not changed and an error status is returned.
+ */
+status FN_DECL_MUST_CHECK
+migration_view_create(
+    migration_view** view, RCPR_SYM(allocator)* alloc)
+{
+    status retval;
+    migration_view* tmp = NULL;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != view);
+    RCPR_MODEL_ASSERT(prop_allocator_valid(alloc));
+
+    /* allocate memory for the migration view instance. */
+    retval = allocator_allocate(alloc, (void**)&tmp, sizeof(*tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(tmp, 0, sizeof(*tmp)));
+
+    /* the tag is not set by default. */
+    RCPR_MODEL_ONLY(tmp->RCPR_MODEL_STRUCT_TAG_REF(migration_view) = 0);
+    RCPR_MODEL_ASSERT_STRUCT_TAG_NOT_INITIALIZED(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(migration_view), migration_view);
+
+    /* set the tag. */
+    RCPR_MODEL_STRUCT_TAG_INIT(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(migration_view), migration_view);
+
+    /* initialize resource. */
+    resource_init(&tmp->hdr, &migration_view_resource_release);
+    tmp->alloc = alloc;
+
+    /* success. */
+    *view = tmp;
+    return STATUS_SUCCESS;
+}
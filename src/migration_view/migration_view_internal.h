@@ -0,0 +1,45 @@
+/**
+ * \file migration_view/migration_view_internal.h
+ *
+ * \brief Internal header for \ref migration_view.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <nepe2/migration_view.h>
+#include <rcpr/resource/protected.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+struct migration_view
+{
+    RCPR_SYM(resource) hdr;
+    RCPR_MODEL_STRUCT_TAG(migration_view);
+    RCPR_SYM(allocator)* alloc;
+    size_t layer_count;
+    size_t layer_capacity;
+    store** layers;
+};
+
+/**
+ * \brief Release a \ref migration_view resource.
+ *
+ * \param r             Pointer to the \ref migration_view resource to be
+ *                      released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status migration_view_resource_release(RCPR_SYM(resource)* r);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
@@ -0,0 +1,24 @@
+/**
+ * \file migration_view/migration_view_layer_count_get.c
+ *
+ * \brief Get the number of layers in a \ref migration_view.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "migration_view_internal.h"
+
+/**
+ * \brief Get the number of layers in a \ref migration_view instance.
+ *
+ * \param view          The \ref migration_view instance for this operation.
+ *
+ * \returns the number of layers in this migration view.
+ */
+size_t
+migration_view_layer_count_get(
+    const migration_view* view)
+{
+    return view->layer_count;
+}
@@ -0,0 +1,28 @@
+/**
+ * \file migration_view/migration_view_layer_get.c
+ *
+ * \brief Get a layer of a \ref migration_view.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "migration_view_internal.h"
+
+/**
+ * \brief Get a layer of a \ref migration_view instance.
+ *
+ * \param view          The \ref migration_view instance for this operation.
+ * \param layer         The index of the layer, which must be less than the
+ *                      layer count of this view.
+ *
+ * \returns the \ref store for this layer, which is owned by the view.
+ */
+const store*
+migration_view_layer_get(
+    const migration_view* view, size_t layer)
+{
+    RCPR_MODEL_ASSERT(layer < view->layer_count);
+
+    return view->layers[layer];
+}
@@ -0,0 +1,78 @@
+/**
+ * \file migration_view/migration_view_layer_push.c
+ *
+ * \brief Push a new layer onto a \ref migration_view.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "migration_view_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Push a new layer onto a \ref migration_view.
+ *
+ * \param view          The \ref migration_view instance for this operation.
+ * \param layer         The \ref store for this layer, which is newer than every
+ *                      layer already in this view.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *
+ * \pre
+ *      - \p view must reference a valid \ref migration_view instance.
+ *      - \p layer must reference a valid \ref store instance.
+ * \post
+ *      - On success, the migration view takes ownership of \p layer, and its
+ *        layer index is the previous layer count.
+ *      - On failure, \p layer is still owned by the caller.
+ */
+status FN_DECL_MUST_CHECK
+migration_view_layer_push(
+    migration_view* view, store* layer)
+{
+    status retval;
+    store** layers;
+    size_t capacity;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_migration_view_valid(view));
+    RCPR_MODEL_ASSERT(prop_store_valid(layer));
+
+    /* grow the layer array if needed. */
+    if (view->layer_count == view->layer_capacity)
+    {
+        capacity = (0 == view->layer_capacity) ? 4 : 2 * view->layer_capacity;
+
+        if (NULL == view->layers)
+        {
+            retval =
+                allocator_allocate(
+                    view->alloc, (void**)&layers, capacity * sizeof(*layers));
+        }
+        else
+        {
+            layers = view->layers;
+            retval =
+                allocator_reallocate(
+                    view->alloc, (void**)&layers, capacity * sizeof(*layers));
+        }
+
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        view->layers = layers;
+        view->layer_capacity = capacity;
+    }
+
+    /* the new layer is the newest layer. */
+    view->layers[view->layer_count++] = layer;
+
+    return STATUS_SUCCESS;
+}
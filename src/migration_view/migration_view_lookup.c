@@ -0,0 +1,70 @@
+/**
+ * \file migration_view/migration_view_lookup.c
+ *
+ * \brief Look up a record in a \ref migration_view.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+
+#include "migration_view_internal.h"
+
+/**
+ * \brief Look up a record by hash id in the newest layer that contains it.
+ *
+ * \param meta          Pointer to receive the record on success.
+ * \param layer         Pointer to receive the index of the layer that answered
+ *                      on success. Layer 0 is the oldest layer.
+ * \param view          The \ref migration_view instance for this operation.
+ * \param hash_id       The hash id to look up.
+ * \param hash_id_size  The size of the hash id.
+ *
+ * \note The index hash of \p hash_id is computed once and reused to probe
+ * every layer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_RECORD_NOT_FOUND if no layer contains this hash id.
+ *
+ * \pre
+ *      - \p meta and \p layer must be valid pointers.
+ *      - \p view must reference a valid \ref migration_view instance.
+ *      - \p hash_id must point to a valid memory region that is at least
+ *        \p hash_id_size bytes in length.
+ * \post
+ *      - On success, \p meta is set to the newest generation of the record in
+ *        the newest layer containing this hash id, and \p layer is set to the
+ *        index of that layer. This record is owned by the layer and must not
+ *        be modified or released by the caller.
+ *      - On failure, \p meta and \p layer are unchanged.
+ */
+status FN_DECL_MUST_CHECK
+migration_view_lookup(
+    const metadata** meta, size_t* layer, const migration_view* view,
+    const void* hash_id, size_t hash_id_size)
+{
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != meta);
+    RCPR_MODEL_ASSERT(NULL != layer);
+    RCPR_MODEL_ASSERT(prop_migration_view_valid(view));
+
+    /* every layer is indexed with the same hash. */
+    uint64_t hash = store_hash_id_hash(hash_id, hash_id_size);
+
+    /* probe from the newest layer to the oldest. */
+    for (size_t i = view->layer_count; i > 0; --i)
+    {
+        if (STATUS_SUCCESS
+                == store_lookup_hashed(
+                        meta, view->layers[i - 1], hash, hash_id,
+                        hash_id_size))
+        {
+            *layer = i - 1;
+            return STATUS_SUCCESS;
+        }
+    }
+
+    return ERROR_STORE_RECORD_NOT_FOUND;
+}
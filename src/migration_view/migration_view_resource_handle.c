@@ -0,0 +1,26 @@
+/**
+ * \file migration_view/migration_view_resource_handle.c
+ *
+ * \brief Get the resource handle for the migration view.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "migration_view_internal.h"
+
+/**
+ * \brief Given a \ref migration_view instance, return the resource handle for
+ * this \ref migration_view instance.
+ *
+ * \param view          The \ref migration_view instance from which the
+ *                      resource handle is returned.
+ *
+ * \returns the resource handle for this \ref migration_view instance.
+ */
+RCPR_SYM(resource)*
+migration_view_resource_handle(
+    migration_view* view)
+{
+    return &view->hdr;
+}
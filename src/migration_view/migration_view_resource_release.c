@@ -0,0 +1,71 @@
+/**
+ * \file migration_view/migration_view_resource_release.c
+ *
+ * \brief Release a \ref migration_view resource.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "migration_view_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Release a \ref migration_view resource.
+ *
+ * \param r             Pointer to the \ref migration_view resource to be
+ *                      released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status migration_view_resource_release(RCPR_SYM(resource)* r)
+{
+    status release_retval = STATUS_SUCCESS;
+    status retval = STATUS_SUCCESS;
+
+    migration_view* view = (migration_view*)r;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_migration_view_valid(view));
+
+    /* cache allocator. */
+    allocator* alloc = view->alloc;
+
+    /* release each layer. */
+    if (NULL != view->layers)
+    {
+        for (size_t i = 0; i < view->layer_count; ++i)
+        {
+            release_retval =
+                resource_release(store_resource_handle(view->layers[i]));
+            if (STATUS_SUCCESS != release_retval)
+            {
+                retval = release_retval;
+            }
+        }
+
+        release_retval = allocator_reclaim(alloc, view->layers);
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(view, 0, sizeof(*view)));
+
+    /* reclaim memory. */
+    release_retval = allocator_reclaim(alloc, view);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
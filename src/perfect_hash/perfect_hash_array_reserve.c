@@ -0,0 +1,64 @@
+/**
+ * \file perfect_hash/perfect_hash_array_reserve.c
+ *
+ * \brief Grow a \ref perfect_hash_builder array.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "perfect_hash_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Grow an array so that it holds at least the given number of
+ * elements.
+ *
+ * \param alloc         The allocator that owns the array.
+ * \param array         Pointer to the array, which may be NULL.
+ * \param capacity      Pointer to the capacity of the array, in elements.
+ * \param needed        The number of elements needed.
+ * \param element_size  The size of each element.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+perfect_hash_array_reserve(
+    RCPR_SYM(allocator)* alloc, void** array, size_t* capacity, size_t needed,
+    size_t element_size)
+{
+    status retval;
+    void* tmp = *array;
+    size_t new_capacity = (0 == *capacity) ? 64 : *capacity;
+
+    if (needed <= *capacity)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    while (new_capacity < needed)
+    {
+        new_capacity *= 2;
+    }
+
+    if (NULL == tmp)
+    {
+        retval = allocator_allocate(alloc, &tmp, new_capacity * element_size);
+    }
+    else
+    {
+        retval =
+            allocator_reallocate(alloc, &tmp, new_capacity * element_size);
+    }
+
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    *array = tmp;
+    *capacity = new_capacity;
+
+    return STATUS_SUCCESS;
+}
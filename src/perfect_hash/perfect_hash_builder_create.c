@@ -0,0 +1,129 @@
+/**
+ * \file perfect_hash/perfect_hash_builder_create.c
+ *
+ * \brief Create a perfect hash builder.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "perfect_hash_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief The initial number of level entries in a builder.
+ */
+#define PERFECT_HASH_BUILDER_LEVELS                                         16
+
+/**
+ * \brief Create a perfect hash builder.
+ *
+ * \param builder       Pointer to the perfect hash builder pointer to receive
+ *                      the builder on success.
+ * \param alloc         The allocator instance to use for this operation.
+ * \param partition_count   The number of partitions, which must be at least
+ *                      1.
+ *
+ * \note This perfect hash builder is a \ref resource that must be released by
+ * calling \ref resource_release on its resource handle when it is no longer
+ * needed by the caller. The resource handle can be accessed by calling
+ * \ref perfect_hash_builder_resource_handle on this builder instance.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *
+ * \pre
+ *      - \p builder must not reference a valid \ref perfect_hash_builder
+ *        instance and must not be NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ * \post
+ *      - On success, \p builder is set to a pointer to a valid
+ *        \ref perfect_hash_builder instance, which is a \ref resource owned by
+ *        the caller that must be released when no longer needed.
+ *      - On failure, \p builder is not changed and an error status is
+ *        returned.
+ */
+status FN_DECL_MUST_CHECK
+perfect_hash_builder_create(
+    perfect_hash_builder** builder, RCPR_SYM(allocator)* alloc,
+    size_t partition_count)
+{
+    status retval, release_retval;
+    perfect_hash_builder* tmp = NULL;
+    size_t first_size = (partition_count + 1) * sizeof(*tmp->first_level);
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != builder);
+    RCPR_MODEL_ASSERT(prop_allocator_valid(alloc));
+    RCPR_MODEL_ASSERT(partition_count > 0);
+
+    /* allocate memory for the builder instance. */
+    retval = allocator_allocate(alloc, (void**)&tmp, sizeof(*tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(tmp, 0, sizeof(*tmp)));
+
+    /* the tag is not set by default. */
+    RCPR_MODEL_ONLY(tmp->RCPR_MODEL_STRUCT_TAG_REF(perfect_hash_builder) = 0);
+    RCPR_MODEL_ASSERT_STRUCT_TAG_NOT_INITIALIZED(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(perfect_hash_builder),
+        perfect_hash_builder);
+
+    /* set the tag. */
+    RCPR_MODEL_STRUCT_TAG_INIT(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(perfect_hash_builder),
+        perfect_hash_builder);
+
+    /* initialize resource. From here on, releasing tmp cleans up whatever has
+     * been allocated so far. */
+    resource_init(&tmp->hdr, &perfect_hash_builder_resource_release);
+    tmp->alloc = alloc;
+    tmp->partition_count = partition_count;
+
+    /* every partition starts out with no levels. */
+    retval = allocator_allocate(alloc, (void**)&tmp->first_level, first_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    RCPR_MODEL_EXEMPT(memset(tmp->first_level, 0, first_size));
+
+    /* the level table always ends with the word count. */
+    retval =
+        allocator_allocate(
+            alloc, (void**)&tmp->level_offset,
+            PERFECT_HASH_BUILDER_LEVELS * sizeof(*tmp->level_offset));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    tmp->level_capacity = PERFECT_HASH_BUILDER_LEVELS;
+    tmp->level_offset[0] = 0;
+
+    /* success. */
+    *builder = tmp;
+    retval = STATUS_SUCCESS;
+    goto done;
+
+cleanup_tmp:
+    release_retval = resource_release(&tmp->hdr);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
@@ -0,0 +1,115 @@
+/**
+ * \file perfect_hash/perfect_hash_builder_emit.c
+ *
+ * \brief Serialize the perfect hash built by a perfect hash builder.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <rcpr/socket_utilities.h>
+#include <string.h>
+
+#include "perfect_hash_internal.h"
+
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Serialize the perfect hash built by a \ref perfect_hash_builder.
+ *
+ * \param buffer        Pointer to receive the serialized perfect hash on
+ *                      success.
+ * \param alloc         The allocator to use for the buffer.
+ * \param builder       The \ref perfect_hash_builder for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_PERFECT_HASH_BAD_PARTITION if not every partition has been
+ *        added.
+ *
+ * \post
+ *      - On success, \p buffer is set to a \ref secure_buffer owned by the
+ *        caller.
+ *      - On failure, \p buffer is not changed.
+ */
+status FN_DECL_MUST_CHECK
+perfect_hash_builder_emit(
+    secure_buffer** buffer, RCPR_SYM(allocator)* alloc,
+    const perfect_hash_builder* builder)
+{
+    status retval;
+    secure_buffer* tmp = NULL;
+    size_t size;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != buffer);
+    RCPR_MODEL_ASSERT(prop_allocator_valid(alloc));
+    RCPR_MODEL_ASSERT(prop_perfect_hash_builder_valid(builder));
+
+    /* every partition must be present. */
+    if (builder->partition != builder->partition_count)
+    {
+        return ERROR_PERFECT_HASH_BAD_PARTITION;
+    }
+
+    /* compute the size of each section. */
+    size_t first_size =
+        ((builder->partition_count + 1) * sizeof(uint32_t) + 7) & ~(size_t)7;
+    size_t offset_size = (builder->level_count + 1) * sizeof(uint64_t);
+    size_t words_size = builder->word_count * sizeof(uint64_t);
+
+    retval =
+        secure_buffer_create(
+            &tmp, alloc,
+            PERFECT_HASH_HEADER_SIZE + first_size + offset_size + words_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    uint8_t* out = (uint8_t*)secure_buffer_data(&size, tmp);
+    memset(out, 0, size);
+
+    /* write the header. */
+    uint32_t header32[4] = {
+        socket_utility_hton32(PERFECT_HASH_MAGIC),
+        socket_utility_hton32(PERFECT_HASH_FORMAT_VERSION_1),
+        socket_utility_hton32((uint32_t)builder->partition_count), 0 };
+    uint64_t header64[3] = {
+        socket_utility_hton64(builder->key_count),
+        socket_utility_hton64(builder->level_count),
+        socket_utility_hton64(builder->word_count) };
+    memcpy(out, header32, sizeof(header32));
+    memcpy(out + sizeof(header32), header64, sizeof(header64));
+    out += PERFECT_HASH_HEADER_SIZE;
+
+    /* write the first level of each partition. */
+    for (size_t i = 0; i <= builder->partition_count; ++i)
+    {
+        uint32_t value = socket_utility_hton32(builder->first_level[i]);
+        memcpy(out + i * sizeof(value), &value, sizeof(value));
+    }
+    out += first_size;
+
+    /* write the level offsets. */
+    for (size_t i = 0; i <= builder->level_count; ++i)
+    {
+        uint64_t value = socket_utility_hton64(builder->level_offset[i]);
+        memcpy(out + i * sizeof(value), &value, sizeof(value));
+    }
+    out += offset_size;
+
+    /* write the words. */
+    for (size_t i = 0; i < builder->word_count; ++i)
+    {
+        uint64_t value = socket_utility_hton64(builder->words[i]);
+        memcpy(out + i * sizeof(value), &value, sizeof(value));
+    }
+
+    *buffer = tmp;
+
+    return STATUS_SUCCESS;
+}
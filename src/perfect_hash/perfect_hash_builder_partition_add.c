@@ -0,0 +1,263 @@
+/**
+ * \file perfect_hash/perfect_hash_builder_partition_add.c
+ *
+ * \brief Add the keys of the next partition to a perfect hash builder.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <string.h>
+
+#include "perfect_hash_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Add the keys of the next partition to a \ref perfect_hash_builder.
+ *
+ * \param slots         Array of \p count entries to receive the slot of each
+ *                      key on success.
+ * \param builder       The \ref perfect_hash_builder for this operation.
+ * \param keys          The distinct keys of this partition.
+ * \param count         The number of keys.
+ *
+ * \note Partitions are added in order, starting with partition 0, and each key
+ * must be in the partition being added. The slots of a partition are the
+ * \p count slots that follow those of the partitions added before it.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_PERFECT_HASH_BAD_PARTITION if every partition has already been
+ *        added, or if a key is not in this partition.
+ *      - ERROR_PERFECT_HASH_BUILD_FAILED if the keys could not be separated,
+ *        which happens if a key is repeated.
+ *
+ * \post
+ *      - On failure, the builder is unchanged.
+ */
+status FN_DECL_MUST_CHECK
+perfect_hash_builder_partition_add(
+    uint64_t* slots, perfect_hash_builder* builder, const uint64_t* keys,
+    size_t count)
+{
+    status retval, release_retval;
+    uint64_t* remaining = NULL;
+    uint64_t* collide = NULL;
+    uint64_t* ranks = NULL;
+    size_t level_count = 0;
+    size_t word_start = builder->word_count;
+    size_t word_count = builder->word_count;
+    size_t level_start = builder->level_count;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_perfect_hash_builder_valid(builder));
+    RCPR_MODEL_ASSERT(NULL != slots || 0 == count);
+    RCPR_MODEL_ASSERT(NULL != keys || 0 == count);
+
+    /* every key must belong to the next partition. */
+    if (builder->partition >= builder->partition_count)
+    {
+        return ERROR_PERFECT_HASH_BAD_PARTITION;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (keys[i] % builder->partition_count != builder->partition)
+        {
+            return ERROR_PERFECT_HASH_BAD_PARTITION;
+        }
+    }
+
+    /* an empty partition has no levels. */
+    if (0 == count)
+    {
+        goto commit;
+    }
+
+    /* the keys still to be placed, and the collision bits of a level, which
+     * never has more words than the first. */
+    size_t max_words = (count + 63) / 64;
+    retval =
+        allocator_allocate(
+            builder->alloc, (void**)&remaining, count * sizeof(*remaining));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    retval =
+        allocator_allocate(
+            builder->alloc, (void**)&collide, max_words * sizeof(*collide));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_remaining;
+    }
+
+    memcpy(remaining, keys, count * sizeof(*remaining));
+
+    /* build levels until every key has its own bit. New levels are written
+     * past the end of the builder's tables, and only counted once the whole
+     * partition succeeds. */
+    size_t remaining_count = count;
+    while (remaining_count > 0)
+    {
+        if (PERFECT_HASH_MAX_LEVELS == level_count)
+        {
+            retval = ERROR_PERFECT_HASH_BUILD_FAILED;
+            goto cleanup_collide;
+        }
+
+        size_t words = (remaining_count + 63) / 64;
+        uint64_t bits = words * 64;
+
+        retval =
+            perfect_hash_array_reserve(
+                builder->alloc, (void**)&builder->words,
+                &builder->word_capacity, word_count + words,
+                sizeof(*builder->words));
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_collide;
+        }
+
+        retval =
+            perfect_hash_array_reserve(
+                builder->alloc, (void**)&builder->level_offset,
+                &builder->level_capacity, level_start + level_count + 2,
+                sizeof(*builder->level_offset));
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_collide;
+        }
+
+        /* mark the bits hit by one key, and those hit by more than one. */
+        uint64_t* hit = builder->words + word_count;
+        memset(hit, 0, words * sizeof(*hit));
+        memset(collide, 0, words * sizeof(*collide));
+        for (size_t i = 0; i < remaining_count; ++i)
+        {
+            uint64_t pos =
+                perfect_hash_position(remaining[i], level_count, bits);
+            uint64_t mask = UINT64_C(1) << (pos % 64);
+
+            if (hit[pos / 64] & mask)
+            {
+                collide[pos / 64] |= mask;
+            }
+            else
+            {
+                hit[pos / 64] |= mask;
+            }
+        }
+
+        for (size_t i = 0; i < words; ++i)
+        {
+            hit[i] &= ~collide[i];
+        }
+
+        /* the keys that collided move on to the next level. */
+        size_t kept = 0;
+        for (size_t i = 0; i < remaining_count; ++i)
+        {
+            uint64_t pos =
+                perfect_hash_position(remaining[i], level_count, bits);
+
+            if (collide[pos / 64] & (UINT64_C(1) << (pos % 64)))
+            {
+                remaining[kept++] = remaining[i];
+            }
+        }
+
+        remaining_count = kept;
+        builder->level_offset[level_start + level_count] = word_count;
+        word_count += words;
+        ++level_count;
+        builder->level_offset[level_start + level_count] = word_count;
+    }
+
+    /* rank each word within this partition. */
+    retval =
+        allocator_allocate(
+            builder->alloc, (void**)&ranks,
+            (word_count - word_start) * sizeof(*ranks));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_collide;
+    }
+
+    uint64_t rank = 0;
+    for (size_t i = word_start; i < word_count; ++i)
+    {
+        ranks[i - word_start] = rank;
+        rank += (uint64_t)__builtin_popcountll(builder->words[i]);
+    }
+
+    /* each key's slot follows those of the earlier partitions. */
+    for (size_t i = 0; i < count; ++i)
+    {
+        for (size_t level = 0; level < level_count; ++level)
+        {
+            uint64_t begin = builder->level_offset[level_start + level];
+            uint64_t bits =
+                (builder->level_offset[level_start + level + 1] - begin) * 64;
+            uint64_t pos = perfect_hash_position(keys[i], level, bits);
+            uint64_t word = builder->words[begin + pos / 64];
+            uint64_t mask = UINT64_C(1) << (pos % 64);
+
+            if (word & mask)
+            {
+                slots[i] =
+                    builder->key_count + ranks[begin + pos / 64 - word_start]
+                  + (uint64_t)__builtin_popcountll(word & (mask - 1));
+                break;
+            }
+        }
+    }
+
+commit:
+    builder->level_count += level_count;
+    builder->word_count = word_count;
+    builder->key_count += count;
+    builder->first_level[builder->partition + 1] =
+        (uint32_t)builder->level_count;
+    ++builder->partition;
+    retval = STATUS_SUCCESS;
+
+    if (NULL == ranks)
+    {
+        goto cleanup_collide;
+    }
+
+    release_retval = allocator_reclaim(builder->alloc, ranks);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_collide:
+    if (NULL != collide)
+    {
+        release_retval = allocator_reclaim(builder->alloc, collide);
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+cleanup_remaining:
+    if (NULL != remaining)
+    {
+        release_retval = allocator_reclaim(builder->alloc, remaining);
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+done:
+    return retval;
+}
@@ -0,0 +1,65 @@
+/**
+ * \file perfect_hash/perfect_hash_builder_resource_release.c
+ *
+ * \brief Release a \ref perfect_hash_builder resource.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "perfect_hash_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Release a \ref perfect_hash_builder resource.
+ *
+ * \param r             Pointer to the \ref perfect_hash_builder resource to be
+ *                      released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status perfect_hash_builder_resource_release(RCPR_SYM(resource)* r)
+{
+    status release_retval;
+    status retval = STATUS_SUCCESS;
+
+    perfect_hash_builder* builder = (perfect_hash_builder*)r;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_perfect_hash_builder_valid(builder));
+
+    /* cache allocator. */
+    allocator* alloc = builder->alloc;
+
+    /* release the tables. */
+    void* tables[] = {
+        builder->first_level, builder->level_offset, builder->words };
+    for (size_t i = 0; i < sizeof(tables) / sizeof(tables[0]); ++i)
+    {
+        if (NULL != tables[i])
+        {
+            release_retval = allocator_reclaim(alloc, tables[i]);
+            if (STATUS_SUCCESS != release_retval)
+            {
+                retval = release_retval;
+            }
+        }
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(builder, 0, sizeof(*builder)));
+
+    /* reclaim memory. */
+    release_retval = allocator_reclaim(alloc, builder);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
@@ -0,0 +1,246 @@
+/**
+ * \file perfect_hash/perfect_hash_create_from_data.c
+ *
+ * \brief Load a serialized perfect hash.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <string.h>
+
+#include "../metadata/metadata_serial.h"
+#include "perfect_hash_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Load a serialized \ref perfect_hash.
+ *
+ * \param ph            Pointer to the perfect hash pointer to receive the
+ *                      perfect hash on success.
+ * \param alloc         The allocator instance to use for this operation.
+ * \param data          The serialized perfect hash.
+ * \param size          The size of the serialized perfect hash.
+ *
+ * \note The bit arrays are copied, and the rank samples are rebuilt from
+ * them, so the perfect hash does not refer to \p data after it is created.
+ *
+ * This perfect hash is a \ref resource that must be released by calling
+ * \ref resource_release on its resource handle when it is no longer needed by
+ * the caller. The resource handle can be accessed by calling
+ * \ref perfect_hash_resource_handle on this perfect hash instance.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_PERFECT_HASH_INVALID_FORMAT if the data is not a valid
+ *        serialized perfect hash.
+ *
+ * \pre
+ *      - \p ph must not reference a valid \ref perfect_hash instance and must
+ *        not be NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ *      - \p data must point to at least \p size readable bytes.
+ * \post
+ *      - On success, \p ph is set to a pointer to a valid \ref perfect_hash
+ *        instance, which is a \ref resource owned by the caller that must be
+ *        released when no longer needed.
+ *      - On failure, \p ph is not changed and an error status is returned.
+ */
+status FN_DECL_MUST_CHECK
+perfect_hash_create_from_data(
+    perfect_hash** ph, RCPR_SYM(allocator)* alloc, const void* data,
+    size_t size)
+{
+    status retval, release_retval;
+    perfect_hash* tmp = NULL;
+    const uint8_t* in = (const uint8_t*)data;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != ph);
+    RCPR_MODEL_ASSERT(prop_allocator_valid(alloc));
+    RCPR_MODEL_ASSERT(NULL != data || 0 == size);
+
+    /* read the header. */
+    if (size < PERFECT_HASH_HEADER_SIZE)
+    {
+        return ERROR_PERFECT_HASH_INVALID_FORMAT;
+    }
+
+    uint32_t magic, format_version, partition_field, reserved;
+    uint64_t key_count, level_count, word_count;
+    const uint8_t* bptr = in;
+    bptr = metadata_serial_get_u32(&magic, bptr);
+    bptr = metadata_serial_get_u32(&format_version, bptr);
+    bptr = metadata_serial_get_u32(&partition_field, bptr);
+    bptr = metadata_serial_get_u32(&reserved, bptr);
+    bptr = metadata_serial_get_u64(&key_count, bptr);
+    bptr = metadata_serial_get_u64(&level_count, bptr);
+    (void)metadata_serial_get_u64(&word_count, bptr);
+    if (PERFECT_HASH_MAGIC != magic
+     || PERFECT_HASH_FORMAT_VERSION_1 != format_version
+     || 0 != reserved)
+    {
+        return ERROR_PERFECT_HASH_INVALID_FORMAT;
+    }
+
+    uint64_t partition_count = partition_field;
+
+    /* the sections must fill the rest of the data exactly. Each count is
+     * bounded by the size before it is scaled, so nothing overflows. */
+    uint64_t remaining = size - PERFECT_HASH_HEADER_SIZE;
+    if (0 == partition_count
+     || partition_count > remaining / sizeof(uint32_t)
+     || level_count > remaining / sizeof(uint64_t)
+     || word_count > remaining / sizeof(uint64_t))
+    {
+        return ERROR_PERFECT_HASH_INVALID_FORMAT;
+    }
+
+    uint64_t first_size =
+        ((partition_count + 1) * sizeof(uint32_t) + 7) & ~(uint64_t)7;
+    uint64_t offset_size = (level_count + 1) * sizeof(uint64_t);
+    uint64_t words_size = word_count * sizeof(uint64_t);
+    if (first_size + offset_size + words_size != remaining)
+    {
+        return ERROR_PERFECT_HASH_INVALID_FORMAT;
+    }
+
+    /* allocate memory for the perfect hash instance. */
+    retval = allocator_allocate(alloc, (void**)&tmp, sizeof(*tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(tmp, 0, sizeof(*tmp)));
+
+    /* the tag is not set by default. */
+    RCPR_MODEL_ONLY(tmp->RCPR_MODEL_STRUCT_TAG_REF(perfect_hash) = 0);
+    RCPR_MODEL_ASSERT_STRUCT_TAG_NOT_INITIALIZED(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(perfect_hash), perfect_hash);
+
+    /* set the tag. */
+    RCPR_MODEL_STRUCT_TAG_INIT(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(perfect_hash), perfect_hash);
+
+    /* initialize resource. From here on, releasing tmp cleans up whatever has
+     * been allocated so far. */
+    resource_init(&tmp->hdr, &perfect_hash_resource_release);
+    tmp->alloc = alloc;
+    tmp->partition_count = partition_count;
+    tmp->key_count = key_count;
+
+    /* allocate the tables. The word and rank tables always get one spare
+     * entry, so that they are never empty. */
+    size_t rank_count = word_count / PERFECT_HASH_RANK_WORDS + 1;
+    if (STATUS_SUCCESS
+            != (retval =
+                    allocator_allocate(
+                        alloc, (void**)&tmp->first_level,
+                        (partition_count + 1) * sizeof(*tmp->first_level)))
+     || STATUS_SUCCESS
+            != (retval =
+                    allocator_allocate(
+                        alloc, (void**)&tmp->level_offset, offset_size))
+     || STATUS_SUCCESS
+            != (retval =
+                    allocator_allocate(
+                        alloc, (void**)&tmp->words,
+                        words_size + sizeof(*tmp->words)))
+     || STATUS_SUCCESS
+            != (retval =
+                    allocator_allocate(
+                        alloc, (void**)&tmp->ranks,
+                        rank_count * sizeof(*tmp->ranks))))
+    {
+        goto cleanup_tmp;
+    }
+
+    /* each partition's levels follow those of the partition before it, and
+     * no partition has more than the builder would make. */
+    in += PERFECT_HASH_HEADER_SIZE;
+    for (size_t i = 0; i <= partition_count; ++i)
+    {
+        (void)metadata_serial_get_u32(
+            &tmp->first_level[i], in + i * sizeof(uint32_t));
+        if ((0 == i && 0 != tmp->first_level[i])
+         || (i > 0
+          && (tmp->first_level[i] < tmp->first_level[i - 1]
+           || tmp->first_level[i] - tmp->first_level[i - 1]
+                > PERFECT_HASH_MAX_LEVELS)))
+        {
+            retval = ERROR_PERFECT_HASH_INVALID_FORMAT;
+            goto cleanup_tmp;
+        }
+    }
+
+    if (tmp->first_level[partition_count] != level_count)
+    {
+        retval = ERROR_PERFECT_HASH_INVALID_FORMAT;
+        goto cleanup_tmp;
+    }
+
+    /* every level has at least one word, and they end at the word count. */
+    in += first_size;
+    for (size_t i = 0; i <= level_count; ++i)
+    {
+        (void)metadata_serial_get_u64(
+            &tmp->level_offset[i], in + i * sizeof(uint64_t));
+        if ((0 == i && 0 != tmp->level_offset[i])
+         || (i > 0 && tmp->level_offset[i] <= tmp->level_offset[i - 1]))
+        {
+            retval = ERROR_PERFECT_HASH_INVALID_FORMAT;
+            goto cleanup_tmp;
+        }
+    }
+
+    if (tmp->level_offset[level_count] != word_count)
+    {
+        retval = ERROR_PERFECT_HASH_INVALID_FORMAT;
+        goto cleanup_tmp;
+    }
+
+    /* copy the words and sample their ranks. Each set bit is one slot, so
+     * the bits must add up to the key count. */
+    in += offset_size;
+    uint64_t rank = 0;
+    for (size_t i = 0; i < word_count; ++i)
+    {
+        if (0 == i % PERFECT_HASH_RANK_WORDS)
+        {
+            tmp->ranks[i / PERFECT_HASH_RANK_WORDS] = rank;
+        }
+
+        (void)metadata_serial_get_u64(
+            &tmp->words[i], in + i * sizeof(uint64_t));
+        rank += (uint64_t)__builtin_popcountll(tmp->words[i]);
+    }
+
+    tmp->words[word_count] = 0;
+    if (rank != key_count)
+    {
+        retval = ERROR_PERFECT_HASH_INVALID_FORMAT;
+        goto cleanup_tmp;
+    }
+
+    /* success. */
+    *ph = tmp;
+    retval = STATUS_SUCCESS;
+    goto done;
+
+cleanup_tmp:
+    release_retval = resource_release(&tmp->hdr);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
@@ -0,0 +1,138 @@
+/**
+ * \file perfect_hash/perfect_hash_internal.h
+ *
+ * \brief Internal header for \ref perfect_hash.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <nepe2/perfect_hash.h>
+#include <rcpr/resource/protected.h>
+#include <stdint.h>
+#include <string.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief The size of the fixed part of a serialized perfect hash.
+ */
+#define PERFECT_HASH_HEADER_SIZE                                            40
+
+/**
+ * \brief The most levels a partition may have. A partition whose keys are
+ * still not separated after this many levels holds a repeated key.
+ */
+#define PERFECT_HASH_MAX_LEVELS                                             64
+
+/**
+ * \brief The number of words covered by each rank sample.
+ */
+#define PERFECT_HASH_RANK_WORDS                                              8
+
+struct perfect_hash
+{
+    RCPR_SYM(resource) hdr;
+    RCPR_MODEL_STRUCT_TAG(perfect_hash);
+    RCPR_SYM(allocator)* alloc;
+    size_t partition_count;
+    uint64_t key_count;
+    uint32_t* first_level;
+    uint64_t* level_offset;
+    uint64_t* words;
+    uint64_t* ranks;
+};
+
+struct perfect_hash_builder
+{
+    RCPR_SYM(resource) hdr;
+    RCPR_MODEL_STRUCT_TAG(perfect_hash_builder);
+    RCPR_SYM(allocator)* alloc;
+    size_t partition_count;
+    size_t partition;
+    uint64_t key_count;
+    uint32_t* first_level;
+    size_t level_count;
+    size_t level_capacity;
+    uint64_t* level_offset;
+    size_t word_count;
+    size_t word_capacity;
+    uint64_t* words;
+};
+
+/**
+ * \brief Release a \ref perfect_hash resource.
+ *
+ * \param r             Pointer to the \ref perfect_hash resource to be
+ *                      released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status perfect_hash_resource_release(RCPR_SYM(resource)* r);
+
+/**
+ * \brief Release a \ref perfect_hash_builder resource.
+ *
+ * \param r             Pointer to the \ref perfect_hash_builder resource to be
+ *                      released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status perfect_hash_builder_resource_release(RCPR_SYM(resource)* r);
+
+/**
+ * \brief Get the bit of a key in one level of its partition.
+ *
+ * \param key           The key.
+ * \param level         The level within the partition, starting at 0.
+ * \param bits          The number of bits in this level.
+ *
+ * \note Keys in one partition share their value modulo the partition count,
+ * so the key is remixed with a per-level seed before it is reduced. The
+ * reduction takes the high word of a multiply, which avoids a division.
+ *
+ * \returns the bit of this key in this level.
+ */
+static inline uint64_t
+perfect_hash_position(
+    uint64_t key, size_t level, uint64_t bits)
+{
+    uint64_t z = key + (level + 1) * UINT64_C(0x9e3779b97f4a7c15);
+
+    z = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+    z = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+    z ^= z >> 31;
+
+    return (uint64_t)(((__uint128_t)z * bits) >> 64);
+}
+
+/**
+ * \brief Grow an array so that it holds at least the given number of
+ * elements.
+ *
+ * \param alloc         The allocator that owns the array.
+ * \param array         Pointer to the array, which may be NULL.
+ * \param capacity      Pointer to the capacity of the array, in elements.
+ * \param needed        The number of elements needed.
+ * \param element_size  The size of each element.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+perfect_hash_array_reserve(
+    RCPR_SYM(allocator)* alloc, void** array, size_t* capacity, size_t needed,
+    size_t element_size);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
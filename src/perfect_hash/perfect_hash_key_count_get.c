@@ -0,0 +1,27 @@
+/**
+ * \file perfect_hash/perfect_hash_key_count_get.c
+ *
+ * \brief Get the number of keys in a perfect hash.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "perfect_hash_internal.h"
+
+/**
+ * \brief Get the number of keys in a \ref perfect_hash.
+ *
+ * \param ph            The \ref perfect_hash instance for this operation.
+ *
+ * \returns the number of keys, which is also the number of slots.
+ */
+uint64_t
+perfect_hash_key_count_get(
+    const perfect_hash* ph)
+{
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_perfect_hash_valid(ph));
+
+    return ph->key_count;
+}
@@ -0,0 +1,61 @@
+/**
+ * \file perfect_hash/perfect_hash_lookup.c
+ *
+ * \brief Get the slot of a key in a perfect hash.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "perfect_hash_internal.h"
+
+/**
+ * \brief Get the slot of a key in a \ref perfect_hash.
+ *
+ * \param ph            The \ref perfect_hash instance for this operation.
+ * \param key           The key to look up.
+ *
+ * \note A key in the set always gets its own slot. A key that is not in the
+ * set gets either \ref PERFECT_HASH_NOT_FOUND or the slot of some other key,
+ * so the caller must check the entry in the slot.
+ *
+ * \returns the slot of this key, or \ref PERFECT_HASH_NOT_FOUND.
+ */
+uint64_t
+perfect_hash_lookup(
+    const perfect_hash* ph, uint64_t key)
+{
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_perfect_hash_valid(ph));
+
+    size_t partition = key % ph->partition_count;
+    size_t first = ph->first_level[partition];
+    size_t end = ph->first_level[partition + 1];
+
+    /* the key belongs to the first level where its bit is set. */
+    for (size_t level = first; level < end; ++level)
+    {
+        uint64_t begin = ph->level_offset[level];
+        uint64_t bits = (ph->level_offset[level + 1] - begin) * 64;
+        uint64_t pos = perfect_hash_position(key, level - first, bits);
+        uint64_t index = begin + pos / 64;
+        uint64_t mask = UINT64_C(1) << (pos % 64);
+
+        if (ph->words[index] & mask)
+        {
+            /* count the set bits before this one from the nearest sample. */
+            uint64_t rank = ph->ranks[index / PERFECT_HASH_RANK_WORDS];
+            for (uint64_t i = index & ~(uint64_t)(PERFECT_HASH_RANK_WORDS - 1);
+                 i < index; ++i)
+            {
+                rank += (uint64_t)__builtin_popcountll(ph->words[i]);
+            }
+
+            return
+                rank + (uint64_t)__builtin_popcountll(
+                            ph->words[index] & (mask - 1));
+        }
+    }
+
+    return PERFECT_HASH_NOT_FOUND;
+}
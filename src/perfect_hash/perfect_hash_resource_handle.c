@@ -0,0 +1,26 @@
+/**
+ * \file perfect_hash/perfect_hash_resource_handle.c
+ *
+ * \brief Get the resource handle for the perfect hash.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "perfect_hash_internal.h"
+
+/**
+ * \brief Given a \ref perfect_hash instance, return the resource handle for
+ * this \ref perfect_hash instance.
+ *
+ * \param ph            The \ref perfect_hash instance from which the resource
+ *                      handle is returned.
+ *
+ * \returns the resource handle for this \ref perfect_hash instance.
+ */
+RCPR_SYM(resource)*
+perfect_hash_resource_handle(
+    perfect_hash* ph)
+{
+    return &ph->hdr;
+}
@@ -0,0 +1,50 @@
+/**
+ * \file secure_buffer/secure_buffer_builder_append.c
+ *
+ * \brief Append bytes to a secure buffer builder.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "secure_buffer_internal.h"
+
+/**
+ * \brief Append a copy of the given bytes to a \ref secure_buffer_builder.
+ *
+ * \param builder       The \ref secure_buffer_builder for this operation.
+ * \param data          The bytes to append.
+ * \param size          The number of bytes to append.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ */
+status FN_DECL_MUST_CHECK
+secure_buffer_builder_append(
+    secure_buffer_builder* builder, const void* data, size_t size)
+{
+    status retval;
+    void* region;
+
+    /* there is nothing to do for an empty append. */
+    if (0 == size)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    /* extend the builder. */
+    retval = secure_buffer_builder_extend(&region, builder, size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* copy the data into place. */
+    memcpy(region, data, size);
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,41 @@
+/**
+ * \file secure_buffer/secure_buffer_builder_consume.c
+ *
+ * \brief Remove bytes from the front of a secure buffer builder.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "secure_buffer_internal.h"
+
+/**
+ * \brief Remove bytes from the front of a \ref secure_buffer_builder.
+ *
+ * \param builder       The \ref secure_buffer_builder for this operation.
+ * \param size          The number of bytes to remove, which must not be
+ *                      greater than the size of this builder.
+ */
+void
+secure_buffer_builder_consume(
+    secure_buffer_builder* builder, size_t size)
+{
+    RCPR_MODEL_ASSERT(size <= builder->size);
+
+    if (0 == size)
+    {
+        return;
+    }
+
+    /* move the remaining bytes to the front. */
+    uint8_t* data = (uint8_t*)builder->data;
+    size_t remaining = builder->size - size;
+    memmove(data, data + size, remaining);
+
+    /* erase the vacated bytes. */
+    RCPR_MODEL_EXEMPT(memset(data + remaining, 0, size));
+    builder->size = remaining;
+}
@@ -0,0 +1,94 @@
+/**
+ * \file secure_buffer/secure_buffer_builder_create.c
+ *
+ * \brief Create a secure buffer builder instance.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "secure_buffer_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Create a secure buffer builder using the given allocator.
+ *
+ * \param builder       Pointer to the pointer to receive the builder on
+ *                      success.
+ * \param alloc         The allocator instance to use for this operation.
+ * \param capacity      The initial capacity of this builder, which may be 0.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ */
+status FN_DECL_MUST_CHECK
+secure_buffer_builder_create(
+    secure_buffer_builder** builder, RCPR_SYM(allocator)* alloc,
+    size_t capacity)
+{
+    status retval, release_retval;
+    secure_buffer_builder* tmp = NULL;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != builder);
+    RCPR_MODEL_ASSERT(prop_allocator_valid(alloc));
+
+    /* allocate memory for the builder struct. */
+    retval = allocator_allocate(alloc, (void**)&tmp, sizeof(*tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(tmp, 0, sizeof(*tmp)));
+
+    /* the tag is not set by default. */
+    RCPR_MODEL_ONLY(tmp->RCPR_MODEL_STRUCT_TAG_REF(secure_buffer_builder) = 0);
+    RCPR_MODEL_ASSERT_STRUCT_TAG_NOT_INITIALIZED(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(secure_buffer_builder),
+        secure_buffer_builder);
+
+    /* set the tag. */
+    RCPR_MODEL_STRUCT_TAG_INIT(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(secure_buffer_builder),
+        secure_buffer_builder);
+
+    /* initialize resource. */
+    resource_init(&tmp->hdr, &secure_buffer_builder_resource_release);
+    tmp->alloc = alloc;
+    tmp->size = 0;
+    tmp->capacity = 0;
+    tmp->data = NULL;
+
+    /* reserve the initial capacity. */
+    if (capacity > 0)
+    {
+        retval = secure_buffer_builder_reserve(tmp, capacity);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_tmp;
+        }
+    }
+
+    /* success. */
+    *builder = tmp;
+    retval = STATUS_SUCCESS;
+    goto done;
+
+cleanup_tmp:
+    release_retval = resource_release(&tmp->hdr);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
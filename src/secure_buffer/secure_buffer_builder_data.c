@@ -0,0 +1,28 @@
+/**
+ * \file secure_buffer/secure_buffer_builder_data.c
+ *
+ * \brief Get the data pointer and size of a secure buffer builder.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "secure_buffer_internal.h"
+
+/**
+ * \brief Given a \ref secure_buffer_builder instance, return the data pointer
+ * and size.
+ *
+ * \param size          Pointer to the size variable to receive the size.
+ * \param builder       The \ref secure_buffer_builder instance to access.
+ *
+ * \returns the data pointer for this builder.
+ */
+void*
+secure_buffer_builder_data(
+    size_t* size, secure_buffer_builder* builder)
+{
+    *size = builder->size;
+
+    return builder->data;
+}
@@ -0,0 +1,46 @@
+/**
+ * \file secure_buffer/secure_buffer_builder_extend.c
+ *
+ * \brief Extend a secure buffer builder in place.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdint.h>
+
+#include "secure_buffer_internal.h"
+
+/**
+ * \brief Extend a \ref secure_buffer_builder by the given number of bytes,
+ * returning the new region so that it can be written in place.
+ *
+ * \param data          Pointer to receive the start of the new region, which
+ *                      is zeroed.
+ * \param builder       The \ref secure_buffer_builder for this operation.
+ * \param size          The number of bytes to extend this builder by.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ */
+status FN_DECL_MUST_CHECK
+secure_buffer_builder_extend(
+    void** data, secure_buffer_builder* builder, size_t size)
+{
+    status retval;
+
+    /* make room for this region. */
+    retval = secure_buffer_builder_reserve(builder, size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* the region past the current size is always zeroed. */
+    *data = (uint8_t*)builder->data + builder->size;
+    builder->size += size;
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,82 @@
+/**
+ * \file secure_buffer/secure_buffer_builder_finalize.c
+ *
+ * \brief Finalize a secure buffer builder into a secure buffer.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <rcpr/model_assert.h>
+#include <string.h>
+
+#include "secure_buffer_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+RCPR_MODEL_STRUCT_TAG_GLOBAL_EXTERN(secure_buffer);
+
+/**
+ * \brief Finalize a \ref secure_buffer_builder into a \ref secure_buffer.
+ *
+ * \param buffer        Pointer to the pointer to receive the secure buffer on
+ *                      success.
+ * \param builder       The \ref secure_buffer_builder to finalize.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_SECURE_BUFFER_BUILDER_EMPTY if nothing has been appended to
+ *        this builder.
+ */
+status FN_DECL_MUST_CHECK
+secure_buffer_builder_finalize(
+    secure_buffer** buffer, secure_buffer_builder* builder)
+{
+    status retval;
+    secure_buffer* tmp = NULL;
+
+    /* secure buffers can't be empty. */
+    if (0 == builder->size)
+    {
+        return ERROR_SECURE_BUFFER_BUILDER_EMPTY;
+    }
+
+    /* allocate memory for the buffer struct. */
+    retval = allocator_allocate(builder->alloc, (void**)&tmp, sizeof(*tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(tmp, 0, sizeof(*tmp)));
+
+    /* set the tag. */
+    RCPR_MODEL_STRUCT_TAG_INIT(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(secure_buffer), secure_buffer);
+
+    /* hand the builder storage to the buffer. Any spare capacity past the
+     * size is zeroed, so erasing the size on release leaves no secrets. */
+    resource_init(&tmp->hdr, &secure_buffer_resource_release);
+    tmp->alloc = builder->alloc;
+    tmp->size = builder->size;
+    tmp->data = builder->data;
+    tmp->cache = NULL;
+
+    /* the builder is now empty. */
+    builder->size = 0;
+    builder->capacity = 0;
+    builder->data = NULL;
+
+    /* verify that this secure buffer is now valid. */
+    RCPR_MODEL_ASSERT(prop_secure_buffer_valid(tmp));
+
+    /* success. */
+    *buffer = tmp;
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,92 @@
+/**
+ * \file secure_buffer/secure_buffer_builder_reserve.c
+ *
+ * \brief Make room in a secure buffer builder.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "secure_buffer_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief The smallest capacity that a builder grows to.
+ */
+#define SECURE_BUFFER_BUILDER_MIN_CAPACITY                                  64
+
+/**
+ * \brief Make room to append at least the given number of bytes to a
+ * \ref secure_buffer_builder without growing it again.
+ *
+ * \param builder       The \ref secure_buffer_builder for this operation.
+ * \param additional    The number of bytes to make room for.
+ *
+ * \note The allocator reallocate method may move a region without erasing the
+ * old one, so growth is always a fresh allocation, a copy, and an erase of the
+ * old region before it is reclaimed.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ */
+status FN_DECL_MUST_CHECK
+secure_buffer_builder_reserve(
+    secure_buffer_builder* builder, size_t additional)
+{
+    status retval;
+    void* tmp = NULL;
+
+    /* there is nothing to do if this already fits. */
+    if (additional <= builder->capacity - builder->size)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    /* check for overflow. */
+    if (additional > SIZE_MAX - builder->size)
+    {
+        return ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    /* grow geometrically, so that repeated appends copy O(n) bytes. */
+    size_t needed = builder->size + additional;
+    size_t capacity =
+        (builder->capacity > SIZE_MAX / 2) ? SIZE_MAX : builder->capacity * 2;
+    if (capacity < SECURE_BUFFER_BUILDER_MIN_CAPACITY)
+    {
+        capacity = SECURE_BUFFER_BUILDER_MIN_CAPACITY;
+    }
+    if (capacity < needed)
+    {
+        capacity = needed;
+    }
+
+    /* allocate the new region. */
+    retval = allocator_allocate(builder->alloc, &tmp, capacity);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* clear it, and copy the current contents. */
+    RCPR_MODEL_EXEMPT(memset(tmp, 0, capacity));
+    if (NULL != builder->data)
+    {
+        memcpy(tmp, builder->data, builder->size);
+
+        /* erase and reclaim the old region. */
+        RCPR_MODEL_EXEMPT(memset(builder->data, 0, builder->capacity));
+        retval = allocator_reclaim(builder->alloc, builder->data);
+    }
+
+    builder->data = tmp;
+    builder->capacity = capacity;
+
+    return retval;
+}
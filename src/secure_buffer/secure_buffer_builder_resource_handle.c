@@ -0,0 +1,26 @@
+/**
+ * \file secure_buffer/secure_buffer_builder_resource_handle.c
+ *
+ * \brief Get the resource handle for a secure buffer builder.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "secure_buffer_internal.h"
+
+/**
+ * \brief Given a \ref secure_buffer_builder instance, return the resource
+ * handle for this \ref secure_buffer_builder instance.
+ *
+ * \param builder       The \ref secure_buffer_builder instance from which the
+ *                      resource handle is returned.
+ *
+ * \returns the resource handle for this \ref secure_buffer_builder instance.
+ */
+RCPR_SYM(resource)*
+secure_buffer_builder_resource_handle(
+    secure_buffer_builder* builder)
+{
+    return &builder->hdr;
+}
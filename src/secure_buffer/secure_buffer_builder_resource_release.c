@@ -0,0 +1,59 @@
+/**
+ * \file secure_buffer/secure_buffer_builder_resource_release.c
+ *
+ * \brief Release a \ref secure_buffer_builder resource.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "secure_buffer_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Release a \ref secure_buffer_builder resource.
+ *
+ * \param r             Pointer to the \ref secure_buffer_builder resource to be
+ *                      released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status secure_buffer_builder_resource_release(RCPR_SYM(resource)* r)
+{
+    status data_reclaim_retval = STATUS_SUCCESS;
+    status reclaim_retval = STATUS_SUCCESS;
+
+    /* reverse type erasure. */
+    secure_buffer_builder* builder = (secure_buffer_builder*)r;
+
+    /* cache the allocator. */
+    allocator* alloc = builder->alloc;
+
+    /* if the storage is set, erase and reclaim it. */
+    if (NULL != builder->data)
+    {
+        RCPR_MODEL_EXEMPT(memset(builder->data, 0, builder->capacity));
+        data_reclaim_retval = allocator_reclaim(alloc, builder->data);
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(builder, 0, sizeof(*builder)));
+
+    /* reclaim memory. */
+    reclaim_retval = allocator_reclaim(alloc, builder);
+
+    /* decode return value. */
+    if (STATUS_SUCCESS != data_reclaim_retval)
+    {
+        return data_reclaim_retval;
+    }
+    else
+    {
+        return reclaim_retval;
+    }
+}
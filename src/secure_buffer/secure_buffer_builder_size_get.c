@@ -0,0 +1,24 @@
+/**
+ * \file secure_buffer/secure_buffer_builder_size_get.c
+ *
+ * \brief Get the number of bytes appended to a secure buffer builder.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "secure_buffer_internal.h"
+
+/**
+ * \brief Get the number of bytes appended to a \ref secure_buffer_builder.
+ *
+ * \param builder       The \ref secure_buffer_builder instance to access.
+ *
+ * \returns the size of this builder.
+ */
+size_t
+secure_buffer_builder_size_get(
+    const secure_buffer_builder* builder)
+{
+    return builder->size;
+}
@@ -0,0 +1,37 @@
+/**
+ * \file secure_buffer/secure_buffer_builder_truncate.c
+ *
+ * \brief Remove bytes from the end of a secure buffer builder.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "secure_buffer_internal.h"
+
+/**
+ * \brief Remove bytes from the end of a \ref secure_buffer_builder.
+ *
+ * \param builder       The \ref secure_buffer_builder for this operation.
+ * \param size          The new size of this builder, which must not be
+ *                      greater than its current size.
+ */
+void
+secure_buffer_builder_truncate(
+    secure_buffer_builder* builder, size_t size)
+{
+    RCPR_MODEL_ASSERT(size <= builder->size);
+
+    if (size == builder->size)
+    {
+        return;
+    }
+
+    /* erase the removed bytes. */
+    RCPR_MODEL_EXEMPT(
+        memset((uint8_t*)builder->data + size, 0, builder->size - size));
+    builder->size = size;
+}
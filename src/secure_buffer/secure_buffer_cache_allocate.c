@@ -0,0 +1,101 @@
+/**
+ * \file secure_buffer/secure_buffer_cache_allocate.c
+ *
+ * \brief Take a zeroed block from a secure buffer cache.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "secure_buffer_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Take a zeroed block from a cache.
+ *
+ * \param block         Pointer to receive the block on success.
+ * \param cache         The cache.
+ * \param size_class    The block size class.
+ *
+ * \note A block is taken from the loaded magazine of the calling thread, or
+ * from its previous magazine if the loaded one is empty. If both are empty,
+ * the previous magazine is returned to the depot and a full magazine is taken
+ * from the depot. Only if the depot has no full magazines, or the thread has
+ * no slot, is the allocator used.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ */
+status FN_DECL_MUST_CHECK
+secure_buffer_cache_allocate(
+    void** block, secure_buffer_cache* cache, size_t size_class)
+{
+    status retval;
+    secure_buffer_depot* depot = &cache->depot[size_class];
+    secure_buffer_cache_thread* slot = secure_buffer_cache_thread_get(cache);
+    secure_buffer_magazine* mag;
+    size_t block_size =
+        (size_t)1 << (SECURE_BUFFER_CACHE_MIN_BLOCK_SHIFT + size_class);
+
+    if (NULL != slot)
+    {
+        uint32_t* loaded = &slot->loaded[size_class];
+        uint32_t* previous = &slot->previous[size_class];
+
+        /* if the loaded magazine is empty, try the previous one. */
+        if (0 == *loaded
+         || 0 == secure_buffer_cache_magazine(
+                    cache, size_class, *loaded)->count)
+        {
+            if (0 != *previous
+             && secure_buffer_cache_magazine(
+                    cache, size_class, *previous)->count > 0)
+            {
+                uint32_t tmp = *loaded;
+                *loaded = *previous;
+                *previous = tmp;
+            }
+            else
+            {
+                /* both are empty, so exchange one for a full magazine. */
+                uint32_t full =
+                    secure_buffer_depot_pop(cache, size_class, &depot->full);
+                if (0 == full)
+                {
+                    goto allocate;
+                }
+
+                if (0 != *previous)
+                {
+                    secure_buffer_depot_push(
+                        cache, size_class, &depot->empty, *previous);
+                }
+
+                *previous = *loaded;
+                *loaded = full;
+            }
+        }
+
+        mag = secure_buffer_cache_magazine(cache, size_class, *loaded);
+        *block = mag->blocks[--mag->count];
+        mag->blocks[mag->count] = NULL;
+
+        return STATUS_SUCCESS;
+    }
+
+allocate:
+    retval = allocator_allocate(cache->alloc, block, block_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    memset(*block, 0, block_size);
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,68 @@
+/**
+ * \file secure_buffer/secure_buffer_cache_buffer_create.c
+ *
+ * \brief Create a secure buffer from a secure buffer cache.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <rcpr/model_assert.h>
+
+#include "secure_buffer_internal.h"
+
+RCPR_IMPORT_resource;
+
+RCPR_MODEL_STRUCT_TAG_GLOBAL_EXTERN(secure_buffer);
+
+/**
+ * \brief Create a secure buffer from a cache.
+ *
+ * \param buffer        Pointer to the pointer to receive the secure buffer on
+ *                      success.
+ * \param cache         The cache.
+ * \param size          The size of the secure buffer, which must not be
+ *                      greater than \ref SECURE_BUFFER_CACHE_MAX_SIZE.
+ *
+ * \note The buffer header and its data share one zeroed block, with the data
+ * just past the header.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ */
+status FN_DECL_MUST_CHECK
+secure_buffer_cache_buffer_create(
+    secure_buffer** buffer, secure_buffer_cache* cache, size_t size)
+{
+    status retval;
+    void* block;
+
+    /* take a zeroed block. */
+    retval =
+        secure_buffer_cache_allocate(
+            &block, cache, secure_buffer_cache_class(size));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    secure_buffer* tmp = (secure_buffer*)block;
+
+    /* set the tag. */
+    RCPR_MODEL_STRUCT_TAG_INIT(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(secure_buffer), secure_buffer);
+
+    /* initialize resource. */
+    resource_init(&tmp->hdr, &secure_buffer_resource_release);
+    tmp->alloc = cache->alloc;
+    tmp->size = size;
+    tmp->data = (uint8_t*)block + SECURE_BUFFER_CACHE_HEADER_SIZE;
+    tmp->cache = cache;
+
+    /* success. */
+    *buffer = tmp;
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,160 @@
+/**
+ * \file secure_buffer/secure_buffer_cache_create.c
+ *
+ * \brief Create a secure buffer cache for an allocator.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <rcpr/model_assert.h>
+#include <string.h>
+
+#include "secure_buffer_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Create a secure buffer cache for the given allocator.
+ *
+ * \param cache         Pointer to the pointer to receive the cache on success.
+ * \param alloc         The allocator to cache, which must be thread-safe.
+ *
+ * \note This cache is a \ref resource that must be released by calling
+ * \ref resource_release on its resource handle when it is no longer needed by
+ * the caller. The resource handle can be accessed by calling
+ * \ref secure_buffer_cache_resource_handle on this cache instance. Every
+ * secure buffer created from \p alloc while the cache exists must be released
+ * before the cache, and no thread may create or release a secure buffer from
+ * \p alloc while the cache is being released. Blocks held by the cache are
+ * returned to \p alloc when the cache is released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_SECURE_BUFFER_CACHE_EXISTS if \p alloc already has a cache.
+ *      - ERROR_SECURE_BUFFER_CACHE_INIT_FAILED if the thread-local storage for
+ *        the cache could not be created, or too many caches exist.
+ *
+ * \pre
+ *      - \p cache must not reference a valid \ref secure_buffer_cache instance
+ *        and must not be NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ * \post
+ *      - On success, \p cache is set to a pointer to a valid
+ *        \ref secure_buffer_cache instance, which is a \ref resource owned by
+ *        the caller that must be released before \p alloc.
+ *      - On failure, \p cache is not changed and an error status is returned.
+ */
+status FN_DECL_MUST_CHECK
+secure_buffer_cache_create(
+    secure_buffer_cache** cache, RCPR_SYM(allocator)* alloc)
+{
+    status retval, release_retval;
+    secure_buffer_cache* tmp = NULL;
+    size_t magazine_count =
+        SECURE_BUFFER_CACHE_CLASS_COUNT * SECURE_BUFFER_CACHE_MAGAZINE_COUNT;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != cache);
+    RCPR_MODEL_ASSERT(prop_allocator_valid(alloc));
+
+    /* allocate memory for the cache struct. */
+    retval = allocator_allocate(alloc, (void**)&tmp, sizeof(*tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(tmp, 0, sizeof(*tmp)));
+
+    /* set the tag. */
+    RCPR_MODEL_STRUCT_TAG_INIT(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(secure_buffer_cache),
+        secure_buffer_cache);
+
+    /* initialize resource. */
+    resource_init(&tmp->hdr, &secure_buffer_cache_resource_release);
+    tmp->alloc = alloc;
+    tmp->key_created = false;
+    tmp->registry_index = SECURE_BUFFER_CACHE_REGISTRY_SIZE;
+    tmp->magazines = NULL;
+    tmp->threads = NULL;
+
+    /* allocate the magazines. */
+    retval =
+        allocator_allocate(
+            alloc, (void**)&tmp->magazines,
+            magazine_count * sizeof(*tmp->magazines));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    memset(tmp->magazines, 0, magazine_count * sizeof(*tmp->magazines));
+
+    /* allocate the thread slots. */
+    retval =
+        allocator_allocate(
+            alloc, (void**)&tmp->threads,
+            SECURE_BUFFER_CACHE_THREAD_COUNT * sizeof(*tmp->threads));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    memset(
+        tmp->threads, 0,
+        SECURE_BUFFER_CACHE_THREAD_COUNT * sizeof(*tmp->threads));
+    for (size_t i = 0; i < SECURE_BUFFER_CACHE_THREAD_COUNT; ++i)
+    {
+        tmp->threads[i].cache = tmp;
+        atomic_init(&tmp->threads[i].in_use, false);
+    }
+
+    /* every magazine starts empty, in the depot. */
+    for (size_t c = 0; c < SECURE_BUFFER_CACHE_CLASS_COUNT; ++c)
+    {
+        atomic_init(&tmp->depot[c].full, 0);
+        atomic_init(&tmp->depot[c].empty, 0);
+        for (uint32_t i = 1; i <= SECURE_BUFFER_CACHE_MAGAZINE_COUNT; ++i)
+        {
+            secure_buffer_depot_push(tmp, c, &tmp->depot[c].empty, i);
+        }
+    }
+
+    /* create the key for the magazines of each thread. */
+    if (0 != pthread_key_create(&tmp->key, &secure_buffer_cache_thread_release))
+    {
+        retval = ERROR_SECURE_BUFFER_CACHE_INIT_FAILED;
+        goto cleanup_tmp;
+    }
+
+    tmp->key_created = true;
+
+    /* route secure buffers of this allocator through the cache. */
+    retval = secure_buffer_cache_register(tmp);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    /* success. */
+    *cache = tmp;
+    retval = STATUS_SUCCESS;
+    goto done;
+
+cleanup_tmp:
+    release_retval = resource_release(&tmp->hdr);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
@@ -0,0 +1,55 @@
+/**
+ * \file secure_buffer/secure_buffer_cache_find.c
+ *
+ * \brief Find the secure buffer cache of an allocator.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "secure_buffer_internal.h"
+
+/* the caches of every allocator that has one. */
+secure_buffer_cache_registration
+secure_buffer_cache_registry[SECURE_BUFFER_CACHE_REGISTRY_SIZE];
+
+/* the number of allocators that have a cache. */
+_Atomic size_t secure_buffer_cache_registry_count;
+
+/**
+ * \brief Find the cache of an allocator.
+ *
+ * \param alloc         The allocator.
+ *
+ * \note This is called for every secure buffer created, so when no allocator
+ * has a cache, it returns after a single load.
+ *
+ * \returns the cache of this allocator, or NULL if it has none.
+ */
+secure_buffer_cache*
+secure_buffer_cache_find(
+    RCPR_SYM(allocator)* alloc)
+{
+    if (0
+            == atomic_load_explicit(
+                    &secure_buffer_cache_registry_count, memory_order_acquire))
+    {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < SECURE_BUFFER_CACHE_REGISTRY_SIZE; ++i)
+    {
+        if (alloc
+                == atomic_load_explicit(
+                        &secure_buffer_cache_registry[i].alloc,
+                        memory_order_acquire))
+        {
+            return
+                atomic_load_explicit(
+                    &secure_buffer_cache_registry[i].cache,
+                    memory_order_acquire);
+        }
+    }
+
+    return NULL;
+}
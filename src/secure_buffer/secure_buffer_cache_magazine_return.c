@@ -0,0 +1,39 @@
+/**
+ * \file secure_buffer/secure_buffer_cache_magazine_return.c
+ *
+ * \brief Return a thread magazine to the secure buffer cache depot.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "secure_buffer_internal.h"
+
+/**
+ * \brief Return a magazine held by a thread to the depot.
+ *
+ * \param cache         The cache.
+ * \param size_class    The block size class of the magazine.
+ * \param index         The 1-based index of the magazine, or 0 for none.
+ */
+void
+secure_buffer_cache_magazine_return(
+    secure_buffer_cache* cache, size_t size_class, uint32_t index)
+{
+    secure_buffer_depot* depot = &cache->depot[size_class];
+
+    if (0 == index)
+    {
+        return;
+    }
+
+    /* a partly full magazine still holds blocks worth sharing. */
+    if (secure_buffer_cache_magazine(cache, size_class, index)->count > 0)
+    {
+        secure_buffer_depot_push(cache, size_class, &depot->full, index);
+    }
+    else
+    {
+        secure_buffer_depot_push(cache, size_class, &depot->empty, index);
+    }
+}
@@ -0,0 +1,89 @@
+/**
+ * \file secure_buffer/secure_buffer_cache_reclaim.c
+ *
+ * \brief Return a zeroed block to a secure buffer cache.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "secure_buffer_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Return a zeroed block to a cache.
+ *
+ * \param cache         The cache.
+ * \param block         The block, which must be entirely zero.
+ * \param size_class    The block size class.
+ *
+ * \note A block is put in the loaded magazine of the calling thread, or in its
+ * previous magazine if the loaded one is full. If both are full, the previous
+ * magazine is given to the depot and an empty magazine is taken from the
+ * depot. Only if the depot has no empty magazines, or the thread has no slot,
+ * is the block reclaimed by the allocator.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error from \ref allocator_reclaim if the cache is full and the
+ *        block could not be reclaimed.
+ */
+status FN_DECL_MUST_CHECK
+secure_buffer_cache_reclaim(
+    secure_buffer_cache* cache, void* block, size_t size_class)
+{
+    secure_buffer_depot* depot = &cache->depot[size_class];
+    secure_buffer_cache_thread* slot = secure_buffer_cache_thread_get(cache);
+    secure_buffer_magazine* mag;
+
+    if (NULL != slot)
+    {
+        uint32_t* loaded = &slot->loaded[size_class];
+        uint32_t* previous = &slot->previous[size_class];
+
+        /* if the loaded magazine is full, try the previous one. */
+        if (0 == *loaded
+         || SECURE_BUFFER_CACHE_MAGAZINE_SIZE
+                == secure_buffer_cache_magazine(
+                        cache, size_class, *loaded)->count)
+        {
+            if (0 != *previous
+             && secure_buffer_cache_magazine(
+                    cache, size_class, *previous)->count
+                        < SECURE_BUFFER_CACHE_MAGAZINE_SIZE)
+            {
+                uint32_t tmp = *loaded;
+                *loaded = *previous;
+                *previous = tmp;
+            }
+            else
+            {
+                /* both are full, so exchange one for an empty magazine. */
+                uint32_t empty =
+                    secure_buffer_depot_pop(cache, size_class, &depot->empty);
+                if (0 == empty)
+                {
+                    goto reclaim;
+                }
+
+                if (0 != *previous)
+                {
+                    secure_buffer_depot_push(
+                        cache, size_class, &depot->full, *previous);
+                }
+
+                *previous = *loaded;
+                *loaded = empty;
+            }
+        }
+
+        mag = secure_buffer_cache_magazine(cache, size_class, *loaded);
+        mag->blocks[mag->count++] = block;
+
+        return STATUS_SUCCESS;
+    }
+
+reclaim:
+    return allocator_reclaim(cache->alloc, block);
+}
@@ -0,0 +1,56 @@
+/**
+ * \file secure_buffer/secure_buffer_cache_register.c
+ *
+ * \brief Register a secure buffer cache for its allocator.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+
+#include "secure_buffer_internal.h"
+
+/**
+ * \brief Register a cache for its allocator.
+ *
+ * \param cache         The cache to register.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_SECURE_BUFFER_CACHE_EXISTS if the allocator already has a
+ *        cache.
+ *      - ERROR_SECURE_BUFFER_CACHE_INIT_FAILED if the registry is full.
+ */
+status FN_DECL_MUST_CHECK
+secure_buffer_cache_register(
+    secure_buffer_cache* cache)
+{
+    if (NULL != secure_buffer_cache_find(cache->alloc))
+    {
+        return ERROR_SECURE_BUFFER_CACHE_EXISTS;
+    }
+
+    for (size_t i = 0; i < SECURE_BUFFER_CACHE_REGISTRY_SIZE; ++i)
+    {
+        RCPR_SYM(allocator)* expected = NULL;
+
+        if (atomic_compare_exchange_strong(
+                &secure_buffer_cache_registry[i].alloc, &expected,
+                cache->alloc))
+        {
+            atomic_store(&secure_buffer_cache_registry[i].cache, cache);
+            atomic_fetch_add(&secure_buffer_cache_registry_count, 1);
+            cache->registry_index = i;
+
+            return STATUS_SUCCESS;
+        }
+
+        if (cache->alloc == expected)
+        {
+            return ERROR_SECURE_BUFFER_CACHE_EXISTS;
+        }
+    }
+
+    return ERROR_SECURE_BUFFER_CACHE_INIT_FAILED;
+}
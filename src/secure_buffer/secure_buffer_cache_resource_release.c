@@ -0,0 +1,104 @@
+/**
+ * \file secure_buffer/secure_buffer_cache_resource_release.c
+ *
+ * \brief Release a secure buffer cache resource.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "secure_buffer_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Release a \ref secure_buffer_cache resource.
+ *
+ * \param r             Pointer to the \ref secure_buffer_cache resource to be
+ *                      released.
+ *
+ * \note Every magazine is in the pool, whether it is held by a thread or by
+ * the depot, so the cached blocks are reclaimed by walking the pool.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status secure_buffer_cache_resource_release(RCPR_SYM(resource)* r)
+{
+    status retval = STATUS_SUCCESS;
+    status reclaim_retval;
+    size_t magazine_count =
+        SECURE_BUFFER_CACHE_CLASS_COUNT * SECURE_BUFFER_CACHE_MAGAZINE_COUNT;
+
+    /* reverse type erasure. */
+    secure_buffer_cache* cache = (secure_buffer_cache*)r;
+
+    /* cache the allocator. */
+    allocator* alloc = cache->alloc;
+
+    /* stop routing secure buffers through this cache. */
+    if (cache->registry_index < SECURE_BUFFER_CACHE_REGISTRY_SIZE)
+    {
+        secure_buffer_cache_registration* reg =
+            &secure_buffer_cache_registry[cache->registry_index];
+
+        atomic_fetch_sub(&secure_buffer_cache_registry_count, 1);
+        atomic_store(&reg->cache, NULL);
+        atomic_store(&reg->alloc, NULL);
+    }
+
+    /* threads that exit from now on leave their magazines to us. */
+    if (cache->key_created)
+    {
+        pthread_key_delete(cache->key);
+    }
+
+    /* reclaim the cached blocks, which are already zeroed. */
+    if (NULL != cache->magazines)
+    {
+        for (size_t i = 0; i < magazine_count; ++i)
+        {
+            secure_buffer_magazine* mag = &cache->magazines[i];
+            for (uint32_t j = 0; j < mag->count; ++j)
+            {
+                reclaim_retval = allocator_reclaim(alloc, mag->blocks[j]);
+                if (STATUS_SUCCESS != reclaim_retval)
+                {
+                    retval = reclaim_retval;
+                }
+            }
+        }
+
+        reclaim_retval = allocator_reclaim(alloc, cache->magazines);
+        if (STATUS_SUCCESS != reclaim_retval)
+        {
+            retval = reclaim_retval;
+        }
+    }
+
+    /* reclaim the thread slots. */
+    if (NULL != cache->threads)
+    {
+        reclaim_retval = allocator_reclaim(alloc, cache->threads);
+        if (STATUS_SUCCESS != reclaim_retval)
+        {
+            retval = reclaim_retval;
+        }
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(cache, 0, sizeof(*cache)));
+
+    /* reclaim memory. */
+    reclaim_retval = allocator_reclaim(alloc, cache);
+    if (STATUS_SUCCESS != reclaim_retval)
+    {
+        retval = reclaim_retval;
+    }
+
+    return retval;
+}
@@ -0,0 +1,57 @@
+/**
+ * \file secure_buffer/secure_buffer_cache_thread_get.c
+ *
+ * \brief Get the magazines of the calling thread.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "secure_buffer_internal.h"
+
+/**
+ * \brief Get the magazines of the calling thread, claiming a slot for it if it
+ * has none.
+ *
+ * \param cache         The cache.
+ *
+ * \note A slot is returned to the cache when its thread exits.
+ *
+ * \returns the thread slot, or NULL if every slot is in use.
+ */
+secure_buffer_cache_thread*
+secure_buffer_cache_thread_get(
+    secure_buffer_cache* cache)
+{
+    secure_buffer_cache_thread* slot =
+        (secure_buffer_cache_thread*)pthread_getspecific(cache->key);
+
+    if (NULL != slot)
+    {
+        return slot;
+    }
+
+    /* claim a free slot. */
+    for (size_t i = 0; i < SECURE_BUFFER_CACHE_THREAD_COUNT; ++i)
+    {
+        bool expected = false;
+
+        slot = &cache->threads[i];
+        if (!atomic_load_explicit(&slot->in_use, memory_order_relaxed)
+         && atomic_compare_exchange_strong_explicit(
+                &slot->in_use, &expected, true, memory_order_acquire,
+                memory_order_relaxed))
+        {
+            if (0 != pthread_setspecific(cache->key, slot))
+            {
+                atomic_store_explicit(
+                    &slot->in_use, false, memory_order_release);
+                return NULL;
+            }
+
+            return slot;
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,33 @@
+/**
+ * \file secure_buffer/secure_buffer_cache_thread_release.c
+ *
+ * \brief Return the magazines of an exiting thread to the depot.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "secure_buffer_internal.h"
+
+/**
+ * \brief Return the magazines of an exiting thread to the depot, and free its
+ * slot.
+ *
+ * \param arg           The thread slot.
+ */
+void
+secure_buffer_cache_thread_release(
+    void* arg)
+{
+    secure_buffer_cache_thread* slot = (secure_buffer_cache_thread*)arg;
+
+    for (size_t c = 0; c < SECURE_BUFFER_CACHE_CLASS_COUNT; ++c)
+    {
+        secure_buffer_cache_magazine_return(slot->cache, c, slot->loaded[c]);
+        secure_buffer_cache_magazine_return(slot->cache, c, slot->previous[c]);
+        slot->loaded[c] = 0;
+        slot->previous[c] = 0;
+    }
+
+    atomic_store_explicit(&slot->in_use, false, memory_order_release);
+}
@@ -28,7 +28,9 @@ RCPR_MODEL_STRUCT_TAG_GLOBAL_EXTERN(secure_buffer);
  * \note This secure buffer is a \ref resource that must be released by calling
  * \ref resource_release on its resource handle when it is no longer needed by
  * the caller. The resource handle can be accessed by calling
- * \ref secure_buffer_resource_handle on this secure buffer instance.
+ * \ref secure_buffer_resource_handle on this secure buffer instance. If
+ * \p alloc has a \ref secure_buffer_cache, a small buffer is taken from the
+ * cache of the calling thread.
  *
  * \returns a status code indicating success or failure.
  *      - STATUS_SUCCESS on success.
@@ -51,12 +53,20 @@ secure_buffer_create(
 {
     status retval, release_retval;
     secure_buffer* tmp = NULL;
+    secure_buffer_cache* cache = NULL;
 
     /* parameter sanity checks. */
     RCPR_MODEL_ASSERT(NULL != buffer);
     RCPR_MODEL_ASSERT(prop_allocator_valid(alloc));
     RCPR_MODEL_ASSERT(size > 0);
 
+    /* use the thread caches of this allocator, if it has them. */
+    RCPR_MODEL_EXEMPT(cache = secure_buffer_cache_find(alloc));
+    if (NULL != cache && size <= SECURE_BUFFER_CACHE_MAX_SIZE)
+    {
+        return secure_buffer_cache_buffer_create(buffer, cache, size);
+    }
+
     /* allocate memory for the buffer struct. */
     retval = allocator_allocate(alloc, (void**)&tmp, sizeof(*tmp));
     if (STATUS_SUCCESS != retval)
@@ -81,6 +91,7 @@ secure_buffer_create(
     tmp->alloc = alloc;
     tmp->size = size;
     tmp->data = NULL;
+    tmp->cache = NULL;
 
     /* allocate buffer memory. */
     retval = allocator_allocate(alloc, &tmp->data, size);
@@ -10,7 +10,9 @@
 #pragma once
 
 #include <nepe2/secure_buffer.h>
+#include <pthread.h>
 #include <rcpr/resource/protected.h>
+#include <stdatomic.h>
 
 /* C++ compatibility. */
 # ifdef   __cplusplus
@@ -24,8 +26,349 @@ struct secure_buffer
     RCPR_SYM(allocator)* alloc;
     size_t size;
     void* data;
+    secure_buffer_cache* cache;
 };
 
+struct secure_buffer_builder
+{
+    RCPR_SYM(resource) hdr;
+    RCPR_MODEL_STRUCT_TAG(secure_buffer_builder);
+    RCPR_SYM(allocator)* alloc;
+    size_t size;
+    size_t capacity;
+    void* data;
+};
+
+/**
+ * \brief The smallest cached block size, as a power of two.
+ */
+#define SECURE_BUFFER_CACHE_MIN_BLOCK_SHIFT                                  6
+
+/**
+ * \brief The number of cached block sizes, which double from the smallest.
+ */
+#define SECURE_BUFFER_CACHE_CLASS_COUNT                                      7
+
+/**
+ * \brief The number of blocks held by a magazine.
+ */
+#define SECURE_BUFFER_CACHE_MAGAZINE_SIZE                                   32
+
+/**
+ * \brief The number of magazines for each block size.
+ */
+#define SECURE_BUFFER_CACHE_MAGAZINE_COUNT                                 256
+
+/**
+ * \brief The number of threads that can hold magazines at once. Other threads
+ * use the allocator directly.
+ */
+#define SECURE_BUFFER_CACHE_THREAD_COUNT                                   128
+
+/**
+ * \brief The number of allocators that can have a cache at once.
+ */
+#define SECURE_BUFFER_CACHE_REGISTRY_SIZE                                   16
+
+/**
+ * \brief The size of the buffer header at the start of a cached block.
+ */
+#define SECURE_BUFFER_CACHE_HEADER_SIZE \
+    ((sizeof(secure_buffer) + 15) & ~(size_t)15)
+
+/**
+ * \brief The largest buffer size that is cached.
+ */
+#define SECURE_BUFFER_CACHE_MAX_SIZE \
+    (((size_t)1 << (SECURE_BUFFER_CACHE_MIN_BLOCK_SHIFT \
+                    + SECURE_BUFFER_CACHE_CLASS_COUNT - 1)) \
+        - SECURE_BUFFER_CACHE_HEADER_SIZE)
+
+/**
+ * \brief A magazine is a stack of zeroed blocks of one size.
+ *
+ * A magazine is owned either by one thread or by the depot. The next link is
+ * only used in the depot, where it may be read by a thread that loses a race
+ * to pop the magazine, so it is atomic.
+ */
+typedef struct secure_buffer_magazine secure_buffer_magazine;
+
+struct secure_buffer_magazine
+{
+    _Atomic uint32_t next;
+    uint32_t count;
+    void* blocks[SECURE_BUFFER_CACHE_MAGAZINE_SIZE];
+};
+
+/**
+ * \brief The depot of one block size holds lock-free stacks of full and empty
+ * magazines.
+ *
+ * Each stack head packs a 1-based magazine index in its low half, with 0 for
+ * an empty stack, and a version in its high half that changes on every update,
+ * so a head that was popped and pushed back between a load and a compare and
+ * swap is not mistaken for an unchanged head.
+ */
+typedef struct secure_buffer_depot secure_buffer_depot;
+
+struct secure_buffer_depot
+{
+    _Atomic uint64_t full;
+    _Atomic uint64_t empty;
+    /* keep each depot on its own cache line. */
+    uint8_t pad[64 - 2 * sizeof(uint64_t)];
+};
+
+/**
+ * \brief The magazines held by one thread.
+ *
+ * Magazines are 1-based indexes into the pool of their block size, with 0 for
+ * none. Only the owning thread touches a slot while it is in use.
+ */
+typedef struct secure_buffer_cache_thread secure_buffer_cache_thread;
+
+struct secure_buffer_cache_thread
+{
+    secure_buffer_cache* cache;
+    _Atomic bool in_use;
+    uint32_t loaded[SECURE_BUFFER_CACHE_CLASS_COUNT];
+    uint32_t previous[SECURE_BUFFER_CACHE_CLASS_COUNT];
+    /* keep slots of different threads off each other's cache lines. */
+    uint8_t pad[64];
+};
+
+struct secure_buffer_cache
+{
+    RCPR_SYM(resource) hdr;
+    RCPR_MODEL_STRUCT_TAG(secure_buffer_cache);
+    RCPR_SYM(allocator)* alloc;
+    pthread_key_t key;
+    bool key_created;
+    size_t registry_index;
+    secure_buffer_depot depot[SECURE_BUFFER_CACHE_CLASS_COUNT];
+    secure_buffer_magazine* magazines;
+    secure_buffer_cache_thread* threads;
+};
+
+/**
+ * \brief An allocator and its cache.
+ */
+typedef struct secure_buffer_cache_registration
+secure_buffer_cache_registration;
+
+struct secure_buffer_cache_registration
+{
+    _Atomic(RCPR_SYM(allocator)*) alloc;
+    _Atomic(secure_buffer_cache*) cache;
+};
+
+/**
+ * \brief The caches of every allocator that has one.
+ */
+extern secure_buffer_cache_registration
+secure_buffer_cache_registry[SECURE_BUFFER_CACHE_REGISTRY_SIZE];
+
+/**
+ * \brief The number of allocators that have a cache.
+ */
+extern _Atomic size_t secure_buffer_cache_registry_count;
+
+/**
+ * \brief Get the size class of a buffer.
+ *
+ * \param size          The size of the buffer, which must not be greater than
+ *                      \ref SECURE_BUFFER_CACHE_MAX_SIZE.
+ *
+ * \returns the size class, whose blocks hold the buffer header and data.
+ */
+static inline size_t secure_buffer_cache_class(size_t size)
+{
+    size_t total = SECURE_BUFFER_CACHE_HEADER_SIZE + size;
+
+    if (total <= ((size_t)1 << SECURE_BUFFER_CACHE_MIN_BLOCK_SHIFT))
+    {
+        return 0;
+    }
+
+    return
+        (sizeof(unsigned long long) * 8
+            - (size_t)__builtin_clzll((unsigned long long)(total - 1)))
+      - SECURE_BUFFER_CACHE_MIN_BLOCK_SHIFT;
+}
+
+/**
+ * \brief Get a magazine of a block size by index.
+ *
+ * \param cache         The cache.
+ * \param size_class    The block size class.
+ * \param index         The 1-based magazine index, which must not be 0.
+ *
+ * \returns the magazine.
+ */
+static inline secure_buffer_magazine* secure_buffer_cache_magazine(
+    secure_buffer_cache* cache, size_t size_class, uint32_t index)
+{
+    return
+        &cache->magazines[
+            size_class * SECURE_BUFFER_CACHE_MAGAZINE_COUNT + index - 1];
+}
+
+/**
+ * \brief Pop a magazine from a depot stack.
+ *
+ * \param cache         The cache.
+ * \param size_class    The block size class of the stack.
+ * \param head          The stack head.
+ *
+ * \returns the 1-based index of the magazine, or 0 if the stack is empty.
+ */
+static inline uint32_t secure_buffer_depot_pop(
+    secure_buffer_cache* cache, size_t size_class, _Atomic uint64_t* head)
+{
+    uint64_t old = atomic_load_explicit(head, memory_order_acquire);
+    uint64_t next;
+
+    do
+    {
+        uint32_t index = (uint32_t)old;
+        if (0 == index)
+        {
+            return 0;
+        }
+
+        next =
+            (((old >> 32) + 1) << 32)
+          | atomic_load_explicit(
+                &secure_buffer_cache_magazine(cache, size_class, index)->next,
+                memory_order_relaxed);
+    } while (
+        !atomic_compare_exchange_weak_explicit(
+            head, &old, next, memory_order_acquire, memory_order_acquire));
+
+    return (uint32_t)old;
+}
+
+/**
+ * \brief Push a magazine onto a depot stack.
+ *
+ * \param cache         The cache.
+ * \param size_class    The block size class of the stack.
+ * \param head          The stack head.
+ * \param index         The 1-based index of the magazine.
+ */
+static inline void secure_buffer_depot_push(
+    secure_buffer_cache* cache, size_t size_class, _Atomic uint64_t* head,
+    uint32_t index)
+{
+    secure_buffer_magazine* mag =
+        secure_buffer_cache_magazine(cache, size_class, index);
+    uint64_t old = atomic_load_explicit(head, memory_order_relaxed);
+    uint64_t next;
+
+    do
+    {
+        atomic_store_explicit(&mag->next, (uint32_t)old, memory_order_relaxed);
+        next = (((old >> 32) + 1) << 32) | index;
+    } while (
+        !atomic_compare_exchange_weak_explicit(
+            head, &old, next, memory_order_release, memory_order_relaxed));
+}
+
+/**
+ * \brief Find the cache of an allocator.
+ *
+ * \param alloc         The allocator.
+ *
+ * \returns the cache of this allocator, or NULL if it has none.
+ */
+secure_buffer_cache*
+secure_buffer_cache_find(
+    RCPR_SYM(allocator)* alloc);
+
+/**
+ * \brief Get the magazines of the calling thread, claiming a slot for it if it
+ * has none.
+ *
+ * \param cache         The cache.
+ *
+ * \returns the thread slot, or NULL if every slot is in use.
+ */
+secure_buffer_cache_thread*
+secure_buffer_cache_thread_get(
+    secure_buffer_cache* cache);
+
+/**
+ * \brief Return the magazines of an exiting thread to the depot, and free its
+ * slot.
+ *
+ * \param arg           The thread slot.
+ */
+void
+secure_buffer_cache_thread_release(
+    void* arg);
+
+/**
+ * \brief Take a zeroed block from a cache.
+ *
+ * \param block         Pointer to receive the block on success.
+ * \param cache         The cache.
+ * \param size_class    The block size class.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ */
+status FN_DECL_MUST_CHECK
+secure_buffer_cache_allocate(
+    void** block, secure_buffer_cache* cache, size_t size_class);
+
+/**
+ * \brief Return a zeroed block to a cache.
+ *
+ * \param cache         The cache.
+ * \param block         The block, which must be entirely zero.
+ * \param size_class    The block size class.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error from \ref allocator_reclaim if the cache is full and the
+ *        block could not be reclaimed.
+ */
+status FN_DECL_MUST_CHECK
+secure_buffer_cache_reclaim(
+    secure_buffer_cache* cache, void* block, size_t size_class);
+
+/**
+ * \brief Create a secure buffer from a cache.
+ *
+ * \param buffer        Pointer to the pointer to receive the secure buffer on
+ *                      success.
+ * \param cache         The cache.
+ * \param size          The size of the secure buffer, which must not be
+ *                      greater than \ref SECURE_BUFFER_CACHE_MAX_SIZE.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ */
+status FN_DECL_MUST_CHECK
+secure_buffer_cache_buffer_create(
+    secure_buffer** buffer, secure_buffer_cache* cache, size_t size);
+
+/**
+ * \brief Release a \ref secure_buffer_cache resource.
+ *
+ * \param r             Pointer to the \ref secure_buffer_cache resource to be
+ *                      released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status secure_buffer_cache_resource_release(RCPR_SYM(resource)* r);
+
 /**
  * \brief Release a \ref secure_buffer resource.
  *
@@ -38,6 +381,44 @@ struct secure_buffer
  */
 status secure_buffer_resource_release(RCPR_SYM(resource)* r);
 
+/**
+ * \brief Release a \ref secure_buffer_builder resource.
+ *
+ * \param r             Pointer to the \ref secure_buffer_builder resource to be
+ *                      released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status secure_buffer_builder_resource_release(RCPR_SYM(resource)* r);
+
+/**
+ * \brief Register a cache for its allocator.
+ *
+ * \param cache         The cache to register.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_SECURE_BUFFER_CACHE_EXISTS if the allocator already has a
+ *        cache.
+ *      - ERROR_SECURE_BUFFER_CACHE_INIT_FAILED if the registry is full.
+ */
+status FN_DECL_MUST_CHECK
+secure_buffer_cache_register(
+    secure_buffer_cache* cache);
+
+/**
+ * \brief Return a magazine held by a thread to the depot.
+ *
+ * \param cache         The cache.
+ * \param size_class    The block size class of the magazine.
+ * \param index         The 1-based index of the magazine, or 0 for none.
+ */
+void
+secure_buffer_cache_magazine_return(
+    secure_buffer_cache* cache, size_t size_class, uint32_t index);
+
 /* C++ compatibility. */
 # ifdef   __cplusplus
 }
@@ -38,6 +38,21 @@ status secure_buffer_resource_release(RCPR_SYM(resource)* r)
     /* cache the allocator. */
     allocator* alloc = buffer->alloc;
 
+    /* a cached buffer shares its block with its data, and is erased before
+     * the block goes back to the cache, so that every cached block is zero. */
+    if (NULL != buffer->cache)
+    {
+        secure_buffer_cache* cache = buffer->cache;
+        size_t size = buffer->size;
+
+        RCPR_MODEL_EXEMPT(
+            memset(buffer, 0, SECURE_BUFFER_CACHE_HEADER_SIZE + size));
+
+        return
+            secure_buffer_cache_reclaim(
+                cache, buffer, secure_buffer_cache_class(size));
+    }
+
     /* if the buffer is set, reclaim it. */
     if (NULL != buffer->data)
     {
@@ -51,6 +66,7 @@ status secure_buffer_resource_release(RCPR_SYM(resource)* r)
     buffer->alloc = NULL;
     buffer->size = 0;
     buffer->data = NULL;
+    buffer->cache = NULL;
 
     /* reclaim memory. */
     reclaim_retval = allocator_reclaim(alloc, buffer);
@@ -0,0 +1,40 @@
+/**
+ * \file store/store_crc32c.c
+ *
+ * \brief Compute the CRC32C checksum of a region.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_internal.h"
+
+/**
+ * \brief Compute or continue the CRC32C (Castagnoli) checksum of a region.
+ *
+ * \param crc           The checksum of the data before this region, or 0 to
+ *                      start a new checksum.
+ * \param data          The region to checksum.
+ * \param size          The size of the region.
+ *
+ * \note Where the CPU supports SSE4.2, the checksum is computed with the crc32
+ * instruction, over three interleaved streams for large regions. Otherwise, a
+ * table is used.
+ *
+ * \returns the checksum of the data so far.
+ */
+uint32_t
+store_crc32c(
+    uint32_t crc, const void* data, size_t size)
+{
+#ifdef STORE_CRC32C_SSE42
+    if (__builtin_cpu_supports("sse4.2"))
+    {
+        (void)pthread_once(&store_crc32c_once, &store_crc32c_init);
+
+        return ~store_crc32c_sse42_update(~crc, (const uint8_t*)data, size);
+    }
+#endif
+
+    return store_crc32c_table(crc, data, size);
+}
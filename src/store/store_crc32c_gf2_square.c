@@ -0,0 +1,26 @@
+/**
+ * \file store/store_crc32c_gf2_square.c
+ *
+ * \brief Square a matrix over GF(2).
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_internal.h"
+
+/**
+ * \brief Square a matrix over GF(2).
+ *
+ * \param square        The 32 columns of the result.
+ * \param mat           The 32 columns of the matrix to square.
+ */
+void
+store_crc32c_gf2_square(
+    uint32_t* square, const uint32_t* mat)
+{
+    for (int n = 0; n < 32; ++n)
+    {
+        square[n] = store_crc32c_gf2_times(mat, mat[n]);
+    }
+}
@@ -0,0 +1,38 @@
+/**
+ * \file store/store_crc32c_gf2_times.c
+ *
+ * \brief Multiply a vector by a matrix over GF(2).
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_internal.h"
+
+/**
+ * \brief Multiply a vector by a matrix over GF(2).
+ *
+ * \param mat           The 32 columns of the matrix.
+ * \param vec           The vector.
+ *
+ * \returns the product.
+ */
+uint32_t
+store_crc32c_gf2_times(
+    const uint32_t* mat, uint32_t vec)
+{
+    uint32_t sum = 0;
+
+    while (vec)
+    {
+        if (vec & 1)
+        {
+            sum ^= *mat;
+        }
+
+        vec >>= 1;
+        ++mat;
+    }
+
+    return sum;
+}
@@ -0,0 +1,41 @@
+/**
+ * \file store/store_crc32c_init.c
+ *
+ * \brief Build the CRC32C checksum tables.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_internal.h"
+
+/**
+ * \brief Build the checksum tables.
+ */
+void
+store_crc32c_init(void)
+{
+    for (uint32_t n = 0; n < 256; ++n)
+    {
+        uint32_t crc = n;
+        for (int k = 0; k < 8; ++k)
+        {
+            crc = (crc & 1) ? (crc >> 1) ^ STORE_CRC32C_POLY : crc >> 1;
+        }
+
+        store_crc32c_slicing[0][n] = crc;
+    }
+
+    for (uint32_t n = 0; n < 256; ++n)
+    {
+        for (int k = 1; k < 8; ++k)
+        {
+            uint32_t prev = store_crc32c_slicing[k - 1][n];
+            store_crc32c_slicing[k][n] =
+                (prev >> 8) ^ store_crc32c_slicing[0][prev & 0xff];
+        }
+    }
+
+    store_crc32c_shift_init(
+        store_crc32c_stream_shift, STORE_CRC32C_STREAM_SIZE);
+}
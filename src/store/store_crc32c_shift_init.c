@@ -0,0 +1,50 @@
+/**
+ * \file store/store_crc32c_shift_init.c
+ *
+ * \brief Build the tables that advance a CRC32C checksum past zeros.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_internal.h"
+
+/**
+ * \brief Build the tables that advance a checksum past a run of zero bytes.
+ *
+ * \param shift         The tables to build.
+ * \param size          The number of zero bytes, which must be a power of two.
+ */
+void
+store_crc32c_shift_init(
+    uint32_t shift[4][256], size_t size)
+{
+    uint32_t odd[32], even[32], row = 1;
+
+    /* the operator for one zero bit. */
+    odd[0] = STORE_CRC32C_POLY;
+    for (int n = 1; n < 32; ++n)
+    {
+        odd[n] = row;
+        row <<= 1;
+    }
+
+    /* square it up to one zero byte, and then up to the run of bytes. */
+    store_crc32c_gf2_square(even, odd);
+    store_crc32c_gf2_square(odd, even);
+    store_crc32c_gf2_square(even, odd);
+    for (size_t bytes = 1; bytes < size; bytes <<= 1)
+    {
+        store_crc32c_gf2_square(odd, even);
+        memcpy(even, odd, sizeof(even));
+    }
+
+    /* apply the operator to each byte of a checksum. */
+    for (uint32_t n = 0; n < 256; ++n)
+    {
+        shift[0][n] = store_crc32c_gf2_times(even, n);
+        shift[1][n] = store_crc32c_gf2_times(even, n << 8);
+        shift[2][n] = store_crc32c_gf2_times(even, n << 16);
+        shift[3][n] = store_crc32c_gf2_times(even, n << 24);
+    }
+}
@@ -0,0 +1,74 @@
+/**
+ * \file store/store_crc32c_sse42_update.c
+ *
+ * \brief Continue a CRC32C checksum with the SSE4.2 crc32 instruction.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_internal.h"
+
+#ifdef STORE_CRC32C_SSE42
+/**
+ * \brief Compute a checksum with the SSE4.2 crc32 instruction.
+ *
+ * \param crc           The inverted checksum so far.
+ * \param bptr          The region to checksum.
+ * \param size          The size of the region.
+ *
+ * \note The crc32 instruction has a latency of three cycles, but can start
+ * every cycle. Large regions are split into three streams that are computed
+ * together, and the stream checksums are then combined by advancing each past
+ * the streams that follow it.
+ *
+ * \returns the inverted checksum.
+ */
+__attribute__((target("sse4.2")))
+uint32_t
+store_crc32c_sse42_update(
+    uint32_t crc, const uint8_t* bptr, size_t size)
+{
+    uint64_t crc0 = crc, crc1, crc2, word0, word1, word2;
+
+    /* three streams at a time. */
+    while (size >= 3 * STORE_CRC32C_STREAM_SIZE)
+    {
+        const uint8_t* end = bptr + STORE_CRC32C_STREAM_SIZE;
+        crc1 = crc2 = 0;
+        do
+        {
+            memcpy(&word0, bptr, sizeof(word0));
+            memcpy(&word1, bptr + STORE_CRC32C_STREAM_SIZE, sizeof(word1));
+            memcpy(
+                &word2, bptr + 2 * STORE_CRC32C_STREAM_SIZE, sizeof(word2));
+            crc0 = _mm_crc32_u64(crc0, word0);
+            crc1 = _mm_crc32_u64(crc1, word1);
+            crc2 = _mm_crc32_u64(crc2, word2);
+            bptr += 8;
+        } while (bptr < end);
+
+        crc0 = store_crc32c_stream_skip((uint32_t)crc0) ^ crc1;
+        crc0 = store_crc32c_stream_skip((uint32_t)crc0) ^ crc2;
+        bptr += 2 * STORE_CRC32C_STREAM_SIZE;
+        size -= 3 * STORE_CRC32C_STREAM_SIZE;
+    }
+
+    /* then one word at a time. */
+    while (size >= 8)
+    {
+        memcpy(&word0, bptr, sizeof(word0));
+        crc0 = _mm_crc32_u64(crc0, word0);
+        bptr += 8;
+        size -= 8;
+    }
+
+    /* then one byte at a time. */
+    while (size--)
+    {
+        crc0 = _mm_crc32_u8((uint32_t)crc0, *bptr++);
+    }
+
+    return (uint32_t)crc0;
+}
+#endif
@@ -0,0 +1,30 @@
+/**
+ * \file store/store_crc32c_table.c
+ *
+ * \brief Compute the CRC32C checksum of a region with the slicing tables.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_internal.h"
+
+/**
+ * \brief Compute or continue the CRC32C checksum of a region with the slicing
+ * tables, whether or not the CPU supports SSE4.2.
+ *
+ * \param crc           The checksum of the data before this region, or 0 to
+ *                      start a new checksum.
+ * \param data          The region to checksum.
+ * \param size          The size of the region.
+ *
+ * \returns the checksum of the data so far.
+ */
+uint32_t
+store_crc32c_table(
+    uint32_t crc, const void* data, size_t size)
+{
+    (void)pthread_once(&store_crc32c_once, &store_crc32c_init);
+
+    return ~store_crc32c_table_update(~crc, (const uint8_t*)data, size);
+}
@@ -0,0 +1,53 @@
+/**
+ * \file store/store_crc32c_table_update.c
+ *
+ * \brief Continue a CRC32C checksum with the slicing tables.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_internal.h"
+
+/**
+ * \brief Compute a checksum with the slicing tables.
+ *
+ * \param crc           The inverted checksum so far.
+ * \param bptr          The region to checksum.
+ * \param size          The size of the region.
+ *
+ * \returns the inverted checksum.
+ */
+uint32_t
+store_crc32c_table_update(
+    uint32_t crc, const uint8_t* bptr, size_t size)
+{
+    uint64_t word;
+
+    while (size >= 8)
+    {
+        memcpy(&word, bptr, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        word = __builtin_bswap64(word);
+#endif
+        word ^= crc;
+        crc =
+            store_crc32c_slicing[7][word & 0xff]
+          ^ store_crc32c_slicing[6][(word >> 8) & 0xff]
+          ^ store_crc32c_slicing[5][(word >> 16) & 0xff]
+          ^ store_crc32c_slicing[4][(word >> 24) & 0xff]
+          ^ store_crc32c_slicing[3][(word >> 32) & 0xff]
+          ^ store_crc32c_slicing[2][(word >> 40) & 0xff]
+          ^ store_crc32c_slicing[1][(word >> 48) & 0xff]
+          ^ store_crc32c_slicing[0][word >> 56];
+        bptr += 8;
+        size -= 8;
+    }
+
+    while (size--)
+    {
+        crc = (crc >> 8) ^ store_crc32c_slicing[0][(crc ^ *bptr++) & 0xff];
+    }
+
+    return crc;
+}
@@ -0,0 +1,19 @@
+/**
+ * \file store/store_crc32c_tables.c
+ *
+ * \brief The shared CRC32C checksum tables.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_internal.h"
+
+/* slicing tables for the table fallback. */
+uint32_t store_crc32c_slicing[8][256];
+
+/* tables that advance a checksum past one stream of zeros. */
+uint32_t store_crc32c_stream_shift[4][256];
+
+/* the tables are built once. */
+pthread_once_t store_crc32c_once = PTHREAD_ONCE_INIT;
@@ -0,0 +1,76 @@
+/**
+ * \file store/store_create_from_buffer.c
+ *
+ * \brief Load a \ref store from a store image using multiple threads.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_internal.h"
+
+/**
+ * \brief Load a store from the given store image.
+ *
+ * \param st            Pointer to the store pointer to receive the store on
+ *                      success.
+ * \param alloc         The allocator instance to use for this operation.
+ * \param image         The store image to load.
+ * \param thread_count  The number of threads to use to deserialize records,
+ *                      or 0 to use one thread per online processor.
+ *
+ * \note The offset table of the store image is built with a single pass over
+ * the record length prefixes. The offset table is then split into one chunk
+ * per thread, and each thread deserializes its chunk using its own allocator
+ * instance, so that loader threads do not share allocator state. If the image
+ * has \ref STORE_FLAG_CRC32C set, each thread verifies the checksum of each
+ * record just before it deserializes the record. Once all
+ * chunks are loaded, they are merged into a single hash id index. If a hash id
+ * appears more than once, the record with the newest generation is indexed,
+ * and the older generations are chained behind it for
+ * \ref store_lookup_history. If the image has \ref STORE_FLAG_PERFECT_HASH
+ * set, the records are still deserialized, but the perfect hash index stored
+ * in the image replaces the hash id index, after every record is checked
+ * against its slot.
+ *
+ * This store is a \ref resource that must be released by calling
+ * \ref resource_release on its resource handle when it is no longer needed by
+ * the caller. The resource handle can be accessed by calling
+ * \ref store_resource_handle on this store instance.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_STORE_INVALID_HEADER if the store header is invalid.
+ *      - ERROR_STORE_UNKNOWN_FORMAT_VERSION if the store format version is not
+ *        supported.
+ *      - ERROR_STORE_INVALID_RECORD_SIZE if a record size is invalid.
+ *      - ERROR_STORE_CHECKSUM_MISMATCH if a record does not match its
+ *        checksum.
+ *      - ERROR_STORE_INVALID_INDEX if the perfect hash index is invalid or
+ *        does not match the records.
+ *      - ERROR_STORE_THREAD_CREATE_FAILED if a loader thread could not be
+ *        created.
+ *      - an error from \ref metadata_header_batch_check or
+ *        \ref metadata_from_data if a record could not be deserialized.
+ *
+ * \pre
+ *      - \p st must not reference a valid \ref store instance and must not be
+ *        NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ *      - \p image must reference a valid \ref secure_buffer instance.
+ * \post
+ *      - On success, \p st is set to a pointer to a valid \ref store instance,
+ *        which is a \ref resource owned by the caller that must be released
+ *        when no longer needed.
+ *      - On failure, \p st is not changed and an error status is returned.
+ */
+status FN_DECL_MUST_CHECK
+store_create_from_buffer(
+    store** st, RCPR_SYM(allocator)* alloc, const secure_buffer* image,
+    size_t thread_count)
+{
+    return
+        store_create_from_buffer_with_flags(st, alloc, image, thread_count, 0);
+}
@@ -0,0 +1,56 @@
+/**
+ * \file store/store_create_from_buffer_with_flags.c
+ *
+ * \brief Load a \ref store from a store image using multiple threads, with
+ * the given load flags.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_internal.h"
+
+/**
+ * \brief Load a store from the given store image, with the given load flags.
+ *
+ * \param st            Pointer to the store pointer to receive the store on
+ *                      success.
+ * \param alloc         The allocator instance to use for this operation.
+ * \param image         The store image to load.
+ * \param thread_count  The number of threads to use to deserialize records,
+ *                      or 0 to use one thread per online processor.
+ * \param flags         Zero or more STORE_LOAD_FLAG_ values.
+ *
+ * \note This loads the store exactly as \ref store_create_from_buffer does. If
+ * a huge page flag is set, the record table, the hash id index, and the
+ * generation chain links are placed together in one mapping of whole huge
+ * pages, so that lookups across a large store touch few TLB entries. If huge
+ * pages are not available, the mapping falls back to transparent huge pages
+ * and then to ordinary pages, and if no mapping can be made, the store
+ * allocator is used. \ref store_page_mode_get reports which was used. The
+ * records themselves are still allocated by the loader threads.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error from \ref store_create_from_buffer on failure.
+ *
+ * \pre
+ *      - \p st must not reference a valid \ref store instance and must not be
+ *        NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ *      - \p image must reference a valid \ref secure_buffer instance.
+ * \post
+ *      - On success, \p st is set to a pointer to a valid \ref store instance,
+ *        which is a \ref resource owned by the caller that must be released
+ *        when no longer needed.
+ *      - On failure, \p st is not changed and an error status is returned.
+ */
+status FN_DECL_MUST_CHECK
+store_create_from_buffer_with_flags(
+    store** st, RCPR_SYM(allocator)* alloc, const secure_buffer* image,
+    size_t thread_count, uint32_t flags)
+{
+    return
+        store_create_from_buffer_with_snapshot(
+            st, alloc, image, NULL, thread_count, flags);
+}
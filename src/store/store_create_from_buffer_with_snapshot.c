@@ -0,0 +1,404 @@
+/**
+ * \file store/store_create_from_buffer_with_snapshot.c
+ *
+ * \brief Load a \ref store from a store image using multiple threads, with
+ * the given load flags, starting from an index snapshot.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <pthread.h>
+#include <string.h>
+
+#include "store_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Load a store from the given store image, with the given load flags,
+ * starting from an index snapshot.
+ *
+ * \param st            Pointer to the store pointer to receive the store on
+ *                      success.
+ * \param alloc         The allocator instance to use for this operation.
+ * \param image         The store image to load.
+ * \param snapshot      An index snapshot written by \ref store_snapshot_create
+ *                      for an earlier load of this image, or NULL.
+ * \param thread_count  The number of threads to use to deserialize records,
+ *                      or 0 to use one thread per online processor.
+ * \param flags         Zero or more STORE_LOAD_FLAG_ values.
+ *
+ * \note The offset table of the store image is built with a single pass over
+ * the record length prefixes. The offset table is then split into one chunk
+ * per thread, and each thread deserializes its chunk using its own allocator
+ * instance, so that loader threads do not share allocator state. If the image
+ * has \ref STORE_FLAG_CRC32C set, each thread verifies the checksum of each
+ * record just before it deserializes the record. Once all
+ * chunks are loaded, they are merged into a single hash id index. If a hash id
+ * appears more than once, the record with the newest generation is indexed,
+ * and the older generations are chained behind it for
+ * \ref store_lookup_history. If the image has \ref STORE_FLAG_PERFECT_HASH
+ * set, the records are still deserialized, but the perfect hash index stored
+ * in the image replaces the hash id index, after every record is checked
+ * against its slot. If a huge page flag is set, the record table, the index,
+ * and the generation chain links share one mapping of whole huge pages, with
+ * the fallbacks described by \ref store_page_mode_get. If a usable snapshot
+ * is given, the chains it holds are copied into the index after the hash of
+ * each record it covers is checked, and only the records appended since it
+ * was written are merged. A snapshot that does not match the image is
+ * ignored.
+ *
+ * This store is a \ref resource that must be released by calling
+ * \ref resource_release on its resource handle when it is no longer needed by
+ * the caller. The resource handle can be accessed by calling
+ * \ref store_resource_handle on this store instance.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_STORE_INVALID_HEADER if the store header is invalid.
+ *      - ERROR_STORE_UNKNOWN_FORMAT_VERSION if the store format version is not
+ *        supported.
+ *      - ERROR_STORE_INVALID_RECORD_SIZE if a record size is invalid.
+ *      - ERROR_STORE_CHECKSUM_MISMATCH if a record does not match its
+ *        checksum.
+ *      - ERROR_STORE_INVALID_INDEX if the perfect hash index is invalid or
+ *        does not match the records.
+ *      - ERROR_STORE_THREAD_CREATE_FAILED if a loader thread could not be
+ *        created.
+ *      - an error from \ref metadata_header_batch_check or
+ *        \ref metadata_from_data if a record could not be deserialized.
+ *
+ * \pre
+ *      - \p st must not reference a valid \ref store instance and must not be
+ *        NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ *      - \p image must reference a valid \ref secure_buffer instance.
+ * \post
+ *      - On success, \p st is set to a pointer to a valid \ref store instance,
+ *        which is a \ref resource owned by the caller that must be released
+ *        when no longer needed.
+ *      - On failure, \p st is not changed and an error status is returned.
+ */
+status FN_DECL_MUST_CHECK
+store_create_from_buffer_with_snapshot(
+    store** st, RCPR_SYM(allocator)* alloc, const secure_buffer* image,
+    const secure_buffer* snapshot, size_t thread_count, uint32_t flags)
+{
+    status retval, release_retval;
+    const uint8_t* image_data;
+    size_t image_size;
+    size_t records_end;
+    size_t index_size = 0;
+    metadata_extent* offsets = NULL;
+    size_t bad_index;
+    uint32_t header_flags, generation;
+    size_t record_count = 0U;
+    size_t index_capacity = 16;
+    const uint8_t* snapshot_data = NULL;
+    size_t snapshot_size, snapshot_count = 0U, snapshot_capacity = 0U;
+    uint64_t* hashes = NULL;
+    store_loader_chunk* chunks = NULL;
+    store* tmp = NULL;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != st);
+    RCPR_MODEL_ASSERT(prop_allocator_valid(alloc));
+    RCPR_MODEL_ASSERT(prop_secure_buffer_valid(image));
+    RCPR_MODEL_ASSERT(NULL == snapshot || prop_secure_buffer_valid(snapshot));
+
+    /* get the image data. */
+    image_data =
+        (const uint8_t*)secure_buffer_data(&image_size, (secure_buffer*)image);
+
+    /* verify the store header. */
+    retval =
+        store_header_read(&header_flags, &generation, image_data, image_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* a perfect hash index sits between the records and the footer. */
+    records_end = image_size;
+    if (header_flags & STORE_FLAG_PERFECT_HASH)
+    {
+        retval =
+            store_index_footer_read(
+                &records_end, &index_size, image_data, image_size);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto done;
+        }
+    }
+
+    /* build the offset table. */
+    retval =
+        store_offset_table_build(
+            &offsets, &record_count, alloc, image_data, records_end,
+            (header_flags & STORE_FLAG_CRC32C)
+                ? STORE_RECORD_TRAILER_SIZE : 0);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* reject a corrupt record before any record is allocated. */
+    retval =
+        metadata_header_batch_check(
+            &bad_index, image_data, offsets, record_count);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_offsets;
+    }
+
+    /* decide how many loader threads to use. */
+    thread_count = store_loader_thread_count(thread_count, record_count);
+
+    /* a snapshot only stands in for the hash id index. */
+    if (NULL != snapshot && !(header_flags & STORE_FLAG_PERFECT_HASH))
+    {
+        snapshot_data =
+            (const uint8_t*)secure_buffer_data(
+                &snapshot_size, (secure_buffer*)snapshot);
+        if (!store_snapshot_header_read(
+                &snapshot_count, &snapshot_capacity, snapshot_data,
+                snapshot_size, generation, record_count))
+        {
+            snapshot_data = NULL;
+            snapshot_count = 0U;
+        }
+    }
+
+    /* allocate memory for the store instance. */
+    retval = allocator_allocate(alloc, (void**)&tmp, sizeof(*tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_offsets;
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(tmp, 0, sizeof(*tmp)));
+
+    /* the tag is not set by default. */
+    RCPR_MODEL_ONLY(tmp->RCPR_MODEL_STRUCT_TAG_REF(store) = 0);
+    RCPR_MODEL_ASSERT_STRUCT_TAG_NOT_INITIALIZED(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(store), store);
+
+    /* set the tag. */
+    RCPR_MODEL_STRUCT_TAG_INIT(tmp->RCPR_MODEL_STRUCT_TAG_REF(store), store);
+
+    /* initialize resource. From here on, releasing tmp cleans up whatever has
+     * been loaded so far. */
+    resource_init(&tmp->hdr, &store_resource_release);
+    tmp->alloc = alloc;
+    tmp->record_count = record_count;
+    tmp->generation = generation;
+    tmp->page_mode = STORE_PAGE_MODE_DEFAULT;
+    tmp->region = NULL;
+
+    /* size the index to keep the load factor at or below 1/2. A perfect hash
+     * index leaves the hash id index empty. */
+    while (0 == index_size && index_capacity < 2 * record_count)
+    {
+        index_capacity *= 2;
+    }
+
+    /* allocate the record array, the index, and the generation chain links. */
+    retval = store_tables_allocate(tmp, index_capacity, flags);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    /* allocate the per-thread arena array. */
+    retval =
+        allocator_allocate(
+            alloc, (void**)&tmp->arenas, thread_count * sizeof(*tmp->arenas));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    RCPR_MODEL_EXEMPT(
+        memset(tmp->arenas, 0, thread_count * sizeof(*tmp->arenas)));
+    tmp->arena_count = thread_count;
+
+    /* create an arena for each loader thread. */
+    for (size_t i = 0; i < thread_count; ++i)
+    {
+        retval = malloc_allocator_create(&tmp->arenas[i]);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_tmp;
+        }
+    }
+
+    /* allocate the per-record hash array. */
+    retval =
+        allocator_allocate(
+            alloc, (void**)&hashes, (record_count + 1) * sizeof(*hashes));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    /* allocate the chunk array. */
+    retval =
+        allocator_allocate(
+            alloc, (void**)&chunks, thread_count * sizeof(*chunks));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_hashes;
+    }
+
+    /* split the offset table into one chunk per thread. */
+    size_t chunk_size = (record_count + thread_count - 1) / thread_count;
+    for (size_t i = 0; i < thread_count; ++i)
+    {
+        RCPR_MODEL_EXEMPT(memset(&chunks[i], 0, sizeof(chunks[i])));
+        chunks[i].image = image_data;
+        chunks[i].offsets = offsets;
+        chunks[i].checksummed = (header_flags & STORE_FLAG_CRC32C);
+        chunks[i].begin = i * chunk_size;
+        chunks[i].end = chunks[i].begin + chunk_size;
+        if (chunks[i].begin > record_count)
+        {
+            chunks[i].begin = record_count;
+        }
+        if (chunks[i].end > record_count)
+        {
+            chunks[i].end = record_count;
+        }
+        chunks[i].records = tmp->records;
+        chunks[i].hashes = hashes;
+        chunks[i].arena = tmp->arenas[i];
+        chunks[i].retval = STATUS_SUCCESS;
+    }
+
+    /* start a thread for every chunk but the first. */
+    retval = STATUS_SUCCESS;
+    for (size_t i = 1; i < thread_count; ++i)
+    {
+        if (0 !=
+                pthread_create(
+                    &chunks[i].thread, NULL, &store_loader_thread, &chunks[i]))
+        {
+            retval = ERROR_STORE_THREAD_CREATE_FAILED;
+            break;
+        }
+
+        chunks[i].thread_started = true;
+    }
+
+    /* the calling thread loads the first chunk. */
+    if (STATUS_SUCCESS == retval)
+    {
+        store_loader_chunk_load(&chunks[0]);
+    }
+
+    /* wait for every started thread. */
+    for (size_t i = 1; i < thread_count; ++i)
+    {
+        if (chunks[i].thread_started)
+        {
+            pthread_join(chunks[i].thread, NULL);
+        }
+    }
+
+    /* bail out if any thread could not be started. */
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_chunks;
+    }
+
+    /* bail out if any chunk failed to load. */
+    for (size_t i = 0; i < thread_count; ++i)
+    {
+        if (STATUS_SUCCESS != chunks[i].retval)
+        {
+            retval = chunks[i].retval;
+            goto cleanup_chunks;
+        }
+    }
+
+    /* check every record against the perfect hash index. */
+    if (header_flags & STORE_FLAG_PERFECT_HASH)
+    {
+        retval =
+            store_perfect_index_load(
+                tmp, hashes, image_data + records_end, index_size);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_chunks;
+        }
+    }
+
+    /* copy in the chains of the snapshot, or start over without it. */
+    if (NULL != snapshot_data
+     && !store_snapshot_index_load(
+            tmp, hashes, snapshot_data, snapshot_count, snapshot_capacity))
+    {
+        RCPR_MODEL_EXEMPT(
+            memset(tmp->index, 0, index_capacity * sizeof(*tmp->index)));
+        snapshot_count = 0U;
+    }
+
+    tmp->snapshot_record_count = snapshot_count;
+
+    /* merge every chunk not covered by the snapshot into the index, in store
+     * order. */
+    for (size_t i = snapshot_count; 0 == index_size && i < record_count; ++i)
+    {
+        retval = store_index_insert(tmp, hashes[i], i);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_chunks;
+        }
+    }
+
+    /* success. */
+    *st = tmp;
+    tmp = NULL;
+    retval = STATUS_SUCCESS;
+    goto cleanup_chunks;
+
+cleanup_chunks:
+    RCPR_MODEL_EXEMPT(memset(chunks, 0, thread_count * sizeof(*chunks)));
+    release_retval = allocator_reclaim(alloc, chunks);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_hashes:
+    release_retval = allocator_reclaim(alloc, hashes);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_tmp:
+    if (NULL != tmp)
+    {
+        release_retval = resource_release(&tmp->hdr);
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+cleanup_offsets:
+    release_retval = allocator_reclaim(alloc, offsets);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
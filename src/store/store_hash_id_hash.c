@@ -0,0 +1,66 @@
+/**
+ * \file store/store_hash_id_hash.c
+ *
+ * \brief Compute the index hash for a hash id.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "store_internal.h"
+
+/**
+ * \brief Mix a 64-bit value.
+ *
+ * \param x             The value to mix.
+ *
+ * \returns the mixed value.
+ */
+static inline uint64_t store_hash_mix(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+
+    return x;
+}
+
+/**
+ * \brief Compute the index hash for a hash id.
+ *
+ * \param hash_id       The hash id to hash.
+ * \param hash_id_size  The size of the hash id.
+ *
+ * \returns the 64-bit index hash for this hash id.
+ */
+uint64_t
+store_hash_id_hash(
+    const void* hash_id, size_t hash_id_size)
+{
+    const uint8_t* bptr = (const uint8_t*)hash_id;
+    uint64_t hash = 0x9e3779b97f4a7c15ULL ^ hash_id_size;
+    uint64_t word;
+
+    /* hash id values are usually digests, so mix them a word at a time. */
+    while (hash_id_size >= sizeof(word))
+    {
+        memcpy(&word, bptr, sizeof(word));
+        hash = store_hash_mix(hash ^ word);
+        bptr += sizeof(word);
+        hash_id_size -= sizeof(word);
+    }
+
+    /* mix in any trailing bytes. */
+    if (hash_id_size > 0)
+    {
+        word = 0;
+        memcpy(&word, bptr, hash_id_size);
+        hash = store_hash_mix(hash ^ word);
+    }
+
+    return hash;
+}
@@ -0,0 +1,72 @@
+/**
+ * \file store/store_header_read.c
+ *
+ * \brief Read the header of a store image.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <rcpr/socket_utilities.h>
+#include <string.h>
+
+#include "store_internal.h"
+
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Verify the header of a store image.
+ *
+ * \param flags         Pointer to receive the store header flags on success.
+ * \param generation    Pointer to receive the store generation on success.
+ * \param image         The store image.
+ * \param image_size    The size of the store image.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_INVALID_HEADER if the store header is invalid.
+ *      - ERROR_STORE_UNKNOWN_FORMAT_VERSION if the store format version is not
+ *        supported.
+ */
+status FN_DECL_MUST_CHECK
+store_header_read(
+    uint32_t* flags, uint32_t* generation, const uint8_t* image,
+    size_t image_size)
+{
+    uint32_t net_field;
+
+    /* verify that the image is large enough for the header. */
+    if (image_size < STORE_HEADER_SIZE)
+    {
+        return ERROR_STORE_INVALID_HEADER;
+    }
+
+    /* verify the magic number. */
+    memcpy(&net_field, image, sizeof(net_field));
+    if (STORE_MAGIC != socket_utility_ntoh32(net_field))
+    {
+        return ERROR_STORE_INVALID_HEADER;
+    }
+
+    /* verify the format version. */
+    memcpy(&net_field, image + 4, sizeof(net_field));
+    if (STORE_FORMAT_VERSION_1 != socket_utility_ntoh32(net_field))
+    {
+        return ERROR_STORE_UNKNOWN_FORMAT_VERSION;
+    }
+
+    /* only supported flags may be set. */
+    memcpy(&net_field, image + 8, sizeof(net_field));
+    *flags = socket_utility_ntoh32(net_field);
+    if (*flags & ~STORE_FLAGS_SUPPORTED)
+    {
+        return ERROR_STORE_INVALID_HEADER;
+    }
+
+    /* any generation is valid. */
+    memcpy(&net_field, image + 12, sizeof(net_field));
+    *generation = socket_utility_ntoh32(net_field);
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,62 @@
+/**
+ * \file store/store_history_next.c
+ *
+ * \brief Step to the next older generation of a record in a \ref store.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+
+#include "store_internal.h"
+
+/**
+ * \brief Step to the next older generation of a record.
+ *
+ * \param meta          Pointer to receive the record on success.
+ * \param cursor        Pointer to the history cursor, which is advanced on
+ *                      success.
+ * \param st            The \ref store instance for this operation.
+ *
+ * \note Generations are returned newest first. Records with the same
+ * generation are returned in reverse store image order.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_RECORD_NOT_FOUND if there are no older generations.
+ *
+ * \pre
+ *      - \p meta must be a valid pointer.
+ *      - \p cursor must have been set by \ref store_lookup_history or by a
+ *        successful call to this method on the same store.
+ *      - \p st must reference a valid \ref store instance.
+ * \post
+ *      - On success, \p meta is set to the next older generation, and
+ *        \p cursor is set to its position in the generation chain.
+ *      - On failure, \p meta and \p cursor are unchanged.
+ */
+status FN_DECL_MUST_CHECK
+store_history_next(
+    const metadata** meta, size_t* cursor, const store* st)
+{
+    size_t next;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != meta);
+    RCPR_MODEL_ASSERT(NULL != cursor);
+    RCPR_MODEL_ASSERT(prop_store_valid(st));
+    RCPR_MODEL_ASSERT(*cursor < st->record_count);
+
+    /* follow the link to the next older generation. */
+    next = st->older[*cursor];
+    if (STORE_HISTORY_END == next)
+    {
+        return ERROR_STORE_RECORD_NOT_FOUND;
+    }
+
+    *meta = st->records[next];
+    *cursor = next;
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,71 @@
+/**
+ * \file store/store_index_footer_check.c
+ *
+ * \brief Parse and check the index footer of a store image.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <rcpr/socket_utilities.h>
+#include <string.h>
+
+#include "store_internal.h"
+
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Parse the index footer of a store image with
+ * \ref STORE_FLAG_PERFECT_HASH set, and check it against the image size.
+ *
+ * \param records_end   Pointer to receive the end of the records on success.
+ * \param index_size    Pointer to receive the size of the serialized perfect
+ *                      hash on success.
+ * \param index_crc     Pointer to receive the checksum of the serialized
+ *                      perfect hash on success.
+ * \param footer        The STORE_INDEX_FOOTER_SIZE bytes of the footer.
+ * \param image_size    The size of the store image, which must hold at least
+ *                      a header and a footer.
+ *
+ * \note This is shared by \ref store_index_footer_read, which has the whole
+ * image, and the store file, which only reads the footer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_INVALID_INDEX if the footer is invalid.
+ */
+status FN_DECL_MUST_CHECK
+store_index_footer_check(
+    size_t* records_end, size_t* index_size, uint32_t* index_crc,
+    const uint8_t* footer, uint64_t image_size)
+{
+    uint32_t net_field;
+    uint64_t net_size;
+    uint64_t end, size;
+
+    memcpy(&net_field, footer, sizeof(net_field));
+    if (STORE_INDEX_MAGIC != socket_utility_ntoh32(net_field))
+    {
+        return ERROR_STORE_INVALID_INDEX;
+    }
+
+    /* the records and the index must fill the space before the footer. */
+    memcpy(&net_size, footer + 8, sizeof(net_size));
+    end = socket_utility_ntoh64(net_size);
+    memcpy(&net_size, footer + 16, sizeof(net_size));
+    size = socket_utility_ntoh64(net_size);
+    if (end < STORE_HEADER_SIZE
+     || end > image_size - STORE_INDEX_FOOTER_SIZE
+     || size != image_size - STORE_INDEX_FOOTER_SIZE - end)
+    {
+        return ERROR_STORE_INVALID_INDEX;
+    }
+
+    memcpy(&net_field, footer + 4, sizeof(net_field));
+    *records_end = (size_t)end;
+    *index_size = (size_t)size;
+    *index_crc = socket_utility_ntoh32(net_field);
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,61 @@
+/**
+ * \file store/store_index_footer_read.c
+ *
+ * \brief Read the perfect hash index footer of a store image.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+
+#include "store_internal.h"
+
+/**
+ * \brief Read the index footer of a store image with
+ * \ref STORE_FLAG_PERFECT_HASH set.
+ *
+ * \param records_end   Pointer to receive the end of the records on success.
+ * \param index_size    Pointer to receive the size of the serialized perfect
+ *                      hash on success.
+ * \param image         The store image.
+ * \param image_size    The size of the store image.
+ *
+ * \note The perfect hash starts at the end of the records, and its checksum
+ * is verified here.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_INVALID_INDEX if the footer is invalid, or if the
+ *        perfect hash does not match its checksum.
+ */
+status FN_DECL_MUST_CHECK
+store_index_footer_read(
+    size_t* records_end, size_t* index_size, const uint8_t* image,
+    size_t image_size)
+{
+    status retval;
+    uint32_t index_crc;
+
+    /* the footer follows at least the header. */
+    if (image_size < STORE_HEADER_SIZE + STORE_INDEX_FOOTER_SIZE)
+    {
+        return ERROR_STORE_INVALID_INDEX;
+    }
+
+    retval =
+        store_index_footer_check(
+            records_end, index_size, &index_crc,
+            image + image_size - STORE_INDEX_FOOTER_SIZE, image_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    if (index_crc != store_crc32c(0, image + *records_end, *index_size))
+    {
+        return ERROR_STORE_INVALID_INDEX;
+    }
+
+    return STATUS_SUCCESS;
+}
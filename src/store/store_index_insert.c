@@ -0,0 +1,124 @@
+/**
+ * \file store/store_index_insert.c
+ *
+ * \brief Insert a record into the hash id index of a \ref store.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_internal.h"
+
+/**
+ * \brief Insert a record into the hash id index of a \ref store.
+ *
+ * \param st            The \ref store instance for this operation.
+ * \param hash          The index hash of this record's hash id.
+ * \param index         The position of the record in the store.
+ *
+ * \note If a record with the same hash id is already indexed, then the record
+ * is linked into the generation chain of that hash id, which is kept newest
+ * first. On a tie, the later record comes first. Records are usually appended
+ * in generation order, so the new record is usually the new head.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_METADATA_FIELD_NOT_SET if the record is missing its hash id or
+ *        generation.
+ *
+ * \pre
+ *      - \p st must reference a valid \ref store instance whose index has at
+ *        least one empty entry.
+ *      - \p index must be less than the record count of this store, and the
+ *        record at this position must not already be indexed.
+ */
+status FN_DECL_MUST_CHECK
+store_index_insert(
+    store* st, uint64_t hash, size_t index)
+{
+    status retval;
+    const void* hash_id;
+    size_t hash_id_size;
+    uint32_t generation, chain_generation;
+    size_t prev, next;
+    metadata* record = st->records[index];
+    size_t slot = hash & st->index_mask;
+
+    /* get the hash id for this record. */
+    retval = metadata_hash_id_get(&hash_id, &hash_id_size, record);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* get the generation for this record. */
+    retval = metadata_generation_get(&generation, record);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* linear probe until we find this hash id or an empty entry. */
+    while (NULL != st->index[slot].record)
+    {
+        if (st->index[slot].hash == hash
+         && store_record_hash_id_equals(
+                st->index[slot].record, hash_id, hash_id_size))
+        {
+            /* get the generation of the head of the chain. */
+            retval =
+                metadata_generation_get(
+                    &chain_generation, st->index[slot].record);
+            if (STATUS_SUCCESS != retval)
+            {
+                return retval;
+            }
+
+            /* a newer generation becomes the new head. */
+            if (generation >= chain_generation)
+            {
+                st->older[index] = st->index[slot].head;
+                st->index[slot].head = index;
+                st->index[slot].record = record;
+
+                return STATUS_SUCCESS;
+            }
+
+            /* otherwise, walk the chain to the first older generation. */
+            prev = st->index[slot].head;
+            while (STORE_HISTORY_END != (next = st->older[prev]))
+            {
+                retval =
+                    metadata_generation_get(
+                        &chain_generation, st->records[next]);
+                if (STATUS_SUCCESS != retval)
+                {
+                    return retval;
+                }
+
+                if (generation >= chain_generation)
+                {
+                    break;
+                }
+
+                prev = next;
+            }
+
+            /* link this record in ahead of it. */
+            st->older[index] = next;
+            st->older[prev] = index;
+
+            return STATUS_SUCCESS;
+        }
+
+        slot = (slot + 1) & st->index_mask;
+    }
+
+    /* this record starts a new chain in this empty entry. */
+    st->index[slot].hash = hash;
+    st->index[slot].record = record;
+    st->index[slot].head = index;
+    st->older[index] = STORE_HISTORY_END;
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,606 @@
+/**
+ * \file store/store_internal.h
+ *
+ * \brief Internal header for \ref store.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <nepe2/perfect_hash.h>
+#include <nepe2/store.h>
+#include <pthread.h>
+#include <rcpr/resource/protected.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__)
+# include <immintrin.h>
+# define STORE_CRC32C_SSE42                                                  1
+#endif
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief The end of a generation chain.
+ */
+#define STORE_HISTORY_END                                             SIZE_MAX
+
+/**
+ * \brief The number of lookups that \ref store_lookup_batch keeps in flight.
+ */
+#define STORE_LOOKUP_GROUP_SIZE                                             16
+
+/**
+ * \brief How many index entries ahead an index snapshot is prefetched while it
+ * is loaded.
+ */
+#define STORE_SNAPSHOT_PREFETCH_DISTANCE                                    16
+
+/**
+ * \brief The reflected CRC32C (Castagnoli) polynomial.
+ */
+#define STORE_CRC32C_POLY                                           0x82f63b78
+
+/**
+ * \brief The length of each of the three interleaved CRC32C streams.
+ */
+#define STORE_CRC32C_STREAM_SIZE                                           256
+
+/**
+ * \brief The slicing tables for the CRC32C table fallback.
+ */
+extern uint32_t store_crc32c_slicing[8][256];
+
+/**
+ * \brief The tables that advance a CRC32C checksum past one stream of zeros.
+ */
+extern uint32_t store_crc32c_stream_shift[4][256];
+
+/**
+ * \brief Guards the one-time build of the CRC32C tables.
+ */
+extern pthread_once_t store_crc32c_once;
+
+/**
+ * \brief An entry in the open addressed hash id index.
+ *
+ * Each entry holds the newest generation of its hash id, and the position of
+ * that record in the store, which is the head of its generation chain. Empty
+ * entries have a NULL record.
+ */
+typedef struct store_index_entry store_index_entry;
+
+struct store_index_entry
+{
+    uint64_t hash;
+    metadata* record;
+    size_t head;
+};
+
+struct store
+{
+    RCPR_SYM(resource) hdr;
+    RCPR_MODEL_STRUCT_TAG(store);
+    RCPR_SYM(allocator)* alloc;
+    size_t arena_count;
+    RCPR_SYM(allocator)** arenas;
+    size_t record_count;
+    metadata** records;
+    size_t index_mask;
+    store_index_entry* index;
+    size_t* older;
+    int page_mode;
+    void* region;
+    size_t region_size;
+    perfect_hash* perfect_index;
+    uint32_t generation;
+    size_t snapshot_record_count;
+};
+
+/**
+ * \brief A contiguous chunk of the offset table loaded by a single thread.
+ */
+typedef struct store_loader_chunk store_loader_chunk;
+
+struct store_loader_chunk
+{
+    pthread_t thread;
+    bool thread_started;
+    const uint8_t* image;
+    const metadata_extent* offsets;
+    bool checksummed;
+    size_t begin;
+    size_t end;
+    metadata** records;
+    uint64_t* hashes;
+    RCPR_SYM(allocator)* arena;
+    status retval;
+};
+
+/**
+ * \brief Release a \ref store resource.
+ *
+ * \param r             Pointer to the \ref store resource to be released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status store_resource_release(RCPR_SYM(resource)* r);
+
+/**
+ * \brief Map a zeroed region backed by huge pages.
+ *
+ * \param region        Pointer to receive the region, or NULL if no region
+ *                      could be mapped.
+ * \param region_size   Pointer to receive the mapped size of the region.
+ * \param size          The number of bytes needed.
+ * \param flags         The STORE_LOAD_FLAG_ values that select the kinds of
+ *                      huge pages to try.
+ *
+ * \returns the STORE_PAGE_MODE_ value of the region.
+ */
+int
+store_pages_map(
+    void** region, size_t* region_size, size_t size, uint32_t flags);
+
+/**
+ * \brief Compute or continue the CRC32C checksum of a region with the slicing
+ * tables, whether or not the CPU supports SSE4.2.
+ *
+ * \param crc           The checksum of the data before this region, or 0 to
+ *                      start a new checksum.
+ * \param data          The region to checksum.
+ * \param size          The size of the region.
+ *
+ * \note This is the fallback used by \ref store_crc32c, and is exposed so that
+ * it can be checked against the SSE4.2 path.
+ *
+ * \returns the checksum of the data so far.
+ */
+uint32_t
+store_crc32c_table(
+    uint32_t crc, const void* data, size_t size);
+
+/**
+ * \brief Multiply a vector by a matrix over GF(2).
+ *
+ * \param mat           The 32 columns of the matrix.
+ * \param vec           The vector.
+ *
+ * \returns the product.
+ */
+uint32_t
+store_crc32c_gf2_times(
+    const uint32_t* mat, uint32_t vec);
+
+/**
+ * \brief Square a matrix over GF(2).
+ *
+ * \param square        The 32 columns of the result.
+ * \param mat           The 32 columns of the matrix to square.
+ */
+void
+store_crc32c_gf2_square(
+    uint32_t* square, const uint32_t* mat);
+
+/**
+ * \brief Build the tables that advance a checksum past a run of zero bytes.
+ *
+ * \param shift         The tables to build.
+ * \param size          The number of zero bytes, which must be a power of two.
+ */
+void
+store_crc32c_shift_init(
+    uint32_t shift[4][256], size_t size);
+
+/**
+ * \brief Build the checksum tables.
+ */
+void
+store_crc32c_init(void);
+
+/**
+ * \brief Compute a checksum with the slicing tables.
+ *
+ * \param crc           The inverted checksum so far.
+ * \param bptr          The region to checksum.
+ * \param size          The size of the region.
+ *
+ * \returns the inverted checksum.
+ */
+uint32_t
+store_crc32c_table_update(
+    uint32_t crc, const uint8_t* bptr, size_t size);
+
+#ifdef STORE_CRC32C_SSE42
+/**
+ * \brief Advance a checksum past one stream of zeros.
+ *
+ * \param crc           The checksum to advance.
+ *
+ * \returns the advanced checksum.
+ */
+static inline uint32_t store_crc32c_stream_skip(uint32_t crc)
+{
+    return
+        store_crc32c_stream_shift[0][crc & 0xff]
+      ^ store_crc32c_stream_shift[1][(crc >> 8) & 0xff]
+      ^ store_crc32c_stream_shift[2][(crc >> 16) & 0xff]
+      ^ store_crc32c_stream_shift[3][crc >> 24];
+}
+
+/**
+ * \brief Compute a checksum with the SSE4.2 crc32 instruction.
+ *
+ * \param crc           The inverted checksum so far.
+ * \param bptr          The region to checksum.
+ * \param size          The size of the region.
+ *
+ * \note The crc32 instruction has a latency of three cycles, but can start
+ * every cycle. Large regions are split into three streams that are computed
+ * together, and the stream checksums are then combined by advancing each past
+ * the streams that follow it.
+ *
+ * \returns the inverted checksum.
+ */
+__attribute__((target("sse4.2")))
+uint32_t
+store_crc32c_sse42_update(
+    uint32_t crc, const uint8_t* bptr, size_t size);
+#endif
+
+/**
+ * \brief Compute the checksum of the index hashes of a run of records, as
+ * stored in an index snapshot.
+ *
+ * \param hashes        The index hash of each record, in store order.
+ * \param count         The number of records.
+ *
+ * \returns the CRC32C of the big-endian index hashes.
+ */
+uint32_t
+store_snapshot_hash_crc(
+    const uint64_t* hashes, size_t count);
+
+/**
+ * \brief Return true if the given record has the given hash id.
+ *
+ * \param record        The record to check.
+ * \param hash_id       The hash id to compare.
+ * \param hash_id_size  The size of the hash id.
+ *
+ * \returns true if the record's hash id matches, and false otherwise.
+ */
+static inline bool
+store_record_hash_id_equals(
+    const metadata* record, const void* hash_id, size_t hash_id_size)
+{
+    const void* record_hash_id;
+    size_t record_hash_id_size;
+
+    if (STATUS_SUCCESS
+            != metadata_hash_id_get(
+                    &record_hash_id, &record_hash_id_size, record))
+    {
+        return false;
+    }
+
+    return
+        record_hash_id_size == hash_id_size
+     && !memcmp(record_hash_id, hash_id, hash_id_size);
+}
+
+/**
+ * \brief Find the newest record for a hash id.
+ *
+ * \param st            The \ref store instance for this operation.
+ * \param hash          The index hash of this hash id.
+ * \param hash_id       The hash id to find.
+ * \param hash_id_size  The size of the hash id.
+ *
+ * \note If the store was loaded with a perfect hash index, the only candidate
+ * is the record in the slot of this hash, and there is no generation chain.
+ *
+ * \returns the position of the newest record with this hash id, which is the
+ * head of its generation chain, or \ref STORE_HISTORY_END if it is not
+ * indexed.
+ */
+static inline size_t
+store_index_find(
+    const store* st, uint64_t hash, const void* hash_id, size_t hash_id_size)
+{
+    size_t slot;
+
+    /* a perfect hash names one slot, which must hold this hash id. */
+    if (NULL != st->perfect_index)
+    {
+        uint64_t position = perfect_hash_lookup(st->perfect_index, hash);
+        if (position < st->record_count
+         && store_record_hash_id_equals(
+                st->records[position], hash_id, hash_id_size))
+        {
+            return (size_t)position;
+        }
+
+        return STORE_HISTORY_END;
+    }
+
+    /* linear probe until we find this hash id or an empty entry. */
+    slot = hash & st->index_mask;
+    while (NULL != st->index[slot].record)
+    {
+        if (st->index[slot].hash == hash
+         && store_record_hash_id_equals(
+                st->index[slot].record, hash_id, hash_id_size))
+        {
+            return st->index[slot].head;
+        }
+
+        slot = (slot + 1) & st->index_mask;
+    }
+
+    return STORE_HISTORY_END;
+}
+
+/**
+ * \brief Insert a record into the hash id index of a \ref store.
+ *
+ * \param st            The \ref store instance for this operation.
+ * \param hash          The index hash of this record's hash id.
+ * \param index         The position of the record in the store.
+ *
+ * \note If a record with the same hash id is already indexed, then the record
+ * is linked into the generation chain of that hash id, which is kept newest
+ * first. On a tie, the later record comes first.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_METADATA_FIELD_NOT_SET if the record is missing its hash id or
+ *        generation.
+ *
+ * \pre
+ *      - \p st must reference a valid \ref store instance whose index has at
+ *        least one empty entry.
+ *      - \p index must be less than the record count of this store, and the
+ *        record at this position must not already be indexed.
+ */
+status FN_DECL_MUST_CHECK
+store_index_insert(
+    store* st, uint64_t hash, size_t index);
+
+/**
+ * \brief Verify the header of a store image.
+ *
+ * \param flags         Pointer to receive the store header flags on success.
+ * \param generation    Pointer to receive the store generation on success.
+ * \param image         The store image.
+ * \param image_size    The size of the store image.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_INVALID_HEADER if the store header is invalid.
+ *      - ERROR_STORE_UNKNOWN_FORMAT_VERSION if the store format version is not
+ *        supported.
+ */
+status FN_DECL_MUST_CHECK
+store_header_read(
+    uint32_t* flags, uint32_t* generation, const uint8_t* image,
+    size_t image_size);
+
+/**
+ * \brief Read the index footer of a store image with
+ * \ref STORE_FLAG_PERFECT_HASH set.
+ *
+ * \param records_end   Pointer to receive the end of the records on success.
+ * \param index_size    Pointer to receive the size of the serialized perfect
+ *                      hash on success.
+ * \param image         The store image.
+ * \param image_size    The size of the store image.
+ *
+ * \note The perfect hash starts at the end of the records, and its checksum
+ * is verified here.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_INVALID_INDEX if the footer is invalid, or if the
+ *        perfect hash does not match its checksum.
+ */
+status FN_DECL_MUST_CHECK
+store_index_footer_read(
+    size_t* records_end, size_t* index_size, const uint8_t* image,
+    size_t image_size);
+
+/**
+ * \brief Parse the index footer of a store image with
+ * \ref STORE_FLAG_PERFECT_HASH set, and check it against the image size.
+ *
+ * \param records_end   Pointer to receive the end of the records on success.
+ * \param index_size    Pointer to receive the size of the serialized perfect
+ *                      hash on success.
+ * \param index_crc     Pointer to receive the checksum of the serialized
+ *                      perfect hash on success.
+ * \param footer        The STORE_INDEX_FOOTER_SIZE bytes of the footer.
+ * \param image_size    The size of the store image, which must hold at least
+ *                      a header and a footer.
+ *
+ * \note This is shared by \ref store_index_footer_read, which has the whole
+ * image, and the store file, which only reads the footer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_INVALID_INDEX if the footer is invalid.
+ */
+status FN_DECL_MUST_CHECK
+store_index_footer_check(
+    size_t* records_end, size_t* index_size, uint32_t* index_crc,
+    const uint8_t* footer, uint64_t image_size);
+
+/**
+ * \brief Load the perfect hash index of a store, and check that it maps the
+ * hash id of every record to the position of that record.
+ *
+ * \param st            The store, whose records are loaded.
+ * \param hashes        The index hash of each record.
+ * \param index         The serialized perfect hash.
+ * \param index_size    The size of the serialized perfect hash.
+ *
+ * \note Since each record must be found in its own position, no hash id
+ * appears twice, so every record ends its own generation chain.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_STORE_INVALID_INDEX if the perfect hash is invalid or does not
+ *        match the records.
+ */
+status FN_DECL_MUST_CHECK
+store_perfect_index_load(
+    store* st, const uint64_t* hashes, const uint8_t* index, size_t index_size);
+
+/**
+ * \brief Read the header of an index snapshot, and decide whether it can be
+ * used for a store image.
+ *
+ * \param count         Pointer to receive the number of records covered by
+ *                      the snapshot.
+ * \param capacity      Pointer to receive the number of index entries in the
+ *                      snapshot.
+ * \param snapshot      The index snapshot.
+ * \param snapshot_size The size of the index snapshot.
+ * \param generation    The generation of the store image.
+ * \param record_count  The number of records in the store image.
+ *
+ * \note The sections must fill the snapshot exactly, and the body must match
+ * its checksum. The index hashes of the records are checked once they are
+ * loaded.
+ *
+ * \returns true if the snapshot can be used, and false otherwise.
+ */
+bool
+store_snapshot_header_read(
+    size_t* count, size_t* capacity, const uint8_t* snapshot,
+    size_t snapshot_size, uint32_t generation, size_t record_count);
+
+/**
+ * \brief Copy the generation chains of an index snapshot into the index of a
+ * store.
+ *
+ * \param st            The store, whose records are loaded and whose index is
+ *                      empty.
+ * \param hashes        The index hash of each record.
+ * \param snapshot      The index snapshot, whose header has been read.
+ * \param count         The number of records covered by the snapshot.
+ * \param capacity      The number of index entries in the snapshot.
+ *
+ * \note The records covered by the snapshot must hash exactly as they did when
+ * it was written. Each chain is walked to check that its records share the
+ * hash of its entry, and each record is marked as it is walked, so a chain
+ * that loops or reaches a record of another chain is rejected. Every covered
+ * record must be reached by exactly one chain. If the store index is larger
+ * than the snapshot index, each entry is probed into place again, which only
+ * needs its hash.
+ *
+ * \returns true if the snapshot was loaded, and false if it does not match
+ * the records or the marks could not be allocated. On false, the index must
+ * be cleared.
+ */
+bool
+store_snapshot_index_load(
+    store* st, const uint64_t* hashes, const uint8_t* snapshot, size_t count,
+    size_t capacity);
+
+/**
+ * \brief Build the offset table for a store image.
+ *
+ * \param offsets       Pointer to receive the offset table on success.
+ * \param count         Pointer to receive the number of records on success.
+ * \param alloc         The allocator to use for the offset table.
+ * \param image         The store image.
+ * \param image_size    The size of the store image.
+ * \param trailer_size  The size of the trailer after each record.
+ *
+ * \note Only the length prefixes are read here; records are not touched until
+ * they are deserialized by a loader thread.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_STORE_INVALID_RECORD_SIZE if a record size is invalid.
+ */
+status FN_DECL_MUST_CHECK
+store_offset_table_build(
+    metadata_extent** offsets, size_t* count, RCPR_SYM(allocator)* alloc,
+    const uint8_t* image, size_t image_size, size_t trailer_size);
+
+/**
+ * \brief Decide how many loader threads to use.
+ *
+ * \param thread_count  The requested thread count, or 0 for one thread per
+ *                      online processor.
+ * \param record_count  The number of records to load.
+ *
+ * \returns the number of loader threads to use, which is at least 1 and at
+ * most \p record_count.
+ */
+size_t
+store_loader_thread_count(
+    size_t thread_count, size_t record_count);
+
+/**
+ * \brief Allocate the record array, the index, and the generation chain links
+ * of a store.
+ *
+ * \param st            The store, whose record count is set.
+ * \param index_capacity The number of index entries.
+ * \param flags         Zero or more STORE_LOAD_FLAG_ values.
+ *
+ * \note If a huge page flag is set and a mapping can be made, the three tables
+ * share the mapping, each starting on a cache line. Otherwise, each table is
+ * allocated with the store allocator. The record array and the index are
+ * zeroed.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ */
+status FN_DECL_MUST_CHECK
+store_tables_allocate(
+    store* st, size_t index_capacity, uint32_t flags);
+
+/**
+ * \brief Entry point for a loader thread.
+ *
+ * \param context       The \ref store_loader_chunk for this thread.
+ *
+ * \returns NULL.
+ */
+void*
+store_loader_thread(
+    void* context);
+
+/**
+ * \brief Verify, deserialize, and hash every record in a chunk.
+ *
+ * \param chunk         The chunk to load.
+ *
+ * \note On failure, the chunk's status is set and loading stops. Records that
+ * were loaded remain in the record array, and are released with the store.
+ */
+void
+store_loader_chunk_load(
+    store_loader_chunk* chunk);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
@@ -0,0 +1,71 @@
+/**
+ * \file store/store_loader_chunk_load.c
+ *
+ * \brief Load one chunk of the records of a store image.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <rcpr/socket_utilities.h>
+#include <string.h>
+
+#include "store_internal.h"
+
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Verify, deserialize, and hash every record in a chunk.
+ *
+ * \param chunk         The chunk to load.
+ *
+ * \note On failure, the chunk's status is set and loading stops. Records that
+ * were loaded remain in the record array, and are released with the store.
+ */
+void
+store_loader_chunk_load(
+    store_loader_chunk* chunk)
+{
+    const void* hash_id;
+    size_t hash_id_size;
+    uint32_t net_crc;
+
+    for (size_t i = chunk->begin; i < chunk->end; ++i)
+    {
+        const uint8_t* record = chunk->image + chunk->offsets[i].offset;
+
+        /* verify the checksum before the record is read. */
+        if (chunk->checksummed)
+        {
+            memcpy(
+                &net_crc, record + chunk->offsets[i].size, sizeof(net_crc));
+            if (socket_utility_ntoh32(net_crc)
+                    != store_crc32c(0, record, chunk->offsets[i].size))
+            {
+                chunk->retval = ERROR_STORE_CHECKSUM_MISMATCH;
+                return;
+            }
+        }
+
+        /* deserialize this record in place, using this thread's arena. */
+        chunk->retval =
+            metadata_from_data(
+                &chunk->records[i], chunk->arena, record,
+                chunk->offsets[i].size);
+        if (STATUS_SUCCESS != chunk->retval)
+        {
+            return;
+        }
+
+        /* hash the record while it is still hot in this thread's cache. */
+        chunk->retval =
+            metadata_hash_id_get(&hash_id, &hash_id_size, chunk->records[i]);
+        if (STATUS_SUCCESS != chunk->retval)
+        {
+            return;
+        }
+
+        chunk->hashes[i] = store_hash_id_hash(hash_id, hash_id_size);
+    }
+}
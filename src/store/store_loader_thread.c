@@ -0,0 +1,26 @@
+/**
+ * \file store/store_loader_thread.c
+ *
+ * \brief Thread entry point for loading part of a store image.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_internal.h"
+
+/**
+ * \brief Entry point for a loader thread.
+ *
+ * \param context       The \ref store_loader_chunk for this thread.
+ *
+ * \returns NULL.
+ */
+void*
+store_loader_thread(
+    void* context)
+{
+    store_loader_chunk_load((store_loader_chunk*)context);
+
+    return NULL;
+}
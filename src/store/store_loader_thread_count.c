@@ -0,0 +1,47 @@
+/**
+ * \file store/store_loader_thread_count.c
+ *
+ * \brief Choose the number of threads that load a store image.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <unistd.h>
+
+#include "store_internal.h"
+
+/**
+ * \brief Decide how many loader threads to use.
+ *
+ * \param thread_count  The requested thread count, or 0 for one thread per
+ *                      online processor.
+ * \param record_count  The number of records to load.
+ *
+ * \returns the number of loader threads to use, which is at least 1 and at
+ * most \p record_count.
+ */
+size_t
+store_loader_thread_count(
+    size_t thread_count, size_t record_count)
+{
+    /* default to one thread per online processor. */
+    if (0 == thread_count)
+    {
+        long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = (processors > 0) ? (size_t)processors : 1;
+    }
+
+    /* there is no point in having threads without records. */
+    if (thread_count > record_count)
+    {
+        thread_count = record_count;
+    }
+
+    if (0 == thread_count)
+    {
+        thread_count = 1;
+    }
+
+    return thread_count;
+}
@@ -0,0 +1,156 @@
+/**
+ * \file store/store_lookup_batch.c
+ *
+ * \brief Look up a batch of records in a \ref store by hash id.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_internal.h"
+
+/**
+ * \brief Look up a batch of records by hash id.
+ *
+ * \param records       Array of \p count entries to receive the newest
+ *                      generation of each hash id, or NULL for each hash id
+ *                      that is not found.
+ * \param st            The \ref store instance for this operation.
+ * \param hash_ids      Array of \p count hash ids.
+ * \param hash_id_sizes Array of \p count hash id sizes.
+ * \param count         The number of hash ids.
+ *
+ * \note The hash ids are looked up in groups. Each step of a lookup starts
+ * loading the memory needed by the next step for every hash id in the group
+ * before any of it is read, so the cache misses of a group overlap instead of
+ * following one another.
+ *
+ * \returns the number of hash ids that were found.
+ *
+ * \pre
+ *      - \p records, \p hash_ids, and \p hash_id_sizes must point to \p count
+ *        entries.
+ *      - \p st must reference a valid \ref store instance.
+ * \post
+ *      - Each entry of \p records is set to the record matching the same
+ *        entry of \p hash_ids, or NULL. These records are owned by the store
+ *        and must not be modified or released by the caller.
+ */
+size_t
+store_lookup_batch(
+    const metadata** records, const store* st, const void* const* hash_ids,
+    const size_t* hash_id_sizes, size_t count)
+{
+    uint64_t hash[STORE_LOOKUP_GROUP_SIZE];
+    size_t slot[STORE_LOOKUP_GROUP_SIZE];
+    const metadata* candidate[STORE_LOOKUP_GROUP_SIZE];
+    size_t found = 0U;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != records || 0 == count);
+    RCPR_MODEL_ASSERT(prop_store_valid(st));
+    RCPR_MODEL_ASSERT(NULL != hash_ids || 0 == count);
+    RCPR_MODEL_ASSERT(NULL != hash_id_sizes || 0 == count);
+
+    for (size_t begin = 0; begin < count; begin += STORE_LOOKUP_GROUP_SIZE)
+    {
+        size_t group =
+            (count - begin < STORE_LOOKUP_GROUP_SIZE)
+                ? count - begin : STORE_LOOKUP_GROUP_SIZE;
+        const void* const* ids = hash_ids + begin;
+        const size_t* sizes = hash_id_sizes + begin;
+
+        /* hash each id, and start loading the first place it could be. */
+        for (size_t i = 0; i < group; ++i)
+        {
+            hash[i] = store_hash_id_hash(ids[i], sizes[i]);
+            if (NULL != st->perfect_index)
+            {
+                slot[i] = perfect_hash_lookup(st->perfect_index, hash[i]);
+                if (slot[i] < st->record_count)
+                {
+                    __builtin_prefetch(&st->records[slot[i]]);
+                }
+            }
+            else
+            {
+                slot[i] = hash[i] & st->index_mask;
+                __builtin_prefetch(&st->index[slot[i]]);
+            }
+        }
+
+        /* find the record whose hash matches, and start loading it. */
+        for (size_t i = 0; i < group; ++i)
+        {
+            candidate[i] = NULL;
+            if (NULL != st->perfect_index)
+            {
+                if (slot[i] < st->record_count)
+                {
+                    candidate[i] = st->records[slot[i]];
+                }
+            }
+            else
+            {
+                /* only the entry hashes are read while probing. */
+                for (size_t j = slot[i];
+                     NULL != st->index[j].record;
+                     j = (j + 1) & st->index_mask)
+                {
+                    if (st->index[j].hash == hash[i])
+                    {
+                        candidate[i] = st->index[j].record;
+                        break;
+                    }
+                }
+            }
+
+            if (NULL != candidate[i])
+            {
+                __builtin_prefetch(candidate[i]);
+            }
+        }
+
+        /* start loading each candidate's hash id. */
+        for (size_t i = 0; i < group; ++i)
+        {
+            const void* candidate_id;
+            size_t candidate_id_size;
+
+            if (NULL != candidate[i]
+             && STATUS_SUCCESS
+                    == metadata_hash_id_get(
+                            &candidate_id, &candidate_id_size, candidate[i]))
+            {
+                __builtin_prefetch(candidate_id);
+            }
+        }
+
+        /* check each candidate's hash id. Two hash ids with the same index
+         * hash are rare, so they take the ordinary lookup. */
+        for (size_t i = 0; i < group; ++i)
+        {
+            records[begin + i] = NULL;
+            if (NULL == candidate[i])
+            {
+                continue;
+            }
+
+            if (store_record_hash_id_equals(candidate[i], ids[i], sizes[i]))
+            {
+                records[begin + i] = candidate[i];
+                ++found;
+                continue;
+            }
+
+            size_t head = store_index_find(st, hash[i], ids[i], sizes[i]);
+            if (STORE_HISTORY_END != head)
+            {
+                records[begin + i] = st->records[head];
+                ++found;
+            }
+        }
+    }
+
+    return found;
+}
@@ -0,0 +1,64 @@
+/**
+ * \file store/store_lookup_hashed.c
+ *
+ * \brief Look up a record in a \ref store using a precomputed index hash.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+
+#include "store_internal.h"
+
+/**
+ * \brief Look up a record by hash id, using a precomputed index hash.
+ *
+ * \param meta          Pointer to receive the record on success.
+ * \param st            The \ref store instance for this operation.
+ * \param hash          The index hash of this hash id, as computed by
+ *                      \ref store_hash_id_hash.
+ * \param hash_id       The hash id to look up.
+ * \param hash_id_size  The size of the hash id.
+ *
+ * \note This allows a caller that probes several indexes for the same hash id
+ * to compute the index hash only once.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_RECORD_NOT_FOUND if no record matches this hash id.
+ *
+ * \pre
+ *      - \p meta must be a valid pointer.
+ *      - \p st must reference a valid \ref store instance.
+ *      - \p hash must be the index hash of \p hash_id.
+ *      - \p hash_id must point to a valid memory region that is at least
+ *        \p hash_id_size bytes in length.
+ * \post
+ *      - On success, \p meta is set to the newest generation of the record
+ *        matching this hash id. This record is owned by the store and must
+ *        not be modified or released by the caller.
+ *      - On failure, \p meta is unchanged.
+ */
+status FN_DECL_MUST_CHECK
+store_lookup_hashed(
+    const metadata** meta, const store* st, uint64_t hash,
+    const void* hash_id, size_t hash_id_size)
+{
+    size_t head;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != meta);
+    RCPR_MODEL_ASSERT(prop_store_valid(st));
+
+    /* find the head of the generation chain for this hash id. */
+    head = store_index_find(st, hash, hash_id, hash_id_size);
+    if (STORE_HISTORY_END == head)
+    {
+        return ERROR_STORE_RECORD_NOT_FOUND;
+    }
+
+    *meta = st->records[head];
+
+    return STATUS_SUCCESS;
+}
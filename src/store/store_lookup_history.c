@@ -0,0 +1,70 @@
+/**
+ * \file store/store_lookup_history.c
+ *
+ * \brief Look up every generation of a record in a \ref store.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+
+#include "store_internal.h"
+
+/**
+ * \brief Look up the newest generation of a record by hash id, and start a walk
+ * of its older generations.
+ *
+ * \param meta          Pointer to receive the record on success.
+ * \param cursor        Pointer to the history cursor, which is set on success.
+ * \param st            The \ref store instance for this operation.
+ * \param hash_id       The hash id to look up.
+ * \param hash_id_size  The size of the hash id.
+ *
+ * \note Every generation of a hash id is chained newest first when the store is
+ * loaded, so the newest generation is found with a single index probe, and
+ * each older generation is one step of \ref store_history_next.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_RECORD_NOT_FOUND if no record matches this hash id.
+ *
+ * \pre
+ *      - \p meta and \p cursor must be valid pointers.
+ *      - \p st must reference a valid \ref store instance.
+ *      - \p hash_id must point to a valid memory region that is at least
+ *        \p hash_id_size bytes in length.
+ * \post
+ *      - On success, \p meta is set to the newest generation of the record
+ *        matching this hash id, and \p cursor is set to its position in the
+ *        generation chain. This record is owned by the store and must not be
+ *        modified or released by the caller.
+ *      - On failure, \p meta and \p cursor are unchanged.
+ */
+status FN_DECL_MUST_CHECK
+store_lookup_history(
+    const metadata** meta, size_t* cursor, const store* st,
+    const void* hash_id, size_t hash_id_size)
+{
+    size_t head;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != meta);
+    RCPR_MODEL_ASSERT(NULL != cursor);
+    RCPR_MODEL_ASSERT(prop_store_valid(st));
+
+    /* find the head of the generation chain for this hash id. */
+    head =
+        store_index_find(
+            st, store_hash_id_hash(hash_id, hash_id_size), hash_id,
+            hash_id_size);
+    if (STORE_HISTORY_END == head)
+    {
+        return ERROR_STORE_RECORD_NOT_FOUND;
+    }
+
+    *meta = st->records[head];
+    *cursor = head;
+
+    return STATUS_SUCCESS;
+}
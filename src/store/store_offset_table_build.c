@@ -0,0 +1,97 @@
+/**
+ * \file store/store_offset_table_build.c
+ *
+ * \brief Build the offset table of a store image.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <rcpr/socket_utilities.h>
+#include <string.h>
+
+#include "store_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Build the offset table for a store image.
+ *
+ * \param offsets       Pointer to receive the offset table on success.
+ * \param count         Pointer to receive the number of records on success.
+ * \param alloc         The allocator to use for the offset table.
+ * \param image         The store image.
+ * \param image_size    The size of the store image.
+ * \param trailer_size  The size of the trailer after each record.
+ *
+ * \note Only the length prefixes are read here; records are not touched until
+ * they are deserialized by a loader thread.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_STORE_INVALID_RECORD_SIZE if a record size is invalid.
+ */
+status FN_DECL_MUST_CHECK
+store_offset_table_build(
+    metadata_extent** offsets, size_t* count, RCPR_SYM(allocator)* alloc,
+    const uint8_t* image, size_t image_size, size_t trailer_size)
+{
+    status retval;
+    uint32_t net_record_size;
+    size_t record_size;
+    size_t record_count = 0U;
+    size_t pos;
+    metadata_extent* tmp = NULL;
+
+    /* first pass: count and validate the records. */
+    for (pos = STORE_HEADER_SIZE; pos < image_size; pos += record_size)
+    {
+        if (image_size - pos < STORE_RECORD_PREFIX_SIZE)
+        {
+            return ERROR_STORE_INVALID_RECORD_SIZE;
+        }
+
+        memcpy(&net_record_size, image + pos, sizeof(net_record_size));
+        record_size =
+            STORE_RECORD_PREFIX_SIZE
+                + (size_t)socket_utility_ntoh32(net_record_size)
+                + trailer_size;
+
+        if (STORE_RECORD_PREFIX_SIZE + trailer_size == record_size
+         || image_size - pos < record_size)
+        {
+            return ERROR_STORE_INVALID_RECORD_SIZE;
+        }
+
+        ++record_count;
+    }
+
+    /* allocate the offset table. */
+    retval =
+        allocator_allocate(
+            alloc, (void**)&tmp, (record_count + 1) * sizeof(*tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* second pass: fill the offset table. */
+    size_t i = 0;
+    for (pos = STORE_HEADER_SIZE; pos < image_size; pos += record_size)
+    {
+        memcpy(&net_record_size, image + pos, sizeof(net_record_size));
+        tmp[i].offset = pos + STORE_RECORD_PREFIX_SIZE;
+        tmp[i].size = socket_utility_ntoh32(net_record_size);
+        record_size = STORE_RECORD_PREFIX_SIZE + tmp[i].size + trailer_size;
+        ++i;
+    }
+
+    /* success. */
+    *offsets = tmp;
+    *count = record_count;
+    return STATUS_SUCCESS;
+}
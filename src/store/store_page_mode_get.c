@@ -0,0 +1,24 @@
+/**
+ * \file store/store_page_mode_get.c
+ *
+ * \brief Get the page mode of the record table and index of a \ref store.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_internal.h"
+
+/**
+ * \brief Get the page mode of the record table and index of a \ref store.
+ *
+ * \param st            The \ref store instance for this operation.
+ *
+ * \returns one of the STORE_PAGE_MODE_ values.
+ */
+int
+store_page_mode_get(
+    const store* st)
+{
+    return st->page_mode;
+}
@@ -0,0 +1,106 @@
+/**
+ * \file store/store_pages_map.c
+ *
+ * \brief Map a zeroed region backed by huge pages.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <sys/mman.h>
+
+#include "store_internal.h"
+
+/**
+ * \brief Map a zeroed region backed by huge pages.
+ *
+ * \param region        Pointer to receive the region, or NULL if no region
+ *                      could be mapped.
+ * \param region_size   Pointer to receive the mapped size of the region.
+ * \param size          The number of bytes needed.
+ * \param flags         The STORE_LOAD_FLAG_ values that select the kinds of
+ *                      huge pages to try.
+ *
+ * \note With \ref STORE_LOAD_FLAG_HUGETLB, the region is first mapped from the
+ * hugetlbfs pool, which fails up front if the pool has too few free pages.
+ * Otherwise, an anonymous mapping is trimmed to start on a huge page boundary
+ * and advised to use transparent huge pages. If the kernel does not support
+ * transparent huge pages, the mapping is dropped.
+ *
+ * \returns the STORE_PAGE_MODE_ value of the region.
+ */
+int
+store_pages_map(
+    void** region, size_t* region_size, size_t size, uint32_t flags)
+{
+    size_t mapped_size =
+        (size + STORE_HUGE_PAGE_SIZE - 1) & ~(size_t)(STORE_HUGE_PAGE_SIZE - 1);
+    uint8_t* ptr;
+
+    *region = NULL;
+    *region_size = 0;
+
+#ifdef MAP_HUGETLB
+    /* try explicit huge pages. */
+    if (flags & STORE_LOAD_FLAG_HUGETLB)
+    {
+        int map_flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+# ifdef MAP_HUGE_SHIFT
+        map_flags |= 21 << MAP_HUGE_SHIFT;
+# endif
+
+        ptr =
+            (uint8_t*)mmap(
+                NULL, mapped_size, PROT_READ | PROT_WRITE, map_flags, -1, 0);
+        if (MAP_FAILED != ptr)
+        {
+            *region = ptr;
+            *region_size = mapped_size;
+
+            return STORE_PAGE_MODE_HUGETLB;
+        }
+    }
+#endif
+
+#ifdef MADV_HUGEPAGE
+    /* over-allocate by a huge page so the region can be aligned. */
+    size_t total = mapped_size + STORE_HUGE_PAGE_SIZE;
+    ptr =
+        (uint8_t*)mmap(
+            NULL, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+            -1, 0);
+    if (MAP_FAILED == ptr)
+    {
+        return STORE_PAGE_MODE_DEFAULT;
+    }
+
+    /* trim the mapping to the aligned region. */
+    uint8_t* aligned =
+        (uint8_t*)(((uintptr_t)ptr + STORE_HUGE_PAGE_SIZE - 1)
+            & ~(uintptr_t)(STORE_HUGE_PAGE_SIZE - 1));
+    if (aligned > ptr)
+    {
+        munmap(ptr, aligned - ptr);
+    }
+    if (aligned + mapped_size < ptr + total)
+    {
+        munmap(aligned + mapped_size, (ptr + total) - (aligned + mapped_size));
+    }
+
+    /* ask for transparent huge pages. */
+    if (0 != madvise(aligned, mapped_size, MADV_HUGEPAGE))
+    {
+        munmap(aligned, mapped_size);
+        return STORE_PAGE_MODE_DEFAULT;
+    }
+
+    *region = aligned;
+    *region_size = mapped_size;
+
+    return STORE_PAGE_MODE_TRANSPARENT;
+#else
+    (void)flags;
+
+    return STORE_PAGE_MODE_DEFAULT;
+#endif
+}
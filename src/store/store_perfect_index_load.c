@@ -0,0 +1,68 @@
+/**
+ * \file store/store_perfect_index_load.c
+ *
+ * \brief Load the perfect hash index of a store image.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <nepe2/perfect_hash.h>
+
+#include "store_internal.h"
+
+/**
+ * \brief Load the perfect hash index of a store, and check that it maps the
+ * hash id of every record to the position of that record.
+ *
+ * \param st            The store, whose records are loaded.
+ * \param hashes        The index hash of each record.
+ * \param index         The serialized perfect hash.
+ * \param index_size    The size of the serialized perfect hash.
+ *
+ * \note Since each record must be found in its own position, no hash id
+ * appears twice, so every record ends its own generation chain.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_STORE_INVALID_INDEX if the perfect hash is invalid or does not
+ *        match the records.
+ */
+status FN_DECL_MUST_CHECK
+store_perfect_index_load(
+    store* st, const uint64_t* hashes, const uint8_t* index, size_t index_size)
+{
+    status retval;
+
+    retval =
+        perfect_hash_create_from_data(
+            &st->perfect_index, st->alloc, index, index_size);
+    if (ERROR_PERFECT_HASH_INVALID_FORMAT == retval)
+    {
+        return ERROR_STORE_INVALID_INDEX;
+    }
+    else if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    if (perfect_hash_key_count_get(st->perfect_index) != st->record_count)
+    {
+        return ERROR_STORE_INVALID_INDEX;
+    }
+
+    for (size_t i = 0; i < st->record_count; ++i)
+    {
+        if (perfect_hash_lookup(st->perfect_index, hashes[i]) != i)
+        {
+            return ERROR_STORE_INVALID_INDEX;
+        }
+
+        st->older[i] = STORE_HISTORY_END;
+    }
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,27 @@
+/**
+ * \file store/store_record_count_get.c
+ *
+ * \brief Get the number of records in a \ref store instance.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_internal.h"
+
+/**
+ * \brief Get the number of records in a \ref store instance.
+ *
+ * \param st            The \ref store instance for this operation.
+ *
+ * \note This count includes every record in the store image, including older
+ * generations that are not reachable by \ref store_lookup.
+ *
+ * \returns the number of records in this store.
+ */
+size_t
+store_record_count_get(
+    const store* st)
+{
+    return st->record_count;
+}
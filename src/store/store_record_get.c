@@ -0,0 +1,32 @@
+/**
+ * \file store/store_record_get.c
+ *
+ * \brief Get a record by its position in a \ref store.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_internal.h"
+
+/**
+ * \brief Get a record by its position in a \ref store instance.
+ *
+ * \param st            The \ref store instance for this operation.
+ * \param index         The index of the record, which must be less than the
+ *                      record count of this store.
+ *
+ * \note Records are in store image order. This includes older generations that
+ * are not reachable by \ref store_lookup.
+ *
+ * \returns the record at this index. This record is owned by the store and
+ * must not be modified or released by the caller.
+ */
+const metadata*
+store_record_get(
+    const store* st, size_t index)
+{
+    RCPR_MODEL_ASSERT(index < st->record_count);
+
+    return st->records[index];
+}
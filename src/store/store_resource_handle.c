@@ -0,0 +1,26 @@
+/**
+ * \file store/store_resource_handle.c
+ *
+ * \brief Get the resource handle for the store.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_internal.h"
+
+/**
+ * \brief Given a \ref store instance, return the resource handle for this
+ * \ref store instance.
+ *
+ * \param st            The \ref store instance from which the resource handle
+ *                      is returned.
+ *
+ * \returns the resource handle for this \ref store instance.
+ */
+RCPR_SYM(resource)*
+store_resource_handle(
+    store* st)
+{
+    return &st->hdr;
+}
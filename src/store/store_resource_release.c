@@ -0,0 +1,139 @@
+/**
+ * \file store/store_resource_release.c
+ *
+ * \brief Release a \ref store resource.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+#include <sys/mman.h>
+
+#include "store_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Release a \ref store resource.
+ *
+ * \param r             Pointer to the \ref store resource to be released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status store_resource_release(RCPR_SYM(resource)* r)
+{
+    status release_retval = STATUS_SUCCESS;
+    status retval = STATUS_SUCCESS;
+
+    store* st = (store*)r;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_store_valid(st));
+
+    /* cache allocator. */
+    allocator* alloc = st->alloc;
+
+    /* release each record. Records must be released before their arenas. */
+    if (NULL != st->records)
+    {
+        for (size_t i = 0; i < st->record_count; ++i)
+        {
+            if (NULL != st->records[i])
+            {
+                release_retval =
+                    resource_release(metadata_resource_handle(st->records[i]));
+                if (STATUS_SUCCESS != release_retval)
+                {
+                    retval = release_retval;
+                }
+            }
+        }
+
+        if (NULL == st->region)
+        {
+            release_retval = allocator_reclaim(alloc, st->records);
+            if (STATUS_SUCCESS != release_retval)
+            {
+                retval = release_retval;
+            }
+        }
+    }
+
+    /* release each loader arena. */
+    if (NULL != st->arenas)
+    {
+        for (size_t i = 0; i < st->arena_count; ++i)
+        {
+            if (NULL != st->arenas[i])
+            {
+                release_retval =
+                    resource_release(allocator_resource_handle(st->arenas[i]));
+                if (STATUS_SUCCESS != release_retval)
+                {
+                    retval = release_retval;
+                }
+            }
+        }
+
+        release_retval = allocator_reclaim(alloc, st->arenas);
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    /* release the perfect hash index. */
+    if (NULL != st->perfect_index)
+    {
+        release_retval =
+            resource_release(perfect_hash_resource_handle(st->perfect_index));
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    /* the tables share a mapping if the store uses huge pages. */
+    if (NULL != st->region)
+    {
+        munmap(st->region, st->region_size);
+        st->index = NULL;
+        st->older = NULL;
+    }
+
+    /* release the index. */
+    if (NULL != st->index)
+    {
+        release_retval = allocator_reclaim(alloc, st->index);
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    /* release the generation chain links. */
+    if (NULL != st->older)
+    {
+        release_retval = allocator_reclaim(alloc, st->older);
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(st, 0, sizeof(*st)));
+
+    /* reclaim memory. */
+    release_retval = allocator_reclaim(alloc, st);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
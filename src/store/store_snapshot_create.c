@@ -0,0 +1,156 @@
+/**
+ * \file store/store_snapshot_create.c
+ *
+ * \brief Write an index snapshot of a \ref store.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+
+#include "../metadata/metadata_serial.h"
+#include "store_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Write an index snapshot of a \ref store.
+ *
+ * \param snapshot      Pointer to receive the snapshot on success.
+ * \param alloc         The allocator to use for the snapshot.
+ * \param st            The \ref store instance for this operation.
+ *
+ * \note The snapshot covers every record of the store. Once more records are
+ * appended to the store image, loading the image with this snapshot only
+ * indexes the new records. The index hash of every record is computed again
+ * here, so that the snapshot can be checked against the records it covers.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_STORE_SNAPSHOT_NOT_SUPPORTED if the store uses a perfect hash
+ *        index.
+ *      - ERROR_METADATA_FIELD_NOT_SET if a record is missing its hash id.
+ *
+ * \pre
+ *      - \p snapshot must not reference a valid \ref secure_buffer instance
+ *        and must not be NULL.
+ *      - \p alloc must reference a valid \ref allocator and must not be NULL.
+ *      - \p st must reference a valid \ref store instance.
+ * \post
+ *      - On success, \p snapshot is set to a \ref secure_buffer owned by the
+ *        caller.
+ *      - On failure, \p snapshot is not changed.
+ */
+status FN_DECL_MUST_CHECK
+store_snapshot_create(
+    secure_buffer** snapshot, RCPR_SYM(allocator)* alloc, const store* st)
+{
+    status retval, release_retval;
+    secure_buffer* tmp = NULL;
+    uint64_t* hashes = NULL;
+    const void* hash_id;
+    size_t hash_id_size, size;
+    size_t capacity = st->index_mask + 1;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != snapshot);
+    RCPR_MODEL_ASSERT(prop_allocator_valid(alloc));
+    RCPR_MODEL_ASSERT(prop_store_valid(st));
+
+    /* a perfect hash index is already stored in the image. */
+    if (NULL != st->perfect_index)
+    {
+        return ERROR_STORE_SNAPSHOT_NOT_SUPPORTED;
+    }
+
+    /* hash every record, in store order. */
+    retval =
+        allocator_allocate(
+            alloc, (void**)&hashes, (st->record_count + 1) * sizeof(*hashes));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    for (size_t i = 0; i < st->record_count; ++i)
+    {
+        retval = metadata_hash_id_get(&hash_id, &hash_id_size, st->records[i]);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_hashes;
+        }
+
+        hashes[i] = store_hash_id_hash(hash_id, hash_id_size);
+    }
+
+    /* each index entry, then each chain link. */
+    retval =
+        secure_buffer_create(
+            &tmp, alloc,
+            STORE_SNAPSHOT_HEADER_SIZE + capacity * 2 * sizeof(uint64_t)
+                + st->record_count * sizeof(uint64_t));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_hashes;
+    }
+
+    uint8_t* out = (uint8_t*)secure_buffer_data(&size, tmp);
+    uint8_t* bptr = out + STORE_SNAPSHOT_HEADER_SIZE;
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        const store_index_entry* entry = &st->index[i];
+
+        if (NULL == entry->record)
+        {
+            bptr = metadata_serial_put_u64(bptr, 0);
+            bptr = metadata_serial_put_u64(bptr, UINT64_MAX);
+        }
+        else
+        {
+            bptr = metadata_serial_put_u64(bptr, entry->hash);
+            bptr = metadata_serial_put_u64(bptr, entry->head);
+        }
+    }
+
+    for (size_t i = 0; i < st->record_count; ++i)
+    {
+        bptr =
+            metadata_serial_put_u64(
+                bptr,
+                (STORE_HISTORY_END == st->older[i])
+                    ? UINT64_MAX : st->older[i]);
+    }
+
+    /* write the header. */
+    uint32_t body_crc =
+        store_crc32c(
+            0, out + STORE_SNAPSHOT_HEADER_SIZE,
+            size - STORE_SNAPSHOT_HEADER_SIZE);
+    bptr = metadata_serial_put_u32(out, STORE_SNAPSHOT_MAGIC);
+    bptr = metadata_serial_put_u32(bptr, STORE_SNAPSHOT_VERSION_1);
+    bptr = metadata_serial_put_u32(bptr, st->generation);
+    bptr =
+        metadata_serial_put_u32(
+            bptr, store_snapshot_hash_crc(hashes, st->record_count));
+    bptr = metadata_serial_put_u64(bptr, st->record_count);
+    bptr = metadata_serial_put_u64(bptr, capacity);
+    bptr = metadata_serial_put_u32(bptr, body_crc);
+    (void)metadata_serial_put_u32(bptr, 0);
+
+    /* success. */
+    *snapshot = tmp;
+    retval = STATUS_SUCCESS;
+
+cleanup_hashes:
+    release_retval = allocator_reclaim(alloc, hashes);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
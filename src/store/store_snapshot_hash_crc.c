@@ -0,0 +1,55 @@
+/**
+ * \file store/store_snapshot_hash_crc.c
+ *
+ * \brief Compute the checksum of the index hashes covered by an index
+ * snapshot.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <rcpr/socket_utilities.h>
+
+#include "store_internal.h"
+
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief The number of hashes converted at a time.
+ */
+#define STORE_SNAPSHOT_HASH_BLOCK                                           64
+
+/**
+ * \brief Compute the checksum of the index hashes of a run of records, as
+ * stored in an index snapshot.
+ *
+ * \param hashes        The index hash of each record, in store order.
+ * \param count         The number of records.
+ *
+ * \returns the CRC32C of the big-endian index hashes.
+ */
+uint32_t
+store_snapshot_hash_crc(
+    const uint64_t* hashes, size_t count)
+{
+    uint64_t block[STORE_SNAPSHOT_HASH_BLOCK];
+    uint32_t crc = 0;
+
+    /* convert a block at a time, so that the checksum runs over long
+     * regions. */
+    for (size_t begin = 0; begin < count; begin += STORE_SNAPSHOT_HASH_BLOCK)
+    {
+        size_t n =
+            (count - begin < STORE_SNAPSHOT_HASH_BLOCK)
+                ? count - begin : STORE_SNAPSHOT_HASH_BLOCK;
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            block[i] = socket_utility_hton64(hashes[begin + i]);
+        }
+
+        crc = store_crc32c(crc, block, n * sizeof(*block));
+    }
+
+    return crc;
+}
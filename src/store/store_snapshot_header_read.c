@@ -0,0 +1,103 @@
+/**
+ * \file store/store_snapshot_header_read.c
+ *
+ * \brief Validate the header of an index snapshot.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <rcpr/socket_utilities.h>
+#include <string.h>
+
+#include "store_internal.h"
+
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Read the header of an index snapshot, and decide whether it can be
+ * used for a store image.
+ *
+ * \param count         Pointer to receive the number of records covered by
+ *                      the snapshot.
+ * \param capacity      Pointer to receive the number of index entries in the
+ *                      snapshot.
+ * \param snapshot      The index snapshot.
+ * \param snapshot_size The size of the index snapshot.
+ * \param generation    The generation of the store image.
+ * \param record_count  The number of records in the store image.
+ *
+ * \note The sections must fill the snapshot exactly, and the body must match
+ * its checksum. The index hashes of the records are checked once they are
+ * loaded.
+ *
+ * \returns true if the snapshot can be used, and false otherwise.
+ */
+bool
+store_snapshot_header_read(
+    size_t* count, size_t* capacity, const uint8_t* snapshot,
+    size_t snapshot_size, uint32_t generation, size_t record_count)
+{
+    uint32_t net_field;
+    uint64_t net_size;
+    uint64_t snapshot_count, snapshot_capacity;
+
+    if (snapshot_size < STORE_SNAPSHOT_HEADER_SIZE)
+    {
+        return false;
+    }
+
+    /* the snapshot must be for this generation of the store. */
+    memcpy(&net_field, snapshot, sizeof(net_field));
+    if (STORE_SNAPSHOT_MAGIC != socket_utility_ntoh32(net_field))
+    {
+        return false;
+    }
+
+    memcpy(&net_field, snapshot + 4, sizeof(net_field));
+    if (STORE_SNAPSHOT_VERSION_1 != socket_utility_ntoh32(net_field))
+    {
+        return false;
+    }
+
+    memcpy(&net_field, snapshot + 8, sizeof(net_field));
+    if (generation != socket_utility_ntoh32(net_field))
+    {
+        return false;
+    }
+
+    memcpy(&net_field, snapshot + 36, sizeof(net_field));
+    if (0 != net_field)
+    {
+        return false;
+    }
+
+    /* the snapshot can't cover records that are not in the image. Each count
+     * is bounded by the size before it is scaled, so nothing overflows. */
+    uint64_t remaining = snapshot_size - STORE_SNAPSHOT_HEADER_SIZE;
+    memcpy(&net_size, snapshot + 16, sizeof(net_size));
+    snapshot_count = socket_utility_ntoh64(net_size);
+    memcpy(&net_size, snapshot + 24, sizeof(net_size));
+    snapshot_capacity = socket_utility_ntoh64(net_size);
+    if (snapshot_count > record_count
+     || snapshot_count > remaining / sizeof(uint64_t)
+     || snapshot_capacity > remaining / (2 * sizeof(uint64_t))
+     || snapshot_capacity * 2 * sizeof(uint64_t)
+            + snapshot_count * sizeof(uint64_t) != remaining)
+    {
+        return false;
+    }
+
+    memcpy(&net_field, snapshot + 32, sizeof(net_field));
+    if (socket_utility_ntoh32(net_field)
+            != store_crc32c(
+                0, snapshot + STORE_SNAPSHOT_HEADER_SIZE, (size_t)remaining))
+    {
+        return false;
+    }
+
+    *count = (size_t)snapshot_count;
+    *capacity = (size_t)snapshot_capacity;
+
+    return true;
+}
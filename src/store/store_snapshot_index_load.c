@@ -0,0 +1,167 @@
+/**
+ * \file store/store_snapshot_index_load.c
+ *
+ * \brief Load the hash id index of a \ref store from an index snapshot.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <rcpr/socket_utilities.h>
+#include <string.h>
+
+#include "store_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Copy the generation chains of an index snapshot into the index of a
+ * store.
+ *
+ * \param st            The store, whose records are loaded and whose index is
+ *                      empty.
+ * \param hashes        The index hash of each record.
+ * \param snapshot      The index snapshot, whose header has been read.
+ * \param count         The number of records covered by the snapshot.
+ * \param capacity      The number of index entries in the snapshot.
+ *
+ * \note The records covered by the snapshot must hash exactly as they did when
+ * it was written. Each chain is walked to check that its records share the
+ * hash of its entry, and each record is marked as it is walked, so a chain
+ * that loops or reaches a record of another chain is rejected. Every covered
+ * record must be reached by exactly one chain. If the store index is larger
+ * than the snapshot index, each entry is probed into place again, which only
+ * needs its hash.
+ *
+ * \returns true if the snapshot was loaded, and false if it does not match
+ * the records or the marks could not be allocated. On false, the index must
+ * be cleared.
+ */
+bool
+store_snapshot_index_load(
+    store* st, const uint64_t* hashes, const uint8_t* snapshot, size_t count,
+    size_t capacity)
+{
+    uint32_t net_field;
+    uint64_t net_value;
+    const uint8_t* entries = snapshot + STORE_SNAPSHOT_HEADER_SIZE;
+    const uint8_t* older = entries + capacity * 2 * sizeof(uint64_t);
+    uint64_t* seen = NULL;
+    size_t seen_words = (count + 63) / 64;
+    size_t visited = 0U;
+    bool loaded = false;
+
+    /* the covered records must be the records that were indexed. */
+    memcpy(&net_field, snapshot + 12, sizeof(net_field));
+    if (socket_utility_ntoh32(net_field)
+            != store_snapshot_hash_crc(hashes, count))
+    {
+        return false;
+    }
+
+    /* every chain link must stay within the covered records. */
+    for (size_t i = 0; i < count; ++i)
+    {
+        memcpy(&net_value, older + i * sizeof(net_value), sizeof(net_value));
+        net_value = socket_utility_ntoh64(net_value);
+        if (UINT64_MAX == net_value)
+        {
+            st->older[i] = STORE_HISTORY_END;
+        }
+        else if (net_value < count)
+        {
+            st->older[i] = (size_t)net_value;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    /* mark each record as its chain reaches it. */
+    if (STATUS_SUCCESS
+            != allocator_allocate(
+                    st->alloc, (void**)&seen,
+                    (seen_words + 1) * sizeof(*seen)))
+    {
+        return false;
+    }
+
+    RCPR_MODEL_EXEMPT(memset(seen, 0, (seen_words + 1) * sizeof(*seen)));
+
+    /* the heads are in slot order, so their records are scattered. Prefetch
+     * each head's record, hash, and chain link well before it is needed. An
+     * index of the same capacity takes each entry in the same slot. */
+    bool same_capacity = (capacity == st->index_mask + 1);
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        uint64_t hash, head;
+
+        if (i + STORE_SNAPSHOT_PREFETCH_DISTANCE < capacity)
+        {
+            memcpy(
+                &net_value,
+                entries + 16 * (i + STORE_SNAPSHOT_PREFETCH_DISTANCE) + 8,
+                sizeof(net_value));
+            head = socket_utility_ntoh64(net_value);
+            if (head < count)
+            {
+                __builtin_prefetch(&st->records[head]);
+                __builtin_prefetch(&hashes[head]);
+                __builtin_prefetch(&st->older[head]);
+            }
+        }
+
+        memcpy(&net_value, entries + 16 * i + 8, sizeof(net_value));
+        head = socket_utility_ntoh64(net_value);
+        if (UINT64_MAX == head)
+        {
+            continue;
+        }
+
+        memcpy(&net_value, entries + 16 * i, sizeof(net_value));
+        hash = socket_utility_ntoh64(net_value);
+        if (head >= count)
+        {
+            goto cleanup_seen;
+        }
+
+        /* no record may be reached twice, whether by a loop, by a chain that
+         * runs into another, or by two entries with the same head. */
+        for (size_t pos = (size_t)head; STORE_HISTORY_END != pos;
+             pos = st->older[pos])
+        {
+            uint64_t bit = UINT64_C(1) << (pos % 64);
+            if ((seen[pos / 64] & bit) || hashes[pos] != hash)
+            {
+                goto cleanup_seen;
+            }
+
+            seen[pos / 64] |= bit;
+            ++visited;
+        }
+
+        /* otherwise, probe this entry into place. */
+        size_t slot = same_capacity ? i : (hash & st->index_mask);
+        while (NULL != st->index[slot].record)
+        {
+            slot = (slot + 1) & st->index_mask;
+        }
+
+        st->index[slot].hash = hash;
+        st->index[slot].record = st->records[head];
+        st->index[slot].head = (size_t)head;
+    }
+
+    /* the chains must cover every record. */
+    loaded = (visited == count);
+
+cleanup_seen:
+    if (STATUS_SUCCESS != allocator_reclaim(st->alloc, seen))
+    {
+        loaded = false;
+    }
+
+    return loaded;
+}
@@ -0,0 +1,27 @@
+/**
+ * \file store/store_snapshot_record_count_get.c
+ *
+ * \brief Get the number of records of a \ref store instance that were indexed
+ * from an index snapshot.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_internal.h"
+
+/**
+ * \brief Get the number of records of a \ref store instance that were indexed
+ * from an index snapshot.
+ *
+ * \param st            The \ref store instance for this operation.
+ *
+ * \returns the number of records covered by the snapshot that this store was
+ * loaded with, or zero if no snapshot was used.
+ */
+size_t
+store_snapshot_record_count_get(
+    const store* st)
+{
+    return st->snapshot_record_count;
+}
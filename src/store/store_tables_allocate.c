@@ -0,0 +1,85 @@
+/**
+ * \file store/store_tables_allocate.c
+ *
+ * \brief Allocate the record and index tables of a \ref store.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "store_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Allocate the record array, the index, and the generation chain links
+ * of a store.
+ *
+ * \param st            The store, whose record count is set.
+ * \param index_capacity The number of index entries.
+ * \param flags         Zero or more STORE_LOAD_FLAG_ values.
+ *
+ * \note If a huge page flag is set and a mapping can be made, the three tables
+ * share the mapping, each starting on a cache line. Otherwise, each table is
+ * allocated with the store allocator. The record array and the index are
+ * zeroed.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ */
+status FN_DECL_MUST_CHECK
+store_tables_allocate(
+    store* st, size_t index_capacity, uint32_t flags)
+{
+    status retval;
+    size_t records_size = (st->record_count + 1) * sizeof(*st->records);
+    size_t index_size = index_capacity * sizeof(*st->index);
+    size_t older_size = (st->record_count + 1) * sizeof(*st->older);
+
+    st->index_mask = index_capacity - 1;
+
+    /* try to place the tables in huge pages. */
+    if (flags & (STORE_LOAD_FLAG_HUGE_PAGES | STORE_LOAD_FLAG_HUGETLB))
+    {
+        size_t index_offset = (records_size + 63) & ~(size_t)63;
+        size_t older_offset = (index_offset + index_size + 63) & ~(size_t)63;
+
+        st->page_mode =
+            store_pages_map(
+                &st->region, &st->region_size, older_offset + older_size,
+                flags);
+        if (NULL != st->region)
+        {
+            /* fresh mappings are already zeroed. */
+            st->records = (metadata**)st->region;
+            st->index =
+                (store_index_entry*)((uint8_t*)st->region + index_offset);
+            st->older = (size_t*)((uint8_t*)st->region + older_offset);
+
+            return STATUS_SUCCESS;
+        }
+    }
+
+    /* otherwise, use the store allocator. */
+    retval = allocator_allocate(st->alloc, (void**)&st->records, records_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    RCPR_MODEL_EXEMPT(memset(st->records, 0, records_size));
+
+    retval = allocator_allocate(st->alloc, (void**)&st->index, index_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    RCPR_MODEL_EXEMPT(memset(st->index, 0, index_size));
+
+    return allocator_allocate(st->alloc, (void**)&st->older, older_size);
+}
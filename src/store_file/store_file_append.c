@@ -0,0 +1,193 @@
+/**
+ * \file store_file/store_file_append.c
+ *
+ * \brief Append records to a \ref store_file.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <errno.h>
+#include <nepe2/error_codes.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "store_file_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Append records to a \ref store_file.
+ *
+ * \param sf            The \ref store_file for this operation.
+ * \param records       The records to append.
+ * \param count         The number of records.
+ * \param sync          If true, the records are durable before this returns.
+ *
+ * \note The records are framed as store image records and written from their
+ * own storage with a single vectored write. With the io_uring backend, the
+ * write and its data sync are linked and submitted with one system call. If the
+ * write completes short, the rest is written with pwritev and synced with
+ * fdatasync. If the ring fails, the whole write is redone with pwritev, and the
+ * file uses the pread backend from then on.
+ *
+ * If the store image has \ref STORE_FLAG_CRC32C set, each record is followed
+ * by its checksum, which is computed from the same iovec entries. If the store
+ * image has a perfect hash index, the index is removed first.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_METADATA_FIELD_NOT_SET if any record is empty.
+ *      - ERROR_STORE_FILE_WRITE_FAILED if the write failed.
+ *      - ERROR_STORE_FILE_SYNC_FAILED if the data sync failed.
+ */
+status FN_DECL_MUST_CHECK
+store_file_append(
+    store_file* sf, const metadata* const* records, size_t count, bool sync)
+{
+    status retval, release_retval;
+    struct iovec* iov = NULL;
+    struct iovec* pending;
+    uint8_t* scratch;
+    uint8_t* trailers = NULL;
+    size_t iov_count, scratch_size, size, written = 0;
+    size_t record_iov_count = METADATA_IOVEC_COUNT;
+    bool synced = false;
+    int results[2];
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_store_file_valid(sf));
+    RCPR_MODEL_ASSERT(NULL != records || 0 == count);
+
+    if (0 == count)
+    {
+        return sync ? store_file_sync(sf) : STATUS_SUCCESS;
+    }
+
+    /* the index would not cover the new records. */
+    retval = store_file_index_drop(sf);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* each checksummed record gets a trailer entry. */
+    if (sf->header_flags & STORE_FLAG_CRC32C)
+    {
+        ++record_iov_count;
+    }
+
+    /* allocate the iovec array and its scratch space together. */
+    iov_count = count * record_iov_count;
+    scratch_size = count * METADATA_IOVEC_FRAMED_SCRATCH_SIZE;
+    if (sf->header_flags & STORE_FLAG_CRC32C)
+    {
+        scratch_size += count * STORE_RECORD_TRAILER_SIZE;
+    }
+
+    retval =
+        allocator_allocate(
+            sf->alloc, (void**)&iov,
+            iov_count * sizeof(struct iovec) + scratch_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    scratch = (uint8_t*)(iov + iov_count);
+
+    /* frame every record. */
+    retval = metadata_to_iovec_batch(iov, scratch, &size, records, count);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_iov;
+    }
+
+    /* checksum every record. */
+    if (sf->header_flags & STORE_FLAG_CRC32C)
+    {
+        trailers = scratch + count * METADATA_IOVEC_FRAMED_SCRATCH_SIZE;
+        store_file_trailers_add(iov, trailers, count);
+        size += count * STORE_RECORD_TRAILER_SIZE;
+    }
+
+    /* submit the write, linked to its sync, as one batch. */
+    if (STORE_FILE_BACKEND_IO_URING == sf->backend)
+    {
+        unsigned submit_count = 1;
+        bool link = sync && iov_count <= IOV_MAX;
+
+        struct io_uring_sqe* sqe = store_file_uring_sqe_get(&sf->ring, 0);
+        sqe->opcode = IORING_OP_WRITEV;
+        sqe->off = sf->size;
+        sqe->addr = (uint64_t)(uintptr_t)iov;
+        sqe->len = iov_count < IOV_MAX ? (uint32_t)iov_count : IOV_MAX;
+
+        if (link)
+        {
+            sqe->flags |= IOSQE_IO_LINK;
+            sqe = store_file_uring_sqe_get(&sf->ring, 1);
+            sqe->opcode = IORING_OP_FSYNC;
+            sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+            ++submit_count;
+        }
+
+        if (store_file_uring_submit(&sf->ring, submit_count, results))
+        {
+            written = results[0] > 0 ? (size_t)results[0] : 0;
+
+            /* a sync that ran and failed is not retried. */
+            if (link && -ECANCELED != results[1])
+            {
+                if (0 != results[1])
+                {
+                    retval = ERROR_STORE_FILE_SYNC_FAILED;
+                    goto cleanup_iov;
+                }
+
+                synced = (written == size);
+            }
+        }
+        else
+        {
+            store_file_uring_disable(sf);
+        }
+    }
+
+    /* write whatever the ring did not. */
+    if (written < size)
+    {
+        pending = iov;
+        store_file_iovec_advance(&pending, &iov_count, written);
+        retval =
+            store_file_pwritev_all(
+                sf->fd, pending, iov_count, sf->size + written);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_iov;
+        }
+    }
+
+    if (sync && !synced && 0 != fdatasync(sf->fd))
+    {
+        retval = ERROR_STORE_FILE_SYNC_FAILED;
+        goto cleanup_iov;
+    }
+
+    /* success. */
+    sf->size += size;
+    retval = STATUS_SUCCESS;
+
+cleanup_iov:
+    memset(scratch, 0, scratch_size);
+    release_retval = allocator_reclaim(sf->alloc, iov);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
@@ -0,0 +1,28 @@
+/**
+ * \file store_file/store_file_backend_get.c
+ *
+ * \brief Get the backend used by a \ref store_file.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_file_internal.h"
+
+/**
+ * \brief Get the backend used by a \ref store_file.
+ *
+ * \param sf            The \ref store_file instance for this operation.
+ *
+ * \note A file whose ring fails switches to the pread backend for good.
+ *
+ * \returns \ref STORE_FILE_BACKEND_PREAD or \ref STORE_FILE_BACKEND_IO_URING.
+ */
+int
+store_file_backend_get(
+    const store_file* sf)
+{
+    RCPR_MODEL_ASSERT(prop_store_file_valid(sf));
+
+    return sf->backend;
+}
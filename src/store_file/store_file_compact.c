@@ -0,0 +1,366 @@
+/**
+ * \file store_file/store_file_compact.c
+ *
+ * \brief Rewrite a store image so that it only holds its live set.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <nepe2/perfect_hash.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "store_file_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief The suffix of the new image, which is renamed over the original.
+ */
+#define STORE_FILE_COMPACT_SUFFIX                                   ".compact"
+
+/**
+ * \brief Rewrite a store image so that it only holds its live set.
+ *
+ * \param stats         Pointer to receive the compaction counters on success.
+ * \param alloc         The allocator instance to use for this operation, which
+ *                      must be thread-safe.
+ * \param path          The path of the store image.
+ * \param options       The options for this compaction.
+ *
+ * \note The number of passes is chosen from an upper bound on the number of
+ * records in the image, so that the index of every thread fits in the memory
+ * budget without growing. During each pass, every thread scans the image for
+ * its own partition, and then the threads copy their live records to adjacent
+ * regions of the new image. The new image keeps the checksum flag of the
+ * original, and checksummed records are verified as they are scanned.
+ *
+ * If \ref STORE_FILE_COMPACT_FLAG_PERFECT_HASH is set, the live records of
+ * each partition are added to a perfect hash after each scan, in partition
+ * order, and each thread then writes its records in slot order, so that the
+ * slot of every hash id is the position of its record. The serialized perfect
+ * hash and its footer follow the records. If two live hash ids share an index
+ * hash, the perfect hash cannot be built, and the image is written without an
+ * index.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_STORE_FILE_OPEN_FAILED if the image or the new image could not
+ *        be opened.
+ *      - ERROR_STORE_FILE_READ_FAILED if the image could not be read.
+ *      - ERROR_STORE_FILE_WRITE_FAILED if the new image could not be written.
+ *      - ERROR_STORE_FILE_SYNC_FAILED if the new image could not be synced.
+ *      - ERROR_STORE_FILE_SWAP_FAILED if the new image could not be renamed
+ *        over the original.
+ *      - ERROR_STORE_INVALID_HEADER if the store header is invalid.
+ *      - ERROR_STORE_UNKNOWN_FORMAT_VERSION if the store format version is not
+ *        supported.
+ *      - ERROR_STORE_INVALID_RECORD_SIZE if a record is truncated.
+ *      - ERROR_STORE_CHECKSUM_MISMATCH if a record does not match its
+ *        checksum.
+ *      - ERROR_STORE_THREAD_CREATE_FAILED if a thread could not be started.
+ *      - an error from \ref metadata_from_data if a record is invalid.
+ */
+status FN_DECL_MUST_CHECK
+store_file_compact(
+    store_file_compact_stats* stats, RCPR_SYM(allocator)* alloc,
+    const char* path, const store_file_compact_options* options)
+{
+    status retval, release_retval;
+    store_file* in = NULL;
+    store_file* out = NULL;
+    store_file_compact_worker* workers = NULL;
+    char* out_path = NULL;
+    size_t path_size, thread_count, worker_count = 0;
+    uint64_t out_offset;
+    perfect_hash_builder* builder = NULL;
+    uint64_t* scratch = NULL;
+    size_t scratch_capacity = 0;
+    uint64_t perfect_index_size = 0;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != stats);
+    RCPR_MODEL_ASSERT(prop_allocator_valid(alloc));
+    RCPR_MODEL_ASSERT(NULL != path);
+    RCPR_MODEL_ASSERT(NULL != options);
+
+    /* open the image, which checks its header. */
+    retval = store_file_open(&in, alloc, path, 0);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* create the new image next to the original. */
+    path_size = strlen(path) + sizeof(STORE_FILE_COMPACT_SUFFIX);
+    retval = allocator_allocate(alloc, (void**)&out_path, path_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_in;
+    }
+
+    snprintf(out_path, path_size, "%s%s", path, STORE_FILE_COMPACT_SUFFIX);
+    unlink(out_path);
+    retval =
+        store_file_open(
+            &out, alloc, out_path,
+            STORE_FILE_FLAG_CREATE
+                | ((in->header_flags & STORE_FLAG_CRC32C)
+                    ? STORE_FILE_FLAG_CRC32C : 0));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_out_path;
+    }
+
+    /* the new image is a new generation, which is synced with its records. */
+    retval = store_file_generation_set(out, in->generation + 1);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_out;
+    }
+
+    /* bound the number of records, and size the passes from that bound. */
+    uint64_t max_records =
+        (in->size - STORE_HEADER_SIZE) / STORE_FILE_COMPACT_MIN_FRAME_SIZE + 1;
+    size_t memory_limit =
+        (0 != options->memory_limit)
+            ? options->memory_limit : STORE_FILE_COMPACT_DEFAULT_MEMORY_LIMIT;
+
+    thread_count = options->thread_count;
+    if (0 == thread_count)
+    {
+        long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = (processors > 0) ? (size_t)processors : 1;
+    }
+
+    if (thread_count > max_records)
+    {
+        thread_count = (size_t)max_records;
+    }
+
+    /* each record needs two index slots and a copy of its hash id. */
+    uint64_t index_size =
+        max_records * (2 * sizeof(store_file_compact_entry) + 32);
+    uint64_t pass_count = (index_size + memory_limit - 1) / memory_limit;
+
+    /* more partitions than records would only add empty passes. */
+    uint64_t max_pass_count = (max_records + thread_count - 1) / thread_count;
+    if (pass_count > max_pass_count)
+    {
+        pass_count = max_pass_count;
+    }
+
+    size_t partition_count = (size_t)pass_count * thread_count;
+
+    size_t table_capacity = 16;
+    while (table_capacity < 2 * (max_records / partition_count + 1))
+    {
+        table_capacity *= 2;
+    }
+
+    /* set up the threads. */
+    retval =
+        allocator_allocate(
+            alloc, (void**)&workers, thread_count * sizeof(*workers));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_out;
+    }
+
+    RCPR_MODEL_EXEMPT(memset(workers, 0, thread_count * sizeof(*workers)));
+    for (worker_count = 0; worker_count < thread_count; ++worker_count)
+    {
+        store_file_compact_worker* worker = &workers[worker_count];
+        worker->in_fd = in->fd;
+        worker->in_size = in->size;
+        worker->trailer_size =
+            (in->header_flags & STORE_FLAG_CRC32C)
+                ? STORE_RECORD_TRAILER_SIZE : 0;
+        worker->out_fd = out->fd;
+        worker->options = options;
+        worker->partition_count = partition_count;
+
+        retval = store_file_compact_worker_init(worker, table_capacity);
+        if (STATUS_SUCCESS != retval)
+        {
+            /* release whatever this worker did set up. */
+            ++worker_count;
+            goto cleanup_workers;
+        }
+    }
+
+    /* the perfect hash has one partition per compaction partition. */
+    if (options->flags & STORE_FILE_COMPACT_FLAG_PERFECT_HASH)
+    {
+        retval =
+            perfect_hash_builder_create(&builder, alloc, partition_count);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_workers;
+        }
+    }
+
+    /* compact one partition per thread in each pass. */
+    out_offset = STORE_HEADER_SIZE;
+    for (uint64_t pass = 0; pass < pass_count; ++pass)
+    {
+        for (size_t i = 0; i < thread_count; ++i)
+        {
+            workers[i].partition = (size_t)pass * thread_count + i;
+        }
+
+        retval =
+            store_file_compact_run(
+                workers, thread_count, &store_file_compact_scan_thread);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_workers;
+        }
+
+        /* put the records of each partition in slot order. */
+        if (NULL != builder)
+        {
+            retval =
+                store_file_compact_index_add(
+                    &builder, alloc, workers, thread_count, &scratch,
+                    &scratch_capacity);
+            if (STATUS_SUCCESS != retval)
+            {
+                goto cleanup_workers;
+            }
+        }
+
+        /* lay out the live records of each thread one after another. */
+        for (size_t i = 0; i < thread_count; ++i)
+        {
+            workers[i].out_offset = out_offset;
+            out_offset += workers[i].live_size;
+        }
+
+        retval =
+            store_file_compact_run(
+                workers, thread_count, &store_file_compact_write_thread);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_workers;
+        }
+    }
+
+    /* the index follows the records. */
+    if (NULL != builder)
+    {
+        retval =
+            store_file_compact_index_write(
+                &perfect_index_size, alloc, builder, out, out_offset);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_workers;
+        }
+    }
+
+    /* make the new image durable before it replaces the original. */
+    out->size = out_offset;
+    retval = store_file_sync(out);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_workers;
+    }
+
+    if (0 != rename(out_path, path))
+    {
+        retval = ERROR_STORE_FILE_SWAP_FAILED;
+        goto cleanup_workers;
+    }
+
+    retval = store_file_directory_sync(alloc, path);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_workers;
+    }
+
+    /* success. */
+    memset(stats, 0, sizeof(*stats));
+    stats->bytes_in = STORE_HEADER_SIZE + in->index_size;
+    stats->bytes_out = STORE_HEADER_SIZE + perfect_index_size;
+    stats->index_size = perfect_index_size;
+    for (size_t i = 0; i < thread_count; ++i)
+    {
+        stats->records_in += workers[i].stats.records_in;
+        stats->records_out += workers[i].stats.records_out;
+        stats->superseded += workers[i].stats.superseded;
+        stats->revoked += workers[i].stats.revoked;
+        stats->bytes_in += workers[i].stats.bytes_in;
+        stats->bytes_out += workers[i].stats.bytes_out;
+    }
+
+cleanup_workers:
+    if (NULL != builder)
+    {
+        release_retval =
+            resource_release(perfect_hash_builder_resource_handle(builder));
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    if (NULL != scratch)
+    {
+        release_retval = allocator_reclaim(alloc, scratch);
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    for (size_t i = 0; i < worker_count; ++i)
+    {
+        release_retval = store_file_compact_worker_dispose(&workers[i]);
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    release_retval = allocator_reclaim(alloc, workers);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_out:
+    release_retval = resource_release(store_file_resource_handle(out));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    /* a new image that was not swapped in is discarded. */
+    if (STATUS_SUCCESS != retval)
+    {
+        unlink(out_path);
+    }
+
+cleanup_out_path:
+    release_retval = allocator_reclaim(alloc, out_path);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_in:
+    release_retval = resource_release(store_file_resource_handle(in));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
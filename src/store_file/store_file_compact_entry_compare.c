@@ -0,0 +1,29 @@
+/**
+ * \file store_file/store_file_compact_entry_compare.c
+ *
+ * \brief Order compaction index entries by image offset.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_file_internal.h"
+
+/**
+ * \brief Order index entries by their offset in the image.
+ *
+ * \param lhs           The left hand \ref store_file_compact_entry.
+ * \param rhs           The right hand \ref store_file_compact_entry.
+ *
+ * \returns less than, equal to, or greater than zero if \p lhs is before, at,
+ * or after \p rhs in the image.
+ */
+int
+store_file_compact_entry_compare(
+    const void* lhs, const void* rhs)
+{
+    const store_file_compact_entry* l = (const store_file_compact_entry*)lhs;
+    const store_file_compact_entry* r = (const store_file_compact_entry*)rhs;
+
+    return (l->offset > r->offset) - (l->offset < r->offset);
+}
@@ -0,0 +1,125 @@
+/**
+ * \file store_file/store_file_compact_index_add.c
+ *
+ * \brief Add the live records of a compaction pass to the perfect hash.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <nepe2/perfect_hash.h>
+
+#include "store_file_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Add the live records of each thread's partition to the perfect hash,
+ * and put each thread's records in slot order.
+ *
+ * \param builder       Pointer to the perfect hash builder, which is released
+ *                      and set to NULL if the perfect hash cannot be built.
+ * \param alloc         The allocator for the scratch space.
+ * \param workers       The compaction threads, in partition order.
+ * \param count         The number of compaction threads.
+ * \param scratch       Pointer to the scratch space for keys and slots.
+ * \param scratch_capacity  Pointer to the number of records that fit in the
+ *                      scratch space.
+ *
+ * \note The slots of a partition follow those of the partitions before it,
+ * just as its records follow theirs in the new image, so a record's position
+ * within its thread is its slot less the first slot of its partition.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+store_file_compact_index_add(
+    perfect_hash_builder** builder, RCPR_SYM(allocator)* alloc,
+    store_file_compact_worker* workers, size_t count, uint64_t** scratch,
+    size_t* scratch_capacity)
+{
+    status retval;
+
+    for (size_t w = 0; w < count; ++w)
+    {
+        store_file_compact_worker* worker = &workers[w];
+        size_t live_count = worker->live_count;
+
+        /* the scratch space holds the keys, then the slots. */
+        if (live_count > *scratch_capacity)
+        {
+            if (NULL != *scratch)
+            {
+                retval = allocator_reclaim(alloc, *scratch);
+                *scratch = NULL;
+                *scratch_capacity = 0;
+                if (STATUS_SUCCESS != retval)
+                {
+                    return retval;
+                }
+            }
+
+            retval =
+                allocator_allocate(
+                    alloc, (void**)scratch, 2 * live_count * sizeof(**scratch));
+            if (STATUS_SUCCESS != retval)
+            {
+                return retval;
+            }
+
+            *scratch_capacity = live_count;
+        }
+
+        uint64_t* keys = *scratch;
+        uint64_t* slots = *scratch + *scratch_capacity;
+        for (size_t i = 0; i < live_count; ++i)
+        {
+            keys[i] = worker->table[i].hash;
+        }
+
+        /* two live hash ids with the same index hash cannot be separated. */
+        retval =
+            perfect_hash_builder_partition_add(
+                slots, *builder, keys, live_count);
+        if (ERROR_PERFECT_HASH_BUILD_FAILED == retval)
+        {
+            retval =
+                resource_release(
+                    perfect_hash_builder_resource_handle(*builder));
+            *builder = NULL;
+            return retval;
+        }
+        else if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        /* the slots of this partition are contiguous. */
+        uint64_t base = UINT64_MAX;
+        for (size_t i = 0; i < live_count; ++i)
+        {
+            base = (slots[i] < base) ? slots[i] : base;
+        }
+
+        /* move each entry to its slot, following each cycle of the
+         * permutation. */
+        for (size_t i = 0; i < live_count; ++i)
+        {
+            while (slots[i] - base != i)
+            {
+                size_t j = (size_t)(slots[i] - base);
+                store_file_compact_entry entry = worker->table[i];
+                uint64_t slot = slots[i];
+
+                worker->table[i] = worker->table[j];
+                worker->table[j] = entry;
+                slots[i] = slots[j];
+                slots[j] = slot;
+            }
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
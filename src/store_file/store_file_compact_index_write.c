@@ -0,0 +1,92 @@
+/**
+ * \file store_file/store_file_compact_index_write.c
+ *
+ * \brief Append the perfect hash to a compacted store image.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/perfect_hash.h>
+#include <rcpr/socket_utilities.h>
+#include <string.h>
+
+#include "store_file_internal.h"
+
+RCPR_IMPORT_resource;
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Append the perfect hash and its footer to the new image, and set
+ * \ref STORE_FLAG_PERFECT_HASH in its header.
+ *
+ * \param index_size    Pointer to receive the size of the perfect hash and its
+ *                      footer on success.
+ * \param alloc         The allocator for the serialized perfect hash.
+ * \param builder       The perfect hash builder, with every partition added.
+ * \param out           The new image.
+ * \param records_end   The end of the records in the new image.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+store_file_compact_index_write(
+    uint64_t* index_size, RCPR_SYM(allocator)* alloc,
+    const perfect_hash_builder* builder, store_file* out, uint64_t records_end)
+{
+    status retval, release_retval;
+    secure_buffer* buffer = NULL;
+    uint8_t footer[STORE_INDEX_FOOTER_SIZE];
+    struct iovec iov[2];
+    size_t size;
+
+    retval = perfect_hash_builder_emit(&buffer, alloc, builder);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    void* data = secure_buffer_data(&size, buffer);
+
+    /* the footer locates and checks the index. */
+    uint32_t net_fields32[2] = {
+        socket_utility_hton32(STORE_INDEX_MAGIC),
+        socket_utility_hton32(store_crc32c(0, data, size)) };
+    uint64_t net_fields64[2] = {
+        socket_utility_hton64(records_end),
+        socket_utility_hton64(size) };
+    memcpy(footer, net_fields32, sizeof(net_fields32));
+    memcpy(footer + sizeof(net_fields32), net_fields64, sizeof(net_fields64));
+
+    iov[0].iov_base = data;
+    iov[0].iov_len = size;
+    iov[1].iov_base = footer;
+    iov[1].iov_len = sizeof(footer);
+    retval = store_file_pwritev_all(out->fd, iov, 2, records_end);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_buffer;
+    }
+
+    /* the header flag is synced with the rest of the new image. */
+    uint32_t net_flags =
+        socket_utility_hton32(out->header_flags | STORE_FLAG_PERFECT_HASH);
+    iov[0].iov_base = &net_flags;
+    iov[0].iov_len = sizeof(net_flags);
+    retval = store_file_pwritev_all(out->fd, iov, 1, 8);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_buffer;
+    }
+
+    *index_size = size + sizeof(footer);
+
+cleanup_buffer:
+    release_retval = resource_release(secure_buffer_resource_handle(buffer));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
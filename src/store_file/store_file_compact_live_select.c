@@ -0,0 +1,53 @@
+/**
+ * \file store_file/store_file_compact_live_select.c
+ *
+ * \brief Select the live records found by a compaction scan.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+
+#include "store_file_internal.h"
+
+/**
+ * \brief Drop every record past its retention window, and gather the rest at
+ * the front of the index in image order.
+ *
+ * \param worker        The compaction thread state.
+ */
+void
+store_file_compact_live_select(
+    store_file_compact_worker* worker)
+{
+    const store_file_compact_options* options = worker->options;
+    size_t live_count = 0;
+
+    for (size_t i = 0; i <= worker->table_mask; ++i)
+    {
+        store_file_compact_entry* entry = &worker->table[i];
+        if (!entry->used)
+        {
+            continue;
+        }
+
+        if (0 != entry->revocation_date
+         && options->now >= entry->revocation_date
+         && options->now - entry->revocation_date >= options->retention)
+        {
+            ++worker->stats.revoked;
+            continue;
+        }
+
+        worker->live_size += entry->frame_size;
+        worker->table[live_count++] = *entry;
+    }
+
+    worker->live_count = live_count;
+
+    /* copy in image order, so that reads of the original are sequential. */
+    qsort(
+        worker->table, live_count, sizeof(*worker->table),
+        &store_file_compact_entry_compare);
+}
@@ -0,0 +1,136 @@
+/**
+ * \file store_file/store_file_compact_record_add.c
+ *
+ * \brief Index one record during a compaction scan.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <rcpr/socket_utilities.h>
+#include <string.h>
+
+#include "../metadata/metadata_serial.h"
+#include "store_file_internal.h"
+
+RCPR_IMPORT_resource;
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Index one record, if it is in the partition of this thread.
+ *
+ * \param worker        The compaction thread state.
+ * \param data          The serialized record, followed by its trailer, if
+ *                      any.
+ * \param size          The size of the serialized record.
+ * \param offset        The offset of the framed record in the image.
+ *
+ * \note Only the fixed header is read to find the partition of a record, so
+ * each thread only verifies the checksum of, and fully decodes, the records
+ * in its own partition. Each record is therefore verified once per pass.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+store_file_compact_record_add(
+    store_file_compact_worker* worker, const uint8_t* data, uint32_t size,
+    uint64_t offset)
+{
+    status retval;
+    metadata_serial_header header;
+    metadata* record = NULL;
+    size_t keys_size;
+    uint32_t net_crc;
+
+    /* the hash id follows the fixed header. */
+    retval = metadata_serial_header_read(&header, data, size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    const uint8_t* key =
+        data + metadata_serial_header_size(header.serial_version);
+    size_t key_size = header.hash_id_size;
+
+    /* skip records that belong to other partitions. */
+    uint64_t hash = store_hash_id_hash(key, key_size);
+    if (hash % worker->partition_count != worker->partition)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    /* verify the checksum. */
+    if (worker->trailer_size > 0)
+    {
+        memcpy(&net_crc, data + size, sizeof(net_crc));
+        if (socket_utility_ntoh32(net_crc) != store_crc32c(0, data, size))
+        {
+            return ERROR_STORE_CHECKSUM_MISMATCH;
+        }
+    }
+
+    /* verify the rest of the record. */
+    retval = metadata_from_data(&record, worker->arena, data, size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = resource_release(metadata_resource_handle(record));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    ++worker->stats.records_in;
+    worker->stats.bytes_in +=
+        STORE_RECORD_PREFIX_SIZE + size + worker->trailer_size;
+
+    /* keep the load factor at or below 1/2. */
+    if (2 * (worker->table_count + 1) > worker->table_mask + 1)
+    {
+        retval = store_file_compact_table_grow(worker);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    store_file_compact_entry* entry =
+        store_file_compact_slot_find(worker, hash, key, key_size);
+    if (entry->used)
+    {
+        /* like a loaded store, a later record wins a generation tie. */
+        ++worker->stats.superseded;
+        if (header.generation < entry->generation)
+        {
+            return STATUS_SUCCESS;
+        }
+    }
+    else
+    {
+        /* keep a copy of the hash id for later comparisons. */
+        secure_buffer_builder_data(&keys_size, worker->keys);
+        retval = secure_buffer_builder_append(worker->keys, key, key_size);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        entry->used = true;
+        entry->hash = hash;
+        entry->key_offset = keys_size;
+        entry->key_size = (uint32_t)key_size;
+        ++worker->table_count;
+    }
+
+    entry->offset = offset;
+    entry->frame_size =
+        STORE_RECORD_PREFIX_SIZE + size + (uint32_t)worker->trailer_size;
+    entry->generation = header.generation;
+    entry->revocation_date = header.revocation_date;
+
+    return STATUS_SUCCESS;
+}
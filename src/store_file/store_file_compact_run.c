@@ -0,0 +1,75 @@
+/**
+ * \file store_file/store_file_compact_run.c
+ *
+ * \brief Run one compaction step on every compaction thread.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+
+#include "store_file_internal.h"
+
+/**
+ * \brief Run one step on every compaction thread, using the calling thread for
+ * the first one, and wait for all of them.
+ *
+ * \param workers       The compaction threads.
+ * \param count         The number of compaction threads.
+ * \param thread        The step to run.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_THREAD_CREATE_FAILED if a thread could not be started.
+ *      - the first error from any thread.
+ */
+status FN_DECL_MUST_CHECK
+store_file_compact_run(
+    store_file_compact_worker* workers, size_t count, void* (*thread)(void*))
+{
+    status retval = STATUS_SUCCESS;
+
+    /* start a thread for every worker but the first. */
+    for (size_t i = 1; i < count; ++i)
+    {
+        workers[i].thread_started = false;
+        if (0 != pthread_create(&workers[i].thread, NULL, thread, &workers[i]))
+        {
+            retval = ERROR_STORE_THREAD_CREATE_FAILED;
+            break;
+        }
+
+        workers[i].thread_started = true;
+    }
+
+    /* the calling thread runs the first worker. */
+    if (STATUS_SUCCESS == retval)
+    {
+        thread(&workers[0]);
+    }
+
+    /* wait for every started thread. */
+    for (size_t i = 1; i < count; ++i)
+    {
+        if (workers[i].thread_started)
+        {
+            pthread_join(workers[i].thread, NULL);
+        }
+    }
+
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (STATUS_SUCCESS != workers[i].retval)
+        {
+            return workers[i].retval;
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,100 @@
+/**
+ * \file store_file/store_file_compact_scan.c
+ *
+ * \brief Find the live records in one partition of a store image.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <rcpr/socket_utilities.h>
+#include <string.h>
+
+#include "store_file_internal.h"
+
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Scan the image for the live records in the current partition of a
+ * compaction thread.
+ *
+ * \param worker        The compaction thread state.
+ *
+ * \note The image is streamed through the buffer of this thread one chunk at a
+ * time. A chunk ends at the last whole record in it, and the next chunk starts
+ * at the record after that.
+ */
+void
+store_file_compact_scan(
+    store_file_compact_worker* worker)
+{
+    status retval;
+    uint64_t offset = STORE_HEADER_SIZE;
+    uint32_t frame_size;
+
+    /* start with an empty index. */
+    memset(
+        worker->table, 0, (worker->table_mask + 1) * sizeof(*worker->table));
+    worker->table_count = 0;
+    worker->live_count = 0;
+    worker->live_size = 0;
+    secure_buffer_builder_truncate(worker->keys, 0);
+
+    while (offset < worker->in_size)
+    {
+        size_t chunk_size = STORE_FILE_COMPACT_CHUNK_SIZE;
+        if (chunk_size > worker->in_size - offset)
+        {
+            chunk_size = (size_t)(worker->in_size - offset);
+        }
+
+        retval =
+            store_file_pread_all(
+                worker->in_fd, worker->buffer, chunk_size, offset);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto done;
+        }
+
+        /* index every whole record in this chunk. */
+        size_t pos = 0;
+        while (chunk_size - pos >= STORE_RECORD_PREFIX_SIZE)
+        {
+            memcpy(&frame_size, worker->buffer + pos, sizeof(frame_size));
+            frame_size = socket_utility_ntoh32(frame_size);
+            if ((uint64_t)frame_size + worker->trailer_size
+                    > chunk_size - pos - STORE_RECORD_PREFIX_SIZE)
+            {
+                break;
+            }
+
+            retval =
+                store_file_compact_record_add(
+                    worker, worker->buffer + pos + STORE_RECORD_PREFIX_SIZE,
+                    frame_size, offset + pos);
+            if (STATUS_SUCCESS != retval)
+            {
+                goto done;
+            }
+
+            pos +=
+                STORE_RECORD_PREFIX_SIZE + frame_size + worker->trailer_size;
+        }
+
+        /* a record that does not fit in a chunk is truncated or invalid. */
+        if (0 == pos)
+        {
+            retval = ERROR_STORE_INVALID_RECORD_SIZE;
+            goto done;
+        }
+
+        offset += pos;
+    }
+
+    store_file_compact_live_select(worker);
+    retval = STATUS_SUCCESS;
+
+done:
+    worker->retval = retval;
+}
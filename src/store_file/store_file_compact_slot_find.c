@@ -0,0 +1,51 @@
+/**
+ * \file store_file/store_file_compact_slot_find.c
+ *
+ * \brief Find the index slot for a hash id during a compaction scan.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "store_file_internal.h"
+
+/**
+ * \brief Find the index slot for a hash id, which is either its entry or the
+ * empty slot where it belongs.
+ *
+ * \param worker        The compaction thread state.
+ * \param hash          The hash of the hash id.
+ * \param key           The hash id.
+ * \param key_size      The size of the hash id.
+ *
+ * \returns the slot for this hash id.
+ */
+store_file_compact_entry*
+store_file_compact_slot_find(
+    store_file_compact_worker* worker, uint64_t hash, const void* key,
+    size_t key_size)
+{
+    size_t keys_size;
+    const uint8_t* keys =
+        (const uint8_t*)secure_buffer_builder_data(&keys_size, worker->keys);
+
+    /* the low bits of the hash are shared by the whole partition. */
+    size_t slot = (hash / worker->partition_count) & worker->table_mask;
+
+    while (worker->table[slot].used)
+    {
+        store_file_compact_entry* entry = &worker->table[slot];
+        if (entry->hash == hash
+         && entry->key_size == key_size
+         && 0 == memcmp(keys + entry->key_offset, key, key_size))
+        {
+            break;
+        }
+
+        slot = (slot + 1) & worker->table_mask;
+    }
+
+    return &worker->table[slot];
+}
@@ -0,0 +1,63 @@
+/**
+ * \file store_file/store_file_compact_table_grow.c
+ *
+ * \brief Grow the index of a compaction thread.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "store_file_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Double the size of the index of a compaction thread.
+ *
+ * \param worker        The compaction thread state.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+store_file_compact_table_grow(
+    store_file_compact_worker* worker)
+{
+    status retval;
+    store_file_compact_entry* old_table = worker->table;
+    size_t old_capacity = worker->table_mask + 1;
+    size_t capacity = 2 * old_capacity;
+
+    retval =
+        allocator_allocate(
+            worker->arena, (void**)&worker->table,
+            capacity * sizeof(*worker->table));
+    if (STATUS_SUCCESS != retval)
+    {
+        worker->table = old_table;
+        return retval;
+    }
+
+    memset(worker->table, 0, capacity * sizeof(*worker->table));
+    worker->table_mask = capacity - 1;
+
+    /* rehash every entry. */
+    for (size_t i = 0; i < old_capacity; ++i)
+    {
+        if (old_table[i].used)
+        {
+            size_t slot =
+                (old_table[i].hash / worker->partition_count)
+                    & worker->table_mask;
+            while (worker->table[slot].used)
+            {
+                slot = (slot + 1) & worker->table_mask;
+            }
+
+            worker->table[slot] = old_table[i];
+        }
+    }
+
+    return allocator_reclaim(worker->arena, old_table);
+}
@@ -0,0 +1,71 @@
+/**
+ * \file store_file/store_file_compact_worker_dispose.c
+ *
+ * \brief Release the buffers of a compaction thread.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_file_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Release whatever was set up for a compaction thread.
+ *
+ * \param worker        The compaction thread state.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+store_file_compact_worker_dispose(
+    store_file_compact_worker* worker)
+{
+    status retval = STATUS_SUCCESS;
+    status release_retval;
+
+    if (NULL == worker->arena)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    if (NULL != worker->keys)
+    {
+        release_retval =
+            resource_release(
+                secure_buffer_builder_resource_handle(worker->keys));
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    if (NULL != worker->table)
+    {
+        release_retval = allocator_reclaim(worker->arena, worker->table);
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    if (NULL != worker->buffer)
+    {
+        release_retval = allocator_reclaim(worker->arena, worker->buffer);
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    release_retval =
+        resource_release(allocator_resource_handle(worker->arena));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
@@ -0,0 +1,55 @@
+/**
+ * \file store_file/store_file_compact_worker_init.c
+ *
+ * \brief Set up the buffers of a compaction thread.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_file_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Set up the buffers of a compaction thread, in its own arena.
+ *
+ * \param worker        The compaction thread state.
+ * \param table_capacity    The initial number of index slots.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+store_file_compact_worker_init(
+    store_file_compact_worker* worker, size_t table_capacity)
+{
+    status retval;
+
+    retval = malloc_allocator_create(&worker->arena);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval =
+        allocator_allocate(
+            worker->arena, (void**)&worker->buffer,
+            STORE_FILE_COMPACT_CHUNK_SIZE);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval =
+        allocator_allocate(
+            worker->arena, (void**)&worker->table,
+            table_capacity * sizeof(*worker->table));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    worker->table_mask = table_capacity - 1;
+
+    return secure_buffer_builder_create(&worker->keys, worker->arena, 0);
+}
@@ -0,0 +1,76 @@
+/**
+ * \file store_file/store_file_compact_write.c
+ *
+ * \brief Copy the live records in one partition of a store image.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_file_internal.h"
+
+/**
+ * \brief Copy the live records found by \ref store_file_compact_scan to the
+ * region of the new image starting at \p worker->out_offset.
+ *
+ * \param worker        The compaction thread state.
+ *
+ * \note Records are read in image order, and gathered in the buffer of this
+ * thread so that each write to the new image is a whole buffer.
+ */
+void
+store_file_compact_write(
+    store_file_compact_worker* worker)
+{
+    status retval = STATUS_SUCCESS;
+    uint64_t out_offset = worker->out_offset;
+    size_t fill = 0;
+    struct iovec iov;
+
+    for (size_t i = 0; i <= worker->live_count; ++i)
+    {
+        size_t frame_size =
+            (i < worker->live_count) ? worker->table[i].frame_size : 0;
+
+        /* write the buffer when it is full, or after the last record. */
+        if (fill > 0
+         && (i == worker->live_count
+          || frame_size > STORE_FILE_COMPACT_CHUNK_SIZE - fill))
+        {
+            iov.iov_base = worker->buffer;
+            iov.iov_len = fill;
+            retval =
+                store_file_pwritev_all(worker->out_fd, &iov, 1, out_offset);
+            if (STATUS_SUCCESS != retval)
+            {
+                goto done;
+            }
+
+            out_offset += fill;
+            fill = 0;
+        }
+
+        if (i == worker->live_count)
+        {
+            break;
+        }
+
+        /* the scan only accepts records that fit in the buffer. */
+        retval =
+            store_file_pread_all(
+                worker->in_fd, worker->buffer + fill, frame_size,
+                worker->table[i].offset);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto done;
+        }
+
+        fill += frame_size;
+    }
+
+    worker->stats.records_out += worker->live_count;
+    worker->stats.bytes_out += worker->live_size;
+
+done:
+    worker->retval = retval;
+}
@@ -0,0 +1,26 @@
+/**
+ * \file store_file/store_file_compact_write_thread.c
+ *
+ * \brief Thread entry point for the compaction write step.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_file_internal.h"
+
+/**
+ * \brief Thread entry point for the write step.
+ *
+ * \param context       The \ref store_file_compact_worker for this thread.
+ *
+ * \returns NULL.
+ */
+void*
+store_file_compact_write_thread(
+    void* context)
+{
+    store_file_compact_write((store_file_compact_worker*)context);
+
+    return NULL;
+}
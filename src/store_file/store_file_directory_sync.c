@@ -0,0 +1,77 @@
+/**
+ * \file store_file/store_file_directory_sync.c
+ *
+ * \brief Sync the directory that holds a path.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <fcntl.h>
+#include <nepe2/error_codes.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "store_file_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Sync the directory that holds the given path, so that a rename in it
+ * is durable.
+ *
+ * \param alloc         The allocator for this operation.
+ * \param path          A path in the directory to sync.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_STORE_FILE_SYNC_FAILED if the directory could not be synced.
+ */
+status FN_DECL_MUST_CHECK
+store_file_directory_sync(
+    RCPR_SYM(allocator)* alloc, const char* path)
+{
+    status retval, release_retval;
+    char* directory = NULL;
+    const char* slash = strrchr(path, '/');
+    size_t size = (NULL == slash) ? 1 : (size_t)(slash - path) + 1;
+    int fd;
+
+    retval = allocator_allocate(alloc, (void**)&directory, size + 1);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* the directory is everything up to the last slash, or "." */
+    if (NULL == slash)
+    {
+        memcpy(directory, ".", 2);
+    }
+    else
+    {
+        memcpy(directory, path, size);
+        directory[size] = 0;
+    }
+
+    fd = open(directory, O_RDONLY | O_CLOEXEC);
+    if (fd < 0 || 0 != fsync(fd))
+    {
+        retval = ERROR_STORE_FILE_SYNC_FAILED;
+    }
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    release_retval = allocator_reclaim(alloc, directory);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
@@ -0,0 +1,26 @@
+/**
+ * \file store_file/store_file_generation_get.c
+ *
+ * \brief Get the generation of the store image of a \ref store_file.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_file_internal.h"
+
+/**
+ * \brief Get the generation of the store image of a \ref store_file.
+ *
+ * \param sf            The \ref store_file instance for this operation.
+ *
+ * \returns the generation of the store image.
+ */
+uint32_t
+store_file_generation_get(
+    const store_file* sf)
+{
+    RCPR_MODEL_ASSERT(prop_store_file_valid(sf));
+
+    return sf->generation;
+}
@@ -0,0 +1,51 @@
+/**
+ * \file store_file/store_file_generation_set.c
+ *
+ * \brief Write the generation of a \ref store_file to its store header.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <rcpr/socket_utilities.h>
+
+#include "store_file_internal.h"
+
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Write the generation of a \ref store_file to its store header.
+ *
+ * \param sf            The \ref store_file for this operation.
+ * \param generation    The new generation.
+ *
+ * \note The header is not synced here.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_FILE_WRITE_FAILED if the header could not be written.
+ */
+status FN_DECL_MUST_CHECK
+store_file_generation_set(
+    store_file* sf, uint32_t generation)
+{
+    status retval;
+    uint32_t net_generation = socket_utility_hton32(generation);
+    struct iovec iov;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_store_file_valid(sf));
+
+    iov.iov_base = &net_generation;
+    iov.iov_len = sizeof(net_generation);
+    retval = store_file_pwritev_all(sf->fd, &iov, 1, 12);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    sf->generation = generation;
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,26 @@
+/**
+ * \file store_file/store_file_header_flags_get.c
+ *
+ * \brief Get the store header flags of a \ref store_file.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_file_internal.h"
+
+/**
+ * \brief Get the store header flags of a \ref store_file.
+ *
+ * \param sf            The \ref store_file instance for this operation.
+ *
+ * \returns zero or more STORE_FLAG_ values.
+ */
+uint32_t
+store_file_header_flags_get(
+    const store_file* sf)
+{
+    RCPR_MODEL_ASSERT(prop_store_file_valid(sf));
+
+    return sf->header_flags;
+}
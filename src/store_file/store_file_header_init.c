@@ -0,0 +1,110 @@
+/**
+ * \file store_file/store_file_header_init.c
+ *
+ * \brief Write or check the header of a \ref store_file.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <rcpr/socket_utilities.h>
+#include <unistd.h>
+
+#include "store_file_internal.h"
+
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Write the store header of an empty file, or validate the store header
+ * of an existing file.
+ *
+ * \param sf            The \ref store_file for this operation.
+ * \param flags         The STORE_FILE_FLAG_ values used to open this file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_FILE_READ_FAILED if the store header could not be read.
+ *      - ERROR_STORE_FILE_WRITE_FAILED if the store header could not be
+ *        written.
+ *      - ERROR_STORE_INVALID_HEADER if the store header is invalid.
+ *      - ERROR_STORE_UNKNOWN_FORMAT_VERSION if the store format version is not
+ *        supported.
+ *      - ERROR_STORE_INVALID_INDEX if the index footer is invalid.
+ */
+status FN_DECL_MUST_CHECK
+store_file_header_init(
+    store_file* sf, uint32_t flags)
+{
+    status retval;
+    uint32_t header[STORE_HEADER_SIZE / sizeof(uint32_t)];
+    struct iovec iov;
+
+    /* a new file gets an empty store image. */
+    if (0 == sf->size)
+    {
+        header[0] = socket_utility_hton32(STORE_MAGIC);
+        header[1] = socket_utility_hton32(STORE_FORMAT_VERSION_1);
+        header[2] = 0;
+        header[3] = 0;
+        if (flags & STORE_FILE_FLAG_CRC32C)
+        {
+            header[2] = socket_utility_hton32(STORE_FLAG_CRC32C);
+        }
+
+        iov.iov_base = header;
+        iov.iov_len = sizeof(header);
+        retval = store_file_pwritev_all(sf->fd, &iov, 1, 0);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        if (0 != fdatasync(sf->fd))
+        {
+            return ERROR_STORE_FILE_WRITE_FAILED;
+        }
+
+        sf->size = sizeof(header);
+        sf->header_flags = socket_utility_ntoh32(header[2]);
+        return STATUS_SUCCESS;
+    }
+
+    /* an existing file must start with a valid header. */
+    if (sf->size < sizeof(header))
+    {
+        return ERROR_STORE_INVALID_HEADER;
+    }
+
+    retval = store_file_pread_all(sf->fd, header, sizeof(header), 0);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    if (STORE_MAGIC != socket_utility_ntoh32(header[0]))
+    {
+        return ERROR_STORE_INVALID_HEADER;
+    }
+
+    if (STORE_FORMAT_VERSION_1 != socket_utility_ntoh32(header[1]))
+    {
+        return ERROR_STORE_UNKNOWN_FORMAT_VERSION;
+    }
+
+    sf->header_flags = socket_utility_ntoh32(header[2]);
+    if (sf->header_flags & ~STORE_FLAGS_SUPPORTED)
+    {
+        return ERROR_STORE_INVALID_HEADER;
+    }
+
+    sf->generation = socket_utility_ntoh32(header[3]);
+
+    /* the records of an indexed image end where its index starts. */
+    if (sf->header_flags & STORE_FLAG_PERFECT_HASH)
+    {
+        return store_file_index_footer_read(sf);
+    }
+
+    return STATUS_SUCCESS;
+}
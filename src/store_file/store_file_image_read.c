@@ -0,0 +1,105 @@
+/**
+ * \file store_file/store_file_image_read.c
+ *
+ * \brief Read the whole store image of a \ref store_file.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+
+#include "store_file_internal.h"
+
+RCPR_IMPORT_resource;
+
+/**
+ * \brief The size of each read of a store image.
+ */
+#define STORE_FILE_IMAGE_CHUNK_SIZE                                 0x00100000
+
+/**
+ * \brief Read the whole store image of a \ref store_file.
+ *
+ * \param image         Pointer to receive the store image on success.
+ * \param alloc         The allocator to use for the store image.
+ * \param sf            The \ref store_file for this operation.
+ *
+ * \note The image is read as a batch of fixed size chunks, so that the
+ * io_uring backend keeps several reads in flight.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_STORE_FILE_READ_FAILED if the read failed.
+ */
+status FN_DECL_MUST_CHECK
+store_file_image_read(
+    secure_buffer** image, RCPR_SYM(allocator)* alloc, store_file* sf)
+{
+    status retval, release_retval;
+    secure_buffer* tmp = NULL;
+    store_file_read_request requests[STORE_FILE_URING_ENTRIES];
+    uint8_t* data;
+    size_t size;
+    uint64_t offset = 0;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != image);
+    RCPR_MODEL_ASSERT(prop_allocator_valid(alloc));
+    RCPR_MODEL_ASSERT(prop_store_file_valid(sf));
+
+    /* the image, with its index, must fit in memory. */
+    if (sf->size + sf->index_size > SIZE_MAX)
+    {
+        return ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    retval =
+        secure_buffer_create(&tmp, alloc, (size_t)(sf->size + sf->index_size));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    data = (uint8_t*)secure_buffer_data(&size, tmp);
+
+    /* read the image in batches of chunks. */
+    while (offset < size)
+    {
+        size_t count = 0;
+        while (count < STORE_FILE_URING_ENTRIES && offset < size)
+        {
+            size_t remaining = size - (size_t)offset;
+            requests[count].offset = offset;
+            requests[count].data = data + offset;
+            requests[count].size =
+                remaining < STORE_FILE_IMAGE_CHUNK_SIZE
+                    ? remaining : STORE_FILE_IMAGE_CHUNK_SIZE;
+            offset += requests[count].size;
+            ++count;
+        }
+
+        retval = store_file_read_batch(sf, requests, count);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_tmp;
+        }
+    }
+
+    /* success. */
+    *image = tmp;
+    retval = STATUS_SUCCESS;
+    goto done;
+
+cleanup_tmp:
+    release_retval = resource_release(secure_buffer_resource_handle(tmp));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
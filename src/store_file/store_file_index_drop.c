@@ -0,0 +1,82 @@
+/**
+ * \file store_file/store_file_index_drop.c
+ *
+ * \brief Remove the perfect hash index of a \ref store_file.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <rcpr/socket_utilities.h>
+#include <unistd.h>
+
+#include "store_file_internal.h"
+
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Remove the perfect hash index of a \ref store_file, if it has one,
+ * before its records change.
+ *
+ * \param sf            The \ref store_file for this operation.
+ *
+ * \note The index and its footer are truncated away and made durable before
+ * \ref STORE_FLAG_PERFECT_HASH is cleared, so that a crash in between leaves
+ * an image that is rejected, rather than one whose index is read as records.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_FILE_WRITE_FAILED if the file could not be truncated or
+ *        its header could not be written.
+ *      - ERROR_STORE_FILE_SYNC_FAILED if the data sync failed.
+ */
+status FN_DECL_MUST_CHECK
+store_file_index_drop(
+    store_file* sf)
+{
+    status retval;
+    uint32_t net_flags;
+    struct iovec iov;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_store_file_valid(sf));
+
+    if (0 == sf->index_size)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    /* remove the index and its footer. */
+    if (0 != ftruncate(sf->fd, (off_t)sf->size))
+    {
+        return ERROR_STORE_FILE_WRITE_FAILED;
+    }
+
+    if (0 != fdatasync(sf->fd))
+    {
+        return ERROR_STORE_FILE_SYNC_FAILED;
+    }
+
+    sf->index_size = 0;
+
+    /* then clear the header flag. */
+    net_flags =
+        socket_utility_hton32(sf->header_flags & ~STORE_FLAG_PERFECT_HASH);
+    iov.iov_base = &net_flags;
+    iov.iov_len = sizeof(net_flags);
+    retval = store_file_pwritev_all(sf->fd, &iov, 1, 8);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    if (0 != fdatasync(sf->fd))
+    {
+        return ERROR_STORE_FILE_SYNC_FAILED;
+    }
+
+    sf->header_flags &= ~STORE_FLAG_PERFECT_HASH;
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,64 @@
+/**
+ * \file store_file/store_file_index_footer_read.c
+ *
+ * \brief Read the index footer of a \ref store_file.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+
+#include "../store/store_internal.h"
+#include "store_file_internal.h"
+
+/**
+ * \brief Read the index footer of a store file with
+ * \ref STORE_FLAG_PERFECT_HASH set, and split its size into the records and
+ * the index.
+ *
+ * \param sf            The \ref store_file for this operation.
+ *
+ * \note The checksum of the index is left to the loader, which reads it.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_FILE_READ_FAILED if the footer could not be read.
+ *      - ERROR_STORE_INVALID_INDEX if the footer is invalid.
+ */
+status FN_DECL_MUST_CHECK
+store_file_index_footer_read(
+    store_file* sf)
+{
+    status retval;
+    size_t records_end, index_size;
+    uint32_t index_crc;
+    uint8_t footer[STORE_INDEX_FOOTER_SIZE];
+
+    if (sf->size < STORE_HEADER_SIZE + STORE_INDEX_FOOTER_SIZE)
+    {
+        return ERROR_STORE_INVALID_INDEX;
+    }
+
+    retval =
+        store_file_pread_all(
+            sf->fd, footer, sizeof(footer),
+            sf->size - STORE_INDEX_FOOTER_SIZE);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval =
+        store_index_footer_check(
+            &records_end, &index_size, &index_crc, footer, sf->size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    sf->index_size = sf->size - records_end;
+    sf->size = records_end;
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,619 @@
+/**
+ * \file store_file/store_file_internal.h
+ *
+ * \brief Internal header for \ref store_file.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <limits.h>
+#include <linux/io_uring.h>
+#include <nepe2/perfect_hash.h>
+#include <nepe2/store_file.h>
+#include <pthread.h>
+#include <rcpr/resource/protected.h>
+#include <string.h>
+#include <sys/uio.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+#ifndef IOV_MAX
+# define IOV_MAX 1024
+#endif
+
+/**
+ * \brief The number of submission queue entries in each ring.
+ */
+#define STORE_FILE_URING_ENTRIES                                            64
+
+/**
+ * \brief An io_uring instance, driven directly with system calls.
+ *
+ * The submission and completion rings are shared with the kernel. The head of
+ * the submission ring and the tail of the completion ring are written by the
+ * kernel, so they are read with acquire loads; the tail of the submission ring
+ * and the head of the completion ring are published with release stores. *
+ * Each entry is tagged with the sequence number of its batch as well as its
+ * position in the batch, so that a completion left over from an earlier batch
+ * is never taken for one of the current batch.
+ */
+typedef struct store_file_uring store_file_uring;
+
+struct store_file_uring
+{
+    int fd;
+    unsigned entries;
+    void* sq_ring;
+    size_t sq_ring_size;
+    void* cq_ring;
+    size_t cq_ring_size;
+    struct io_uring_sqe* sqes;
+    size_t sqes_size;
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    struct io_uring_cqe* cqes;
+    uint32_t batch;
+};
+
+struct store_file
+{
+    RCPR_SYM(resource) hdr;
+    RCPR_MODEL_STRUCT_TAG(store_file);
+    RCPR_SYM(allocator)* alloc;
+    int fd;
+    uint64_t size;
+    uint64_t index_size;
+    uint32_t header_flags;
+    uint32_t generation;
+    int backend;
+    store_file_uring ring;
+};
+
+/**
+ * \brief The size of the buffer that each compaction thread streams the image
+ * through.
+ */
+#define STORE_FILE_COMPACT_CHUNK_SIZE                               0x00040000
+
+/**
+ * \brief The smallest framed record size assumed when estimating the number of
+ * records in an image.
+ */
+#define STORE_FILE_COMPACT_MIN_FRAME_SIZE                                   64
+
+/**
+ * \brief The default memory budget for the live set index of a compaction.
+ */
+#define STORE_FILE_COMPACT_DEFAULT_MEMORY_LIMIT                     0x04000000
+
+/**
+ * \brief The newest record seen so far for one hash id during a compaction.
+ */
+typedef struct store_file_compact_entry store_file_compact_entry;
+
+struct store_file_compact_entry
+{
+    uint64_t hash;
+    uint64_t offset;
+    uint64_t revocation_date;
+    uint64_t key_offset;
+    uint32_t key_size;
+    uint32_t frame_size;
+    uint32_t generation;
+    bool used;
+};
+
+/**
+ * \brief The state of one compaction thread.
+ *
+ * During each pass, a thread first scans the whole image for the records in
+ * its partition of the hash id space, and then copies the live records of
+ * that partition to its region of the new image.
+ */
+typedef struct store_file_compact_worker store_file_compact_worker;
+
+struct store_file_compact_worker
+{
+    pthread_t thread;
+    bool thread_started;
+    int in_fd;
+    uint64_t in_size;
+    size_t trailer_size;
+    int out_fd;
+    uint64_t out_offset;
+    const store_file_compact_options* options;
+    size_t partition;
+    size_t partition_count;
+    RCPR_SYM(allocator)* arena;
+    uint8_t* buffer;
+    secure_buffer_builder* keys;
+    store_file_compact_entry* table;
+    size_t table_mask;
+    size_t table_count;
+    size_t live_count;
+    uint64_t live_size;
+    store_file_compact_stats stats;
+    status retval;
+};
+
+/**
+ * \brief Release a \ref store_file resource.
+ *
+ * \param r             Pointer to the \ref store_file resource to be released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status store_file_resource_release(RCPR_SYM(resource)* r);
+
+/**
+ * \brief Set up an io_uring instance for the given file.
+ *
+ * \param ring          The ring to set up.
+ * \param fd            The file, which is registered with the ring as fixed
+ *                      file 0.
+ *
+ * \returns true if the ring was set up, or false if io_uring is unavailable.
+ */
+bool
+store_file_uring_init(
+    store_file_uring* ring, int fd);
+
+/**
+ * \brief Tear down an io_uring instance.
+ *
+ * \param ring          The ring to tear down.
+ */
+void
+store_file_uring_release(
+    store_file_uring* ring);
+
+/**
+ * \brief Submit the prepared submission queue entries, and wait for all of
+ * them to complete.
+ *
+ * \param ring          The ring for this operation.
+ * \param count         The number of prepared entries, which must not be
+ *                      greater than the ring size.
+ * \param results       Array of \p count results, indexed by the position of
+ *                      each entry in the batch, which receives the result of
+ *                      each entry.
+ *
+ * \note If the ring fails, the entries that the kernel has not taken are
+ * withdrawn, and this waits for the ones it has taken to complete. Nothing
+ * from the batch is still in flight when this returns.
+ *
+ * \returns true on success, or false if the ring failed.
+ */
+bool
+store_file_uring_submit(
+    store_file_uring* ring, unsigned count, int* results);
+
+/**
+ * \brief Switch a \ref store_file whose ring failed to the pread backend for
+ * good, and tear down the ring.
+ *
+ * \param sf            The \ref store_file for this operation.
+ */
+void
+store_file_uring_disable(
+    store_file* sf);
+
+/**
+ * \brief Get the next free submission queue entry of a ring.
+ *
+ * \param ring          The ring for this operation.
+ * \param index         The position of this entry in the current batch, which
+ *                      must be less than the ring size.
+ *
+ * \note The entry is cleared, targets fixed file 0, and is tagged with the
+ * current batch and \p index as its user data. It is not visible to the kernel
+ * until \ref store_file_uring_submit is called.
+ *
+ * \returns the submission queue entry.
+ */
+static inline struct io_uring_sqe*
+store_file_uring_sqe_get(
+    store_file_uring* ring, unsigned index)
+{
+    unsigned tail = *ring->sq_tail + index;
+    unsigned slot = tail & *ring->sq_mask;
+    struct io_uring_sqe* sqe = &ring->sqes[slot];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->fd = 0;
+    sqe->flags = IOSQE_FIXED_FILE;
+    sqe->user_data = ((uint64_t)ring->batch << 32) | index;
+    ring->sq_array[slot] = slot;
+
+    return sqe;
+}
+
+/**
+ * \brief Remove the perfect hash index of a \ref store_file, if it has one,
+ * before its records change.
+ *
+ * \param sf            The \ref store_file for this operation.
+ *
+ * \note The index and its footer are truncated away and made durable before
+ * \ref STORE_FLAG_PERFECT_HASH is cleared, so that a crash in between leaves
+ * an image that is rejected, rather than one whose index is read as records.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_FILE_WRITE_FAILED if the file could not be truncated or
+ *        its header could not be written.
+ *      - ERROR_STORE_FILE_SYNC_FAILED if the data sync failed.
+ */
+status FN_DECL_MUST_CHECK
+store_file_index_drop(
+    store_file* sf);
+
+/**
+ * \brief Write the generation of a \ref store_file to its store header.
+ *
+ * \param sf            The \ref store_file for this operation.
+ * \param generation    The new generation.
+ *
+ * \note The header is not synced here.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_FILE_WRITE_FAILED if the header could not be written.
+ */
+status FN_DECL_MUST_CHECK
+store_file_generation_set(
+    store_file* sf, uint32_t generation);
+
+/**
+ * \brief Sync the directory that holds the given path, so that a rename in it
+ * is durable.
+ *
+ * \param alloc         The allocator for this operation.
+ * \param path          A path in the directory to sync.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_STORE_FILE_SYNC_FAILED if the directory could not be synced.
+ */
+status FN_DECL_MUST_CHECK
+store_file_directory_sync(
+    RCPR_SYM(allocator)* alloc, const char* path);
+
+/**
+ * \brief Read exactly the given number of bytes with pread.
+ *
+ * \param fd            The file to read.
+ * \param data          The buffer to read into.
+ * \param size          The number of bytes to read.
+ * \param offset        The file offset to read from.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_FILE_READ_FAILED if the read failed or reached the end of
+ *        the file.
+ */
+status FN_DECL_MUST_CHECK
+store_file_pread_all(
+    int fd, void* data, size_t size, uint64_t offset);
+
+/**
+ * \brief Write every byte of an iovec array with pwritev.
+ *
+ * \param fd            The file to write.
+ * \param iov           The entries to write, which are modified as they are
+ *                      written.
+ * \param count         The number of entries.
+ * \param offset        The file offset to write to.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_FILE_WRITE_FAILED if the write failed.
+ */
+status FN_DECL_MUST_CHECK
+store_file_pwritev_all(
+    int fd, struct iovec* iov, size_t count, uint64_t offset);
+
+/**
+ * \brief Advance an iovec array past the given number of written bytes.
+ *
+ * \param iov           Pointer to the first unwritten entry, which is updated.
+ * \param count         Pointer to the number of unwritten entries, which is
+ *                      updated.
+ * \param written       The number of bytes written.
+ */
+static inline void
+store_file_iovec_advance(
+    struct iovec** iov, size_t* count, size_t written)
+{
+    while (written > 0)
+    {
+        size_t consumed =
+            written < (*iov)->iov_len ? written : (*iov)->iov_len;
+        (*iov)->iov_base = (uint8_t*)(*iov)->iov_base + consumed;
+        (*iov)->iov_len -= consumed;
+        written -= consumed;
+
+        if (0 == (*iov)->iov_len)
+        {
+            ++*iov;
+            --*count;
+        }
+    }
+}
+
+/**
+ * \brief Scan the image for the live records in the current partition of a
+ * compaction thread.
+ *
+ * \param worker        The compaction thread state.
+ *
+ * \note On return, the first \p worker->live_count entries of the table are
+ * the live records of this partition, in image order, and
+ * \p worker->live_size is their framed size. The result is stored in
+ * \p worker->retval.
+ */
+void
+store_file_compact_scan(
+    store_file_compact_worker* worker);
+
+/**
+ * \brief Copy the live records found by \ref store_file_compact_scan to the
+ * region of the new image starting at \p worker->out_offset.
+ *
+ * \param worker        The compaction thread state.
+ *
+ * \note The result is stored in \p worker->retval.
+ */
+void
+store_file_compact_write(
+    store_file_compact_worker* worker);
+
+/**
+ * \brief Set up the buffers of a compaction thread, in its own arena.
+ *
+ * \param worker        The compaction thread state.
+ * \param table_capacity    The initial number of index slots.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+store_file_compact_worker_init(
+    store_file_compact_worker* worker, size_t table_capacity);
+
+/**
+ * \brief Release whatever was set up for a compaction thread.
+ *
+ * \param worker        The compaction thread state.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+store_file_compact_worker_dispose(
+    store_file_compact_worker* worker);
+
+/**
+ * \brief Run one step on every compaction thread, using the calling thread for
+ * the first one, and wait for all of them.
+ *
+ * \param workers       The compaction threads.
+ * \param count         The number of compaction threads.
+ * \param thread        The step to run.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_THREAD_CREATE_FAILED if a thread could not be started.
+ *      - the first error from any thread.
+ */
+status FN_DECL_MUST_CHECK
+store_file_compact_run(
+    store_file_compact_worker* workers, size_t count, void* (*thread)(void*));
+
+/**
+ * \brief Add the live records of each thread's partition to the perfect hash,
+ * and put each thread's records in slot order.
+ *
+ * \param builder       Pointer to the perfect hash builder, which is released
+ *                      and set to NULL if the perfect hash cannot be built.
+ * \param alloc         The allocator for the scratch space.
+ * \param workers       The compaction threads, in partition order.
+ * \param count         The number of compaction threads.
+ * \param scratch       Pointer to the scratch space for keys and slots.
+ * \param scratch_capacity  Pointer to the number of records that fit in the
+ *                      scratch space.
+ *
+ * \note The slots of a partition follow those of the partitions before it,
+ * just as its records follow theirs in the new image, so a record's position
+ * within its thread is its slot less the first slot of its partition.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+store_file_compact_index_add(
+    perfect_hash_builder** builder, RCPR_SYM(allocator)* alloc,
+    store_file_compact_worker* workers, size_t count, uint64_t** scratch,
+    size_t* scratch_capacity);
+
+/**
+ * \brief Append the perfect hash and its footer to the new image, and set
+ * \ref STORE_FLAG_PERFECT_HASH in its header.
+ *
+ * \param index_size    Pointer to receive the size of the perfect hash and its
+ *                      footer on success.
+ * \param alloc         The allocator for the serialized perfect hash.
+ * \param builder       The perfect hash builder, with every partition added.
+ * \param out           The new image.
+ * \param records_end   The end of the records in the new image.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+store_file_compact_index_write(
+    uint64_t* index_size, RCPR_SYM(allocator)* alloc,
+    const perfect_hash_builder* builder, store_file* out, uint64_t records_end);
+
+/**
+ * \brief Thread entry point for the scan step.
+ *
+ * \param context       The \ref store_file_compact_worker for this thread.
+ *
+ * \returns NULL.
+ */
+void*
+store_file_compact_scan_thread(
+    void* context);
+
+/**
+ * \brief Thread entry point for the write step.
+ *
+ * \param context       The \ref store_file_compact_worker for this thread.
+ *
+ * \returns NULL.
+ */
+void*
+store_file_compact_write_thread(
+    void* context);
+
+/**
+ * \brief Index one record, if it is in the partition of this thread.
+ *
+ * \param worker        The compaction thread state.
+ * \param data          The serialized record, followed by its trailer, if
+ *                      any.
+ * \param size          The size of the serialized record.
+ * \param offset        The offset of the framed record in the image.
+ *
+ * \note Only the fixed header is read to find the partition of a record, so
+ * each thread only verifies the checksum of, and fully decodes, the records
+ * in its own partition. Each record is therefore verified once per pass.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+store_file_compact_record_add(
+    store_file_compact_worker* worker, const uint8_t* data, uint32_t size,
+    uint64_t offset);
+
+/**
+ * \brief Find the index slot for a hash id, which is either its entry or the
+ * empty slot where it belongs.
+ *
+ * \param worker        The compaction thread state.
+ * \param hash          The hash of the hash id.
+ * \param key           The hash id.
+ * \param key_size      The size of the hash id.
+ *
+ * \returns the slot for this hash id.
+ */
+store_file_compact_entry*
+store_file_compact_slot_find(
+    store_file_compact_worker* worker, uint64_t hash, const void* key,
+    size_t key_size);
+
+/**
+ * \brief Double the size of the index of a compaction thread.
+ *
+ * \param worker        The compaction thread state.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+store_file_compact_table_grow(
+    store_file_compact_worker* worker);
+
+/**
+ * \brief Drop every record past its retention window, and gather the rest at
+ * the front of the index in image order.
+ *
+ * \param worker        The compaction thread state.
+ */
+void
+store_file_compact_live_select(
+    store_file_compact_worker* worker);
+
+/**
+ * \brief Order index entries by their offset in the image.
+ *
+ * \param lhs           The left hand \ref store_file_compact_entry.
+ * \param rhs           The right hand \ref store_file_compact_entry.
+ *
+ * \returns less than, equal to, or greater than zero if \p lhs is before, at,
+ * or after \p rhs in the image.
+ */
+int
+store_file_compact_entry_compare(
+    const void* lhs, const void* rhs);
+
+/**
+ * \brief Write the store header of an empty file, or validate the store header
+ * of an existing file.
+ *
+ * \param sf            The \ref store_file for this operation.
+ * \param flags         The STORE_FILE_FLAG_ values used to open this file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_FILE_READ_FAILED if the store header could not be read.
+ *      - ERROR_STORE_FILE_WRITE_FAILED if the store header could not be
+ *        written.
+ *      - ERROR_STORE_INVALID_HEADER if the store header is invalid.
+ *      - ERROR_STORE_UNKNOWN_FORMAT_VERSION if the store format version is not
+ *        supported.
+ *      - ERROR_STORE_INVALID_INDEX if the index footer is invalid.
+ */
+status FN_DECL_MUST_CHECK
+store_file_header_init(
+    store_file* sf, uint32_t flags);
+
+/**
+ * \brief Read the index footer of a store file with
+ * \ref STORE_FLAG_PERFECT_HASH set, and split its size into the records and
+ * the index.
+ *
+ * \param sf            The \ref store_file for this operation.
+ *
+ * \note The checksum of the index is left to the loader, which reads it.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_FILE_READ_FAILED if the footer could not be read.
+ *      - ERROR_STORE_INVALID_INDEX if the footer is invalid.
+ */
+status FN_DECL_MUST_CHECK
+store_file_index_footer_read(
+    store_file* sf);
+
+/**
+ * \brief Add a checksum trailer entry after the entries of each record.
+ *
+ * \param iov           The entries of each framed record, packed at
+ *                      \ref METADATA_IOVEC_COUNT entries per record, with room
+ *                      for one more entry per record.
+ * \param trailers      Scratch space for \p count trailers.
+ * \param count         The number of records.
+ *
+ * \note Records are spread out from the last to the first, so no entry is
+ * overwritten before it is moved.
+ */
+void
+store_file_trailers_add(
+    struct iovec* iov, uint8_t* trailers, size_t count);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
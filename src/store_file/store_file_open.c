@@ -0,0 +1,149 @@
+/**
+ * \file store_file/store_file_open.c
+ *
+ * \brief Open a \ref store_file.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <fcntl.h>
+#include <nepe2/error_codes.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "store_file_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Open a store file.
+ *
+ * \param sf            Pointer to the store file pointer to receive the store
+ *                      file on success.
+ * \param alloc         The allocator instance to use for this operation.
+ * \param path          The path of the store image.
+ * \param flags         Zero or more STORE_FILE_FLAG_ values.
+ *
+ * \note If \ref STORE_FILE_FLAG_IO_URING is set but io_uring is unavailable,
+ * for instance because the kernel is too old or io_uring is disabled, the store
+ * file silently uses the pread backend. The backend in use is returned by
+ * \ref store_file_backend_get.
+ *
+ * A new store image has \ref STORE_FLAG_CRC32C set if
+ * \ref STORE_FILE_FLAG_CRC32C is set. An existing image keeps the flags in its
+ * header, which are returned by \ref store_file_header_flags_get, and every
+ * append follows them. If the image has \ref STORE_FLAG_PERFECT_HASH set, the
+ * size of the store file is the end of its records, and the first append or
+ * truncate removes the index and clears the flag.
+ *
+ * This store file is a \ref resource that must be released by calling
+ * \ref resource_release on its resource handle when it is no longer needed by
+ * the caller. The resource handle can be accessed by calling
+ * \ref store_file_resource_handle on this store file instance.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_STORE_FILE_OPEN_FAILED if the file could not be opened or
+ *        created.
+ *      - ERROR_STORE_FILE_READ_FAILED if the store header could not be read.
+ *      - ERROR_STORE_FILE_WRITE_FAILED if the store header of a new file could
+ *        not be written.
+ *      - ERROR_STORE_INVALID_HEADER if the store header is invalid.
+ *      - ERROR_STORE_UNKNOWN_FORMAT_VERSION if the store format version is not
+ *        supported.
+ *      - ERROR_STORE_INVALID_INDEX if the index footer is invalid.
+ */
+status FN_DECL_MUST_CHECK
+store_file_open(
+    store_file** sf, RCPR_SYM(allocator)* alloc, const char* path,
+    uint32_t flags)
+{
+    status retval, release_retval;
+    store_file* tmp = NULL;
+    struct stat st;
+    int open_flags = O_RDWR | O_CLOEXEC;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != sf);
+    RCPR_MODEL_ASSERT(prop_allocator_valid(alloc));
+    RCPR_MODEL_ASSERT(NULL != path);
+
+    /* allocate memory for the store file instance. */
+    retval = allocator_allocate(alloc, (void**)&tmp, sizeof(*tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(tmp, 0, sizeof(*tmp)));
+    tmp->ring.fd = -1;
+    tmp->backend = STORE_FILE_BACKEND_PREAD;
+
+    /* the tag is not set by default. */
+    RCPR_MODEL_ONLY(tmp->RCPR_MODEL_STRUCT_TAG_REF(store_file) = 0);
+    RCPR_MODEL_ASSERT_STRUCT_TAG_NOT_INITIALIZED(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(store_file), store_file);
+
+    /* set the tag. */
+    RCPR_MODEL_STRUCT_TAG_INIT(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(store_file), store_file);
+
+    /* initialize resource. */
+    resource_init(&tmp->hdr, &store_file_resource_release);
+    tmp->alloc = alloc;
+
+    /* open the file. */
+    if (flags & STORE_FILE_FLAG_CREATE)
+    {
+        open_flags |= O_CREAT;
+    }
+
+    tmp->fd = open(path, open_flags, S_IRUSR | S_IWUSR);
+    if (tmp->fd < 0 || 0 != fstat(tmp->fd, &st))
+    {
+        retval = ERROR_STORE_FILE_OPEN_FAILED;
+        goto cleanup_tmp;
+    }
+
+    /* write the header of a new file, or check the header of this one. */
+    tmp->size = (uint64_t)st.st_size;
+    retval = store_file_header_init(tmp, flags);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    /* use io_uring if it is requested and available. */
+    if ((flags & STORE_FILE_FLAG_IO_URING)
+     && store_file_uring_init(&tmp->ring, tmp->fd))
+    {
+        tmp->backend = STORE_FILE_BACKEND_IO_URING;
+    }
+
+    /* success. */
+    *sf = tmp;
+    retval = STATUS_SUCCESS;
+    goto done;
+
+cleanup_tmp:
+    if (tmp->fd >= 0)
+    {
+        close(tmp->fd);
+    }
+
+    RCPR_MODEL_EXEMPT(memset(tmp, 0, sizeof(*tmp)));
+    release_retval = allocator_reclaim(alloc, tmp);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
@@ -0,0 +1,53 @@
+/**
+ * \file store_file/store_file_pread_all.c
+ *
+ * \brief Read an exact number of bytes from a file.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <errno.h>
+#include <nepe2/error_codes.h>
+#include <unistd.h>
+
+#include "store_file_internal.h"
+
+/**
+ * \brief Read exactly the given number of bytes with pread.
+ *
+ * \param fd            The file to read.
+ * \param data          The buffer to read into.
+ * \param size          The number of bytes to read.
+ * \param offset        The file offset to read from.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_FILE_READ_FAILED if the read failed or reached the end of
+ *        the file.
+ */
+status FN_DECL_MUST_CHECK
+store_file_pread_all(
+    int fd, void* data, size_t size, uint64_t offset)
+{
+    uint8_t* out = (uint8_t*)data;
+
+    while (size > 0)
+    {
+        ssize_t bytes = pread(fd, out, size, (off_t)offset);
+        if (bytes < 0 && EINTR == errno)
+        {
+            continue;
+        }
+        else if (bytes <= 0)
+        {
+            return ERROR_STORE_FILE_READ_FAILED;
+        }
+
+        out += bytes;
+        size -= (size_t)bytes;
+        offset += (uint64_t)bytes;
+    }
+
+    return STATUS_SUCCESS;
+}
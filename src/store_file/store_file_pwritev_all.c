@@ -0,0 +1,50 @@
+/**
+ * \file store_file/store_file_pwritev_all.c
+ *
+ * \brief Write every byte of an iovec array to a file.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <errno.h>
+#include <nepe2/error_codes.h>
+
+#include "store_file_internal.h"
+
+/**
+ * \brief Write every byte of an iovec array with pwritev.
+ *
+ * \param fd            The file to write.
+ * \param iov           The entries to write, which are modified as they are
+ *                      written.
+ * \param count         The number of entries.
+ * \param offset        The file offset to write to.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_FILE_WRITE_FAILED if the write failed.
+ */
+status FN_DECL_MUST_CHECK
+store_file_pwritev_all(
+    int fd, struct iovec* iov, size_t count, uint64_t offset)
+{
+    while (count > 0)
+    {
+        int chunk = count > IOV_MAX ? IOV_MAX : (int)count;
+        ssize_t bytes = pwritev(fd, iov, chunk, (off_t)offset);
+        if (bytes < 0 && EINTR == errno)
+        {
+            continue;
+        }
+        else if (bytes <= 0)
+        {
+            return ERROR_STORE_FILE_WRITE_FAILED;
+        }
+
+        offset += (uint64_t)bytes;
+        store_file_iovec_advance(&iov, &count, (size_t)bytes);
+    }
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,113 @@
+/**
+ * \file store_file/store_file_read_batch.c
+ *
+ * \brief Perform a batch of reads from a \ref store_file.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+
+#include "store_file_internal.h"
+
+/**
+ * \brief The largest read submitted as one ring entry.
+ */
+#define STORE_FILE_URING_READ_MAX                                   0x40000000
+
+/**
+ * \brief Perform a batch of reads from a \ref store_file.
+ *
+ * \param sf            The \ref store_file for this operation.
+ * \param requests      The reads to perform.
+ * \param count         The number of reads.
+ *
+ * \note With the io_uring backend, the whole batch is submitted and reaped with
+ * as few system calls as the ring size allows. A read that completes short, or
+ * that the kernel rejects, is finished with pread.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_FILE_READ_FAILED if any read failed or reached the end of
+ *        the file.
+ */
+status FN_DECL_MUST_CHECK
+store_file_read_batch(
+    store_file* sf, const store_file_read_request* requests, size_t count)
+{
+    status retval;
+    int results[STORE_FILE_URING_ENTRIES];
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_store_file_valid(sf));
+    RCPR_MODEL_ASSERT(NULL != requests || 0 == count);
+
+    /* the pread backend reads each request in turn. */
+    if (STORE_FILE_BACKEND_IO_URING != sf->backend)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            retval =
+                store_file_pread_all(
+                    sf->fd, requests[i].data, requests[i].size,
+                    requests[i].offset);
+            if (STATUS_SUCCESS != retval)
+            {
+                return retval;
+            }
+        }
+
+        return STATUS_SUCCESS;
+    }
+
+    /* submit the batch one ring at a time. */
+    unsigned ring_size =
+        sf->ring.entries < STORE_FILE_URING_ENTRIES
+            ? sf->ring.entries : STORE_FILE_URING_ENTRIES;
+    while (count > 0)
+    {
+        unsigned chunk = count < ring_size ? (unsigned)count : ring_size;
+
+        for (unsigned i = 0; i < chunk; ++i)
+        {
+            struct io_uring_sqe* sqe = store_file_uring_sqe_get(&sf->ring, i);
+            sqe->opcode = IORING_OP_READ;
+            sqe->off = requests[i].offset;
+            sqe->addr = (uint64_t)(uintptr_t)requests[i].data;
+            sqe->len =
+                requests[i].size < STORE_FILE_URING_READ_MAX
+                    ? (uint32_t)requests[i].size : STORE_FILE_URING_READ_MAX;
+        }
+
+        /* a failed ring leaves the rest of the batch to pread. */
+        if (!store_file_uring_submit(&sf->ring, chunk, results))
+        {
+            store_file_uring_disable(sf);
+
+            return store_file_read_batch(sf, requests, count);
+        }
+
+        /* finish any short or rejected reads. */
+        for (unsigned i = 0; i < chunk; ++i)
+        {
+            size_t done = results[i] > 0 ? (size_t)results[i] : 0;
+            if (done < requests[i].size)
+            {
+                retval =
+                    store_file_pread_all(
+                        sf->fd, (uint8_t*)requests[i].data + done,
+                        requests[i].size - done, requests[i].offset + done);
+                if (STATUS_SUCCESS != retval)
+                {
+                    return retval;
+                }
+            }
+        }
+
+        requests += chunk;
+        count -= chunk;
+    }
+
+    return STATUS_SUCCESS;
+}
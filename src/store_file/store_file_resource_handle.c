@@ -0,0 +1,26 @@
+/**
+ * \file store_file/store_file_resource_handle.c
+ *
+ * \brief Get the resource handle for a \ref store_file.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_file_internal.h"
+
+/**
+ * \brief Given a \ref store_file instance, return the resource handle for this
+ * \ref store_file instance.
+ *
+ * \param sf            The \ref store_file instance from which the resource
+ *                      handle is returned.
+ *
+ * \returns the resource handle for this \ref store_file instance.
+ */
+RCPR_SYM(resource)*
+store_file_resource_handle(
+    store_file* sf)
+{
+    return &sf->hdr;
+}
@@ -0,0 +1,50 @@
+/**
+ * \file store_file/store_file_resource_release.c
+ *
+ * \brief Release a \ref store_file resource.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+#include <unistd.h>
+
+#include "store_file_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Release a \ref store_file resource.
+ *
+ * \param r             Pointer to the \ref store_file resource to be released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status store_file_resource_release(RCPR_SYM(resource)* r)
+{
+    store_file* sf = (store_file*)r;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_store_file_valid(sf));
+
+    /* cache allocator. */
+    allocator* alloc = sf->alloc;
+
+    /* tear down the ring before closing the file registered with it. */
+    if (STORE_FILE_BACKEND_IO_URING == sf->backend)
+    {
+        store_file_uring_release(&sf->ring);
+    }
+
+    close(sf->fd);
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(sf, 0, sizeof(*sf)));
+
+    /* reclaim memory. */
+    return allocator_reclaim(alloc, sf);
+}
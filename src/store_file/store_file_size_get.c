@@ -0,0 +1,27 @@
+/**
+ * \file store_file/store_file_size_get.c
+ *
+ * \brief Get the size of the store image of a \ref store_file.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_file_internal.h"
+
+/**
+ * \brief Get the size of the store image of a \ref store_file, including every
+ * append, but not a perfect hash index.
+ *
+ * \param sf            The \ref store_file instance for this operation.
+ *
+ * \returns the size of the store image.
+ */
+uint64_t
+store_file_size_get(
+    const store_file* sf)
+{
+    RCPR_MODEL_ASSERT(prop_store_file_valid(sf));
+
+    return sf->size;
+}
@@ -0,0 +1,120 @@
+/**
+ * \file store_file/store_file_snapshot_read.c
+ *
+ * \brief Read the index snapshot sidecar of a store image.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <fcntl.h>
+#include <nepe2/error_codes.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "store_file_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Read the index snapshot sidecar of a store image.
+ *
+ * \param snapshot      Pointer to receive the index snapshot on success.
+ * \param alloc         The allocator instance to use for this operation.
+ * \param path          The path of the store image.
+ *
+ * \note The snapshot is not checked here; a stale or damaged snapshot is
+ * ignored by \ref store_create_from_buffer_with_snapshot.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_STORE_FILE_OPEN_FAILED if there is no sidecar, or it could not
+ *        be opened.
+ *      - ERROR_STORE_FILE_READ_FAILED if the sidecar could not be read.
+ */
+status FN_DECL_MUST_CHECK
+store_file_snapshot_read(
+    secure_buffer** snapshot, RCPR_SYM(allocator)* alloc, const char* path)
+{
+    status retval, release_retval;
+    char* sidecar_path = NULL;
+    secure_buffer* tmp = NULL;
+    struct stat st;
+    size_t size;
+    int fd;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != snapshot);
+    RCPR_MODEL_ASSERT(prop_allocator_valid(alloc));
+    RCPR_MODEL_ASSERT(NULL != path);
+
+    size_t sidecar_size = strlen(path) + sizeof(STORE_FILE_SNAPSHOT_SUFFIX);
+    retval = allocator_allocate(alloc, (void**)&sidecar_path, sidecar_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    snprintf(
+        sidecar_path, sidecar_size, "%s%s", path, STORE_FILE_SNAPSHOT_SUFFIX);
+
+    fd = open(sidecar_path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        retval = ERROR_STORE_FILE_OPEN_FAILED;
+        goto cleanup_sidecar_path;
+    }
+
+    if (0 != fstat(fd, &st))
+    {
+        retval = ERROR_STORE_FILE_READ_FAILED;
+        goto cleanup_fd;
+    }
+
+    /* the snapshot must fit in memory. */
+    if ((uint64_t)st.st_size > SIZE_MAX)
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_fd;
+    }
+
+    retval = secure_buffer_create(&tmp, alloc, (size_t)st.st_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_fd;
+    }
+
+    void* data = secure_buffer_data(&size, tmp);
+    retval = store_file_pread_all(fd, data, size, 0);
+    if (STATUS_SUCCESS != retval)
+    {
+        release_retval = resource_release(secure_buffer_resource_handle(tmp));
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+
+        goto cleanup_fd;
+    }
+
+    /* success. */
+    *snapshot = tmp;
+
+cleanup_fd:
+    close(fd);
+
+cleanup_sidecar_path:
+    release_retval = allocator_reclaim(alloc, sidecar_path);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
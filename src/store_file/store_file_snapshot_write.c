@@ -0,0 +1,132 @@
+/**
+ * \file store_file/store_file_snapshot_write.c
+ *
+ * \brief Write the index snapshot sidecar of a store image.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <fcntl.h>
+#include <nepe2/error_codes.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "store_file_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief The suffix of the temporary file that is renamed over the sidecar.
+ */
+#define STORE_FILE_SNAPSHOT_TEMP_SUFFIX                                 ".tmp"
+
+/**
+ * \brief Write the index snapshot sidecar of a store image.
+ *
+ * \param alloc         The allocator instance to use for this operation.
+ * \param path          The path of the store image.
+ * \param snapshot      The index snapshot, as written by
+ *                      \ref store_snapshot_create.
+ *
+ * \note The sidecar is the store image path followed by
+ * \ref STORE_FILE_SNAPSHOT_SUFFIX. The snapshot is written to a temporary
+ * file, which is synced and then renamed over the sidecar, so a crash leaves
+ * either the old sidecar or the new one.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_STORE_FILE_OPEN_FAILED if the temporary file could not be
+ *        created.
+ *      - ERROR_STORE_FILE_WRITE_FAILED if the snapshot could not be written.
+ *      - ERROR_STORE_FILE_SYNC_FAILED if the snapshot could not be synced.
+ *      - ERROR_STORE_FILE_SWAP_FAILED if the temporary file could not be
+ *        renamed over the sidecar.
+ */
+status FN_DECL_MUST_CHECK
+store_file_snapshot_write(
+    RCPR_SYM(allocator)* alloc, const char* path,
+    const secure_buffer* snapshot)
+{
+    status retval, release_retval;
+    char* paths = NULL;
+    struct iovec iov;
+    size_t size;
+    int fd;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_allocator_valid(alloc));
+    RCPR_MODEL_ASSERT(NULL != path);
+    RCPR_MODEL_ASSERT(prop_secure_buffer_valid(snapshot));
+
+    /* the sidecar path is followed by the temporary path. */
+    size_t sidecar_size = strlen(path) + sizeof(STORE_FILE_SNAPSHOT_SUFFIX);
+    size_t temp_size =
+        sidecar_size - 1 + sizeof(STORE_FILE_SNAPSHOT_TEMP_SUFFIX);
+    retval =
+        allocator_allocate(alloc, (void**)&paths, sidecar_size + temp_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    char* sidecar_path = paths;
+    char* temp_path = paths + sidecar_size;
+    snprintf(
+        sidecar_path, sidecar_size, "%s%s", path, STORE_FILE_SNAPSHOT_SUFFIX);
+    snprintf(
+        temp_path, temp_size, "%s%s%s", path, STORE_FILE_SNAPSHOT_SUFFIX,
+        STORE_FILE_SNAPSHOT_TEMP_SUFFIX);
+
+    /* write and sync the temporary file. */
+    fd =
+        open(
+            temp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+            S_IRUSR | S_IWUSR);
+    if (fd < 0)
+    {
+        retval = ERROR_STORE_FILE_OPEN_FAILED;
+        goto cleanup_paths;
+    }
+
+    iov.iov_base = secure_buffer_data(&size, (secure_buffer*)snapshot);
+    iov.iov_len = size;
+    retval = store_file_pwritev_all(fd, &iov, 1, 0);
+    if (STATUS_SUCCESS == retval && 0 != fdatasync(fd))
+    {
+        retval = ERROR_STORE_FILE_SYNC_FAILED;
+    }
+
+    close(fd);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_temp;
+    }
+
+    /* then replace the sidecar. */
+    if (0 != rename(temp_path, sidecar_path))
+    {
+        retval = ERROR_STORE_FILE_SWAP_FAILED;
+        goto cleanup_temp;
+    }
+
+    retval = store_file_directory_sync(alloc, sidecar_path);
+    goto cleanup_paths;
+
+cleanup_temp:
+    unlink(temp_path);
+
+cleanup_paths:
+    release_retval = allocator_reclaim(alloc, paths);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
@@ -0,0 +1,55 @@
+/**
+ * \file store_file/store_file_sync.c
+ *
+ * \brief Make every append to a \ref store_file durable.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <unistd.h>
+
+#include "store_file_internal.h"
+
+/**
+ * \brief Make every append to a \ref store_file durable.
+ *
+ * \param sf            The \ref store_file for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_FILE_SYNC_FAILED if the data sync failed.
+ */
+status FN_DECL_MUST_CHECK
+store_file_sync(
+    store_file* sf)
+{
+    int result;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_store_file_valid(sf));
+
+    if (STORE_FILE_BACKEND_IO_URING == sf->backend)
+    {
+        struct io_uring_sqe* sqe = store_file_uring_sqe_get(&sf->ring, 0);
+        sqe->opcode = IORING_OP_FSYNC;
+        sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+
+        /* an error from the sync itself is not retried. */
+        if (store_file_uring_submit(&sf->ring, 1, &result))
+        {
+            return 0 == result ? STATUS_SUCCESS : ERROR_STORE_FILE_SYNC_FAILED;
+        }
+
+        store_file_uring_disable(sf);
+    }
+
+    /* the pread backend, or a failed ring, syncs directly. */
+    if (0 != fdatasync(sf->fd))
+    {
+        return ERROR_STORE_FILE_SYNC_FAILED;
+    }
+
+    return STATUS_SUCCESS;
+}
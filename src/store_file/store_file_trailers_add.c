@@ -0,0 +1,61 @@
+/**
+ * \file store_file/store_file_trailers_add.c
+ *
+ * \brief Add checksum trailers to the records of a \ref store_file append.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <rcpr/socket_utilities.h>
+#include <string.h>
+
+#include "store_file_internal.h"
+
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Add a checksum trailer entry after the entries of each record.
+ *
+ * \param iov           The entries of each framed record, packed at
+ *                      \ref METADATA_IOVEC_COUNT entries per record, with room
+ *                      for one more entry per record.
+ * \param trailers      Scratch space for \p count trailers.
+ * \param count         The number of records.
+ *
+ * \note Records are spread out from the last to the first, so no entry is
+ * overwritten before it is moved.
+ */
+void
+store_file_trailers_add(
+    struct iovec* iov, uint8_t* trailers, size_t count)
+{
+    const size_t stride = METADATA_IOVEC_COUNT + 1;
+
+    for (size_t i = count; i-- > 0;)
+    {
+        struct iovec* record = iov + i * stride;
+        uint8_t* trailer = trailers + i * STORE_RECORD_TRAILER_SIZE;
+        uint32_t crc;
+
+        memmove(
+            record, iov + i * METADATA_IOVEC_COUNT,
+            METADATA_IOVEC_COUNT * sizeof(*record));
+
+        /* the first entry starts with the length prefix. */
+        crc =
+            store_crc32c(
+                0, (const uint8_t*)record[0].iov_base
+                        + STORE_RECORD_PREFIX_SIZE,
+                record[0].iov_len - STORE_RECORD_PREFIX_SIZE);
+        for (size_t j = 1; j < METADATA_IOVEC_COUNT; ++j)
+        {
+            crc = store_crc32c(crc, record[j].iov_base, record[j].iov_len);
+        }
+
+        crc = socket_utility_hton32(crc);
+        memcpy(trailer, &crc, sizeof(crc));
+        record[METADATA_IOVEC_COUNT].iov_base = trailer;
+        record[METADATA_IOVEC_COUNT].iov_len = STORE_RECORD_TRAILER_SIZE;
+    }
+}
@@ -0,0 +1,76 @@
+/**
+ * \file store_file/store_file_truncate.c
+ *
+ * \brief Truncate the store image of a \ref store_file.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <unistd.h>
+
+#include "store_file_internal.h"
+
+/**
+ * \brief Truncate the store image of a \ref store_file, and make the new size
+ * durable.
+ *
+ * \param sf            The \ref store_file for this operation.
+ * \param size          The new size of the store image.
+ *
+ * \note If the store image has a perfect hash index, the index is removed
+ * first. The generation of the store image is then advanced and made durable
+ * before the file is truncated, so that no index snapshot of the records that
+ * are removed is used again.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_STORE_FILE_WRITE_FAILED if the file could not be truncated, or
+ *        if the generation could not be written.
+ *      - ERROR_STORE_FILE_SYNC_FAILED if the data sync failed.
+ */
+status FN_DECL_MUST_CHECK
+store_file_truncate(
+    store_file* sf, uint64_t size)
+{
+    status retval;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_store_file_valid(sf));
+    RCPR_MODEL_ASSERT(size >= STORE_HEADER_SIZE && size <= sf->size);
+
+    /* the index no longer matches the records. */
+    retval = store_file_index_drop(sf);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* a snapshot of the old records must not outlive them. */
+    retval = store_file_generation_set(sf, sf->generation + 1);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    if (0 != fdatasync(sf->fd))
+    {
+        return ERROR_STORE_FILE_SYNC_FAILED;
+    }
+
+    if (0 != ftruncate(sf->fd, (off_t)size))
+    {
+        return ERROR_STORE_FILE_WRITE_FAILED;
+    }
+
+    sf->size = size;
+
+    /* the new size is file metadata that the data sync covers. */
+    if (0 != fdatasync(sf->fd))
+    {
+        return ERROR_STORE_FILE_SYNC_FAILED;
+    }
+
+    return STATUS_SUCCESS;
+}
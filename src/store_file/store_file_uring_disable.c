@@ -0,0 +1,31 @@
+/**
+ * \file store_file/store_file_uring_disable.c
+ *
+ * \brief Switch a \ref store_file whose ring failed to the pread backend.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "store_file_internal.h"
+
+/**
+ * \brief Switch a \ref store_file whose ring failed to the pread backend for
+ * good, and tear down the ring.
+ *
+ * \param sf            The \ref store_file for this operation.
+ *
+ * \note \ref store_file_uring_submit leaves nothing in flight when it fails, so
+ * the ring can be torn down right away.
+ */
+void
+store_file_uring_disable(
+    store_file* sf)
+{
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_store_file_valid(sf));
+    RCPR_MODEL_ASSERT(STORE_FILE_BACKEND_IO_URING == sf->backend);
+
+    store_file_uring_release(&sf->ring);
+    sf->backend = STORE_FILE_BACKEND_PREAD;
+}
@@ -0,0 +1,136 @@
+/**
+ * \file store_file/store_file_uring_init.c
+ *
+ * \brief Set up an io_uring instance for a \ref store_file.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "store_file_internal.h"
+
+/**
+ * \brief Set up an io_uring instance for the given file.
+ *
+ * \param ring          The ring to set up.
+ * \param fd            The file, which is registered with the ring as fixed
+ *                      file 0.
+ *
+ * \note This uses the io_uring system calls directly, rather than a helper
+ * library. Any failure, including the system calls being unavailable or
+ * disabled, leaves the ring unused so that the caller can fall back to the
+ * pread backend.
+ *
+ * \returns true if the ring was set up, or false if io_uring is unavailable.
+ */
+bool
+store_file_uring_init(
+    store_file_uring* ring, int fd)
+{
+    struct io_uring_params params;
+
+    memset(ring, 0, sizeof(*ring));
+    memset(&params, 0, sizeof(params));
+
+    ring->fd =
+        (int)syscall(__NR_io_uring_setup, STORE_FILE_URING_ENTRIES, &params);
+    if (ring->fd < 0)
+    {
+        return false;
+    }
+
+    /* map the submission ring, and the completion ring if it is separate. */
+    ring->sq_ring_size =
+        params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size =
+        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (ring->cq_ring_size > ring->sq_ring_size)
+        {
+            ring->sq_ring_size = ring->cq_ring_size;
+        }
+    }
+
+    ring->sq_ring =
+        mmap(
+            NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (MAP_FAILED == ring->sq_ring)
+    {
+        goto cleanup_fd;
+    }
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        ring->cq_ring = ring->sq_ring;
+        ring->cq_ring_size = 0;
+    }
+    else
+    {
+        ring->cq_ring =
+            mmap(
+                NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        if (MAP_FAILED == ring->cq_ring)
+        {
+            goto cleanup_sq_ring;
+        }
+    }
+
+    /* map the submission queue entries. */
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes =
+        (struct io_uring_sqe*)mmap(
+            NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (MAP_FAILED == (void*)ring->sqes)
+    {
+        goto cleanup_cq_ring;
+    }
+
+    /* register the file, so that each request skips the file table. */
+    if (0 != syscall(
+                __NR_io_uring_register, ring->fd, IORING_REGISTER_FILES, &fd,
+                1))
+    {
+        goto cleanup_sqes;
+    }
+
+    uint8_t* sq = (uint8_t*)ring->sq_ring;
+    uint8_t* cq = (uint8_t*)ring->cq_ring;
+    ring->entries = params.sq_entries;
+    ring->sq_head = (unsigned*)(sq + params.sq_off.head);
+    ring->sq_tail = (unsigned*)(sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned*)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned*)(sq + params.sq_off.array);
+    ring->cq_head = (unsigned*)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned*)(cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+
+    return true;
+
+cleanup_sqes:
+    munmap(ring->sqes, ring->sqes_size);
+
+cleanup_cq_ring:
+    if (ring->cq_ring != ring->sq_ring)
+    {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+
+cleanup_sq_ring:
+    munmap(ring->sq_ring, ring->sq_ring_size);
+
+cleanup_fd:
+    close(ring->fd);
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = -1;
+
+    return false;
+}
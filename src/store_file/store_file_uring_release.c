@@ -0,0 +1,34 @@
+/**
+ * \file store_file/store_file_uring_release.c
+ *
+ * \brief Tear down the io_uring instance of a \ref store_file.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "store_file_internal.h"
+
+/**
+ * \brief Tear down an io_uring instance.
+ *
+ * \param ring          The ring to tear down.
+ */
+void
+store_file_uring_release(
+    store_file_uring* ring)
+{
+    munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_ring != ring->sq_ring)
+    {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    munmap(ring->sq_ring, ring->sq_ring_size);
+    close(ring->fd);
+
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = -1;
+}
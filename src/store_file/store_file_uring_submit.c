@@ -0,0 +1,103 @@
+/**
+ * \file store_file/store_file_uring_submit.c
+ *
+ * \brief Submit a batch to the io_uring instance of a \ref store_file.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <errno.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "store_file_internal.h"
+
+/**
+ * \brief Submit the prepared submission queue entries, and wait for all of
+ * them to complete.
+ *
+ * \param ring          The ring for this operation.
+ * \param count         The number of prepared entries, which must not be
+ *                      greater than the ring size.
+ * \param results       Array of \p count results, indexed by the position of
+ *                      each entry in the batch, which receives the result of
+ *                      each entry.
+ *
+ * \note The whole batch is normally submitted and reaped with a single
+ * io_uring_enter call. If the ring fails, the entries that the kernel has not
+ * taken are withdrawn, and this waits for the ones it has taken to complete,
+ * so that the caller can redo the batch without a stale write or sync landing
+ * afterwards. A completion from an earlier batch is discarded.
+ *
+ * \returns true on success, or false if the ring failed.
+ */
+bool
+store_file_uring_submit(
+    store_file_uring* ring, unsigned count, int* results)
+{
+    unsigned first = *ring->sq_tail;
+    unsigned to_submit = count;
+    unsigned expected = count;
+    unsigned completed = 0;
+    bool failed = false;
+
+    RCPR_MODEL_ASSERT(count <= ring->entries);
+
+    /* publish the prepared entries to the kernel. */
+    __atomic_store_n(ring->sq_tail, first + count, __ATOMIC_RELEASE);
+
+    while (completed < expected)
+    {
+        /* submit anything not yet taken, and wait for the rest. */
+        int submitted =
+            (int)syscall(
+                __NR_io_uring_enter, ring->fd, to_submit,
+                expected - completed, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (submitted >= 0)
+        {
+            to_submit -= (unsigned)submitted;
+        }
+        else if (EINTR == errno || EAGAIN == errno || EBUSY == errno)
+        {
+            continue;
+        }
+        else if (failed)
+        {
+            /* the ring can't wait, so poll for the last completions. */
+            sched_yield();
+        }
+        else
+        {
+            /* without SQPOLL, the kernel only reads the submission ring
+             * during io_uring_enter, so the entries it has not taken can be
+             * withdrawn. Each entry it has taken still completes. */
+            unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+            __atomic_store_n(ring->sq_tail, head, __ATOMIC_RELEASE);
+            expected = head - first;
+            to_submit = 0;
+            failed = true;
+        }
+
+        /* reap every available completion of this batch. */
+        unsigned head = *ring->cq_head;
+        unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head)
+        {
+            struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cq_mask];
+            uint32_t index = (uint32_t)cqe->user_data;
+            if ((cqe->user_data >> 32) == ring->batch && index < count)
+            {
+                results[index] = cqe->res;
+                ++completed;
+            }
+        }
+
+        __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    ++ring->batch;
+
+    return !failed;
+}
@@ -0,0 +1,64 @@
+/**
+ * \file upgrade_pipeline/upgrade_item_release.c
+ *
+ * \brief Release an item moving through an \ref upgrade_pipeline.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "upgrade_pipeline_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Release an item and everything it owns.
+ *
+ * \param alloc         The allocator for this item.
+ * \param item          The item to release.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+upgrade_item_release(
+    RCPR_SYM(allocator)* alloc, upgrade_item* item)
+{
+    status retval = STATUS_SUCCESS;
+    status release_retval;
+
+    /* the old record is owned by the source view. */
+
+    /* the password buffer is cleared when it is released. */
+    if (NULL != item->password)
+    {
+        release_retval =
+            resource_release(secure_buffer_resource_handle(item->password));
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    if (NULL != item->new_record)
+    {
+        release_retval =
+            resource_release(metadata_resource_handle(item->new_record));
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    RCPR_MODEL_EXEMPT(memset(item, 0, sizeof(*item)));
+
+    release_retval = allocator_reclaim(alloc, item);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
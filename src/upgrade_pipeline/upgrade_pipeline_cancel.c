@@ -0,0 +1,33 @@
+/**
+ * \file upgrade_pipeline/upgrade_pipeline_cancel.c
+ *
+ * \brief Cancel an \ref upgrade_pipeline.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "upgrade_pipeline_internal.h"
+
+/**
+ * \brief Ask an \ref upgrade_pipeline to stop.
+ *
+ * \param pipeline      The \ref upgrade_pipeline instance for this operation.
+ *
+ * \note Records in flight are discarded. The checkpoint still covers every
+ * record that was emitted, so the upgrade can be resumed from it.
+ */
+void
+upgrade_pipeline_cancel(
+    upgrade_pipeline* pipeline)
+{
+    pthread_mutex_lock(&pipeline->state_lock);
+    pipeline->canceled = true;
+    pthread_mutex_unlock(&pipeline->state_lock);
+
+    /* wake every stage so that it stops. */
+    for (size_t i = 0; i < pipeline->queues_initialized; ++i)
+    {
+        upgrade_queue_abort(&pipeline->queues[i]);
+    }
+}
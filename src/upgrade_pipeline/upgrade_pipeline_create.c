@@ -0,0 +1,170 @@
+/**
+ * \file upgrade_pipeline/upgrade_pipeline_create.c
+ *
+ * \brief Create and start an \ref upgrade_pipeline.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <string.h>
+
+#include "upgrade_pipeline_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Create an upgrade pipeline and start its stages.
+ *
+ * \param pipeline      Pointer to the upgrade pipeline pointer to receive the
+ *                      upgrade pipeline on success.
+ * \param alloc         The allocator instance to use for this operation. This
+ *                      allocator is used concurrently by every stage.
+ * \param options       The options for this pipeline, which are copied.
+ *
+ * \note This upgrade pipeline is a \ref resource that must be released by
+ * calling \ref resource_release on its resource handle when it is no longer
+ * needed by the caller. The resource handle can be accessed by calling
+ * \ref upgrade_pipeline_resource_handle on this upgrade pipeline instance.
+ * Releasing a running pipeline cancels it.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_UPGRADE_PIPELINE_BAD_TARGET_LAYER if the target layer is not a
+ *        layer of the view.
+ *      - ERROR_UPGRADE_PIPELINE_SYNC_INIT_FAILED if a lock or condition
+ *        variable could not be created.
+ *      - ERROR_UPGRADE_PIPELINE_THREAD_CREATE_FAILED if a stage thread could
+ *        not be created.
+ *
+ * \pre
+ *      - \p pipeline must not reference a valid \ref upgrade_pipeline instance
+ *        and must not be NULL.
+ *      - \p alloc must reference a valid, thread-safe \ref allocator.
+ *      - \p options must reference valid options, with every callback set.
+ * \post
+ *      - On success, \p pipeline is set to a pointer to a valid, running
+ *        \ref upgrade_pipeline instance, which is a \ref resource owned by the
+ *        caller that must be released when no longer needed.
+ *      - On failure, \p pipeline is not changed and an error status is
+ *        returned.
+ */
+status FN_DECL_MUST_CHECK
+upgrade_pipeline_create(
+    upgrade_pipeline** pipeline, RCPR_SYM(allocator)* alloc,
+    const upgrade_pipeline_options* options)
+{
+    status retval, release_retval;
+    upgrade_pipeline* tmp = NULL;
+    size_t queue_depth;
+    void* (*stages[UPGRADE_PIPELINE_STAGE_COUNT])(void*) = {
+        &upgrade_pipeline_lookup_stage,
+        &upgrade_pipeline_derive_old_stage,
+        &upgrade_pipeline_derive_new_stage,
+        &upgrade_pipeline_emit_stage };
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != pipeline);
+    RCPR_MODEL_ASSERT(prop_allocator_valid(alloc));
+    RCPR_MODEL_ASSERT(NULL != options);
+
+    /* the target layer may be one past the last layer, if the newest layer is
+     * the output of this pipeline. */
+    if (options->target_layer > migration_view_layer_count_get(options->view))
+    {
+        return ERROR_UPGRADE_PIPELINE_BAD_TARGET_LAYER;
+    }
+
+    /* allocate memory for the upgrade pipeline instance. */
+    retval = allocator_allocate(alloc, (void**)&tmp, sizeof(*tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(tmp, 0, sizeof(*tmp)));
+
+    /* the tag is not set by default. */
+    RCPR_MODEL_ONLY(tmp->RCPR_MODEL_STRUCT_TAG_REF(upgrade_pipeline) = 0);
+    RCPR_MODEL_ASSERT_STRUCT_TAG_NOT_INITIALIZED(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(upgrade_pipeline), upgrade_pipeline);
+
+    /* set the tag. */
+    RCPR_MODEL_STRUCT_TAG_INIT(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(upgrade_pipeline), upgrade_pipeline);
+
+    /* initialize resource. */
+    resource_init(&tmp->hdr, &upgrade_pipeline_resource_release);
+    tmp->alloc = alloc;
+    tmp->options = *options;
+    tmp->checkpoint = options->start;
+    tmp->first_error = STATUS_SUCCESS;
+    atomic_init(&tmp->scanned, 0);
+    atomic_init(&tmp->skipped, 0);
+    atomic_init(&tmp->upgraded, 0);
+
+    /* create the state lock. */
+    if (0 != pthread_mutex_init(&tmp->state_lock, NULL))
+    {
+        retval = ERROR_UPGRADE_PIPELINE_SYNC_INIT_FAILED;
+        goto cleanup_tmp;
+    }
+
+    /* create the queues between stages. */
+    queue_depth =
+        (0 == options->queue_depth)
+            ? UPGRADE_PIPELINE_DEFAULT_QUEUE_DEPTH
+            : options->queue_depth;
+    for (size_t i = 0; i < UPGRADE_PIPELINE_QUEUE_COUNT; ++i)
+    {
+        retval = upgrade_queue_init(&tmp->queues[i], alloc, queue_depth);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_pipeline;
+        }
+
+        ++tmp->queues_initialized;
+    }
+
+    /* start the stages. */
+    tmp->stages_running = UPGRADE_PIPELINE_STAGE_COUNT;
+    for (size_t i = 0; i < UPGRADE_PIPELINE_STAGE_COUNT; ++i)
+    {
+        if (0 != pthread_create(&tmp->threads[i], NULL, stages[i], tmp))
+        {
+            retval = ERROR_UPGRADE_PIPELINE_THREAD_CREATE_FAILED;
+            goto cleanup_pipeline;
+        }
+
+        ++tmp->threads_started;
+    }
+
+    /* success. */
+    *pipeline = tmp;
+    return STATUS_SUCCESS;
+
+cleanup_pipeline:
+    /* stop and join any started stages, and release the queues. */
+    release_retval = resource_release(&tmp->hdr);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+
+cleanup_tmp:
+    RCPR_MODEL_EXEMPT(memset(tmp, 0, sizeof(*tmp)));
+    release_retval = allocator_reclaim(alloc, tmp);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
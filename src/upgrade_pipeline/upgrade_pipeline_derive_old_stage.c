@@ -0,0 +1,73 @@
+/**
+ * \file upgrade_pipeline/upgrade_pipeline_derive_old_stage.c
+ *
+ * \brief The derive old stage of an \ref upgrade_pipeline.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "upgrade_pipeline_internal.h"
+
+/**
+ * \brief The derive old stage thread.
+ *
+ * \param context       The \ref upgrade_pipeline for this stage.
+ *
+ * \returns NULL.
+ */
+void*
+upgrade_pipeline_derive_old_stage(
+    void* context)
+{
+    status retval, release_retval;
+    upgrade_pipeline* pipeline = (upgrade_pipeline*)context;
+    const upgrade_pipeline_options* options = &pipeline->options;
+    upgrade_item* item;
+
+    while (upgrade_queue_pop(&pipeline->queues[0], &item))
+    {
+        /* derive the password in the old mode. */
+        if (!item->skip)
+        {
+            retval =
+                options->derive_old(
+                    options->context, &item->password, pipeline->alloc,
+                    item->old_record);
+            if (STATUS_SUCCESS != retval)
+            {
+                goto cleanup_item;
+            }
+        }
+
+        /* the queue is only aborted if the pipeline is stopping. */
+        if (!upgrade_queue_push(&pipeline->queues[1], item))
+        {
+            retval = upgrade_item_release(pipeline->alloc, item);
+            if (STATUS_SUCCESS != retval)
+            {
+                goto fail;
+            }
+
+            goto done;
+        }
+    }
+
+    upgrade_queue_close(&pipeline->queues[1]);
+    goto done;
+
+cleanup_item:
+    release_retval = upgrade_item_release(pipeline->alloc, item);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+fail:
+    upgrade_pipeline_fail(pipeline, retval);
+
+done:
+    upgrade_pipeline_stage_done(pipeline);
+
+    return NULL;
+}
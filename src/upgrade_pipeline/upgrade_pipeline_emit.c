@@ -0,0 +1,95 @@
+/**
+ * \file upgrade_pipeline/upgrade_pipeline_emit.c
+ *
+ * \brief Emit one upgraded record of an \ref upgrade_pipeline.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <rcpr/socket_utilities.h>
+#include <string.h>
+
+#include "upgrade_pipeline_internal.h"
+
+RCPR_IMPORT_resource;
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Frame the new record of an item and pass it to the emit callback.
+ *
+ * \param pipeline      The \ref upgrade_pipeline for this operation.
+ * \param item          The item to emit.
+ * \param next          The checkpoint after this item.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+upgrade_pipeline_emit(
+    upgrade_pipeline* pipeline, const upgrade_item* item,
+    const upgrade_checkpoint* next)
+{
+    status retval, release_retval;
+    secure_buffer* record = NULL;
+    secure_buffer* frame = NULL;
+    const void* record_data;
+    uint8_t* frame_data;
+    size_t record_size, frame_size, trailer_size = 0;
+
+    /* serialize the new record. */
+    retval = metadata_to_buffer(&record, pipeline->alloc, item->new_record);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    record_data = secure_buffer_data(&record_size, record);
+
+    /* frame it as a store image record. */
+    if (pipeline->options.store_flags & STORE_FLAG_CRC32C)
+    {
+        trailer_size = STORE_RECORD_TRAILER_SIZE;
+    }
+
+    retval =
+        secure_buffer_create(
+            &frame, pipeline->alloc,
+            STORE_RECORD_PREFIX_SIZE + record_size + trailer_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_record;
+    }
+
+    frame_data = (uint8_t*)secure_buffer_data(&frame_size, frame);
+    uint32_t net_record_size = socket_utility_hton32((uint32_t)record_size);
+    memcpy(frame_data, &net_record_size, sizeof(net_record_size));
+    memcpy(frame_data + STORE_RECORD_PREFIX_SIZE, record_data, record_size);
+    if (trailer_size > 0)
+    {
+        uint32_t net_crc =
+            socket_utility_hton32(store_crc32c(0, record_data, record_size));
+        memcpy(
+            frame_data + STORE_RECORD_PREFIX_SIZE + record_size, &net_crc,
+            sizeof(net_crc));
+    }
+
+    /* append it to the output. */
+    retval =
+        pipeline->options.emit(
+            pipeline->options.context, frame_data, frame_size, next);
+
+    release_retval = resource_release(secure_buffer_resource_handle(frame));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_record:
+    release_retval = resource_release(secure_buffer_resource_handle(record));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
@@ -0,0 +1,84 @@
+/**
+ * \file upgrade_pipeline/upgrade_pipeline_emit_stage.c
+ *
+ * \brief The emit stage of an \ref upgrade_pipeline.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "upgrade_pipeline_internal.h"
+
+/**
+ * \brief The emit stage thread.
+ *
+ * \param context       The \ref upgrade_pipeline for this stage.
+ *
+ * \note Items arrive in source order, so the checkpoint advances past every
+ * item as soon as it is emitted or skipped.
+ *
+ * \returns NULL.
+ */
+void*
+upgrade_pipeline_emit_stage(
+    void* context)
+{
+    status retval, release_retval;
+    upgrade_pipeline* pipeline = (upgrade_pipeline*)context;
+    upgrade_item* item;
+    upgrade_checkpoint next;
+
+    while (upgrade_queue_pop(&pipeline->queues[2], &item))
+    {
+        next.layer = item->position.layer;
+        next.index = item->position.index + 1;
+
+        /* serialize and append the new record. */
+        if (!item->skip)
+        {
+            retval = upgrade_pipeline_emit(pipeline, item, &next);
+            if (STATUS_SUCCESS != retval)
+            {
+                goto cleanup_item;
+            }
+
+            atomic_fetch_add_explicit(
+                &pipeline->upgraded, 1, memory_order_relaxed);
+        }
+
+        pthread_mutex_lock(&pipeline->state_lock);
+        pipeline->checkpoint = next;
+        pthread_mutex_unlock(&pipeline->state_lock);
+
+        retval = upgrade_item_release(pipeline->alloc, item);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto fail;
+        }
+    }
+
+    /* if every stage finished normally, every source record is complete. */
+    pthread_mutex_lock(&pipeline->state_lock);
+    if (!pipeline->canceled && STATUS_SUCCESS == pipeline->first_error)
+    {
+        pipeline->checkpoint.layer = pipeline->options.target_layer;
+        pipeline->checkpoint.index = 0;
+    }
+    pthread_mutex_unlock(&pipeline->state_lock);
+    goto done;
+
+cleanup_item:
+    release_retval = upgrade_item_release(pipeline->alloc, item);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+fail:
+    upgrade_pipeline_fail(pipeline, retval);
+
+done:
+    upgrade_pipeline_stage_done(pipeline);
+
+    return NULL;
+}
@@ -0,0 +1,34 @@
+/**
+ * \file upgrade_pipeline/upgrade_pipeline_fail.c
+ *
+ * \brief Stop an \ref upgrade_pipeline because of an error.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "upgrade_pipeline_internal.h"
+
+/**
+ * \brief Stop every stage of the pipeline because of an error.
+ *
+ * \param pipeline      The \ref upgrade_pipeline for this operation.
+ * \param error         The error status. Only the first error is kept.
+ */
+void
+upgrade_pipeline_fail(
+    upgrade_pipeline* pipeline, status error)
+{
+    pthread_mutex_lock(&pipeline->state_lock);
+    if (STATUS_SUCCESS == pipeline->first_error)
+    {
+        pipeline->first_error = error;
+    }
+    pthread_mutex_unlock(&pipeline->state_lock);
+
+    /* wake every stage so that it stops. */
+    for (size_t i = 0; i < pipeline->queues_initialized; ++i)
+    {
+        upgrade_queue_abort(&pipeline->queues[i]);
+    }
+}
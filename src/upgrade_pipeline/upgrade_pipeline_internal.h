@@ -0,0 +1,272 @@
+/**
+ * \file upgrade_pipeline/upgrade_pipeline_internal.h
+ *
+ * \brief Internal header for \ref upgrade_pipeline.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <nepe2/upgrade_pipeline.h>
+#include <pthread.h>
+#include <rcpr/resource/protected.h>
+#include <stdatomic.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief The default capacity of each queue between stages.
+ */
+#define UPGRADE_PIPELINE_DEFAULT_QUEUE_DEPTH                                64
+
+/**
+ * \brief The number of stages, and stage threads, in a pipeline.
+ */
+#define UPGRADE_PIPELINE_STAGE_COUNT                                         4
+
+/**
+ * \brief The number of queues between stages.
+ */
+#define UPGRADE_PIPELINE_QUEUE_COUNT    (UPGRADE_PIPELINE_STAGE_COUNT - 1)
+
+/**
+ * \brief A single source record moving through the pipeline.
+ *
+ * Records that don't need an upgrade still move through the pipeline, so that
+ * the emit stage can advance the checkpoint in source order.
+ */
+typedef struct upgrade_item upgrade_item;
+
+struct upgrade_item
+{
+    upgrade_checkpoint position;
+    bool skip;
+    const metadata* old_record;
+    secure_buffer* password;
+    metadata* new_record;
+};
+
+/**
+ * \brief A bounded, blocking, single-producer single-consumer queue of items.
+ */
+typedef struct upgrade_queue upgrade_queue;
+
+struct upgrade_queue
+{
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    size_t capacity;
+    size_t head;
+    size_t count;
+    bool closed;
+    bool aborted;
+    upgrade_item** items;
+};
+
+struct upgrade_pipeline
+{
+    RCPR_SYM(resource) hdr;
+    RCPR_MODEL_STRUCT_TAG(upgrade_pipeline);
+    RCPR_SYM(allocator)* alloc;
+    upgrade_pipeline_options options;
+    upgrade_queue queues[UPGRADE_PIPELINE_QUEUE_COUNT];
+    size_t queues_initialized;
+    pthread_t threads[UPGRADE_PIPELINE_STAGE_COUNT];
+    size_t threads_started;
+    bool joined;
+    _Atomic uint64_t scanned;
+    _Atomic uint64_t skipped;
+    _Atomic uint64_t upgraded;
+    /* everything below is protected by the state lock. */
+    pthread_mutex_t state_lock;
+    upgrade_checkpoint checkpoint;
+    size_t stages_running;
+    bool canceled;
+    status first_error;
+};
+
+/**
+ * \brief Release an \ref upgrade_pipeline resource.
+ *
+ * \param r             Pointer to the \ref upgrade_pipeline resource to be
+ *                      released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status upgrade_pipeline_resource_release(RCPR_SYM(resource)* r);
+
+/**
+ * \brief Stop every stage of the pipeline because of an error.
+ *
+ * \param pipeline      The \ref upgrade_pipeline for this operation.
+ * \param error         The error status. Only the first error is kept.
+ */
+void
+upgrade_pipeline_fail(
+    upgrade_pipeline* pipeline, status error);
+
+/**
+ * \brief Mark a stage as stopped.
+ *
+ * \param pipeline      The \ref upgrade_pipeline for this operation.
+ */
+void
+upgrade_pipeline_stage_done(
+    upgrade_pipeline* pipeline);
+
+/**
+ * \brief The lookup stage thread.
+ *
+ * \param context       The \ref upgrade_pipeline for this stage.
+ *
+ * \returns NULL.
+ */
+void*
+upgrade_pipeline_lookup_stage(
+    void* context);
+
+/**
+ * \brief The derive old stage thread.
+ *
+ * \param context       The \ref upgrade_pipeline for this stage.
+ *
+ * \returns NULL.
+ */
+void*
+upgrade_pipeline_derive_old_stage(
+    void* context);
+
+/**
+ * \brief The derive new stage thread.
+ *
+ * \param context       The \ref upgrade_pipeline for this stage.
+ *
+ * \returns NULL.
+ */
+void*
+upgrade_pipeline_derive_new_stage(
+    void* context);
+
+/**
+ * \brief The emit stage thread.
+ *
+ * \param context       The \ref upgrade_pipeline for this stage.
+ *
+ * \returns NULL.
+ */
+void*
+upgrade_pipeline_emit_stage(
+    void* context);
+
+/**
+ * \brief Release an item and everything it owns.
+ *
+ * \param alloc         The allocator for this item.
+ * \param item          The item to release.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+upgrade_item_release(
+    RCPR_SYM(allocator)* alloc, upgrade_item* item);
+
+/**
+ * \brief Initialize a queue.
+ *
+ * \param queue         The queue to initialize.
+ * \param alloc         The allocator for the queue storage.
+ * \param capacity      The capacity of the queue.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_UPGRADE_PIPELINE_SYNC_INIT_FAILED if a lock or condition
+ *        variable could not be created.
+ */
+status FN_DECL_MUST_CHECK
+upgrade_queue_init(
+    upgrade_queue* queue, RCPR_SYM(allocator)* alloc, size_t capacity);
+
+/**
+ * \brief Dispose of a queue, releasing any items left in it.
+ *
+ * \param queue         The queue to dispose.
+ * \param alloc         The allocator for the queue storage and items.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+upgrade_queue_dispose(
+    upgrade_queue* queue, RCPR_SYM(allocator)* alloc);
+
+/**
+ * \brief Push an item onto a queue, blocking while the queue is full.
+ *
+ * \param queue         The queue for this operation.
+ * \param item          The item to push.
+ *
+ * \returns true if the item was pushed, or false if the queue was aborted, in
+ * which case the caller still owns the item.
+ */
+bool
+upgrade_queue_push(
+    upgrade_queue* queue, upgrade_item* item);
+
+/**
+ * \brief Pop an item from a queue, blocking while the queue is empty.
+ *
+ * \param queue         The queue for this operation.
+ * \param item          Pointer to receive the item.
+ *
+ * \returns true if an item was popped, or false if the queue is closed and
+ * empty, or was aborted.
+ */
+bool
+upgrade_queue_pop(
+    upgrade_queue* queue, upgrade_item** item);
+
+/**
+ * \brief Close a queue. Consumers drain the remaining items.
+ *
+ * \param queue         The queue for this operation.
+ */
+void
+upgrade_queue_close(
+    upgrade_queue* queue);
+
+/**
+ * \brief Abort a queue. Blocked producers and consumers return immediately.
+ *
+ * \param queue         The queue for this operation.
+ */
+void
+upgrade_queue_abort(
+    upgrade_queue* queue);
+
+/**
+ * \brief Frame the new record of an item and pass it to the emit callback.
+ *
+ * \param pipeline      The \ref upgrade_pipeline for this operation.
+ * \param item          The item to emit.
+ * \param next          The checkpoint after this item.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+upgrade_pipeline_emit(
+    upgrade_pipeline* pipeline, const upgrade_item* item,
+    const upgrade_checkpoint* next);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
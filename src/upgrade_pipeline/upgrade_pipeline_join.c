@@ -0,0 +1,57 @@
+/**
+ * \file upgrade_pipeline/upgrade_pipeline_join.c
+ *
+ * \brief Wait for an \ref upgrade_pipeline to stop.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+
+#include "upgrade_pipeline_internal.h"
+
+/**
+ * \brief Wait for every stage of an \ref upgrade_pipeline to stop.
+ *
+ * \param pipeline      The \ref upgrade_pipeline instance for this operation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS if every record was upgraded.
+ *      - ERROR_UPGRADE_PIPELINE_CANCELED if the pipeline was canceled.
+ *      - the first error returned by a stage or callback otherwise.
+ */
+status FN_DECL_MUST_CHECK
+upgrade_pipeline_join(
+    upgrade_pipeline* pipeline)
+{
+    status retval;
+
+    /* join each stage thread once. */
+    if (!pipeline->joined)
+    {
+        for (size_t i = 0; i < pipeline->threads_started; ++i)
+        {
+            pthread_join(pipeline->threads[i], NULL);
+        }
+
+        pipeline->joined = true;
+    }
+
+    pthread_mutex_lock(&pipeline->state_lock);
+    if (STATUS_SUCCESS != pipeline->first_error)
+    {
+        retval = pipeline->first_error;
+    }
+    else if (pipeline->canceled)
+    {
+        retval = ERROR_UPGRADE_PIPELINE_CANCELED;
+    }
+    else
+    {
+        retval = STATUS_SUCCESS;
+    }
+    pthread_mutex_unlock(&pipeline->state_lock);
+
+    return retval;
+}
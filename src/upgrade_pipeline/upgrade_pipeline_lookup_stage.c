@@ -0,0 +1,117 @@
+/**
+ * \file upgrade_pipeline/upgrade_pipeline_lookup_stage.c
+ *
+ * \brief The lookup stage of an \ref upgrade_pipeline.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "upgrade_pipeline_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief The lookup stage thread.
+ *
+ * \param context       The \ref upgrade_pipeline for this stage.
+ *
+ * \note A source record is upgraded only if it is the record that the view
+ * resolves its hash id to. Older generations, and hash ids answered by a newer
+ * layer, are skipped.
+ *
+ * \returns NULL.
+ */
+void*
+upgrade_pipeline_lookup_stage(
+    void* context)
+{
+    status retval, release_retval;
+    upgrade_pipeline* pipeline = (upgrade_pipeline*)context;
+    const upgrade_pipeline_options* options = &pipeline->options;
+    upgrade_item* item;
+    const store* layer;
+    const metadata* answer;
+    size_t answer_layer;
+    const void* hash_id;
+    size_t hash_id_size;
+
+    for (size_t l = options->start.layer; l < options->target_layer; ++l)
+    {
+        layer = migration_view_layer_get(options->view, l);
+        size_t count = store_record_count_get(layer);
+        size_t i = (l == options->start.layer) ? options->start.index : 0;
+
+        for (; i < count; ++i)
+        {
+            retval =
+                allocator_allocate(
+                    pipeline->alloc, (void**)&item, sizeof(*item));
+            if (STATUS_SUCCESS != retval)
+            {
+                goto fail;
+            }
+
+            RCPR_MODEL_EXEMPT(memset(item, 0, sizeof(*item)));
+            item->position.layer = l;
+            item->position.index = i;
+            item->old_record = store_record_get(layer, i);
+
+            retval =
+                metadata_hash_id_get(&hash_id, &hash_id_size, item->old_record);
+            if (STATUS_SUCCESS != retval)
+            {
+                goto cleanup_item;
+            }
+
+            /* only the record that still answers for its hash id moves. */
+            item->skip =
+                STATUS_SUCCESS
+                    != migration_view_lookup(
+                            &answer, &answer_layer, options->view, hash_id,
+                            hash_id_size)
+                || answer_layer != l
+                || answer != item->old_record;
+
+            atomic_fetch_add_explicit(
+                &pipeline->scanned, 1, memory_order_relaxed);
+            if (item->skip)
+            {
+                atomic_fetch_add_explicit(
+                    &pipeline->skipped, 1, memory_order_relaxed);
+            }
+
+            /* the queue is only aborted if the pipeline is stopping. */
+            if (!upgrade_queue_push(&pipeline->queues[0], item))
+            {
+                retval = upgrade_item_release(pipeline->alloc, item);
+                if (STATUS_SUCCESS != retval)
+                {
+                    goto fail;
+                }
+
+                goto done;
+            }
+        }
+    }
+
+    upgrade_queue_close(&pipeline->queues[0]);
+    goto done;
+
+cleanup_item:
+    release_retval = upgrade_item_release(pipeline->alloc, item);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+fail:
+    upgrade_pipeline_fail(pipeline, retval);
+
+done:
+    upgrade_pipeline_stage_done(pipeline);
+
+    return NULL;
+}
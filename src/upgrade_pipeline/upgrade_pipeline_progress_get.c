@@ -0,0 +1,35 @@
+/**
+ * \file upgrade_pipeline/upgrade_pipeline_progress_get.c
+ *
+ * \brief Get the progress of an \ref upgrade_pipeline.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "upgrade_pipeline_internal.h"
+
+/**
+ * \brief Get the progress of an \ref upgrade_pipeline.
+ *
+ * \param progress      Pointer to receive the progress.
+ * \param pipeline      The \ref upgrade_pipeline instance for this operation.
+ *
+ * \note This can be called from any thread while the pipeline runs.
+ */
+void
+upgrade_pipeline_progress_get(
+    upgrade_progress* progress, upgrade_pipeline* pipeline)
+{
+    progress->scanned =
+        atomic_load_explicit(&pipeline->scanned, memory_order_relaxed);
+    progress->skipped =
+        atomic_load_explicit(&pipeline->skipped, memory_order_relaxed);
+    progress->upgraded =
+        atomic_load_explicit(&pipeline->upgraded, memory_order_relaxed);
+
+    pthread_mutex_lock(&pipeline->state_lock);
+    progress->checkpoint = pipeline->checkpoint;
+    progress->done = (0 == pipeline->stages_running);
+    pthread_mutex_unlock(&pipeline->state_lock);
+}
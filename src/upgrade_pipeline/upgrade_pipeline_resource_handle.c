@@ -0,0 +1,26 @@
+/**
+ * \file upgrade_pipeline/upgrade_pipeline_resource_handle.c
+ *
+ * \brief Get the resource handle for the upgrade pipeline.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "upgrade_pipeline_internal.h"
+
+/**
+ * \brief Given an \ref upgrade_pipeline instance, return the resource handle
+ * for this \ref upgrade_pipeline instance.
+ *
+ * \param pipeline      The \ref upgrade_pipeline instance from which the
+ *                      resource handle is returned.
+ *
+ * \returns the resource handle for this \ref upgrade_pipeline instance.
+ */
+RCPR_SYM(resource)*
+upgrade_pipeline_resource_handle(
+    upgrade_pipeline* pipeline)
+{
+    return &pipeline->hdr;
+}
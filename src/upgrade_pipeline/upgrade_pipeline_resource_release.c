@@ -0,0 +1,78 @@
+/**
+ * \file upgrade_pipeline/upgrade_pipeline_resource_release.c
+ *
+ * \brief Release an \ref upgrade_pipeline resource.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <string.h>
+
+#include "upgrade_pipeline_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Release an \ref upgrade_pipeline resource.
+ *
+ * \param r             Pointer to the \ref upgrade_pipeline resource to be
+ *                      released.
+ *
+ * \note A running pipeline is canceled and joined first.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status upgrade_pipeline_resource_release(RCPR_SYM(resource)* r)
+{
+    status retval = STATUS_SUCCESS;
+    status release_retval;
+
+    upgrade_pipeline* pipeline = (upgrade_pipeline*)r;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_upgrade_pipeline_valid(pipeline));
+
+    /* cache allocator. */
+    allocator* alloc = pipeline->alloc;
+
+    /* stop every stage. Canceling a finished pipeline has no effect. */
+    if (!pipeline->joined)
+    {
+        upgrade_pipeline_cancel(pipeline);
+
+        release_retval = upgrade_pipeline_join(pipeline);
+        if (STATUS_SUCCESS != release_retval
+         && ERROR_UPGRADE_PIPELINE_CANCELED != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    /* release the queues, and any items left in them. */
+    for (size_t i = 0; i < pipeline->queues_initialized; ++i)
+    {
+        release_retval = upgrade_queue_dispose(&pipeline->queues[i], alloc);
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    pthread_mutex_destroy(&pipeline->state_lock);
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(pipeline, 0, sizeof(*pipeline)));
+
+    /* reclaim memory. */
+    release_retval = allocator_reclaim(alloc, pipeline);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
@@ -0,0 +1,24 @@
+/**
+ * \file upgrade_pipeline/upgrade_pipeline_stage_done.c
+ *
+ * \brief Mark a stage of an \ref upgrade_pipeline as stopped.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "upgrade_pipeline_internal.h"
+
+/**
+ * \brief Mark a stage as stopped.
+ *
+ * \param pipeline      The \ref upgrade_pipeline for this operation.
+ */
+void
+upgrade_pipeline_stage_done(
+    upgrade_pipeline* pipeline)
+{
+    pthread_mutex_lock(&pipeline->state_lock);
+    --pipeline->stages_running;
+    pthread_mutex_unlock(&pipeline->state_lock);
+}
@@ -0,0 +1,26 @@
+/**
+ * \file upgrade_pipeline/upgrade_queue_abort.c
+ *
+ * \brief Abort a bounded queue between pipeline stages.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "upgrade_pipeline_internal.h"
+
+/**
+ * \brief Abort a queue. Blocked producers and consumers return immediately.
+ *
+ * \param queue         The queue for this operation.
+ */
+void
+upgrade_queue_abort(
+    upgrade_queue* queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    queue->aborted = true;
+    pthread_cond_broadcast(&queue->not_empty);
+    pthread_cond_broadcast(&queue->not_full);
+    pthread_mutex_unlock(&queue->lock);
+}
@@ -0,0 +1,25 @@
+/**
+ * \file upgrade_pipeline/upgrade_queue_close.c
+ *
+ * \brief Close a bounded queue between pipeline stages.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "upgrade_pipeline_internal.h"
+
+/**
+ * \brief Close a queue. Consumers drain the remaining items.
+ *
+ * \param queue         The queue for this operation.
+ */
+void
+upgrade_queue_close(
+    upgrade_queue* queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    queue->closed = true;
+    pthread_cond_broadcast(&queue->not_empty);
+    pthread_mutex_unlock(&queue->lock);
+}
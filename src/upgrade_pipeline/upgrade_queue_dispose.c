@@ -0,0 +1,56 @@
+/**
+ * \file upgrade_pipeline/upgrade_queue_dispose.c
+ *
+ * \brief Dispose of a bounded queue between pipeline stages.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "upgrade_pipeline_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Dispose of a queue, releasing any items left in it.
+ *
+ * \param queue         The queue to dispose.
+ * \param alloc         The allocator for the queue storage and items.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+upgrade_queue_dispose(
+    upgrade_queue* queue, RCPR_SYM(allocator)* alloc)
+{
+    status retval = STATUS_SUCCESS;
+    status release_retval;
+
+    /* release the items left behind by a canceled pipeline. */
+    for (size_t i = 0; i < queue->count; ++i)
+    {
+        release_retval =
+            upgrade_item_release(
+                alloc, queue->items[(queue->head + i) % queue->capacity]);
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    pthread_cond_destroy(&queue->not_full);
+    pthread_cond_destroy(&queue->not_empty);
+    pthread_mutex_destroy(&queue->lock);
+
+    release_retval = allocator_reclaim(alloc, queue->items);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    RCPR_MODEL_EXEMPT(memset(queue, 0, sizeof(*queue)));
+
+    return retval;
+}
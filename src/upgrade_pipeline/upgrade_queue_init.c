@@ -0,0 +1,83 @@
+/**
+ * \file upgrade_pipeline/upgrade_queue_init.c
+ *
+ * \brief Initialize a bounded queue between pipeline stages.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <string.h>
+
+#include "upgrade_pipeline_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Initialize a queue.
+ *
+ * \param queue         The queue to initialize.
+ * \param alloc         The allocator for the queue storage.
+ * \param capacity      The capacity of the queue.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_UPGRADE_PIPELINE_SYNC_INIT_FAILED if a lock or condition
+ *        variable could not be created.
+ */
+status FN_DECL_MUST_CHECK
+upgrade_queue_init(
+    upgrade_queue* queue, RCPR_SYM(allocator)* alloc, size_t capacity)
+{
+    status retval, release_retval;
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(queue, 0, sizeof(*queue)));
+    queue->capacity = capacity;
+
+    /* allocate the ring. */
+    retval =
+        allocator_allocate(
+            alloc, (void**)&queue->items, capacity * sizeof(*queue->items));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* create the lock and condition variables. */
+    retval = ERROR_UPGRADE_PIPELINE_SYNC_INIT_FAILED;
+    if (0 != pthread_mutex_init(&queue->lock, NULL))
+    {
+        goto cleanup_items;
+    }
+
+    if (0 != pthread_cond_init(&queue->not_empty, NULL))
+    {
+        goto cleanup_lock;
+    }
+
+    if (0 != pthread_cond_init(&queue->not_full, NULL))
+    {
+        goto cleanup_not_empty;
+    }
+
+    return STATUS_SUCCESS;
+
+cleanup_not_empty:
+    pthread_cond_destroy(&queue->not_empty);
+
+cleanup_lock:
+    pthread_mutex_destroy(&queue->lock);
+
+cleanup_items:
+    release_retval = allocator_reclaim(alloc, queue->items);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
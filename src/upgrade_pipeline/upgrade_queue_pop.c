@@ -0,0 +1,47 @@
+/**
+ * \file upgrade_pipeline/upgrade_queue_pop.c
+ *
+ * \brief Pop an item from a bounded queue between pipeline stages.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "upgrade_pipeline_internal.h"
+
+/**
+ * \brief Pop an item from a queue, blocking while the queue is empty.
+ *
+ * \param queue         The queue for this operation.
+ * \param item          Pointer to receive the item.
+ *
+ * \returns true if an item was popped, or false if the queue is closed and
+ * empty, or was aborted.
+ */
+bool
+upgrade_queue_pop(
+    upgrade_queue* queue, upgrade_item** item)
+{
+    bool popped = false;
+
+    pthread_mutex_lock(&queue->lock);
+
+    while (0 == queue->count && !queue->closed && !queue->aborted)
+    {
+        pthread_cond_wait(&queue->not_empty, &queue->lock);
+    }
+
+    /* items left in an aborted queue are released when it is disposed. */
+    if (!queue->aborted && queue->count > 0)
+    {
+        *item = queue->items[queue->head];
+        queue->head = (queue->head + 1) % queue->capacity;
+        --queue->count;
+        popped = true;
+        pthread_cond_signal(&queue->not_full);
+    }
+
+    pthread_mutex_unlock(&queue->lock);
+
+    return popped;
+}
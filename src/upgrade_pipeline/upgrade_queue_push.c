@@ -0,0 +1,46 @@
+/**
+ * \file upgrade_pipeline/upgrade_queue_push.c
+ *
+ * \brief Push an item onto a bounded queue between pipeline stages.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "upgrade_pipeline_internal.h"
+
+/**
+ * \brief Push an item onto a queue, blocking while the queue is full.
+ *
+ * \param queue         The queue for this operation.
+ * \param item          The item to push.
+ *
+ * \returns true if the item was pushed, or false if the queue was aborted, in
+ * which case the caller still owns the item.
+ */
+bool
+upgrade_queue_push(
+    upgrade_queue* queue, upgrade_item* item)
+{
+    bool pushed = false;
+
+    pthread_mutex_lock(&queue->lock);
+
+    /* a full queue applies back pressure to the producer. */
+    while (queue->count == queue->capacity && !queue->aborted)
+    {
+        pthread_cond_wait(&queue->not_full, &queue->lock);
+    }
+
+    if (!queue->aborted)
+    {
+        queue->items[(queue->head + queue->count) % queue->capacity] = item;
+        ++queue->count;
+        pushed = true;
+        pthread_cond_signal(&queue->not_empty);
+    }
+
+    pthread_mutex_unlock(&queue->lock);
+
+    return pushed;
+}
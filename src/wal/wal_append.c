@@ -0,0 +1,95 @@
+/**
+ * \file wal/wal_append.c
+ *
+ * \brief Append records to a \ref wal.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <string.h>
+
+#include "wal_internal.h"
+
+/**
+ * \brief Append records to a \ref wal, and wait until they are durable.
+ *
+ * \param w             The \ref wal for this operation.
+ * \param records       The records to append.
+ * \param count         The number of records.
+ *
+ * \note This may be called from any number of threads at once. The records
+ * join the pending group, and this thread then either leads the commit of that
+ * group or waits for another writer to commit it.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_WAL_FAILED if this or an earlier commit failed.
+ */
+status FN_DECL_MUST_CHECK
+wal_append(
+    wal* w, const metadata* const* records, size_t count)
+{
+    status retval;
+    uint64_t group_id;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_wal_valid(w));
+    RCPR_MODEL_ASSERT(NULL != records || 0 == count);
+
+    pthread_mutex_lock(&w->lock);
+
+    if (w->failed)
+    {
+        retval = ERROR_WAL_FAILED;
+        goto unlock;
+    }
+
+    if (0 == count)
+    {
+        retval = STATUS_SUCCESS;
+        goto unlock;
+    }
+
+    /* join the pending group. */
+    retval = wal_pending_reserve(w, count);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto unlock;
+    }
+
+    memcpy(w->pending + w->pending_count, records, count * sizeof(*records));
+    w->pending_count += count;
+    group_id = w->next_group;
+
+    /* lead a commit whenever none is in progress, until this group is done. */
+    for (;;)
+    {
+        if (w->durable_group >= group_id)
+        {
+            retval = STATUS_SUCCESS;
+            break;
+        }
+        else if (w->failed)
+        {
+            retval = ERROR_WAL_FAILED;
+            break;
+        }
+        else if (!w->busy)
+        {
+            wal_commit(w);
+        }
+        else
+        {
+            pthread_cond_wait(&w->cond, &w->lock);
+        }
+    }
+
+unlock:
+    pthread_mutex_unlock(&w->lock);
+
+    return retval;
+}
@@ -0,0 +1,66 @@
+/**
+ * \file wal/wal_checkpoint.c
+ *
+ * \brief Apply the log of a \ref wal to its target.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+
+#include "wal_internal.h"
+
+/**
+ * \brief Apply every committed record in a \ref wal to its target, and empty
+ * the log.
+ *
+ * \param w             The \ref wal for this operation.
+ *
+ * \note The checkpoint holds off commits, rather than the lock, while it runs,
+ * so appends can still join the pending group in the meantime.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_WAL_FAILED if an earlier commit failed.
+ *      - ERROR_WAL_CORRUPT if a record before the end of the log is damaged.
+ *      - an error from \ref store_file_append or \ref store_file_truncate if
+ *        the log could not be applied.
+ */
+status FN_DECL_MUST_CHECK
+wal_checkpoint(
+    wal* w)
+{
+    status retval;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_wal_valid(w));
+
+    /* wait for the commit in progress, and hold off the next one. */
+    pthread_mutex_lock(&w->lock);
+    while (w->busy)
+    {
+        pthread_cond_wait(&w->cond, &w->lock);
+    }
+
+    if (w->failed)
+    {
+        pthread_mutex_unlock(&w->lock);
+        return ERROR_WAL_FAILED;
+    }
+
+    w->busy = true;
+    pthread_mutex_unlock(&w->lock);
+
+    retval = wal_replay(w);
+
+    /* let the next group commit. */
+    pthread_mutex_lock(&w->lock);
+    w->busy = false;
+    pthread_cond_broadcast(&w->cond);
+    pthread_mutex_unlock(&w->lock);
+
+    return retval;
+}
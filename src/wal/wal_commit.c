@@ -0,0 +1,87 @@
+/**
+ * \file wal/wal_commit.c
+ *
+ * \brief Commit the pending group of a \ref wal.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <errno.h>
+#include <time.h>
+
+#include "wal_internal.h"
+
+/**
+ * \brief Commit the pending group as its leader.
+ *
+ * \param w             The \ref wal for this operation.
+ *
+ * \note This must be called with the lock held and no commit or checkpoint in
+ * progress. The lock is released while waiting for other writers to join, and
+ * while writing, and is held again on return. Every waiting writer is woken
+ * once the commit finishes.
+ */
+void
+wal_commit(
+    wal* w)
+{
+    status retval;
+    struct timespec deadline;
+    const metadata** group;
+    size_t count;
+    uint64_t group_id;
+
+    RCPR_MODEL_ASSERT(!w->busy);
+
+    w->busy = true;
+
+    /* give other writers a chance to join this group. */
+    if (w->max_delay_us > 0)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += w->max_delay_us / 1000000;
+        deadline.tv_nsec += (long)(w->max_delay_us % 1000000) * 1000;
+        if (deadline.tv_nsec >= 1000000000)
+        {
+            deadline.tv_sec += 1;
+            deadline.tv_nsec -= 1000000000;
+        }
+
+        while (ETIMEDOUT
+                != pthread_cond_timedwait(&w->cond, &w->lock, &deadline))
+        {
+        }
+    }
+
+    /* take the group, so that new writers start the next one. */
+    group = w->pending;
+    count = w->pending_count;
+    group_id = w->next_group++;
+
+    w->pending = w->committing;
+    w->committing = group;
+    w->pending_count = 0;
+
+    size_t capacity = w->pending_capacity;
+    w->pending_capacity = w->committing_capacity;
+    w->committing_capacity = capacity;
+
+    /* write and sync the whole group with the lock released. */
+    pthread_mutex_unlock(&w->lock);
+    retval = store_file_append(w->log, group, count, true);
+    pthread_mutex_lock(&w->lock);
+
+    if (STATUS_SUCCESS == retval)
+    {
+        w->durable_group = group_id;
+        ++w->commit_count;
+    }
+    else
+    {
+        w->failed = true;
+    }
+
+    w->busy = false;
+    pthread_cond_broadcast(&w->cond);
+}
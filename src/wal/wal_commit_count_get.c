@@ -0,0 +1,32 @@
+/**
+ * \file wal/wal_commit_count_get.c
+ *
+ * \brief Get the number of commits of a \ref wal.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "wal_internal.h"
+
+/**
+ * \brief Get the number of commits, each of which is one data sync of the log.
+ *
+ * \param w             The \ref wal instance for this operation.
+ *
+ * \returns the number of commits since this log was opened.
+ */
+uint64_t
+wal_commit_count_get(
+    wal* w)
+{
+    uint64_t count;
+
+    RCPR_MODEL_ASSERT(prop_wal_valid(w));
+
+    pthread_mutex_lock(&w->lock);
+    count = w->commit_count;
+    pthread_mutex_unlock(&w->lock);
+
+    return count;
+}
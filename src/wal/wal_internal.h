@@ -0,0 +1,164 @@
+/**
+ * \file wal/wal_internal.h
+ *
+ * \brief Internal header for \ref wal.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <nepe2/wal.h>
+#include <pthread.h>
+#include <rcpr/resource/protected.h>
+#include <stdbool.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief The initial capacity of each record queue.
+ */
+#define WAL_QUEUE_INITIAL_CAPACITY                                          64
+
+/**
+ * \brief The number of log records decoded and applied at a time during a
+ * replay.
+ */
+#define WAL_REPLAY_CHUNK                                                    64
+
+struct wal
+{
+    RCPR_SYM(resource) hdr;
+    RCPR_MODEL_STRUCT_TAG(wal);
+    RCPR_SYM(allocator)* alloc;
+    store_file* target;
+    store_file* log;
+    uint32_t max_delay_us;
+
+    /* everything below is protected by lock. */
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    const metadata** pending;
+    size_t pending_count;
+    size_t pending_capacity;
+    const metadata** committing;
+    size_t committing_capacity;
+    uint64_t next_group;
+    uint64_t durable_group;
+    uint64_t commit_count;
+    bool busy;
+    bool failed;
+};
+
+/**
+ * \brief Release a \ref wal resource.
+ *
+ * \param r             Pointer to the \ref wal resource to be released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status wal_resource_release(RCPR_SYM(resource)* r);
+
+/**
+ * \brief Make room for the given number of records in the pending queue.
+ *
+ * \param w             The \ref wal for this operation, whose lock is held.
+ * \param count         The number of records to make room for.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ */
+status FN_DECL_MUST_CHECK
+wal_pending_reserve(
+    wal* w, size_t count);
+
+/**
+ * \brief Commit the pending group as its leader.
+ *
+ * \param w             The \ref wal for this operation.
+ *
+ * \note This must be called with the lock held and no commit or checkpoint in
+ * progress. The lock is released while waiting for other writers to join, and
+ * while writing, and is held again on return. Every waiting writer is woken
+ * once the commit finishes.
+ */
+void
+wal_commit(
+    wal* w);
+
+/**
+ * \brief Apply every complete record in the log to the target, sync the
+ * target, and empty the log.
+ *
+ * \param w             The \ref wal for this operation.
+ *
+ * \note This must be called without the lock held, while no commit is in
+ * progress. An incomplete or invalid record at the end of the log is the torn
+ * tail of an unacknowledged commit and is dropped, but a damaged record with
+ * more of the log after it fails the replay, and leaves the log and the target
+ * as they were. A replay is not idempotent: if the process stops before the
+ * log is emptied, the next replay applies the log again, and the target holds
+ * identical copies of those records.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_WAL_CORRUPT if a record before the end of the log is damaged.
+ *      - an error from \ref store_file_append or \ref store_file_truncate if
+ *        the log could not be applied.
+ */
+status FN_DECL_MUST_CHECK
+wal_replay(
+    wal* w);
+
+/**
+ * \brief Append a chunk of decoded records to the target, and release them.
+ *
+ * \param w             The \ref wal for this operation.
+ * \param records       The decoded records.
+ * \param count         Pointer to the number of decoded records, which is
+ *                      reset to zero.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+wal_replay_chunk(
+    wal* w, metadata** records, size_t* count);
+
+/**
+ * \brief Find the end of the records in a log image that can be replayed.
+ *
+ * \param end           Pointer to receive the offset just past the last record
+ *                      to replay.
+ * \param data          The log image.
+ * \param size          The size of the log image.
+ * \param trailer_size  The size of the checksum after each record, or zero if
+ *                      the log is not checksummed.
+ *
+ * \note Each record is checked for its framing, its checksum, and its header,
+ * without being decoded. The scan stops at the first record that fails. If
+ * that record runs to the end of the image, or is followed only by zeroes, it
+ * is the torn tail of an unacknowledged commit and is dropped. Otherwise, a
+ * committed record was damaged, and nothing may be replayed.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_WAL_CORRUPT if a damaged record is followed by more of the log.
+ */
+status FN_DECL_MUST_CHECK
+wal_replay_scan(
+    size_t* end, const uint8_t* data, size_t size, size_t trailer_size);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
@@ -0,0 +1,182 @@
+/**
+ * \file wal/wal_open.c
+ *
+ * \brief Open a \ref wal.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <string.h>
+#include <time.h>
+
+#include "wal_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Open a write-ahead log, replaying any records in it into the target.
+ *
+ * \param w             Pointer to the log pointer to receive the log on
+ *                      success.
+ * \param alloc         The allocator instance to use for this operation, which
+ *                      must be thread-safe.
+ * \param path          The path of the log, which is created if it does not
+ *                      exist.
+ * \param target        The \ref store_file that the log is applied to.
+ * \param flags         Zero or more STORE_FILE_FLAG_ values for the log.
+ * \param max_delay_us  The longest time, in microseconds, that a commit waits
+ *                      for other writers to join it. Zero commits as soon as
+ *                      the previous commit finishes.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_WAL_SYNC_INIT_FAILED if the commit lock could not be created.
+ *      - an error from \ref store_file_open if the log could not be opened.
+ *      - ERROR_WAL_CORRUPT if a record before the end of the log is damaged.
+ *      - an error from \ref store_file_append or \ref store_file_truncate if
+ *        the log could not be replayed.
+ */
+status FN_DECL_MUST_CHECK
+wal_open(
+    wal** w, RCPR_SYM(allocator)* alloc, const char* path, store_file* target,
+    uint32_t flags, uint32_t max_delay_us)
+{
+    status retval, release_retval;
+    wal* tmp = NULL;
+    pthread_condattr_t attr;
+    size_t queue_size = WAL_QUEUE_INITIAL_CAPACITY * sizeof(metadata*);
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(NULL != w);
+    RCPR_MODEL_ASSERT(prop_allocator_valid(alloc));
+    RCPR_MODEL_ASSERT(NULL != path);
+    RCPR_MODEL_ASSERT(prop_store_file_valid(target));
+
+    /* allocate memory for the log instance. */
+    retval = allocator_allocate(alloc, (void**)&tmp, sizeof(*tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(tmp, 0, sizeof(*tmp)));
+
+    /* the tag is not set by default. */
+    RCPR_MODEL_ONLY(tmp->RCPR_MODEL_STRUCT_TAG_REF(wal) = 0);
+    RCPR_MODEL_ASSERT_STRUCT_TAG_NOT_INITIALIZED(
+        tmp->RCPR_MODEL_STRUCT_TAG_REF(wal), wal);
+
+    /* set the tag. */
+    RCPR_MODEL_STRUCT_TAG_INIT(tmp->RCPR_MODEL_STRUCT_TAG_REF(wal), wal);
+
+    /* initialize resource. */
+    resource_init(&tmp->hdr, &wal_resource_release);
+    tmp->alloc = alloc;
+    tmp->target = target;
+    tmp->max_delay_us = max_delay_us;
+    tmp->next_group = 1;
+
+    /* open the log. */
+    retval =
+        store_file_open(
+            &tmp->log, alloc, path, STORE_FILE_FLAG_CREATE | flags);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    /* allocate the record queues. */
+    retval = allocator_allocate(alloc, (void**)&tmp->pending, queue_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_log;
+    }
+
+    retval = allocator_allocate(alloc, (void**)&tmp->committing, queue_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_pending;
+    }
+
+    tmp->pending_capacity = WAL_QUEUE_INITIAL_CAPACITY;
+    tmp->committing_capacity = WAL_QUEUE_INITIAL_CAPACITY;
+
+    /* create the commit lock, whose condition waits on the monotonic clock. */
+    if (0 != pthread_mutex_init(&tmp->lock, NULL))
+    {
+        retval = ERROR_WAL_SYNC_INIT_FAILED;
+        goto cleanup_committing;
+    }
+
+    if (0 != pthread_condattr_init(&attr))
+    {
+        retval = ERROR_WAL_SYNC_INIT_FAILED;
+        goto cleanup_lock;
+    }
+
+    if (0 != pthread_condattr_setclock(&attr, CLOCK_MONOTONIC)
+     || 0 != pthread_cond_init(&tmp->cond, &attr))
+    {
+        pthread_condattr_destroy(&attr);
+        retval = ERROR_WAL_SYNC_INIT_FAILED;
+        goto cleanup_lock;
+    }
+
+    pthread_condattr_destroy(&attr);
+
+    /* apply anything left in the log by a previous process. */
+    retval = wal_replay(tmp);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_cond;
+    }
+
+    /* success. */
+    *w = tmp;
+    retval = STATUS_SUCCESS;
+    goto done;
+
+cleanup_cond:
+    pthread_cond_destroy(&tmp->cond);
+
+cleanup_lock:
+    pthread_mutex_destroy(&tmp->lock);
+
+cleanup_committing:
+    release_retval = allocator_reclaim(alloc, tmp->committing);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_pending:
+    release_retval = allocator_reclaim(alloc, tmp->pending);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_log:
+    release_retval = resource_release(store_file_resource_handle(tmp->log));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_tmp:
+    RCPR_MODEL_EXEMPT(memset(tmp, 0, sizeof(*tmp)));
+    release_retval = allocator_reclaim(alloc, tmp);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
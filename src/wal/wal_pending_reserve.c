@@ -0,0 +1,65 @@
+/**
+ * \file wal/wal_pending_reserve.c
+ *
+ * \brief Make room in the pending queue of a \ref wal.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <string.h>
+
+#include "wal_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Make room for the given number of records in the pending queue.
+ *
+ * \param w             The \ref wal for this operation, whose lock is held.
+ * \param count         The number of records to make room for.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ */
+status FN_DECL_MUST_CHECK
+wal_pending_reserve(
+    wal* w, size_t count)
+{
+    status retval;
+    const metadata** queue;
+    size_t capacity = w->pending_capacity;
+
+    if (count <= capacity - w->pending_count)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    while (count > capacity - w->pending_count)
+    {
+        if (capacity > SIZE_MAX / (2 * sizeof(*queue)))
+        {
+            return ERROR_GENERAL_OUT_OF_MEMORY;
+        }
+
+        capacity *= 2;
+    }
+
+    retval =
+        allocator_allocate(w->alloc, (void**)&queue, capacity * sizeof(*queue));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    memcpy(queue, w->pending, w->pending_count * sizeof(*queue));
+
+    retval = allocator_reclaim(w->alloc, w->pending);
+    w->pending = queue;
+    w->pending_capacity = capacity;
+
+    return retval;
+}
@@ -0,0 +1,145 @@
+/**
+ * \file wal/wal_replay.c
+ *
+ * \brief Apply the log of a \ref wal to its target.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <rcpr/socket_utilities.h>
+#include <string.h>
+
+#include "wal_internal.h"
+
+RCPR_IMPORT_resource;
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Apply every complete record in the log to the target, sync the
+ * target, and empty the log.
+ *
+ * \param w             The \ref wal for this operation.
+ *
+ * \note This must be called without the lock held, while no commit is in
+ * progress. The log is checked with \ref wal_replay_scan before anything is
+ * applied: an incomplete or invalid record at the end of the log is the torn
+ * tail of an unacknowledged commit and is dropped, but a damaged record with
+ * more of the log after it fails the replay, and leaves the log and the target
+ * as they were. If the log has \ref STORE_FLAG_CRC32C set, a record that does
+ * not match its checksum is damaged. Records are then decoded and applied a
+ * chunk at a time, so a large log never needs more than one chunk of decoded
+ * records.
+ *
+ * A replay is not idempotent. If the process stops after some of the log has
+ * been applied but before the log is emptied, the next replay applies the log
+ * again, and the target holds those records twice. The copies are identical,
+ * so a lookup finds the same record either way, and a compaction keeps one.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if this method failed due to an
+ *        out-of-memory condition.
+ *      - ERROR_WAL_CORRUPT if a record before the end of the log is damaged.
+ *      - an error from \ref store_file_append or \ref store_file_truncate if
+ *        the log could not be applied.
+ */
+status FN_DECL_MUST_CHECK
+wal_replay(
+    wal* w)
+{
+    status retval, release_retval;
+    secure_buffer* image = NULL;
+    metadata* records[WAL_REPLAY_CHUNK];
+    const uint8_t* data;
+    size_t size, offset, end, count = 0;
+    size_t trailer_size = 0;
+    uint32_t record_size;
+
+    /* an empty log has nothing to apply. */
+    if (STORE_HEADER_SIZE == store_file_size_get(w->log))
+    {
+        return STATUS_SUCCESS;
+    }
+
+    retval = store_file_image_read(&image, w->alloc, w->log);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    data = (const uint8_t*)secure_buffer_data(&size, image);
+    if (store_file_header_flags_get(w->log) & STORE_FLAG_CRC32C)
+    {
+        trailer_size = STORE_RECORD_TRAILER_SIZE;
+    }
+
+    /* find the records to apply, before applying any of them. */
+    retval = wal_replay_scan(&end, data, size, trailer_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_image;
+    }
+
+    /* decode and apply each record. */
+    for (offset = STORE_HEADER_SIZE; offset < end; )
+    {
+        memcpy(&record_size, data + offset, sizeof(record_size));
+        record_size = socket_utility_ntoh32(record_size);
+
+        retval =
+            metadata_from_data(
+                &records[count], w->alloc,
+                data + offset + STORE_RECORD_PREFIX_SIZE, record_size);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_records;
+        }
+
+        offset += STORE_RECORD_PREFIX_SIZE + record_size + trailer_size;
+        if (++count == WAL_REPLAY_CHUNK)
+        {
+            retval = wal_replay_chunk(w, records, &count);
+            if (STATUS_SUCCESS != retval)
+            {
+                goto cleanup_image;
+            }
+        }
+    }
+
+    retval = wal_replay_chunk(w, records, &count);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_image;
+    }
+
+    /* the log can only be emptied once the target is durable. */
+    retval = store_file_sync(w->target);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_image;
+    }
+
+    retval = store_file_truncate(w->log, STORE_HEADER_SIZE);
+    goto cleanup_image;
+
+cleanup_records:
+    for (size_t i = 0; i < count; ++i)
+    {
+        release_retval = resource_release(metadata_resource_handle(records[i]));
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+cleanup_image:
+    release_retval = resource_release(secure_buffer_resource_handle(image));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
@@ -0,0 +1,46 @@
+/**
+ * \file wal/wal_replay_chunk.c
+ *
+ * \brief Apply a chunk of decoded log records to the target of a \ref wal.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "wal_internal.h"
+
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Append a chunk of decoded records to the target, and release them.
+ *
+ * \param w             The \ref wal for this operation.
+ * \param records       The decoded records.
+ * \param count         Pointer to the number of decoded records, which is
+ *                      reset to zero.
+ *
+ * \returns a status code indicating success or failure.
+ */
+status FN_DECL_MUST_CHECK
+wal_replay_chunk(
+    wal* w, metadata** records, size_t* count)
+{
+    status retval, release_retval;
+
+    retval =
+        store_file_append(
+            w->target, (const metadata* const*)records, *count, false);
+
+    for (size_t i = 0; i < *count; ++i)
+    {
+        release_retval = resource_release(metadata_resource_handle(records[i]));
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    *count = 0;
+
+    return retval;
+}
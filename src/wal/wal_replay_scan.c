@@ -0,0 +1,94 @@
+/**
+ * \file wal/wal_replay_scan.c
+ *
+ * \brief Find the records of a log image that can be replayed.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <nepe2/error_codes.h>
+#include <rcpr/socket_utilities.h>
+#include <string.h>
+
+#include "wal_internal.h"
+
+RCPR_IMPORT_socket_utilities;
+
+/**
+ * \brief Find the end of the records in a log image that can be replayed.
+ *
+ * \param end           Pointer to receive the offset just past the last record
+ *                      to replay.
+ * \param data          The log image.
+ * \param size          The size of the log image.
+ * \param trailer_size  The size of the checksum after each record, or zero if
+ *                      the log is not checksummed.
+ *
+ * \note Each record is checked for its framing, its checksum, and its header,
+ * without being decoded. The scan stops at the first record that fails. If
+ * that record runs to the end of the image, or is followed only by zeroes, it
+ * is the torn tail of an unacknowledged commit and is dropped. Otherwise, a
+ * committed record was damaged, and nothing may be replayed.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_WAL_CORRUPT if a damaged record is followed by more of the log.
+ */
+status FN_DECL_MUST_CHECK
+wal_replay_scan(
+    size_t* end, const uint8_t* data, size_t size, size_t trailer_size)
+{
+    metadata_extent extent;
+    size_t offset = STORE_HEADER_SIZE;
+    size_t frame_end, bad_index;
+    uint32_t record_size, net_crc;
+
+    while (size - offset >= STORE_RECORD_PREFIX_SIZE)
+    {
+        memcpy(&record_size, data + offset, sizeof(record_size));
+        record_size = socket_utility_ntoh32(record_size);
+
+        /* a record that runs past the end of the image is the torn tail. */
+        if ((uint64_t)record_size + trailer_size
+                > size - offset - STORE_RECORD_PREFIX_SIZE)
+        {
+            break;
+        }
+
+        extent.offset = offset + STORE_RECORD_PREFIX_SIZE;
+        extent.size = record_size;
+        frame_end = extent.offset + record_size + trailer_size;
+
+        if (trailer_size > 0)
+        {
+            memcpy(
+                &net_crc, data + extent.offset + record_size,
+                sizeof(net_crc));
+        }
+
+        if ((trailer_size > 0
+                && socket_utility_ntoh32(net_crc)
+                    != store_crc32c(0, data + extent.offset, record_size))
+         || STATUS_SUCCESS
+                != metadata_header_batch_check(&bad_index, data, &extent, 1))
+        {
+            /* only a torn tail may be dropped. */
+            for (size_t i = frame_end; i < size; ++i)
+            {
+                if (0 != data[i])
+                {
+                    return ERROR_WAL_CORRUPT;
+                }
+            }
+
+            break;
+        }
+
+        offset = frame_end;
+    }
+
+    *end = offset;
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,26 @@
+/**
+ * \file wal/wal_resource_handle.c
+ *
+ * \brief Get the resource handle for a \ref wal.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "wal_internal.h"
+
+/**
+ * \brief Given a \ref wal instance, return the resource handle for this
+ * \ref wal instance.
+ *
+ * \param w             The \ref wal instance from which the resource handle is
+ *                      returned.
+ *
+ * \returns the resource handle for this \ref wal instance.
+ */
+RCPR_SYM(resource)*
+wal_resource_handle(
+    wal* w)
+{
+    return &w->hdr;
+}
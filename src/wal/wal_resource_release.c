@@ -0,0 +1,81 @@
+/**
+ * \file wal/wal_resource_release.c
+ *
+ * \brief Release a \ref wal resource.
+ *
+ * \copyright 2023 Justin Handville.  Please see License.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "wal_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Release a \ref wal resource.
+ *
+ * \param r             Pointer to the \ref wal resource to be released.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - an error code on failure.
+ */
+status wal_resource_release(RCPR_SYM(resource)* r)
+{
+    status retval = STATUS_SUCCESS;
+    status release_retval;
+
+    wal* w = (wal*)r;
+
+    /* parameter sanity checks. */
+    RCPR_MODEL_ASSERT(prop_wal_valid(w));
+    RCPR_MODEL_ASSERT(!w->busy && 0 == w->pending_count);
+
+    /* cache allocator. */
+    allocator* alloc = w->alloc;
+
+    /* release the record queues. */
+    release_retval = allocator_reclaim(alloc, w->pending);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    release_retval = allocator_reclaim(alloc, w->committing);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    /* release the log and the target. */
+    release_retval = resource_release(store_file_resource_handle(w->log));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    release_retval = resource_release(store_file_resource_handle(w->target));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    /* destroy the commit lock. */
+    pthread_cond_destroy(&w->cond);
+    pthread_mutex_destroy(&w->lock);
+
+    /* clear memory. */
+    RCPR_MODEL_EXEMPT(memset(w, 0, sizeof(*w)));
+
+    /* reclaim memory. */
+    release_retval = allocator_reclaim(alloc, w);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
@@ -0,0 +1,401 @@
+/**
+ * \file test/agent/test_agent.cpp
+ *
+ * \brief Unit tests for agent.
+ */
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <minunit/minunit.h>
+#include <nepe2/agent.h>
+#include <nepe2/error_codes.h>
+#include <string.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "../test_record.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+TEST_SUITE(agent);
+
+static const char* MASTER = "correct horse battery staple";
+static const uint32_t ITERATIONS = 16;
+static const uint32_t RECORD_COUNT = 4;
+
+/**
+ * \brief Create a derive context for the test master passphrase.
+ */
+static status context_create(derive_context** ctx, allocator* alloc)
+{
+    status retval, release_retval;
+    secure_buffer* master = nullptr;
+    size_t size;
+
+    retval = secure_buffer_create(&master, alloc, strlen(MASTER));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    memcpy(secure_buffer_data(&size, master), MASTER, strlen(MASTER));
+
+    retval = derive_context_create(ctx, alloc, master, ITERATIONS);
+    release_retval = resource_release(secure_buffer_resource_handle(master));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * Verify that an agent answers batched lookup and derive requests.
+ */
+TEST(lookup_and_derive)
+{
+    allocator* alloc = nullptr;
+    metadata* records[RECORD_COUNT];
+    const metadata* crecords[RECORD_COUNT];
+    struct iovec iov[RECORD_COUNT * METADATA_IOVEC_COUNT];
+    uint8_t scratch[RECORD_COUNT * METADATA_IOVEC_FRAMED_SCRATCH_SIZE];
+    secure_buffer* image = nullptr;
+    secure_buffer* response = nullptr;
+    secure_buffer* expected = nullptr;
+    metadata* copy = nullptr;
+    store* vault = nullptr;
+    derive_context* ctx = nullptr;
+    derive_context* check_ctx = nullptr;
+    agent* ag = nullptr;
+    status run_retval = -1;
+    status entry_status;
+    const void* data;
+    uint64_t creation_date;
+    uint32_t kdf_cost;
+    size_t size, iov_size, offset;
+    int fd = -1;
+
+    std::string path =
+        "/tmp/nepe2-agent-test-" + std::to_string(getpid()) + ".sock";
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* build a vault image with a store header and framed records. */
+    for (uint32_t i = 0; i < RECORD_COUNT; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == test_record_create(
+                        &records[i], alloc, i, { .password_length = 16 + i }));
+        crecords[i] = records[i];
+    }
+
+    /* one record has its own kdf cost, so it is served as serial version 2. */
+    TEST_ASSERT(STATUS_SUCCESS == metadata_kdf_cost_set(records[2], 32));
+
+    /* another has a kdf cost that no derivation accepts. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == metadata_kdf_cost_set(
+                    records[3], (uint32_t)DERIVE_COST_MAX + 1));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == metadata_to_iovec_batch(
+                    iov, scratch, &iov_size, crecords, RECORD_COUNT));
+    std::vector<uint8_t> bytes;
+    test_image_append_header(bytes);
+    for (const auto& entry : iov)
+    {
+        bytes.insert(
+            bytes.end(), (uint8_t*)entry.iov_base,
+            (uint8_t*)entry.iov_base + entry.iov_len);
+    }
+    TEST_ASSERT(STATUS_SUCCESS == test_image_to_buffer(&image, alloc, bytes));
+    TEST_ASSERT(
+        STATUS_SUCCESS == store_create_from_buffer(&vault, alloc, image, 1));
+
+    /* start an agent. */
+    TEST_ASSERT(STATUS_SUCCESS == context_create(&ctx, alloc));
+    TEST_ASSERT(STATUS_SUCCESS == context_create(&check_ctx, alloc));
+    unlink(path.c_str());
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == agent_create(&ag, alloc, vault, ctx, path.c_str(), 0));
+    std::thread runner([&]() { run_retval = agent_run(ag); });
+    TEST_ASSERT(STATUS_SUCCESS == agent_connect(&fd, path.c_str()));
+
+    /* look up two records and one missing hash id in one batch. */
+    uint8_t hash_ids[3][32];
+    test_hash_id_init(hash_ids[0], 2);
+    test_hash_id_init(hash_ids[1], 99);
+    test_hash_id_init(hash_ids[2], 0);
+    const void* keys[3] = { hash_ids[0], hash_ids[1], hash_ids[2] };
+    const size_t key_sizes[3] = { 32, 32, 32 };
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == agent_request(
+                    &response, alloc, fd, AGENT_OP_LOOKUP, keys, key_sizes,
+                    3));
+
+    /* the first entry is the serialized record. */
+    offset = 0;
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == agent_response_entry_next(
+                    &entry_status, &data, &size, &offset, response));
+    TEST_ASSERT(STATUS_SUCCESS == entry_status);
+    TEST_ASSERT(
+        STATUS_SUCCESS == metadata_from_data(&copy, alloc, data, size));
+    TEST_ASSERT(
+        STATUS_SUCCESS == metadata_creation_date_get(&creation_date, copy));
+    TEST_EXPECT(2 == creation_date);
+    TEST_ASSERT(STATUS_SUCCESS == metadata_kdf_cost_get(&kdf_cost, copy));
+    TEST_EXPECT(32 == kdf_cost);
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(metadata_resource_handle(copy)));
+
+    /* the second entry was not found. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == agent_response_entry_next(
+                    &entry_status, &data, &size, &offset, response));
+    TEST_EXPECT(ERROR_STORE_RECORD_NOT_FOUND == entry_status);
+    TEST_EXPECT(0 == size);
+
+    /* the third entry is found, and there are no more. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == agent_response_entry_next(
+                    &entry_status, &data, &size, &offset, response));
+    TEST_EXPECT(STATUS_SUCCESS == entry_status);
+    TEST_EXPECT(
+        ERROR_AGENT_BAD_FRAME
+            == agent_response_entry_next(
+                    &entry_status, &data, &size, &offset, response));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(response)));
+
+    /* derive the same batch on the same connection. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == agent_request(
+                    &response, alloc, fd, AGENT_OP_DERIVE, keys, key_sizes,
+                    3));
+    offset = 0;
+    for (size_t i = 0; i < 3; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == agent_response_entry_next(
+                        &entry_status, &data, &size, &offset, response));
+        if (1 == i)
+        {
+            TEST_EXPECT(ERROR_STORE_RECORD_NOT_FOUND == entry_status);
+            continue;
+        }
+
+        /* each password matches a local derivation. */
+        const uint32_t id = (0 == i) ? 2 : 0;
+        TEST_ASSERT(STATUS_SUCCESS == entry_status);
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == derive_password(&expected, alloc, check_ctx, records[id]));
+        size_t expected_size;
+        const void* expected_data =
+            secure_buffer_data(&expected_size, expected);
+        TEST_ASSERT(16 + id == size);
+        TEST_EXPECT(expected_size == size);
+        TEST_EXPECT(0 == memcmp(expected_data, data, size));
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == resource_release(secure_buffer_resource_handle(expected)));
+    }
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(response)));
+
+    /* an invalid record fails its own entry and not the rest. */
+    test_hash_id_init(hash_ids[0], 3);
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == agent_request(
+                    &response, alloc, fd, AGENT_OP_DERIVE, keys, key_sizes,
+                    3));
+    offset = 0;
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == agent_response_entry_next(
+                    &entry_status, &data, &size, &offset, response));
+    TEST_EXPECT(ERROR_DERIVE_INVALID_COST == entry_status);
+    TEST_EXPECT(0 == size);
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == agent_response_entry_next(
+                    &entry_status, &data, &size, &offset, response));
+    TEST_EXPECT(ERROR_STORE_RECORD_NOT_FOUND == entry_status);
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == agent_response_entry_next(
+                    &entry_status, &data, &size, &offset, response));
+    TEST_EXPECT(STATUS_SUCCESS == entry_status);
+    TEST_EXPECT(16 == size);
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(response)));
+    test_hash_id_init(hash_ids[0], 2);
+
+    /* an unknown op is rejected without closing the connection. */
+    TEST_EXPECT(
+        ERROR_AGENT_UNKNOWN_OP
+            == agent_request(&response, alloc, fd, 0x7f, keys, key_sizes, 1));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == agent_request(
+                    &response, alloc, fd, AGENT_OP_LOOKUP, keys, key_sizes,
+                    0));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(response)));
+
+    /* a connection that arrives while the process is out of descriptors does
+     * not make the agent spin. */
+    struct rlimit old_limit, limit;
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path.c_str());
+    int raw_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    TEST_ASSERT(raw_fd >= 0);
+    TEST_ASSERT(0 == getrlimit(RLIMIT_NOFILE, &old_limit));
+    int lowest_fd = dup(0);
+    TEST_ASSERT(lowest_fd >= 0);
+    close(lowest_fd);
+    limit = old_limit;
+    limit.rlim_cur = lowest_fd;
+    TEST_ASSERT(0 == setrlimit(RLIMIT_NOFILE, &limit));
+    TEST_ASSERT(
+        0 == connect(raw_fd, (const struct sockaddr*)&addr, sizeof(addr)));
+    struct rusage before, after;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    getrusage(RUSAGE_SELF, &before);
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    getrusage(RUSAGE_SELF, &after);
+    long cpu_usec =
+        (after.ru_utime.tv_sec - before.ru_utime.tv_sec) * 1000000L
+      + (after.ru_utime.tv_usec - before.ru_utime.tv_usec)
+      + (after.ru_stime.tv_sec - before.ru_stime.tv_sec) * 1000000L
+      + (after.ru_stime.tv_usec - before.ru_stime.tv_usec);
+    TEST_EXPECT(cpu_usec < 150000);
+
+    /* while it waits to be accepted, the client writes exactly one full read
+     * of requests and shuts down its side, so that the agent reads the
+     * requests and EOF together: a lookup of the record with id 2, and a
+     * lookup of a hash id that pads the requests out. */
+    const uint32_t pad_size = 16384 - 45 - 13;
+    std::vector<uint8_t> frames;
+    test_image_append_u32(frames, 41);
+    frames.push_back(AGENT_OP_LOOKUP);
+    test_image_append_u32(frames, 1);
+    test_image_append_u32(frames, 32);
+    frames.insert(frames.end(), hash_ids[0], hash_ids[0] + 32);
+    test_image_append_u32(frames, pad_size + 9);
+    frames.push_back(AGENT_OP_LOOKUP);
+    test_image_append_u32(frames, 1);
+    test_image_append_u32(frames, pad_size);
+    frames.resize(16384, 0xa5);
+    TEST_ASSERT(
+        (ssize_t)frames.size()
+            == write(raw_fd, frames.data(), frames.size()));
+    TEST_ASSERT(0 == shutdown(raw_fd, SHUT_WR));
+
+    /* once descriptors free up, the connection is accepted, and every request
+     * is answered before the agent closes it. */
+    TEST_ASSERT(0 == setrlimit(RLIMIT_NOFILE, &old_limit));
+    std::vector<uint8_t> answers;
+    for (;;)
+    {
+        uint8_t buffer[4096];
+        ssize_t bytes = read(raw_fd, buffer, sizeof(buffer));
+        TEST_ASSERT(bytes >= 0);
+        if (0 == bytes)
+        {
+            break;
+        }
+        answers.insert(answers.end(), buffer, buffer + bytes);
+    }
+    close(raw_fd);
+    offset = 0;
+    for (status expected_status :
+            { STATUS_SUCCESS, ERROR_STORE_RECORD_NOT_FOUND })
+    {
+        uint32_t net_value;
+        TEST_ASSERT(answers.size() - offset >= 20);
+        memcpy(&net_value, answers.data() + offset, sizeof(net_value));
+        size_t frame_size = ntohl(net_value);
+        memcpy(&net_value, answers.data() + offset + 4, sizeof(net_value));
+        TEST_EXPECT(STATUS_SUCCESS == ntohl(net_value));
+        memcpy(&net_value, answers.data() + offset + 12, sizeof(net_value));
+        TEST_EXPECT(expected_status == (status)ntohl(net_value));
+        offset += 4 + frame_size;
+    }
+    TEST_EXPECT(answers.size() == offset);
+
+    /* stop the agent. */
+    close(fd);
+    TEST_ASSERT(STATUS_SUCCESS == agent_stop(ag));
+    runner.join();
+    TEST_EXPECT(STATUS_SUCCESS == run_retval);
+
+    /* clean up. */
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(agent_resource_handle(ag)));
+    TEST_EXPECT(0 != access(path.c_str(), F_OK));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(derive_context_resource_handle(check_ctx)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(image)));
+    for (uint32_t i = 0; i < RECORD_COUNT; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == resource_release(metadata_resource_handle(records[i])));
+    }
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Verify that an agent can't be created on a path that is too long.
+ */
+TEST(path_too_long)
+{
+    allocator* alloc = nullptr;
+    agent* ag = nullptr;
+    int fd = -1;
+    std::string path(200, 'x');
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* the vault and context are never touched when creation fails. */
+    TEST_EXPECT(
+        ERROR_AGENT_PATH_TOO_LONG
+            == agent_create(&ag, alloc, nullptr, nullptr, path.c_str(), 0));
+    TEST_EXPECT(nullptr == ag);
+    TEST_EXPECT(
+        ERROR_AGENT_PATH_TOO_LONG == agent_connect(&fd, path.c_str()));
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
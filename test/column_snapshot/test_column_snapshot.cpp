@@ -0,0 +1,377 @@
+/**
+ * \file test/column_snapshot/test_column_snapshot.cpp
+ *
+ * \brief Unit tests for column_snapshot.
+ */
+
+#include <algorithm>
+#include <minunit/minunit.h>
+#include <nepe2/column_snapshot.h>
+#include <nepe2/error_codes.h>
+#include <string.h>
+#include <vector>
+
+#include "../../src/column_snapshot/column_snapshot_internal.h"
+#include "../test_record.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+TEST_SUITE(column_snapshot);
+
+static const char* KDF_NAMES[] = {
+    "pbkdf2-sha3-512", "argon2id", "scrypt" };
+
+static const char* ENCODINGS[] = {
+    "0123456789abcdef", "abcdefghijklmnopqrstuvwxyz012345", "01234567" };
+
+/**
+ * \brief Append a serialized record whose fields vary with its id.
+ */
+static status append_record(
+    std::vector<uint8_t>& image, allocator* alloc, uint32_t id)
+{
+    status retval, release_retval;
+    metadata* meta = nullptr;
+
+    retval =
+        test_record_create(
+            &meta, alloc, id,
+            { .version = 1 + id % 2,
+              .revocation_date = (id % 4) ? 0 : UINT64_MAX - id,
+              .expiration_date = id * 7919 % 1000,
+              .password_length = (id % 9) ? 16 + id % 8 : 0x80000000 + id,
+              .generation = id % 3, .legacy_flag = 0 != (id & 1),
+              .kdf_name = KDF_NAMES[id % 3], .encoding = ENCODINGS[id % 2] });
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* creation dates use the high word as well. */
+    retval =
+        metadata_creation_date_set(
+            meta, UINT64_C(0x100000000) * (id % 5) + id);
+    if (STATUS_SUCCESS == retval)
+    {
+        retval = test_image_append_metadata(image, alloc, meta);
+    }
+
+    release_retval = resource_release(metadata_resource_handle(meta));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Load a store of the given number of records.
+ */
+static status store_build(store** st, allocator* alloc, uint32_t count)
+{
+    status retval, release_retval;
+    secure_buffer* buffer = nullptr;
+    std::vector<uint8_t> image;
+
+    test_image_append_header(image);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        retval = append_record(image, alloc, i);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    retval = test_image_to_buffer(&buffer, alloc, image);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = store_create_from_buffer(st, alloc, buffer, 2);
+
+    release_retval = resource_release(secure_buffer_resource_handle(buffer));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Read a snapshot field from a record, the slow way.
+ */
+static status field_read(
+    uint64_t* value, const column_snapshot* snap, const metadata* meta,
+    uint32_t field)
+{
+    status retval;
+    uint32_t u32;
+    bool flag;
+    const char* name;
+
+    switch (field)
+    {
+        case COLUMN_SNAPSHOT_FIELD_VERSION:
+            retval = metadata_version_get(&u32, meta);
+            break;
+
+        case COLUMN_SNAPSHOT_FIELD_CREATION_DATE:
+            return metadata_creation_date_get(value, meta);
+
+        case COLUMN_SNAPSHOT_FIELD_REVOCATION_DATE:
+            return metadata_revocation_date_get(value, meta);
+
+        case COLUMN_SNAPSHOT_FIELD_EXPIRATION_DATE:
+            return metadata_expiration_date_get(value, meta);
+
+        case COLUMN_SNAPSHOT_FIELD_PASSWORD_LENGTH:
+            retval = metadata_password_length_get(&u32, meta);
+            break;
+
+        case COLUMN_SNAPSHOT_FIELD_GENERATION:
+            retval = metadata_generation_get(&u32, meta);
+            break;
+
+        case COLUMN_SNAPSHOT_FIELD_LEGACY:
+            retval = metadata_legacy_flag_get(&flag, meta);
+            u32 = flag;
+            break;
+
+        case COLUMN_SNAPSHOT_FIELD_KDF:
+            retval = metadata_kdf_name_get(&name, meta);
+            if (STATUS_SUCCESS == retval)
+            {
+                retval = column_snapshot_kdf_id_get(&u32, snap, name);
+            }
+            break;
+
+        default:
+            retval = metadata_encoding_get(&name, meta);
+            if (STATUS_SUCCESS == retval)
+            {
+                retval = column_snapshot_alphabet_id_get(&u32, snap, name);
+            }
+            break;
+    }
+
+    if (STATUS_SUCCESS == retval)
+    {
+        *value = u32;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Compare two values with an operator.
+ */
+static bool op_apply(uint32_t op, uint64_t lhs, uint64_t rhs)
+{
+    switch (op)
+    {
+        case COLUMN_SNAPSHOT_OP_LT: return lhs < rhs;
+        case COLUMN_SNAPSHOT_OP_LE: return lhs <= rhs;
+        case COLUMN_SNAPSHOT_OP_EQ: return lhs == rhs;
+        case COLUMN_SNAPSHOT_OP_NE: return lhs != rhs;
+        case COLUMN_SNAPSHOT_OP_GE: return lhs >= rhs;
+        default:                    return lhs > rhs;
+    }
+}
+
+/**
+ * \brief Check every field and operator against a record walk.
+ */
+static bool scans_match(const store* st, const column_snapshot* snap)
+{
+    size_t rows = column_snapshot_row_count_get(snap);
+    size_t words = COLUMN_SNAPSHOT_BITMAP_WORDS(rows);
+    std::vector<uint64_t> bitmap(words + 1);
+    std::vector<uint64_t> scalar(words);
+    const void* column;
+    size_t width;
+    uint64_t row;
+    const uint64_t values[] = {
+        0, 1, 2, 17, 500, 0x80000000, 0x100000003, UINT64_MAX - 64,
+        UINT64_MAX };
+
+    for (uint32_t field = COLUMN_SNAPSHOT_FIELD_VERSION;
+         field <= COLUMN_SNAPSHOT_FIELD_ALPHABET; ++field)
+    {
+        for (uint32_t op = COLUMN_SNAPSHOT_OP_LT; op <= COLUMN_SNAPSHOT_OP_GT;
+             ++op)
+        {
+            for (uint64_t value : values)
+            {
+                size_t expected_count = 0;
+
+                /* poison the bitmap, including the word past the end. */
+                std::fill(bitmap.begin(), bitmap.end(), UINT64_MAX);
+                if (STATUS_SUCCESS
+                        != column_snapshot_scan(
+                                bitmap.data(), snap, field, op, value))
+                {
+                    return false;
+                }
+
+                for (size_t i = 0; i < rows; ++i)
+                {
+                    if (STATUS_SUCCESS
+                            != field_read(
+                                    &row, snap, store_record_get(st, i),
+                                    field))
+                    {
+                        return false;
+                    }
+
+                    bool expected = op_apply(op, row, value);
+                    bool actual = (bitmap[i / 64] >> (i % 64)) & 1;
+                    if (expected != actual)
+                    {
+                        return false;
+                    }
+
+                    expected_count += expected;
+                }
+
+                /* bits past the last row are clear. */
+                if (rows % 64
+                 && (bitmap[rows / 64] >> (rows % 64)) != 0)
+                {
+                    return false;
+                }
+
+                if (expected_count
+                        != column_snapshot_bitmap_count(bitmap.data(), rows))
+                {
+                    return false;
+                }
+
+                /* the scalar kernel, which an AVX2 host never falls back to,
+                 * agrees with the scan once its padding rows are cleared. */
+                if (STATUS_SUCCESS
+                        != column_snapshot_column_get(
+                                &column, &width, snap, field))
+                {
+                    return false;
+                }
+
+                column_snapshot_scan_scalar(
+                    scalar.data(), column, width, words, op, value);
+                if (rows % 64)
+                {
+                    scalar[words - 1] &= (UINT64_C(1) << (rows % 64)) - 1;
+                }
+
+                if (!std::equal(scalar.begin(), scalar.end(), bitmap.begin()))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Verify that scans agree with a record walk for row counts on and off word
+ * boundaries.
+ */
+TEST(scan)
+{
+    allocator* alloc = nullptr;
+    const uint32_t COUNTS[] = { 0, 1, 63, 64, 65, 200 };
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    for (uint32_t count : COUNTS)
+    {
+        store* st = nullptr;
+        column_snapshot* snap = nullptr;
+
+        /* we can build a store and a snapshot of it. */
+        TEST_ASSERT(STATUS_SUCCESS == store_build(&st, alloc, count));
+        TEST_ASSERT(STATUS_SUCCESS == column_snapshot_create(&snap, alloc, st));
+        TEST_EXPECT(count == column_snapshot_row_count_get(snap));
+
+        /* every scan matches. */
+        TEST_EXPECT(scans_match(st, snap));
+
+        /* clean up. */
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == resource_release(column_snapshot_resource_handle(snap)));
+        TEST_ASSERT(
+            STATUS_SUCCESS == resource_release(store_resource_handle(st)));
+    }
+
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Verify the dictionaries and the argument checks.
+ */
+TEST(dictionaries)
+{
+    allocator* alloc = nullptr;
+    store* st = nullptr;
+    column_snapshot* snap = nullptr;
+    uint32_t id, other;
+    uint64_t bitmap[2];
+
+    /* we can build a store and a snapshot of it. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+    TEST_ASSERT(STATUS_SUCCESS == store_build(&st, alloc, 90));
+    TEST_ASSERT(STATUS_SUCCESS == column_snapshot_create(&snap, alloc, st));
+
+    /* each kdf name has its own id. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == column_snapshot_kdf_id_get(&id, snap, "argon2id"));
+    TEST_ASSERT(
+        STATUS_SUCCESS == column_snapshot_kdf_id_get(&other, snap, "scrypt"));
+    TEST_EXPECT(id != other);
+    TEST_EXPECT(
+        ERROR_COLUMN_SNAPSHOT_NAME_NOT_FOUND
+            == column_snapshot_kdf_id_get(&id, snap, "bcrypt"));
+
+    /* a kdf id selects the records with that kdf. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == column_snapshot_scan(
+                    bitmap, snap, COLUMN_SNAPSHOT_FIELD_KDF,
+                    COLUMN_SNAPSHOT_OP_EQ, other));
+    TEST_EXPECT(30 == column_snapshot_bitmap_count(bitmap, 90));
+
+    /* the encodings have their own dictionary. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == column_snapshot_alphabet_id_get(
+                    &id, snap, "abcdefghijklmnopqrstuvwxyz012345"));
+    TEST_EXPECT(
+        ERROR_COLUMN_SNAPSHOT_NAME_NOT_FOUND
+            == column_snapshot_alphabet_id_get(&id, snap, "01234567"));
+
+    /* bad fields and operators are rejected. */
+    TEST_EXPECT(
+        ERROR_COLUMN_SNAPSHOT_INVALID_FIELD
+            == column_snapshot_scan(bitmap, snap, 0, COLUMN_SNAPSHOT_OP_EQ, 0));
+    TEST_EXPECT(
+        ERROR_COLUMN_SNAPSHOT_INVALID_OPERATOR
+            == column_snapshot_scan(
+                    bitmap, snap, COLUMN_SNAPSHOT_FIELD_VERSION, 7, 0));
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(column_snapshot_resource_handle(snap)));
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(store_resource_handle(st)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
@@ -0,0 +1,179 @@
+/**
+ * \file test/cpp/test_nepe2_hpp.cpp
+ *
+ * \brief Unit tests for the C++ wrappers.
+ */
+
+#include <cstring>
+#include <minunit/minunit.h>
+#include <nepe2/nepe2.hpp>
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+TEST_SUITE(nepe2_hpp);
+
+namespace {
+
+/**
+ * \brief Create a secure buffer holding an ASCII zero terminated string.
+ */
+nepe2::secure_buffer string_buffer(allocator* alloc, const char* str)
+{
+    nepe2::secure_buffer buffer(alloc, strlen(str) + 1);
+    memcpy(buffer.span().data(), str, strlen(str));
+
+    return buffer;
+}
+
+} /* namespace */
+
+/**
+ * Secure buffers are move-only owners with span access.
+ */
+TEST(secure_buffer_move)
+{
+    allocator* alloc = nullptr;
+    const std::byte BYTES[] = { std::byte{1}, std::byte{2}, std::byte{3} };
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    {
+        nepe2::secure_buffer a(alloc, std::span(BYTES));
+        ::secure_buffer* raw = a.get();
+
+        /* the buffer holds a copy of the bytes. */
+        TEST_ASSERT(3 == a.size());
+        TEST_EXPECT(std::ranges::equal(a.span(), std::span(BYTES)));
+
+        /* moving transfers ownership without a new allocation. */
+        nepe2::secure_buffer b(std::move(a));
+        TEST_EXPECT(!a);
+        TEST_EXPECT(raw == b.get());
+        TEST_EXPECT(a.span().empty());
+
+        /* move assignment releases the previous buffer. */
+        nepe2::secure_buffer c(alloc, 8);
+        c = std::move(b);
+        TEST_EXPECT(raw == c.get());
+
+        /* release gives up ownership. */
+        ::secure_buffer* released = c.release();
+        TEST_EXPECT(!c);
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == resource_release(secure_buffer_resource_handle(released)));
+    }
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Metadata records can be built with moved buffers and round trip.
+ */
+TEST(metadata_round_trip)
+{
+    allocator* alloc = nullptr;
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    {
+        nepe2::metadata meta(alloc);
+        TEST_EXPECT(meta.empty());
+
+        /* a moved hash id is used in place. */
+        nepe2::secure_buffer hash_id(alloc, 32);
+        std::ranges::fill(hash_id.span(), std::byte{0x7e});
+        const std::byte* hash_id_data = hash_id.span().data();
+        meta.hash_id(std::move(hash_id));
+        TEST_EXPECT(!hash_id);
+        TEST_EXPECT(hash_id_data == meta.hash_id().data());
+
+        meta.kdf_name(string_buffer(alloc, "pbkdf2-sha3-512"));
+        meta.encoding(string_buffer(alloc, "0123456789abcdef"));
+        meta.version(1);
+        meta.creation_date(100);
+        meta.revocation_date(0);
+        meta.expiration_date(200);
+        meta.password_length(24);
+        meta.generation(3);
+        meta.legacy_flag(false);
+        TEST_EXPECT(!meta.empty());
+
+        /* an unset kdf cost reads as zero. */
+        TEST_EXPECT(0 == meta.kdf_cost());
+        meta.kdf_cost(120000);
+
+        /* round trip through the serialized form. */
+        nepe2::secure_buffer serialized = meta.to_buffer(alloc);
+        nepe2::metadata copy =
+            nepe2::metadata::from_data(alloc, serialized.span());
+
+        TEST_EXPECT(std::ranges::equal(meta.hash_id(), copy.hash_id()));
+        TEST_EXPECT(copy.kdf_name() == "pbkdf2-sha3-512");
+        TEST_EXPECT(copy.encoding() == "0123456789abcdef");
+        TEST_EXPECT(200 == copy.expiration_date());
+        TEST_EXPECT(24 == copy.password_length());
+        TEST_EXPECT(3 == copy.generation());
+        TEST_EXPECT(120000 == copy.kdf_cost());
+        TEST_EXPECT(!copy.legacy_flag());
+
+        /* moved-from records own nothing. */
+        nepe2::metadata moved(std::move(copy));
+        TEST_EXPECT(!copy);
+        TEST_EXPECT(3 == moved.generation());
+    }
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Errors from the C API are thrown with their status codes.
+ */
+TEST(errors)
+{
+    allocator* alloc = nullptr;
+    status code = STATUS_SUCCESS;
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    {
+        nepe2::metadata meta(alloc);
+
+        /* getting an unset field throws. */
+        try
+        {
+            (void)meta.generation();
+        }
+        catch (const nepe2::error& e)
+        {
+            code = e.code();
+        }
+
+        TEST_EXPECT(ERROR_METADATA_FIELD_NOT_SET == code);
+
+        /* a rejected buffer is still released. */
+        code = STATUS_SUCCESS;
+        try
+        {
+            meta.encoding(string_buffer(alloc, "abc"));
+        }
+        catch (const nepe2::error& e)
+        {
+            code = e.code();
+        }
+
+        TEST_EXPECT(ERROR_METADATA_BAD_ENCODING_LENGTH == code);
+    }
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
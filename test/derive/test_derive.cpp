@@ -0,0 +1,596 @@
+/**
+ * \file test/derive/test_derive.cpp
+ *
+ * \brief Unit tests for derive.
+ */
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <minunit/minunit.h>
+#include <nepe2/derive.h>
+#include <nepe2/error_codes.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "../test_record.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+TEST_SUITE(derive);
+
+static const char* MASTER = "correct horse battery staple";
+static const char* SESSION = "tuesday";
+static const uint32_t ITERATIONS = 16;
+
+/**
+ * \brief Create a derive context for the test master passphrase.
+ */
+static status context_create(derive_context** ctx, allocator* alloc)
+{
+    status retval, release_retval;
+    secure_buffer* master = nullptr;
+    size_t size;
+
+    retval = secure_buffer_create(&master, alloc, strlen(MASTER));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    memcpy(secure_buffer_data(&size, master), MASTER, strlen(MASTER));
+
+    retval = derive_context_create(ctx, alloc, master, ITERATIONS);
+    release_retval = resource_release(secure_buffer_resource_handle(master));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Compute the expected PBKDF2 HMAC-SHA3-512 password independently.
+ */
+static std::string expected_password(
+    uint32_t id, uint32_t generation, uint32_t password_length,
+    const char* encoding, unsigned int bits,
+    uint32_t iterations = ITERATIONS)
+{
+    std::vector<uint8_t> salt;
+    uint32_t net_version = htonl(1);
+    uint32_t net_generation = htonl(generation);
+    uint8_t hash_id[32];
+
+    memset(hash_id, 0, sizeof(hash_id));
+    memcpy(hash_id, &id, sizeof(id));
+    salt.insert(
+        salt.end(), (uint8_t*)&net_version,
+        (uint8_t*)&net_version + sizeof(net_version));
+    salt.insert(
+        salt.end(), (uint8_t*)&net_generation,
+        (uint8_t*)&net_generation + sizeof(net_generation));
+    salt.insert(salt.end(), hash_id, hash_id + sizeof(hash_id));
+
+    std::vector<uint8_t> key((password_length * bits + 7) / 8);
+    PKCS5_PBKDF2_HMAC(
+        MASTER, strlen(MASTER), salt.data(), salt.size(), iterations,
+        EVP_sha3_512(), key.size(), key.data());
+
+    /* read each character's bits, most significant bit first. */
+    std::string out;
+    for (size_t i = 0; i < password_length; ++i)
+    {
+        unsigned int index = 0;
+        for (unsigned int b = 0; b < bits; ++b)
+        {
+            size_t bit = i * bits + b;
+            index = (index << 1) | ((key[bit / 8] >> (7 - bit % 8)) & 1);
+        }
+
+        out.push_back(encoding[index]);
+    }
+
+    return out;
+}
+
+/**
+ * \brief Compute the expected session HMAC-SHA3-512 password independently.
+ */
+static std::string expected_session_password(
+    const char* session, uint32_t id, uint32_t generation,
+    uint32_t password_length, const char* encoding, unsigned int bits)
+{
+    std::string salt = std::string("nepe2 session") + session;
+    uint8_t session_key[64];
+    uint32_t fields[4] = {
+        0, htonl(1), htonl(generation), htonl(password_length) };
+    uint8_t message[sizeof(fields) + 32];
+    unsigned int size;
+
+    PKCS5_PBKDF2_HMAC(
+        MASTER, strlen(MASTER), (const uint8_t*)salt.data(), salt.size(),
+        ITERATIONS, EVP_sha3_512(), sizeof(session_key), session_key);
+
+    memset(message, 0, sizeof(message));
+    memcpy(message + sizeof(fields), &id, sizeof(id));
+
+    std::vector<uint8_t> key;
+    for (uint32_t block = 1; key.size() * 8 < password_length * bits; ++block)
+    {
+        uint8_t digest[64];
+
+        fields[0] = htonl(block);
+        memcpy(message, fields, sizeof(fields));
+        HMAC(
+            EVP_sha3_512(), session_key, sizeof(session_key), message,
+            sizeof(message), digest, &size);
+        key.insert(key.end(), digest, digest + sizeof(digest));
+    }
+
+    /* read each character's bits, most significant bit first. */
+    std::string out;
+    for (size_t i = 0; i < password_length; ++i)
+    {
+        unsigned int index = 0;
+        for (unsigned int b = 0; b < bits; ++b)
+        {
+            size_t bit = i * bits + b;
+            index = (index << 1) | ((key[bit / 8] >> (7 - bit % 8)) & 1);
+        }
+
+        out.push_back(encoding[index]);
+    }
+
+    return out;
+}
+
+/**
+ * \brief Start a session on a derive context.
+ */
+static status session_set(
+    derive_context* ctx, allocator* alloc, const char* value)
+{
+    status retval, release_retval;
+    secure_buffer* session = nullptr;
+    size_t size;
+
+    retval = secure_buffer_create(&session, alloc, strlen(value));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    memcpy(secure_buffer_data(&size, session), value, strlen(value));
+
+    retval = derive_context_session_set(ctx, session);
+    release_retval = resource_release(secure_buffer_resource_handle(session));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Get a password as a string.
+ */
+static std::string password_string(secure_buffer* password)
+{
+    size_t size;
+    const char* data = (const char*)secure_buffer_data(&size, password);
+
+    return std::string(data, size);
+}
+
+/**
+ * \brief A stand-in legacy scheme that returns "legacy-" and the record id.
+ */
+static status legacy_stub(
+    void* context, secure_buffer** password, allocator* alloc,
+    const secure_buffer*, const metadata* record)
+{
+    status retval;
+    uint64_t id;
+    size_t size;
+
+    ++*(std::atomic<int>*)context;
+
+    retval = metadata_creation_date_get(&id, record);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    std::string value = "legacy-" + std::to_string(id);
+    retval = secure_buffer_create(password, alloc, value.size());
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    memcpy(secure_buffer_data(&size, *password), value.data(), value.size());
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * Verify that the PBKDF2 HMAC-SHA3-512 mode matches an independent
+ * computation for every alphabet length.
+ */
+TEST(pbkdf2_sha3_512)
+{
+    allocator* alloc = nullptr;
+    derive_context* ctx = nullptr;
+    metadata* meta = nullptr;
+    secure_buffer* password = nullptr;
+    const char* encodings[] = {
+        "01",
+        "0123",
+        "01234567",
+        "0123456789abcdef",
+        "abcdefghijklmnopqrstuvwxyz012345",
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/" };
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+    TEST_ASSERT(STATUS_SUCCESS == context_create(&ctx, alloc));
+
+    for (unsigned int bits = 1; bits <= 6; ++bits)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == test_record_create(
+                        &meta, alloc, 7,
+                        { .password_length = 21, .generation = 3,
+                          .kdf_name = DERIVE_KDF_PBKDF2_SHA3_512,
+                          .encoding = encodings[bits - 1] }));
+        TEST_ASSERT(
+            STATUS_SUCCESS == derive_password(&password, alloc, ctx, meta));
+        TEST_EXPECT(
+            expected_password(7, 3, 21, encodings[bits - 1], bits)
+                == password_string(password));
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == resource_release(secure_buffer_resource_handle(password)));
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == resource_release(metadata_resource_handle(meta)));
+    }
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(derive_context_resource_handle(ctx)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Verify that a record with a kdf cost is derived with its own iteration
+ * count, and that a cost that PBKDF2 can't take is rejected.
+ */
+TEST(kdf_cost)
+{
+    allocator* alloc = nullptr;
+    derive_context* ctx = nullptr;
+    metadata* meta = nullptr;
+    secure_buffer* password = nullptr;
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+    TEST_ASSERT(STATUS_SUCCESS == context_create(&ctx, alloc));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == test_record_create(
+                    &meta, alloc, 7,
+                    { .password_length = 21, .generation = 3,
+                      .kdf_name = DERIVE_KDF_PBKDF2_SHA3_512 }));
+
+    /* the record cost replaces the context cost. */
+    TEST_ASSERT(STATUS_SUCCESS == metadata_kdf_cost_set(meta, 37));
+    TEST_EXPECT(STATUS_SUCCESS == derive_password_check(ctx, meta));
+    TEST_ASSERT(STATUS_SUCCESS == derive_password(&password, alloc, ctx, meta));
+    TEST_EXPECT(
+        expected_password(7, 3, 21, "0123456789abcdef", 4, 37)
+            == password_string(password));
+    TEST_EXPECT(
+        expected_password(7, 3, 21, "0123456789abcdef", 4)
+            != password_string(password));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(password)));
+
+    /* a cost past the largest iteration count is rejected. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == metadata_kdf_cost_set(meta, (uint32_t)DERIVE_COST_MAX + 1));
+    TEST_EXPECT(
+        ERROR_DERIVE_INVALID_COST
+            == derive_password(&password, alloc, ctx, meta));
+    TEST_EXPECT(
+        ERROR_DERIVE_INVALID_COST == derive_password_check(ctx, meta));
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(metadata_resource_handle(meta)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(derive_context_resource_handle(ctx)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Verify that calibration picks a usable cost that grows with the target.
+ */
+TEST(cost_calibrate)
+{
+    uint32_t short_cost = 0U;
+    uint32_t long_cost = 0U;
+
+    /* an unknown kdf can't be calibrated. */
+    TEST_EXPECT(
+        ERROR_DERIVE_UNKNOWN_KDF
+            == derive_cost_calibrate(&short_cost, "scrypt", 1000));
+    TEST_EXPECT(0U == short_cost);
+
+    /* both modes can be calibrated. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == derive_cost_calibrate(
+                    &short_cost, DERIVE_KDF_SESSION_HMAC_SHA3_512, 1000));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == derive_cost_calibrate(
+                    &long_cost, DERIVE_KDF_PBKDF2_SHA3_512, 100000));
+    TEST_EXPECT(short_cost >= 1U && short_cost <= DERIVE_COST_MAX);
+    TEST_EXPECT(long_cost >= 1U && long_cost <= DERIVE_COST_MAX);
+
+    /* a target 100 times longer gets a much larger cost, even on a noisy
+     * host. */
+    TEST_EXPECT(long_cost > 10 * short_cost);
+}
+
+/**
+ * Verify that the session HMAC-SHA3-512 mode matches an independent
+ * computation, and that it depends on the session passphrase.
+ */
+TEST(session_hmac_sha3_512)
+{
+    allocator* alloc = nullptr;
+    derive_context* ctx = nullptr;
+    metadata* meta = nullptr;
+    secure_buffer* password = nullptr;
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+    TEST_ASSERT(STATUS_SUCCESS == context_create(&ctx, alloc));
+
+    /* a password long enough to need three blocks. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == test_record_create(
+                    &meta, alloc, 7,
+                    { .password_length = 300, .generation = 3,
+                      .kdf_name = DERIVE_KDF_SESSION_HMAC_SHA3_512 }));
+
+    /* the record stage needs a session. */
+    TEST_EXPECT(
+        ERROR_DERIVE_SESSION_UNAVAILABLE
+            == derive_password(&password, alloc, ctx, meta));
+
+    TEST_ASSERT(STATUS_SUCCESS == session_set(ctx, alloc, SESSION));
+    TEST_ASSERT(STATUS_SUCCESS == derive_password(&password, alloc, ctx, meta));
+    std::string first = password_string(password);
+    TEST_EXPECT(
+        expected_session_password(SESSION, 7, 3, 300, "0123456789abcdef", 4)
+            == first);
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(password)));
+
+    /* a new session replaces the old one. */
+    TEST_ASSERT(STATUS_SUCCESS == session_set(ctx, alloc, "wednesday"));
+    TEST_ASSERT(STATUS_SUCCESS == derive_password(&password, alloc, ctx, meta));
+    TEST_EXPECT(first != password_string(password));
+    TEST_EXPECT(
+        expected_session_password(
+            "wednesday", 7, 3, 300, "0123456789abcdef", 4)
+                == password_string(password));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(password)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(metadata_resource_handle(meta)));
+
+    /* the password length feeds the record stage. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == test_record_create(
+                    &meta, alloc, 7,
+                    { .password_length = 21, .generation = 3,
+                      .kdf_name = DERIVE_KDF_SESSION_HMAC_SHA3_512,
+                      .encoding = "01" }));
+    TEST_ASSERT(STATUS_SUCCESS == derive_password(&password, alloc, ctx, meta));
+    TEST_EXPECT(
+        expected_session_password("wednesday", 7, 3, 21, "01", 1)
+            == password_string(password));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(password)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(metadata_resource_handle(meta)));
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(derive_context_resource_handle(ctx)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Verify that unsupported records are rejected.
+ */
+TEST(unsupported)
+{
+    allocator* alloc = nullptr;
+    derive_context* ctx = nullptr;
+    metadata* meta = nullptr;
+    secure_buffer* password = nullptr;
+    std::atomic<int> legacy_calls(0);
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+    TEST_ASSERT(STATUS_SUCCESS == context_create(&ctx, alloc));
+
+    /* an unknown kdf is rejected. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == test_record_create(
+                    &meta, alloc, 1,
+                    { .kdf_name = "scrypt", .encoding = "0123" }));
+    TEST_EXPECT(
+        ERROR_DERIVE_UNKNOWN_KDF
+            == derive_password(&password, alloc, ctx, meta));
+    TEST_EXPECT(ERROR_DERIVE_UNKNOWN_KDF == derive_password_check(ctx, meta));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(metadata_resource_handle(meta)));
+
+    /* a symbolic encoding is rejected. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == test_record_create(
+                    &meta, alloc, 1,
+                    { .kdf_name = DERIVE_KDF_PBKDF2_SHA3_512,
+                      .encoding = "SYMBOLIC-words" }));
+    TEST_EXPECT(
+        ERROR_DERIVE_UNSUPPORTED_ENCODING
+            == derive_password(&password, alloc, ctx, meta));
+    TEST_EXPECT(
+        ERROR_DERIVE_UNSUPPORTED_ENCODING == derive_password_check(ctx, meta));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(metadata_resource_handle(meta)));
+
+    /* a legacy record needs a legacy scheme. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == test_record_create(
+                    &meta, alloc, 1,
+                    { .legacy_flag = true,
+                      .kdf_name = DERIVE_KDF_PBKDF2_SHA3_512,
+                      .encoding = "0123" }));
+    TEST_EXPECT(
+        ERROR_DERIVE_LEGACY_UNAVAILABLE
+            == derive_password(&password, alloc, ctx, meta));
+    TEST_EXPECT(
+        ERROR_DERIVE_LEGACY_UNAVAILABLE == derive_password_check(ctx, meta));
+
+    /* once set, the legacy scheme is used. */
+    derive_context_legacy_set(ctx, &legacy_stub, &legacy_calls);
+    TEST_EXPECT(STATUS_SUCCESS == derive_password_check(ctx, meta));
+    TEST_ASSERT(STATUS_SUCCESS == derive_password(&password, alloc, ctx, meta));
+    TEST_EXPECT(1 == legacy_calls);
+    TEST_EXPECT("legacy-1" == password_string(password));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(password)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(metadata_resource_handle(meta)));
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(derive_context_resource_handle(ctx)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Verify that batch derivation of mixed records matches single derivation.
+ */
+TEST(batch)
+{
+    const size_t COUNT = 40;
+    allocator* alloc = nullptr;
+    derive_context* ctx = nullptr;
+    std::vector<metadata*> records(COUNT);
+    std::vector<secure_buffer*> passwords(COUNT);
+    secure_buffer* password = nullptr;
+    std::atomic<int> legacy_calls(0);
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+    TEST_ASSERT(STATUS_SUCCESS == context_create(&ctx, alloc));
+    TEST_ASSERT(STATUS_SUCCESS == session_set(ctx, alloc, SESSION));
+    derive_context_legacy_set(ctx, &legacy_stub, &legacy_calls);
+
+    /* every third record is a legacy record, and every other record uses the
+     * session. */
+    for (size_t i = 0; i < COUNT; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == test_record_create(
+                        &records[i], alloc, i,
+                        { .password_length = static_cast<uint32_t>(12 + i % 5),
+                          .legacy_flag = 0 == i % 3,
+                          .kdf_name =
+                              (i & 1) ? DERIVE_KDF_SESSION_HMAC_SHA3_512
+                                      : DERIVE_KDF_PBKDF2_SHA3_512 }));
+    }
+
+    /* derive the batch on several threads. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == derive_password_batch(
+                    passwords.data(), alloc, ctx,
+                    (const metadata* const*)records.data(), COUNT, 4));
+
+    /* each password matches a single derivation. */
+    for (size_t i = 0; i < COUNT; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == derive_password(&password, alloc, ctx, records[i]));
+        TEST_EXPECT(password_string(password) == password_string(passwords[i]));
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == resource_release(secure_buffer_resource_handle(password)));
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == resource_release(
+                        secure_buffer_resource_handle(passwords[i])));
+    }
+
+    /* a failing record fails the batch and leaves no passwords behind. */
+    derive_context_legacy_set(ctx, nullptr, nullptr);
+    TEST_EXPECT(
+        ERROR_DERIVE_LEGACY_UNAVAILABLE
+            == derive_password_batch(
+                    passwords.data(), alloc, ctx,
+                    (const metadata* const*)records.data(), COUNT, 3));
+    for (size_t i = 0; i < COUNT; ++i)
+    {
+        TEST_EXPECT(nullptr == passwords[i]);
+    }
+
+    /* clean up. */
+    for (size_t i = 0; i < COUNT; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == resource_release(metadata_resource_handle(records[i])));
+    }
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(derive_context_resource_handle(ctx)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
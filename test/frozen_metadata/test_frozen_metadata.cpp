@@ -0,0 +1,165 @@
+/**
+ * \file test/frozen_metadata/test_frozen_metadata.cpp
+ *
+ * \brief Unit tests for frozen_metadata.
+ */
+
+#include <minunit/minunit.h>
+#include <nepe2/error_codes.h>
+#include <nepe2/frozen_metadata.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "../test_record.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+TEST_SUITE(frozen_metadata);
+
+static const uint32_t ID = 100;
+
+/* the numeric fields all differ from the test record defaults. */
+static const test_record_fields FIELDS = {
+    .version = 7, .revocation_date = 200, .expiration_date = 300,
+    .password_length = 24, .generation = 3, .legacy_flag = true,
+    .kdf_cost = 210000 };
+
+/**
+ * A frozen record holds a copy of every field.
+ */
+TEST(freeze)
+{
+    allocator* alloc = nullptr;
+    metadata* meta = nullptr;
+    frozen_metadata* frozen = nullptr;
+    size_t size = 0U;
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* an empty record can't be frozen. */
+    TEST_ASSERT(STATUS_SUCCESS == metadata_create(&meta, alloc));
+    TEST_EXPECT(
+        ERROR_METADATA_FIELD_NOT_SET == metadata_freeze(&frozen, alloc, meta));
+    TEST_EXPECT(nullptr == frozen);
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(metadata_resource_handle(meta)));
+
+    /* a complete record can be frozen. */
+    TEST_ASSERT(STATUS_SUCCESS == test_record_create(&meta, alloc, ID, FIELDS));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_freeze(&frozen, alloc, meta));
+
+    /* changing the source record does not change the frozen record. */
+    TEST_ASSERT(STATUS_SUCCESS == metadata_generation_set(meta, 4));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_kdf_name_set(meta, "other"));
+
+    /* every field matches. */
+    uint8_t expected_hash_id[32];
+    test_hash_id_init(expected_hash_id, ID);
+    const void* hash_id = frozen_metadata_hash_id_get(&size, frozen);
+    TEST_ASSERT(sizeof(expected_hash_id) == size);
+    TEST_EXPECT(!memcmp(expected_hash_id, hash_id, size));
+    TEST_EXPECT(
+        !strcmp("pbkdf2-sha3-512", frozen_metadata_kdf_name_get(frozen)));
+    TEST_EXPECT(
+        !strcmp("0123456789abcdef", frozen_metadata_encoding_get(frozen)));
+    TEST_EXPECT(7 == frozen_metadata_version_get(frozen));
+    TEST_EXPECT(100 == frozen_metadata_creation_date_get(frozen));
+    TEST_EXPECT(200 == frozen_metadata_revocation_date_get(frozen));
+    TEST_EXPECT(300 == frozen_metadata_expiration_date_get(frozen));
+    TEST_EXPECT(24 == frozen_metadata_password_length_get(frozen));
+    TEST_EXPECT(3 == frozen_metadata_generation_get(frozen));
+    TEST_EXPECT(frozen_metadata_legacy_flag_get(frozen));
+    TEST_EXPECT(210000 == frozen_metadata_kdf_cost_get(frozen));
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(frozen_metadata_resource_handle(frozen)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(metadata_resource_handle(meta)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Threads can share a frozen record, and the last release reclaims it.
+ */
+TEST(shared)
+{
+    const int THREADS = 8;
+    const int ROUNDS = 1000;
+    allocator* alloc = nullptr;
+    metadata* meta = nullptr;
+    frozen_metadata* frozen = nullptr;
+    std::vector<std::thread> threads;
+    std::vector<int> mismatches(THREADS, 0);
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* freeze a record, and release the source. */
+    TEST_ASSERT(STATUS_SUCCESS == test_record_create(&meta, alloc, ID, FIELDS));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_freeze(&frozen, alloc, meta));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(metadata_resource_handle(meta)));
+
+    /* each thread gets its own reference, and reads without locks. */
+    for (int i = 0; i < THREADS; ++i)
+    {
+        frozen_metadata* ref = frozen_metadata_acquire(frozen);
+        threads.emplace_back([ref, i, &mismatches]() {
+            uint8_t expected_hash_id[32];
+            size_t size;
+
+            test_hash_id_init(expected_hash_id, ID);
+
+            for (int round = 0; round < ROUNDS; ++round)
+            {
+                frozen_metadata* local = frozen_metadata_acquire(ref);
+                const void* hash_id = frozen_metadata_hash_id_get(&size, local);
+                if (sizeof(expected_hash_id) != size
+                 || memcmp(expected_hash_id, hash_id, size)
+                 || 3 != frozen_metadata_generation_get(local))
+                {
+                    ++mismatches[i];
+                }
+
+                if (STATUS_SUCCESS
+                        != resource_release(
+                                frozen_metadata_resource_handle(local)))
+                {
+                    ++mismatches[i];
+                }
+            }
+
+            if (STATUS_SUCCESS
+                    != resource_release(frozen_metadata_resource_handle(ref)))
+            {
+                ++mismatches[i];
+            }
+        });
+    }
+
+    /* the original reference can be dropped while threads still read. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(frozen_metadata_resource_handle(frozen)));
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    /* every read saw the frozen values. */
+    for (int i = 0; i < THREADS; ++i)
+    {
+        TEST_EXPECT(0 == mismatches[i]);
+    }
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
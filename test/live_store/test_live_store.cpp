@@ -0,0 +1,313 @@
+/**
+ * \file test/live_store/test_live_store.cpp
+ *
+ * \brief Unit tests for live_store.
+ */
+
+#include <atomic>
+#include <minunit/minunit.h>
+#include <nepe2/error_codes.h>
+#include <nepe2/live_store.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "../test_record.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+TEST_SUITE(live_store);
+
+/**
+ * \brief Create a base store with the given number of generation 0 records.
+ */
+static status base_create(store** st, allocator* alloc, uint32_t count)
+{
+    status retval, release_retval;
+    secure_buffer* buffer = nullptr;
+    std::vector<uint8_t> image;
+
+    test_image_append_header(image);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        retval = test_image_append_record(image, alloc, i);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    retval = test_image_to_buffer(&buffer, alloc, image);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = store_create_from_buffer(st, alloc, buffer, 2);
+    release_retval = resource_release(secure_buffer_resource_handle(buffer));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Get the generation of the record with the given id, or -1 if it is
+ * not found.
+ */
+static int64_t generation_get(const live_store_snapshot* snap, uint32_t id)
+{
+    const metadata* meta = nullptr;
+    uint8_t hash_id[32];
+    uint32_t generation;
+
+    test_hash_id_init(hash_id, id);
+
+    if (STATUS_SUCCESS
+            != live_store_snapshot_lookup(&meta, snap, hash_id, sizeof(hash_id))
+     || STATUS_SUCCESS != metadata_generation_get(&generation, meta))
+    {
+        return -1;
+    }
+
+    return generation;
+}
+
+/**
+ * Verify that appended records shadow base records.
+ */
+TEST(append_lookup)
+{
+    allocator* alloc = nullptr;
+    store* base = nullptr;
+    live_store* ls = nullptr;
+    live_store_reader* reader = nullptr;
+    const live_store_snapshot* before;
+    const live_store_snapshot* after;
+    metadata* records[11];
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* we can create a live store over a base store. */
+    TEST_ASSERT(STATUS_SUCCESS == base_create(&base, alloc, 10));
+    TEST_ASSERT(STATUS_SUCCESS == live_store_create(&ls, alloc, base));
+    TEST_ASSERT(STATUS_SUCCESS == live_store_reader_create(&reader, ls));
+
+    /* the base records are visible. */
+    before = live_store_snapshot_get(reader);
+    TEST_EXPECT(0 == generation_get(before, 3));
+    TEST_EXPECT(-1 == generation_get(before, 10));
+
+    /* append new records and a new generation of a base record. */
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS == test_record_create(&records[i], alloc, 10 + i));
+    }
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == test_record_create(&records[10], alloc, 3, { .generation = 2 }));
+    TEST_ASSERT(STATUS_SUCCESS == live_store_append(ls, records, 11));
+
+    /* the old snapshot is unchanged. */
+    TEST_EXPECT(0 == generation_get(before, 3));
+    TEST_EXPECT(-1 == generation_get(before, 10));
+
+    /* the new snapshot sees the appended records. */
+    live_store_reader_quiescent(reader);
+    after = live_store_snapshot_get(reader);
+    TEST_EXPECT(before != after);
+    TEST_EXPECT(2 == generation_get(after, 3));
+    TEST_EXPECT(0 == generation_get(after, 4));
+    for (uint32_t i = 10; i < 20; ++i)
+    {
+        TEST_EXPECT(0 == generation_get(after, i));
+    }
+    TEST_EXPECT(-1 == generation_get(after, 20));
+
+    /* the old snapshot can now be reclaimed. */
+    TEST_ASSERT(STATUS_SUCCESS == live_store_synchronize(ls));
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(live_store_reader_resource_handle(reader)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(live_store_resource_handle(ls)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Verify that only the newest generation of a hash id is visible.
+ */
+TEST(newest_generation)
+{
+    allocator* alloc = nullptr;
+    store* base = nullptr;
+    live_store* ls = nullptr;
+    live_store_reader* reader = nullptr;
+    metadata* records[3];
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* we can create a live store over a base store. */
+    TEST_ASSERT(STATUS_SUCCESS == base_create(&base, alloc, 4));
+    TEST_ASSERT(STATUS_SUCCESS == live_store_create(&ls, alloc, base));
+    TEST_ASSERT(STATUS_SUCCESS == live_store_reader_create(&reader, ls));
+
+    /* a batch with generations out of order keeps the newest. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == test_record_create(&records[0], alloc, 7, { .generation = 1 }));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == test_record_create(&records[1], alloc, 7, { .generation = 3 }));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == test_record_create(&records[2], alloc, 7, { .generation = 2 }));
+    TEST_ASSERT(STATUS_SUCCESS == live_store_append(ls, records, 3));
+    live_store_reader_quiescent(reader);
+    TEST_EXPECT(3 == generation_get(live_store_snapshot_get(reader), 7));
+
+    /* an older generation in a later batch does not replace it. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == test_record_create(&records[0], alloc, 7, { .generation = 2 }));
+    TEST_ASSERT(STATUS_SUCCESS == live_store_append(ls, records, 1));
+    live_store_reader_quiescent(reader);
+    TEST_EXPECT(3 == generation_get(live_store_snapshot_get(reader), 7));
+
+    /* a newer generation does. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == test_record_create(&records[0], alloc, 7, { .generation = 4 }));
+    TEST_ASSERT(STATUS_SUCCESS == live_store_append(ls, records, 1));
+    live_store_reader_quiescent(reader);
+    TEST_EXPECT(4 == generation_get(live_store_snapshot_get(reader), 7));
+
+    /* an appended record can't roll back a base record. */
+    TEST_ASSERT(STATUS_SUCCESS == test_record_create(&records[0], alloc, 1));
+    TEST_ASSERT(STATUS_SUCCESS == live_store_append(ls, records, 1));
+    live_store_reader_quiescent(reader);
+    TEST_EXPECT(0 == generation_get(live_store_snapshot_get(reader), 1));
+
+    /* an offline reader does not hold up reclamation. */
+    live_store_reader_offline(reader);
+    TEST_ASSERT(STATUS_SUCCESS == live_store_synchronize(ls));
+    live_store_reader_online(reader);
+    TEST_EXPECT(4 == generation_get(live_store_snapshot_get(reader), 7));
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(live_store_reader_resource_handle(reader)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(live_store_resource_handle(ls)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Verify that readers see monotonic generations while a writer appends.
+ */
+TEST(concurrent_readers)
+{
+    const uint32_t GENERATIONS = 200;
+    const size_t READER_COUNT = 3;
+    allocator* alloc = nullptr;
+    store* base = nullptr;
+    live_store* ls = nullptr;
+    std::atomic<bool> writer_done(false);
+    std::atomic<size_t> errors(0);
+    std::vector<std::thread> readers;
+    metadata* records[2];
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* we can create a live store over a base store. */
+    TEST_ASSERT(STATUS_SUCCESS == base_create(&base, alloc, 16));
+    TEST_ASSERT(STATUS_SUCCESS == live_store_create(&ls, alloc, base));
+
+    /* start the readers. */
+    for (size_t i = 0; i < READER_COUNT; ++i)
+    {
+        readers.emplace_back([&]() {
+            live_store_reader* reader = nullptr;
+            int64_t last_generation = 0;
+
+            if (STATUS_SUCCESS != live_store_reader_create(&reader, ls))
+            {
+                ++errors;
+                return;
+            }
+
+            do
+            {
+                const live_store_snapshot* snap =
+                    live_store_snapshot_get(reader);
+
+                /* generations never go backwards. */
+                int64_t generation = generation_get(snap, 0);
+                if (generation < last_generation)
+                {
+                    ++errors;
+                }
+                last_generation = generation;
+
+                /* appended ids below the generation are visible. */
+                if (generation > 0
+                 && generation - 1 != generation_get(snap, 1000 + generation))
+                {
+                    ++errors;
+                }
+
+                live_store_reader_quiescent(reader);
+                std::this_thread::yield();
+            } while (!writer_done.load());
+
+            if (STATUS_SUCCESS
+                    != resource_release(
+                            live_store_reader_resource_handle(reader)))
+            {
+                ++errors;
+            }
+        });
+    }
+
+    /* append new generations while the readers run. */
+    for (uint32_t i = 1; i <= GENERATIONS; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == test_record_create(
+                        &records[0], alloc, 1000 + i, { .generation = i - 1 }));
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == test_record_create(
+                        &records[1], alloc, 0, { .generation = i }));
+        TEST_ASSERT(STATUS_SUCCESS == live_store_append(ls, records, 2));
+    }
+
+    writer_done = true;
+    for (auto& t : readers)
+    {
+        t.join();
+    }
+
+    TEST_EXPECT(0 == errors.load());
+    TEST_ASSERT(STATUS_SUCCESS == live_store_synchronize(ls));
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(live_store_resource_handle(ls)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
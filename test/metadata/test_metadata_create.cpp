@@ -8,6 +8,8 @@
 #include <nepe2/error_codes.h>
 #include <nepe2/metadata.h>
 #include <string.h>
+#include <unistd.h>
+#include <vector>
 
 RCPR_IMPORT_allocator;
 RCPR_IMPORT_resource;
@@ -398,6 +400,43 @@ TEST(metadata_generation_set_get)
         STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
 }
 
+/**
+ * We can set and get the kdf cost, which is optional.
+ */
+TEST(metadata_kdf_cost_set_get)
+{
+    const uint32_t KDF_COST = 600000;
+    allocator* alloc = nullptr;
+    metadata* meta = nullptr;
+    uint32_t kdf_cost = 1U;
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* we can successfully create a metadata instance. */
+    TEST_ASSERT(STATUS_SUCCESS == metadata_create(&meta, alloc));
+
+    /* a record without a kdf cost has a cost of zero. */
+    TEST_ASSERT(STATUS_SUCCESS == metadata_kdf_cost_get(&kdf_cost, meta));
+    TEST_EXPECT(0U == kdf_cost);
+
+    /* set the kdf cost. */
+    TEST_ASSERT(STATUS_SUCCESS == metadata_kdf_cost_set(meta, KDF_COST));
+
+    /* the kdf cost matches. */
+    TEST_ASSERT(STATUS_SUCCESS == metadata_kdf_cost_get(&kdf_cost, meta));
+    TEST_EXPECT(KDF_COST == kdf_cost);
+
+    /* the kdf cost does not make the record whole. */
+    TEST_EXPECT(metadata_empty_flag_get(meta));
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(metadata_resource_handle(meta)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
 /**
  * We can set and get the legacy flag.
  */
@@ -436,3 +475,530 @@ TEST(metadata_legacy_flag_set_get)
     TEST_ASSERT(
         STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
 }
+
+/**
+ * The move setters take ownership of their buffers without copying them.
+ */
+TEST(metadata_move_setters)
+{
+    const char* KDF_NAME = "pbkdf2-sha3-512";
+    const char* ENCODING = "0123456789abcdef";
+    allocator* alloc = nullptr;
+    metadata* meta = nullptr;
+    secure_buffer* hash_id = nullptr;
+    secure_buffer* kdf_name = nullptr;
+    secure_buffer* encoding = nullptr;
+    secure_buffer* bad = nullptr;
+    const void* hptr = nullptr;
+    const char* str = nullptr;
+    size_t size = 0U;
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* we can successfully create a metadata instance. */
+    TEST_ASSERT(STATUS_SUCCESS == metadata_create(&meta, alloc));
+
+    /* create the buffers to move. */
+    TEST_ASSERT(STATUS_SUCCESS == secure_buffer_create(&hash_id, alloc, 32));
+    memset(secure_buffer_data(&size, hash_id), 0x5a, 32);
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == secure_buffer_create(&kdf_name, alloc, strlen(KDF_NAME) + 1));
+    memcpy(secure_buffer_data(&size, kdf_name), KDF_NAME, strlen(KDF_NAME));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == secure_buffer_create(&encoding, alloc, strlen(ENCODING) + 1));
+    memcpy(secure_buffer_data(&size, encoding), ENCODING, strlen(ENCODING));
+
+    /* move the buffers into the record. */
+    TEST_ASSERT(STATUS_SUCCESS == metadata_hash_id_move(meta, hash_id));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_kdf_name_move(meta, kdf_name));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_encoding_move(meta, encoding));
+
+    /* the record uses the moved storage directly. */
+    TEST_ASSERT(STATUS_SUCCESS == metadata_hash_id_get(&hptr, &size, meta));
+    TEST_EXPECT(secure_buffer_data(&size, hash_id) == hptr);
+    TEST_ASSERT(STATUS_SUCCESS == metadata_kdf_name_get(&str, meta));
+    TEST_EXPECT(secure_buffer_data(&size, kdf_name) == str);
+    TEST_EXPECT(!strcmp(KDF_NAME, str));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_encoding_get(&str, meta));
+    TEST_EXPECT(!strcmp(ENCODING, str));
+
+    /* a buffer without a terminator is rejected and released. */
+    TEST_ASSERT(STATUS_SUCCESS == secure_buffer_create(&bad, alloc, 4));
+    memset(secure_buffer_data(&size, bad), 'a', 4);
+    TEST_EXPECT(
+        ERROR_METADATA_INVALID_STRING == metadata_kdf_name_move(meta, bad));
+
+    /* an unsupported encoding is rejected and released. */
+    TEST_ASSERT(STATUS_SUCCESS == secure_buffer_create(&bad, alloc, 4));
+    memcpy(secure_buffer_data(&size, bad), "abc", 3);
+    TEST_EXPECT(
+        ERROR_METADATA_BAD_ENCODING_LENGTH
+            == metadata_encoding_move(meta, bad));
+
+    /* the previous values are unchanged. */
+    TEST_ASSERT(STATUS_SUCCESS == metadata_kdf_name_get(&str, meta));
+    TEST_EXPECT(!strcmp(KDF_NAME, str));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_encoding_get(&str, meta));
+    TEST_EXPECT(!strcmp(ENCODING, str));
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(metadata_resource_handle(meta)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * A record serializes to the documented big-endian layout and back.
+ */
+TEST(metadata_serialization_layout)
+{
+    const uint8_t EXPECTED[] = {
+        0x00, 0x00, 0x00, 0x01,                         /* serial version */
+        0x00,                                           /* symbolic */
+        0x00, 0x00, 0x00, 0x02,                         /* version */
+        0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, /* creation */
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* revocation */
+        0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, /* expiration */
+        0x00, 0x00, 0x00, 0x14,                         /* password length */
+        0x00, 0x00, 0x01, 0x00,                         /* generation */
+        0x01,                                           /* legacy flag */
+        0x00, 0x00, 0x00, 0x02,                         /* hash id size */
+        0x00, 0x00, 0x00, 0x02,                         /* kdf name size */
+        0x00, 0x00, 0x00, 0x03,                         /* encoding size */
+        0xab, 0xcd,                                     /* hash id */
+        'k', 0x00,                                      /* kdf name */
+        '0', '1', 0x00 };                               /* encoding */
+    const uint8_t HASH_ID[] = { 0xab, 0xcd };
+    allocator* alloc = nullptr;
+    metadata* meta = nullptr;
+    metadata* copy = nullptr;
+    secure_buffer* buffer = nullptr;
+    const char* str = nullptr;
+    uint64_t expiration_date = 0U;
+    uint32_t generation = 0U;
+    bool legacy_flag = false;
+    size_t size = 0U;
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* create a record. */
+    TEST_ASSERT(STATUS_SUCCESS == metadata_create(&meta, alloc));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == metadata_hash_id_set(meta, HASH_ID, sizeof(HASH_ID)));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_version_set(meta, 2));
+    TEST_ASSERT(
+        STATUS_SUCCESS == metadata_creation_date_set(meta, 0x01020304));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_revocation_date_set(meta, 0));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == metadata_expiration_date_set(meta, 0x1122334455667788));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_password_length_set(meta, 20));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_generation_set(meta, 256));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_legacy_flag_set(meta, true));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_kdf_name_set(meta, "k"));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_encoding_set(meta, "01"));
+
+    /* the serialized record matches the expected layout. */
+    TEST_ASSERT(STATUS_SUCCESS == metadata_to_buffer(&buffer, alloc, meta));
+    const void* data = secure_buffer_data(&size, buffer);
+    TEST_ASSERT(sizeof(EXPECTED) == size);
+    TEST_EXPECT(!memcmp(EXPECTED, data, size));
+
+    /* the record reads back. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == metadata_from_data(&copy, alloc, EXPECTED, size));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == metadata_expiration_date_get(&expiration_date, copy));
+    TEST_EXPECT(0x1122334455667788 == expiration_date);
+    TEST_ASSERT(STATUS_SUCCESS == metadata_generation_get(&generation, copy));
+    TEST_EXPECT(256 == generation);
+    TEST_ASSERT(
+        STATUS_SUCCESS == metadata_legacy_flag_get(&legacy_flag, copy));
+    TEST_EXPECT(legacy_flag);
+    TEST_ASSERT(STATUS_SUCCESS == metadata_kdf_name_get(&str, copy));
+    TEST_EXPECT(!strcmp("k", str));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_encoding_get(&str, copy));
+    TEST_EXPECT(!strcmp("01", str));
+
+    /* truncated records are rejected. */
+    TEST_EXPECT(
+        ERROR_METADATA_INVALID_BUFFER_SIZE
+            == metadata_from_data(&copy, alloc, EXPECTED, 3));
+    TEST_EXPECT(
+        ERROR_METADATA_INVALID_BUFFER_SIZE
+            == metadata_from_data(&copy, alloc, EXPECTED, 40));
+    TEST_EXPECT(
+        ERROR_METADATA_INVALID_BUFFER_SIZE
+            == metadata_from_data(&copy, alloc, EXPECTED, size - 1));
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(metadata_resource_handle(copy)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(metadata_resource_handle(meta)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * A record with a kdf cost serializes to serial version 2, which appends the
+ * kdf cost to the serial version 1 header.
+ */
+TEST(metadata_serialization_layout_v2)
+{
+    const uint8_t EXPECTED[] = {
+        0x00, 0x00, 0x00, 0x02,                         /* serial version */
+        0x00,                                           /* symbolic */
+        0x00, 0x00, 0x00, 0x02,                         /* version */
+        0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, /* creation */
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* revocation */
+        0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, /* expiration */
+        0x00, 0x00, 0x00, 0x14,                         /* password length */
+        0x00, 0x00, 0x01, 0x00,                         /* generation */
+        0x01,                                           /* legacy flag */
+        0x00, 0x00, 0x00, 0x02,                         /* hash id size */
+        0x00, 0x00, 0x00, 0x02,                         /* kdf name size */
+        0x00, 0x00, 0x00, 0x03,                         /* encoding size */
+        0x00, 0x09, 0x27, 0xc0,                         /* kdf cost */
+        0xab, 0xcd,                                     /* hash id */
+        'k', 0x00,                                      /* kdf name */
+        '0', '1', 0x00 };                               /* encoding */
+    const uint8_t HASH_ID[] = { 0xab, 0xcd };
+    allocator* alloc = nullptr;
+    metadata* meta = nullptr;
+    metadata* copy = nullptr;
+    secure_buffer* buffer = nullptr;
+    struct iovec iov[METADATA_IOVEC_COUNT];
+    uint8_t scratch[METADATA_IOVEC_SCRATCH_SIZE];
+    const char* str = nullptr;
+    uint32_t kdf_cost = 0U;
+    size_t size = 0U;
+    size_t iov_size = 0U;
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* create a record with a kdf cost. */
+    TEST_ASSERT(STATUS_SUCCESS == metadata_create(&meta, alloc));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == metadata_hash_id_set(meta, HASH_ID, sizeof(HASH_ID)));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_version_set(meta, 2));
+    TEST_ASSERT(
+        STATUS_SUCCESS == metadata_creation_date_set(meta, 0x01020304));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_revocation_date_set(meta, 0));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == metadata_expiration_date_set(meta, 0x1122334455667788));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_password_length_set(meta, 20));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_generation_set(meta, 256));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_legacy_flag_set(meta, true));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_kdf_name_set(meta, "k"));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_encoding_set(meta, "01"));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_kdf_cost_set(meta, 600000));
+
+    /* the serialized record matches the expected layout. */
+    TEST_ASSERT(STATUS_SUCCESS == metadata_to_buffer(&buffer, alloc, meta));
+    const void* data = secure_buffer_data(&size, buffer);
+    TEST_ASSERT(sizeof(EXPECTED) == size);
+    TEST_EXPECT(!memcmp(EXPECTED, data, size));
+
+    /* the iovec header holds the larger header. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == metadata_to_iovec(iov, scratch, &iov_size, meta));
+    TEST_EXPECT(size == iov_size);
+    TEST_EXPECT(METADATA_IOVEC_SCRATCH_SIZE == iov[0].iov_len);
+    TEST_EXPECT(!memcmp(EXPECTED, iov[0].iov_base, iov[0].iov_len));
+
+    /* the record reads back with its kdf cost. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == metadata_from_data(&copy, alloc, EXPECTED, size));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_kdf_cost_get(&kdf_cost, copy));
+    TEST_EXPECT(600000 == kdf_cost);
+    TEST_ASSERT(STATUS_SUCCESS == metadata_encoding_get(&str, copy));
+    TEST_EXPECT(!strcmp("01", str));
+
+    /* a record cut off in the kdf cost is rejected. */
+    TEST_EXPECT(
+        ERROR_METADATA_INVALID_BUFFER_SIZE
+            == metadata_from_data(&copy, alloc, EXPECTED, 56));
+    TEST_EXPECT(
+        ERROR_METADATA_INVALID_BUFFER_SIZE
+            == metadata_from_data(&copy, alloc, EXPECTED, size - 1));
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(metadata_resource_handle(copy)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(metadata_resource_handle(meta)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Verify that a record described as an iovec array matches its serialized
+ * form, and that a framed batch can be written with writev.
+ */
+TEST(metadata_to_iovec)
+{
+    const uint8_t HASH_ID[] = { 0xab, 0xcd };
+    allocator* alloc = nullptr;
+    metadata* meta = nullptr;
+    metadata* empty = nullptr;
+    secure_buffer* buffer = nullptr;
+    struct iovec iov[2 * METADATA_IOVEC_COUNT];
+    uint8_t scratch[2 * METADATA_IOVEC_FRAMED_SCRATCH_SIZE];
+    uint8_t out[256];
+    const void* hash_id = nullptr;
+    const char* str = nullptr;
+    size_t hash_id_size = 0U;
+    size_t size = 0U;
+    size_t iov_size = 0U;
+    int fds[2];
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* create a record. */
+    TEST_ASSERT(STATUS_SUCCESS == metadata_create(&meta, alloc));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == metadata_hash_id_set(meta, HASH_ID, sizeof(HASH_ID)));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_version_set(meta, 2));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_creation_date_set(meta, 1));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_revocation_date_set(meta, 0));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_expiration_date_set(meta, 2));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_password_length_set(meta, 20));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_generation_set(meta, 3));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_legacy_flag_set(meta, false));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_kdf_name_set(meta, "k"));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_encoding_set(meta, "01"));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_to_buffer(&buffer, alloc, meta));
+    const void* data = secure_buffer_data(&size, buffer);
+
+    /* an empty record can't be described. */
+    TEST_ASSERT(STATUS_SUCCESS == metadata_create(&empty, alloc));
+    TEST_EXPECT(
+        ERROR_METADATA_FIELD_NOT_SET
+            == metadata_to_iovec(iov, scratch, &iov_size, empty));
+
+    /* the iovec entries concatenate to the serialized record. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == metadata_to_iovec(iov, scratch, &iov_size, meta));
+    TEST_ASSERT(size == iov_size);
+    uint8_t* optr = out;
+    for (size_t i = 0; i < METADATA_IOVEC_COUNT; ++i)
+    {
+        memcpy(optr, iov[i].iov_base, iov[i].iov_len);
+        optr += iov[i].iov_len;
+    }
+    TEST_ASSERT(size == (size_t)(optr - out));
+    TEST_EXPECT(!memcmp(data, out, size));
+
+    /* the variable length fields are not copied. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == metadata_hash_id_get(&hash_id, &hash_id_size, meta));
+    TEST_EXPECT(hash_id == iov[1].iov_base);
+    TEST_ASSERT(STATUS_SUCCESS == metadata_kdf_name_get(&str, meta));
+    TEST_EXPECT(str == iov[2].iov_base);
+
+    /* a framed batch is written with writev. */
+    const metadata* records[2] = { meta, meta };
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == metadata_to_iovec_batch(iov, scratch, &iov_size, records, 2));
+    TEST_ASSERT(2 * (4 + size) == iov_size);
+    TEST_ASSERT(0 == pipe(fds));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == metadata_iovec_write(fds[1], iov, 2 * METADATA_IOVEC_COUNT));
+    TEST_ASSERT(iov_size == (size_t)read(fds[0], out, sizeof(out)));
+    close(fds[0]);
+    close(fds[1]);
+
+    /* each record is preceded by its big-endian size. */
+    for (size_t i = 0; i < 2; ++i)
+    {
+        const uint8_t* rptr = out + i * (4 + size);
+        TEST_EXPECT(0 == rptr[0] && 0 == rptr[1] && 0 == rptr[2]);
+        TEST_EXPECT(size == rptr[3]);
+        TEST_EXPECT(!memcmp(data, rptr + 4, size));
+    }
+
+    /* writing to a closed descriptor fails. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == metadata_to_iovec(iov, scratch, &iov_size, meta));
+    TEST_EXPECT(
+        ERROR_METADATA_WRITE_FAILED
+            == metadata_iovec_write(fds[1], iov, METADATA_IOVEC_COUNT));
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(metadata_resource_handle(empty)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(metadata_resource_handle(meta)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Verify that a batch of record headers is checked, and that the first
+ * corrupt record is reported with the status that reading it would return.
+ */
+TEST(metadata_header_batch_check)
+{
+    const uint8_t RECORD[] = {
+        0x00, 0x00, 0x00, 0x01,                         /* serial version */
+        0x00,                                           /* symbolic */
+        0x00, 0x00, 0x00, 0x02,                         /* version */
+        0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, /* creation */
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* revocation */
+        0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, /* expiration */
+        0x00, 0x00, 0x00, 0x14,                         /* password length */
+        0x00, 0x00, 0x01, 0x00,                         /* generation */
+        0x01,                                           /* legacy flag */
+        0x00, 0x00, 0x00, 0x02,                         /* hash id size */
+        0x00, 0x00, 0x00, 0x02,                         /* kdf name size */
+        0x00, 0x00, 0x00, 0x03,                         /* encoding size */
+        0xab, 0xcd,                                     /* hash id */
+        'k', 0x00,                                      /* kdf name */
+        '0', '1', 0x00 };                               /* encoding */
+    const size_t COUNT = 11;
+    const size_t SYMBOLIC_OFFSET = 4;
+    const size_t ENCODING_SIZE_OFFSET = 53;
+    const size_t SIZES_END = 54;
+    std::vector<uint8_t> image;
+    std::vector<metadata_extent> extents;
+    size_t bad_index = 0U;
+
+    /* lay out a batch with whole groups and a tail. */
+    for (size_t i = 0; i < COUNT; ++i)
+    {
+        extents.push_back({ image.size(), sizeof(RECORD) });
+        image.insert(image.end(), RECORD, RECORD + sizeof(RECORD));
+    }
+
+    /* every header is valid. */
+    TEST_EXPECT(
+        STATUS_SUCCESS
+            == metadata_header_batch_check(
+                    &bad_index, image.data(), extents.data(), COUNT));
+    TEST_EXPECT(0U == bad_index);
+    TEST_EXPECT(
+        STATUS_SUCCESS
+            == metadata_header_batch_check(
+                    &bad_index, image.data(), extents.data(), 0));
+
+    /* each kind of corruption is found in a group and in the tail. */
+    for (size_t index : { (size_t)5, COUNT - 1 })
+    {
+        uint8_t* record = image.data() + extents[index].offset;
+
+        /* an unknown serial version. */
+        record[3] = 0x03;
+        TEST_EXPECT(
+            ERROR_METADATA_UNKNOWN_SERIAL_VERSION
+                == metadata_header_batch_check(
+                        &bad_index, image.data(), extents.data(), COUNT));
+        TEST_EXPECT(index == bad_index);
+        record[3] = 0x01;
+
+        /* sizes that don't add up to the record size. */
+        extents[index].size -= 1;
+        TEST_EXPECT(
+            ERROR_METADATA_INVALID_BUFFER_SIZE
+                == metadata_header_batch_check(
+                        &bad_index, image.data(), extents.data(), COUNT));
+        TEST_EXPECT(index == bad_index);
+
+        /* a record shorter than its header. */
+        extents[index].size = 40;
+        TEST_EXPECT(
+            ERROR_METADATA_INVALID_BUFFER_SIZE
+                == metadata_header_batch_check(
+                        &bad_index, image.data(), extents.data(), COUNT));
+        TEST_EXPECT(index == bad_index);
+        extents[index].size = sizeof(RECORD);
+
+        /* an unsupported alphabet size, with the record size adjusted. */
+        record[ENCODING_SIZE_OFFSET] = 0x04;
+        extents[index].size += 1;
+        TEST_EXPECT(
+            ERROR_METADATA_BAD_ENCODING_LENGTH
+                == metadata_header_batch_check(
+                        &bad_index, image.data(), extents.data(), COUNT));
+        TEST_EXPECT(index == bad_index);
+
+        /* a symbolic encoding that is too short for its prefix. */
+        record[SYMBOLIC_OFFSET] = 0x01;
+        TEST_EXPECT(
+            ERROR_METADATA_BAD_ENCODING_LENGTH
+                == metadata_header_batch_check(
+                        &bad_index, image.data(), extents.data(), COUNT));
+        TEST_EXPECT(index == bad_index);
+        record[SYMBOLIC_OFFSET] = 0x00;
+        record[ENCODING_SIZE_OFFSET] = 0x03;
+        extents[index].size -= 1;
+    }
+
+    /* the repaired batch is valid again. */
+    TEST_EXPECT(
+        STATUS_SUCCESS
+            == metadata_header_batch_check(
+                    &bad_index, image.data(), extents.data(), COUNT));
+
+    /* serial version 2 records, which carry a kdf cost, mix with serial
+     * version 1 records in a group and in the tail. */
+    std::vector<uint8_t> mixed;
+    std::vector<metadata_extent> mixed_extents;
+    for (size_t i = 0; i < COUNT; ++i)
+    {
+        size_t offset = mixed.size();
+
+        mixed.insert(mixed.end(), RECORD, RECORD + SIZES_END);
+        if (i & 1)
+        {
+            mixed[offset + 3] = 0x02;
+            mixed.insert(mixed.end(), { 0x00, 0x00, 0x04, 0x00 });
+        }
+        mixed.insert(mixed.end(), RECORD + SIZES_END, RECORD + sizeof(RECORD));
+        mixed_extents.push_back({ offset, mixed.size() - offset });
+    }
+
+    TEST_EXPECT(
+        STATUS_SUCCESS
+            == metadata_header_batch_check(
+                    &bad_index, mixed.data(), mixed_extents.data(), COUNT));
+
+    /* a serial version 2 record too short for its header is rejected. */
+    for (size_t index : { (size_t)5, COUNT - 2 })
+    {
+        size_t size = mixed_extents[index].size;
+
+        mixed_extents[index].size = SIZES_END + 2;
+        TEST_EXPECT(
+            ERROR_METADATA_INVALID_BUFFER_SIZE
+                == metadata_header_batch_check(
+                        &bad_index, mixed.data(), mixed_extents.data(),
+                        COUNT));
+        TEST_EXPECT(index == bad_index);
+        mixed_extents[index].size = size;
+    }
+}
@@ -0,0 +1,166 @@
+/**
+ * \file test/migration_view/test_migration_view.cpp
+ *
+ * \brief Unit tests for migration_view.
+ */
+
+#include <minunit/minunit.h>
+#include <nepe2/error_codes.h>
+#include <nepe2/migration_view.h>
+#include <string.h>
+#include <vector>
+
+#include "../test_record.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+TEST_SUITE(migration_view);
+
+/**
+ * \brief Create a layer holding the ids in [begin, end), tagged with the given
+ * version.
+ */
+static status layer_create(
+    store** st, allocator* alloc, uint32_t begin, uint32_t end,
+    uint32_t version)
+{
+    status retval, release_retval;
+    secure_buffer* buffer = nullptr;
+    std::vector<uint8_t> image;
+
+    test_image_append_header(image);
+
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        retval =
+            test_image_append_record(
+                image, alloc, i,
+                { .version = version, .legacy_flag = 0 == version });
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    retval = test_image_to_buffer(&buffer, alloc, image);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = store_create_from_buffer(st, alloc, buffer, 1);
+    release_retval = resource_release(secure_buffer_resource_handle(buffer));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * Verify that an empty migration view finds nothing.
+ */
+TEST(empty)
+{
+    allocator* alloc = nullptr;
+    migration_view* view = nullptr;
+    const metadata* meta = nullptr;
+    size_t layer = 99;
+    uint8_t hash_id[32];
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* we can create a migration view. */
+    TEST_ASSERT(STATUS_SUCCESS == migration_view_create(&view, alloc));
+    TEST_EXPECT(0 == migration_view_layer_count_get(view));
+
+    /* nothing is found. */
+    test_hash_id_init(hash_id, 1);
+    TEST_EXPECT(
+        ERROR_STORE_RECORD_NOT_FOUND
+            == migration_view_lookup(
+                    &meta, &layer, view, hash_id, sizeof(hash_id)));
+    TEST_EXPECT(nullptr == meta);
+    TEST_EXPECT(99 == layer);
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(migration_view_resource_handle(view)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Verify that a lookup resolves to the newest layer containing a hash id.
+ */
+TEST(newest_layer)
+{
+    allocator* alloc = nullptr;
+    migration_view* view = nullptr;
+    store* st = nullptr;
+    const metadata* meta = nullptr;
+    size_t layer;
+    uint32_t version;
+    uint8_t hash_id[32];
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+    TEST_ASSERT(STATUS_SUCCESS == migration_view_create(&view, alloc));
+
+    /* push a legacy layer, an older mode, and the newest mode. */
+    TEST_ASSERT(STATUS_SUCCESS == layer_create(&st, alloc, 0, 100, 0));
+    TEST_ASSERT(STATUS_SUCCESS == migration_view_layer_push(view, st));
+    TEST_ASSERT(STATUS_SUCCESS == layer_create(&st, alloc, 50, 150, 1));
+    TEST_ASSERT(STATUS_SUCCESS == migration_view_layer_push(view, st));
+    TEST_ASSERT(STATUS_SUCCESS == layer_create(&st, alloc, 100, 120, 2));
+    TEST_ASSERT(STATUS_SUCCESS == migration_view_layer_push(view, st));
+    TEST_EXPECT(3 == migration_view_layer_count_get(view));
+
+    /* each id resolves to the newest layer containing it. */
+    for (uint32_t i = 0; i < 150; ++i)
+    {
+        size_t expected_layer = (i < 50) ? 0 : (i < 100 || i >= 120) ? 1 : 2;
+
+        test_hash_id_init(hash_id, i);
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == migration_view_lookup(
+                        &meta, &layer, view, hash_id, sizeof(hash_id)));
+        TEST_EXPECT(expected_layer == layer);
+        TEST_ASSERT(STATUS_SUCCESS == metadata_version_get(&version, meta));
+        TEST_EXPECT(expected_layer == version);
+    }
+
+    /* an id in no layer is not found. */
+    test_hash_id_init(hash_id, 150);
+    TEST_EXPECT(
+        ERROR_STORE_RECORD_NOT_FOUND
+            == migration_view_lookup(
+                    &meta, &layer, view, hash_id, sizeof(hash_id)));
+
+    /* more layers than the initial capacity can be pushed. */
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS == layer_create(&st, alloc, 200 + i, 201 + i, 3));
+        TEST_ASSERT(STATUS_SUCCESS == migration_view_layer_push(view, st));
+    }
+    TEST_EXPECT(8 == migration_view_layer_count_get(view));
+    test_hash_id_init(hash_id, 202);
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == migration_view_lookup(
+                    &meta, &layer, view, hash_id, sizeof(hash_id)));
+    TEST_EXPECT(5 == layer);
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(migration_view_resource_handle(view)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
@@ -0,0 +1,222 @@
+/**
+ * \file test/perfect_hash/test_perfect_hash.cpp
+ *
+ * \brief Unit tests for perfect_hash.
+ */
+
+#include <minunit/minunit.h>
+#include <nepe2/error_codes.h>
+#include <nepe2/perfect_hash.h>
+#include <string.h>
+#include <vector>
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+TEST_SUITE(perfect_hash);
+
+/**
+ * \brief Get a well-mixed test key.
+ */
+static uint64_t test_key(uint64_t i)
+{
+    uint64_t z = i * UINT64_C(0x9e3779b97f4a7c15) + 12345;
+
+    z = (z ^ (z >> 33)) * UINT64_C(0xff51afd7ed558ccd);
+
+    return z ^ (z >> 33);
+}
+
+/**
+ * Verify that a perfect hash built over several partitions maps every key to
+ * its own slot, both before and after it is serialized.
+ */
+TEST(bijection)
+{
+    allocator* alloc = nullptr;
+    perfect_hash_builder* builder = nullptr;
+    perfect_hash* ph = nullptr;
+    secure_buffer* buffer = nullptr;
+    const size_t partition_count = 7;
+    const size_t key_count = 5000;
+    std::vector<std::vector<uint64_t>> partitions(partition_count);
+    std::vector<uint64_t> expected(key_count);
+    std::vector<bool> seen(key_count);
+    size_t size;
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* split the keys into partitions, leaving one partition empty. */
+    for (uint64_t i = 0; i < key_count; ++i)
+    {
+        uint64_t key = test_key(i);
+
+        if (3 != key % partition_count)
+        {
+            partitions[key % partition_count].push_back(key);
+        }
+    }
+
+    /* we can create a builder. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == perfect_hash_builder_create(&builder, alloc, partition_count));
+
+    /* emitting before every partition is added fails. */
+    TEST_EXPECT(
+        ERROR_PERFECT_HASH_BAD_PARTITION
+            == perfect_hash_builder_emit(&buffer, alloc, builder));
+
+    /* a key from another partition is rejected. */
+    uint64_t stray = partitions[1][0];
+    TEST_EXPECT(
+        ERROR_PERFECT_HASH_BAD_PARTITION
+            == perfect_hash_builder_partition_add(
+                    expected.data(), builder, &stray, 1));
+
+    /* each partition's slots follow those of the partitions before it. */
+    std::vector<uint64_t> keys;
+    size_t base = 0;
+    for (size_t p = 0; p < partition_count; ++p)
+    {
+        std::vector<uint64_t> slots(partitions[p].size());
+
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == perfect_hash_builder_partition_add(
+                        slots.data(), builder, partitions[p].data(),
+                        partitions[p].size()));
+
+        for (size_t i = 0; i < slots.size(); ++i)
+        {
+            TEST_ASSERT(slots[i] >= base);
+            TEST_ASSERT(slots[i] < base + slots.size());
+            TEST_EXPECT(!seen[slots[i]]);
+            seen[slots[i]] = true;
+            expected[keys.size()] = slots[i];
+            keys.push_back(partitions[p][i]);
+        }
+
+        base += slots.size();
+    }
+
+    /* there are no more partitions. */
+    TEST_EXPECT(
+        ERROR_PERFECT_HASH_BAD_PARTITION
+            == perfect_hash_builder_partition_add(
+                    nullptr, builder, nullptr, 0));
+
+    /* the function can be serialized and loaded. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == perfect_hash_builder_emit(&buffer, alloc, builder));
+    const uint8_t* data = (const uint8_t*)secure_buffer_data(&size, buffer);
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == perfect_hash_create_from_data(&ph, alloc, data, size));
+    TEST_EXPECT(keys.size() == perfect_hash_key_count_get(ph));
+
+    /* it uses a few bits per key. */
+    TEST_EXPECT(size * 8 < keys.size() * 4);
+
+    /* every key gets the slot the builder gave it. */
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        TEST_EXPECT(expected[i] == perfect_hash_lookup(ph, keys[i]));
+    }
+
+    /* a truncated or damaged image is rejected. */
+    perfect_hash* bad = nullptr;
+    std::vector<uint8_t> copy(data, data + size);
+    TEST_EXPECT(
+        ERROR_PERFECT_HASH_INVALID_FORMAT
+            == perfect_hash_create_from_data(
+                    &bad, alloc, copy.data(), copy.size() - 8));
+    copy[copy.size() - 1] ^= 0x01;
+    TEST_EXPECT(
+        ERROR_PERFECT_HASH_INVALID_FORMAT
+            == perfect_hash_create_from_data(
+                    &bad, alloc, copy.data(), copy.size()));
+    copy[copy.size() - 1] ^= 0x01;
+    copy[0] ^= 0x01;
+    TEST_EXPECT(
+        ERROR_PERFECT_HASH_INVALID_FORMAT
+            == perfect_hash_create_from_data(
+                    &bad, alloc, copy.data(), copy.size()));
+    TEST_EXPECT(nullptr == bad);
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(perfect_hash_resource_handle(ph)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(perfect_hash_builder_resource_handle(builder)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Verify that a repeated key fails its partition without changing the
+ * builder.
+ */
+TEST(repeated_key)
+{
+    allocator* alloc = nullptr;
+    perfect_hash_builder* builder = nullptr;
+    perfect_hash* ph = nullptr;
+    secure_buffer* buffer = nullptr;
+    uint64_t keys[] = { 2, 4, 6, 8, 4 };
+    uint64_t slots[5];
+    size_t size;
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+    TEST_ASSERT(
+        STATUS_SUCCESS == perfect_hash_builder_create(&builder, alloc, 2));
+
+    /* the repeated key cannot be separated. */
+    TEST_EXPECT(
+        ERROR_PERFECT_HASH_BUILD_FAILED
+            == perfect_hash_builder_partition_add(slots, builder, keys, 5));
+
+    /* the same partition can be added again without the repeat. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == perfect_hash_builder_partition_add(slots, builder, keys, 4));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == perfect_hash_builder_partition_add(slots, builder, nullptr, 0));
+    TEST_ASSERT(
+        STATUS_SUCCESS == perfect_hash_builder_emit(&buffer, alloc, builder));
+
+    const void* data = secure_buffer_data(&size, buffer);
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == perfect_hash_create_from_data(&ph, alloc, data, size));
+    TEST_EXPECT(4 == perfect_hash_key_count_get(ph));
+
+    bool seen[4] = { false, false, false, false };
+    for (size_t i = 0; i < 4; ++i)
+    {
+        uint64_t slot = perfect_hash_lookup(ph, keys[i]);
+
+        TEST_ASSERT(slot < 4);
+        TEST_EXPECT(!seen[slot]);
+        seen[slot] = true;
+    }
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(perfect_hash_resource_handle(ph)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(perfect_hash_builder_resource_handle(builder)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
@@ -5,8 +5,12 @@
  */
 
 #include <minunit/minunit.h>
+#include <nepe2/error_codes.h>
 #include <nepe2/secure_buffer.h>
 #include <rcpr/allocator.h>
+#include <string.h>
+#include <thread>
+#include <vector>
 
 RCPR_IMPORT_allocator;
 RCPR_IMPORT_resource;
@@ -51,3 +55,207 @@ TEST(basics)
     TEST_ASSERT(
         STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
 }
+
+/**
+ * A builder grows as bytes are appended, and finalizes without a copy.
+ */
+TEST(builder)
+{
+    allocator* alloc = nullptr;
+    secure_buffer_builder* builder = nullptr;
+    secure_buffer* buffer = nullptr;
+    void* region = nullptr;
+    size_t size = 0U;
+    uint8_t expected[1000];
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* we can create an empty builder. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == secure_buffer_builder_create(&builder, alloc, 0));
+    TEST_EXPECT(0 == secure_buffer_builder_size_get(builder));
+
+    /* an empty builder can't be finalized. */
+    TEST_EXPECT(
+        ERROR_SECURE_BUFFER_BUILDER_EMPTY
+            == secure_buffer_builder_finalize(&buffer, builder));
+
+    /* append enough small chunks to grow several times. */
+    for (size_t i = 0; i < sizeof(expected); ++i)
+    {
+        expected[i] = (uint8_t)(i * 7);
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == secure_buffer_builder_append(builder, &expected[i], 1));
+    }
+
+    /* extend the builder and write in place. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == secure_buffer_builder_extend(&region, builder, 4));
+    TEST_EXPECT(0 == memcmp(region, "\0\0\0\0", 4));
+    memcpy(region, "tail", 4);
+    TEST_EXPECT(1004 == secure_buffer_builder_size_get(builder));
+
+    /* finalizing hands the storage over. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == secure_buffer_builder_finalize(&buffer, builder));
+    TEST_EXPECT(0 == secure_buffer_builder_size_get(builder));
+    const uint8_t* data = (const uint8_t*)secure_buffer_data(&size, buffer);
+    TEST_ASSERT(1004 == size);
+    TEST_EXPECT(0 == memcmp(expected, data, sizeof(expected)));
+    TEST_EXPECT(0 == memcmp("tail", data + sizeof(expected), 4));
+    TEST_EXPECT((const uint8_t*)region == data + sizeof(expected));
+
+    /* the builder can be reused after it is finalized. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == secure_buffer_builder_reserve(builder, 16));
+    TEST_ASSERT(
+        STATUS_SUCCESS == secure_buffer_builder_append(builder, "x", 1));
+    TEST_EXPECT(1 == secure_buffer_builder_size_get(builder));
+
+    /* consuming from the front leaves the rest, and erases the tail. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == secure_buffer_builder_append(builder, "yz", 2));
+    secure_buffer_builder_consume(builder, 2);
+    const char* rest = (const char*)secure_buffer_builder_data(&size, builder);
+    TEST_ASSERT(1 == size);
+    TEST_EXPECT('z' == rest[0]);
+    TEST_EXPECT(0 == rest[1] && 0 == rest[2]);
+
+    /* truncating removes bytes from the end. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == secure_buffer_builder_append(builder, "ab", 2));
+    secure_buffer_builder_truncate(builder, 2);
+    TEST_EXPECT(2 == secure_buffer_builder_size_get(builder));
+    TEST_EXPECT('a' == rest[1] && 0 == rest[2]);
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(
+                    secure_buffer_builder_resource_handle(builder)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * A cache hands back erased blocks, and blocks flow between threads through
+ * its depot.
+ */
+TEST(cache)
+{
+    allocator* alloc = nullptr;
+    secure_buffer_cache* cache = nullptr;
+    secure_buffer_cache* second = nullptr;
+    secure_buffer* buffer = nullptr;
+    const size_t THREAD_COUNT = 8;
+    const size_t BUFFERS_PER_THREAD = 500;
+    std::vector<secure_buffer*> buffers(THREAD_COUNT * BUFFERS_PER_THREAD);
+    std::vector<status> results(THREAD_COUNT);
+    std::vector<std::thread> threads;
+    size_t size = 0U;
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* an allocator has at most one cache. */
+    TEST_ASSERT(STATUS_SUCCESS == secure_buffer_cache_create(&cache, alloc));
+    TEST_EXPECT(
+        ERROR_SECURE_BUFFER_CACHE_EXISTS
+            == secure_buffer_cache_create(&second, alloc));
+
+    /* a released block comes back erased. */
+    TEST_ASSERT(STATUS_SUCCESS == secure_buffer_create(&buffer, alloc, 100));
+    uint8_t* first = (uint8_t*)secure_buffer_data(&size, buffer);
+    TEST_ASSERT(100 == size);
+    memset(first, 0xa5, size);
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+    TEST_ASSERT(STATUS_SUCCESS == secure_buffer_create(&buffer, alloc, 100));
+    uint8_t* again = (uint8_t*)secure_buffer_data(&size, buffer);
+    TEST_EXPECT(first == again);
+    for (size_t i = 0; i < size; ++i)
+        TEST_ASSERT(0 == again[i]);
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+
+    /* large buffers bypass the cache. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == secure_buffer_create(&buffer, alloc, 100000));
+    TEST_ASSERT(nullptr != secure_buffer_data(&size, buffer));
+    TEST_EXPECT(100000 == size);
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+
+    /* every thread creates and fills its buffers, which this thread releases,
+     * and then a second round of threads reuses the blocks. */
+    for (int round = 0; round < 2; ++round)
+    {
+        threads.clear();
+        for (size_t t = 0; t < THREAD_COUNT; ++t)
+        {
+            threads.emplace_back([&, t]() {
+                results[t] = STATUS_SUCCESS;
+                for (size_t i = 0; i < BUFFERS_PER_THREAD; ++i)
+                {
+                    size_t buffer_size = 1 + (i * 37) % 3000;
+                    size_t actual = 0U;
+                    secure_buffer** out =
+                        &buffers[t * BUFFERS_PER_THREAD + i];
+
+                    status retval =
+                        secure_buffer_create(out, alloc, buffer_size);
+                    if (STATUS_SUCCESS != retval)
+                    {
+                        results[t] = retval;
+                        return;
+                    }
+
+                    uint8_t* data =
+                        (uint8_t*)secure_buffer_data(&actual, *out);
+                    for (size_t j = 0; j < actual; ++j)
+                    {
+                        if (0 != data[j])
+                        {
+                            results[t] = -1;
+                        }
+                    }
+
+                    memset(data, 0x5a, actual);
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        for (size_t t = 0; t < THREAD_COUNT; ++t)
+        {
+            TEST_EXPECT(STATUS_SUCCESS == results[t]);
+        }
+
+        for (auto* item : buffers)
+        {
+            TEST_ASSERT(nullptr != item);
+            TEST_ASSERT(
+                STATUS_SUCCESS
+                    == resource_release(secure_buffer_resource_handle(item)));
+        }
+    }
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_cache_resource_handle(cache)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
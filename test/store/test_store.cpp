@@ -0,0 +1,787 @@
+/**
+ * \file test/store/test_store.cpp
+ *
+ * \brief Unit tests for store.
+ */
+
+#include <minunit/minunit.h>
+#include <nepe2/error_codes.h>
+#include <nepe2/store.h>
+#include <string.h>
+#include <vector>
+
+#include "../../src/store/store_internal.h"
+#include "../test_record.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+TEST_SUITE(store);
+
+/**
+ * \brief Append a record whose password length and legacy flag vary with its
+ * id.
+ */
+static status append_record(
+    std::vector<uint8_t>& image, allocator* alloc, uint32_t id,
+    uint32_t generation, bool checksum = false)
+{
+    return
+        test_image_append_record(
+            image, alloc, id,
+            { .password_length = 16 + id % 8, .generation = generation,
+              .legacy_flag = 0 != (id & 1) },
+            checksum ? &store_crc32c : nullptr);
+}
+
+/**
+ * Verify that an empty store image can be loaded.
+ */
+TEST(empty)
+{
+    allocator* alloc = nullptr;
+    secure_buffer* buffer = nullptr;
+    store* st = nullptr;
+    const metadata* meta = nullptr;
+    std::vector<uint8_t> image;
+    const uint8_t hash_id[32] = { 0 };
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* build an empty image. */
+    test_image_append_header(image);
+    TEST_ASSERT(STATUS_SUCCESS == test_image_to_buffer(&buffer, alloc, image));
+
+    /* we can load this store. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == store_create_from_buffer(&st, alloc, buffer, 4));
+
+    /* the store is empty. */
+    TEST_EXPECT(0 == store_record_count_get(st));
+    TEST_EXPECT(
+        ERROR_STORE_RECORD_NOT_FOUND
+            == store_lookup(&meta, st, hash_id, sizeof(hash_id)));
+
+    /* clean up. */
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(store_resource_handle(st)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Verify that invalid store images are rejected.
+ */
+TEST(invalid_images)
+{
+    allocator* alloc = nullptr;
+    secure_buffer* buffer = nullptr;
+    store* st = nullptr;
+    std::vector<uint8_t> image;
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* a bad magic number is rejected. */
+    test_image_append_u32(image, 0x12345678);
+    test_image_append_u32(image, STORE_FORMAT_VERSION_1);
+    test_image_append_u32(image, 0);
+    test_image_append_u32(image, 0);
+    TEST_ASSERT(STATUS_SUCCESS == test_image_to_buffer(&buffer, alloc, image));
+    TEST_EXPECT(
+        ERROR_STORE_INVALID_HEADER
+            == store_create_from_buffer(&st, alloc, buffer, 1));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+
+    /* a truncated record is rejected. */
+    image.clear();
+    test_image_append_header(image);
+    TEST_ASSERT(STATUS_SUCCESS == append_record(image, alloc, 1, 0));
+    image.pop_back();
+    TEST_ASSERT(STATUS_SUCCESS == test_image_to_buffer(&buffer, alloc, image));
+    TEST_EXPECT(
+        ERROR_STORE_INVALID_RECORD_SIZE
+            == store_create_from_buffer(&st, alloc, buffer, 1));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+
+    /* a corrupt record is rejected, and partially loaded chunks are freed. */
+    image.clear();
+    test_image_append_header(image);
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        TEST_ASSERT(STATUS_SUCCESS == append_record(image, alloc, i, 0));
+    }
+    image[STORE_HEADER_SIZE + STORE_RECORD_PREFIX_SIZE + 3] = 0x77;
+    TEST_ASSERT(STATUS_SUCCESS == test_image_to_buffer(&buffer, alloc, image));
+    TEST_EXPECT(
+        ERROR_METADATA_UNKNOWN_SERIAL_VERSION
+            == store_create_from_buffer(&st, alloc, buffer, 4));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Verify that records loaded on multiple threads can all be found.
+ */
+TEST(parallel_load)
+{
+    const uint32_t RECORD_COUNT = 1000;
+    allocator* alloc = nullptr;
+    secure_buffer* buffer = nullptr;
+    store* st = nullptr;
+    const metadata* meta = nullptr;
+    std::vector<uint8_t> image;
+    uint8_t hash_id[32];
+    uint64_t creation_date;
+    uint32_t password_length;
+    const char* kdf_name;
+    const char* encoding;
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* build an image. */
+    test_image_append_header(image);
+    for (uint32_t i = 0; i < RECORD_COUNT; ++i)
+    {
+        TEST_ASSERT(STATUS_SUCCESS == append_record(image, alloc, i, 0));
+    }
+    TEST_ASSERT(STATUS_SUCCESS == test_image_to_buffer(&buffer, alloc, image));
+
+    /* we can load this store with several threads. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == store_create_from_buffer(&st, alloc, buffer, 7));
+    TEST_EXPECT(RECORD_COUNT == store_record_count_get(st));
+
+    /* every record can be found. */
+    for (uint32_t i = 0; i < RECORD_COUNT; ++i)
+    {
+        memset(hash_id, 0, sizeof(hash_id));
+        memcpy(hash_id, &i, sizeof(i));
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == store_lookup(&meta, st, hash_id, sizeof(hash_id)));
+        TEST_ASSERT(
+            STATUS_SUCCESS == metadata_creation_date_get(&creation_date, meta));
+        TEST_EXPECT(i == creation_date);
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == metadata_password_length_get(&password_length, meta));
+        TEST_EXPECT(16 + i % 8 == password_length);
+        TEST_ASSERT(STATUS_SUCCESS == metadata_kdf_name_get(&kdf_name, meta));
+        TEST_EXPECT(!strcmp("pbkdf2-sha3-512", kdf_name));
+        TEST_ASSERT(STATUS_SUCCESS == metadata_encoding_get(&encoding, meta));
+        TEST_EXPECT(!strcmp("0123456789abcdef", encoding));
+    }
+
+    /* an unknown hash id is not found. */
+    memset(hash_id, 0xff, sizeof(hash_id));
+    TEST_EXPECT(
+        ERROR_STORE_RECORD_NOT_FOUND
+            == store_lookup(&meta, st, hash_id, sizeof(hash_id)));
+
+    /* clean up. */
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(store_resource_handle(st)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Verify that the newest generation of a hash id is indexed.
+ */
+TEST(newest_generation)
+{
+    allocator* alloc = nullptr;
+    secure_buffer* buffer = nullptr;
+    store* st = nullptr;
+    const metadata* meta = nullptr;
+    std::vector<uint8_t> image;
+    uint8_t hash_id[32];
+    uint32_t id = 5;
+    uint32_t generation;
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* build an image with generations out of order. */
+    test_image_append_header(image);
+    TEST_ASSERT(STATUS_SUCCESS == append_record(image, alloc, id, 1));
+    TEST_ASSERT(STATUS_SUCCESS == append_record(image, alloc, id, 3));
+    TEST_ASSERT(STATUS_SUCCESS == append_record(image, alloc, id, 2));
+    TEST_ASSERT(STATUS_SUCCESS == test_image_to_buffer(&buffer, alloc, image));
+
+    /* we can load this store. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == store_create_from_buffer(&st, alloc, buffer, 3));
+    TEST_EXPECT(3 == store_record_count_get(st));
+
+    /* the newest generation is found. */
+    memset(hash_id, 0, sizeof(hash_id));
+    memcpy(hash_id, &id, sizeof(id));
+    TEST_ASSERT(
+        STATUS_SUCCESS == store_lookup(&meta, st, hash_id, sizeof(hash_id)));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_generation_get(&generation, meta));
+    TEST_EXPECT(3 == generation);
+
+    /* clean up. */
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(store_resource_handle(st)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Verify that every generation of a hash id can be walked newest first.
+ */
+TEST(history)
+{
+    allocator* alloc = nullptr;
+    secure_buffer* buffer = nullptr;
+    store* st = nullptr;
+    const metadata* meta = nullptr;
+    std::vector<uint8_t> image;
+    uint8_t hash_id[32];
+    uint32_t id = 5;
+    uint32_t other_id = 6;
+    uint32_t generation;
+    size_t cursor;
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* build an image with generations out of order, and a tie. */
+    test_image_append_header(image);
+    TEST_ASSERT(STATUS_SUCCESS == append_record(image, alloc, id, 1));
+    TEST_ASSERT(STATUS_SUCCESS == append_record(image, alloc, id, 3));
+    TEST_ASSERT(STATUS_SUCCESS == append_record(image, alloc, other_id, 0));
+    TEST_ASSERT(STATUS_SUCCESS == append_record(image, alloc, id, 2));
+    TEST_ASSERT(STATUS_SUCCESS == append_record(image, alloc, id, 3));
+    TEST_ASSERT(STATUS_SUCCESS == append_record(image, alloc, id, 0));
+    TEST_ASSERT(STATUS_SUCCESS == test_image_to_buffer(&buffer, alloc, image));
+
+    /* we can load this store. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == store_create_from_buffer(&st, alloc, buffer, 2));
+    TEST_EXPECT(6 == store_record_count_get(st));
+
+    /* the walk starts with the later of the two newest generations. */
+    memset(hash_id, 0, sizeof(hash_id));
+    memcpy(hash_id, &id, sizeof(id));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_lookup_history(
+                    &meta, &cursor, st, hash_id, sizeof(hash_id)));
+    TEST_EXPECT(store_record_get(st, 4) == meta);
+
+    /* the older generations follow in order. */
+    const size_t expected[] = { 1, 3, 0, 5 };
+    for (size_t expected_index : expected)
+    {
+        TEST_ASSERT(STATUS_SUCCESS == store_history_next(&meta, &cursor, st));
+        TEST_EXPECT(store_record_get(st, expected_index) == meta);
+    }
+    TEST_ASSERT(STATUS_SUCCESS == metadata_generation_get(&generation, meta));
+    TEST_EXPECT(0 == generation);
+    TEST_EXPECT(
+        ERROR_STORE_RECORD_NOT_FOUND
+            == store_history_next(&meta, &cursor, st));
+    TEST_EXPECT(store_record_get(st, 5) == meta);
+
+    /* a hash id with one generation has no history. */
+    memcpy(hash_id, &other_id, sizeof(other_id));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_lookup_history(
+                    &meta, &cursor, st, hash_id, sizeof(hash_id)));
+    TEST_EXPECT(store_record_get(st, 2) == meta);
+    TEST_EXPECT(
+        ERROR_STORE_RECORD_NOT_FOUND
+            == store_history_next(&meta, &cursor, st));
+
+    /* a missing hash id is not found. */
+    hash_id[0] = 0x7f;
+    TEST_EXPECT(
+        ERROR_STORE_RECORD_NOT_FOUND
+            == store_lookup_history(
+                    &meta, &cursor, st, hash_id, sizeof(hash_id)));
+
+    /* clean up. */
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(store_resource_handle(st)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Verify that a batch lookup finds the same records as single lookups.
+ */
+TEST(lookup_batch)
+{
+    allocator* alloc = nullptr;
+    secure_buffer* buffer = nullptr;
+    store* st = nullptr;
+    const metadata* meta = nullptr;
+    std::vector<uint8_t> image;
+    const uint32_t id_count = 100;
+    const uint32_t lookup_count = 150;
+    std::vector<uint8_t> hash_ids(lookup_count * 32);
+    std::vector<const void*> ids(lookup_count);
+    std::vector<size_t> sizes(lookup_count, 32);
+    std::vector<const metadata*> found(lookup_count);
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* build an image with a newer generation of every tenth id. */
+    test_image_append_header(image);
+    for (uint32_t i = 0; i < id_count; ++i)
+    {
+        TEST_ASSERT(STATUS_SUCCESS == append_record(image, alloc, i, 0));
+    }
+    for (uint32_t i = 0; i < id_count; i += 10)
+    {
+        TEST_ASSERT(STATUS_SUCCESS == append_record(image, alloc, i, 1));
+    }
+    TEST_ASSERT(STATUS_SUCCESS == test_image_to_buffer(&buffer, alloc, image));
+    TEST_ASSERT(
+        STATUS_SUCCESS == store_create_from_buffer(&st, alloc, buffer, 2));
+
+    /* look up every id, a few that are missing, and one that is too short. */
+    for (uint32_t i = 0; i < lookup_count; ++i)
+    {
+        memcpy(&hash_ids[i * 32], &i, sizeof(i));
+        ids[i] = &hash_ids[i * 32];
+    }
+    sizes[7] = 16;
+
+    /* nothing is found in an empty batch. */
+    TEST_EXPECT(0 == store_lookup_batch(nullptr, st, nullptr, nullptr, 0));
+
+    /* every entry matches a single lookup. */
+    TEST_EXPECT(
+        id_count - 1
+            == store_lookup_batch(
+                    found.data(), st, ids.data(), sizes.data(),
+                    lookup_count));
+    for (uint32_t i = 0; i < lookup_count; ++i)
+    {
+        if (i < id_count && 7 != i)
+        {
+            TEST_ASSERT(
+                STATUS_SUCCESS == store_lookup(&meta, st, ids[i], sizes[i]));
+            TEST_EXPECT(meta == found[i]);
+        }
+        else
+        {
+            TEST_EXPECT(nullptr == found[i]);
+        }
+    }
+
+    /* clean up. */
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(store_resource_handle(st)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * \brief Get the position of every generation of a hash id, newest first.
+ */
+static std::vector<size_t> history_positions(const store* st, uint32_t id)
+{
+    std::vector<size_t> positions;
+    const metadata* meta = nullptr;
+    uint8_t hash_id[32];
+    size_t cursor;
+    status retval;
+
+    memset(hash_id, 0, sizeof(hash_id));
+    memcpy(hash_id, &id, sizeof(id));
+    retval = store_lookup_history(&meta, &cursor, st, hash_id, sizeof(hash_id));
+    while (STATUS_SUCCESS == retval)
+    {
+        for (size_t i = 0; i < store_record_count_get(st); ++i)
+        {
+            if (store_record_get(st, i) == meta)
+            {
+                positions.push_back(i);
+                break;
+            }
+        }
+
+        retval = store_history_next(&meta, &cursor, st);
+    }
+
+    return positions;
+}
+
+/**
+ * Verify that a store loaded from an index snapshot only indexes the records
+ * appended since the snapshot, and that a snapshot that does not match the
+ * image is ignored.
+ */
+TEST(snapshot)
+{
+    allocator* alloc = nullptr;
+    secure_buffer* buffer = nullptr;
+    secure_buffer* snapshot = nullptr;
+    store* st = nullptr;
+    store* full = nullptr;
+    std::vector<uint8_t> image;
+    const uint32_t id_count = 100;
+    size_t size;
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* build an image with a few generation chains. */
+    test_image_append_header(image);
+    for (uint32_t i = 0; i < id_count; ++i)
+    {
+        TEST_ASSERT(STATUS_SUCCESS == append_record(image, alloc, i, 0));
+    }
+    TEST_ASSERT(STATUS_SUCCESS == append_record(image, alloc, 5, 2));
+    TEST_ASSERT(STATUS_SUCCESS == append_record(image, alloc, 5, 1));
+    TEST_ASSERT(STATUS_SUCCESS == append_record(image, alloc, 9, 1));
+    size_t covered = id_count + 3;
+
+    /* a store that was not loaded from a snapshot can write one. */
+    TEST_ASSERT(STATUS_SUCCESS == test_image_to_buffer(&buffer, alloc, image));
+    TEST_ASSERT(
+        STATUS_SUCCESS == store_create_from_buffer(&st, alloc, buffer, 2));
+    TEST_EXPECT(0 == store_snapshot_record_count_get(st));
+    TEST_ASSERT(STATUS_SUCCESS == store_snapshot_create(&snapshot, alloc, st));
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(store_resource_handle(st)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+
+    /* append enough records that the index grows. */
+    for (uint32_t i = id_count; i < 2 * id_count; ++i)
+    {
+        TEST_ASSERT(STATUS_SUCCESS == append_record(image, alloc, i, 0));
+    }
+    TEST_ASSERT(STATUS_SUCCESS == append_record(image, alloc, 5, 3));
+    TEST_ASSERT(STATUS_SUCCESS == append_record(image, alloc, 9, 0));
+    TEST_ASSERT(STATUS_SUCCESS == test_image_to_buffer(&buffer, alloc, image));
+
+    /* only the appended records are indexed, and every chain matches a full
+     * load. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_create_from_buffer_with_snapshot(
+                    &st, alloc, buffer, snapshot, 2, 0));
+    TEST_ASSERT(
+        STATUS_SUCCESS == store_create_from_buffer(&full, alloc, buffer, 2));
+    TEST_EXPECT(covered == store_snapshot_record_count_get(st));
+    TEST_EXPECT(
+        store_record_count_get(full) == store_record_count_get(st));
+    for (uint32_t i = 0; i < 2 * id_count + 1; ++i)
+    {
+        TEST_EXPECT(history_positions(full, i) == history_positions(st, i));
+    }
+    TEST_EXPECT(4 == history_positions(st, 5).size());
+    TEST_EXPECT(0 == history_positions(st, 2 * id_count).size());
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(store_resource_handle(st)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(store_resource_handle(full)));
+
+    /* a damaged snapshot is ignored. */
+    uint8_t* data = (uint8_t*)secure_buffer_data(&size, snapshot);
+    data[size - 1] ^= 0x01;
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_create_from_buffer_with_snapshot(
+                    &st, alloc, buffer, snapshot, 2, 0));
+    TEST_EXPECT(0 == store_snapshot_record_count_get(st));
+    TEST_EXPECT(3 == history_positions(st, 9).size());
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(store_resource_handle(st)));
+    data[size - 1] ^= 0x01;
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+
+    /* so is a snapshot of another generation of the image. */
+    image[15] = 1;
+    TEST_ASSERT(STATUS_SUCCESS == test_image_to_buffer(&buffer, alloc, image));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_create_from_buffer_with_snapshot(
+                    &st, alloc, buffer, snapshot, 2, 0));
+    TEST_EXPECT(0 == store_snapshot_record_count_get(st));
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(store_resource_handle(st)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+
+    /* and a snapshot with two entries for one chain, which leaves as many
+     * records unreached as the chain reaches twice. */
+    image[15] = 0;
+    TEST_ASSERT(STATUS_SUCCESS == test_image_to_buffer(&buffer, alloc, image));
+    data = (uint8_t*)secure_buffer_data(&size, snapshot);
+    std::vector<uint8_t> twice(data, data + size);
+    uint8_t* body = twice.data() + STORE_SNAPSHOT_HEADER_SIZE;
+    size_t capacity = (size - STORE_SNAPSHOT_HEADER_SIZE - covered * 8) / 16;
+    uint8_t* entry3 = nullptr;
+    uint8_t* entry7 = nullptr;
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        uint8_t* entry = body + 16 * i;
+        if (0 == memcmp(entry + 8, "\0\0\0\0\0\0\0\3", 8))
+        {
+            entry3 = entry;
+        }
+        else if (0 == memcmp(entry + 8, "\0\0\0\0\0\0\0\7", 8))
+        {
+            entry7 = entry;
+        }
+    }
+    TEST_ASSERT(nullptr != entry3 && nullptr != entry7);
+    memcpy(entry7, entry3, 16);
+    uint32_t body_crc =
+        htonl(
+            store_crc32c(
+                0, body, twice.size() - STORE_SNAPSHOT_HEADER_SIZE));
+    memcpy(twice.data() + 32, &body_crc, sizeof(body_crc));
+    secure_buffer* damaged = nullptr;
+    TEST_ASSERT(
+        STATUS_SUCCESS == test_image_to_buffer(&damaged, alloc, twice));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_create_from_buffer_with_snapshot(
+                    &st, alloc, buffer, damaged, 2, 0));
+    TEST_EXPECT(0 == store_snapshot_record_count_get(st));
+    TEST_EXPECT(1 == history_positions(st, 7).size());
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(store_resource_handle(st)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(damaged)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+
+    /* and a snapshot whose records were rewritten. */
+    std::vector<uint8_t> rewritten;
+    test_image_append_header(rewritten);
+    for (uint32_t i = 0; i < covered; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS == append_record(rewritten, alloc, i + 1, 0));
+    }
+    TEST_ASSERT(
+        STATUS_SUCCESS == test_image_to_buffer(&buffer, alloc, rewritten));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_create_from_buffer_with_snapshot(
+                    &st, alloc, buffer, snapshot, 2, 0));
+    TEST_EXPECT(0 == store_snapshot_record_count_get(st));
+    TEST_EXPECT(covered == store_record_count_get(st));
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(store_resource_handle(st)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(snapshot)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Verify that CRC32C checksums match known values, and that a store image
+ * with checksummed records is verified when it is loaded.
+ */
+TEST(checksums)
+{
+    const char* CHECK = "123456789";
+    allocator* alloc = nullptr;
+    secure_buffer* buffer = nullptr;
+    store* st = nullptr;
+    const metadata* meta = nullptr;
+    std::vector<uint8_t> image;
+    std::vector<uint8_t> pattern(4096 + 13);
+    uint8_t hash_id[32];
+    uint32_t id = 9;
+    size_t corrupt_offset = 0;
+
+    /* the standard check value matches. */
+    TEST_EXPECT(0xe3069283 == store_crc32c(0, CHECK, strlen(CHECK)));
+    TEST_EXPECT(0 == store_crc32c(0, CHECK, 0));
+
+    /* a long region matches the same region checksummed a piece at a time. */
+    for (size_t i = 0; i < pattern.size(); ++i)
+    {
+        pattern[i] = (uint8_t)(i * 31 + 7);
+    }
+    uint32_t crc = 0;
+    for (size_t i = 0; i < pattern.size(); i += 5)
+    {
+        size_t size = pattern.size() - i < 5 ? pattern.size() - i : 5;
+        crc = store_crc32c(crc, pattern.data() + i, size);
+    }
+    TEST_EXPECT(crc == store_crc32c(0, pattern.data(), pattern.size()));
+
+    /* the table fallback matches the check value, and the path chosen for
+     * this CPU. */
+    TEST_EXPECT(0xe3069283 == store_crc32c_table(0, CHECK, strlen(CHECK)));
+    TEST_EXPECT(
+        store_crc32c(0, pattern.data(), pattern.size())
+            == store_crc32c_table(0, pattern.data(), pattern.size()));
+    TEST_EXPECT(
+        store_crc32c(0x12345678, pattern.data() + 3, pattern.size() - 3)
+            == store_crc32c_table(
+                    0x12345678, pattern.data() + 3, pattern.size() - 3));
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* build an image with checksummed records. */
+    test_image_append_header(image, STORE_FLAG_CRC32C);
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        if (id == i)
+        {
+            corrupt_offset = image.size() + STORE_RECORD_PREFIX_SIZE + 100;
+        }
+
+        TEST_ASSERT(
+            STATUS_SUCCESS == append_record(image, alloc, i, 0, true));
+    }
+
+    /* it loads, and its records can be found. */
+    TEST_ASSERT(STATUS_SUCCESS == test_image_to_buffer(&buffer, alloc, image));
+    TEST_ASSERT(
+        STATUS_SUCCESS == store_create_from_buffer(&st, alloc, buffer, 4));
+    TEST_EXPECT(16 == store_record_count_get(st));
+    memset(hash_id, 0, sizeof(hash_id));
+    memcpy(hash_id, &id, sizeof(id));
+    TEST_EXPECT(
+        STATUS_SUCCESS == store_lookup(&meta, st, hash_id, sizeof(hash_id)));
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(store_resource_handle(st)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+
+    /* a flipped bit in a record body is found. */
+    image[corrupt_offset] ^= 0x04;
+    TEST_ASSERT(STATUS_SUCCESS == test_image_to_buffer(&buffer, alloc, image));
+    TEST_EXPECT(
+        ERROR_STORE_CHECKSUM_MISMATCH
+            == store_create_from_buffer(&st, alloc, buffer, 4));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+
+    /* an unknown flag is rejected. */
+    image.clear();
+    test_image_append_header(image, 0x80000000);
+    TEST_ASSERT(STATUS_SUCCESS == test_image_to_buffer(&buffer, alloc, image));
+    TEST_EXPECT(
+        ERROR_STORE_INVALID_HEADER
+            == store_create_from_buffer(&st, alloc, buffer, 1));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Verify that a store loaded into huge pages finds the same records, and
+ * reports how its tables are backed.
+ */
+TEST(huge_pages)
+{
+    allocator* alloc = nullptr;
+    secure_buffer* buffer = nullptr;
+    store* st = nullptr;
+    const metadata* meta = nullptr;
+    std::vector<uint8_t> image;
+    uint8_t hash_id[32];
+    uint32_t generation;
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* build an image with a history for one hash id. */
+    test_image_append_header(image);
+    for (uint32_t i = 0; i < 64; ++i)
+    {
+        TEST_ASSERT(STATUS_SUCCESS == append_record(image, alloc, i, 0));
+    }
+    TEST_ASSERT(STATUS_SUCCESS == append_record(image, alloc, 7, 2));
+    TEST_ASSERT(STATUS_SUCCESS == test_image_to_buffer(&buffer, alloc, image));
+
+    /* the default load uses the allocator. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == store_create_from_buffer(&st, alloc, buffer, 2));
+    TEST_EXPECT(STORE_PAGE_MODE_DEFAULT == store_page_mode_get(st));
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(store_resource_handle(st)));
+
+    for (uint32_t flags : {
+            STORE_LOAD_FLAG_HUGE_PAGES, STORE_LOAD_FLAG_HUGETLB })
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == store_create_from_buffer_with_flags(
+                        &st, alloc, buffer, 2, flags));
+
+        /* explicit huge pages are only used when asked for, and every mode
+         * falls back cleanly. */
+        int mode = store_page_mode_get(st);
+        TEST_EXPECT(
+            STORE_PAGE_MODE_DEFAULT == mode
+         || STORE_PAGE_MODE_TRANSPARENT == mode
+         || (STORE_PAGE_MODE_HUGETLB == mode
+                && STORE_LOAD_FLAG_HUGETLB == flags));
+
+        /* every record is found, and the history is kept. */
+        TEST_EXPECT(65 == store_record_count_get(st));
+        for (uint32_t i = 0; i < 64; ++i)
+        {
+            memset(hash_id, 0, sizeof(hash_id));
+            memcpy(hash_id, &i, sizeof(i));
+            TEST_ASSERT(
+                STATUS_SUCCESS
+                    == store_lookup(&meta, st, hash_id, sizeof(hash_id)));
+            TEST_ASSERT(
+                STATUS_SUCCESS == metadata_generation_get(&generation, meta));
+            TEST_EXPECT((7 == i ? 2U : 0U) == generation);
+        }
+
+        TEST_ASSERT(
+            STATUS_SUCCESS == resource_release(store_resource_handle(st)));
+    }
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(buffer)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
@@ -0,0 +1,762 @@
+/**
+ * \file test/store_file/test_store_file.cpp
+ *
+ * \brief Unit tests for store file.
+ */
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <minunit/minunit.h>
+#include <nepe2/error_codes.h>
+#include <nepe2/store_file.h>
+#include <string.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "../../src/store_file/store_file_internal.h"
+#include "../test_record.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+TEST_SUITE(store_file);
+
+static const uint32_t RECORD_COUNT = 8;
+
+/**
+ * Verify that each backend appends records and reads them back, with and
+ * without checksums.
+ */
+TEST(append_and_read)
+{
+    allocator* alloc = nullptr;
+    metadata* records[RECORD_COUNT];
+    const metadata* crecords[RECORD_COUNT];
+    store_file* sf = nullptr;
+    secure_buffer* image = nullptr;
+    store* st = nullptr;
+    const metadata* found;
+    const uint8_t* data;
+    uint64_t creation_date, offset;
+    uint32_t prefixes[RECORD_COUNT];
+    store_file_read_request requests[RECORD_COUNT];
+    uint8_t hash_id[32] = { 6 };
+    size_t size;
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    for (uint32_t i = 0; i < RECORD_COUNT; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS == test_record_create(&records[i], alloc, i));
+        crecords[i] = records[i];
+    }
+
+    for (uint32_t flags :
+            { 0, STORE_FILE_FLAG_IO_URING, STORE_FILE_FLAG_CRC32C,
+              STORE_FILE_FLAG_IO_URING | STORE_FILE_FLAG_CRC32C })
+    {
+        const bool checksummed = (flags & STORE_FILE_FLAG_CRC32C);
+        const size_t trailer_size =
+            checksummed ? STORE_RECORD_TRAILER_SIZE : 0;
+
+        std::string path =
+            "/tmp/nepe2-store-file-test-" + std::to_string(getpid()) + "-"
+            + std::to_string(flags) + ".img";
+
+        /* a new store file holds only a store header. */
+        unlink(path.c_str());
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == store_file_open(
+                        &sf, alloc, path.c_str(),
+                        STORE_FILE_FLAG_CREATE | flags));
+        TEST_EXPECT(STORE_HEADER_SIZE == store_file_size_get(sf));
+        TEST_EXPECT(
+            (checksummed ? STORE_FLAG_CRC32C : 0)
+                == store_file_header_flags_get(sf));
+        if (0 == flags)
+        {
+            TEST_EXPECT(
+                STORE_FILE_BACKEND_PREAD == store_file_backend_get(sf));
+        }
+
+        /* append a synced batch, then an unsynced one, then sync. */
+        TEST_ASSERT(
+            STATUS_SUCCESS == store_file_append(sf, crecords, 5, true));
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == store_file_append(
+                        sf, crecords + 5, RECORD_COUNT - 5, false));
+        TEST_ASSERT(STATUS_SUCCESS == store_file_sync(sf));
+        TEST_ASSERT(
+            STATUS_SUCCESS == store_file_append(sf, crecords, 0, true));
+
+        /* the image loads as a store. */
+        TEST_ASSERT(
+            STATUS_SUCCESS == store_file_image_read(&image, alloc, sf));
+        data = (const uint8_t*)secure_buffer_data(&size, image);
+        TEST_EXPECT(store_file_size_get(sf) == size);
+        TEST_ASSERT(
+            STATUS_SUCCESS == store_create_from_buffer(&st, alloc, image, 1));
+        TEST_EXPECT(RECORD_COUNT == store_record_count_get(st));
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == store_lookup(&found, st, hash_id, sizeof(hash_id)));
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == metadata_creation_date_get(&creation_date, found));
+        TEST_EXPECT(6 == creation_date);
+
+        /* every record prefix can be read in one batch. */
+        offset = STORE_HEADER_SIZE;
+        for (uint32_t i = 0; i < RECORD_COUNT; ++i)
+        {
+            uint32_t record_size;
+            memcpy(&record_size, data + offset, sizeof(record_size));
+
+            requests[i].offset = offset;
+            requests[i].size = sizeof(prefixes[i]);
+            requests[i].data = &prefixes[i];
+            offset +=
+                STORE_RECORD_PREFIX_SIZE + ntohl(record_size) + trailer_size;
+        }
+        TEST_EXPECT(store_file_size_get(sf) == offset);
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == store_file_read_batch(sf, requests, RECORD_COUNT));
+        for (uint32_t i = 1; i < RECORD_COUNT; ++i)
+        {
+            TEST_EXPECT(prefixes[0] == prefixes[i]);
+        }
+
+        /* a read past the end of the file fails. */
+        requests[0].offset = offset;
+        TEST_EXPECT(
+            ERROR_STORE_FILE_READ_FAILED
+                == store_file_read_batch(sf, requests, 1));
+
+        /* a reopened store file picks up where the last one left off, and
+         * keeps the header flags of its image. */
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == resource_release(store_file_resource_handle(sf)));
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == store_file_open(
+                        &sf, alloc, path.c_str(),
+                        flags & ~STORE_FILE_FLAG_CRC32C));
+        TEST_EXPECT(offset == store_file_size_get(sf));
+        TEST_EXPECT(
+            (checksummed ? STORE_FLAG_CRC32C : 0)
+                == store_file_header_flags_get(sf));
+
+        /* a compacted image keeps its checksums. */
+        if (checksummed)
+        {
+            store_file_compact_stats stats;
+            store_file_compact_options options = { 0, 0, 2, 0, 0 };
+            TEST_ASSERT(
+                STATUS_SUCCESS
+                    == store_file_compact(
+                            &stats, alloc, path.c_str(), &options));
+            TEST_EXPECT(RECORD_COUNT == stats.records_out);
+            TEST_EXPECT(offset == stats.bytes_out);
+        }
+
+        /* clean up this backend. */
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == resource_release(store_file_resource_handle(sf)));
+        TEST_ASSERT(
+            STATUS_SUCCESS == resource_release(store_resource_handle(st)));
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == resource_release(secure_buffer_resource_handle(image)));
+        unlink(path.c_str());
+    }
+
+    /* clean up. */
+    for (uint32_t i = 0; i < RECORD_COUNT; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == resource_release(metadata_resource_handle(records[i])));
+    }
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Verify that a failed ring is torn down, and that the append it was running
+ * is redone with the pread backend.
+ */
+TEST(uring_failure)
+{
+    const uint32_t RECORD_COUNT = 10;
+    allocator* alloc = nullptr;
+    store_file* sf = nullptr;
+    secure_buffer* image = nullptr;
+    store* st = nullptr;
+    metadata* records[RECORD_COUNT];
+    const metadata* crecords[RECORD_COUNT];
+
+    std::string path =
+        "/tmp/nepe2-store-file-uring-" + std::to_string(getpid()) + ".img";
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    for (uint32_t i = 0; i < RECORD_COUNT; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS == test_record_create(&records[i], alloc, i));
+        crecords[i] = records[i];
+    }
+
+    unlink(path.c_str());
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_file_open(
+                    &sf, alloc, path.c_str(),
+                    STORE_FILE_FLAG_CREATE | STORE_FILE_FLAG_IO_URING));
+
+    /* this only applies where io_uring is available. */
+    if (STORE_FILE_BACKEND_IO_URING == store_file_backend_get(sf))
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS == store_file_append(sf, crecords, 5, true));
+
+        /* io_uring_enter fails for a file that is not a ring. */
+        int ring_fd = sf->ring.fd;
+        sf->ring.fd = open("/dev/null", O_RDONLY);
+        TEST_ASSERT(sf->ring.fd >= 0);
+
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == store_file_append(
+                        sf, crecords + 5, RECORD_COUNT - 5, true));
+        TEST_EXPECT(STORE_FILE_BACKEND_PREAD == store_file_backend_get(sf));
+        TEST_EXPECT(STATUS_SUCCESS == store_file_sync(sf));
+        close(ring_fd);
+
+        /* every record was written once. */
+        TEST_ASSERT(
+            STATUS_SUCCESS == store_file_image_read(&image, alloc, sf));
+        TEST_ASSERT(
+            STATUS_SUCCESS == store_create_from_buffer(&st, alloc, image, 1));
+        TEST_EXPECT(RECORD_COUNT == store_record_count_get(st));
+
+        TEST_ASSERT(
+            STATUS_SUCCESS == resource_release(store_resource_handle(st)));
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == resource_release(secure_buffer_resource_handle(image)));
+    }
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(store_file_resource_handle(sf)));
+    unlink(path.c_str());
+    for (uint32_t i = 0; i < RECORD_COUNT; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == resource_release(metadata_resource_handle(records[i])));
+    }
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Verify that a store file must exist, and must have a valid header.
+ */
+TEST(bad_files)
+{
+    allocator* alloc = nullptr;
+    store_file* sf = nullptr;
+    int fd;
+
+    std::string path =
+        "/tmp/nepe2-store-file-bad-" + std::to_string(getpid()) + ".img";
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* a missing file is not created without the create flag. */
+    unlink(path.c_str());
+    TEST_EXPECT(
+        ERROR_STORE_FILE_OPEN_FAILED
+            == store_file_open(&sf, alloc, path.c_str(), 0));
+    TEST_EXPECT(nullptr == sf);
+
+    /* a file that is not a store image is rejected. */
+    fd = open(path.c_str(), O_WRONLY | O_CREAT, 0600);
+    TEST_ASSERT(fd >= 0);
+    TEST_ASSERT(16 == write(fd, "not a store file", 16));
+    close(fd);
+    TEST_EXPECT(
+        ERROR_STORE_INVALID_HEADER
+            == store_file_open(
+                    &sf, alloc, path.c_str(), STORE_FILE_FLAG_CREATE));
+    TEST_EXPECT(nullptr == sf);
+
+    /* clean up. */
+    unlink(path.c_str());
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Verify that compaction keeps only the newest generation of each hash id,
+ * drops revoked records after their retention window, and leaves readers of
+ * the original image unaffected.
+ */
+TEST(compact)
+{
+    allocator* alloc = nullptr;
+    std::vector<metadata*> records;
+    std::vector<const metadata*> crecords;
+    store_file* sf = nullptr;
+    store_file* reader = nullptr;
+    secure_buffer* image = nullptr;
+    store* st = nullptr;
+    const metadata* found;
+    store_file_compact_stats stats;
+    store_file_compact_options options;
+    uint64_t original_size;
+    uint32_t generation;
+    uint8_t hash_id[32] = { 0 };
+    size_t size;
+
+    std::string path =
+        "/tmp/nepe2-store-file-compact-" + std::to_string(getpid()) + ".img";
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* ten records, a new generation of the first five, and two revocations,
+     * one of which is past its retention window. */
+    records.resize(17);
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS == test_record_create(&records[i], alloc, i));
+    }
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == test_record_create(
+                        &records[10 + i], alloc, i, { .generation = 1 }));
+    }
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == test_record_create(
+                    &records[15], alloc, 7,
+                    { .revocation_date = 100, .generation = 2 }));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == test_record_create(
+                    &records[16], alloc, 8,
+                    { .revocation_date = 950, .generation = 2 }));
+    crecords.assign(records.begin(), records.end());
+
+    unlink(path.c_str());
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_file_open(
+                    &sf, alloc, path.c_str(), STORE_FILE_FLAG_CREATE));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_file_append(sf, crecords.data(), crecords.size(), true));
+    original_size = store_file_size_get(sf);
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(store_file_resource_handle(sf)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_file_open(&reader, alloc, path.c_str(), 0));
+
+    /* compact with a tiny memory budget, which forces several passes. */
+    options.now = 1000;
+    options.retention = 100;
+    options.thread_count = 3;
+    options.memory_limit = 1;
+    options.flags = 0;
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_file_compact(&stats, alloc, path.c_str(), &options));
+    TEST_EXPECT(17 == stats.records_in);
+    TEST_EXPECT(7 == stats.superseded);
+    TEST_EXPECT(1 == stats.revoked);
+    TEST_EXPECT(9 == stats.records_out);
+    TEST_EXPECT(original_size == stats.bytes_in);
+
+    /* the compacted image holds the live set. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == store_file_open(&sf, alloc, path.c_str(), 0));
+    TEST_EXPECT(stats.bytes_out == store_file_size_get(sf));
+    TEST_ASSERT(STATUS_SUCCESS == store_file_image_read(&image, alloc, sf));
+    TEST_ASSERT(
+        STATUS_SUCCESS == store_create_from_buffer(&st, alloc, image, 1));
+    TEST_EXPECT(9 == store_record_count_get(st));
+    hash_id[0] = 0;
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_lookup(&found, st, hash_id, sizeof(hash_id)));
+    TEST_ASSERT(STATUS_SUCCESS == metadata_generation_get(&generation, found));
+    TEST_EXPECT(1 == generation);
+    hash_id[0] = 7;
+    TEST_EXPECT(
+        ERROR_STORE_RECORD_NOT_FOUND
+            == store_lookup(&found, st, hash_id, sizeof(hash_id)));
+    hash_id[0] = 8;
+    TEST_EXPECT(
+        STATUS_SUCCESS
+            == store_lookup(&found, st, hash_id, sizeof(hash_id)));
+
+    /* a reader opened before the swap still sees the original image. */
+    TEST_EXPECT(original_size == store_file_size_get(reader));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(image)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == store_file_image_read(&image, alloc, reader));
+    secure_buffer_data(&size, image);
+    TEST_EXPECT(original_size == size);
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(image)));
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(store_resource_handle(st)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(store_file_resource_handle(sf)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(store_file_resource_handle(reader)));
+    for (auto record : records)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == resource_release(metadata_resource_handle(record)));
+    }
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+    unlink(path.c_str());
+}
+
+/**
+ * Verify that a compacted image with a perfect hash index is loaded with that
+ * index, and that appending to it drops the index.
+ */
+TEST(compact_perfect_hash)
+{
+    allocator* alloc = nullptr;
+    std::vector<metadata*> records;
+    std::vector<const metadata*> crecords;
+    store_file* sf = nullptr;
+    secure_buffer* image = nullptr;
+    store* st = nullptr;
+    const metadata* found;
+    store_file_compact_stats stats;
+    store_file_compact_options options = { 0, 0, 3, 1, 0 };
+    uint32_t generation;
+    size_t cursor, size;
+    uint8_t hash_id[32] = { 0 };
+    const uint32_t id_count = 500;
+
+    std::string path =
+        "/tmp/nepe2-store-file-mphf-" + std::to_string(getpid()) + ".img";
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    /* every id, with a newer generation of every tenth id. */
+    for (uint32_t i = 0; i < id_count; ++i)
+    {
+        records.push_back(nullptr);
+        TEST_ASSERT(
+            STATUS_SUCCESS == test_record_create(&records.back(), alloc, i));
+    }
+    for (uint32_t i = 0; i < id_count; i += 10)
+    {
+        records.push_back(nullptr);
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == test_record_create(
+                        &records.back(), alloc, i, { .generation = 1 }));
+    }
+    crecords.assign(records.begin(), records.end());
+
+    unlink(path.c_str());
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_file_open(
+                    &sf, alloc, path.c_str(),
+                    STORE_FILE_FLAG_CREATE | STORE_FILE_FLAG_CRC32C));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_file_append(sf, crecords.data(), crecords.size(), true));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(store_file_resource_handle(sf)));
+
+    /* compact in several passes, with a perfect hash index. */
+    options.flags = STORE_FILE_COMPACT_FLAG_PERFECT_HASH;
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_file_compact(&stats, alloc, path.c_str(), &options));
+    TEST_EXPECT(id_count == stats.records_out);
+    TEST_ASSERT(stats.index_size > STORE_INDEX_FOOTER_SIZE);
+
+    /* the store file reports the records, and reads the index with them. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == store_file_open(&sf, alloc, path.c_str(), 0));
+    TEST_EXPECT(
+        (STORE_FLAG_CRC32C | STORE_FLAG_PERFECT_HASH)
+            == store_file_header_flags_get(sf));
+    TEST_EXPECT(1 == store_file_generation_get(sf));
+    TEST_EXPECT(
+        stats.bytes_out - stats.index_size == store_file_size_get(sf));
+    TEST_ASSERT(STATUS_SUCCESS == store_file_image_read(&image, alloc, sf));
+    uint8_t* data = (uint8_t*)secure_buffer_data(&size, image);
+    TEST_EXPECT(stats.bytes_out == size);
+
+    /* every id is found through the perfect hash. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == store_create_from_buffer(&st, alloc, image, 2));
+    TEST_EXPECT(id_count == store_record_count_get(st));
+    for (uint32_t i = 0; i < id_count; ++i)
+    {
+        memcpy(hash_id, &i, sizeof(i));
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == store_lookup_history(
+                        &found, &cursor, st, hash_id, sizeof(hash_id)));
+        TEST_ASSERT(
+            STATUS_SUCCESS == metadata_generation_get(&generation, found));
+        TEST_EXPECT((0 == i % 10 ? 1U : 0U) == generation);
+        TEST_EXPECT(
+            ERROR_STORE_RECORD_NOT_FOUND
+                == store_history_next(&found, &cursor, st));
+    }
+    memcpy(hash_id, &id_count, sizeof(id_count));
+    TEST_EXPECT(
+        ERROR_STORE_RECORD_NOT_FOUND
+            == store_lookup(&found, st, hash_id, sizeof(hash_id)));
+
+    /* a batch lookup finds the same records. */
+    std::vector<uint8_t> hash_ids((id_count + 1) * 32);
+    std::vector<const void*> ids(id_count + 1);
+    std::vector<size_t> sizes(id_count + 1, 32);
+    std::vector<const metadata*> batch(id_count + 1);
+    for (uint32_t i = 0; i <= id_count; ++i)
+    {
+        memcpy(&hash_ids[i * 32], &i, sizeof(i));
+        ids[i] = &hash_ids[i * 32];
+    }
+    TEST_EXPECT(
+        id_count
+            == store_lookup_batch(
+                    batch.data(), st, ids.data(), sizes.data(), id_count + 1));
+    for (uint32_t i = 0; i < id_count; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS == store_lookup(&found, st, ids[i], sizes[i]));
+        TEST_EXPECT(found == batch[i]);
+    }
+    TEST_EXPECT(nullptr == batch[id_count]);
+
+    /* the perfect hash is already in the image, so there is no snapshot. */
+    secure_buffer* snapshot = nullptr;
+    TEST_EXPECT(
+        ERROR_STORE_SNAPSHOT_NOT_SUPPORTED
+            == store_snapshot_create(&snapshot, alloc, st));
+    TEST_EXPECT(nullptr == snapshot);
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(store_resource_handle(st)));
+
+    /* a damaged index is rejected. */
+    data[size - STORE_INDEX_FOOTER_SIZE - 1] ^= 0x01;
+    TEST_EXPECT(
+        ERROR_STORE_INVALID_INDEX
+            == store_create_from_buffer(&st, alloc, image, 1));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(image)));
+
+    /* appending drops the index. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == store_file_append(sf, crecords.data(), 1, true));
+    TEST_EXPECT(STORE_FLAG_CRC32C == store_file_header_flags_get(sf));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(store_file_resource_handle(sf)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == store_file_open(&sf, alloc, path.c_str(), 0));
+    TEST_EXPECT(STORE_FLAG_CRC32C == store_file_header_flags_get(sf));
+    TEST_ASSERT(STATUS_SUCCESS == store_file_image_read(&image, alloc, sf));
+    TEST_ASSERT(
+        STATUS_SUCCESS == store_create_from_buffer(&st, alloc, image, 1));
+    TEST_EXPECT(id_count + 1 == store_record_count_get(st));
+    memset(hash_id, 0, sizeof(hash_id));
+    hash_id[0] = 10;
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_lookup(&found, st, hash_id, sizeof(hash_id)));
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(image)));
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(store_resource_handle(st)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(store_file_resource_handle(sf)));
+    for (auto record : records)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == resource_release(metadata_resource_handle(record)));
+    }
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+    unlink(path.c_str());
+}
+
+/**
+ * Verify that an index snapshot survives a round trip through its sidecar, and
+ * that truncating the image makes the snapshot stale.
+ */
+TEST(snapshot_sidecar)
+{
+    allocator* alloc = nullptr;
+    metadata* records[RECORD_COUNT];
+    const metadata* crecords[RECORD_COUNT];
+    store_file* sf = nullptr;
+    secure_buffer* image = nullptr;
+    secure_buffer* snapshot = nullptr;
+    secure_buffer* sidecar = nullptr;
+    store* st = nullptr;
+    const void* data;
+    const void* sidecar_data;
+    size_t size, sidecar_size;
+
+    std::string path =
+        "/tmp/nepe2-store-file-snapshot-" + std::to_string(getpid()) + ".img";
+    std::string sidecar_path = path + STORE_FILE_SNAPSHOT_SUFFIX;
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    for (uint32_t i = 0; i < RECORD_COUNT; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS == test_record_create(&records[i], alloc, i));
+        crecords[i] = records[i];
+    }
+
+    /* a new image starts at generation 0, and has no sidecar. */
+    unlink(path.c_str());
+    unlink(sidecar_path.c_str());
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_file_open(
+                    &sf, alloc, path.c_str(), STORE_FILE_FLAG_CREATE));
+    TEST_EXPECT(0 == store_file_generation_get(sf));
+    TEST_EXPECT(
+        ERROR_STORE_FILE_OPEN_FAILED
+            == store_file_snapshot_read(&sidecar, alloc, path.c_str()));
+    TEST_EXPECT(nullptr == sidecar);
+
+    /* write a snapshot of half of the records. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_file_append(sf, crecords, RECORD_COUNT / 2, true));
+    TEST_ASSERT(STATUS_SUCCESS == store_file_image_read(&image, alloc, sf));
+    uint64_t half_size = store_file_size_get(sf);
+    TEST_ASSERT(
+        STATUS_SUCCESS == store_create_from_buffer(&st, alloc, image, 1));
+    TEST_ASSERT(STATUS_SUCCESS == store_snapshot_create(&snapshot, alloc, st));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_file_snapshot_write(alloc, path.c_str(), snapshot));
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(store_resource_handle(st)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(image)));
+
+    /* the sidecar holds the same snapshot. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_file_snapshot_read(&sidecar, alloc, path.c_str()));
+    data = secure_buffer_data(&size, snapshot);
+    sidecar_data = secure_buffer_data(&sidecar_size, sidecar);
+    TEST_ASSERT(size == sidecar_size);
+    TEST_EXPECT(0 == memcmp(data, sidecar_data, size));
+    TEST_EXPECT(0 != access((sidecar_path + ".tmp").c_str(), F_OK));
+
+    /* appends keep the generation, so only the new records are indexed. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_file_append(
+                    sf, crecords + RECORD_COUNT / 2,
+                    RECORD_COUNT - RECORD_COUNT / 2, true));
+    TEST_EXPECT(0 == store_file_generation_get(sf));
+    TEST_ASSERT(STATUS_SUCCESS == store_file_image_read(&image, alloc, sf));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_create_from_buffer_with_snapshot(
+                    &st, alloc, image, sidecar, 1, 0));
+    TEST_EXPECT(RECORD_COUNT == store_record_count_get(st));
+    TEST_EXPECT(RECORD_COUNT / 2 == store_snapshot_record_count_get(st));
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(store_resource_handle(st)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(image)));
+
+    /* a truncate starts a new generation, which the snapshot does not
+     * match, even once the records are appended again. */
+    TEST_ASSERT(STATUS_SUCCESS == store_file_truncate(sf, half_size));
+    TEST_EXPECT(1 == store_file_generation_get(sf));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_file_append(
+                    sf, crecords + RECORD_COUNT / 2,
+                    RECORD_COUNT - RECORD_COUNT / 2, true));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(store_file_resource_handle(sf)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == store_file_open(&sf, alloc, path.c_str(), 0));
+    TEST_EXPECT(1 == store_file_generation_get(sf));
+    TEST_ASSERT(STATUS_SUCCESS == store_file_image_read(&image, alloc, sf));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_create_from_buffer_with_snapshot(
+                    &st, alloc, image, sidecar, 1, 0));
+    TEST_EXPECT(RECORD_COUNT == store_record_count_get(st));
+    TEST_EXPECT(0 == store_snapshot_record_count_get(st));
+
+    /* clean up. */
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(store_resource_handle(st)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(image)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(sidecar)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(secure_buffer_resource_handle(snapshot)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(store_file_resource_handle(sf)));
+    for (uint32_t i = 0; i < RECORD_COUNT; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == resource_release(metadata_resource_handle(records[i])));
+    }
+    unlink(path.c_str());
+    unlink(sidecar_path.c_str());
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
@@ -0,0 +1,215 @@
+/**
+ * \file test/test_record.h
+ *
+ * \brief Record and store image fixtures shared by the unit tests.
+ */
+
+#pragma once
+
+#include <arpa/inet.h>
+#include <nepe2/metadata.h>
+#include <nepe2/store.h>
+#include <string.h>
+#include <vector>
+
+/**
+ * \brief The fields of a test record that are not derived from its id.
+ *
+ * Tests set only the fields they care about, in declaration order, e.g.
+ * { .generation = 2, .password_length = 20 }.
+ */
+struct test_record_fields
+{
+    uint32_t version = 1;
+    uint64_t revocation_date = 0;
+    uint64_t expiration_date = 0;
+    uint32_t password_length = 16;
+    uint32_t generation = 0;
+    bool legacy_flag = false;
+    const char* kdf_name = "pbkdf2-sha3-512";
+    const char* encoding = "0123456789abcdef";
+    uint32_t kdf_cost = 0;
+};
+
+/**
+ * \brief Set the 32 byte hash id for the given test id.
+ */
+inline void test_hash_id_init(uint8_t* hash_id, uint32_t id)
+{
+    memset(hash_id, 0, 32);
+    memcpy(hash_id, &id, sizeof(id));
+}
+
+/**
+ * \brief Create a complete record for the given test id, whose hash id is set
+ * by \ref test_hash_id_init and whose creation date is the id.
+ */
+inline status test_record_create(
+    metadata** meta, RCPR_SYM(allocator)* alloc, uint32_t id,
+    const test_record_fields& fields = {})
+{
+    status retval, release_retval;
+    metadata* tmp = nullptr;
+    uint8_t hash_id[32];
+
+    test_hash_id_init(hash_id, id);
+
+    retval = metadata_create(&tmp, alloc);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    if (STATUS_SUCCESS
+            != (retval = metadata_hash_id_set(tmp, hash_id, sizeof(hash_id)))
+     || STATUS_SUCCESS
+            != (retval = metadata_version_set(tmp, fields.version))
+     || STATUS_SUCCESS != (retval = metadata_creation_date_set(tmp, id))
+     || STATUS_SUCCESS
+            != (retval =
+                    metadata_revocation_date_set(
+                        tmp, fields.revocation_date))
+     || STATUS_SUCCESS
+            != (retval =
+                    metadata_expiration_date_set(
+                        tmp, fields.expiration_date))
+     || STATUS_SUCCESS
+            != (retval =
+                    metadata_password_length_set(
+                        tmp, fields.password_length))
+     || STATUS_SUCCESS
+            != (retval = metadata_generation_set(tmp, fields.generation))
+     || STATUS_SUCCESS
+            != (retval = metadata_legacy_flag_set(tmp, fields.legacy_flag))
+     || STATUS_SUCCESS
+            != (retval = metadata_kdf_name_set(tmp, fields.kdf_name))
+     || STATUS_SUCCESS
+            != (retval = metadata_encoding_set(tmp, fields.encoding))
+     || STATUS_SUCCESS
+            != (retval = metadata_kdf_cost_set(tmp, fields.kdf_cost)))
+    {
+        goto cleanup_tmp;
+    }
+
+    *meta = tmp;
+    return STATUS_SUCCESS;
+
+cleanup_tmp:
+    release_retval =
+        RCPR_SYM(resource_release)(metadata_resource_handle(tmp));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief A checksum appended after each record of a checksummed image, e.g.
+ * \ref store_crc32c.
+ */
+typedef uint32_t (*test_image_checksum)(uint32_t, const void*, size_t);
+
+/**
+ * \brief Append a big-endian 32-bit value to an image.
+ */
+inline void test_image_append_u32(std::vector<uint8_t>& image, uint32_t value)
+{
+    uint32_t net_value = htonl(value);
+    const uint8_t* bptr = (const uint8_t*)&net_value;
+
+    image.insert(image.end(), bptr, bptr + sizeof(net_value));
+}
+
+/**
+ * \brief Append a store header to an image.
+ */
+inline void test_image_append_header(
+    std::vector<uint8_t>& image, uint32_t flags = 0, uint32_t generation = 0)
+{
+    test_image_append_u32(image, STORE_MAGIC);
+    test_image_append_u32(image, STORE_FORMAT_VERSION_1);
+    test_image_append_u32(image, flags);
+    test_image_append_u32(image, generation);
+}
+
+/**
+ * \brief Append a serialized record to an image, followed by its checksum if
+ * \p checksum is set.
+ */
+inline status test_image_append_metadata(
+    std::vector<uint8_t>& image, RCPR_SYM(allocator)* alloc,
+    const metadata* meta, test_image_checksum checksum = nullptr)
+{
+    status retval;
+    secure_buffer* buffer = nullptr;
+    const uint8_t* data;
+    size_t size;
+
+    retval = metadata_to_buffer(&buffer, alloc, meta);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    data = (const uint8_t*)secure_buffer_data(&size, buffer);
+    test_image_append_u32(image, size);
+    image.insert(image.end(), data, data + size);
+    if (nullptr != checksum)
+    {
+        test_image_append_u32(image, checksum(0, data, size));
+    }
+
+    return RCPR_SYM(resource_release)(secure_buffer_resource_handle(buffer));
+}
+
+/**
+ * \brief Append the record created by \ref test_record_create to an image.
+ */
+inline status test_image_append_record(
+    std::vector<uint8_t>& image, RCPR_SYM(allocator)* alloc, uint32_t id,
+    const test_record_fields& fields = {},
+    test_image_checksum checksum = nullptr)
+{
+    status retval, release_retval;
+    metadata* meta = nullptr;
+
+    retval = test_record_create(&meta, alloc, id, fields);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = test_image_append_metadata(image, alloc, meta, checksum);
+
+    release_retval =
+        RCPR_SYM(resource_release)(metadata_resource_handle(meta));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Copy an image into a new secure buffer.
+ */
+inline status test_image_to_buffer(
+    secure_buffer** buffer, RCPR_SYM(allocator)* alloc,
+    const std::vector<uint8_t>& image)
+{
+    status retval;
+    size_t size;
+
+    retval = secure_buffer_create(buffer, alloc, image.size());
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    memcpy(secure_buffer_data(&size, *buffer), image.data(), image.size());
+
+    return STATUS_SUCCESS;
+}
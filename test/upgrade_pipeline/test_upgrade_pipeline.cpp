@@ -0,0 +1,409 @@
+/**
+ * \file test/upgrade_pipeline/test_upgrade_pipeline.cpp
+ *
+ * \brief Unit tests for upgrade_pipeline.
+ */
+
+#include <atomic>
+#include <minunit/minunit.h>
+#include <nepe2/error_codes.h>
+#include <nepe2/upgrade_pipeline.h>
+#include <set>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "../test_record.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+TEST_SUITE(upgrade_pipeline);
+
+/**
+ * \brief Load a store from an image.
+ */
+static status image_load(
+    store** st, allocator* alloc, const std::vector<uint8_t>& image)
+{
+    status retval, release_retval;
+    secure_buffer* buffer = nullptr;
+
+    retval = test_image_to_buffer(&buffer, alloc, image);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = store_create_from_buffer(st, alloc, buffer, 1);
+    release_retval = resource_release(secure_buffer_resource_handle(buffer));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Create a layer holding the ids in [begin, end) with the given version.
+ */
+static status layer_create(
+    store** st, allocator* alloc, uint32_t begin, uint32_t end,
+    uint32_t version)
+{
+    status retval;
+    std::vector<uint8_t> image;
+
+    test_image_append_header(image);
+
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        retval =
+            test_image_append_record(
+                image, alloc, i,
+                { .version = version, .legacy_flag = 0 == version });
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    return image_load(st, alloc, image);
+}
+
+/**
+ * \brief Build a view with a legacy layer and an older mode layer.
+ */
+static status view_create(migration_view** view, allocator* alloc)
+{
+    status retval;
+    store* st = nullptr;
+
+    retval = migration_view_create(view, alloc);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    if (STATUS_SUCCESS != (retval = layer_create(&st, alloc, 0, 100, 0))
+     || STATUS_SUCCESS != (retval = migration_view_layer_push(*view, st))
+     || STATUS_SUCCESS != (retval = layer_create(&st, alloc, 50, 150, 1))
+     || STATUS_SUCCESS != (retval = migration_view_layer_push(*view, st)))
+    {
+        return retval;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Test context shared with the pipeline callbacks.
+ */
+struct test_context
+{
+    allocator* alloc;
+    std::vector<uint8_t> image;
+    upgrade_checkpoint checkpoint;
+    size_t emit_limit;
+    std::atomic<bool> gate;
+};
+
+/**
+ * \brief Derive a fake password from the creation date of the old record.
+ */
+static status derive_old(
+    void* context, secure_buffer** password, allocator* alloc,
+    const metadata* old_record)
+{
+    test_context* ctx = (test_context*)context;
+    status retval;
+    uint64_t creation_date;
+    size_t size;
+
+    /* wait until the test opens the gate. */
+    while (!ctx->gate.load())
+    {
+        std::this_thread::yield();
+    }
+
+    retval = metadata_creation_date_get(&creation_date, old_record);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = secure_buffer_create(password, alloc, sizeof(creation_date));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    memcpy(
+        secure_buffer_data(&size, *password), &creation_date,
+        sizeof(creation_date));
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Build a version 2 record for the fake password.
+ */
+static status derive_new(
+    void*, metadata** new_record, allocator* alloc, const metadata*,
+    const secure_buffer* password)
+{
+    uint64_t creation_date;
+    size_t size;
+
+    memcpy(
+        &creation_date,
+        secure_buffer_data(&size, (secure_buffer*)password),
+        sizeof(creation_date));
+
+    return
+        test_record_create(
+            new_record, alloc, (uint32_t)creation_date, { .version = 2 });
+}
+
+/**
+ * \brief Append a frame to the output image, up to the emit limit.
+ */
+static status emit(
+    void* context, const void* frame, size_t frame_size,
+    const upgrade_checkpoint* next)
+{
+    test_context* ctx = (test_context*)context;
+    const uint8_t* bframe = (const uint8_t*)frame;
+
+    if (0 == ctx->emit_limit)
+    {
+        return ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    --ctx->emit_limit;
+    ctx->image.insert(ctx->image.end(), bframe, bframe + frame_size);
+    ctx->checkpoint = *next;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Initialize pipeline options for the test context.
+ */
+static void options_init(
+    upgrade_pipeline_options* options, const migration_view* view,
+    test_context* ctx)
+{
+    memset(options, 0, sizeof(*options));
+    options->view = view;
+    options->target_layer = 2;
+    options->queue_depth = 4;
+    options->start = ctx->checkpoint;
+    options->derive_old = &derive_old;
+    options->derive_new = &derive_new;
+    options->emit = &emit;
+    options->context = ctx;
+}
+
+/**
+ * \brief Verify that the output image holds every id in [0, 150) exactly once,
+ * in the newest mode.
+ */
+static bool output_valid(allocator* alloc, const std::vector<uint8_t>& image)
+{
+    store* st = nullptr;
+    std::set<uint64_t> ids;
+    uint64_t creation_date;
+    uint32_t version;
+    bool valid;
+
+    if (STATUS_SUCCESS != image_load(&st, alloc, image))
+    {
+        return false;
+    }
+
+    valid = (150 == store_record_count_get(st));
+    for (size_t i = 0; valid && i < store_record_count_get(st); ++i)
+    {
+        const metadata* meta = store_record_get(st, i);
+        valid =
+            STATUS_SUCCESS == metadata_creation_date_get(&creation_date, meta)
+         && STATUS_SUCCESS == metadata_version_get(&version, meta)
+         && 2 == version
+         && ids.insert(creation_date).second;
+    }
+
+    valid = valid && 150 == ids.size() && 149 == *ids.rbegin();
+
+    return
+        STATUS_SUCCESS == resource_release(store_resource_handle(st)) && valid;
+}
+
+/**
+ * Verify that every record answered by a fallback layer is upgraded.
+ */
+TEST(upgrade_all)
+{
+    allocator* alloc = nullptr;
+    migration_view* view = nullptr;
+    upgrade_pipeline* pipeline = nullptr;
+    upgrade_pipeline_options options;
+    upgrade_progress progress;
+    test_context ctx;
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+    TEST_ASSERT(STATUS_SUCCESS == view_create(&view, alloc));
+
+    /* set up the test context. */
+    ctx.alloc = alloc;
+    test_image_append_header(ctx.image);
+    ctx.checkpoint.layer = 0;
+    ctx.checkpoint.index = 0;
+    ctx.emit_limit = SIZE_MAX;
+    ctx.gate = true;
+    options_init(&options, view, &ctx);
+
+    /* run the pipeline to completion. */
+    TEST_ASSERT(
+        STATUS_SUCCESS == upgrade_pipeline_create(&pipeline, alloc, &options));
+    TEST_EXPECT(STATUS_SUCCESS == upgrade_pipeline_join(pipeline));
+
+    /* the shadowed legacy records were skipped. */
+    upgrade_pipeline_progress_get(&progress, pipeline);
+    TEST_EXPECT(progress.done);
+    TEST_EXPECT(200 == progress.scanned);
+    TEST_EXPECT(50 == progress.skipped);
+    TEST_EXPECT(150 == progress.upgraded);
+    TEST_EXPECT(2 == progress.checkpoint.layer);
+    TEST_EXPECT(0 == progress.checkpoint.index);
+
+    /* the output is a valid store image for the newest layer. */
+    TEST_EXPECT(output_valid(alloc, ctx.image));
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(upgrade_pipeline_resource_handle(pipeline)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(migration_view_resource_handle(view)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Verify that a failed upgrade can be resumed from its checkpoint.
+ */
+TEST(resume)
+{
+    allocator* alloc = nullptr;
+    migration_view* view = nullptr;
+    upgrade_pipeline* pipeline = nullptr;
+    upgrade_pipeline_options options;
+    upgrade_progress progress;
+    test_context ctx;
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+    TEST_ASSERT(STATUS_SUCCESS == view_create(&view, alloc));
+
+    /* the output fails after 70 records. */
+    ctx.alloc = alloc;
+    test_image_append_header(ctx.image);
+    ctx.checkpoint.layer = 0;
+    ctx.checkpoint.index = 0;
+    ctx.emit_limit = 70;
+    ctx.gate = true;
+    options_init(&options, view, &ctx);
+
+    TEST_ASSERT(
+        STATUS_SUCCESS == upgrade_pipeline_create(&pipeline, alloc, &options));
+    TEST_EXPECT(
+        ERROR_GENERAL_OUT_OF_MEMORY == upgrade_pipeline_join(pipeline));
+
+    /* the pipeline checkpoint matches the last durable frame. */
+    upgrade_pipeline_progress_get(&progress, pipeline);
+    TEST_EXPECT(progress.done);
+    TEST_EXPECT(70 == progress.upgraded);
+    TEST_EXPECT(ctx.checkpoint.layer == progress.checkpoint.layer);
+    TEST_EXPECT(ctx.checkpoint.index == progress.checkpoint.index);
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(upgrade_pipeline_resource_handle(pipeline)));
+
+    /* resume from the checkpoint. */
+    ctx.emit_limit = SIZE_MAX;
+    options_init(&options, view, &ctx);
+    TEST_ASSERT(
+        STATUS_SUCCESS == upgrade_pipeline_create(&pipeline, alloc, &options));
+    TEST_EXPECT(STATUS_SUCCESS == upgrade_pipeline_join(pipeline));
+    upgrade_pipeline_progress_get(&progress, pipeline);
+    TEST_EXPECT(80 == progress.upgraded);
+
+    /* every record was upgraded exactly once. */
+    TEST_EXPECT(output_valid(alloc, ctx.image));
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(upgrade_pipeline_resource_handle(pipeline)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(migration_view_resource_handle(view)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
+
+/**
+ * Verify that a running pipeline can be canceled.
+ */
+TEST(cancel)
+{
+    allocator* alloc = nullptr;
+    migration_view* view = nullptr;
+    upgrade_pipeline* pipeline = nullptr;
+    upgrade_pipeline_options options;
+    upgrade_progress progress;
+    test_context ctx;
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+    TEST_ASSERT(STATUS_SUCCESS == view_create(&view, alloc));
+
+    /* the derive old stage blocks until the gate opens. */
+    ctx.alloc = alloc;
+    test_image_append_header(ctx.image);
+    ctx.checkpoint.layer = 0;
+    ctx.checkpoint.index = 0;
+    ctx.emit_limit = SIZE_MAX;
+    ctx.gate = false;
+    options_init(&options, view, &ctx);
+
+    TEST_ASSERT(
+        STATUS_SUCCESS == upgrade_pipeline_create(&pipeline, alloc, &options));
+
+    /* cancel the pipeline, then let the stages run. */
+    upgrade_pipeline_cancel(pipeline);
+    ctx.gate = true;
+    TEST_EXPECT(
+        ERROR_UPGRADE_PIPELINE_CANCELED == upgrade_pipeline_join(pipeline));
+
+    /* nothing was emitted. */
+    upgrade_pipeline_progress_get(&progress, pipeline);
+    TEST_EXPECT(progress.done);
+    TEST_EXPECT(0 == progress.upgraded);
+    TEST_EXPECT(0 == progress.checkpoint.layer);
+    TEST_EXPECT(0 == progress.checkpoint.index);
+
+    /* clean up. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(upgrade_pipeline_resource_handle(pipeline)));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == resource_release(migration_view_resource_handle(view)));
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+}
@@ -0,0 +1,421 @@
+/**
+ * \file test/wal/test_wal.cpp
+ *
+ * \brief Unit tests for wal.
+ */
+
+#include <fcntl.h>
+#include <minunit/minunit.h>
+#include <nepe2/error_codes.h>
+#include <nepe2/wal.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "../test_record.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+TEST_SUITE(wal);
+
+static const uint32_t THREAD_COUNT = 8;
+static const uint32_t APPENDS_PER_THREAD = 16;
+
+/**
+ * \brief Count the records in a store file.
+ */
+static status record_count_get(
+    size_t* count, allocator* alloc, store_file* sf)
+{
+    status retval, release_retval;
+    secure_buffer* image = nullptr;
+    store* st = nullptr;
+
+    retval = store_file_image_read(&image, alloc, sf);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = store_create_from_buffer(&st, alloc, image, 1);
+    if (STATUS_SUCCESS == retval)
+    {
+        *count = store_record_count_get(st);
+        retval = resource_release(store_resource_handle(st));
+    }
+
+    release_retval = resource_release(secure_buffer_resource_handle(image));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * Verify that records left in a log are replayed into the target on open, and
+ * that a torn record at the end of the log is dropped.
+ */
+TEST(recovery)
+{
+    allocator* alloc = nullptr;
+    metadata* records[3];
+    store_file* target = nullptr;
+    wal* w = nullptr;
+    size_t count;
+    int fd;
+
+    std::string target_path =
+        "/tmp/nepe2-wal-test-" + std::to_string(getpid()) + ".img";
+    std::string log_path = target_path + ".wal";
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS == test_record_create(&records[i], alloc, i));
+    }
+
+    /* append each record in its own commit, without a checkpoint. */
+    unlink(target_path.c_str());
+    unlink(log_path.c_str());
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_file_open(
+                    &target, alloc, target_path.c_str(),
+                    STORE_FILE_FLAG_CREATE));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == wal_open(&w, alloc, log_path.c_str(), target, 0, 0));
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        const metadata* record = records[i];
+        TEST_ASSERT(STATUS_SUCCESS == wal_append(w, &record, 1));
+    }
+    TEST_EXPECT(3 == wal_commit_count_get(w));
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(wal_resource_handle(w)));
+
+    /* simulate a crash in the middle of the next commit. */
+    fd = open(log_path.c_str(), O_WRONLY | O_APPEND);
+    TEST_ASSERT(fd >= 0);
+    TEST_ASSERT(8 == write(fd, "\0\0\0\x40torn", 8));
+    close(fd);
+
+    /* the target holds none of the records yet. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_file_open(&target, alloc, target_path.c_str(), 0));
+    TEST_EXPECT(STORE_HEADER_SIZE == store_file_size_get(target));
+
+    /* opening the log replays the committed records, and empties the log. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == wal_open(&w, alloc, log_path.c_str(), target, 0, 0));
+    TEST_ASSERT(STATUS_SUCCESS == record_count_get(&count, alloc, target));
+    TEST_EXPECT(3 == count);
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(wal_resource_handle(w)));
+
+    /* a clean log replays nothing more. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_file_open(&target, alloc, target_path.c_str(), 0));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == wal_open(&w, alloc, log_path.c_str(), target, 0, 0));
+    TEST_ASSERT(STATUS_SUCCESS == record_count_get(&count, alloc, target));
+    TEST_EXPECT(3 == count);
+
+    /* clean up. */
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(wal_resource_handle(w)));
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == resource_release(metadata_resource_handle(records[i])));
+    }
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+    unlink(target_path.c_str());
+    unlink(log_path.c_str());
+}
+
+/**
+ * Verify that a checksummed log drops a damaged record at its end, even when
+ * the damaged record still parses.
+ */
+TEST(checksummed_recovery)
+{
+    allocator* alloc = nullptr;
+    metadata* records[3];
+    store_file* target = nullptr;
+    wal* w = nullptr;
+    size_t count;
+    off_t log_size;
+    char last;
+    int fd;
+
+    std::string target_path =
+        "/tmp/nepe2-wal-crc-test-" + std::to_string(getpid()) + ".img";
+    std::string log_path = target_path + ".wal";
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS == test_record_create(&records[i], alloc, i));
+    }
+
+    /* append each record to a checksummed log, without a checkpoint. */
+    unlink(target_path.c_str());
+    unlink(log_path.c_str());
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_file_open(
+                    &target, alloc, target_path.c_str(),
+                    STORE_FILE_FLAG_CREATE));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == wal_open(
+                    &w, alloc, log_path.c_str(), target,
+                    STORE_FILE_FLAG_CRC32C, 0));
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        const metadata* record = records[i];
+        TEST_ASSERT(STATUS_SUCCESS == wal_append(w, &record, 1));
+    }
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(wal_resource_handle(w)));
+
+    /* change the last character of the last encoding, which still parses. */
+    fd = open(log_path.c_str(), O_RDWR);
+    TEST_ASSERT(fd >= 0);
+    log_size = lseek(fd, 0, SEEK_END);
+    TEST_ASSERT(
+        1 == pread(fd, &last, 1, log_size - STORE_RECORD_TRAILER_SIZE - 2));
+    TEST_EXPECT('f' == last);
+    TEST_ASSERT(
+        1 == pwrite(fd, "g", 1, log_size - STORE_RECORD_TRAILER_SIZE - 2));
+    close(fd);
+
+    /* only the undamaged records are replayed. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_file_open(&target, alloc, target_path.c_str(), 0));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == wal_open(&w, alloc, log_path.c_str(), target, 0, 0));
+    TEST_ASSERT(STATUS_SUCCESS == record_count_get(&count, alloc, target));
+    TEST_EXPECT(2 == count);
+
+    /* clean up. */
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(wal_resource_handle(w)));
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == resource_release(metadata_resource_handle(records[i])));
+    }
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+    unlink(target_path.c_str());
+    unlink(log_path.c_str());
+}
+
+/**
+ * Verify that a damaged record before the end of the log fails the replay and
+ * leaves the log alone, while a tail of zeroes is dropped.
+ */
+TEST(damaged_log)
+{
+    allocator* alloc = nullptr;
+    metadata* records[3];
+    store_file* target = nullptr;
+    wal* w = nullptr;
+    size_t count;
+    off_t log_size, damaged_size;
+    char zeroes[64] = { 0 };
+    char first;
+    int fd;
+
+    std::string target_path =
+        "/tmp/nepe2-wal-damaged-test-" + std::to_string(getpid()) + ".img";
+    std::string log_path = target_path + ".wal";
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS == test_record_create(&records[i], alloc, i));
+    }
+
+    /* append each record to a checksummed log, without a checkpoint. */
+    unlink(target_path.c_str());
+    unlink(log_path.c_str());
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_file_open(
+                    &target, alloc, target_path.c_str(),
+                    STORE_FILE_FLAG_CREATE));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == wal_open(
+                    &w, alloc, log_path.c_str(), target,
+                    STORE_FILE_FLAG_CRC32C, 0));
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        const metadata* record = records[i];
+        TEST_ASSERT(STATUS_SUCCESS == wal_append(w, &record, 1));
+    }
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(wal_resource_handle(w)));
+
+    /* a crash that extends the log with zeroes leaves a torn tail. */
+    fd = open(log_path.c_str(), O_RDWR);
+    TEST_ASSERT(fd >= 0);
+    log_size = lseek(fd, 0, SEEK_END);
+    TEST_ASSERT(
+        (ssize_t)sizeof(zeroes)
+            == pwrite(fd, zeroes, sizeof(zeroes), log_size));
+
+    /* damage the first byte of the serial version of the first record. */
+    TEST_ASSERT(
+        1 == pread(
+                fd, &first, 1, STORE_HEADER_SIZE + STORE_RECORD_PREFIX_SIZE));
+    first ^= 0x40;
+    TEST_ASSERT(
+        1 == pwrite(
+                fd, &first, 1, STORE_HEADER_SIZE + STORE_RECORD_PREFIX_SIZE));
+    damaged_size = lseek(fd, 0, SEEK_END);
+
+    /* the replay fails, and applies nothing. */
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_file_open(&target, alloc, target_path.c_str(), 0));
+    TEST_EXPECT(
+        ERROR_WAL_CORRUPT
+            == wal_open(&w, alloc, log_path.c_str(), target, 0, 0));
+    TEST_EXPECT(STORE_HEADER_SIZE == store_file_size_get(target));
+    TEST_EXPECT(damaged_size == lseek(fd, 0, SEEK_END));
+
+    /* once the record is repaired, every record is replayed. */
+    first ^= 0x40;
+    TEST_ASSERT(
+        1 == pwrite(
+                fd, &first, 1, STORE_HEADER_SIZE + STORE_RECORD_PREFIX_SIZE));
+    close(fd);
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == wal_open(&w, alloc, log_path.c_str(), target, 0, 0));
+    TEST_ASSERT(STATUS_SUCCESS == record_count_get(&count, alloc, target));
+    TEST_EXPECT(3 == count);
+
+    /* clean up. */
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(wal_resource_handle(w)));
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == resource_release(metadata_resource_handle(records[i])));
+    }
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+    unlink(target_path.c_str());
+    unlink(log_path.c_str());
+}
+
+/**
+ * Verify that concurrent writers share commits, and that a checkpoint applies
+ * every committed record.
+ */
+TEST(group_commit)
+{
+    allocator* alloc = nullptr;
+    std::vector<metadata*> records(THREAD_COUNT * APPENDS_PER_THREAD);
+    store_file* target = nullptr;
+    wal* w = nullptr;
+    status results[THREAD_COUNT];
+    std::vector<std::thread> writers;
+    size_t count;
+
+    std::string target_path =
+        "/tmp/nepe2-wal-group-" + std::to_string(getpid()) + ".img";
+    std::string log_path = target_path + ".wal";
+
+    /* we can successfully create a malloc allocator. */
+    TEST_ASSERT(STATUS_SUCCESS == malloc_allocator_create(&alloc));
+
+    for (uint32_t i = 0; i < records.size(); ++i)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS == test_record_create(&records[i], alloc, i));
+    }
+
+    /* open a log that waits up to 2 ms for each group to fill. */
+    unlink(target_path.c_str());
+    unlink(log_path.c_str());
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == store_file_open(
+                    &target, alloc, target_path.c_str(),
+                    STORE_FILE_FLAG_CREATE));
+    TEST_ASSERT(
+        STATUS_SUCCESS
+            == wal_open(&w, alloc, log_path.c_str(), target, 0, 2000));
+
+    /* each writer appends its records one at a time. */
+    for (uint32_t t = 0; t < THREAD_COUNT; ++t)
+    {
+        writers.emplace_back([&, t]() {
+            results[t] = STATUS_SUCCESS;
+            for (uint32_t i = 0; i < APPENDS_PER_THREAD; ++i)
+            {
+                const metadata* record =
+                    records[t * APPENDS_PER_THREAD + i];
+                status retval = wal_append(w, &record, 1);
+                if (STATUS_SUCCESS != retval)
+                {
+                    results[t] = retval;
+                }
+            }
+        });
+    }
+    for (auto& writer : writers)
+    {
+        writer.join();
+    }
+
+    /* every append succeeded, with fewer commits than appends. */
+    for (uint32_t t = 0; t < THREAD_COUNT; ++t)
+    {
+        TEST_EXPECT(STATUS_SUCCESS == results[t]);
+    }
+    TEST_EXPECT(wal_commit_count_get(w) < records.size());
+
+    /* a checkpoint applies every record to the target. */
+    TEST_ASSERT(STATUS_SUCCESS == record_count_get(&count, alloc, target));
+    TEST_EXPECT(0 == count);
+    TEST_ASSERT(STATUS_SUCCESS == wal_checkpoint(w));
+    TEST_ASSERT(STATUS_SUCCESS == record_count_get(&count, alloc, target));
+    TEST_EXPECT(records.size() == count);
+
+    /* clean up. */
+    TEST_ASSERT(STATUS_SUCCESS == resource_release(wal_resource_handle(w)));
+    for (auto record : records)
+    {
+        TEST_ASSERT(
+            STATUS_SUCCESS
+                == resource_release(metadata_resource_handle(record)));
+    }
+    TEST_ASSERT(
+        STATUS_SUCCESS == resource_release(allocator_resource_handle(alloc)));
+    unlink(target_path.c_str());
+    unlink(log_path.c_str());
+}